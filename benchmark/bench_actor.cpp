@@ -6,6 +6,7 @@
 //
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
+#include "td/actor/MultiPromise.h"
 #include "td/actor/PromiseFuture.h"
 
 #include "td/utils/benchmark.h"
@@ -324,7 +325,400 @@ class QueryBench final : public td::Benchmark {
   td::ActorOwn<ServerActor> server_;
 };
 
+// a message is sent to an actor on another scheduler and the answer is awaited before sending the next message
+class PingPongBench final : public td::Benchmark {
+ public:
+  explicit PingPongBench(int thread_n) : thread_n_(thread_n) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "PingPong (threads_n = " << thread_n_ << ")";
+  }
+
+  class PingActor;
+
+  class PongActor final : public td::Actor {
+   public:
+    void ping(td::ActorId<PingActor> ping_actor, int n);
+  };
+
+  class PingActor final : public td::Actor {
+   public:
+    explicit PingActor(td::ActorId<PongActor> pong_actor) : pong_actor_(pong_actor) {
+    }
+
+    void pong(int n) {
+      if (n == 0) {
+        return td::Scheduler::instance()->finish();
+      }
+      send_closure(pong_actor_, &PongActor::ping, actor_id(this), n - 1);
+    }
+
+   private:
+    td::ActorId<PongActor> pong_actor_;
+  };
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(thread_n_, 0);
+    auto pong_actor = scheduler_->create_actor_unsafe<PongActor>(thread_n_, "PongActor").release();
+    ping_actor_ = scheduler_->create_actor_unsafe<PingActor>(0, "PingActor", pong_actor).release();
+    scheduler_->start();
+  }
+
+  void run(int n) final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      send_closure(ping_actor_, &PingActor::pong, n);
+    }
+    while (scheduler_->run_main(10)) {
+      // empty
+    }
+  }
+
+  void tear_down() final {
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  int thread_n_ = 0;
+  td::ActorId<PingActor> ping_actor_;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+};
+
+void PingPongBench::PongActor::ping(td::ActorId<PingActor> ping_actor, int n) {
+  send_closure(ping_actor, &PingActor::pong, n);
+}
+
+// messages are sent to many actors on other schedulers without waiting and all answers are collected by one actor
+class FanOutFanInBench final : public td::Benchmark {
+ public:
+  FanOutFanInBench(int worker_n, int thread_n) : worker_n_(worker_n), thread_n_(thread_n) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "FanOutFanIn (workers_n = " << worker_n_ << ") (threads_n = " << thread_n_ << ")";
+  }
+
+  class CollectorActor;
+
+  class WorkerActor final : public td::Actor {
+   public:
+    explicit WorkerActor(td::ActorId<CollectorActor> collector) : collector_(collector) {
+    }
+
+    void process(int x);
+
+   private:
+    td::ActorId<CollectorActor> collector_;
+  };
+
+  class CollectorActor final : public td::Actor {
+   public:
+    void run(td::vector<td::ActorId<WorkerActor>> workers, int n) {
+      workers_ = std::move(workers);
+      left_n_ = n;
+      send_round();
+    }
+
+    void on_processed(int x) {
+      CHECK(pending_n_ > 0);
+      if (--pending_n_ == 0) {
+        send_round();
+      }
+    }
+
+   private:
+    td::vector<td::ActorId<WorkerActor>> workers_;
+    int left_n_ = 0;
+    int pending_n_ = 0;
+
+    void send_round() {
+      if (left_n_ <= 0) {
+        return td::Scheduler::instance()->finish();
+      }
+      for (auto &worker : workers_) {
+        send_closure(worker, &WorkerActor::process, left_n_);
+      }
+      pending_n_ = static_cast<int>(workers_.size());
+      left_n_ -= pending_n_;
+    }
+  };
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(thread_n_, 0);
+    collector_ = scheduler_->create_actor_unsafe<CollectorActor>(0, "CollectorActor").release();
+    workers_.clear();
+    for (int i = 0; i < worker_n_; i++) {
+      workers_.push_back(scheduler_
+                             ->create_actor_unsafe<WorkerActor>(thread_n_ == 0 ? 0 : 1 + i % thread_n_, "WorkerActor",
+                                                                collector_)
+                             .release());
+    }
+    scheduler_->start();
+  }
+
+  void run(int n) final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      send_closure(collector_, &CollectorActor::run, workers_, n);
+    }
+    while (scheduler_->run_main(10)) {
+      // empty
+    }
+  }
+
+  void tear_down() final {
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  int worker_n_ = 0;
+  int thread_n_ = 0;
+  td::ActorId<CollectorActor> collector_;
+  td::vector<td::ActorId<WorkerActor>> workers_;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+};
+
+void FanOutFanInBench::WorkerActor::process(int x) {
+  send_closure(collector_, &CollectorActor::on_processed, x);
+}
+
+// an actor migrates to the next scheduler on every received message
+class MigrateActorBench final : public td::Benchmark {
+ public:
+  explicit MigrateActorBench(int thread_n) : thread_n_(thread_n) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "MigrateActor (threads_n = " << thread_n_ << ")";
+  }
+
+  class MigratingActor final : public td::Actor {
+   public:
+    explicit MigratingActor(int scheduler_n) : scheduler_n_(scheduler_n) {
+    }
+
+    void hop(int n) {
+      if (n == 0) {
+        return td::Scheduler::instance()->finish();
+      }
+      migrate(n % scheduler_n_);
+      send_closure_later(actor_id(this), &MigratingActor::hop, n - 1);
+    }
+
+   private:
+    int scheduler_n_ = 0;
+  };
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(thread_n_, 0);
+    actor_ = scheduler_->create_actor_unsafe<MigratingActor>(0, "MigratingActor", thread_n_ + 1).release();
+    scheduler_->start();
+  }
+
+  void run(int n) final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      send_closure(actor_, &MigratingActor::hop, n);
+    }
+    while (scheduler_->run_main(10)) {
+      // empty
+    }
+  }
+
+  void tear_down() final {
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  int thread_n_ = 0;
+  td::ActorId<MigratingActor> actor_;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+};
+
+// many actors on other schedulers are created and immediately destroyed, releasing ActorShared of the parent
+class HangupStormBench final : public td::Benchmark {
+ public:
+  explicit HangupStormBench(int thread_n) : thread_n_(thread_n) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "HangupStorm (threads_n = " << thread_n_ << ")";
+  }
+
+  class ChildActor final : public td::Actor {
+   public:
+    explicit ChildActor(td::ActorShared<> parent) : parent_(std::move(parent)) {
+    }
+
+    void start_up() final {
+      stop();
+    }
+
+   private:
+    td::ActorShared<> parent_;
+  };
+
+  class ParentActor final : public td::Actor {
+   public:
+    explicit ParentActor(int thread_n) : thread_n_(thread_n) {
+    }
+
+    void run(int n) {
+      left_n_ = n;
+      create_children();
+    }
+
+    void hangup_shared() final {
+      CHECK(child_n_ > 0);
+      if (--child_n_ == 0) {
+        create_children();
+      }
+    }
+
+   private:
+    static constexpr int MAX_CHILDREN = 1000;
+
+    int thread_n_ = 0;
+    int left_n_ = 0;
+    int child_n_ = 0;
+
+    void create_children() {
+      if (left_n_ <= 0) {
+        return td::Scheduler::instance()->finish();
+      }
+      child_n_ = td::min(left_n_, MAX_CHILDREN);
+      left_n_ -= child_n_;
+      for (int i = 0; i < child_n_; i++) {
+        td::create_actor_on_scheduler<ChildActor>("ChildActor", thread_n_ == 0 ? 0 : 1 + i % thread_n_,
+                                                  actor_shared(this))
+            .release();
+      }
+    }
+  };
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(thread_n_, 0);
+    parent_ = scheduler_->create_actor_unsafe<ParentActor>(0, "ParentActor", thread_n_).release();
+    scheduler_->start();
+  }
+
+  void run(int n) final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      send_closure(parent_, &ParentActor::run, n);
+    }
+    while (scheduler_->run_main(10)) {
+      // empty
+    }
+  }
+
+  void tear_down() final {
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  int thread_n_ = 0;
+  td::ActorId<ParentActor> parent_;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+};
+
+// promises of a MultiPromise are set concurrently by actors on other schedulers
+class MultiPromiseBench final : public td::Benchmark {
+ public:
+  explicit MultiPromiseBench(int thread_n) : thread_n_(thread_n) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "MultiPromise (threads_n = " << thread_n_ << ")";
+  }
+
+  class WorkerActor final : public td::Actor {
+   public:
+    void resolve(td::Promise<td::Unit> promise) {
+      promise.set_value(td::Unit());
+    }
+  };
+
+  class AggregatorActor final : public td::Actor {
+   public:
+    explicit AggregatorActor(td::vector<td::ActorId<WorkerActor>> workers) : workers_(std::move(workers)) {
+    }
+
+    void run(int n) {
+      left_n_ = n;
+      start_round();
+    }
+
+    void on_round_finished() {
+      start_round();
+    }
+
+   private:
+    static constexpr int PROMISES_PER_ROUND = 1000;
+
+    td::vector<td::ActorId<WorkerActor>> workers_;
+    int left_n_ = 0;
+    td::unique_ptr<td::MultiPromiseActorSafe> multipromise_;
+
+    void start_round() {
+      if (left_n_ <= 0) {
+        multipromise_ = nullptr;
+        return td::Scheduler::instance()->finish();
+      }
+      auto promise_n = td::min(left_n_, PROMISES_PER_ROUND);
+      left_n_ -= promise_n;
+
+      multipromise_ = td::make_unique<td::MultiPromiseActorSafe>("BenchMultiPromiseActor");
+      multipromise_->add_promise(td::PromiseCreator::lambda([actor_id = actor_id(this)](td::Unit) {
+        send_closure(actor_id, &AggregatorActor::on_round_finished);
+      }));
+      auto lock = multipromise_->get_promise();
+      for (int i = 0; i < promise_n; i++) {
+        send_closure(workers_[i % workers_.size()], &WorkerActor::resolve, multipromise_->get_promise());
+      }
+      lock.set_value(td::Unit());
+    }
+  };
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(thread_n_, 0);
+    td::vector<td::ActorId<WorkerActor>> workers;
+    for (int i = 0; i < td::max(thread_n_, 1); i++) {
+      workers.push_back(
+          scheduler_->create_actor_unsafe<WorkerActor>(thread_n_ == 0 ? 0 : 1 + i, "WorkerActor").release());
+    }
+    aggregator_ = scheduler_->create_actor_unsafe<AggregatorActor>(0, "AggregatorActor", std::move(workers)).release();
+    scheduler_->start();
+  }
+
+  void run(int n) final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      send_closure(aggregator_, &AggregatorActor::run, n);
+    }
+    while (scheduler_->run_main(10)) {
+      // empty
+    }
+  }
+
+  void tear_down() final {
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  int thread_n_ = 0;
+  td::ActorId<AggregatorActor> aggregator_;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+};
+
 int main() {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
   td::init_openssl_threads();
 
   bench(CreateActorBench());
@@ -346,4 +740,11 @@ int main() {
   bench(RingBench<0>(504, 2));
   bench(RingBench<1>(504, 2));
   bench(RingBench<2>(504, 2));
+  for (int thread_n : {0, 1, 2, 4}) {
+    bench(PingPongBench(thread_n));
+    bench(FanOutFanInBench(100, thread_n));
+    bench(MigrateActorBench(thread_n));
+    bench(HangupStormBench(thread_n));
+    bench(MultiPromiseBench(thread_n));
+  }
 }
@@ -439,6 +439,18 @@ BENCH(SslRandBuf, "ssl_rand_bytes") {
   td::do_not_optimize_away(res);
 }
 
+BENCH(SslRandPadding, "ssl_rand_padding") {
+  td::uint8 res = 0;
+  std::array<td::uint8, 268> buf;
+  for (int i = 0; i < n; i++) {
+    // a typical size of MTProto message padding
+    auto size = 12 + (static_cast<size_t>(i) & 0xff);
+    td::Random::secure_bytes(buf.data(), size);
+    res ^= buf[size - 1];
+  }
+  td::do_not_optimize_away(res);
+}
+
 BENCH(Pbkdf2, "pbkdf2") {
   std::string password = "cucumber";
   std::string salt = "abcdefghijklmnopqrstuvw";
@@ -512,6 +524,7 @@ int main() {
   td::bench(SslRandBench());
 #endif
   td::bench(SslRandBufBench());
+  td::bench(SslRandPaddingBench());
 #if OPENSSL_VERSION_NUMBER <= 0x10100000L
   td::bench(SHA1Bench());
 #endif
@@ -10,7 +10,10 @@
 #include "td/utils/base64.h"
 #include "td/utils/benchmark.h"
 #include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/port/thread.h"
 #include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
 
 #include <map>
 
@@ -25,48 +28,101 @@ static td::string prime_base64 =
     "WC2xF40WnGvEZbDW_5yjko_vW5rk5Bj8Feg-vqD4f6n_Xu1wBQ3tKEn0e_lZ2VaFDOkphR8NgRX2NbEF7i5OFdBLJFS_b0-t8DSxBAMRnNjjuS_MW"
     "w";
 
+class FakeDhCallback final : public td::mtproto::DhCallback {
+ public:
+  int is_good_prime(td::Slice prime_str) const final {
+    auto it = cache.find(prime_str.str());
+    if (it == cache.end()) {
+      return -1;
+    }
+    return it->second;
+  }
+  void add_good_prime(td::Slice prime_str) const final {
+    cache[prime_str.str()] = 1;
+  }
+  void add_bad_prime(td::Slice prime_str) const final {
+    cache[prime_str.str()] = 0;
+  }
+  mutable std::map<td::string, int> cache;
+};
+
+// the prime must be already checked
+static void run_handshakes(int n, FakeDhCallback &dh_callback) {
+  td::mtproto::DhHandshake a;
+  td::mtproto::DhHandshake b;
+  auto prime = td::base64url_decode(prime_base64).move_as_ok();
+  for (int i = 0; i < n; i += 2) {
+    a.set_config(g, prime);
+    b.set_config(g, prime);
+    b.set_g_a(a.get_g_b());
+    a.set_g_a(b.get_g_b());
+    a.run_checks(true, &dh_callback).ensure();
+    b.run_checks(true, &dh_callback).ensure();
+    auto a_key = a.gen_key();
+    auto b_key = b.gen_key();
+    CHECK(a_key.first == b_key.first);
+  }
+}
+
 class HandshakeBench final : public td::Benchmark {
   td::string get_description() const final {
     return "Handshake";
   }
 
-  class FakeDhCallback final : public td::mtproto::DhCallback {
-   public:
-    int is_good_prime(td::Slice prime_str) const final {
-      auto it = cache.find(prime_str.str());
-      if (it == cache.end()) {
-        return -1;
-      }
-      return it->second;
-    }
-    void add_good_prime(td::Slice prime_str) const final {
-      cache[prime_str.str()] = 1;
-    }
-    void add_bad_prime(td::Slice prime_str) const final {
-      cache[prime_str.str()] = 0;
-    }
-    mutable std::map<td::string, int> cache;
-  } dh_callback;
+  FakeDhCallback dh_callback;
 
-  void run(int n) final {
-    td::mtproto::DhHandshake a;
-    td::mtproto::DhHandshake b;
+  void start_up() final {
     auto prime = td::base64url_decode(prime_base64).move_as_ok();
     td::mtproto::DhHandshake::check_config(g, prime, &dh_callback).ensure();
-    for (int i = 0; i < n; i += 2) {
-      a.set_config(g, prime);
-      b.set_config(g, prime);
-      b.set_g_a(a.get_g_b());
-      a.set_g_a(b.get_g_b());
-      a.run_checks(true, &dh_callback).ensure();
-      b.run_checks(true, &dh_callback).ensure();
-      auto a_key = a.gen_key();
-      auto b_key = b.gen_key();
-      CHECK(a_key.first == b_key.first);
+  }
+
+  void run(int n) final {
+    run_handshakes(n, dh_callback);
+  }
+};
+
+#if !TD_THREAD_UNSUPPORTED
+class ConcurrentHandshakeBench final : public td::Benchmark {
+ public:
+  explicit ConcurrentHandshakeBench(int thread_count) : thread_count_(thread_count) {
+  }
+
+ private:
+  int thread_count_;
+
+  td::string get_description() const final {
+    return PSTRING() << "Handshake with " << thread_count_ << " threads";
+  }
+
+  td::vector<td::unique_ptr<FakeDhCallback>> dh_callbacks_;
+
+  void start_up() final {
+    auto prime = td::base64url_decode(prime_base64).move_as_ok();
+    dh_callbacks_.clear();
+    for (int i = 0; i < thread_count_; i++) {
+      dh_callbacks_.push_back(td::make_unique<FakeDhCallback>());
+      td::mtproto::DhHandshake::check_config(g, prime, dh_callbacks_.back().get()).ensure();
+    }
+  }
+
+  void run(int n) final {
+    td::vector<td::thread> threads;
+    for (int i = 0; i < thread_count_; i++) {
+      auto thread_n = n / thread_count_ + (i < n % thread_count_ ? 1 : 0);
+      threads.emplace_back([&, i, thread_n] { run_handshakes(thread_n, *dh_callbacks_[i]); });
+    }
+    for (auto &thread : threads) {
+      thread.join();
     }
   }
 };
+#endif
 
 int main() {
   td::bench(HandshakeBench());
+#if !TD_THREAD_UNSUPPORTED
+  for (int thread_count : {2, 4, 8}) {
+    td::bench(ConcurrentHandshakeBench(thread_count));
+  }
+#endif
 }
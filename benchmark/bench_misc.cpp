@@ -8,8 +8,14 @@
 #include "td/telegram/telegram_api.h"
 #include "td/telegram/telegram_api.hpp"
 
+#include "td/mtproto/TlsReaderByteFlow.h"
+
+#include "td/utils/AesCtrByteFlow.h"
 #include "td/utils/algorithm.h"
+#include "td/utils/base64.h"
 #include "td/utils/benchmark.h"
+#include "td/utils/buffer.h"
+#include "td/utils/ByteFlow.h"
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/Clocks.h"
@@ -26,6 +32,7 @@
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/ThreadSafeCounter.h"
+#include "td/utils/UInt.h"
 
 #if !TD_WINDOWS
 #include <unistd.h>
@@ -739,6 +746,55 @@ BENCH(AnyOfStd, "any_of std") {
   td::do_not_optimize_away(res);
 }
 
+// decoding of received data of an emulated TLS connection, measured in processed records per second
+class EmulatedTlsReadBench final : public td::Benchmark {
+ public:
+  explicit EmulatedTlsReadBench(size_t record_size) : record_size_(record_size) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "EmulatedTlsRead of " << record_size_ << " byte records";
+  }
+
+  void start_up() final {
+    record_ = td::string("\x17\x03\x03", 3);
+    record_ += static_cast<char>(record_size_ >> 8);
+    record_ += static_cast<char>(record_size_ & 255);
+    record_.resize(5 + record_size_);
+    td::Random::secure_bytes(td::MutableSlice(record_).substr(5));
+  }
+
+  void run(int n) final {
+    td::ChainBufferWriter input_writer;
+    auto input = input_writer.extract_reader();
+    td::mtproto::TlsReaderByteFlow tls_reader;
+    td::AesCtrByteFlow aes_ctr;
+    td::ByteFlowSink sink;
+    td::UInt256 key;
+    td::UInt128 iv;
+    td::Random::secure_bytes(key.raw, sizeof(key));
+    td::Random::secure_bytes(iv.raw, sizeof(iv));
+    aes_ctr.init(key, iv);
+    tls_reader.set_input(&input);
+    tls_reader >> aes_ctr >> sink;
+
+    size_t total_size = 0;
+    for (int i = 0; i < n; i++) {
+      input_writer.append(record_);
+      input.sync_with_writer();
+      tls_reader.wakeup();
+      auto output = sink.get_output();
+      total_size += output->size();
+      output->advance(output->size());
+    }
+    CHECK(total_size == static_cast<size_t>(n) * record_size_);
+  }
+
+ private:
+  size_t record_size_;
+  td::string record_;
+};
+
 BENCH(AnyOfTd, "any_of td") {
   td::vector<int> v;
   for (int i = 0; i < 100; i++) {
@@ -752,12 +808,66 @@ BENCH(AnyOfTd, "any_of td") {
   td::do_not_optimize_away(res);
 }
 
+class Base64EncodeBench final : public td::Benchmark {
+ public:
+  explicit Base64EncodeBench(std::size_t size) : data_(size, '\0') {
+    td::Random::secure_bytes(td::MutableSlice(data_));
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "base64_encode " << data_.size();
+  }
+
+  void run(int n) final {
+    std::size_t res = 0;
+    for (int i = 0; i < n; i++) {
+      res += td::base64_encode(data_).size();
+    }
+    td::do_not_optimize_away(res);
+  }
+
+ private:
+  td::string data_;
+};
+
+class Base64urlDecodeBench final : public td::Benchmark {
+ public:
+  explicit Base64urlDecodeBench(std::size_t size) {
+    td::string data(size, '\0');
+    td::Random::secure_bytes(td::MutableSlice(data));
+    encoded_ = td::base64url_encode(data);
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "base64url_decode " << encoded_.size();
+  }
+
+  void run(int n) final {
+    std::size_t res = 0;
+    for (int i = 0; i < n; i++) {
+      res += td::base64url_decode(encoded_).ok().size();
+    }
+    td::do_not_optimize_away(res);
+  }
+
+ private:
+  td::string encoded_;
+};
+
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(DEBUG));
 
+  td::bench(Base64EncodeBench(48));
+  td::bench(Base64EncodeBench(4096));
+  td::bench(Base64urlDecodeBench(48));
+  td::bench(Base64urlDecodeBench(4096));
+
   td::bench(AnyOfStdBench());
   td::bench(AnyOfTdBench());
 
+  td::bench(EmulatedTlsReadBench(2878));
+  td::bench(EmulatedTlsReadBench(16384));
+
   td::bench(ToStringIntSmallBench());
   td::bench(ToStringIntBigBench());
 
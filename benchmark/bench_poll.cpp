@@ -0,0 +1,125 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/benchmark.h"
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/port/detail/NativeFd.h"
+#include "td/utils/port/detail/PollableFd.h"
+#include "td/utils/port/Poll.h"
+#include "td/utils/port/PollFlags.h"
+#include "td/utils/port/rlimit.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/Status.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+// measures event delivery of the scheduler poll for connections, only a part of which have something to read
+class PollBenchmark final : public td::Benchmark {
+ public:
+  PollBenchmark(size_t idle_connection_count, size_t active_connection_count, bool use_io_uring)
+      : idle_connection_count_(idle_connection_count)
+      , active_connection_count_(active_connection_count)
+      , use_io_uring_(use_io_uring) {
+  }
+
+  std::string get_description() const final {
+    return PSTRING() << "Poll[" << (use_io_uring_ ? "io_uring" : "epoll") << ", idle = " << idle_connection_count_
+                     << ", active = " << active_connection_count_ << ']';
+  }
+
+  void start_up() final {
+#if TD_POLL_IO_URING
+    td::detail::IoUring::set_enabled(use_io_uring_);
+#endif
+    poll_.init();
+#if TD_POLL_IO_URING
+    td::detail::IoUring::set_enabled(false);
+    if (use_io_uring_ && !poll_.is_io_uring_used()) {
+      LOG(ERROR) << "io_uring isn't supported, epoll is used instead";
+    }
+#endif
+    for (size_t i = 0; i < idle_connection_count_ + active_connection_count_; i++) {
+      int fds[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        LOG(ERROR) << "Failed to create " << i << "-th connection: " << OS_SOCKET_ERROR("socketpair failed");
+        break;
+      }
+      Connection connection;
+      connection.writer_ = td::NativeFd(fds[0]);
+      td::NativeFd reader(fds[1]);
+      reader.set_is_blocking(false).ensure();
+      connection.reader_ = td::make_unique<td::PollableFdInfo>(std::move(reader));
+      poll_.subscribe(connection.reader_->extract_pollable_fd(nullptr), td::PollFlags::Read());
+      if (i < idle_connection_count_) {
+        idle_connections_.push_back(std::move(connection));
+      } else {
+        active_connections_.push_back(std::move(connection));
+      }
+    }
+    poll_.run(0);
+  }
+
+  void run(int n) final {
+    char byte = 'a';
+    for (int i = 0; i < n; i++) {
+      for (auto &connection : active_connections_) {
+        CHECK(write(connection.writer_.fd(), &byte, 1) == 1);
+      }
+      size_t left_count = active_connections_.size();
+      while (left_count > 0) {
+        poll_.run(1);
+        for (auto &connection : active_connections_) {
+          if (connection.reader_->sync_with_poll().can_read()) {
+            CHECK(read(connection.reader_->native_fd().fd(), &byte, 1) == 1);
+            connection.reader_->clear_flags(td::PollFlags::Read());
+            left_count--;
+          }
+        }
+      }
+    }
+  }
+
+  void tear_down() final {
+    for (auto *connections : {&idle_connections_, &active_connections_}) {
+      for (auto &connection : *connections) {
+        poll_.unsubscribe(connection.reader_->get_pollable_fd_ref());
+      }
+      connections->clear();
+    }
+    poll_.clear();
+  }
+
+ private:
+  struct Connection {
+    td::NativeFd writer_;
+    td::unique_ptr<td::PollableFdInfo> reader_;
+  };
+
+  size_t idle_connection_count_;
+  size_t active_connection_count_;
+  bool use_io_uring_;
+  td::Poll poll_;
+  td::vector<Connection> idle_connections_;
+  td::vector<Connection> active_connections_;
+};
+
+int main() {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  td::set_maximize_resource_limit(td::ResourceLimitType::NoFile, 1 << 18).ignore();
+
+  for (auto use_io_uring : {false, true}) {
+#if !TD_POLL_IO_URING
+    if (use_io_uring) {
+      continue;
+    }
+#endif
+    td::bench(PollBenchmark(0, 5000, use_io_uring));
+    td::bench(PollBenchmark(50000, 5000, use_io_uring));
+    td::bench(PollBenchmark(50000, 100, use_io_uring));
+  }
+}
@@ -7,11 +7,14 @@
 #include "td/utils/benchmark.h"
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
+#include "td/utils/MpmcWaiter.h"
 #include "td/utils/MpscPollableQueue.h"
+#include "td/utils/port/Clocks.h"
 #include "td/utils/port/sleep.h"
 #include "td/utils/port/thread.h"
 #include "td/utils/queue.h"
 #include "td/utils/Random.h"
+#include "td/utils/StringBuilder.h"
 
 // TODO: check system calls
 // TODO: all return values must be checked
@@ -23,6 +26,7 @@
 #include <sched.h>
 #include <semaphore.h>
 #include <sys/syscall.h>
+#include <time.h>
 #include <unistd.h>
 #endif
 
@@ -847,6 +851,51 @@ class RingBenchmark final : public td::Benchmark {
 };
 #endif
 
+#if TD_PORT_POSIX && !TD_THREAD_UNSUPPORTED
+static double get_thread_cpu_time() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+// measures wakeup latency of a worker waiting with MpmcEagerWaiter and CPU time spent by the worker
+static void bench_waiter_latency(int average_interval_us) {
+  int event_count = td::max(100, 500000 / td::max(average_interval_us, 1));
+  td::MpmcEagerWaiter waiter;
+  std::atomic<int> published_count{0};
+  td::vector<double> publish_times(event_count);
+  double total_latency = 0.0;
+  double worker_cpu_time = 0.0;
+  td::thread worker([&] {
+    td::MpmcEagerWaiter::Slot slot;
+    td::MpmcEagerWaiter::init_slot(slot, 1);
+    auto start_cpu_time = get_thread_cpu_time();
+    for (int i = 1; i <= event_count; i++) {
+      while (published_count.load(std::memory_order_acquire) < i) {
+        waiter.wait(slot);
+      }
+      waiter.stop_wait(slot);
+      total_latency += td::Clocks::monotonic() - publish_times[i - 1];
+    }
+    worker_cpu_time = get_thread_cpu_time() - start_cpu_time;
+  });
+
+  auto start_time = td::Clocks::monotonic();
+  for (int i = 0; i < event_count; i++) {
+    td::usleep_for(td::Random::fast(0, 2 * average_interval_us));
+    publish_times[i] = td::Clocks::monotonic();
+    published_count.store(i + 1, std::memory_order_release);
+    waiter.notify();
+  }
+  worker.join();
+  auto total_time = td::Clocks::monotonic() - start_time;
+
+  LOG(ERROR) << "MpmcEagerWaiter with average event interval " << average_interval_us << " us: average latency "
+             << td::StringBuilder::FixedDouble(total_latency / event_count * 1e6, 3) << " us, worker CPU usage "
+             << td::StringBuilder::FixedDouble(worker_cpu_time / total_time * 100, 1) << '%';
+}
+#endif
+
 /*
 #if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
 static void test_queue() {
@@ -887,6 +936,12 @@ int main() {
   // test_queue();
 #endif
 
+#if TD_PORT_POSIX && !TD_THREAD_UNSUPPORTED
+  for (auto average_interval_us : {10, 100, 1000, 10000}) {
+    bench_waiter_latency(average_interval_us);
+  }
+#endif
+
 #if TD_PORT_POSIX
   // td::bench(RingBenchmark<SemQueue>());
   // td::bench(RingBenchmark<td::PollQueue<qvalue_t>>());
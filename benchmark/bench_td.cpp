@@ -0,0 +1,233 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/Client.h"
+#include "td/telegram/ClientJson.h"
+#include "td/telegram/td_api.h"
+
+#include "td/utils/benchmark.h"
+#include "td/utils/common.h"
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/Clocks.h"
+#include "td/utils/port/path.h"
+#include "td/utils/port/Stat.h"
+#include "td/utils/Slice.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// all requests are processed locally, so neither network connection, nor authorization are needed
+
+static constexpr int MAX_PENDING_REQUESTS = 1000;
+
+class TdRequestBenchmark final : public td::Benchmark {
+ public:
+  td::string get_description() const final {
+    return "TdRequestBenchmark";
+  }
+
+  TdRequestBenchmark() : client_id_(client_manager_.create_client_id()) {
+  }
+
+  void run(int n) final {
+    int sent_count = 0;
+    int received_count = 0;
+    while (received_count < n) {
+      while (sent_count < n && sent_count - received_count < MAX_PENDING_REQUESTS) {
+        sent_count++;
+        client_manager_.send(client_id_, sent_count, td::td_api::make_object<td::td_api::testSquareInt>(sent_count));
+      }
+      auto response = client_manager_.receive(10.0);
+      CHECK(response.object != nullptr);
+      if (response.request_id != 0) {
+        CHECK(response.object->get_id() == td::td_api::testInt::ID);
+        received_count++;
+      }
+    }
+  }
+
+ private:
+  td::ClientManager client_manager_;
+  td::ClientManager::ClientId client_id_;
+};
+
+class TdJsonRequestBenchmark final : public td::Benchmark {
+ public:
+  td::string get_description() const final {
+    return "TdJsonRequestBenchmark";
+  }
+
+  TdJsonRequestBenchmark() : client_id_(td::json_create_client_id()) {
+    request_ = "{\"@type\":\"testCallVectorString\",\"x\":[";
+    for (int i = 0; i < 10; i++) {
+      if (i != 0) {
+        request_ += ',';
+      }
+      request_ += "\"string with \\\"escaped\\\" characters and unicode \\u043f\\u0440\\u0438\\u0432\\u0435\\u0442\"";
+    }
+    request_ += "],\"@extra\":1}";
+  }
+
+  void run(int n) final {
+    int sent_count = 0;
+    int received_count = 0;
+    while (received_count < n) {
+      while (sent_count < n && sent_count - received_count < MAX_PENDING_REQUESTS) {
+        sent_count++;
+        td::json_send(client_id_, request_);
+      }
+      auto response = td::json_receive(10.0);
+      CHECK(response != nullptr);
+      if (std::strstr(response, "\"@extra\":1") != nullptr) {
+        received_count++;
+      }
+    }
+  }
+
+ private:
+  int client_id_;
+  td::string request_;
+};
+
+// measures time from creation of a client with an empty database directory to the first authorization request
+static void bench_cold_start(int start_count) {
+  td::string database_directory = "bench_td_db";
+  td::vector<double> starts_per_second;
+  td::ClientManager client_manager;
+  for (int i = 0; i < start_count; i++) {
+    td::rmrf(database_directory).ignore();
+
+    auto start_time = td::Clocks::monotonic();
+    auto client_id = client_manager.create_client_id();
+    client_manager.send(client_id, 1,
+                        td::td_api::make_object<td::td_api::setTdlibParameters>(
+                            true, database_directory, td::string(), td::string(), true, true, true, false, 94575,
+                            "a3406de8d171bb422bb6ddf3bbd800e2", "en", "Desktop", "Unknown", "1.0"));
+    bool is_started = false;
+    bool is_closed = false;
+    while (!is_closed) {
+      auto response = client_manager.receive(100.0);
+      CHECK(response.object != nullptr);
+      if (response.client_id != client_id || response.object->get_id() != td::td_api::updateAuthorizationState::ID) {
+        continue;
+      }
+      auto &state = static_cast<const td::td_api::updateAuthorizationState &>(*response.object).authorization_state_;
+      switch (state->get_id()) {
+        case td::td_api::authorizationStateWaitPhoneNumber::ID:
+          if (!is_started) {
+            is_started = true;
+            starts_per_second.push_back(1 / (td::Clocks::monotonic() - start_time));
+            client_manager.send(client_id, 2, td::td_api::make_object<td::td_api::close>());
+          }
+          break;
+        case td::td_api::authorizationStateClosed::ID:
+          is_closed = true;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  td::rmrf(database_directory).ignore();
+
+  td::print_benchmark_result("TdColdStart", std::move(starts_per_second));
+}
+
+static td::uint64 get_resident_size() {
+  auto r_mem_stat = td::mem_stat();
+  return r_mem_stat.is_ok() ? r_mem_stat.ok().resident_size_ : 0;
+}
+
+// measures memory usage, request throughput and latency depending on the number of clients in the process
+static void bench_multiple_clients(int max_client_count) {
+  for (int client_count = 1; client_count <= max_client_count; client_count *= 10) {
+    auto begin_resident_size = get_resident_size();
+
+    td::ClientManager client_manager;
+    td::vector<td::ClientManager::ClientId> client_ids;
+    auto start_time = td::Clocks::monotonic();
+    for (int i = 0; i < client_count; i++) {
+      client_ids.push_back(client_manager.create_client_id());
+      client_manager.send(client_ids.back(), 1, td::td_api::make_object<td::td_api::testSquareInt>(i));
+    }
+    // wait for a response from each client to be sure that all of them are completely created
+    int created_client_count = 0;
+    while (created_client_count < client_count) {
+      auto response = client_manager.receive(100.0);
+      CHECK(response.object != nullptr);
+      if (response.request_id != 0) {
+        created_client_count++;
+      }
+    }
+    auto creation_time = td::Clocks::monotonic() - start_time;
+    auto end_resident_size = get_resident_size();
+    auto memory_per_client =
+        end_resident_size > begin_resident_size ? (end_resident_size - begin_resident_size) / client_count : 0;
+
+    // requests are spread evenly between the clients and are answered without network and database access
+    int request_count = td::max(10 * client_count, 100000);
+    td::vector<double> send_times(request_count + 1);
+    td::vector<double> latencies;
+    latencies.reserve(request_count);
+    int sent_count = 0;
+    start_time = td::Clocks::monotonic();
+    while (static_cast<int>(latencies.size()) < request_count) {
+      while (sent_count < request_count && sent_count - static_cast<int>(latencies.size()) < MAX_PENDING_REQUESTS) {
+        sent_count++;
+        td::td_api::object_ptr<td::td_api::Function> request;
+        if (sent_count % 2 == 0) {
+          request = td::td_api::make_object<td::td_api::testSquareInt>(sent_count);
+        } else {
+          request = td::td_api::make_object<td::td_api::testCallString>("request with a short string");
+        }
+        send_times[sent_count] = td::Clocks::monotonic();
+        client_manager.send(client_ids[sent_count % client_count], sent_count, std::move(request));
+      }
+      auto response = client_manager.receive(10.0);
+      CHECK(response.object != nullptr);
+      if (response.request_id != 0) {
+        CHECK(response.request_id <= static_cast<td::uint64>(request_count));
+        latencies.push_back(td::Clocks::monotonic() - send_times[static_cast<size_t>(response.request_id)]);
+      }
+    }
+    auto total_time = td::Clocks::monotonic() - start_time;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto get_latency_percentile = [&](size_t percent) {
+      return latencies[td::min(percent * latencies.size() / 100, latencies.size() - 1)];
+    };
+    td::print_benchmark_result("TdMultiClientRequests" + td::to_string(client_count), {request_count / total_time});
+    LOG(PLAIN) << "Clients: " << client_count << ", creation time per client: "
+               << td::format::as_time(creation_time / client_count)
+               << ", memory per client: " << td::format::as_size(memory_per_client)
+               << ", request latency p50: " << td::format::as_time(get_latency_percentile(50))
+               << ", p99: " << td::format::as_time(get_latency_percentile(99));
+  }
+}
+
+int main(int argc, char **argv) {
+  td::ClientManager::execute(td::td_api::make_object<td::td_api::setLogVerbosityLevel>(1));
+
+  bool need_cold_start = true;
+  int max_client_count = 1000;
+  for (int i = 1; i < argc; i++) {
+    if (td::Slice(argv[i]) == "--no-cold-start") {
+      need_cold_start = false;
+    } else if (td::Slice(argv[i]) == "--max-clients" && i + 1 < argc) {
+      max_client_count = td::to_integer<int>(td::Slice(argv[++i]));
+    }
+  }
+
+  td::bench(TdRequestBenchmark());
+  td::bench(TdJsonRequestBenchmark());
+  if (need_cold_start) {
+    bench_cold_start(10);
+  }
+  bench_multiple_clients(max_client_count);
+}
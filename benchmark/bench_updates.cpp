@@ -0,0 +1,166 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/telegram_api.h"
+
+#include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/filesystem.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/Clocks.h"
+#include "td/utils/port/sleep.h"
+#include "td/utils/port/Stat.h"
+#include "td/utils/Slice.h"
+#include "td/utils/StringBuilder.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/TsCerr.h"
+
+#include <cstdlib>
+#include <cstring>
+
+// replays update packets recorded by a client with the option "x_record_updates_path" set
+
+static void usage() {
+  td::TsCerr() << "Replays recorded update packets and reports their processing latency.\n";
+  td::TsCerr() << "Usage: bench_updates [options] <file>\n";
+  td::TsCerr() << "Options:\n";
+  td::TsCerr() << "  -s/--speed\tReplay speed relative to the recording; 0 replays as fast as possible (default is 0)\n";
+  td::TsCerr() << "  -h/--help\tDisplay this information\n";
+  std::exit(2);
+}
+
+struct RecordedPacket {
+  double receive_time = 0.0;
+  td::BufferSlice data;
+};
+
+static td::vector<RecordedPacket> parse_recorded_packets(td::Slice data) {
+  td::vector<RecordedPacket> result;
+  constexpr size_t HEADER_SIZE = sizeof(double) + sizeof(td::int32);
+  while (data.size() >= HEADER_SIZE) {
+    RecordedPacket packet;
+    td::int32 size;
+    std::memcpy(&packet.receive_time, data.data(), sizeof(double));
+    std::memcpy(&size, data.data() + sizeof(double), sizeof(td::int32));
+    data.remove_prefix(HEADER_SIZE);
+    if (size < 0 || static_cast<size_t>(size) > data.size()) {
+      LOG(ERROR) << "Recorded packet " << result.size() << " is truncated";
+      break;
+    }
+    packet.data = td::BufferSlice(data.substr(0, size));
+    data.remove_prefix(size);
+    result.push_back(std::move(packet));
+  }
+  return result;
+}
+
+int main(int argc, char **argv) {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+
+  double speed = 0.0;
+  td::string path;
+  for (int i = 1; i < argc; i++) {
+    td::Slice arg(argv[i]);
+    if (arg == "-s" || arg == "--speed") {
+      if (i + 1 == argc) {
+        usage();
+      }
+      speed = td::to_double(td::Slice(argv[++i]));
+    } else if (td::begins_with(arg, "-") || !path.empty()) {
+      usage();
+    } else {
+      path = arg.str();
+    }
+  }
+  if (path.empty() || speed < 0) {
+    usage();
+  }
+
+  auto r_data = td::read_file(path);
+  if (r_data.is_error()) {
+    LOG(ERROR) << "Failed to read " << path << ": " << r_data.error();
+    return 1;
+  }
+  auto packets = parse_recorded_packets(r_data.ok().as_slice());
+  if (packets.empty()) {
+    LOG(ERROR) << "There are no recorded packets in " << path;
+    return 1;
+  }
+
+  size_t update_count = 0;
+  size_t failed_packet_count = 0;
+  size_t max_queue_size = 0;
+  double total_latency = 0.0;
+  double max_latency = 0.0;
+  double total_processing_time = 0.0;
+
+  auto first_receive_time = packets[0].receive_time;
+  auto start_time = td::Clocks::monotonic();
+  auto get_scheduled_time = [&](const RecordedPacket &packet) {
+    if (speed == 0.0) {
+      return start_time;
+    }
+    return start_time + (packet.receive_time - first_receive_time) / speed;
+  };
+  for (size_t i = 0; i < packets.size(); i++) {
+    auto scheduled_time = get_scheduled_time(packets[i]);
+    auto now = td::Clocks::monotonic();
+    if (scheduled_time > now) {
+      td::usleep_for(static_cast<td::int32>((scheduled_time - now) * 1e6));
+      now = td::Clocks::monotonic();
+    }
+
+    // packets, which had to be already received, are waiting in the queue
+    size_t queue_size = 1;
+    while (speed != 0.0 && i + queue_size < packets.size() && get_scheduled_time(packets[i + queue_size]) <= now) {
+      queue_size++;
+    }
+    max_queue_size = td::max(max_queue_size, queue_size);
+
+    td::TlBufferParser parser(&packets[i].data);
+    auto updates = td::telegram_api::Updates::fetch(parser);
+    parser.fetch_end();
+    if (parser.get_error() != nullptr) {
+      failed_packet_count++;
+    } else {
+      switch (updates->get_id()) {
+        case td::telegram_api::updates::ID:
+          update_count += static_cast<const td::telegram_api::updates *>(updates.get())->updates_.size();
+          break;
+        case td::telegram_api::updatesCombined::ID:
+          update_count += static_cast<const td::telegram_api::updatesCombined *>(updates.get())->updates_.size();
+          break;
+        default:
+          update_count++;
+          break;
+      }
+    }
+    updates = nullptr;
+
+    auto finish_time = td::Clocks::monotonic();
+    auto latency = finish_time - (speed == 0.0 ? now : scheduled_time);
+    total_latency += latency;
+    max_latency = td::max(max_latency, latency);
+    total_processing_time += finish_time - now;
+  }
+  auto total_time = td::Clocks::monotonic() - start_time;
+
+  td::uint64 resident_size_peak = 0;
+  auto r_mem_stat = td::mem_stat();
+  if (r_mem_stat.is_ok()) {
+    resident_size_peak = r_mem_stat.ok().resident_size_peak_;
+  }
+
+  LOG(ERROR) << "Replayed " << packets.size() << " packets with " << update_count << " updates in "
+             << td::StringBuilder::FixedDouble(total_time, 3) << " seconds, failed to parse " << failed_packet_count
+             << " packets";
+  LOG(ERROR) << "Processing: " << td::StringBuilder::FixedDouble(packets.size() / total_processing_time, 3)
+             << " packets/sec, latency average "
+             << td::StringBuilder::FixedDouble(total_latency / packets.size() * 1e6, 3) << " us, maximum "
+             << td::StringBuilder::FixedDouble(max_latency * 1e6, 3) << " us, maximum queue size " << max_queue_size
+             << ", peak resident size " << (resident_size_peak >> 20) << " MB";
+}
@@ -830,6 +830,7 @@ class TdClient {
       query['@type'] === 'getLogVerbosityLevel' ||
       query['@type'] === 'setLogTagVerbosityLevel' ||
       query['@type'] === 'getLogTagVerbosityLevel' ||
+      query['@type'] === 'setLogTagSampling' ||
       query['@type'] === 'getLogTags'
     ) {
       this.execute(query);
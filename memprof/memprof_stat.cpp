@@ -11,10 +11,12 @@
 #if (TD_DARWIN || TD_LINUX)
 #include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <new>
 #include <utility>
 #include <vector>
@@ -34,6 +36,8 @@ bool is_memprof_on() {
 struct malloc_info {
   std::int32_t magic;
   std::int32_t size;
+  std::int32_t sample_pos;      // position of the call site in sampled_ht or -1 if the allocation isn't sampled
+  std::uint32_t sample_weight;  // estimated size of allocations represented by the sampled allocation
 };
 
 static std::atomic<std::size_t> total_memory_used;
@@ -49,6 +53,156 @@ std::size_t get_used_memory_size() {
   return total_memory_used.load();
 }
 
+static constexpr std::size_t MAX_SAMPLE_RATE = 1 << 30;
+static std::atomic<std::size_t> memprof_sample_rate{0};
+
+void set_memprof_sample_rate(std::size_t sample_rate) {
+  memprof_sample_rate.store(std::min(sample_rate, MAX_SAMPLE_RATE), std::memory_order_relaxed);
+}
+
+std::size_t get_memprof_sample_rate() {
+  return memprof_sample_rate.load(std::memory_order_relaxed);
+}
+
+// allocations made before initialization of static variables are never sampled
+static bool init_memprof_sample_rate() {
+  const char *sample_rate = std::getenv("TD_MEMPROF_SAMPLE_RATE");
+  if (sample_rate != nullptr) {
+    set_memprof_sample_rate(static_cast<std::size_t>(std::strtoull(sample_rate, nullptr, 10)));
+  }
+  return true;
+}
+static bool is_memprof_sample_rate_inited = init_memprof_sample_rate();
+
+// number of frames of the allocator itself in the beginning of a backtrace
+static constexpr std::size_t SAMPLED_BACKTRACE_SHIFT = 1;
+
+static SampledBacktrace get_sampled_backtrace() {
+  std::array<void *, SAMPLED_BACKTRACE_LENGTH + SAMPLED_BACKTRACE_SHIFT> tmp{{nullptr}};
+  auto n = static_cast<std::size_t>(backtrace(tmp.data(), static_cast<int>(tmp.size())));
+  SampledBacktrace res{{nullptr}};
+  for (std::size_t i = SAMPLED_BACKTRACE_SHIFT; i < n; i++) {
+    res[i - SAMPLED_BACKTRACE_SHIFT] = tmp[i];
+  }
+  return res;
+}
+
+static std::uint64_t get_hash(const SampledBacktrace &bt) {
+  std::uint64_t h = 7;
+  for (auto *ip : bt) {
+    h = h * 0x4372897893428797lu + reinterpret_cast<std::uintptr_t>(ip);
+  }
+  return h == 0 ? 1 : h;
+}
+
+struct SampledHashtableNode {
+  std::atomic<std::uint64_t> hash;
+  SampledBacktrace backtrace;
+  std::atomic<std::size_t> size;
+  std::atomic<std::size_t> count;
+};
+
+static constexpr std::size_t SAMPLED_HT_MAX_SIZE = 1 << 16;
+static std::atomic<std::size_t> sampled_ht_size{0};
+static std::array<SampledHashtableNode, SAMPLED_HT_MAX_SIZE> sampled_ht;
+
+static std::int32_t get_sampled_ht_pos(const SampledBacktrace &bt, bool force = false) {
+  auto hash = get_hash(bt);
+  auto pos = static_cast<std::size_t>(hash % sampled_ht.size());
+  while (true) {
+    auto pos_hash = sampled_ht[pos].hash.load();
+    if (pos_hash == 0) {
+      if (sampled_ht_size > SAMPLED_HT_MAX_SIZE / 2 && !force) {
+        // too many call sites; account the rest of them together
+        SampledBacktrace unknown_bt{{nullptr}};
+        unknown_bt[0] = reinterpret_cast<void *>(1);
+        return get_sampled_ht_pos(unknown_bt, true);
+      }
+
+      std::uint64_t expected = 0;
+      if (sampled_ht[pos].hash.compare_exchange_strong(expected, hash)) {
+        sampled_ht[pos].backtrace = bt;
+        ++sampled_ht_size;
+        return static_cast<std::int32_t>(pos);
+      }
+    } else if (pos_hash == hash) {
+      return static_cast<std::int32_t>(pos);
+    } else {
+      pos++;
+      if (pos == sampled_ht.size()) {
+        pos = 0;
+      }
+    }
+  }
+}
+
+static __thread std::size_t bytes_until_sample;     // static zero-initialized
+static __thread std::uint64_t sample_random_state;  // static zero-initialized
+static __thread bool in_sample_alloc;               // static zero-initialized
+
+// returns an exponentially distributed distance in bytes to the next sampled allocation with the mean of sample_rate,
+// so each allocated byte is sampled independently with probability 1 / sample_rate
+static std::size_t get_next_sample_distance(std::size_t sample_rate) {
+  auto &x = sample_random_state;
+  if (x == 0) {
+    x = reinterpret_cast<std::uintptr_t>(&x) | 1;
+  }
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  auto uniform = (static_cast<double>(x >> 11) + 0.5) / static_cast<double>(static_cast<std::uint64_t>(1) << 53);
+  return 1 + static_cast<std::size_t>(-std::log(uniform) * static_cast<double>(sample_rate));
+}
+
+static void maybe_sample_alloc(malloc_info *info) {
+  info->sample_pos = -1;
+  info->sample_weight = 0;
+  auto sample_rate = memprof_sample_rate.load(std::memory_order_relaxed);
+  if (sample_rate == 0 || in_sample_alloc) {
+    return;
+  }
+  if (bytes_until_sample == 0) {
+    bytes_until_sample = get_next_sample_distance(sample_rate);
+  }
+  auto size = static_cast<std::size_t>(info->size);
+  if (bytes_until_sample > size) {
+    bytes_until_sample -= size;
+    return;
+  }
+
+  // the allocation is sampled with probability 1 - exp(-size / sample_rate), so it represents size / probability bytes
+  in_sample_alloc = true;
+  bytes_until_sample = get_next_sample_distance(sample_rate);
+  auto scaled_size = static_cast<double>(size) / static_cast<double>(sample_rate);
+  auto weight = scaled_size < 1e-9 ? static_cast<double>(sample_rate)
+                                   : static_cast<double>(size) / -std::expm1(-scaled_size);
+  info->sample_weight = static_cast<std::uint32_t>(std::min(weight, 4294967295.0));
+  info->sample_pos = get_sampled_ht_pos(get_sampled_backtrace());
+  auto &node = sampled_ht[info->sample_pos];
+  node.size.fetch_add(info->sample_weight, std::memory_order_relaxed);
+  node.count.fetch_add(1, std::memory_order_relaxed);
+  in_sample_alloc = false;
+}
+
+static void unregister_sampled_alloc(const malloc_info *info) {
+  if (info->sample_pos < 0) {
+    return;
+  }
+  auto &node = sampled_ht[info->sample_pos];
+  node.size.fetch_sub(info->sample_weight, std::memory_order_relaxed);
+  node.count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void dump_sampled_alloc(const std::function<void(const SampledAllocInfo &)> &func) {
+  for (auto &node : sampled_ht) {
+    auto count = node.count.load(std::memory_order_relaxed);
+    if (count == 0) {
+      continue;
+    }
+    func(SampledAllocInfo{node.backtrace, node.size.load(std::memory_order_relaxed), count});
+  }
+}
+
 extern "C" {
 
 static constexpr std::size_t RESERVED_SIZE = 16;
@@ -71,6 +225,7 @@ static void *do_malloc(std::size_t size) {
   info->size = static_cast<std::int32_t>(size);
 
   register_xalloc(info, +1);
+  maybe_sample_alloc(info);
 
   void *data = buf + RESERVED_SIZE;
 
@@ -96,6 +251,7 @@ void free(void *data_void) {
   }
   auto *info = get_info(data_void);
   register_xalloc(info, -1);
+  unregister_sampled_alloc(info);
 
 #if TD_DARWIN
   static void *free_void = dlsym(RTLD_NEXT, "free");
@@ -163,4 +319,11 @@ bool is_memprof_on() {
 std::size_t get_used_memory_size() {
   return 0;
 }
+void set_memprof_sample_rate(std::size_t sample_rate) {
+}
+std::size_t get_memprof_sample_rate() {
+  return 0;
+}
+void dump_sampled_alloc(const std::function<void(const SampledAllocInfo &)> &func) {
+}
 #endif
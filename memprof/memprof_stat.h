@@ -6,8 +6,28 @@
 //
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <functional>
+
+constexpr std::size_t SAMPLED_BACKTRACE_LENGTH = 10;
+
+using SampledBacktrace = std::array<void *, SAMPLED_BACKTRACE_LENGTH>;
+struct SampledAllocInfo {
+  SampledBacktrace backtrace;
+  std::size_t size;   // estimated total size of live allocations from the call site
+  std::size_t count;  // number of live sampled allocations from the call site
+};
 
 bool is_memprof_on();
 
 std::size_t get_used_memory_size();
+
+// starts to sample on average one allocation per sample_rate allocated bytes; 0 disables sampling of new allocations
+// the initial value is taken from the environment variable TD_MEMPROF_SAMPLE_RATE
+void set_memprof_sample_rate(std::size_t sample_rate);
+
+std::size_t get_memprof_sample_rate();
+
+// returns a snapshot of the live heap by call site, built from sampled allocations; can be called from any thread
+void dump_sampled_alloc(const std::function<void(const SampledAllocInfo &)> &func);
@@ -303,11 +303,12 @@ std::string TD_TL_writer_jni_cpp::gen_type_store(const std::string &field_name,
     if (storer_type == 1) {
       res = "s.store_field(\"" + get_pretty_field_name(field_name) + "\", " + field_name + ");";
     } else if (name == "Bool") {
-      res = "env->SetBooleanField(s, " + field_name + "fieldID, " + field_name + ");";
+      // fields of an object returned by AllocObject are zero-initialized, so there is no need to store zero values
+      res = "if (" + field_name + ") { env->SetBooleanField(s, " + field_name + "fieldID, JNI_TRUE); }";
     } else if (name == "Int32") {
-      res = "env->SetIntField(s, " + field_name + "fieldID, " + field_name + ");";
+      res = "if (" + field_name + " != 0) { env->SetIntField(s, " + field_name + "fieldID, " + field_name + "); }";
     } else if (name == "Int53" || name == "Int64") {
-      res = "env->SetLongField(s, " + field_name + "fieldID, " + field_name + ");";
+      res = "if (" + field_name + " != 0) { env->SetLongField(s, " + field_name + "fieldID, " + field_name + "); }";
     } else if (name == "Double") {
       res = "env->SetDoubleField(s, " + field_name + "fieldID, " + field_name + ");";
     } else if (name == "String") {
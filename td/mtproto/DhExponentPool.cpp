@@ -0,0 +1,98 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/mtproto/DhExponentPool.h"
+
+#include "td/utils/port/thread.h"
+
+#include <mutex>
+#include <utility>
+
+namespace td {
+namespace mtproto {
+
+namespace {
+
+class DhExponentPoolImpl {
+ public:
+  bool get_exponent(int32 g_int, Slice prime_str, BigNum &b, BigNum &g_b) {
+#if TD_THREAD_UNSUPPORTED
+    return false;
+#else
+    std::lock_guard<std::mutex> guard(mutex_);
+    bool is_found = false;
+    if (g_int_ == g_int && prime_str_ == prime_str) {
+      if (!exponents_.empty()) {
+        b = std::move(exponents_.back().first);
+        g_b = std::move(exponents_.back().second);
+        exponents_.pop_back();
+        is_found = true;
+      }
+    } else {
+      // Telegram servers use the same prime for all keys, so there is no need to keep exponents for other primes
+      g_int_ = g_int;
+      prime_str_ = prime_str.str();
+      exponents_.clear();
+    }
+    if (!is_generating_ && exponents_.size() < MIN_EXPONENT_COUNT) {
+      is_generating_ = true;
+      td::thread([this] { run_generator(); }).detach();
+    }
+    return is_found;
+#endif
+  }
+
+ private:
+  static constexpr size_t MIN_EXPONENT_COUNT = 16;
+  static constexpr size_t MAX_EXPONENT_COUNT = 64;
+
+  std::mutex mutex_;
+  int32 g_int_ = 0;
+  string prime_str_;
+  vector<std::pair<BigNum, BigNum>> exponents_;
+  bool is_generating_ = false;
+
+  void run_generator() {
+    BigNumContext ctx;
+    while (true) {
+      int32 g_int;
+      string prime_str;
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (exponents_.size() >= MAX_EXPONENT_COUNT) {
+          is_generating_ = false;
+          return;
+        }
+        g_int = g_int_;
+        prime_str = prime_str_;
+      }
+
+      BigNum b;
+      BigNum::random(b, 2048, -1, 0);
+
+      BigNum g;
+      g.set_value(g_int);
+      BigNum g_b;
+      BigNum::mod_exp(g_b, g, b, BigNum::from_binary(prime_str), ctx);
+
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (g_int_ == g_int && prime_str_ == prime_str) {
+        exponents_.emplace_back(std::move(b), std::move(g_b));
+      }
+    }
+  }
+};
+
+}  // namespace
+
+bool DhExponentPool::get_exponent(int32 g_int, Slice prime_str, BigNum &b, BigNum &g_b) {
+  // the pool is never destroyed, because the generator thread can still use it during program exit
+  static auto *pool = new DhExponentPoolImpl();
+  return pool->get_exponent(g_int, prime_str, b, g_b);
+}
+
+}  // namespace mtproto
+}  // namespace td
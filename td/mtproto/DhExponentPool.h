@@ -0,0 +1,25 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/BigNum.h"
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+namespace td {
+namespace mtproto {
+
+// Process-wide pool of random Diffie-Hellman exponents together with the corresponding powers of g,
+// which are generated in advance in a background thread. Each exponent is returned at most once.
+class DhExponentPool {
+ public:
+  // returns false if there are no ready exponents for the given g and prime; the pool is refilled in the background
+  static bool get_exponent(int32 g_int, Slice prime_str, BigNum &b, BigNum &g_b);
+};
+
+}  // namespace mtproto
+}  // namespace td
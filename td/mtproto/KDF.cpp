@@ -72,23 +72,17 @@ void tmp_KDF(const UInt128 &server_nonce, const UInt256 &new_nonce, UInt256 *tmp
 }
 
 void KDF2(Slice auth_key, const UInt128 &msg_key, int X, UInt256 *aes_key, UInt256 *aes_iv) {
-  uint8 buf_raw[36 + 16];
-  MutableSlice buf(buf_raw, 36 + 16);
   Slice msg_key_slice = as_slice(msg_key);
 
   // sha256_a = SHA256 (msg_key + substr(auth_key, x, 36));
-  buf.copy_from(msg_key_slice);
-  buf.substr(16, 36).copy_from(auth_key.substr(X, 36));
   uint8 sha256_a_raw[32];
   MutableSlice sha256_a(sha256_a_raw, 32);
-  sha256(buf, sha256_a);
+  sha256(msg_key_slice, auth_key.substr(X, 36), sha256_a);
 
   // sha256_b = SHA256 (substr(auth_key, 40+x, 36) + msg_key);
-  buf.copy_from(auth_key.substr(40 + X, 36));
-  buf.substr(36).copy_from(msg_key_slice);
   uint8 sha256_b_raw[32];
   MutableSlice sha256_b(sha256_b_raw, 32);
-  sha256(buf, sha256_b);
+  sha256(auth_key.substr(40 + X, 36), msg_key_slice, sha256_b);
 
   // aes_key = substr(sha256_a, 0, 8) + substr(sha256_b, 8, 16) + substr(sha256_a, 24, 8);
   MutableSlice aes_key_slice(aes_key->raw, sizeof(aes_key->raw));
@@ -55,6 +55,10 @@ class RawConnectionDefault final : public RawConnection {
     return transport_->can_write();
   }
 
+  size_t get_pending_write_size() const final {
+    return socket_fd_.left_unwritten();
+  }
+
   TransportType get_transport_type() const final {
     return transport_->get_type();
   }
@@ -295,6 +299,11 @@ class RawConnectionHttp final : public RawConnection {
     return mode_ == Send;
   }
 
+  size_t get_pending_write_size() const final {
+    // all packets are passed to DarwinHttp during flush
+    return 0;
+  }
+
   TransportType get_transport_type() const final {
     return mtproto::TransportType{mtproto::TransportType::Http, 0, mtproto::ProxySecret()};
   }
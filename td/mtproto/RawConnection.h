@@ -47,6 +47,8 @@ class RawConnection {
   virtual void set_connection_token(ConnectionManager::ConnectionToken connection_token) = 0;
 
   virtual bool can_send() const = 0;
+  // returns size of the data, which wasn't sent to the network during the last flush
+  virtual size_t get_pending_write_size() const = 0;
   virtual TransportType get_transport_type() const = 0;
   virtual size_t send_crypto(const Storer &storer, uint64 session_id, int64 salt, const AuthKey &auth_key,
                              uint64 quick_ack_token) = 0;
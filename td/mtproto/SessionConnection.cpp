@@ -665,10 +665,15 @@ bool SessionConnection::must_flush_packet() {
   }
   // queries and acks (+ resend & get_info)
   if (has_salt && force_send_at_ != 0) {
-    if (Time::now_cached() > force_send_at_) {
+    auto send_at = force_send_at_;
+    if (is_write_blocked()) {
+      // the packet can't be sent now anyway, so wait a little to pack more messages in the container
+      send_at += WRITE_BLOCKED_DELAY;
+    }
+    if (Time::now_cached() > send_at) {
       return true;
     } else {
-      relax_timeout_at(&flush_packet_at_, force_send_at_);
+      relax_timeout_at(&flush_packet_at_, send_at);
     }
   }
 
@@ -816,7 +821,8 @@ Result<MessageId> SessionConnection::send_query(BufferSlice buffer, bool gzip_fl
   }
   auto seq_no = auth_data_->next_seq_no(true);
   if (to_send_.empty()) {
-    send_before(Time::now_cached() + QUERY_DELAY);
+    // send the query without delay if the connection is idle
+    send_before(Time::now_cached() + (raw_connection_->get_pending_write_size() == 0 ? 0.0 : QUERY_DELAY));
   }
   to_send_.push_back(MtprotoQuery{message_id, seq_no, std::move(buffer), gzip_flag, std::move(invoke_after_message_ids),
                                   use_quick_ack});
@@ -947,9 +953,10 @@ void SessionConnection::flush_packet() {
   static constexpr size_t MAX_QUERY_COUNT = 1000;
   size_t send_till = 0;
   size_t send_size = 0;
+  size_t max_container_size = get_max_container_size();
   if (has_salt) {
-    // send at most MAX_QUERY_COUNT queries, of total size up to 2^15
-    while (send_till < to_send_.size() && send_till < MAX_QUERY_COUNT && send_size < (1 << 15)) {
+    // send at most MAX_QUERY_COUNT queries, of total size up to max_container_size
+    while (send_till < to_send_.size() && send_till < MAX_QUERY_COUNT && send_size < max_container_size) {
       send_size += to_send_[send_till].packet.size();
       send_till++;
     }
@@ -977,7 +984,8 @@ void SessionConnection::flush_packet() {
     destroy_auth_key_send_time_ = Time::now();
   }
 
-  VLOG(mtproto) << "Sent packet: " << tag("query_count", queries.size()) << tag("ack_count", to_ack_message_ids_.size())
+  VLOG(mtproto) << "Sent packet: " << tag("query_count", queries.size()) << tag("query_size", send_size)
+                << tag("max_container_size", max_container_size) << tag("ack_count", to_ack_message_ids_.size())
                 << tag("ping", ping_id != 0) << tag("http_wait", max_delay >= 0)
                 << tag("future_salt", future_salt_n > 0) << tag("get_info", to_get_state_info_message_ids_.size())
                 << tag("resend", to_resend_answer_message_ids_.size())
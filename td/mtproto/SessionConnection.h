@@ -121,6 +121,12 @@ class SessionConnection final
   static constexpr int ACK_DELAY = 30;                  // 30s
   static constexpr double QUERY_DELAY = 0.001;          // 0.001s
   static constexpr double RESEND_ANSWER_DELAY = 0.001;  // 0.001s
+  static constexpr double WRITE_BLOCKED_DELAY = 0.05;   // 0.05s
+  static constexpr double HIGH_RTT = 1.0;               // 1s
+
+  static constexpr size_t MAX_CONTAINER_SIZE = 1 << 15;
+  static constexpr size_t MAX_BIG_CONTAINER_SIZE = 1 << 17;
+  static constexpr size_t WRITE_BLOCKED_SIZE = 1 << 14;
 
   struct MsgInfo {
     MessageId message_id;
@@ -138,6 +144,16 @@ class SessionConnection final
     return max(2.0, raw_connection_->extra().rtt * 1.5 + 1);
   }
 
+  // the previously sent packets are still waiting in the send buffer
+  bool is_write_blocked() const {
+    return raw_connection_->get_pending_write_size() >= WRITE_BLOCKED_SIZE;
+  }
+
+  // bigger containers reduce the number of packets if they can't be sent immediately anyway
+  size_t get_max_container_size() const {
+    return is_write_blocked() || raw_connection_->extra().rtt >= HIGH_RTT ? MAX_BIG_CONTAINER_SIZE : MAX_CONTAINER_SIZE;
+  }
+
   double read_disconnect_delay() const {
     return online_flag_ ? rtt() * 3.5 : 135 + random_delay_;
   }
@@ -153,67 +153,73 @@ Result<size_t> ObfuscatedTransport::read_next(BufferSlice *message, uint32 *quic
 
 void ObfuscatedTransport::write(BufferWriter &&message, bool quick_ack) {
   impl_.write_prepare_inplace(&message, quick_ack);
-  output_state_.encrypt(message.as_slice(), message.as_mutable_slice());
   if (secret_.emulate_tls()) {
-    do_write_tls(std::move(message));
+    do_write_tls(message.as_slice());
   } else {
     do_write_main(std::move(message));
   }
 }
 
 void ObfuscatedTransport::do_write_main(BufferWriter &&message) {
-  BufferBuilder builder(std::move(message));
   if (!header_.empty()) {
-    builder.prepend(header_);
+    output_->append(Slice(header_));
     header_ = {};
   }
-  do_write(builder.extract());
-}
 
-void ObfuscatedTransport::do_write_tls(BufferWriter &&message) {
-  CHECK(header_.size() <= MAX_TLS_PACKET_LENGTH);
-  if (message.size() + header_.size() > MAX_TLS_PACKET_LENGTH) {
-    auto buffer_slice = message.as_buffer_slice();
-    auto slice = buffer_slice.as_slice();
-    while (!slice.empty()) {
-      auto buf = buffer_slice.from_slice(slice.substr(0, MAX_TLS_PACKET_LENGTH - header_.size()));
-      slice.remove_prefix(buf.size());
-      BufferBuilder builder;
-      builder.append(std::move(buf));
-      do_write_tls(std::move(builder));
-    }
+  auto data = message.as_mutable_slice();
+  auto ready = output_->prepare_append_inplace();
+  if (ready.size() >= data.size()) {
+    // the message fits into the already allocated output buffer, so encrypt it there directly
+    output_state_.encrypt(data, ready.substr(0, data.size()));
+    output_->confirm_append(data.size());
     return;
   }
 
-  BufferBuilder builder(std::move(message));
-  do_write_tls(std::move(builder));
+  // encrypt the message in place and link it to the output buffer without copying
+  output_state_.encrypt(data, data);
+  output_->append(message.as_buffer_slice());
 }
 
-void ObfuscatedTransport::do_write_tls(BufferBuilder &&builder) {
-  if (!header_.empty()) {
-    builder.prepend(header_);
-    header_ = {};
+void ObfuscatedTransport::do_write_tls(Slice data) {
+  CHECK(header_.size() < MAX_TLS_PACKET_LENGTH);
+  static constexpr size_t TLS_RECORD_HEADER_SIZE = 5;
+  Slice first_prefix("\x14\x03\x03\x00\x01\x01");
+
+  // reserve space for all TLS records at once, so they are written to a single output buffer chunk
+  auto first_record_data_size = min(data.size(), MAX_TLS_PACKET_LENGTH - header_.size());
+  auto record_count = 1 + (data.size() - first_record_data_size + MAX_TLS_PACKET_LENGTH - 1) / MAX_TLS_PACKET_LENGTH;
+  auto total_size = data.size() + header_.size() + record_count * TLS_RECORD_HEADER_SIZE;
+  if (is_first_tls_packet_) {
+    total_size += first_prefix.size();
   }
+  output_->prepare_append_at_least(total_size);
 
-  size_t size = builder.size();
-  CHECK(size <= MAX_TLS_PACKET_LENGTH);
+  while (!data.empty()) {
+    auto part = data.substr(0, MAX_TLS_PACKET_LENGTH - header_.size());
+    data.remove_prefix(part.size());
 
-  char buf[] = "\x17\x03\x03\x00\x00";
-  buf[3] = static_cast<char>((size >> 8) & 0xff);
-  buf[4] = static_cast<char>(size & 0xff);
-  builder.prepend(Slice(buf, 5));
+    if (is_first_tls_packet_) {
+      is_first_tls_packet_ = false;
+      output_->append(first_prefix);
+    }
 
-  if (is_first_tls_packet_) {
-    is_first_tls_packet_ = false;
-    Slice first_prefix("\x14\x03\x03\x00\x01\x01");
-    builder.prepend(first_prefix);
-  }
+    size_t size = header_.size() + part.size();
+    CHECK(size <= MAX_TLS_PACKET_LENGTH);
+    char buf[] = "\x17\x03\x03\x00\x00";
+    buf[3] = static_cast<char>((size >> 8) & 0xff);
+    buf[4] = static_cast<char>(size & 0xff);
+    output_->append(Slice(buf, TLS_RECORD_HEADER_SIZE));
 
-  do_write(builder.extract());
-}
+    if (!header_.empty()) {
+      output_->append(Slice(header_));
+      header_ = {};
+    }
 
-void ObfuscatedTransport::do_write(BufferSlice &&message) {
-  output_->append(std::move(message));
+    // encrypt the data directly into the output buffer
+    auto dest = output_->prepare_append_at_least(part.size()).substr(0, part.size());
+    output_state_.encrypt(part, dest);
+    output_->confirm_append(part.size());
+  }
 }
 
 }  // namespace tcp
@@ -159,7 +159,7 @@ class ObfuscatedTransport final : public IStreamTransport {
   ByteFlowSink byte_flow_sink_;
   ChainBufferReader *input_ = nullptr;
 
-  static constexpr int32 MAX_TLS_PACKET_LENGTH = 2878;
+  static constexpr size_t MAX_TLS_PACKET_LENGTH = 2878;
 
   // TODO: use ByteFlow?
   // One problem is that BufferedFd owns output_buffer_
@@ -168,10 +168,8 @@ class ObfuscatedTransport final : public IStreamTransport {
   AesCtrState output_state_;
   ChainBufferWriter *output_ = nullptr;
 
-  void do_write_tls(BufferWriter &&message);
-  void do_write_tls(BufferBuilder &&builder);
+  void do_write_tls(Slice data);
   void do_write_main(BufferWriter &&message);
-  void do_write(BufferSlice &&message);
 };
 
 using Transport = ObfuscatedTransport;
@@ -209,6 +209,8 @@ class AuthManager final : public NetActor {
   void on_reset_email_address_result(NetQueryPtr &&net_query);
   void on_request_qr_code_result(NetQueryPtr &&net_query, bool is_import);
   void on_get_password_result(NetQueryPtr &&net_query);
+  void on_get_input_check_password(uint64 query_id,
+                                   Result<tl_object_ptr<telegram_api::InputCheckPasswordSRP>> r_hash);
   void on_request_password_recovery_result(NetQueryPtr &&net_query);
   void on_check_password_recovery_code_result(NetQueryPtr &&net_query);
   void on_request_firebase_sms_result(NetQueryPtr &&net_query);
@@ -111,20 +111,22 @@ class GetBotCommandsQuery final : public Td::ResultHandler {
 
 BotCommand::BotCommand(telegram_api::object_ptr<telegram_api::botCommand> &&bot_command) {
   CHECK(bot_command != nullptr);
-  command_ = std::move(bot_command->command_);
-  description_ = std::move(bot_command->description_);
+  command_ = get_shared_string(bot_command->command_);
+  description_ = get_shared_string(bot_command->description_);
 }
 
 td_api::object_ptr<td_api::botCommand> BotCommand::get_bot_command_object() const {
-  return td_api::make_object<td_api::botCommand>(command_, description_);
+  return td_api::make_object<td_api::botCommand>(command_.as_slice().str(), description_.as_slice().str());
 }
 
 telegram_api::object_ptr<telegram_api::botCommand> BotCommand::get_input_bot_command() const {
-  return telegram_api::make_object<telegram_api::botCommand>(command_, description_);
+  return telegram_api::make_object<telegram_api::botCommand>(command_.as_slice().str(),
+                                                             description_.as_slice().str());
 }
 
 bool operator==(const BotCommand &lhs, const BotCommand &rhs) {
-  return lhs.command_ == rhs.command_ && lhs.description_ == rhs.description_;
+  return lhs.command_.as_slice() == rhs.command_.as_slice() &&
+         lhs.description_.as_slice() == rhs.description_.as_slice();
 }
 
 BotCommands::BotCommands(UserId bot_user_id, vector<telegram_api::object_ptr<telegram_api::botCommand>> &&bot_commands)
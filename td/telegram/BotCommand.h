@@ -6,28 +6,42 @@
 //
 #pragma once
 
+#include "td/telegram/misc.h"
 #include "td/telegram/td_api.h"
 #include "td/telegram/telegram_api.h"
 #include "td/telegram/UserId.h"
 
 #include "td/utils/common.h"
 #include "td/utils/Promise.h"
+#include "td/utils/SharedSlice.h"
 #include "td/utils/tl_helpers.h"
 
 namespace td {
 
 class Td;
 
+// commands of a bot are duplicated in every chat with the bot, so their texts are kept in the shared string pool
 class BotCommand {
-  string command_;
-  string description_;
+  SharedSlice command_;
+  SharedSlice description_;
 
   friend bool operator==(const BotCommand &lhs, const BotCommand &rhs);
 
  public:
   BotCommand() = default;
-  BotCommand(string command, string description) : command_(std::move(command)), description_(std::move(description)) {
+  BotCommand(Slice command, Slice description)
+      : command_(get_shared_string(command)), description_(get_shared_string(description)) {
   }
+  BotCommand(const BotCommand &other) : command_(other.command_.clone()), description_(other.description_.clone()) {
+  }
+  BotCommand &operator=(const BotCommand &other) {
+    command_ = other.command_.clone();
+    description_ = other.description_.clone();
+    return *this;
+  }
+  BotCommand(BotCommand &&) = default;
+  BotCommand &operator=(BotCommand &&) = default;
+  ~BotCommand() = default;
   explicit BotCommand(telegram_api::object_ptr<telegram_api::botCommand> &&bot_command);
 
   td_api::object_ptr<td_api::botCommand> get_bot_command_object() const;
@@ -36,14 +50,18 @@ class BotCommand {
 
   template <class StorerT>
   void store(StorerT &storer) const {
-    td::store(command_, storer);
-    td::store(description_, storer);
+    td::store(command_.as_slice(), storer);
+    td::store(description_.as_slice(), storer);
   }
 
   template <class ParserT>
   void parse(ParserT &parser) {
-    td::parse(command_, parser);
-    td::parse(description_, parser);
+    string command;
+    string description;
+    td::parse(command, parser);
+    td::parse(description, parser);
+    command_ = get_shared_string(command);
+    description_ = get_shared_string(description);
   }
 };
 
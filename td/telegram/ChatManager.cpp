@@ -22,6 +22,7 @@
 #include "td/telegram/InputGroupCallId.h"
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/logevent/LogEventHelper.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageSender.h"
 #include "td/telegram/MessagesManager.h"
 #include "td/telegram/MessageTtl.h"
@@ -4458,6 +4459,43 @@ bool ChatManager::have_channel_force(ChannelId channel_id, const char *source) {
   return get_channel_force(channel_id, source) != nullptr;
 }
 
+void ChatManager::preload_channels_from_database(const vector<tl_object_ptr<telegram_api::Chat>> &chats) {
+  if (!G()->use_chat_info_database() || chats.size() <= 1) {
+    return;
+  }
+
+  // find min-channels, which will be synchronously loaded from the database by on_get_channel
+  vector<ChannelId> channel_ids;
+  for (auto &chat : chats) {
+    if (chat->get_id() != telegram_api::channel::ID) {
+      continue;
+    }
+    auto channel = static_cast<const telegram_api::channel *>(chat.get());
+    if ((channel->flags_ & CHANNEL_FLAG_IS_MIN) == 0 && channel->flags_ != 0) {
+      continue;
+    }
+    ChannelId channel_id(channel->id_);
+    if (channel_id.is_valid() && get_channel(channel_id) == nullptr &&
+        loaded_from_database_channels_.count(channel_id) == 0) {
+      channel_ids.push_back(channel_id);
+    }
+  }
+  if (channel_ids.size() <= 1) {
+    return;
+  }
+
+  LOG(INFO) << "Preload " << channel_ids.size() << " supergroups from database";
+  auto *pmc = G()->td_db()->get_sqlite_sync_pmc();
+  // all lookups are done in one read transaction, which is much faster than a transaction per lookup
+  pmc->begin_read_transaction().ensure();
+  auto values =
+      transform(channel_ids, [pmc](ChannelId channel_id) { return pmc->get(get_channel_database_key(channel_id)); });
+  pmc->commit_transaction().ensure();
+  for (size_t i = 0; i < channel_ids.size(); i++) {
+    on_load_channel_from_database(channel_ids[i], std::move(values[i]), true);
+  }
+}
+
 ChatManager::Channel *ChatManager::get_channel_force(ChannelId channel_id, const char *source) {
   if (!channel_id.is_valid()) {
     return nullptr;
@@ -5180,6 +5218,7 @@ void ChatManager::on_get_chat(tl_object_ptr<telegram_api::Chat> &&chat, const ch
 }
 
 void ChatManager::on_get_chats(vector<tl_object_ptr<telegram_api::Chat>> &&chats, const char *source) {
+  preload_channels_from_database(chats);
   for (auto &chat : chats) {
     auto constuctor_id = chat->get_id();
     if (constuctor_id == telegram_api::channel::ID || constuctor_id == telegram_api::channelForbidden::ID) {
@@ -5820,7 +5859,7 @@ bool ChatManager::speculative_add_count(int32 &count, int32 delta_count, int32 m
 
 void ChatManager::speculative_add_channel_participants(ChannelId channel_id, const vector<UserId> &added_user_ids,
                                                        UserId inviter_user_id, int32 date, bool by_me) {
-  td_->dialog_participant_manager_->add_cached_channel_participants(channel_id, added_user_ids, inviter_user_id, date);
+  td_->dialog_participant_manager_->add_cached_channel_participants(channel_id, added_user_ids);
   auto channel_full = get_channel_full_force(channel_id, true, "speculative_add_channel_participants");
 
   int32 delta_participant_count = 0;
@@ -8892,6 +8931,41 @@ tl_object_ptr<td_api::supergroupFullInfo> ChatManager::get_supergroup_full_info_
       channel_full->migrated_from_max_message_id.get());
 }
 
+void ChatManager::optimize_memory() {
+  chats_.shrink_to_fit();
+  chats_full_.shrink_to_fit();
+  chat_full_file_source_ids_.shrink_to_fit();
+  min_channels_.shrink_to_fit();
+  channels_.shrink_to_fit();
+  channels_full_.shrink_to_fit();
+  invalidated_channels_full_.shrink_to_fit();
+  channel_full_file_source_ids_.shrink_to_fit();
+  loaded_from_database_chats_.shrink_to_fit();
+  unavailable_chat_fulls_.shrink_to_fit();
+  loaded_from_database_channels_.shrink_to_fit();
+  unavailable_channel_fulls_.shrink_to_fit();
+  for (auto &it : channel_messages_) {
+    it.second.shrink_to_fit();
+  }
+  channel_messages_.shrink_to_fit();
+  linked_channel_ids_.shrink_to_fit();
+  restricted_channel_ids_.shrink_to_fit();
+}
+
+void ChatManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  statistics.add("ChatManager", "chats", chats_.calc_size(), sizeof(ChatId) + sizeof(unique_ptr<Chat>) + sizeof(Chat));
+  statistics.add("ChatManager", "chats_full", chats_full_.calc_size(),
+                 sizeof(ChatId) + sizeof(unique_ptr<ChatFull>) + sizeof(ChatFull));
+  statistics.add("ChatManager", "min_channels", min_channels_.calc_size(),
+                 sizeof(ChannelId) + sizeof(unique_ptr<MinChannel>) + sizeof(MinChannel));
+  statistics.add("ChatManager", "channels", channels_.calc_size(),
+                 sizeof(ChannelId) + sizeof(unique_ptr<Channel>) + sizeof(Channel));
+  statistics.add("ChatManager", "channels_full", channels_full_.calc_size(),
+                 sizeof(ChannelId) + sizeof(unique_ptr<ChannelFull>) + sizeof(ChannelFull));
+  statistics.add("ChatManager", "channel_messages", channel_messages_.size(),
+                 sizeof(ChannelId) + sizeof(FlatHashSet<MessageFullId, MessageFullIdHash>));
+}
+
 void ChatManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   for (auto chat_id : unknown_chats_) {
     if (!have_chat(chat_id)) {
@@ -55,6 +55,7 @@ namespace td {
 
 struct BinlogEvent;
 struct MinChannel;
+class MemoryStatistics;
 class Td;
 
 class ChatManager final : public Actor {
@@ -383,6 +384,10 @@ class ChatManager final : public Actor {
 
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
+  void optimize_memory();
+
  private:
   struct Chat {
     string title;
@@ -803,6 +808,7 @@ class ChatManager final : public Actor {
   void load_channel_from_database(Channel *c, ChannelId channel_id, Promise<Unit> promise);
   void load_channel_from_database_impl(ChannelId channel_id, Promise<Unit> promise);
   void on_load_channel_from_database(ChannelId channel_id, string value, bool force);
+  void preload_channels_from_database(const vector<tl_object_ptr<telegram_api::Chat>> &chats);
 
   static void save_chat_full(const ChatFull *chat_full, ChatId chat_id);
   static string get_chat_full_database_key(ChatId chat_id);
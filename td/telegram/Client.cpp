@@ -171,6 +171,30 @@ class ClientManager::Impl final {
     return response;
   }
 
+  int get_receive_fd() {
+    return -1;
+  }
+
+  void set_receive_group(ClientId client_id, int32 group_id) {
+    // all clients share the same queue, because there is only one thread
+  }
+
+  Response receive_group(int32 group_id, double timeout) {
+    return receive(timeout);
+  }
+
+  vector<Response> receive_batch(double timeout, size_t max_count) {
+    vector<Response> responses;
+    while (responses.size() < max_count) {
+      auto response = receive(responses.empty() ? timeout : 0.0);
+      if (response.object == nullptr) {
+        break;
+      }
+      responses.push_back(std::move(response));
+    }
+    return responses;
+  }
+
   Impl() = default;
   Impl(const Impl &) = delete;
   Impl &operator=(const Impl &) = delete;
@@ -228,6 +252,14 @@ class Client::Impl final {
     return old_response;
   }
 
+  vector<Response> receive_batch(double timeout, size_t max_count) {
+    vector<Response> old_responses;
+    for (auto &response : impl_.receive_batch(timeout, max_count)) {
+      old_responses.push_back({response.request_id, std::move(response.object)});
+    }
+    return old_responses;
+  }
+
  private:
   ClientManager::Impl impl_;
   ClientManager::ClientId client_id_;
@@ -278,23 +310,42 @@ class TdReceiver {
 
   ClientManager::Response receive(double timeout, bool from_manager) {
     VLOG(td_requests) << "Begin to wait for updates with timeout " << timeout;
-    auto is_locked = receive_lock_.exchange(true);
-    if (is_locked) {
-      if (from_manager) {
-        LOG(FATAL) << "Receive must not be called simultaneously from two different threads, but this has just "
-                      "happened. Call it from a fixed thread, dedicated for updates and response processing.";
-      } else {
-        LOG(FATAL) << "Receive is called after Client destroy, or simultaneously from different threads";
-      }
-    }
+    lock_receive(from_manager);
     auto response = receive_unlocked(clamp(timeout, 0.0, 1000000.0));
-    is_locked = receive_lock_.exchange(false);
-    CHECK(is_locked);
+    unlock_receive();
     VLOG(td_requests) << "End to wait for updates, returning object " << response.request_id << ' '
                       << response.object.get();
     return response;
   }
 
+  vector<ClientManager::Response> receive_batch(double timeout, size_t max_count, bool from_manager) {
+    CHECK(max_count > 0);
+    VLOG(td_requests) << "Begin to wait for at most " << max_count << " updates with timeout " << timeout;
+    lock_receive(from_manager);
+    vector<ClientManager::Response> responses;
+    auto response = receive_unlocked(clamp(timeout, 0.0, 1000000.0));
+    if (!is_empty_response(response)) {
+      responses.push_back(std::move(response));
+      while (responses.size() < max_count) {
+        if (output_queue_ready_cnt_ == 0) {
+          output_queue_ready_cnt_ = output_queue_->reader_wait_nonblock();
+          if (output_queue_ready_cnt_ == 0) {
+            break;
+          }
+        }
+        output_queue_ready_cnt_--;
+        responses.push_back(output_queue_->reader_get_unsafe());
+      }
+    }
+    unlock_receive();
+    VLOG(td_requests) << "End to wait for updates, returning " << responses.size() << " objects";
+    return responses;
+  }
+
+  static bool is_empty_response(const ClientManager::Response &response) {
+    return response.client_id == 0 && response.request_id == 0 && response.object == nullptr;
+  }
+
   unique_ptr<TdCallback> create_callback(ClientManager::ClientId client_id) {
     class Callback final : public TdCallback {
      public:
@@ -326,12 +377,38 @@ class TdReceiver {
     output_queue_->writer_put({client_id, id, std::move(result)});
   }
 
+  // the descriptor becomes readable as soon as a response is added after the queue was found empty
+  int get_receive_fd() {
+#if TD_PORT_POSIX
+    return output_queue_->reader_get_event_fd().get_poll_info().native_fd().fd();
+#else
+    return -1;
+#endif
+  }
+
  private:
   using OutputQueue = MpscPollableQueue<ClientManager::Response>;
   std::shared_ptr<OutputQueue> output_queue_;
   int output_queue_ready_cnt_{0};
   std::atomic<bool> receive_lock_{false};
 
+  void lock_receive(bool from_manager) {
+    auto is_locked = receive_lock_.exchange(true);
+    if (is_locked) {
+      if (from_manager) {
+        LOG(FATAL) << "Receive must not be called simultaneously from two different threads, but this has just "
+                      "happened. Call it from a fixed thread, dedicated for updates and response processing.";
+      } else {
+        LOG(FATAL) << "Receive is called after Client destroy, or simultaneously from different threads";
+      }
+    }
+  }
+
+  void unlock_receive() {
+    auto is_locked = receive_lock_.exchange(false);
+    CHECK(is_locked);
+  }
+
   ClientManager::Response receive_unlocked(double timeout) {
     if (output_queue_ready_cnt_ == 0) {
       output_queue_ready_cnt_ = output_queue_->reader_wait_nonblock();
@@ -350,10 +427,15 @@ class TdReceiver {
 
 class MultiImpl {
  public:
-  static constexpr int32 ADDITIONAL_THREAD_COUNT = 3;
+  static constexpr int32 MAX_ADDITIONAL_THREAD_COUNT = 5;
 
-  explicit MultiImpl(std::shared_ptr<NetQueryStats> net_query_stats) {
-    concurrent_scheduler_ = std::make_shared<ConcurrentScheduler>(ADDITIONAL_THREAD_COUNT, 0);
+  MultiImpl(std::shared_ptr<NetQueryStats> net_query_stats, int32 additional_thread_count,
+            double actor_stats_log_period, uint64 thread_affinity_mask) {
+    CHECK(0 <= additional_thread_count && additional_thread_count <= MAX_ADDITIONAL_THREAD_COUNT);
+    concurrent_scheduler_ = std::make_shared<ConcurrentScheduler>(additional_thread_count, thread_affinity_mask);
+    if (actor_stats_log_period > 0) {
+      concurrent_scheduler_->enable_actor_stats(actor_stats_log_period);
+    }
     concurrent_scheduler_->start();
 
     {
@@ -363,7 +445,14 @@ class MultiImpl {
       multi_td_ = create_actor<MultiTd>("MultiTd", std::move(options));
     }
 
-    scheduler_thread_ = thread([concurrent_scheduler = concurrent_scheduler_] {
+    scheduler_thread_ = thread([concurrent_scheduler = concurrent_scheduler_, thread_affinity_mask] {
+#if TD_HAVE_THREAD_AFFINITY
+      if (thread_affinity_mask != 0) {
+        thread::set_affinity_mask(this_thread::get_id(), thread_affinity_mask).ignore();
+      }
+#else
+      (void)thread_affinity_mask;
+#endif
       while (concurrent_scheduler->run_main(10)) {
       }
     });
@@ -423,9 +512,12 @@ class MultiImpl {
   static std::atomic<uint32> current_id_;
 };
 
-constexpr int32 MultiImpl::ADDITIONAL_THREAD_COUNT;
+constexpr int32 MultiImpl::MAX_ADDITIONAL_THREAD_COUNT;
 std::atomic<uint32> MultiImpl::current_id_{1};
 
+static std::mutex scheduler_topology_mutex;
+static ClientManager::SchedulerTopology scheduler_topology;
+
 class MultiImplPool {
  public:
   std::shared_ptr<MultiImpl> get() {
@@ -433,20 +525,44 @@ class MultiImplPool {
     if (impls_.empty()) {
       init_openssl_threads();
 
+      ClientManager::SchedulerTopology topology;
+      {
+        std::lock_guard<std::mutex> topology_guard(scheduler_topology_mutex);
+        topology = scheduler_topology;
+      }
+      additional_thread_count_ = clamp(topology.additional_thread_count, 0, MultiImpl::MAX_ADDITIONAL_THREAD_COUNT);
+      actor_stats_log_period_ = topology.actor_stats_log_period;
+      thread_group_affinity_masks_ = std::move(topology.thread_group_affinity_masks);
+      is_round_robin_ = topology.client_assignment == ClientManager::SchedulerTopology::ClientAssignment::RoundRobin;
+      next_impl_ = 0;
+
       auto max_client_threads = clamp(thread::hardware_concurrency(), 8u, 20u) * 5 / 4;
 #if TD_OPENBSD
       max_client_threads = td::min(max_client_threads, 4u);
 #endif
-      impls_.resize(max_client_threads);
-      CHECK(impls_.size() * (1 + MultiImpl::ADDITIONAL_THREAD_COUNT + 1 /* IOCP */) < 128);
+      if (topology.client_thread_count > 0) {
+        max_client_threads = static_cast<uint32>(topology.client_thread_count);
+      }
+      // the total number of scheduler threads must be less than 128
+      auto max_possible_client_threads = static_cast<uint32>(127 / (1 + additional_thread_count_ + 1 /* IOCP */));
+      impls_.resize(td::min(max_client_threads, max_possible_client_threads));
+      CHECK(impls_.size() * (1 + additional_thread_count_ + 1 /* IOCP */) < 128);
 
       net_query_stats_ = std::make_shared<NetQueryStats>();
     }
-    auto &impl = *std::min_element(impls_.begin(), impls_.end(),
-                                   [](auto &a, auto &b) { return a.lock().use_count() < b.lock().use_count(); });
+    auto &impl = is_round_robin_ ? impls_[next_impl_++ % impls_.size()]
+                                 : *std::min_element(impls_.begin(), impls_.end(), [](auto &a, auto &b) {
+                                     return a.lock().use_count() < b.lock().use_count();
+                                   });
     auto result = impl.lock();
     if (!result) {
-      result = std::make_shared<MultiImpl>(net_query_stats_);
+      uint64 thread_affinity_mask = 0;
+      if (!thread_group_affinity_masks_.empty()) {
+        auto group_id = static_cast<size_t>(&impl - impls_.data());
+        thread_affinity_mask = thread_group_affinity_masks_[group_id % thread_group_affinity_masks_.size()];
+      }
+      result = std::make_shared<MultiImpl>(net_query_stats_, additional_thread_count_, actor_stats_log_period_,
+                                           thread_affinity_mask);
       impl = result;
     }
     return result;
@@ -474,6 +590,11 @@ class MultiImplPool {
   std::mutex mutex_;
   std::vector<std::weak_ptr<MultiImpl>> impls_;
   std::shared_ptr<NetQueryStats> net_query_stats_;
+  int32 additional_thread_count_ = MultiImpl::MAX_ADDITIONAL_THREAD_COUNT;
+  double actor_stats_log_period_ = 0.0;
+  std::vector<uint64> thread_group_affinity_masks_;
+  bool is_round_robin_ = false;
+  size_t next_impl_ = 0;
 };
 
 class ClientManager::Impl final {
@@ -504,7 +625,7 @@ class ClientManager::Impl final {
       it = impls_.find(client_id);
       if (it != impls_.end() && it->second.impl == nullptr) {
         it->second.impl = pool_.get();
-        it->second.impl->create(client_id, receiver_.create_callback(client_id));
+        it->second.impl->create(client_id, get_receiver(it->second).create_callback(client_id));
       }
       write_lock.reset();
 
@@ -512,14 +633,70 @@ class ClientManager::Impl final {
       it = impls_.find(client_id);
     }
     if (it == impls_.end() || it->second.is_closed) {
-      receiver_.add_response(client_id, request_id, td_api::make_object<td_api::error>(500, "Request aborted"));
+      auto &receiver = it == impls_.end() ? receiver_ : get_receiver(it->second);
+      receiver.add_response(client_id, request_id, td_api::make_object<td_api::error>(500, "Request aborted"));
       return;
     }
     it->second.impl->send(client_id, request_id, std::move(request));
   }
 
+  void set_receive_group(ClientId client_id, int32 group_id) {
+    auto lock = impls_mutex_.lock_write().move_as_ok();
+    auto it = impls_.find(client_id);
+    if (it == impls_.end() || it->second.impl != nullptr || it->second.is_closed) {
+      LOG(ERROR) << "Can't change receive group of client " << client_id;
+      return;
+    }
+    if (group_id == 0) {
+      it->second.receiver = nullptr;
+      return;
+    }
+    auto &receiver = group_receivers_[group_id];
+    if (receiver == nullptr) {
+      receiver = make_unique<TdReceiver>();
+    }
+    it->second.receiver = receiver.get();
+  }
+
   Response receive(double timeout) {
     auto response = receiver_.receive(timeout, true);
+    while (process_response(response)) {
+      // the response was consumed internally, so the next one must be returned to keep the queue drained
+      response = receiver_.receive(0, true);
+    }
+    return response;
+  }
+
+  Response receive_group(int32 group_id, double timeout) {
+    if (group_id == 0) {
+      return receive(timeout);
+    }
+    auto receiver = get_group_receiver(group_id);
+    if (receiver == nullptr) {
+      return {0, 0, nullptr};
+    }
+    auto response = receiver->receive(timeout, true);
+    while (process_response(response)) {
+      response = receiver->receive(0, true);
+    }
+    return response;
+  }
+
+  vector<Response> receive_batch(double timeout, size_t max_count) {
+    auto responses = receiver_.receive_batch(timeout, max_count, true);
+    for (auto &response : responses) {
+      process_response(response);
+    }
+    td::remove_if(responses, [](const Response &response) { return response.object == nullptr; });
+    return responses;
+  }
+
+  int get_receive_fd() {
+    return receiver_.get_receive_fd();
+  }
+
+  // returns true, if the response was consumed and replaced with an empty response
+  bool process_response(Response &response) {
     if (response.request_id == 0 && response.object != nullptr &&
         response.object->get_id() == td_api::updateAuthorizationState::ID &&
         static_cast<const td_api::updateAuthorizationState *>(response.object.get())->authorization_state_->get_id() ==
@@ -530,6 +707,7 @@ class ClientManager::Impl final {
 
       response.client_id = 0;
       response.object = nullptr;
+      return true;
     }
     if (response.object == nullptr && response.client_id != 0 && response.request_id == 0) {
       auto lock = impls_mutex_.lock_write().move_as_ok();
@@ -546,7 +724,7 @@ class ClientManager::Impl final {
         pool_.try_clear();
       }
     }
-    return response;
+    return false;
   }
 
   void close_impl(ClientId client_id) {
@@ -555,7 +733,7 @@ class ClientManager::Impl final {
     if (!it->second.is_closed) {
       it->second.is_closed = true;
       if (it->second.impl == nullptr) {
-        receiver_.add_response(client_id, 0, nullptr);
+        get_receiver(it->second).add_response(client_id, 0, nullptr);
       } else {
         it->second.impl->close(client_id);
       }
@@ -576,7 +754,11 @@ class ClientManager::Impl final {
       close_impl(it.first);
     }
     while (!impls_.empty() && !ExitGuard::is_exited()) {
-      receive(0.1);
+      for (auto &group_receiver : group_receivers_) {
+        auto response = group_receiver.second->receive(0, true);
+        process_response(response);
+      }
+      receive(group_receivers_.empty() ? 0.1 : 0.01);
     }
   }
 
@@ -585,10 +767,25 @@ class ClientManager::Impl final {
   RwMutex impls_mutex_;
   struct MultiImplInfo {
     std::shared_ptr<MultiImpl> impl;
+    TdReceiver *receiver = nullptr;
     bool is_closed = false;
   };
   FlatHashMap<ClientId, MultiImplInfo> impls_;
+  FlatHashMap<int32, unique_ptr<TdReceiver>> group_receivers_;
   TdReceiver receiver_;
+
+  TdReceiver &get_receiver(const MultiImplInfo &info) {
+    return info.receiver == nullptr ? receiver_ : *info.receiver;
+  }
+
+  TdReceiver *get_group_receiver(int32 group_id) {
+    auto lock = impls_mutex_.lock_read().move_as_ok();
+    auto it = group_receivers_.find(group_id);
+    if (it == group_receivers_.end()) {
+      return nullptr;
+    }
+    return it->second.get();
+  }
 };
 
 class Client::Impl final {
@@ -619,6 +816,16 @@ class Client::Impl final {
     return old_response;
   }
 
+  vector<Response> receive_batch(double timeout, size_t max_count) {
+    vector<Response> old_responses;
+    for (auto &response : receiver_.receive_batch(timeout, max_count, false)) {
+      if (response.object != nullptr) {
+        old_responses.push_back({response.request_id, std::move(response.object)});
+      }
+    }
+    return old_responses;
+  }
+
   Impl(const Impl &) = delete;
   Impl &operator=(const Impl &) = delete;
   Impl(Impl &&) = delete;
@@ -653,6 +860,10 @@ Client::Response Client::receive(double timeout) {
   return impl_->receive(timeout);
 }
 
+std::vector<Client::Response> Client::receive_batch(double timeout, std::size_t max_count) {
+  return impl_->receive_batch(timeout, max_count);
+}
+
 Client::Response Client::execute(Request &&request) {
   Response response;
   response.id = request.id;
@@ -679,10 +890,33 @@ ClientManager::Response ClientManager::receive(double timeout) {
   return impl_->receive(timeout);
 }
 
+void ClientManager::set_receive_group(ClientId client_id, std::int32_t group_id) {
+  impl_->set_receive_group(client_id, group_id);
+}
+
+ClientManager::Response ClientManager::receive_group(std::int32_t group_id, double timeout) {
+  return impl_->receive_group(group_id, timeout);
+}
+
+std::vector<ClientManager::Response> ClientManager::receive_batch(double timeout, std::size_t max_count) {
+  return impl_->receive_batch(timeout, max_count);
+}
+
+int ClientManager::get_receive_fd() {
+  return impl_->get_receive_fd();
+}
+
 td_api::object_ptr<td_api::Object> ClientManager::execute(td_api::object_ptr<td_api::Function> &&request) {
   return Td::static_request(std::move(request));
 }
 
+void ClientManager::set_scheduler_topology(const SchedulerTopology &topology) {
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  std::lock_guard<std::mutex> guard(scheduler_topology_mutex);
+  scheduler_topology = topology;
+#endif
+}
+
 static std::atomic<ClientManager::LogMessageCallbackPtr> log_message_callback;
 
 static void log_message_callback_wrapper(int verbosity_level, CSlice message) {
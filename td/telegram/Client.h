@@ -11,8 +11,10 @@
 #include "td/telegram/td_api.h"
 #include "td/telegram/td_api.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace td {
 
@@ -115,6 +117,50 @@ class ClientManager final {
    */
   Response receive(double timeout);
 
+  /**
+   * Receives all immediately available incoming updates and responses to requests from TDLib, waiting for the first
+   * of them at most timeout seconds. May be called from any thread, but must not be called simultaneously from two
+   * different threads or simultaneously with ClientManager::receive.
+   * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+   * \param[in] max_count The maximum number of returned responses. Must be positive.
+   * \return Incoming updates and responses to requests in the order they were received. The returned vector is empty
+   *         if the timeout expires and doesn't contain responses with a nullptr object.
+   */
+  std::vector<Response> receive_batch(double timeout, std::size_t max_count);
+
+  /**
+   * Returns a file descriptor, which can be used to wait for incoming updates and responses to requests in an external
+   * event loop instead of blocking in ClientManager::receive. The descriptor becomes readable when new data is
+   * available after ClientManager::receive has returned an empty response. After the descriptor becomes readable, all
+   * available responses must be received by calling ClientManager::receive with zero timeout until it returns
+   * a response with a nullptr object. The descriptor must not be read, written or closed by the application, and is
+   * valid until the ClientManager is destroyed. Only the receive group 0 can be waited for using the descriptor.
+   * \return The file descriptor, or -1 if waiting for the descriptor isn't supported on the current platform.
+   */
+  int get_receive_fd();
+
+  /**
+   * Assigns a TDLib client instance to a receive group. Incoming updates and responses to requests for clients
+   * from a non-zero receive group are returned only by ClientManager::receive_group for the group, and can be received
+   * independently from other groups. By default, all clients belong to the group 0, which is received by
+   * ClientManager::receive. Must be called before the first request is sent to the client.
+   * If threads aren't supported, then all clients belong to the same group.
+   * \param[in] client_id TDLib client instance identifier.
+   * \param[in] group_id Identifier of the receive group.
+   */
+  void set_receive_group(ClientId client_id, std::int32_t group_id);
+
+  /**
+   * Receives incoming updates and responses to requests for clients from the specified receive group.
+   * May be called from any thread, but must not be called simultaneously from two different threads for the same group.
+   * Receiving updates for the group 0 is equivalent to ClientManager::receive.
+   * \param[in] group_id Identifier of the receive group.
+   * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+   * \return An incoming update or response to a request. The object returned in the response may be a nullptr
+   *         if the timeout expires.
+   */
+  Response receive_group(std::int32_t group_id, double timeout);
+
   /**
    * Synchronously executes a TDLib request.
    * A request can be executed synchronously, only if it is documented with "Can be called synchronously".
@@ -144,6 +190,71 @@ class ClientManager final {
    */
   static void set_log_message_callback(int max_verbosity_level, LogMessageCallbackPtr callback);
 
+  /**
+   * Layout of scheduler threads used by TDLib client instances.
+   */
+  struct SchedulerTopology {
+    /**
+     * The number of thread groups running TDLib client instances. Each group has its own main thread, where TDLib
+     * client instances are run, and additional threads with database, garbage collection and slow network work.
+     * Pass 0 to choose the number automatically based on the number of CPU cores.
+     */
+    std::int32_t client_thread_count = 0;
+
+    /**
+     * The number of additional threads in each group; 0-5. If 0, then all work is done in the main thread.
+     * If 1, then database, garbage collection and slow network work share one thread. If 2, then the database work
+     * is done in a dedicated thread, and garbage collection and slow network work share the other thread.
+     * If 3, then each kind of work is done in a dedicated thread, and authentication key generation is done in the slow
+     * network thread. If 4, then authentication key generation is also done in a dedicated thread.
+     * If 5, then file reads and writes of downloads and uploads are also done in a dedicated thread instead of
+     * the garbage collection thread.
+     */
+    std::int32_t additional_thread_count = 3;
+
+    /**
+     * The way new TDLib client instances are assigned to thread groups.
+     */
+    enum class ClientAssignment : std::int32_t {
+      /**
+       * A new client instance is assigned to the group with the least number of client instances.
+       */
+      LeastLoaded,
+
+      /**
+       * New client instances are assigned to the groups in turn.
+       */
+      RoundRobin
+    };
+
+    /**
+     * The way new TDLib client instances are assigned to thread groups.
+     */
+    ClientAssignment client_assignment = ClientAssignment::LeastLoaded;
+
+    /**
+     * If positive, then statistics about events processed by internal actors and time spent in them are collected,
+     * and the actors with the biggest total run time are logged with the specified period in seconds.
+     */
+    double actor_stats_log_period = 0.0;
+
+    /**
+     * CPU affinity masks of the thread groups. If non-empty, then all threads of the i-th group, including its main
+     * thread, are pinned to the CPUs from the mask thread_group_affinity_masks[i % thread_group_affinity_masks.size()].
+     * A zero mask leaves the threads of the group unpinned. Choose masks with CPUs of a single NUMA node to keep
+     * the memory used by each group node-local. Has no effect if thread affinity isn't supported.
+     */
+    std::vector<std::uint64_t> thread_group_affinity_masks;
+  };
+
+  /**
+   * Changes the layout of scheduler threads used by TDLib client instances created by all client managers.
+   * The new layout is applied the next time the scheduler threads are created, i.e., when the first TDLib client
+   * instance is created after all previous instances were closed. Has no effect if threads aren't supported.
+   * \param[in] topology The new scheduler topology.
+   */
+  static void set_scheduler_topology(const SchedulerTopology &topology);
+
   /**
    * Destroys the client manager and all TDLib client instances managed by it.
    */
@@ -258,6 +369,17 @@ class Client final {
    */
   Response receive(double timeout);
 
+  /**
+   * Receives all immediately available incoming updates and request responses from TDLib, waiting for the first
+   * of them at most timeout seconds. May be called from any thread, but shouldn't be called simultaneously from two
+   * different threads.
+   * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+   * \param[in] max_count The maximum number of returned responses. Must be positive.
+   * \return Incoming updates and request responses in the order they were received. The returned vector is empty
+   *         if the timeout expires.
+   */
+  std::vector<Response> receive_batch(double timeout, std::size_t max_count);
+
   /**
    * Synchronously executes TDLib requests. Only a few requests can be executed synchronously.
    * May be called from any thread.
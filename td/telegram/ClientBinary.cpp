@@ -0,0 +1,75 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/ClientBinary.h"
+
+#include "td/telegram/Client.h"
+#include "td/telegram/td_api.h"
+
+#include "td/tl/tl_object_parse.h"
+#include "td/tl/tl_object_store.h"
+
+#include "td/utils/port/thread_local.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/tl_storers.h"
+
+namespace td {
+
+static td_api::object_ptr<td_api::Function> to_request(Slice request) {
+  TlParser parser(request);
+  auto function = td_api::Function::fetch(parser);
+  parser.fetch_end();
+  const char *error = parser.get_error();
+  if (error != nullptr) {
+    auto error_object = td_api::make_object<td_api::error>(
+        400, PSTRING() << "Failed to parse TL-serialized request: " << error << " at " << parser.get_error_pos());
+    return td_api::make_object<td_api::testReturnError>(std::move(error_object));
+  }
+  return function;
+}
+
+static TD_THREAD_LOCAL string *current_output;
+
+static Slice store_response(int32 client_id, uint64 request_id, const td_api::object_ptr<td_api::Object> &object) {
+  TlStorerCalcLength calc_length;
+  calc_length.store_binary(client_id);
+  calc_length.store_binary(static_cast<int64>(request_id));
+  TlStoreBoxedUnknown<TlStoreObject>::store(object, calc_length);
+  auto length = calc_length.get_length();
+
+  init_thread_local<string>(current_output);
+  current_output->resize(length);
+  MutableSlice data(*current_output);
+  TlStorerUnsafe storer(data.ubegin());
+  storer.store_binary(client_id);
+  storer.store_binary(static_cast<int64>(request_id));
+  TlStoreBoxedUnknown<TlStoreObject>::store(object, storer);
+  CHECK(storer.get_buf() == data.uend());
+  return data;
+}
+
+static ClientManager *get_manager() {
+  return ClientManager::get_manager_singleton();
+}
+
+void binary_send(int client_id, uint64 request_id, Slice request) {
+  get_manager()->send(client_id, request_id, to_request(request));
+}
+
+Slice binary_receive(double timeout) {
+  auto response = get_manager()->receive(timeout);
+  if (!response.object) {
+    return Slice();
+  }
+  return store_response(response.client_id, response.request_id, response.object);
+}
+
+Slice binary_execute(Slice request) {
+  return store_response(0, 0, ClientManager::execute(to_request(request)));
+}
+
+}  // namespace td
@@ -0,0 +1,23 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+namespace td {
+
+// requests are boxed TL-serialized td_api functions
+// responses consist of int32 client identifier, int64 request identifier and boxed TL-serialized td_api object
+void binary_send(int client_id, uint64 request_id, Slice request);
+
+// returns an empty slice if the timeout expires
+Slice binary_receive(double timeout);
+
+Slice binary_execute(Slice request);
+
+}  // namespace td
@@ -9,6 +9,7 @@
 #include "td/telegram/td_api.h"
 #include "td/telegram/td_api_json.h"
 
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/JsonBuilder.h"
@@ -17,6 +18,7 @@
 #include "td/utils/StackAllocator.h"
 #include "td/utils/StringBuilder.h"
 
+#include <cstring>
 #include <utility>
 
 namespace td {
@@ -53,7 +55,8 @@ static std::pair<td_api::object_ptr<td_api::Function>, string> to_request(Slice
   return std::make_pair(std::move(func), std::move(extra));
 }
 
-static string from_response(const td_api::Object &object, const string &extra, int client_id) {
+template <class F>
+static auto store_response(const td_api::Object &object, const string &extra, int client_id, F &&store) {
   auto buf = StackAllocator::alloc(1 << 18);
   JsonBuilder jb(StringBuilder(buf.as_slice(), true), -1);
   jb.enter_value() << ToJson(object);
@@ -68,7 +71,39 @@ static string from_response(const td_api::Object &object, const string &extra, i
     sb << ",\"@client_id\":" << client_id;
   }
   sb << '}';
-  return sb.as_cslice().str();
+  return store(sb.as_cslice());
+}
+
+static string from_response(const td_api::Object &object, const string &extra, int client_id) {
+  return store_response(object, extra, client_id, [](CSlice response) { return response.str(); });
+}
+
+static BufferSlice from_response_buffer(const td_api::Object &object, const string &extra, int client_id) {
+  return store_response(object, extra, client_id, [](CSlice response) {
+    // keep the terminating zero to allow using the buffer as a C string
+    BufferSlice result(response.size() + 1);
+    result.as_mutable_slice().copy_from(Slice(response.c_str(), response.size() + 1));
+    return result;
+  });
+}
+
+static string from_responses(vector<string> &&responses) {
+  CHECK(!responses.empty());
+  size_t size = responses.size() + 1;
+  for (auto &response : responses) {
+    size += response.size();
+  }
+  string result;
+  result.reserve(size);
+  result += '[';
+  for (auto &response : responses) {
+    if (result.size() != 1) {
+      result += ',';
+    }
+    result += response;
+  }
+  result += ']';
+  return result;
 }
 
 static TD_THREAD_LOCAL string *current_output;
@@ -95,16 +130,34 @@ const char *ClientJson::receive(double timeout) {
     return nullptr;
   }
 
+  return store_string(from_response(*response.object, get_extra(response.id), 0));
+}
+
+string ClientJson::get_extra(std::uint64_t request_id) {
   string extra;
-  if (response.id != 0) {
+  if (request_id != 0) {
     std::lock_guard<std::mutex> guard(mutex_);
-    auto it = extra_.find(response.id);
+    auto it = extra_.find(request_id);
     if (it != extra_.end()) {
       extra = std::move(it->second);
       extra_.erase(it);
     }
   }
-  return store_string(from_response(*response.object, extra, 0));
+  return extra;
+}
+
+const char *ClientJson::receive_batch(double timeout, size_t max_count) {
+  auto responses = client_.receive_batch(timeout, td::max(max_count, static_cast<size_t>(1)));
+  if (responses.empty()) {
+    return nullptr;
+  }
+
+  vector<string> results;
+  results.reserve(responses.size());
+  for (auto &response : responses) {
+    results.push_back(from_response(*response.object, get_extra(response.id), 0));
+  }
+  return store_string(from_responses(std::move(results)));
 }
 
 const char *ClientJson::execute(Slice request) {
@@ -135,22 +188,70 @@ void json_send(int client_id, Slice request) {
   get_manager()->send(client_id, request_id, std::move(parsed_request.first));
 }
 
-const char *json_receive(double timeout) {
-  auto response = get_manager()->receive(timeout);
-  if (!response.object) {
-    return nullptr;
-  }
-
+static string get_extra(uint64 request_id) {
   string extra_str;
-  if (response.request_id != 0) {
+  if (request_id != 0) {
     std::lock_guard<std::mutex> guard(extra_mutex);
-    auto it = extra.find(response.request_id);
+    auto it = extra.find(request_id);
     if (it != extra.end()) {
       extra_str = std::move(it->second);
       extra.erase(it);
     }
   }
-  return store_string(from_response(*response.object, extra_str, response.client_id));
+  return extra_str;
+}
+
+const char *json_receive(double timeout) {
+  auto response = get_manager()->receive(timeout);
+  if (!response.object) {
+    return nullptr;
+  }
+
+  return store_string(from_response(*response.object, get_extra(response.request_id), response.client_id));
+}
+
+const char *json_receive_batch(double timeout, int max_count) {
+  auto responses = get_manager()->receive_batch(timeout, static_cast<size_t>(td::max(max_count, 1)));
+  if (responses.empty()) {
+    return nullptr;
+  }
+
+  vector<string> results;
+  results.reserve(responses.size());
+  for (auto &response : responses) {
+    results.push_back(from_response(*response.object, get_extra(response.request_id), response.client_id));
+  }
+  return store_string(from_responses(std::move(results)));
+}
+
+BufferSlice json_receive_buffer(double timeout) {
+  auto response = get_manager()->receive(timeout);
+  if (!response.object) {
+    return BufferSlice();
+  }
+
+  return from_response_buffer(*response.object, get_extra(response.request_id), response.client_id);
+}
+
+const char *json_receive_owned(double timeout) {
+  auto response = get_manager()->receive(timeout);
+  if (!response.object) {
+    return nullptr;
+  }
+
+  return store_response(*response.object, get_extra(response.request_id), response.client_id, [](CSlice response) {
+    auto result = new char[response.size() + 1];
+    std::memcpy(result, response.c_str(), response.size() + 1);
+    return static_cast<const char *>(result);
+  });
+}
+
+void json_release_owned(const char *response) {
+  delete[] response;
+}
+
+int json_get_receive_fd() {
+  return get_manager()->get_receive_fd();
 }
 
 const char *json_execute(Slice request) {
@@ -8,10 +8,12 @@
 
 #include "td/telegram/Client.h"
 
+#include "td/utils/buffer.h"
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/Slice.h"
 
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <mutex>
 #include <string>
@@ -25,6 +27,8 @@ class ClientJson final {
 
   const char *receive(double timeout);
 
+  const char *receive_batch(double timeout, std::size_t max_count);
+
   static const char *execute(Slice request);
 
  private:
@@ -32,6 +36,8 @@ class ClientJson final {
   std::mutex mutex_;  // for extra_
   FlatHashMap<std::int64_t, std::string> extra_;
   std::atomic<std::uint64_t> extra_id_{1};
+
+  std::string get_extra(std::uint64_t request_id);
 };
 
 int json_create_client_id();
@@ -40,6 +46,18 @@ void json_send(int client_id, Slice request);
 
 const char *json_receive(double timeout);
 
+const char *json_receive_batch(double timeout, int max_count);
+
+// returns an empty buffer if the timeout expires; otherwise, the buffer is zero-terminated
+BufferSlice json_receive_buffer(double timeout);
+
+// the returned response must be released with json_release_owned
+const char *json_receive_owned(double timeout);
+
+void json_release_owned(const char *response);
+
+int json_get_receive_fd();
+
 const char *json_execute(Slice request);
 
 }  // namespace td
@@ -0,0 +1,112 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/DatabaseMaintenanceWorker.h"
+
+#include "td/telegram/Global.h"
+
+#include "td/db/SqliteConnectionSafe.h"
+#include "td/db/SqliteDb.h"
+#include "td/db/SqliteStatement.h"
+
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/Status.h"
+#include "td/utils/Time.h"
+
+namespace td {
+
+DatabaseMaintenanceWorker::DatabaseMaintenanceWorker(ActorShared<> parent,
+                                                     std::shared_ptr<SqliteConnectionSafe> sql_connection)
+    : parent_(std::move(parent)), sql_connection_(std::move(sql_connection)) {
+}
+
+void DatabaseMaintenanceWorker::run_maintenance(Promise<Unit> promise) {
+  promises_.push_back(std::move(promise));
+  if (state_ != State::None) {
+    return;
+  }
+
+  LOG(INFO) << "Start database maintenance";
+  state_ = State::Checkpoint;
+  freed_page_count_ = 0;
+  vacuum_step_count_ = 0;
+  start_time_ = Time::now();
+  yield();
+}
+
+Status DatabaseMaintenanceWorker::do_step() {
+  auto &db = sql_connection_->get();
+  switch (state_) {
+    case State::Checkpoint: {
+      // copy pages from the WAL file to the database without waiting for other connections
+      TRY_RESULT(stmt, db.get_statement("PRAGMA wal_checkpoint(PASSIVE)"));
+      TRY_STATUS(stmt.step());
+      if (stmt.has_row()) {
+        LOG(INFO) << "Checkpointed " << stmt.view_int64(2) << " out of " << stmt.view_int64(1) << " WAL pages";
+      }
+      state_ = State::Vacuum;
+      return Status::OK();
+    }
+    case State::Vacuum: {
+      TRY_RESULT(free_page_count_string, db.get_pragma("freelist_count"));
+      auto free_page_count = to_integer<int64>(free_page_count_string);
+      if (free_page_count == 0) {
+        state_ = State::Optimize;
+        return Status::OK();
+      }
+      // incremental vacuum is possible only for databases created with auto_vacuum = INCREMENTAL
+      TRY_RESULT(auto_vacuum, db.get_pragma("auto_vacuum"));
+      if (to_integer<int32>(auto_vacuum) != 2) {
+        LOG(INFO) << "Keep " << free_page_count << " free database pages, because incremental vacuum is disabled";
+        state_ = State::Optimize;
+        return Status::OK();
+      }
+      TRY_STATUS(db.exec(PSLICE() << "PRAGMA incremental_vacuum(" << VACUUM_PAGES_PER_STEP << ')'));
+      freed_page_count_ += min(free_page_count, static_cast<int64>(VACUUM_PAGES_PER_STEP));
+      vacuum_step_count_++;
+      return Status::OK();
+    }
+    case State::Optimize:
+      // runs ANALYZE only for indices, statistics of which are likely to be outdated
+      TRY_STATUS(db.exec("PRAGMA optimize"));
+      state_ = State::None;
+      return Status::OK();
+    case State::None:
+    default:
+      UNREACHABLE();
+      return Status::OK();
+  }
+}
+
+void DatabaseMaintenanceWorker::loop() {
+  if (state_ == State::None) {
+    return;
+  }
+
+  auto status = do_step();
+  if (status.is_error()) {
+    LOG(ERROR) << "Failed to run database maintenance: " << status;
+    state_ = State::None;
+    return fail_promises(promises_, std::move(status));
+  }
+  if (state_ != State::None) {
+    // other database queries are processed before the next step
+    return yield();
+  }
+
+  LOG(INFO) << "Finish database maintenance in " << Time::now() - start_time_ << " seconds; freed "
+            << freed_page_count_ << " pages in " << vacuum_step_count_ << " steps";
+  set_promises(promises_);
+}
+
+void DatabaseMaintenanceWorker::hangup() {
+  fail_promises(promises_, Global::request_aborted_error());
+  stop();
+}
+
+}  // namespace td
@@ -0,0 +1,49 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/actor/actor.h"
+
+#include "td/utils/common.h"
+#include "td/utils/Promise.h"
+
+#include <memory>
+
+namespace td {
+
+class SqliteConnectionSafe;
+
+// must be created on the database scheduler; runs maintenance of the SQLite database in small steps,
+// so other database queries are delayed for at most one step
+class DatabaseMaintenanceWorker final : public Actor {
+ public:
+  DatabaseMaintenanceWorker(ActorShared<> parent, std::shared_ptr<SqliteConnectionSafe> sql_connection);
+
+  void run_maintenance(Promise<Unit> promise);
+
+ private:
+  static constexpr int32 VACUUM_PAGES_PER_STEP = 256;
+
+  enum class State : int32 { None, Checkpoint, Vacuum, Optimize };
+
+  ActorShared<> parent_;
+  std::shared_ptr<SqliteConnectionSafe> sql_connection_;
+
+  State state_ = State::None;
+  int64 freed_page_count_ = 0;
+  int32 vacuum_step_count_ = 0;
+  double start_time_ = 0.0;
+  vector<Promise<Unit>> promises_;
+
+  Status do_step();
+
+  void loop() final;
+
+  void hangup() final;
+};
+
+}  // namespace td
@@ -16,6 +16,7 @@
 #include "td/actor/SchedulerLocalStorage.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
@@ -23,6 +24,10 @@
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Time.h"
 
+#include <map>
+#include <mutex>
+#include <set>
+
 namespace td {
 // NB: must happen inside a transaction
 Status init_dialog_db(SqliteDb &db, int32 version, KeyValueSyncInterface &binlog_pmc, bool &was_created) {
@@ -109,9 +114,84 @@ Status drop_dialog_db(SqliteDb &db, int version) {
   return status;
 }
 
+// in-memory copy of the table notification_groups shared between all database connections
+class NotificationGroupIndex {
+ public:
+  template <class LoadF>
+  Result<NotificationGroupKey> get_notification_group(NotificationGroupId notification_group_id, LoadF &&load) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    load_index(load);
+    auto it = notification_groups_.find(notification_group_id);
+    if (it == notification_groups_.end() || !it->second.dialog_id.is_valid()) {
+      return Status::Error("Not found");
+    }
+    return it->second;
+  }
+
+  template <class LoadF>
+  vector<NotificationGroupKey> get_notification_groups_by_last_notification_date(
+      NotificationGroupKey notification_group_key, int32 limit, LoadF &&load) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    load_index(load);
+    vector<NotificationGroupKey> result;
+    // NotificationGroupKey::operator< orders the keys by descending last_notification_date
+    for (auto it = ordered_notification_groups_.upper_bound(notification_group_key);
+         it != ordered_notification_groups_.end() && static_cast<int32>(result.size()) < limit; ++it) {
+      result.push_back(*it);
+    }
+    return result;
+  }
+
+  // must be called for every change of the table, including changes made before the index is loaded
+  void on_notification_group_changed(const NotificationGroupKey &notification_group_key) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto &old_key = notification_groups_[notification_group_key.group_id];
+    if (old_key.last_notification_date != 0) {
+      ordered_notification_groups_.erase(old_key);
+    }
+    old_key = notification_group_key;
+    if (!notification_group_key.dialog_id.is_valid()) {
+      old_key.last_notification_date = 0;
+    } else if (notification_group_key.last_notification_date != 0) {
+      ordered_notification_groups_.insert(notification_group_key);
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  bool is_loaded_ = false;
+  // deleted notification groups are kept with an invalid dialog_id until the index is loaded
+  FlatHashMap<NotificationGroupId, NotificationGroupKey, NotificationGroupIdHash> notification_groups_;
+  std::set<NotificationGroupKey> ordered_notification_groups_;
+
+  template <class LoadF>
+  void load_index(LoadF &&load) {
+    if (is_loaded_) {
+      return;
+    }
+    is_loaded_ = true;
+
+    // changes, which were made before the index was loaded, are newer than the database state,
+    // which can also miss changes from a not yet committed write transaction
+    auto keys = load();
+    for (auto &key : keys) {
+      auto &stored_key = notification_groups_[key.group_id];
+      if (stored_key.group_id.is_valid()) {
+        continue;
+      }
+      stored_key = key;
+      if (key.last_notification_date != 0) {
+        ordered_notification_groups_.insert(key);
+      }
+    }
+    LOG(INFO) << "Loaded " << keys.size() << " notification groups from database";
+  }
+};
+
 class DialogDbImpl final : public DialogDbSyncInterface {
  public:
-  explicit DialogDbImpl(SqliteDb db) : db_(std::move(db)) {
+  DialogDbImpl(SqliteDb db, std::shared_ptr<NotificationGroupIndex> notification_group_index)
+      : db_(std::move(db)), notification_group_index_(std::move(notification_group_index)) {
     init().ensure();
   }
 
@@ -127,18 +207,12 @@ class DialogDbImpl final : public DialogDbSyncInterface {
         db_.get_statement("SELECT data, dialog_id, dialog_order FROM dialogs WHERE "
                           "folder_id = ?1 AND (dialog_order < ?2 OR (dialog_order = ?2 AND dialog_id < ?3)) ORDER "
                           "BY dialog_order DESC, dialog_id DESC LIMIT ?4"));
-    TRY_RESULT_ASSIGN(
-        get_notification_groups_by_last_notification_date_stmt_,
-        db_.get_statement("SELECT notification_group_id, dialog_id, last_notification_date FROM notification_groups "
-                          "WHERE last_notification_date < ?1 OR (last_notification_date = ?1 "
-                          "AND (dialog_id < ?2 OR (dialog_id = ?2 AND notification_group_id < ?3))) ORDER BY "
-                          "last_notification_date DESC, dialog_id DESC LIMIT ?4"));
-    //                          "WHERE (last_notification_date, dialog_id, notification_group_id) < (?1, ?2, ?3) ORDER BY "
-    //                          "last_notification_date DESC, dialog_id DESC, notification_group_id DESC LIMIT ?4"));
-    TRY_RESULT_ASSIGN(
-        get_notification_group_stmt_,
-        db_.get_statement(
-            "SELECT dialog_id, last_notification_date FROM notification_groups WHERE notification_group_id = ?1"));
+    TRY_RESULT_ASSIGN(get_dialog_dates_stmt_,
+                      db_.get_statement("SELECT dialog_order, dialog_id FROM dialogs WHERE folder_id = ?1 ORDER BY "
+                                        "dialog_order DESC, dialog_id DESC"));
+    TRY_RESULT_ASSIGN(get_all_notification_groups_stmt_,
+                      db_.get_statement("SELECT notification_group_id, dialog_id, last_notification_date FROM "
+                                        "notification_groups"));
     TRY_RESULT_ASSIGN(
         get_secret_chat_count_stmt_,
         db_.get_statement(
@@ -146,8 +220,6 @@ class DialogDbImpl final : public DialogDbSyncInterface {
 
     // LOG(ERROR) << get_dialog_stmt_.explain().ok();
     // LOG(ERROR) << get_dialogs_stmt_.explain().ok();
-    // LOG(ERROR) << get_notification_groups_by_last_notification_date_stmt_.explain().ok();
-    // LOG(ERROR) << get_notification_group_stmt_.explain().ok();
     // LOG(FATAL) << "EXPLAINED";
 
     return Status::OK();
@@ -189,6 +261,7 @@ class DialogDbImpl final : public DialogDbSyncInterface {
         delete_notification_group_stmt_.bind_int32(1, to_add.group_id.get()).ensure();
         delete_notification_group_stmt_.step().ensure();
       }
+      notification_group_index_->on_notification_group_changed(to_add);
     }
   }
 
@@ -206,16 +279,8 @@ class DialogDbImpl final : public DialogDbSyncInterface {
   }
 
   Result<NotificationGroupKey> get_notification_group(NotificationGroupId notification_group_id) final {
-    SCOPE_EXIT {
-      get_notification_group_stmt_.reset();
-    };
-    get_notification_group_stmt_.bind_int32(1, notification_group_id.get()).ensure();
-    TRY_STATUS(get_notification_group_stmt_.step());
-    if (!get_notification_group_stmt_.has_row()) {
-      return Status::Error("Not found");
-    }
-    return NotificationGroupKey(notification_group_id, DialogId(get_notification_group_stmt_.view_int64(0)),
-                                get_last_notification_date(get_notification_group_stmt_, 1));
+    return notification_group_index_->get_notification_group(notification_group_id,
+                                                             [this] { return get_all_notification_groups(); });
   }
 
   int32 get_secret_chat_count(FolderId folder_id) final {
@@ -254,27 +319,26 @@ class DialogDbImpl final : public DialogDbSyncInterface {
     return result;
   }
 
-  vector<NotificationGroupKey> get_notification_groups_by_last_notification_date(
-      NotificationGroupKey notification_group_key, int32 limit) final {
-    auto &stmt = get_notification_groups_by_last_notification_date_stmt_;
+  vector<DialogDate> get_dialog_dates(FolderId folder_id) final {
     SCOPE_EXIT {
-      stmt.reset();
+      get_dialog_dates_stmt_.reset();
     };
 
-    stmt.bind_int32(1, notification_group_key.last_notification_date).ensure();
-    stmt.bind_int64(2, notification_group_key.dialog_id.get()).ensure();
-    stmt.bind_int32(3, notification_group_key.group_id.get()).ensure();
-    stmt.bind_int32(4, limit).ensure();
+    get_dialog_dates_stmt_.bind_int32(1, folder_id.get()).ensure();
 
-    vector<NotificationGroupKey> notification_groups;
-    stmt.step().ensure();
-    while (stmt.has_row()) {
-      notification_groups.emplace_back(NotificationGroupId(stmt.view_int32(0)), DialogId(stmt.view_int64(1)),
-                                       get_last_notification_date(stmt, 2));
-      stmt.step().ensure();
+    vector<DialogDate> result;
+    get_dialog_dates_stmt_.step().ensure();
+    while (get_dialog_dates_stmt_.has_row()) {
+      result.emplace_back(get_dialog_dates_stmt_.view_int64(0), DialogId(get_dialog_dates_stmt_.view_int64(1)));
+      get_dialog_dates_stmt_.step().ensure();
     }
+    return result;
+  }
 
-    return notification_groups;
+  vector<NotificationGroupKey> get_notification_groups_by_last_notification_date(
+      NotificationGroupKey notification_group_key, int32 limit) final {
+    return notification_group_index_->get_notification_groups_by_last_notification_date(
+        notification_group_key, limit, [this] { return get_all_notification_groups(); });
   }
 
   Status begin_read_transaction() final {
@@ -289,16 +353,33 @@ class DialogDbImpl final : public DialogDbSyncInterface {
 
  private:
   SqliteDb db_;
+  std::shared_ptr<NotificationGroupIndex> notification_group_index_;
 
   SqliteStatement add_dialog_stmt_;
   SqliteStatement add_notification_group_stmt_;
   SqliteStatement delete_notification_group_stmt_;
   SqliteStatement get_dialog_stmt_;
   SqliteStatement get_dialogs_stmt_;
-  SqliteStatement get_notification_groups_by_last_notification_date_stmt_;
-  SqliteStatement get_notification_group_stmt_;
+  SqliteStatement get_dialog_dates_stmt_;
+  SqliteStatement get_all_notification_groups_stmt_;
   SqliteStatement get_secret_chat_count_stmt_;
 
+  vector<NotificationGroupKey> get_all_notification_groups() {
+    auto &stmt = get_all_notification_groups_stmt_;
+    SCOPE_EXIT {
+      stmt.reset();
+    };
+
+    vector<NotificationGroupKey> notification_groups;
+    stmt.step().ensure();
+    while (stmt.has_row()) {
+      notification_groups.emplace_back(NotificationGroupId(stmt.view_int32(0)), DialogId(stmt.view_int64(1)),
+                                       get_last_notification_date(stmt, 2));
+      stmt.step().ensure();
+    }
+    return notification_groups;
+  }
+
   static int32 get_last_notification_date(SqliteStatement &stmt, int id) {
     if (stmt.view_datatype(id) == SqliteStatement::Datatype::Null) {
       return 0;
@@ -312,8 +393,9 @@ std::shared_ptr<DialogDbSyncSafeInterface> create_dialog_db_sync(
   class DialogDbSyncSafe final : public DialogDbSyncSafeInterface {
    public:
     explicit DialogDbSyncSafe(std::shared_ptr<SqliteConnectionSafe> sqlite_connection)
-        : lsls_db_([safe_connection = std::move(sqlite_connection)] {
-          return make_unique<DialogDbImpl>(safe_connection->get().clone());
+        : lsls_db_([safe_connection = std::move(sqlite_connection),
+                    notification_group_index = std::make_shared<NotificationGroupIndex>()] {
+          return td::make_unique<DialogDbImpl>(safe_connection->get().clone(), notification_group_index);
         }) {
     }
     DialogDbSyncInterface &get() final {
@@ -377,6 +459,7 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
 
     void add_dialog(DialogId dialog_id, FolderId folder_id, int64 order, BufferSlice data,
                     vector<NotificationGroupKey> notification_groups, Promise<Unit> promise) {
+      update_cached_dialog_date(dialog_id, folder_id, order);
       add_write_query([this, dialog_id, folder_id, order, promise = std::move(promise), data = std::move(data),
                        notification_groups = std::move(notification_groups)](Unit) mutable {
         sync_db_->add_dialog(dialog_id, folder_id, order, std::move(data), std::move(notification_groups));
@@ -413,7 +496,25 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
     void get_dialogs(FolderId folder_id, int64 order, DialogId dialog_id, int32 limit,
                      Promise<DialogDbGetDialogsResult> promise) {
       add_read_query();
-      promise.set_value(sync_db_->get_dialogs(folder_id, order, dialog_id, limit));
+      const auto &dialog_dates = get_folder_dialog_dates(folder_id);
+
+      // only the dialogs from the requested page are loaded
+      DialogDbGetDialogsResult result;
+      result.next_order = order;
+      result.next_dialog_id = dialog_id;
+      for (auto it = dialog_dates.upper_bound(DialogDate(order, dialog_id));
+           it != dialog_dates.end() && static_cast<int32>(result.dialogs.size()) < limit; ++it) {
+        auto r_data = sync_db_->get_dialog(it->get_dialog_id());
+        if (r_data.is_error()) {
+          LOG(ERROR) << "Failed to load " << it->get_dialog_id() << " from the dialog list cache: " << r_data.error();
+          continue;
+        }
+        result.next_order = it->get_order();
+        result.next_dialog_id = it->get_dialog_id();
+        LOG(INFO) << "Load " << result.next_dialog_id << " with order " << result.next_order;
+        result.dialogs.push_back(r_data.move_as_ok());
+      }
+      promise.set_value(std::move(result));
     }
 
     void close(Promise<Unit> promise) {
@@ -433,6 +534,15 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
     std::shared_ptr<DialogDbSyncSafeInterface> sync_db_safe_;
     DialogDbSyncInterface *sync_db_ = nullptr;
 
+    struct CachedDialog {
+      FolderId folder_id;
+      int64 order = 0;
+    };
+
+    // ordered dialog lists of the folders, which were already loaded from the database
+    std::map<int32, std::set<DialogDate>> folder_dialog_dates_;
+    FlatHashMap<DialogId, CachedDialog, DialogIdHash> cached_dialogs_;
+
     static constexpr size_t MAX_PENDING_QUERIES_COUNT{50};
     static constexpr double MAX_PENDING_QUERIES_DELAY{0.01};
 
@@ -441,6 +551,40 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
     vector<Promise<Unit>> pending_writes_;  // TODO use Action
     double wakeup_at_ = 0;
 
+    const std::set<DialogDate> &get_folder_dialog_dates(FolderId folder_id) {
+      auto it = folder_dialog_dates_.find(folder_id.get());
+      if (it != folder_dialog_dates_.end()) {
+        return it->second;
+      }
+
+      auto &dialog_dates = folder_dialog_dates_[folder_id.get()];
+      for (auto &dialog_date : sync_db_->get_dialog_dates(folder_id)) {
+        dialog_dates.insert(dialog_dates.end(), dialog_date);
+        cached_dialogs_[dialog_date.get_dialog_id()] = {folder_id, dialog_date.get_order()};
+      }
+      LOG(INFO) << "Cache " << dialog_dates.size() << " chats in " << folder_id;
+      return dialog_dates;
+    }
+
+    void update_cached_dialog_date(DialogId dialog_id, FolderId folder_id, int64 order) {
+      auto it = cached_dialogs_.find(dialog_id);
+      if (it != cached_dialogs_.end()) {
+        auto folder_it = folder_dialog_dates_.find(it->second.folder_id.get());
+        CHECK(folder_it != folder_dialog_dates_.end());
+        folder_it->second.erase(DialogDate(it->second.order, dialog_id));
+        cached_dialogs_.erase(it);
+      }
+      if (order <= 0) {
+        // the dialog isn't stored in any folder
+        return;
+      }
+      auto folder_it = folder_dialog_dates_.find(folder_id.get());
+      if (folder_it != folder_dialog_dates_.end()) {
+        folder_it->second.insert(DialogDate(order, dialog_id));
+        cached_dialogs_[dialog_id] = {folder_id, order};
+      }
+    }
+
     template <class F>
     void add_write_query(F &&f) {
       pending_writes_.push_back(PromiseCreator::lambda(std::forward<F>(f)));
@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/telegram/DialogDate.h"
 #include "td/telegram/DialogId.h"
 #include "td/telegram/FolderId.h"
 #include "td/telegram/NotificationGroupId.h"
@@ -46,6 +47,9 @@ class DialogDbSyncInterface {
 
   virtual DialogDbGetDialogsResult get_dialogs(FolderId folder_id, int64 order, DialogId dialog_id, int32 limit) = 0;
 
+  // returns dates of all dialogs in the folder in the list order; uses only the index and doesn't load dialogs
+  virtual vector<DialogDate> get_dialog_dates(FolderId folder_id) = 0;
+
   virtual vector<NotificationGroupKey> get_notification_groups_by_last_notification_date(
       NotificationGroupKey notification_group_key, int32 limit) = 0;
 
@@ -177,7 +177,27 @@ Result<unique_ptr<DialogFilter>> DialogFilter::create_dialog_filter(Td *td, Dial
   return std::move(dialog_filter);
 }
 
+int32 DialogFilter::DialogIdIndex::get_flags(const DialogFilter &filter, DialogId dialog_id) {
+  if (!is_inited_) {
+    is_inited_ = true;
+    auto add_dialog_ids = [&](const vector<InputDialogId> &input_dialog_ids, int32 flag) {
+      for (auto &input_dialog_id : input_dialog_ids) {
+        dialog_id_flags_[input_dialog_id.get_dialog_id()] |= flag;
+      }
+    };
+    add_dialog_ids(filter.pinned_dialog_ids_, PINNED);
+    add_dialog_ids(filter.included_dialog_ids_, INCLUDED);
+    add_dialog_ids(filter.excluded_dialog_ids_, EXCLUDED);
+  }
+  auto it = dialog_id_flags_.find(dialog_id);
+  if (it == dialog_id_flags_.end()) {
+    return 0;
+  }
+  return it->second;
+}
+
 void DialogFilter::set_dialog_is_pinned(InputDialogId input_dialog_id, bool is_pinned) {
+  dialog_id_index_.reset();
   auto dialog_id = input_dialog_id.get_dialog_id();
   if (is_pinned) {
     pinned_dialog_ids_.insert(pinned_dialog_ids_.begin(), input_dialog_id);
@@ -191,6 +211,7 @@ void DialogFilter::set_dialog_is_pinned(InputDialogId input_dialog_id, bool is_p
 }
 
 void DialogFilter::set_pinned_dialog_ids(vector<InputDialogId> &&input_dialog_ids) {
+  dialog_id_index_.reset();
   FlatHashSet<DialogId, DialogIdHash> new_pinned_dialog_ids;
   for (auto input_dialog_id : input_dialog_ids) {
     auto dialog_id = input_dialog_id.get_dialog_id();
@@ -210,11 +231,13 @@ void DialogFilter::set_pinned_dialog_ids(vector<InputDialogId> &&input_dialog_id
 }
 
 void DialogFilter::include_dialog(InputDialogId input_dialog_id) {
+  dialog_id_index_.reset();
   included_dialog_ids_.push_back(input_dialog_id);
   InputDialogId::remove(excluded_dialog_ids_, input_dialog_id.get_dialog_id());
 }
 
 void DialogFilter::remove_secret_chat_dialog_ids() {
+  dialog_id_index_.reset();
   auto remove_secret_chats = [](vector<InputDialogId> &input_dialog_ids) {
     td::remove_if(input_dialog_ids, [](InputDialogId input_dialog_id) {
       return input_dialog_id.get_dialog_id().get_type() == DialogType::SecretChat;
@@ -226,6 +249,7 @@ void DialogFilter::remove_secret_chat_dialog_ids() {
 }
 
 void DialogFilter::remove_dialog_id(DialogId dialog_id) {
+  dialog_id_index_.reset();
   InputDialogId::remove(pinned_dialog_ids_, dialog_id);
   InputDialogId::remove(included_dialog_ids_, dialog_id);
   InputDialogId::remove(excluded_dialog_ids_, dialog_id);
@@ -246,11 +270,11 @@ bool DialogFilter::is_empty(bool for_server) const {
 }
 
 bool DialogFilter::is_dialog_pinned(DialogId dialog_id) const {
-  return InputDialogId::contains(pinned_dialog_ids_, dialog_id);
+  return (get_dialog_id_flags(dialog_id) & DialogIdIndex::PINNED) != 0;
 }
 
 bool DialogFilter::is_dialog_included(DialogId dialog_id) const {
-  return InputDialogId::contains(included_dialog_ids_, dialog_id) || is_dialog_pinned(dialog_id);
+  return (get_dialog_id_flags(dialog_id) & (DialogIdIndex::PINNED | DialogIdIndex::INCLUDED)) != 0;
 }
 
 bool DialogFilter::can_include_dialog(DialogId dialog_id) const {
@@ -684,6 +708,7 @@ unique_ptr<DialogFilter> DialogFilter::merge_dialog_filter_changes(const DialogF
 
 void DialogFilter::sort_input_dialog_ids(const Td *td, const char *source) {
   if (!include_contacts_ && !include_non_contacts_ && !include_bots_ && !include_groups_ && !include_channels_) {
+    dialog_id_index_.reset();
     excluded_dialog_ids_.clear();
   }
 
@@ -759,20 +784,21 @@ vector<FolderId> DialogFilter::get_folder_ids() const {
 
 bool DialogFilter::need_dialog(const Td *td, const DialogFilterDialogInfo &dialog_info) const {
   auto dialog_id = dialog_info.dialog_id_;
-  if (is_dialog_included(dialog_id)) {
+  auto flags = get_dialog_id_flags(dialog_id);
+  if ((flags & (DialogIdIndex::PINNED | DialogIdIndex::INCLUDED)) != 0) {
     return true;
   }
-  if (InputDialogId::contains(excluded_dialog_ids_, dialog_id)) {
+  if ((flags & DialogIdIndex::EXCLUDED) != 0) {
     return false;
   }
   if (dialog_id.get_type() == DialogType::SecretChat) {
     auto user_id = td->user_manager_->get_secret_chat_user_id(dialog_id.get_secret_chat_id());
     if (user_id.is_valid()) {
-      auto user_dialog_id = DialogId(user_id);
-      if (is_dialog_included(user_dialog_id)) {
+      auto user_flags = get_dialog_id_flags(DialogId(user_id));
+      if ((user_flags & (DialogIdIndex::PINNED | DialogIdIndex::INCLUDED)) != 0) {
         return true;
       }
-      if (InputDialogId::contains(excluded_dialog_ids_, user_dialog_id)) {
+      if ((user_flags & DialogIdIndex::EXCLUDED) != 0) {
         return false;
       }
     }
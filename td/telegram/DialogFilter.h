@@ -137,11 +137,43 @@ class DialogFilter {
   bool is_shareable_ = false;
   bool has_my_invites_ = false;
 
+  // lazily built index of explicitly specified chats, which is reset whenever the filter is changed or copied
+  class DialogIdIndex {
+   public:
+    static constexpr int32 PINNED = 1;
+    static constexpr int32 INCLUDED = 2;
+    static constexpr int32 EXCLUDED = 4;
+
+    DialogIdIndex() = default;
+    DialogIdIndex(const DialogIdIndex &) {
+    }
+    DialogIdIndex &operator=(const DialogIdIndex &) {
+      reset();
+      return *this;
+    }
+
+    void reset() {
+      is_inited_ = false;
+      dialog_id_flags_ = {};
+    }
+
+    int32 get_flags(const DialogFilter &filter, DialogId dialog_id);
+
+   private:
+    bool is_inited_ = false;
+    FlatHashMap<DialogId, int32, DialogIdHash> dialog_id_flags_;
+  };
+  mutable DialogIdIndex dialog_id_index_;
+
   static FlatHashMap<string, string> emoji_to_icon_name_;
   static FlatHashMap<string, string> icon_name_to_emoji_;
 
   static bool is_valid_color_id(int32 color_id);
 
+  int32 get_dialog_id_flags(DialogId dialog_id) const {
+    return dialog_id_index_.get_flags(*this, dialog_id);
+  }
+
   static bool are_flags_equal(const DialogFilter &lhs, const DialogFilter &rhs);
 
   static void init_icon_names();
@@ -1032,15 +1032,26 @@ void DialogParticipantManager::update_dialog_online_member_count(const vector<Di
   if (td_->auth_manager_->is_bot()) {
     return;
   }
+
+  vector<UserId> user_ids;
+  for (const auto &participant : participants) {
+    if (participant.dialog_id_.get_type() == DialogType::User) {
+      user_ids.push_back(participant.dialog_id_.get_user_id());
+    }
+  }
+  update_dialog_online_member_count(user_ids, dialog_id, is_from_server);
+}
+
+void DialogParticipantManager::update_dialog_online_member_count(const vector<UserId> &user_ids, DialogId dialog_id,
+                                                                 bool is_from_server) {
+  if (td_->auth_manager_->is_bot()) {
+    return;
+  }
   CHECK(dialog_id.is_valid());
 
   int32 online_member_count = 0;
   int32 unix_time = G()->unix_time();
-  for (const auto &participant : participants) {
-    if (participant.dialog_id_.get_type() != DialogType::User) {
-      continue;
-    }
-    auto user_id = participant.dialog_id_.get_user_id();
+  for (auto user_id : user_ids) {
     if (!td_->user_manager_->is_user_deleted(user_id) && !td_->user_manager_->is_user_bot(user_id)) {
       if (td_->user_manager_->is_user_online(user_id, 0, unix_time)) {
         online_member_count++;
@@ -2802,8 +2813,23 @@ const DialogParticipant *DialogParticipantManager::get_channel_participant_from_
 }
 
 void DialogParticipantManager::set_cached_channel_participants(ChannelId channel_id,
-                                                               vector<DialogParticipant> participants) {
-  cached_channel_participants_[channel_id] = std::move(participants);
+                                                               const vector<DialogParticipant> &participants) {
+  vector<UserId> user_ids;
+  user_ids.reserve(participants.size());
+  for (const auto &participant : participants) {
+    if (participant.dialog_id_.get_type() == DialogType::User && participant.status_.is_member()) {
+      user_ids.push_back(participant.dialog_id_.get_user_id());
+    }
+  }
+  std::sort(user_ids.begin(), user_ids.end(), [](UserId lhs, UserId rhs) { return lhs.get() < rhs.get(); });
+  user_ids.erase(std::unique(user_ids.begin(), user_ids.end()), user_ids.end());
+  user_ids.shrink_to_fit();
+  cached_channel_participants_[channel_id] = std::move(user_ids);
+}
+
+static vector<UserId>::iterator get_cached_channel_participant(vector<UserId> &user_ids, UserId user_id) {
+  return std::lower_bound(user_ids.begin(), user_ids.end(), user_id,
+                          [](UserId lhs, UserId rhs) { return lhs.get() < rhs.get(); });
 }
 
 void DialogParticipantManager::drop_cached_channel_participants(ChannelId channel_id) {
@@ -2811,29 +2837,22 @@ void DialogParticipantManager::drop_cached_channel_participants(ChannelId channe
 }
 
 void DialogParticipantManager::add_cached_channel_participants(ChannelId channel_id,
-                                                               const vector<UserId> &added_user_ids,
-                                                               UserId inviter_user_id, int32 date) {
+                                                               const vector<UserId> &added_user_ids) {
   auto it = cached_channel_participants_.find(channel_id);
   if (it == cached_channel_participants_.end()) {
     return;
   }
-  auto &participants = it->second;
+  auto &user_ids = it->second;
   bool is_participants_cache_changed = false;
   for (auto user_id : added_user_ids) {
     if (!user_id.is_valid()) {
       continue;
     }
 
-    bool is_found = false;
-    for (const auto &participant : participants) {
-      if (participant.dialog_id_ == DialogId(user_id)) {
-        is_found = true;
-        break;
-      }
-    }
-    if (!is_found) {
+    auto user_it = get_cached_channel_participant(user_ids, user_id);
+    if (user_it == user_ids.end() || *user_it != user_id) {
       is_participants_cache_changed = true;
-      participants.emplace_back(DialogId(user_id), inviter_user_id, date, DialogParticipantStatus::Member());
+      user_ids.insert(user_it, user_id);
     }
   }
   if (is_participants_cache_changed) {
@@ -2850,13 +2869,11 @@ void DialogParticipantManager::delete_cached_channel_participant(ChannelId chann
   if (it == cached_channel_participants_.end()) {
     return;
   }
-  auto &participants = it->second;
-  for (size_t i = 0; i < participants.size(); i++) {
-    if (participants[i].dialog_id_ == DialogId(deleted_user_id)) {
-      participants.erase(participants.begin() + i);
-      update_channel_online_member_count(channel_id, false);
-      break;
-    }
+  auto &user_ids = it->second;
+  auto user_it = get_cached_channel_participant(user_ids, deleted_user_id);
+  if (user_it != user_ids.end() && *user_it == deleted_user_id) {
+    user_ids.erase(user_it);
+    update_channel_online_member_count(channel_id, false);
   }
 }
 
@@ -2866,22 +2883,15 @@ void DialogParticipantManager::update_cached_channel_participant_status(ChannelI
   if (it == cached_channel_participants_.end()) {
     return;
   }
-  auto &participants = it->second;
-  bool is_found = false;
-  for (size_t i = 0; i < participants.size(); i++) {
-    if (participants[i].dialog_id_ == DialogId(user_id)) {
-      if (!status.is_member()) {
-        participants.erase(participants.begin() + i);
-        update_channel_online_member_count(channel_id, false);
-      } else {
-        participants[i].status_ = status;
-      }
-      is_found = true;
-      break;
+  auto &user_ids = it->second;
+  auto user_it = get_cached_channel_participant(user_ids, user_id);
+  bool is_found = user_it != user_ids.end() && *user_it == user_id;
+  if (is_found != status.is_member()) {
+    if (is_found) {
+      user_ids.erase(user_it);
+    } else {
+      user_ids.insert(user_it, user_id);
     }
-  }
-  if (!is_found && status.is_member()) {
-    participants.emplace_back(DialogId(user_id), td_->user_manager_->get_my_id(), G()->unix_time(), status);
     update_channel_online_member_count(channel_id, false);
   }
 }
@@ -2989,6 +2999,20 @@ void DialogParticipantManager::transfer_channel_ownership(
       ->send(channel_id, user_id, std::move(input_check_password));
 }
 
+void DialogParticipantManager::optimize_memory() {
+  dialog_online_member_counts_.shrink_to_fit();
+  for (auto &it : user_online_member_dialogs_) {
+    it.second->online_member_dialogs_.shrink_to_fit();
+  }
+  user_online_member_dialogs_.shrink_to_fit();
+  dialog_administrators_.shrink_to_fit();
+  for (auto &it : channel_participants_) {
+    it.second.participants_.shrink_to_fit();
+  }
+  channel_participants_.shrink_to_fit();
+  cached_channel_participants_.shrink_to_fit();
+}
+
 void DialogParticipantManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   for (const auto &it : dialog_online_member_counts_) {
     auto dialog_id = it.first;
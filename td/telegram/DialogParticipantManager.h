@@ -49,8 +49,7 @@ class DialogParticipantManager final : public Actor {
 
   void on_update_dialog_online_member_count(DialogId dialog_id, int32 online_member_count, bool is_from_server);
 
-  void add_cached_channel_participants(ChannelId channel_id, const vector<UserId> &added_user_ids,
-                                       UserId inviter_user_id, int32 date);
+  void add_cached_channel_participants(ChannelId channel_id, const vector<UserId> &added_user_ids);
 
   void delete_cached_channel_participant(ChannelId channel_id, UserId deleted_user_id);
 
@@ -150,6 +149,8 @@ class DialogParticipantManager final : public Actor {
 
   void transfer_dialog_ownership(DialogId dialog_id, UserId user_id, const string &password, Promise<Unit> &&promise);
 
+  void optimize_memory();
+
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
  private:
@@ -269,7 +270,9 @@ class DialogParticipantManager final : public Actor {
 
   void on_channel_participant_cache_timeout(ChannelId channel_id);
 
-  void set_cached_channel_participants(ChannelId channel_id, vector<DialogParticipant> participants);
+  void update_dialog_online_member_count(const vector<UserId> &user_ids, DialogId dialog_id, bool is_from_server);
+
+  void set_cached_channel_participants(ChannelId channel_id, const vector<DialogParticipant> &participants);
 
   void drop_cached_channel_participants(ChannelId channel_id);
 
@@ -304,7 +307,8 @@ class DialogParticipantManager final : public Actor {
   };
   FlatHashMap<ChannelId, ChannelParticipants, ChannelIdHash> channel_participants_;
 
-  FlatHashMap<ChannelId, vector<DialogParticipant>, ChannelIdHash> cached_channel_participants_;
+  // sorted identifiers of recent members of megagroups, which are used to calculate online member count
+  FlatHashMap<ChannelId, vector<UserId>, ChannelIdHash> cached_channel_participants_;
 
   FlatHashMap<ChannelId, vector<Promise<td_api::object_ptr<td_api::failedToAddMembers>>>, ChannelIdHash>
       join_channel_queries_;
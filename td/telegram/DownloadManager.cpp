@@ -28,6 +28,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <set>
 
@@ -227,8 +228,64 @@ class DownloadManagerImpl final : public DownloadManager {
       }
       offset_int64 = r_offset.move_as_ok();
     }
-    auto download_ids = hints_.search(query, 10000, true).second;
+    vector<int64> download_ids;
     FileCounters counters;
+    if (query.empty()) {
+      // all files match, so the counters are already known and the files are taken from the ordered sets
+      counters = file_counters_;
+      download_ids = get_download_ids(only_active, only_completed, offset_int64, limit);
+    } else {
+      download_ids = search_download_ids(query, only_active, only_completed, offset_int64, limit, counters);
+    }
+    auto file_downloads = transform(download_ids, [&](int64 download_id) {
+      on_file_viewed(download_id);
+
+      auto it = files_.find(download_id);
+      CHECK(it != files_.end());
+      const FileInfo &file_info = *it->second;
+      return callback_->get_file_download_object(file_info.file_id, file_info.file_source_id, file_info.created_at,
+                                                 file_info.completed_at, file_info.is_paused);
+    });
+    td::remove_if(file_downloads, [](const auto &file_download) { return file_download->message_ == nullptr; });
+    string next_offset;
+    if (!download_ids.empty()) {
+      next_offset = to_string(download_ids.back());
+    }
+    promise.set_value(td_api::make_object<td_api::foundFileDownloads>(counters.get_downloaded_file_counts_object(),
+                                                                      std::move(file_downloads), next_offset));
+  }
+
+  // returns identifiers of the newest files with identifier less than offset
+  vector<int64> get_download_ids(bool only_active, bool only_completed, int64 offset, int32 limit) const {
+    auto active_it = std::make_reverse_iterator(active_download_ids_.lower_bound(offset));
+    auto active_end = active_download_ids_.rend();
+    if (only_completed) {
+      active_it = active_end;
+    }
+    auto completed_it = std::make_reverse_iterator(completed_download_ids_.lower_bound(offset));
+    auto completed_end = completed_download_ids_.rend();
+    if (only_active) {
+      completed_it = completed_end;
+    }
+
+    vector<int64> download_ids;
+    while (static_cast<int32>(download_ids.size()) < limit) {
+      bool has_active = active_it != active_end;
+      bool has_completed = completed_it != completed_end;
+      if (has_active && (!has_completed || *active_it > *completed_it)) {
+        download_ids.push_back(*active_it++);
+      } else if (has_completed) {
+        download_ids.push_back(*completed_it++);
+      } else {
+        break;
+      }
+    }
+    return download_ids;
+  }
+
+  vector<int64> search_download_ids(const string &query, bool only_active, bool only_completed, int64 offset,
+                                    int32 limit, FileCounters &counters) {
+    auto download_ids = hints_.search(query, 10000, true).second;
     td::remove_if(download_ids, [&](int64 download_id) {
       auto r_file_info_ptr = get_file_info_ptr(download_id);
       CHECK(r_file_info_ptr.is_ok());
@@ -247,31 +304,18 @@ class DownloadManagerImpl final : public DownloadManager {
           return true;
         }
       }
-      if (download_id >= offset_int64) {
+      if (download_id >= offset) {
         return true;
       }
       return false;
     });
-    std::sort(download_ids.begin(), download_ids.end(), std::greater<>());
     if (static_cast<int32>(download_ids.size()) > limit) {
+      std::partial_sort(download_ids.begin(), download_ids.begin() + limit, download_ids.end(), std::greater<>());
       download_ids.resize(limit);
+    } else {
+      std::sort(download_ids.begin(), download_ids.end(), std::greater<>());
     }
-    auto file_downloads = transform(download_ids, [&](int64 download_id) {
-      on_file_viewed(download_id);
-
-      auto it = files_.find(download_id);
-      CHECK(it != files_.end());
-      const FileInfo &file_info = *it->second;
-      return callback_->get_file_download_object(file_info.file_id, file_info.file_source_id, file_info.created_at,
-                                                 file_info.completed_at, file_info.is_paused);
-    });
-    td::remove_if(file_downloads, [](const auto &file_download) { return file_download->message_ == nullptr; });
-    string next_offset;
-    if (!download_ids.empty()) {
-      next_offset = to_string(download_ids.back());
-    }
-    promise.set_value(td_api::make_object<td_api::foundFileDownloads>(counters.get_downloaded_file_counts_object(),
-                                                                      std::move(file_downloads), next_offset));
+    return download_ids;
   }
 
   void update_file_download_state(FileId internal_file_id, int64 downloaded_size, int64 size, int64 expected_size,
@@ -344,6 +388,7 @@ class DownloadManagerImpl final : public DownloadManager {
   FlatHashMap<FileId, int64, FileIdHash> by_file_id_;
   FlatHashMap<FileId, int64, FileIdHash> by_internal_file_id_;
   FlatHashMap<int64, unique_ptr<FileInfo>> files_;
+  std::set<int64> active_download_ids_;
   std::set<int64> completed_download_ids_;
   FlatHashSet<int64> unviewed_completed_download_ids_;
   Hints hints_;
@@ -558,6 +603,7 @@ class DownloadManagerImpl final : public DownloadManager {
         callback_->start_file(it->second->internal_file_id, it->second->priority,
                               actor_shared(this, it->second->link_token));
       }
+      active_download_ids_.insert(download_id);
     }
     if (is_search_inited_) {
       callback_->update_file_added(it->second->file_id, it->second->file_source_id, it->second->created_at,
@@ -579,6 +625,7 @@ class DownloadManagerImpl final : public DownloadManager {
     by_internal_file_id_.erase(file_info.internal_file_id);
     by_file_id_.erase(file_id);
     hints_.remove(download_id);
+    active_download_ids_.erase(download_id);
     completed_download_ids_.erase(download_id);
 
     remove_from_database(file_info);
@@ -733,6 +780,7 @@ class DownloadManagerImpl final : public DownloadManager {
       file_info.completed_at = G()->unix_time();
       file_info.need_save_to_database = true;
 
+      active_download_ids_.erase(file_info.download_id);
       bool is_inserted = completed_download_ids_.insert(file_info.download_id).second;
       CHECK(is_inserted);
       if (file_info.is_counted) {
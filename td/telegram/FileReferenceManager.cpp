@@ -11,6 +11,7 @@
 #include "td/telegram/BackgroundManager.h"
 #include "td/telegram/ChatManager.h"
 #include "td/telegram/ConfigManager.h"
+#include "td/telegram/DialogId.h"
 #include "td/telegram/DialogManager.h"
 #include "td/telegram/files/FileManager.h"
 #include "td/telegram/Global.h"
@@ -27,6 +28,7 @@
 
 #include "td/utils/algorithm.h"
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/overloaded.h"
@@ -317,13 +319,59 @@ void FileReferenceManager::send_query(Destination dest, FileSourceId file_source
     send_closure(file_manager_actor_id, &FileManager::on_file_reference_repaired, dest.node_id, file_source_id,
                  std::move(result), std::move(new_promise));
   });
+  add_file_source_query(file_source_id, std::move(promise));
+}
+
+void FileReferenceManager::add_file_source_query(FileSourceId file_source_id, Promise<Unit> &&promise) {
+  // many files can share the same file source, so the source is reloaded once for all of them
+  auto &promises = file_source_queries_[file_source_id];
+  promises.push_back(std::move(promise));
+  if (promises.size() != 1) {
+    VLOG(file_references) << "Wait for the already sent query for " << file_source_id;
+    return;
+  }
+
+  auto index = static_cast<size_t>(file_source_id.get()) - 1;
+  CHECK(index < file_sources_.size());
+  auto file_source_type = file_sources_[index].get_offset();
+  CHECK(file_source_type >= 0);
+  if (static_cast<size_t>(file_source_type) >= file_source_type_queries_.size()) {
+    file_source_type_queries_.resize(file_source_type + 1);
+  }
+  auto &type_queries = file_source_type_queries_[file_source_type];
+  if (type_queries.active_query_count >= get_max_active_file_source_queries(file_source_type)) {
+    VLOG(file_references) << "Delay query for " << file_source_id;
+    type_queries.pending_file_source_ids.push(file_source_id);
+    return;
+  }
+  type_queries.active_query_count++;
+  send_file_source_query(file_source_id);
+}
+
+int32 FileReferenceManager::get_max_active_file_source_queries(int32 file_source_type) const {
+  if (file_source_type == FileSource::offset<FileSourceMessage>()) {
+    return MAX_ACTIVE_MESSAGE_FILE_SOURCE_QUERIES;
+  }
+  return MAX_ACTIVE_FILE_SOURCE_QUERIES;
+}
+
+void FileReferenceManager::send_file_source_query(FileSourceId file_source_id) {
   auto index = static_cast<size_t>(file_source_id.get()) - 1;
   CHECK(index < file_sources_.size());
+  if (file_sources_[index].get_offset() == FileSource::offset<FileSourceMessage>()) {
+    // messages are reloaded after all currently received repair requests are added
+    if (pending_message_file_source_ids_.empty()) {
+      send_closure_later(actor_id(this), &FileReferenceManager::send_get_messages_queries);
+    }
+    pending_message_file_source_ids_.push_back(file_source_id);
+    return;
+  }
+
+  auto promise = PromiseCreator::lambda([actor_id = actor_id(this), file_source_id](Result<Unit> result) {
+    send_closure(actor_id, &FileReferenceManager::on_file_source_query_result, file_source_id, std::move(result));
+  });
   file_sources_[index].visit(overloaded(
-      [&](const FileSourceMessage &source) {
-        send_closure_later(G()->messages_manager(), &MessagesManager::get_message_from_server, source.message_full_id,
-                           std::move(promise), "FileSourceMessage", nullptr);
-      },
+      [&](const FileSourceMessage &source) { UNREACHABLE(); },
       [&](const FileSourceUserPhoto &source) {
         send_closure_later(G()->user_manager(), &UserManager::reload_user_profile_photo, source.user_id,
                            source.photo_id, std::move(promise));
@@ -399,6 +447,71 @@ void FileReferenceManager::send_query(Destination dest, FileSourceId file_source
       }));
 }
 
+void FileReferenceManager::send_get_messages_queries() {
+  // messages from different chats are reloaded separately, so an inaccessible chat doesn't affect other chats
+  FlatHashMap<DialogId, vector<FileSourceId>, DialogIdHash> dialog_file_source_ids;
+  for (auto file_source_id : pending_message_file_source_ids_) {
+    auto index = static_cast<size_t>(file_source_id.get()) - 1;
+    CHECK(index < file_sources_.size());
+    auto dialog_id = file_sources_[index].get<FileSourceMessage>().message_full_id.get_dialog_id();
+    dialog_file_source_ids[dialog_id].push_back(file_source_id);
+  }
+  pending_message_file_source_ids_.clear();
+
+  for (auto &it : dialog_file_source_ids) {
+    auto message_full_ids = transform(it.second, [&](FileSourceId file_source_id) {
+      auto index = static_cast<size_t>(file_source_id.get()) - 1;
+      return file_sources_[index].get<FileSourceMessage>().message_full_id;
+    });
+    VLOG(file_references) << "Reload " << message_full_ids.size() << " messages from " << it.first;
+    auto promise = PromiseCreator::lambda(
+        [actor_id = actor_id(this), file_source_ids = std::move(it.second)](Result<Unit> result) mutable {
+          send_closure(actor_id, &FileReferenceManager::on_file_source_queries_result, std::move(file_source_ids),
+                       std::move(result));
+        });
+    send_closure_later(G()->messages_manager(), &MessagesManager::get_messages_from_server, std::move(message_full_ids),
+                       std::move(promise), "FileSourceMessage", nullptr);
+  }
+}
+
+void FileReferenceManager::on_file_source_queries_result(vector<FileSourceId> &&file_source_ids,
+                                                         Result<Unit> &&result) {
+  for (auto file_source_id : file_source_ids) {
+    if (result.is_error()) {
+      on_file_source_query_result(file_source_id, result.error().clone());
+    } else {
+      on_file_source_query_result(file_source_id, Unit());
+    }
+  }
+}
+
+void FileReferenceManager::on_file_source_query_result(FileSourceId file_source_id, Result<Unit> &&result) {
+  auto it = file_source_queries_.find(file_source_id);
+  CHECK(it != file_source_queries_.end());
+  auto promises = std::move(it->second);
+  file_source_queries_.erase(it);
+
+  auto index = static_cast<size_t>(file_source_id.get()) - 1;
+  CHECK(index < file_sources_.size());
+  auto file_source_type = file_sources_[index].get_offset();
+  auto &type_queries = file_source_type_queries_[file_source_type];
+  CHECK(type_queries.active_query_count > 0);
+  type_queries.active_query_count--;
+  while (!type_queries.pending_file_source_ids.empty() &&
+         type_queries.active_query_count < get_max_active_file_source_queries(file_source_type)) {
+    type_queries.active_query_count++;
+    send_file_source_query(type_queries.pending_file_source_ids.pop());
+  }
+
+  VLOG(file_references) << "Receive result of query for " << file_source_id << " for " << promises.size()
+                        << " files";
+  if (result.is_error()) {
+    fail_promises(promises, result.move_as_error());
+  } else {
+    set_promises(promises);
+  }
+}
+
 FileReferenceManager::Destination FileReferenceManager::on_query_result(Destination dest, FileSourceId file_source_id,
                                                                         Status status, int32 sub) {
   if (G()->close_flag()) {
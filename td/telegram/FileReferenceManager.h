@@ -22,11 +22,13 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/logging.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 #include "td/utils/Variant.h"
+#include "td/utils/VectorQueue.h"
 #include "td/utils/WaitFreeHashMap.h"
 #include "td/utils/WaitFreeVector.h"
 
@@ -191,6 +193,20 @@ class FileReferenceManager final : public Actor {
 
   int64 query_generation_{0};
 
+  static constexpr int32 MAX_ACTIVE_FILE_SOURCE_QUERIES = 10;
+  static constexpr int32 MAX_ACTIVE_MESSAGE_FILE_SOURCE_QUERIES = 100;
+
+  struct FileSourceTypeQueries {
+    int32 active_query_count = 0;
+    VectorQueue<FileSourceId> pending_file_source_ids;
+  };
+  // promises of repair queries, which are sent or wait for sending, for each file source
+  FlatHashMap<FileSourceId, vector<Promise<Unit>>, FileSourceIdHash> file_source_queries_;
+  vector<FileSourceTypeQueries> file_source_type_queries_;  // indexed by file source type
+
+  // message file sources, which will be reloaded in one request for each chat
+  vector<FileSourceId> pending_message_file_source_ids_;
+
   WaitFreeHashMap<NodeId, unique_ptr<Node>, FileIdHash> nodes_;
 
   ActorShared<> parent_;
@@ -199,6 +215,18 @@ class FileReferenceManager final : public Actor {
 
   void run_node(NodeId node);
   void send_query(Destination dest, FileSourceId file_source_id);
+
+  void add_file_source_query(FileSourceId file_source_id, Promise<Unit> &&promise);
+
+  int32 get_max_active_file_source_queries(int32 file_source_type) const;
+
+  void send_file_source_query(FileSourceId file_source_id);
+
+  void send_get_messages_queries();
+
+  void on_file_source_query_result(FileSourceId file_source_id, Result<Unit> &&result);
+
+  void on_file_source_queries_result(vector<FileSourceId> &&file_source_ids, Result<Unit> &&result);
   Destination on_query_result(Destination dest, FileSourceId file_source_id, Status status, int32 sub = 0);
 
   template <class T>
@@ -31,6 +31,9 @@ Global::Global() {
   database_scheduler_id_ = min(current_scheduler_id + 1, max_scheduler_id);
   gc_scheduler_id_ = min(current_scheduler_id + 2, max_scheduler_id);
   slow_net_scheduler_id_ = min(current_scheduler_id + 3, max_scheduler_id);
+  crypto_scheduler_id_ = min(current_scheduler_id + 4, max_scheduler_id);
+  // file I/O is done in the garbage collection thread if there is no dedicated thread for it
+  file_io_scheduler_id_ = current_scheduler_id + 5 <= max_scheduler_id ? current_scheduler_id + 5 : gc_scheduler_id_;
 }
 
 Global::~Global() = default;
@@ -258,6 +261,7 @@ DcId Global::get_webfile_dc_id() const {
 }
 
 void Global::set_net_query_stats(std::shared_ptr<NetQueryStats> net_query_stats) {
+  net_query_stats_ = net_query_stats;
   net_query_creator_.set_create_func(
       [net_query_stats = std::move(net_query_stats)] { return td::make_unique<NetQueryCreator>(net_query_stats); });
 }
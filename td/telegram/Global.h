@@ -130,6 +130,11 @@ class Global final : public ActorContext {
 
   void set_net_query_stats(std::shared_ptr<NetQueryStats> net_query_stats);
 
+  // returns nullptr if network query statistics aren't collected
+  NetQueryStats *get_net_query_stats() const {
+    return net_query_stats_.get();
+  }
+
   void set_net_query_dispatcher(unique_ptr<NetQueryDispatcher> net_query_dispatcher);
 
   NetQueryDispatcher &net_query_dispatcher() {
@@ -557,6 +562,14 @@ class Global final : public ActorContext {
     return slow_net_scheduler_id_;
   }
 
+  int32 get_crypto_scheduler_id() const {
+    return crypto_scheduler_id_;
+  }
+
+  int32 get_file_io_scheduler_id() const {
+    return file_io_scheduler_id_;
+  }
+
   DcId get_webfile_dc_id() const;
 
   std::shared_ptr<DhConfig> get_dh_config() {
@@ -579,7 +592,8 @@ class Global final : public ActorContext {
   }
 
   static Status request_aborted_error() {
-    return Status::Error(500, "Request aborted");
+    static const Status status = Status::StaticError(500, "Request aborted");
+    return status.clone();
   }
 
   template <class T>
@@ -699,6 +713,8 @@ class Global final : public ActorContext {
   int32 database_scheduler_id_ = 0;
   int32 gc_scheduler_id_ = 0;
   int32 slow_net_scheduler_id_ = 0;
+  int32 crypto_scheduler_id_ = 0;
+  int32 file_io_scheduler_id_ = 0;
 
   std::atomic<bool> store_all_files_in_files_directory_{false};
 
@@ -719,6 +735,7 @@ class Global final : public ActorContext {
 
   ActorId<StateManager> state_manager_;
 
+  std::shared_ptr<NetQueryStats> net_query_stats_;
   LazySchedulerLocalStorage<unique_ptr<NetQueryCreator>> net_query_creator_;
   unique_ptr<NetQueryDispatcher> net_query_dispatcher_;
 
@@ -953,6 +953,7 @@ struct GroupCallManager::GroupCall {
 
 struct GroupCallManager::GroupCallParticipants {
   vector<GroupCallParticipant> participants;
+  FlatHashMap<DialogId, size_t, DialogIdHash> participant_indexes;  // dialog_id -> index in participants
   string next_offset;
   GroupCallParticipantOrder min_order = GroupCallParticipantOrder::max();
   bool joined_date_asc = false;
@@ -997,6 +998,9 @@ GroupCallManager::GroupCallManager(Td *td, ActorShared<> parent) : td_(td), pare
 
   sync_participants_timeout_.set_callback(on_sync_participants_timeout_callback);
   sync_participants_timeout_.set_callback_data(static_cast<void *>(this));
+
+  send_participant_updates_timeout_.set_callback(on_send_participant_updates_timeout_callback);
+  send_participant_updates_timeout_.set_callback_data(static_cast<void *>(this));
 }
 
 GroupCallManager::~GroupCallManager() = default;
@@ -1151,6 +1155,26 @@ void GroupCallManager::on_sync_participants_timeout(GroupCallId group_call_id) {
   sync_group_call_participants(input_group_call_id);
 }
 
+void GroupCallManager::on_send_participant_updates_timeout_callback(void *group_call_manager_ptr,
+                                                                    int64 group_call_id_int) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  auto group_call_manager = static_cast<GroupCallManager *>(group_call_manager_ptr);
+  send_closure_later(group_call_manager->actor_id(group_call_manager),
+                     &GroupCallManager::on_send_participant_updates_timeout,
+                     GroupCallId(narrow_cast<int32>(group_call_id_int)));
+}
+
+void GroupCallManager::on_send_participant_updates_timeout(GroupCallId group_call_id) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  send_pending_group_call_participant_updates(group_call_id);
+}
+
 bool GroupCallManager::is_group_call_being_joined(InputGroupCallId input_group_call_id) const {
   return pending_join_requests_.count(input_group_call_id) != 0;
 }
@@ -1709,15 +1733,40 @@ GroupCallParticipant *GroupCallManager::get_group_call_participant(GroupCallPart
       }
     }
   } else {
-    for (auto &group_call_participant : group_call_participants->participants) {
-      if (group_call_participant.dialog_id == dialog_id) {
-        return &group_call_participant;
-      }
+    auto it = group_call_participants->participant_indexes.find(dialog_id);
+    if (it != group_call_participants->participant_indexes.end()) {
+      return &group_call_participants->participants[it->second];
     }
   }
   return nullptr;
 }
 
+void GroupCallManager::add_group_call_participant(GroupCallParticipants *group_call_participants,
+                                                  GroupCallParticipant &&participant) {
+  group_call_participants->participant_indexes[participant.dialog_id] = group_call_participants->participants.size();
+  group_call_participants->participants.push_back(std::move(participant));
+}
+
+void GroupCallManager::remove_group_call_participant(GroupCallParticipants *group_call_participants, size_t pos) {
+  auto &participants = group_call_participants->participants;
+  auto &participant_indexes = group_call_participants->participant_indexes;
+  CHECK(pos < participants.size());
+  auto it = participant_indexes.find(participants[pos].dialog_id);
+  if (it != participant_indexes.end() && it->second == pos) {
+    participant_indexes.erase(it);
+  }
+  // the order of participants in the vector doesn't matter, so the last participant is moved to the freed place
+  auto last_pos = participants.size() - 1;
+  if (pos != last_pos) {
+    it = participant_indexes.find(participants[last_pos].dialog_id);
+    if (it != participant_indexes.end() && it->second == last_pos) {
+      it->second = pos;
+    }
+    participants[pos] = std::move(participants[last_pos]);
+  }
+  participants.pop_back();
+}
+
 void GroupCallManager::on_update_group_call_participants(
     InputGroupCallId input_group_call_id, vector<tl_object_ptr<telegram_api::groupCallParticipant>> &&participants,
     int32 version, bool is_recursive) {
@@ -2128,11 +2177,11 @@ void GroupCallManager::process_group_call_participants(
   if (is_sync) {
     auto *group_call_participants = add_group_call_participants(input_group_call_id);
     auto &group_participants = group_call_participants->participants;
-    for (auto participant_it = group_participants.begin(); participant_it != group_participants.end();) {
-      auto &participant = *participant_it;
+    for (size_t i = 0; i < group_participants.size();) {
+      auto &participant = group_participants[i];
       if (old_participant_dialog_ids.count(participant.dialog_id) == 0) {
         // successfully synced old user
-        ++participant_it;
+        i++;
         continue;
       }
 
@@ -2141,7 +2190,7 @@ void GroupCallManager::process_group_call_participants(
           participant.order = min_order;
           send_update_group_call_participant(input_group_call_id, participant, "process_group_call_participants self");
         }
-        ++participant_it;
+        i++;
         continue;
       }
 
@@ -2153,7 +2202,7 @@ void GroupCallManager::process_group_call_participants(
       }
       on_remove_group_call_participant(input_group_call_id, participant.dialog_id);
       group_call_participants->local_unmuted_video_count -= participant.get_has_video();
-      participant_it = group_participants.erase(participant_it);
+      remove_group_call_participant(group_call_participants, i);
     }
     if (group_call_participants->min_order < min_order) {
       // if previously known more users, adjust min_order
@@ -2255,54 +2304,71 @@ std::pair<int32, int32> GroupCallManager::process_group_call_participant(InputGr
   bool can_self_unmute = get_group_call_can_self_unmute(input_group_call_id);
   bool can_manage = can_manage_group_call(input_group_call_id);
   auto *participants = add_group_call_participants(input_group_call_id);
-  for (size_t i = 0; i < participants->participants.size(); i++) {
-    auto &old_participant = participants->participants[i];
-    if (old_participant.dialog_id == participant.dialog_id || (old_participant.is_self && participant.is_self)) {
-      if (participant.joined_date == 0) {
-        LOG(INFO) << "Remove " << old_participant;
-        if (old_participant.order.is_valid()) {
-          send_update_group_call_participant(input_group_call_id, participant, "process_group_call_participant remove");
-        }
-        on_remove_group_call_participant(input_group_call_id, old_participant.dialog_id);
-        remove_recent_group_call_speaker(input_group_call_id, old_participant.dialog_id);
-        int32 unmuted_video_diff = -old_participant.get_has_video();
-        participants->local_unmuted_video_count += unmuted_video_diff;
-        participants->participants.erase(participants->participants.begin() + i);
-        return {-1, unmuted_video_diff};
+  auto old_pos = participants->participants.size();
+  auto it = participants->participant_indexes.find(participant.dialog_id);
+  if (it != participants->participant_indexes.end()) {
+    old_pos = it->second;
+  } else if (participant.is_self) {
+    for (size_t i = 0; i < participants->participants.size(); i++) {
+      if (participants->participants[i].is_self) {
+        old_pos = i;
+        break;
       }
-
-      if (old_participant.version > participant.version) {
-        LOG(INFO) << "Ignore outdated update of " << old_participant.dialog_id;
-        return {0, 0};
+    }
+  }
+  if (old_pos < participants->participants.size()) {
+    auto &old_participant = participants->participants[old_pos];
+    if (participant.joined_date == 0) {
+      LOG(INFO) << "Remove " << old_participant;
+      if (old_participant.order.is_valid()) {
+        send_update_group_call_participant(input_group_call_id, participant, "process_group_call_participant remove");
       }
+      on_remove_group_call_participant(input_group_call_id, old_participant.dialog_id);
+      remove_recent_group_call_speaker(input_group_call_id, old_participant.dialog_id);
+      int32 unmuted_video_diff = -old_participant.get_has_video();
+      participants->local_unmuted_video_count += unmuted_video_diff;
+      remove_group_call_participant(participants, old_pos);
+      return {-1, unmuted_video_diff};
+    }
 
-      if (old_participant.dialog_id != participant.dialog_id) {
-        on_remove_group_call_participant(input_group_call_id, old_participant.dialog_id);
-        on_add_group_call_participant(input_group_call_id, participant.dialog_id);
-      }
+    if (old_participant.version > participant.version) {
+      LOG(INFO) << "Ignore outdated update of " << old_participant.dialog_id;
+      return {0, 0};
+    }
 
-      participant.update_from(old_participant);
+    if (old_participant.dialog_id != participant.dialog_id) {
+      on_remove_group_call_participant(input_group_call_id, old_participant.dialog_id);
+      on_add_group_call_participant(input_group_call_id, participant.dialog_id);
+    }
 
-      participant.is_just_joined = false;
-      participant.order = get_real_participant_order(can_self_unmute, participant, participants);
-      update_group_call_participant_can_be_muted(can_manage, participants, participant);
+    participant.update_from(old_participant);
 
-      LOG(INFO) << "Edit " << old_participant << " to " << participant;
-      if (old_participant != participant && (old_participant.order.is_valid() || participant.order.is_valid())) {
-        send_update_group_call_participant(input_group_call_id, participant, "process_group_call_participant edit");
-        if (old_participant.dialog_id != participant.dialog_id) {
-          // delete old self-participant; shouldn't affect correct apps
-          old_participant.order = GroupCallParticipantOrder();
-          send_update_group_call_participant(input_group_call_id, old_participant,
-                                             "process_group_call_participant edit self");
-        }
+    participant.is_just_joined = false;
+    participant.order = get_real_participant_order(can_self_unmute, participant, participants);
+    update_group_call_participant_can_be_muted(can_manage, participants, participant);
+
+    LOG(INFO) << "Edit " << old_participant << " to " << participant;
+    if (old_participant != participant && (old_participant.order.is_valid() || participant.order.is_valid())) {
+      send_update_group_call_participant(input_group_call_id, participant, "process_group_call_participant edit");
+      if (old_participant.dialog_id != participant.dialog_id) {
+        // delete old self-participant; shouldn't affect correct apps
+        old_participant.order = GroupCallParticipantOrder();
+        send_update_group_call_participant(input_group_call_id, old_participant,
+                                           "process_group_call_participant edit self");
       }
-      on_participant_speaking_in_group_call(input_group_call_id, participant);
-      int32 unmuted_video_diff = participant.get_has_video() - old_participant.get_has_video();
-      participants->local_unmuted_video_count += unmuted_video_diff;
-      old_participant = std::move(participant);
-      return {0, unmuted_video_diff};
     }
+    on_participant_speaking_in_group_call(input_group_call_id, participant);
+    int32 unmuted_video_diff = participant.get_has_video() - old_participant.get_has_video();
+    participants->local_unmuted_video_count += unmuted_video_diff;
+    if (old_participant.dialog_id != participant.dialog_id) {
+      auto old_it = participants->participant_indexes.find(old_participant.dialog_id);
+      if (old_it != participants->participant_indexes.end() && old_it->second == old_pos) {
+        participants->participant_indexes.erase(old_it);
+      }
+      participants->participant_indexes[participant.dialog_id] = old_pos;
+    }
+    old_participant = std::move(participant);
+    return {0, unmuted_video_diff};
   }
 
   if (participant.joined_date == 0) {
@@ -2322,7 +2388,7 @@ std::pair<int32, int32> GroupCallManager::process_group_call_participant(InputGr
   participant.is_just_joined = false;
   participants->local_unmuted_video_count += participant.get_has_video();
   update_group_call_participant_can_be_muted(can_manage, participants, participant);
-  participants->participants.push_back(std::move(participant));
+  add_group_call_participant(participants, std::move(participant));
   if (participants->participants.back().order.is_valid()) {
     send_update_group_call_participant(input_group_call_id, participants->participants.back(),
                                        "process_group_call_participant add");
@@ -4849,21 +4915,51 @@ tl_object_ptr<td_api::updateGroupCallParticipant> GroupCallManager::get_update_g
 
 void GroupCallManager::send_update_group_call(const GroupCall *group_call, const char *source) {
   LOG(INFO) << "Send update about " << group_call->group_call_id << " from " << source;
+  send_pending_group_call_participant_updates(group_call->group_call_id);
   send_closure(G()->td(), &Td::send_update,
                get_update_group_call_object(group_call, get_recent_speakers(group_call, true)));
 }
 
-void GroupCallManager::send_update_group_call_participant(GroupCallId group_call_id,
+void GroupCallManager::send_update_group_call_participant(const GroupCall *group_call,
                                                           const GroupCallParticipant &participant, const char *source) {
-  LOG(INFO) << "Send update about " << participant << " in " << group_call_id << " from " << source;
-  send_closure(G()->td(), &Td::send_update, get_update_group_call_participant_object(group_call_id, participant));
+  auto group_call_id = group_call->group_call_id;
+  auto update = get_update_group_call_participant_object(group_call_id, participant);
+  if (group_call->participant_count < MIN_COALESCED_UPDATES_PARTICIPANT_COUNT &&
+      pending_participant_updates_.count(group_call_id) == 0) {
+    LOG(INFO) << "Send update about " << participant << " in " << group_call_id << " from " << source;
+    send_closure(G()->td(), &Td::send_update, std::move(update));
+    return;
+  }
+
+  // in big group calls participants change too often, so only the last update about each of them is sent
+  LOG(INFO) << "Postpone update about " << participant << " in " << group_call_id << " from " << source;
+  auto &updates = pending_participant_updates_[group_call_id];
+  if (updates.empty()) {
+    send_participant_updates_timeout_.set_timeout_in(group_call_id.get(), GROUP_CALL_PARTICIPANT_UPDATES_DELAY);
+  }
+  updates[participant.dialog_id] = std::move(update);
 }
 
 void GroupCallManager::send_update_group_call_participant(InputGroupCallId input_group_call_id,
                                                           const GroupCallParticipant &participant, const char *source) {
   auto group_call = get_group_call(input_group_call_id);
   CHECK(group_call != nullptr && group_call->is_inited);
-  send_update_group_call_participant(group_call->group_call_id, participant, source);
+  send_update_group_call_participant(group_call, participant, source);
+}
+
+void GroupCallManager::send_pending_group_call_participant_updates(GroupCallId group_call_id) {
+  auto it = pending_participant_updates_.find(group_call_id);
+  if (it == pending_participant_updates_.end()) {
+    return;
+  }
+  auto updates = std::move(it->second);
+  pending_participant_updates_.erase(it);
+  send_participant_updates_timeout_.cancel_timeout(group_call_id.get());
+
+  LOG(INFO) << "Send " << updates.size() << " postponed updates about participants in " << group_call_id;
+  for (auto &update : updates) {
+    send_closure(G()->td(), &Td::send_update, std::move(update.second));
+  }
 }
 
 }  // namespace td
@@ -154,6 +154,8 @@ class GroupCallManager final : public Actor {
   static constexpr int32 RECENT_SPEAKER_TIMEOUT = 60 * 60;
   static constexpr int32 UPDATE_GROUP_CALL_PARTICIPANT_ORDER_TIMEOUT = 10;
   static constexpr int32 CHECK_GROUP_CALL_IS_JOINED_TIMEOUT = 10;
+  static constexpr int32 MIN_COALESCED_UPDATES_PARTICIPANT_COUNT = 1000;
+  static constexpr double GROUP_CALL_PARTICIPANT_UPDATES_DELAY = 0.5;
   static constexpr size_t MAX_TITLE_LENGTH = 64;  // server side limit for group call/call record title length
 
   void tear_down() final;
@@ -179,6 +181,10 @@ class GroupCallManager final : public Actor {
 
   void on_sync_participants_timeout(GroupCallId group_call_id);
 
+  static void on_send_participant_updates_timeout_callback(void *group_call_manager_ptr, int64 group_call_id_int);
+
+  void on_send_participant_updates_timeout(GroupCallId group_call_id);
+
   Result<InputGroupCallId> get_input_group_call_id(GroupCallId group_call_id);
 
   GroupCallId get_next_group_call_id(InputGroupCallId input_group_call_id);
@@ -294,6 +300,11 @@ class GroupCallManager final : public Actor {
   GroupCallParticipant *get_group_call_participant(GroupCallParticipants *group_call_participants,
                                                    DialogId dialog_id) const;
 
+  static void add_group_call_participant(GroupCallParticipants *group_call_participants,
+                                         GroupCallParticipant &&participant);
+
+  static void remove_group_call_participant(GroupCallParticipants *group_call_participants, size_t pos);
+
   void send_edit_group_call_title_query(InputGroupCallId input_group_call_id, const string &title);
 
   void on_edit_group_call_title(InputGroupCallId input_group_call_id, const string &title, Result<Unit> &&result);
@@ -383,9 +394,11 @@ class GroupCallManager final : public Actor {
 
   void send_update_group_call(const GroupCall *group_call, const char *source);
 
-  void send_update_group_call_participant(GroupCallId group_call_id, const GroupCallParticipant &participant,
+  void send_update_group_call_participant(const GroupCall *group_call, const GroupCallParticipant &participant,
                                           const char *source);
 
+  void send_pending_group_call_participant_updates(GroupCallId group_call_id);
+
   void send_update_group_call_participant(InputGroupCallId input_group_call_id, const GroupCallParticipant &participant,
                                           const char *source);
 
@@ -405,6 +418,12 @@ class GroupCallManager final : public Actor {
 
   FlatHashMap<GroupCallId, unique_ptr<GroupCallRecentSpeakers>, GroupCallIdHash> group_call_recent_speakers_;
 
+  // the last not sent update for each participant of big group calls
+  FlatHashMap<GroupCallId,
+              FlatHashMap<DialogId, td_api::object_ptr<td_api::updateGroupCallParticipant>, DialogIdHash>,
+              GroupCallIdHash>
+      pending_participant_updates_;
+
   FlatHashMap<InputGroupCallId, vector<Promise<td_api::object_ptr<td_api::groupCall>>>, InputGroupCallIdHash>
       load_group_call_queries_;
 
@@ -426,6 +445,7 @@ class GroupCallManager final : public Actor {
   MultiTimeout pending_send_speaking_action_timeout_{"PendingSendSpeakingActionTimeout"};
   MultiTimeout recent_speaker_update_timeout_{"RecentSpeakerUpdateTimeout"};
   MultiTimeout sync_participants_timeout_{"SyncParticipantsTimeout"};
+  MultiTimeout send_participant_updates_timeout_{"SendParticipantUpdatesTimeout"};
 };
 
 }  // namespace td
@@ -37,8 +37,12 @@ void HashtagHints::hashtag_used(const string &hashtag) {
     return;
   }
   hashtag_used_impl(hashtag);
-  G()->td_db()->get_sqlite_pmc()->set(get_key(), serialize(keys_to_strings(hints_.search_empty(101).second)),
-                                      Promise<Unit>());
+
+  // all hashtags of a message are added one by one, so save them together
+  if (!need_save_to_database_) {
+    need_save_to_database_ = true;
+    set_timeout_in(SAVE_TO_DATABASE_DELAY);
+  }
 }
 
 void HashtagHints::remove_hashtag(string hashtag, Promise<Unit> promise) {
@@ -51,8 +55,7 @@ void HashtagHints::remove_hashtag(string hashtag, Promise<Unit> promise) {
   auto key = Hash<string>()(hashtag);
   if (hints_.has_key(key)) {
     hints_.remove(key);
-    G()->td_db()->get_sqlite_pmc()->set(get_key(), serialize(keys_to_strings(hints_.search_empty(101).second)),
-                                        Promise<Unit>());
+    save_to_database();
     promise.set_value(Unit());  // set promise explicitly, because sqlite_pmc waits for too long before setting promise
   } else {
     promise.set_value(Unit());
@@ -64,7 +67,7 @@ void HashtagHints::clear(Promise<Unit> promise) {
     return promise.set_value(Unit());
   }
   hints_ = {};
-  G()->td_db()->get_sqlite_pmc()->set(get_key(), serialize(vector<string>()), Promise<Unit>());
+  save_to_database();
   promise.set_value(Unit());
 }
 
@@ -79,6 +82,27 @@ void HashtagHints::query(const string &prefix, int32 limit, Promise<vector<strin
   promise.set_value(keys_to_strings(result.second));
 }
 
+void HashtagHints::timeout_expired() {
+  if (need_save_to_database_) {
+    save_to_database();
+  }
+}
+
+void HashtagHints::hangup() {
+  if (need_save_to_database_) {
+    save_to_database();
+  }
+  stop();
+}
+
+void HashtagHints::save_to_database() {
+  CHECK(sync_with_db_);
+  need_save_to_database_ = false;
+  cancel_timeout();
+  G()->td_db()->get_sqlite_pmc()->set(get_key(), serialize(keys_to_strings(hints_.search_empty(101).second)),
+                                      Promise<Unit>());
+}
+
 string HashtagHints::get_key() const {
   return "hashtag_hints#" + mode_;
 }
@@ -32,14 +32,23 @@ class HashtagHints final : public Actor {
   Hints hints_;
   char first_character_ = '#';
   bool sync_with_db_ = false;
+  bool need_save_to_database_ = false;
   int64 counter_ = 0;
 
   ActorShared<> parent_;
 
   string get_key() const;
 
+  static constexpr double SAVE_TO_DATABASE_DELAY = 1.0;
+
   void start_up() final;
 
+  void timeout_expired() final;
+
+  void hangup() final;
+
+  void save_to_database();
+
   void hashtag_used_impl(const string &hashtag);
   void from_db(Result<string> data, bool dummy);
   vector<string> keys_to_strings(const vector<int64> &keys);
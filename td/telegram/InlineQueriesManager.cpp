@@ -1041,12 +1041,17 @@ uint64 InlineQueriesManager::send_inline_query(UserId bot_user_id, DialogId dial
   if (it != inline_query_results_.end()) {
     it->second.pending_request_count++;
     if (Time::now() < it->second.cache_expire_time) {
+      inline_query_result_cache_hit_count_++;
+      LOG(INFO) << "Use cached results for inline query " << query_hash << ", have "
+                << inline_query_result_cache_hit_count_ << " cache hits and " << inline_query_result_cache_miss_count_
+                << " cache misses";
       promise.set_value(Unit());
       return query_hash;
     }
   } else {
     inline_query_results_[query_hash] = {nullptr, -1.0, 1};
   }
+  inline_query_result_cache_miss_count_++;
 
   if (pending_inline_query_ != nullptr) {
     LOG(INFO) << "Drop inline query " << pending_inline_query_->query_hash;
@@ -1478,7 +1483,39 @@ tl_object_ptr<td_api::inlineQueryResults> InlineQueriesManager::decrease_pending
       drop_inline_query_result_timeout_.set_timeout_at(static_cast<int64>(query_hash), it->second.cache_expire_time);
     }
   }
-  return copy(it->second.results);
+  auto result = copy(it->second.results);
+  drop_excess_inline_query_results();
+  return result;
+}
+
+void InlineQueriesManager::drop_excess_inline_query_results() {
+  // only results, which aren't awaited by pending requests, can be dropped
+  size_t total_result_count = 0;
+  for (const auto &it : inline_query_results_) {
+    if (it.second.results != nullptr) {
+      total_result_count += it.second.results->results_.size();
+    }
+  }
+  while (total_result_count > MAX_CACHED_INLINE_QUERY_RESULTS) {
+    uint64 query_hash = 0;
+    double min_cache_expire_time = 0.0;
+    for (const auto &it : inline_query_results_) {
+      if (it.second.pending_request_count == 0 && it.second.results != nullptr &&
+          (query_hash == 0 || it.second.cache_expire_time < min_cache_expire_time)) {
+        query_hash = it.first;
+        min_cache_expire_time = it.second.cache_expire_time;
+      }
+    }
+    if (query_hash == 0) {
+      break;
+    }
+
+    LOG(INFO) << "Drop cache for inline query " << query_hash << " to free memory";
+    drop_inline_query_result_timeout_.cancel_timeout(static_cast<int64>(query_hash));
+    auto it = inline_query_results_.find(query_hash);
+    total_result_count -= it->second.results->results_.size();
+    inline_query_results_.erase(it);
+  }
 }
 
 tl_object_ptr<td_api::thumbnail> InlineQueriesManager::register_thumbnail(
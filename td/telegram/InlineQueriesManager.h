@@ -82,8 +82,9 @@ class InlineQueriesManager final : public Actor {
       tl_object_ptr<telegram_api::InputBotInlineMessageID> &&input_bot_inline_message_id);
 
  private:
-  static constexpr size_t MAX_RECENT_INLINE_BOTS = 20;  // some reasonable value
-  static constexpr int32 INLINE_QUERY_DELAY_MS = 400;   // server side limit
+  static constexpr size_t MAX_RECENT_INLINE_BOTS = 20;             // some reasonable value
+  static constexpr int32 INLINE_QUERY_DELAY_MS = 400;              // server side limit
+  static constexpr size_t MAX_CACHED_INLINE_QUERY_RESULTS = 2000;  // some reasonable value
 
   static constexpr int32 BOT_INLINE_MEDIA_RESULT_FLAG_HAS_PHOTO = 1 << 0;
   static constexpr int32 BOT_INLINE_MEDIA_RESULT_FLAG_HAS_DOCUMENT = 1 << 1;
@@ -118,6 +119,8 @@ class InlineQueriesManager final : public Actor {
 
   static void on_drop_inline_query_result_timeout_callback(void *inline_queries_manager_ptr, int64 query_hash);
 
+  void drop_excess_inline_query_results();
+
   void loop() final;
 
   void tear_down() final;
@@ -150,6 +153,8 @@ class InlineQueriesManager final : public Actor {
 
   MultiTimeout drop_inline_query_result_timeout_{"DropInlineQueryResultTimeout"};
   FlatHashMap<uint64, InlineQueryResult> inline_query_results_;  // query_hash -> result
+  int64 inline_query_result_cache_hit_count_ = 0;
+  int64 inline_query_result_cache_miss_count_ = 0;
 
   FlatHashMap<int64, FlatHashMap<string, InlineMessageContent>>
       inline_message_contents_;  // query_id -> [result_id -> inline_message_content]
@@ -21,6 +21,7 @@
 #include "td/utils/FlatHashSet.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
+#include "td/utils/port/path.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 
@@ -175,6 +176,14 @@ static string load_database_language_base_language_code(SqliteKeyValue *kv) {
 }
 
 LanguagePackManager::LanguageDatabase *LanguagePackManager::add_language_database(string path) {
+  // the same database can be specified by different clients using different paths,
+  // so databases are identified by their real path to be loaded only once per process
+  if (!path.empty()) {
+    auto r_real_path = realpath(path, true);
+    if (r_real_path.is_ok()) {
+      path = r_real_path.move_as_ok();
+    }
+  }
   auto it = language_databases_.find(path);
   if (it != language_databases_.end()) {
     return it->second.get();
@@ -189,6 +198,17 @@ LanguagePackManager::LanguageDatabase *LanguagePackManager::add_language_databas
     }
 
     database = r_database.move_as_ok();
+
+    // the database file could have been just created, so its real path must be checked again
+    auto r_real_path = realpath(path, true);
+    if (r_real_path.is_ok() && r_real_path.ok() != path) {
+      path = r_real_path.move_as_ok();
+      it = language_databases_.find(path);
+      if (it != language_databases_.end()) {
+        database.close();
+        return it->second.get();
+      }
+    }
   }
 
   it = language_databases_.emplace(path, make_unique<LanguageDatabase>()).first;
@@ -147,6 +147,23 @@ Result<int> Logging::get_tag_verbosity_level(Slice tag) {
   return *it->second;
 }
 
+Status Logging::set_tag_sampling(Slice tag, int sample_rate, int max_lines_per_second) {
+  if (log_tags.count(tag) == 0) {
+    return Status::Error("Log tag is not found");
+  }
+  if (sample_rate < 0) {
+    return Status::Error("Wrong sample rate specified");
+  }
+  if (max_lines_per_second < 0) {
+    return Status::Error("Wrong maximum number of lines per second specified");
+  }
+
+  if (!set_log_tag_sampling(tag, sample_rate, max_lines_per_second)) {
+    return Status::Error("Too many sampled log tags");
+  }
+  return Status::OK();
+}
+
 void Logging::add_message(int log_verbosity_level, Slice message) {
   int VERBOSITY_NAME(client) = clamp(log_verbosity_level, 0, VERBOSITY_NAME(NEVER));
   VLOG(client) << message;
@@ -30,6 +30,8 @@ class Logging {
 
   static Result<int> get_tag_verbosity_level(Slice tag);
 
+  static Status set_tag_sampling(Slice tag, int sample_rate, int max_lines_per_second);
+
   static void add_message(int log_verbosity_level, Slice message);
 };
 
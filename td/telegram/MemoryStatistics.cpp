@@ -0,0 +1,40 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/MemoryStatistics.h"
+
+#include "td/utils/algorithm.h"
+#include "td/utils/SliceBuilder.h"
+
+namespace td {
+
+void MemoryStatistics::add(Slice manager_name, Slice container_name, size_t object_count, size_t object_size) {
+  add_total(manager_name, container_name, object_count, object_count * object_size);
+}
+
+void MemoryStatistics::add_total(Slice manager_name, Slice container_name, size_t object_count, size_t total_size) {
+  Entry entry;
+  entry.manager_name_ = manager_name.str();
+  entry.container_name_ = container_name.str();
+  entry.object_count_ = static_cast<int64>(object_count);
+  entry.size_ = static_cast<int64>(total_size);
+  entries_.push_back(std::move(entry));
+}
+
+td_api::object_ptr<td_api::memoryStatistics> MemoryStatistics::get_memory_statistics_object() const {
+  string statistics;
+  for (auto &entry : entries_) {
+    statistics += PSTRING() << entry.manager_name_ << '.' << entry.container_name_ << ": " << entry.object_count_
+                            << " objects, " << entry.size_ << " bytes\n";
+  }
+  auto entries = transform(entries_, [](const Entry &entry) {
+    return td_api::make_object<td_api::memoryStatisticsEntry>(entry.manager_name_, entry.container_name_,
+                                                              entry.object_count_, entry.size_);
+  });
+  return td_api::make_object<td_api::memoryStatistics>(std::move(statistics), std::move(entries));
+}
+
+}  // namespace td
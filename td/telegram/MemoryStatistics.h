@@ -0,0 +1,35 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/telegram/td_api.h"
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+namespace td {
+
+// collects object counts and estimated sizes of the main containers of the managers
+class MemoryStatistics {
+  struct Entry {
+    string manager_name_;
+    string container_name_;
+    int64 object_count_ = 0;
+    int64 size_ = 0;
+  };
+  vector<Entry> entries_;
+
+ public:
+  // object_size is the size of a single object including its share of the container overhead
+  void add(Slice manager_name, Slice container_name, size_t object_count, size_t object_size);
+
+  void add_total(Slice manager_name, Slice container_name, size_t object_count, size_t total_size);
+
+  td_api::object_ptr<td_api::memoryStatistics> get_memory_statistics_object() const;
+};
+
+}  // namespace td
@@ -15,6 +15,7 @@
 #include "td/db/SqliteStatement.h"
 
 #include "td/actor/actor.h"
+#include "td/actor/MultiPromise.h"
 #include "td/actor/SchedulerLocalStorage.h"
 
 #include "td/utils/format.h"
@@ -22,10 +23,10 @@
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
-#include "td/utils/StackAllocator.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/Time.h"
 #include "td/utils/tl_helpers.h"
+#include "td/utils/translit.h"
 #include "td/utils/unicode.h"
 #include "td/utils/utf8.h"
 
@@ -41,6 +42,17 @@ namespace td {
 static constexpr int32 MESSAGE_DB_INDEX_COUNT = 30;
 static constexpr int32 MESSAGE_DB_INDEX_COUNT_OLD = 9;
 
+static string get_message_index_filter_list() {
+  string result;
+  for (int32 i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
+    if (i != 0) {
+      result += ", ";
+    }
+    result += to_string(i);
+  }
+  return result;
+}
+
 // NB: must happen inside a transaction
 Status init_message_db(SqliteDb &db, int32 version) {
   LOG(INFO) << "Init message database " << tag("version", version);
@@ -63,6 +75,20 @@ Status init_message_db(SqliteDb &db, int32 version) {
     return Status::OK();
   };
 
+  // message identifiers for every search filter are stored in a separate table instead of
+  // MESSAGE_DB_INDEX_COUNT partial indexes, so only the indexes, which the message belongs to, are updated
+  auto add_message_index_table = [&db] {
+    TRY_STATUS(
+        db.exec("CREATE TABLE IF NOT EXISTS message_index (dialog_id INT8, filter INT4, message_id INT8, "
+                "PRIMARY KEY (dialog_id, filter, message_id)) WITHOUT ROWID"));
+    TRY_STATUS(db.exec(PSLICE() << "CREATE TRIGGER IF NOT EXISTS trigger_message_index_delete AFTER DELETE ON messages "
+                                   "WHEN OLD.index_mask IS NOT NULL BEGIN DELETE FROM message_index WHERE dialog_id = "
+                                   "OLD.dialog_id AND filter IN ("
+                                << get_message_index_filter_list()
+                                << ") AND message_id = OLD.message_id AND (OLD.index_mask & (1 << filter)) != 0; END"));
+    return Status::OK();
+  };
+
   auto add_fts = [&db] {
     TRY_STATUS(
         db.exec("CREATE INDEX IF NOT EXISTS message_by_search_id ON messages "
@@ -70,7 +96,8 @@ Status init_message_db(SqliteDb &db, int32 version) {
 
     TRY_STATUS(
         db.exec("CREATE VIRTUAL TABLE IF NOT EXISTS messages_fts USING fts5(text, content='messages', "
-                "content_rowid='search_id', tokenize = \"unicode61 remove_diacritics 0 tokenchars '\a'\")"));
+                "content_rowid='search_id', tokenize = \"unicode61 remove_diacritics 0 tokenchars '\a'\", "
+                "prefix = '2 3 4')"));
     TRY_STATUS(db.exec(
         "CREATE TRIGGER IF NOT EXISTS trigger_fts_delete BEFORE DELETE ON messages WHEN OLD.search_id IS NOT NULL"
         " BEGIN INSERT INTO messages_fts(messages_fts, rowid, text) VALUES(\'delete\', OLD.search_id, OLD.text); END"));
@@ -130,7 +157,7 @@ Status init_message_db(SqliteDb &db, int32 version) {
         db.exec("CREATE INDEX IF NOT EXISTS message_by_ttl ON messages "
                 "(ttl_expires_at) WHERE ttl_expires_at IS NOT NULL"));
 
-    TRY_STATUS(add_media_indices(0, MESSAGE_DB_INDEX_COUNT));
+    TRY_STATUS(add_message_index_table());
 
     TRY_STATUS(add_fts());
 
@@ -167,6 +194,23 @@ Status init_message_db(SqliteDb &db, int32 version) {
   if (version < static_cast<int32>(DbVersion::AddMessageThreadSupport)) {
     TRY_STATUS(db.exec("ALTER TABLE messages ADD COLUMN top_thread_message_id INT8"));
   }
+  if (version < static_cast<int32>(DbVersion::AddMessageDbFtsPrefixIndex) &&
+      version >= static_cast<int32>(DbVersion::AddMessageDbFts)) {
+    // recreate the full-text index with prefix indexes
+    TRY_STATUS(db.exec("DROP TABLE IF EXISTS messages_fts"));
+    TRY_STATUS(add_fts());
+    TRY_STATUS(
+        db.exec("INSERT INTO messages_fts(rowid, text) SELECT search_id, text FROM messages WHERE search_id IS NOT "
+                "NULL"));
+  }
+  if (version < static_cast<int32>(DbVersion::AddMessageDbIndexTable)) {
+    TRY_STATUS(add_message_index_table());
+    for (int32 i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
+      TRY_STATUS(db.exec(PSLICE() << "INSERT OR IGNORE INTO message_index SELECT dialog_id, " << i
+                                  << ", message_id FROM messages WHERE (index_mask & " << (1 << i) << ") != 0"));
+      TRY_STATUS(db.exec(PSLICE() << "DROP INDEX IF EXISTS message_index_" << i));
+    }
+  }
   return Status::OK();
 }
 
@@ -174,6 +218,7 @@ Status init_message_db(SqliteDb &db, int32 version) {
 Status drop_message_db(SqliteDb &db, int32 version) {
   LOG(WARNING) << "Drop message database " << tag("version", version)
                << tag("current_db_version", current_db_version());
+  TRY_STATUS(db.exec("DROP TABLE IF EXISTS message_index"));
   return db.exec("DROP TABLE IF EXISTS messages");
 }
 
@@ -187,6 +232,13 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     TRY_RESULT_ASSIGN(
         add_message_stmt_,
         db_.get_statement("INSERT OR REPLACE INTO messages VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12)"));
+    TRY_RESULT_ASSIGN(get_message_index_mask_stmt_,
+                      db_.get_statement("SELECT index_mask FROM messages WHERE dialog_id = ?1 AND message_id = ?2"));
+    TRY_RESULT_ASSIGN(add_message_index_stmt_,
+                      db_.get_statement("INSERT OR IGNORE INTO message_index VALUES(?1, ?2, ?3)"));
+    TRY_RESULT_ASSIGN(
+        delete_message_index_stmt_,
+        db_.get_statement("DELETE FROM message_index WHERE dialog_id = ?1 AND filter = ?2 AND message_id = ?3"));
     TRY_RESULT_ASSIGN(delete_message_stmt_,
                       db_.get_statement("DELETE FROM messages WHERE dialog_id = ?1 AND message_id = ?2"));
     TRY_RESULT_ASSIGN(delete_all_dialog_messages_stmt_,
@@ -223,28 +275,25 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     TRY_RESULT_ASSIGN(get_messages_fts_stmt_,
                       db_.get_statement("SELECT dialog_id, message_id, data, search_id FROM messages WHERE search_id "
                                         "IN (SELECT rowid FROM messages_fts WHERE messages_fts MATCH ?1 AND rowid < ?2 "
-                                        "ORDER BY rowid DESC LIMIT ?3) ORDER BY search_id DESC"));
+                                        "AND rowid >= ?4 ORDER BY rowid DESC LIMIT ?3) ORDER BY search_id DESC"));
 
     for (int32 i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
       TRY_RESULT_ASSIGN(
           get_message_ids_stmts_[i],
-          db_.get_statement(
-              PSLICE() << "SELECT message_id FROM messages WHERE dialog_id = ?1 AND message_id < ?2 AND (index_mask & "
-                       << (1 << i) << ") != 0 ORDER BY message_id DESC LIMIT 1000000"));
+          db_.get_statement(PSLICE() << "SELECT message_id FROM message_index WHERE dialog_id = ?1 AND filter = " << i
+                                     << " AND message_id < ?2 ORDER BY message_id DESC LIMIT 1000000"));
 
       TRY_RESULT_ASSIGN(
           get_messages_from_index_stmts_[i].desc_stmt_,
-          db_.get_statement(
-              PSLICE()
-              << "SELECT data, message_id FROM messages WHERE dialog_id = ?1 AND message_id < ?2 AND (index_mask & "
-              << (1 << i) << ") != 0 ORDER BY message_id DESC LIMIT ?3"));
+          db_.get_statement(PSLICE() << "SELECT data, messages.message_id FROM message_index CROSS JOIN messages USING "
+                                        "(dialog_id, message_id) WHERE dialog_id = ?1 AND filter = "
+                                     << i << " AND message_id < ?2 ORDER BY message_id DESC LIMIT ?3"));
 
       TRY_RESULT_ASSIGN(
           get_messages_from_index_stmts_[i].asc_stmt_,
-          db_.get_statement(
-              PSLICE()
-              << "SELECT data, message_id FROM messages WHERE dialog_id = ?1 AND message_id > ?2 AND (index_mask & "
-              << (1 << i) << ") != 0 ORDER BY message_id ASC LIMIT ?3"));
+          db_.get_statement(PSLICE() << "SELECT data, messages.message_id FROM message_index CROSS JOIN messages USING "
+                                        "(dialog_id, message_id) WHERE dialog_id = ?1 AND filter = "
+                                     << i << " AND message_id > ?2 ORDER BY message_id ASC LIMIT ?3"));
 
       // LOG(ERROR) << get_messages_from_index_stmts_[i].desc_stmt_.explain().ok();
       // LOG(ERROR) << get_messages_from_index_stmts_[i].asc_stmt_.explain().ok();
@@ -295,6 +344,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     auto message_id = message_full_id.get_message_id();
     LOG_CHECK(dialog_id.is_valid()) << dialog_id << ' ' << message_id << ' ' << message_full_id;
     CHECK(message_id.is_valid());
+    update_message_index(dialog_id, message_id, index_mask);
     SCOPE_EXIT {
       add_message_stmt_.reset();
     };
@@ -366,6 +416,25 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     add_message_stmt_.step().ensure();
   }
 
+  void add_messages(vector<MessageDbAddMessageQuery> queries) final {
+    // insert messages in the order of the primary key to improve locality of B-tree updates;
+    // the sort must be stable, because the last added version of a message must be kept
+    std::stable_sort(queries.begin(), queries.end(),
+                     [](const MessageDbAddMessageQuery &lhs, const MessageDbAddMessageQuery &rhs) {
+                       auto lhs_dialog_id = lhs.message_full_id.get_dialog_id().get();
+                       auto rhs_dialog_id = rhs.message_full_id.get_dialog_id().get();
+                       if (lhs_dialog_id != rhs_dialog_id) {
+                         return lhs_dialog_id < rhs_dialog_id;
+                       }
+                       return lhs.message_full_id.get_message_id() < rhs.message_full_id.get_message_id();
+                     });
+    for (auto &query : queries) {
+      add_message(query.message_full_id, query.unique_message_id, query.sender_dialog_id, query.random_id,
+                  query.ttl_expires_at, query.index_mask, query.search_id, std::move(query.text), query.notification_id,
+                  query.top_thread_message_id, std::move(query.data));
+    }
+  }
+
   void add_scheduled_message(MessageFullId message_full_id, BufferSlice data) final {
     LOG(INFO) << "Add " << message_full_id << " to database";
     auto dialog_id = message_full_id.get_dialog_id();
@@ -688,7 +757,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     return result;
   }
 
-  static string prepare_query(Slice query) {
+  static string prepare_query(Slice query, bool use_prefix_search, bool use_transliteration) {
     auto is_word_character = [](uint32 a) {
       switch (get_unicode_simple_category(a)) {
         case UnicodeSimpleCategory::Letter:
@@ -702,37 +771,62 @@ class MessageDbImpl final : public MessageDbSyncInterface {
 
     const size_t MAX_QUERY_SIZE = 1024;
     query = utf8_truncate(query, MAX_QUERY_SIZE);
-    auto buf = StackAllocator::alloc(query.size() * 4 + 100);
-    StringBuilder sb(buf.as_slice());
-    bool in_word{false};
-
+    vector<Slice> words;
+    const unsigned char *word_begin = nullptr;
     for (auto ptr = query.ubegin(), end = query.uend(); ptr < end;) {
       uint32 code;
       auto code_ptr = ptr;
       ptr = next_utf8_unsafe(ptr, &code);
       if (is_word_character(code)) {
-        if (!in_word) {
-          in_word = true;
-          sb << "\"";
-        }
-        sb << Slice(code_ptr, ptr);
-      } else {
-        if (in_word) {
-          in_word = false;
-          sb << "\" ";
+        if (word_begin == nullptr) {
+          word_begin = code_ptr;
         }
+      } else if (word_begin != nullptr) {
+        words.emplace_back(word_begin, code_ptr);
+        word_begin = nullptr;
       }
     }
-    if (in_word) {
-      sb << "\" ";
-    }
+    if (word_begin != nullptr) {
+      words.emplace_back(word_begin, query.uend());
+    }
+
+    // parenthesized groups can't be combined with implicit AND, so AND is always explicit
+    string result;
+    for (size_t i = 0; i < words.size(); i++) {
+      // only the last word can be incomplete
+      bool is_prefix = use_prefix_search && i + 1 == words.size();
+      auto add_word = [&result, is_prefix](Slice word) {
+        result += '"';
+        result.append(word.data(), word.size());
+        result += is_prefix ? "\"*" : "\"";
+      };
+
+      vector<string> transliterations;
+      if (use_transliteration) {
+        auto word = utf8_to_lower(words[i]);
+        for (auto &transliteration : get_word_transliterations(word, is_prefix)) {
+          if (transliteration != word) {
+            transliterations.push_back(std::move(transliteration));
+          }
+        }
+      }
 
-    if (sb.is_error()) {
-      LOG(ERROR) << "StringBuilder buffer overflow";
-      return "";
+      if (i != 0) {
+        result += " AND ";
+      }
+      if (transliterations.empty()) {
+        add_word(words[i]);
+        continue;
+      }
+      result += '(';
+      add_word(words[i]);
+      for (auto &transliteration : transliterations) {
+        result += " OR ";
+        add_word(transliteration);
+      }
+      result += ')';
     }
-
-    return sb.as_cslice().str();
+    return result;
   }
 
   MessageDbFtsResult get_messages_fts(MessageDbFtsQuery query) final {
@@ -741,18 +835,26 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     };
 
     LOG(INFO) << tag("query", query.query) << query.dialog_id << tag("filter", query.filter)
-              << tag("from_search_id", query.from_search_id) << tag("limit", query.limit);
-    string words = prepare_query(query.query);
+              << tag("from_search_id", query.from_search_id) << tag("min_date", query.min_date)
+              << tag("limit", query.limit);
+    string words = prepare_query(query.query, query.use_prefix_search, query.use_transliteration);
     LOG(INFO) << tag("from", query.query) << tag("to", words);
 
+    auto add_condition = [&words](Slice condition) {
+      if (!words.empty()) {
+        words += " AND ";
+      }
+      words.append(condition.data(), condition.size());
+    };
+
     // dialog_id kludge
     if (query.dialog_id.is_valid()) {
-      words += PSTRING() << " \"\a" << query.dialog_id.get() << "\"";
+      add_condition(PSLICE() << "\"\a" << query.dialog_id.get() << "\"");
     }
 
     // index_mask kludge
     if (query.filter != MessageSearchFilter::Empty) {
-      words += PSTRING() << " \"\a\a" << message_search_filter_index(query.filter) << "\"";
+      add_condition(PSLICE() << "\"\a\a" << message_search_filter_index(query.filter) << "\"");
     }
 
     auto &stmt = get_messages_fts_stmt_;
@@ -762,6 +864,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     }
     stmt.bind_int64(2, query.from_search_id).ensure();
     stmt.bind_int32(3, query.limit).ensure();
+    stmt.bind_int64(4, static_cast<int64>(max(query.min_date, 0)) << 32).ensure();
     MessageDbFtsResult result;
     auto status = stmt.step();
     if (status.is_error()) {
@@ -816,6 +919,45 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     return result;
   }
 
+  static bool has_index(int32 index_mask, int32 index) {
+    return (index_mask & (1 << index)) != 0;
+  }
+
+  // REPLACE doesn't fire delete triggers, so the index of the replaced message is updated manually
+  void update_message_index(DialogId dialog_id, MessageId message_id, int32 index_mask) {
+    int32 old_index_mask = 0;
+    {
+      SCOPE_EXIT {
+        get_message_index_mask_stmt_.reset();
+      };
+      get_message_index_mask_stmt_.bind_int64(1, dialog_id.get()).ensure();
+      get_message_index_mask_stmt_.bind_int64(2, message_id.get()).ensure();
+      get_message_index_mask_stmt_.step().ensure();
+      if (get_message_index_mask_stmt_.has_row()) {
+        // NULL is returned as 0
+        old_index_mask = get_message_index_mask_stmt_.view_int32(0);
+      }
+    }
+    if (old_index_mask == 0 && index_mask == 0) {
+      return;
+    }
+
+    for (int32 i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
+      if (!has_index(index_mask, i) && !has_index(old_index_mask, i)) {
+        continue;
+      }
+      // existing index entries are ignored
+      auto &stmt = has_index(index_mask, i) ? add_message_index_stmt_ : delete_message_index_stmt_;
+      SCOPE_EXIT {
+        stmt.reset();
+      };
+      stmt.bind_int64(1, dialog_id.get()).ensure();
+      stmt.bind_int32(2, i).ensure();
+      stmt.bind_int64(3, message_id.get()).ensure();
+      stmt.step().ensure();
+    }
+  }
+
   Status begin_write_transaction() final {
     return db_.begin_write_transaction();
   }
@@ -827,6 +969,9 @@ class MessageDbImpl final : public MessageDbSyncInterface {
   SqliteDb db_;
 
   SqliteStatement add_message_stmt_;
+  SqliteStatement get_message_index_mask_stmt_;
+  SqliteStatement add_message_index_stmt_;
+  SqliteStatement delete_message_index_stmt_;
 
   SqliteStatement delete_message_stmt_;
   SqliteStatement delete_all_dialog_messages_stmt_;
@@ -984,89 +1129,172 @@ std::shared_ptr<MessageDbSyncSafeInterface> create_message_db_sync(
 
 class MessageDbAsync final : public MessageDbAsyncInterface {
  public:
-  MessageDbAsync(std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id) {
-    impl_ = create_actor_on_scheduler<Impl>("MessageDbActor", scheduler_id, std::move(sync_db));
+  MessageDbAsync(std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id,
+                 std::shared_ptr<MessageDbSyncSafeInterface> reader_sync_db, vector<int32> reader_scheduler_ids) {
+    impl_ = create_actor_on_scheduler<Impl>("MessageDbActor", scheduler_id, std::move(sync_db),
+                                            std::move(reader_sync_db), std::move(reader_scheduler_ids));
   }
 
   void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
                    int64 random_id, int32 ttl_expires_at, int32 index_mask, int64 search_id, string text,
                    NotificationId notification_id, MessageId top_thread_message_id, BufferSlice data,
                    Promise<> promise) final {
+    if (add_message_batch_depth_ > 0) {
+      MessageDbAddMessageQuery query;
+      query.message_full_id = message_full_id;
+      query.unique_message_id = unique_message_id;
+      query.sender_dialog_id = sender_dialog_id;
+      query.random_id = random_id;
+      query.ttl_expires_at = ttl_expires_at;
+      query.index_mask = index_mask;
+      query.search_id = search_id;
+      query.text = std::move(text);
+      query.notification_id = notification_id;
+      query.top_thread_message_id = top_thread_message_id;
+      query.data = std::move(data);
+      add_message_batch_.push_back(std::move(query));
+      if (promise) {
+        add_message_batch_promises_.push_back(std::move(promise));
+      }
+      return;
+    }
     send_closure_later(impl_, &Impl::add_message, message_full_id, unique_message_id, sender_dialog_id, random_id,
                        ttl_expires_at, index_mask, search_id, std::move(text), notification_id, top_thread_message_id,
                        std::move(data), std::move(promise));
   }
+  void add_messages(vector<MessageDbAddMessageQuery> queries, Promise<> promise) final {
+    flush_add_message_batch();
+    send_closure_later(impl_, &Impl::add_messages, std::move(queries), std::move(promise));
+  }
+
+  void start_add_message_batch() final {
+    add_message_batch_depth_++;
+  }
+  void finish_add_message_batch() final {
+    CHECK(add_message_batch_depth_ > 0);
+    if (--add_message_batch_depth_ == 0) {
+      flush_add_message_batch();
+    }
+  }
   void add_scheduled_message(MessageFullId message_full_id, BufferSlice data, Promise<> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::add_scheduled_message, message_full_id, std::move(data), std::move(promise));
   }
 
   void delete_message(MessageFullId message_full_id, Promise<> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::delete_message, message_full_id, std::move(promise));
   }
   void delete_all_dialog_messages(DialogId dialog_id, MessageId from_message_id, Promise<> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::delete_all_dialog_messages, dialog_id, from_message_id, std::move(promise));
   }
   void delete_dialog_messages_by_sender(DialogId dialog_id, DialogId sender_dialog_id, Promise<> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::delete_dialog_messages_by_sender, dialog_id, sender_dialog_id, std::move(promise));
   }
 
   void get_message(MessageFullId message_full_id, Promise<MessageDbDialogMessage> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_message, message_full_id, std::move(promise));
   }
   void get_message_by_unique_message_id(ServerMessageId unique_message_id, Promise<MessageDbMessage> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_message_by_unique_message_id, unique_message_id, std::move(promise));
   }
   void get_message_by_random_id(DialogId dialog_id, int64 random_id, Promise<MessageDbDialogMessage> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_message_by_random_id, dialog_id, random_id, std::move(promise));
   }
   void get_dialog_message_by_date(DialogId dialog_id, MessageId first_message_id, MessageId last_message_id, int32 date,
                                   Promise<MessageDbDialogMessage> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_dialog_message_by_date, dialog_id, first_message_id, last_message_id, date,
                        std::move(promise));
   }
 
   void get_dialog_message_calendar(MessageDbDialogCalendarQuery query, Promise<MessageDbCalendar> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_dialog_message_calendar, std::move(query), std::move(promise));
   }
 
   void get_dialog_sparse_message_positions(MessageDbGetDialogSparseMessagePositionsQuery query,
                                            Promise<MessageDbMessagePositions> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_dialog_sparse_message_positions, std::move(query), std::move(promise));
   }
 
   void get_messages(MessageDbMessagesQuery query, Promise<vector<MessageDbDialogMessage>> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_messages, std::move(query), std::move(promise));
   }
   void get_scheduled_messages(DialogId dialog_id, int32 limit, Promise<vector<MessageDbDialogMessage>> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_scheduled_messages, dialog_id, limit, std::move(promise));
   }
   void get_messages_from_notification_id(DialogId dialog_id, NotificationId from_notification_id, int32 limit,
                                          Promise<vector<MessageDbDialogMessage>> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_messages_from_notification_id, dialog_id, from_notification_id, limit,
                        std::move(promise));
   }
   void get_calls(MessageDbCallsQuery query, Promise<MessageDbCallsResult> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_calls, std::move(query), std::move(promise));
   }
   void get_messages_fts(MessageDbFtsQuery query, Promise<MessageDbFtsResult> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_messages_fts, std::move(query), std::move(promise));
   }
   void get_expiring_messages(int32 expires_till, int32 limit, Promise<vector<MessageDbMessage>> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::get_expiring_messages, expires_till, limit, std::move(promise));
   }
 
   void close(Promise<> promise) final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::close, std::move(promise));
   }
 
   void force_flush() final {
+    flush_add_message_batch();
     send_closure_later(impl_, &Impl::force_flush);
   }
 
  private:
+  class Reader final : public Actor {
+   public:
+    explicit Reader(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe) : sync_db_safe_(std::move(sync_db_safe)) {
+    }
+
+    void run_query(Promise<MessageDbSyncInterface *> query) {
+      auto *sync_db = sync_db_;
+      query.set_value(std::move(sync_db));
+    }
+
+    void close(Promise<> promise) {
+      sync_db_safe_.reset();
+      sync_db_ = nullptr;
+      promise.set_value(Unit());
+      stop();
+    }
+
+   private:
+    std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe_;
+    MessageDbSyncInterface *sync_db_ = nullptr;
+
+    void start_up() final {
+      sync_db_ = &sync_db_safe_->get();
+    }
+  };
+
   class Impl final : public Actor {
    public:
-    explicit Impl(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe) : sync_db_safe_(std::move(sync_db_safe)) {
+    Impl(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe,
+         std::shared_ptr<MessageDbSyncSafeInterface> reader_sync_db_safe, vector<int32> reader_scheduler_ids)
+        : sync_db_safe_(std::move(sync_db_safe))
+        , reader_sync_db_safe_(std::move(reader_sync_db_safe))
+        , reader_scheduler_ids_(std::move(reader_scheduler_ids)) {
     }
     void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
                      int64 random_id, int32 ttl_expires_at, int32 index_mask, int64 search_id, string text,
@@ -1081,6 +1309,12 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
         on_write_result(std::move(promise));
       });
     }
+    void add_messages(vector<MessageDbAddMessageQuery> queries, Promise<> promise) {
+      add_write_query([this, queries = std::move(queries), promise = std::move(promise)](Unit) mutable {
+        sync_db_->add_messages(std::move(queries));
+        on_write_result(std::move(promise));
+      });
+    }
     void add_scheduled_message(MessageFullId message_full_id, BufferSlice data, Promise<> promise) {
       add_write_query([this, message_full_id, promise = std::move(promise), data = std::move(data)](Unit) mutable {
         sync_db_->add_scheduled_message(message_full_id, std::move(data));
@@ -1113,65 +1347,85 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
     }
 
     void get_message(MessageFullId message_full_id, Promise<MessageDbDialogMessage> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_message(message_full_id));
+      add_read_query(std::move(promise), [message_full_id](MessageDbSyncInterface *sync_db) {
+        return sync_db->get_message(message_full_id);
+      });
     }
     void get_message_by_unique_message_id(ServerMessageId unique_message_id, Promise<MessageDbMessage> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_message_by_unique_message_id(unique_message_id));
+      add_read_query(std::move(promise), [unique_message_id](MessageDbSyncInterface *sync_db) {
+        return sync_db->get_message_by_unique_message_id(unique_message_id);
+      });
     }
     void get_message_by_random_id(DialogId dialog_id, int64 random_id, Promise<MessageDbDialogMessage> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_message_by_random_id(dialog_id, random_id));
+      add_read_query(std::move(promise), [dialog_id, random_id](MessageDbSyncInterface *sync_db) {
+        return sync_db->get_message_by_random_id(dialog_id, random_id);
+      });
     }
     void get_dialog_message_by_date(DialogId dialog_id, MessageId first_message_id, MessageId last_message_id,
                                     int32 date, Promise<MessageDbDialogMessage> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_dialog_message_by_date(dialog_id, first_message_id, last_message_id, date));
+      add_read_query(std::move(promise),
+                     [dialog_id, first_message_id, last_message_id, date](MessageDbSyncInterface *sync_db) {
+                       return sync_db->get_dialog_message_by_date(dialog_id, first_message_id, last_message_id, date);
+                     });
     }
 
     void get_dialog_message_calendar(MessageDbDialogCalendarQuery query, Promise<MessageDbCalendar> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_dialog_message_calendar(std::move(query)));
+      add_read_query(std::move(promise), [query = std::move(query)](MessageDbSyncInterface *sync_db) mutable {
+        return sync_db->get_dialog_message_calendar(std::move(query));
+      });
     }
 
     void get_dialog_sparse_message_positions(MessageDbGetDialogSparseMessagePositionsQuery query,
                                              Promise<MessageDbMessagePositions> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_dialog_sparse_message_positions(std::move(query)));
+      add_read_query(std::move(promise), [query = std::move(query)](MessageDbSyncInterface *sync_db) mutable {
+        return sync_db->get_dialog_sparse_message_positions(std::move(query));
+      });
     }
 
     void get_messages(MessageDbMessagesQuery query, Promise<vector<MessageDbDialogMessage>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_messages(std::move(query)));
+      add_read_query(std::move(promise), [query = std::move(query)](MessageDbSyncInterface *sync_db) mutable {
+        return sync_db->get_messages(std::move(query));
+      });
     }
     void get_scheduled_messages(DialogId dialog_id, int32 limit, Promise<vector<MessageDbDialogMessage>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_scheduled_messages(dialog_id, limit));
+      add_read_query(std::move(promise), [dialog_id, limit](MessageDbSyncInterface *sync_db) {
+        return sync_db->get_scheduled_messages(dialog_id, limit);
+      });
     }
     void get_messages_from_notification_id(DialogId dialog_id, NotificationId from_notification_id, int32 limit,
                                            Promise<vector<MessageDbDialogMessage>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_messages_from_notification_id(dialog_id, from_notification_id, limit));
+      add_read_query(std::move(promise), [dialog_id, from_notification_id, limit](MessageDbSyncInterface *sync_db) {
+        return sync_db->get_messages_from_notification_id(dialog_id, from_notification_id, limit);
+      });
     }
     void get_calls(MessageDbCallsQuery query, Promise<MessageDbCallsResult> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_calls(std::move(query)));
+      add_read_query(std::move(promise), [query = std::move(query)](MessageDbSyncInterface *sync_db) mutable {
+        return sync_db->get_calls(std::move(query));
+      });
     }
     void get_messages_fts(MessageDbFtsQuery query, Promise<MessageDbFtsResult> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_messages_fts(std::move(query)));
+      add_read_query(std::move(promise), [query = std::move(query)](MessageDbSyncInterface *sync_db) mutable {
+        return sync_db->get_messages_fts(std::move(query));
+      });
     }
     void get_expiring_messages(int32 expires_till, int32 limit, Promise<vector<MessageDbMessage>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_expiring_messages(expires_till, limit));
+      add_read_query(std::move(promise), [expires_till, limit](MessageDbSyncInterface *sync_db) {
+        return sync_db->get_expiring_messages(expires_till, limit);
+      });
     }
 
     void close(Promise<> promise) {
       do_flush();
       sync_db_safe_.reset();
       sync_db_ = nullptr;
-      promise.set_value(Unit());
+
+      MultiPromiseActorSafe mpas{"MessageDbReadersCloseMultiPromiseActor"};
+      mpas.add_promise(std::move(promise));
+      auto lock = mpas.get_promise();
+      for (auto &reader : readers_) {
+        send_closure(reader, &Reader::close, mpas.get_promise());
+      }
+      lock.set_value(Unit());
       stop();
     }
 
@@ -1184,6 +1438,11 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
     std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe_;
     MessageDbSyncInterface *sync_db_ = nullptr;
 
+    std::shared_ptr<MessageDbSyncSafeInterface> reader_sync_db_safe_;
+    vector<int32> reader_scheduler_ids_;
+    vector<ActorOwn<Reader>> readers_;
+    size_t next_reader_ = 0;
+
     static constexpr size_t MAX_PENDING_QUERIES_COUNT{50};
     static constexpr double MAX_PENDING_QUERIES_DELAY{0.01};
 
@@ -1208,6 +1467,25 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
     void add_read_query() {
       do_flush();
     }
+
+    // pending writes are committed before the query is sent to a reader, so it sees all previous changes
+    template <class T, class F>
+    void add_read_query(Promise<T> &&promise, F &&f) {
+      add_read_query();
+      if (readers_.empty()) {
+        return promise.set_result(f(sync_db_));
+      }
+      auto &reader = readers_[next_reader_];
+      next_reader_ = (next_reader_ + 1) % readers_.size();
+      send_closure(reader, &Reader::run_query,
+                   PromiseCreator::lambda([f = std::forward<F>(f), promise = std::move(promise)](
+                                              Result<MessageDbSyncInterface *> r_sync_db) mutable {
+                     if (r_sync_db.is_error()) {
+                       return promise.set_error(r_sync_db.move_as_error());
+                     }
+                     promise.set_result(f(r_sync_db.ok()));
+                   }));
+    }
     void do_flush() {
       if (pending_writes_.empty()) {
         return;
@@ -1224,14 +1502,47 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
 
     void start_up() final {
       sync_db_ = &sync_db_safe_->get();
+      if (reader_sync_db_safe_ != nullptr) {
+        for (auto scheduler_id : reader_scheduler_ids_) {
+          readers_.push_back(
+              create_actor_on_scheduler<Reader>("MessageDbReader", scheduler_id, reader_sync_db_safe_));
+        }
+        reader_sync_db_safe_.reset();
+      }
     }
   };
   ActorOwn<Impl> impl_;
+
+  int32 add_message_batch_depth_ = 0;
+  vector<MessageDbAddMessageQuery> add_message_batch_;
+  vector<Promise<Unit>> add_message_batch_promises_;
+
+  void flush_add_message_batch() {
+    if (add_message_batch_.empty()) {
+      return;
+    }
+    Promise<Unit> promise;
+    if (!add_message_batch_promises_.empty()) {
+      promise = PromiseCreator::lambda(
+          [promises = std::move(add_message_batch_promises_)](Result<Unit> result) mutable {
+            if (result.is_error()) {
+              fail_promises(promises, result.move_as_error());
+            } else {
+              set_promises(promises);
+            }
+          });
+      add_message_batch_promises_.clear();
+    }
+    send_closure_later(impl_, &Impl::add_messages, std::move(add_message_batch_), std::move(promise));
+    add_message_batch_.clear();
+  }
 };
 
-std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(std::shared_ptr<MessageDbSyncSafeInterface> sync_db,
-                                                                 int32 scheduler_id) {
-  return std::make_shared<MessageDbAsync>(std::move(sync_db), scheduler_id);
+std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(
+    std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id,
+    std::shared_ptr<MessageDbSyncSafeInterface> reader_sync_db, vector<int32> reader_scheduler_ids) {
+  return std::make_shared<MessageDbAsync>(std::move(sync_db), scheduler_id, std::move(reader_sync_db),
+                                          std::move(reader_scheduler_ids));
 }
 
 }  // namespace td
@@ -80,7 +80,10 @@ struct MessageDbFtsQuery {
   DialogId dialog_id;
   MessageSearchFilter filter{MessageSearchFilter::Empty};
   int64 from_search_id{0};
+  int32 min_date{0};  // messages sent before the date aren't returned
   int32 limit{100};
+  bool use_prefix_search{false};    // the last word of the query can be a prefix of a message word
+  bool use_transliteration{false};  // transliterations of the query words are also matched
 };
 struct MessageDbFtsResult {
   vector<MessageDbMessage> messages;
@@ -97,6 +100,20 @@ struct MessageDbCallsResult {
   vector<MessageDbMessage> messages;
 };
 
+struct MessageDbAddMessageQuery {
+  MessageFullId message_full_id;
+  ServerMessageId unique_message_id;
+  DialogId sender_dialog_id;
+  int64 random_id{0};
+  int32 ttl_expires_at{0};
+  int32 index_mask{0};
+  int64 search_id{0};
+  string text;
+  NotificationId notification_id;
+  MessageId top_thread_message_id;
+  BufferSlice data;
+};
+
 class MessageDbSyncInterface {
  public:
   MessageDbSyncInterface() = default;
@@ -107,6 +124,7 @@ class MessageDbSyncInterface {
   virtual void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
                            int64 random_id, int32 ttl_expires_at, int32 index_mask, int64 search_id, string text,
                            NotificationId notification_id, MessageId top_thread_message_id, BufferSlice data) = 0;
+  virtual void add_messages(vector<MessageDbAddMessageQuery> queries) = 0;
   virtual void add_scheduled_message(MessageFullId message_full_id, BufferSlice data) = 0;
 
   virtual void delete_message(MessageFullId message_full_id) = 0;
@@ -159,8 +177,14 @@ class MessageDbAsyncInterface {
                            int64 random_id, int32 ttl_expires_at, int32 index_mask, int64 search_id, string text,
                            NotificationId notification_id, MessageId top_thread_message_id, BufferSlice data,
                            Promise<> promise) = 0;
+  virtual void add_messages(vector<MessageDbAddMessageQuery> queries, Promise<> promise) = 0;
   virtual void add_scheduled_message(MessageFullId message_full_id, BufferSlice data, Promise<> promise) = 0;
 
+  // add_message calls between start_add_message_batch and finish_add_message_batch are combined into one
+  // add_messages query, which is sent before any other query; all calls must be done from the same thread
+  virtual void start_add_message_batch() = 0;
+  virtual void finish_add_message_batch() = 0;
+
   virtual void delete_message(MessageFullId message_full_id, Promise<> promise) = 0;
   virtual void delete_all_dialog_messages(DialogId dialog_id, MessageId from_message_id, Promise<> promise) = 0;
   virtual void delete_dialog_messages_by_sender(DialogId dialog_id, DialogId sender_dialog_id, Promise<> promise) = 0;
@@ -199,7 +223,10 @@ Status drop_message_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
 std::shared_ptr<MessageDbSyncSafeInterface> create_message_db_sync(
     std::shared_ptr<SqliteConnectionSafe> sqlite_connection);
 
-std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(std::shared_ptr<MessageDbSyncSafeInterface> sync_db,
-                                                                 int32 scheduler_id = -1);
+// if reader_sync_db is non-null, then read queries are executed on reader_sync_db by separate actors
+// on the schedulers from reader_scheduler_ids, and only writes are done on the scheduler_id scheduler
+std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(
+    std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id = -1,
+    std::shared_ptr<MessageDbSyncSafeInterface> reader_sync_db = nullptr, vector<int32> reader_scheduler_ids = {});
 
 }  // namespace td
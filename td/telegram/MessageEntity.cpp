@@ -19,6 +19,7 @@
 #include "td/actor/MultiPromise.h"
 
 #include "td/utils/algorithm.h"
+#include "td/utils/bits.h"
 #include "td/utils/format.h"
 #include "td/utils/HashTableUtils.h"
 #include "td/utils/logging.h"
@@ -34,6 +35,14 @@
 #include <limits>
 #include <tuple>
 
+#if defined(__SSE2__) || (TD_MSVC && (defined(_M_X64) || (defined(_M_IX86) && _M_IX86_FP >= 2)))
+#define TD_SSE2 1
+#endif
+
+#if TD_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace td {
 
 int MessageEntity::get_type_priority(Type type) {
@@ -1678,9 +1687,92 @@ static void fix_entity_offsets(Slice text, vector<MessageEntity> &entities) {
   }
 }
 
+struct EntityTriggerFlags {
+  enum : int32 {
+    AtSign = 1 << 0,
+    Slash = 1 << 1,
+    NumberSign = 1 << 2,
+    DollarSign = 1 << 3,
+    Colon = 1 << 4,
+    Dot = 1 << 5,
+    All = (1 << 6) - 1
+  };
+};
+
+static constexpr size_t MIN_BANK_CARD_DIGIT_COUNT = 13;
+
+static int32 get_entity_trigger_flag(unsigned char c) {
+  switch (c) {
+    case '@':
+      return EntityTriggerFlags::AtSign;
+    case '/':
+      return EntityTriggerFlags::Slash;
+    case '#':
+      return EntityTriggerFlags::NumberSign;
+    case '$':
+      return EntityTriggerFlags::DollarSign;
+    case ':':
+      return EntityTriggerFlags::Colon;
+    case '.':
+      return EntityTriggerFlags::Dot;
+    default:
+      return 0;
+  }
+}
+
+// returns flags of characters, without which the corresponding entities can't be found, in a single pass over the text
+static int32 get_entity_trigger_flags(Slice text, size_t &digit_count) {
+  int32 flags = 0;
+  digit_count = 0;
+  const unsigned char *ptr = text.ubegin();
+  const unsigned char *end = text.uend();
+#if TD_SSE2
+  const auto at_signs = _mm_set1_epi8('@');
+  const auto slashes = _mm_set1_epi8('/');
+  const auto number_signs = _mm_set1_epi8('#');
+  const auto dollar_signs = _mm_set1_epi8('$');
+  const auto colons = _mm_set1_epi8(':');
+  const auto dots = _mm_set1_epi8('.');
+  const auto before_zeros = _mm_set1_epi8('0' - 1);
+  const auto after_nines = _mm_set1_epi8('9' + 1);
+  while (end - ptr >= 16) {
+    auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+    ptr += 16;
+    // bytes 0x80-0xFF are negative and aren't counted as digits
+    auto digits = _mm_and_si128(_mm_cmpgt_epi8(bytes, before_zeros), _mm_cmplt_epi8(bytes, after_nines));
+    digit_count += count_bits32(static_cast<uint32>(_mm_movemask_epi8(digits)));
+    if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, at_signs), _mm_cmpeq_epi8(bytes, slashes)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(bytes, number_signs),
+                                                    _mm_cmpeq_epi8(bytes, dollar_signs)))) != 0 ||
+        _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, colons), _mm_cmpeq_epi8(bytes, dots))) != 0) {
+      for (size_t i = 0; i < 16; i++) {
+        flags |= get_entity_trigger_flag(ptr[i - 16]);
+      }
+    }
+    if (flags == EntityTriggerFlags::All && digit_count >= MIN_BANK_CARD_DIGIT_COUNT) {
+      return flags;
+    }
+  }
+#endif
+  for (; ptr != end; ptr++) {
+    flags |= get_entity_trigger_flag(*ptr);
+    if (is_digit(*ptr)) {
+      digit_count++;
+    }
+  }
+  return flags;
+}
+
 vector<MessageEntity> find_entities(Slice text, bool skip_bot_commands, bool skip_media_timestamps) {
   vector<MessageEntity> entities;
 
+  // most texts contain no entities at all, so run the matchers only if the text has the needed characters
+  size_t digit_count = 0;
+  auto flags = get_entity_trigger_flags(text, digit_count);
+  auto has_flag = [flags](int32 flag) {
+    return (flags & flag) != 0;
+  };
+
   auto add_entities = [&entities, &text](MessageEntity::Type type, vector<Slice> (*find_entities_f)(Slice)) mutable {
     auto new_entities = find_entities_f(text);
     for (auto &entity : new_entities) {
@@ -1689,23 +1781,36 @@ vector<MessageEntity> find_entities(Slice text, bool skip_bot_commands, bool ski
       entities.emplace_back(type, offset, length);
     }
   };
-  add_entities(MessageEntity::Type::Mention, find_mentions);
-  if (!skip_bot_commands) {
+  if (has_flag(EntityTriggerFlags::AtSign)) {
+    add_entities(MessageEntity::Type::Mention, find_mentions);
+  }
+  if (!skip_bot_commands && has_flag(EntityTriggerFlags::Slash)) {
     add_entities(MessageEntity::Type::BotCommand, find_bot_commands);
   }
-  add_entities(MessageEntity::Type::Hashtag, find_hashtags);
-  add_entities(MessageEntity::Type::Cashtag, find_cashtags);
+  if (has_flag(EntityTriggerFlags::NumberSign)) {
+    add_entities(MessageEntity::Type::Hashtag, find_hashtags);
+  }
+  if (has_flag(EntityTriggerFlags::DollarSign)) {
+    add_entities(MessageEntity::Type::Cashtag, find_cashtags);
+  }
   // TODO find_phone_numbers
-  add_entities(MessageEntity::Type::BankCardNumber, find_bank_card_numbers);
-  add_entities(MessageEntity::Type::Url, find_tg_urls);
-  auto urls = find_urls(text);
-  for (auto &url : urls) {
-    auto type = url.second ? MessageEntity::Type::EmailAddress : MessageEntity::Type::Url;
-    auto offset = narrow_cast<int32>(url.first.begin() - text.begin());
-    auto length = narrow_cast<int32>(url.first.size());
-    entities.emplace_back(type, offset, length);
-  }
-  if (!skip_media_timestamps) {
+  if (digit_count >= MIN_BANK_CARD_DIGIT_COUNT) {
+    add_entities(MessageEntity::Type::BankCardNumber, find_bank_card_numbers);
+  }
+  if (has_flag(EntityTriggerFlags::Colon)) {
+    add_entities(MessageEntity::Type::Url, find_tg_urls);
+  }
+  if (has_flag(EntityTriggerFlags::Dot)) {
+    auto urls = find_urls(text);
+    for (auto &url : urls) {
+      auto type = url.second ? MessageEntity::Type::EmailAddress : MessageEntity::Type::Url;
+      auto offset = narrow_cast<int32>(url.first.begin() - text.begin());
+      auto length = narrow_cast<int32>(url.first.size());
+      entities.emplace_back(type, offset, length);
+    }
+  }
+  // the shortest media timestamp is "0:00"
+  if (!skip_media_timestamps && has_flag(EntityTriggerFlags::Colon) && digit_count >= 3) {
     auto media_timestamps = find_media_timestamps(text);
     for (auto &entity : media_timestamps) {
       auto offset = narrow_cast<int32>(entity.first.begin() - text.begin());
@@ -4066,6 +4171,30 @@ static Result<string> clean_input_string_with_entities(const string &text, vecto
       break;
     }
 
+    if (0x20 <= c && c < 0x80) {
+      // printable ASCII characters up to the next entity boundary are copied at once
+      auto max_length = text_size - pos;
+      if (!nested_entities_stack.empty()) {
+        auto *entity = nested_entities_stack.back().entity;
+        max_length = min(max_length, static_cast<size_t>(entity->offset + entity->length - utf16_offset));
+      }
+      if (current_entity < entities.size()) {
+        max_length = min(max_length, static_cast<size_t>(entities[current_entity].offset - utf16_offset));
+      }
+      size_t length = 1;
+      while (length < max_length) {
+        auto next = static_cast<unsigned char>(text[pos + length]);
+        if (next < 0x20 || next >= 0x80) {
+          break;
+        }
+        length++;
+      }
+      result.append(text, pos, length);
+      utf16_offset += static_cast<int32>(length);
+      pos += length - 1;
+      continue;
+    }
+
     switch (c) {
       // remove control characters
       case 0:
@@ -4458,7 +4587,7 @@ Status fix_formatted_text(string &text, vector<MessageEntity> &entities, bool al
       text = std::move(result);
     }
   }
-  LOG_CHECK(check_utf8(text)) << text;
+  LOG_DCHECK(check_utf8(text)) << text;
 
   if (!allow_empty && is_empty_string(text)) {
     return Status::Error(400, "Text must be non-empty");
@@ -438,6 +438,7 @@ void MessageImportManager::start_import_messages(DialogId dialog_id, int64 impor
   pending_message_import->dialog_id = dialog_id;
   pending_message_import->import_id = import_id;
   pending_message_import->promise = std::move(promise);
+  pending_message_import->attached_file_ids = std::move(attached_file_ids);
 
   auto &multipromise = pending_message_import->upload_files_multipromise;
 
@@ -451,15 +452,60 @@ void MessageImportManager::start_import_messages(DialogId dialog_id, int64 impor
     send_closure_later(actor_id, &MessageImportManager::on_imported_message_attachments_uploaded, random_id,
                        std::move(result));
   }));
-  auto lock_promise = multipromise.get_promise();
+  pending_message_imports_[random_id]->lock_promise = multipromise.get_promise();
 
-  for (auto attached_file_id : attached_file_ids) {
-    upload_imported_message_attachment(dialog_id, import_id,
+  upload_pending_imported_message_attachments(random_id);
+}
+
+void MessageImportManager::upload_pending_imported_message_attachments(int64 random_id) {
+  auto it = pending_message_imports_.find(random_id);
+  if (it == pending_message_imports_.end()) {
+    return;
+  }
+  auto *pending_message_import = it->second.get();
+  CHECK(pending_message_import != nullptr);
+
+  // uploading thousands of files simultaneously only opens all of them and splits the bandwidth between them,
+  // so upload only a few attachments at a time
+  auto &attached_file_ids = pending_message_import->attached_file_ids;
+  while (pending_message_import->active_upload_count < MAX_ACTIVE_ATTACHMENT_UPLOADS &&
+         pending_message_import->next_attached_file_pos < attached_file_ids.size()) {
+    auto attached_file_id = attached_file_ids[pending_message_import->next_attached_file_pos++];
+    pending_message_import->active_upload_count++;
+    auto promise = PromiseCreator::lambda([actor_id = actor_id(this), random_id,
+                                           promise = pending_message_import->upload_files_multipromise.get_promise()](
+                                              Result<Unit> result) mutable {
+      send_closure(actor_id, &MessageImportManager::on_imported_message_attachment_uploaded, random_id,
+                   result.is_error());
+      promise.set_result(std::move(result));
+    });
+    upload_imported_message_attachment(pending_message_import->dialog_id, pending_message_import->import_id,
                                        td_->file_manager_->dup_file_id(attached_file_id, "start_import_messages"),
-                                       false, multipromise.get_promise());
+                                       false, std::move(promise));
   }
 
-  lock_promise.set_value(Unit());
+  if (pending_message_import->next_attached_file_pos == attached_file_ids.size() &&
+      pending_message_import->lock_promise) {
+    LOG(INFO) << "Started upload of all " << attached_file_ids.size() << " attached files for import "
+              << pending_message_import->import_id;
+    pending_message_import->lock_promise.set_value(Unit());
+  }
+}
+
+void MessageImportManager::on_imported_message_attachment_uploaded(int64 random_id, bool is_error) {
+  auto it = pending_message_imports_.find(random_id);
+  if (it == pending_message_imports_.end()) {
+    return;
+  }
+  auto *pending_message_import = it->second.get();
+  CHECK(pending_message_import != nullptr);
+  CHECK(pending_message_import->active_upload_count > 0);
+  pending_message_import->active_upload_count--;
+  if (is_error) {
+    // the import will fail anyway, so there is no need to upload the remaining files
+    pending_message_import->next_attached_file_pos = pending_message_import->attached_file_ids.size();
+  }
+  upload_pending_imported_message_attachments(random_id);
 }
 
 void MessageImportManager::upload_imported_message_attachment(DialogId dialog_id, int64 import_id, FileId file_id,
@@ -59,6 +59,10 @@ class MessageImportManager final : public Actor {
 
   void on_upload_imported_message_attachment_error(FileId file_id, Status status);
 
+  void upload_pending_imported_message_attachments(int64 random_id);
+
+  void on_imported_message_attachment_uploaded(int64 random_id, bool is_error);
+
   void on_imported_message_attachments_uploaded(int64 random_id, Result<Unit> &&result);
 
   class UploadImportedMessagesCallback;
@@ -97,11 +101,18 @@ class MessageImportManager final : public Actor {
   FlatHashMap<FileId, unique_ptr<UploadedImportedMessageAttachmentInfo>, FileIdHash>
       being_uploaded_imported_message_attachments_;
 
+  static constexpr size_t MAX_ACTIVE_ATTACHMENT_UPLOADS = 10;
+
   struct PendingMessageImport {
     MultiPromiseActor upload_files_multipromise{"UploadAttachedFilesMultiPromiseActor"};
     DialogId dialog_id;
     int64 import_id = 0;
     Promise<Unit> promise;
+
+    vector<FileId> attached_file_ids;
+    size_t next_attached_file_pos = 0;
+    size_t active_upload_count = 0;
+    Promise<Unit> lock_promise;
   };
   FlatHashMap<int64, unique_ptr<PendingMessageImport>> pending_message_imports_;
 
@@ -45,6 +45,7 @@
 #include "td/telegram/LinkManager.h"
 #include "td/telegram/Location.h"
 #include "td/telegram/logevent/LogEvent.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageContent.h"
 #include "td/telegram/MessageDb.h"
 #include "td/telegram/MessageEntity.h"
@@ -4150,6 +4151,7 @@ class MessagesManager::UploadThumbnailCallback final : public FileManager::Uploa
 template <class StorerT>
 void MessagesManager::Message::store(StorerT &storer) const {
   using td::store;
+  const auto &message_send_info = get_message_send_info(this);
   bool has_sender = sender_user_id.is_valid();
   bool has_edit_date = edit_date > 0;
   bool has_random_id = random_id != 0;
@@ -4163,7 +4165,7 @@ void MessagesManager::Message::store(StorerT &storer) const {
   bool has_send_date = message_id.is_yet_unsent() && send_date != 0;
   bool has_flags2 = true;
   bool has_notification_id = notification_id.is_valid();
-  bool has_send_error_code = send_error_code != 0;
+  bool has_send_error_code = message_send_info.send_error_code != 0;
   bool has_real_forward_from = real_forward_from_dialog_id.is_valid() && real_forward_from_message_id.is_valid();
   bool has_legacy_layer = legacy_layer != 0;
   bool has_restriction_reasons = !restriction_reasons.empty();
@@ -4175,7 +4177,7 @@ void MessagesManager::Message::store(StorerT &storer) const {
   bool has_local_thread_message_ids = !local_thread_message_ids.empty();
   bool has_linked_top_thread_message_id = linked_top_thread_message_id.is_valid();
   bool has_interaction_info_update_date = interaction_info_update_date != 0;
-  bool has_send_emoji = !send_emoji.empty();
+  bool has_send_emoji = !message_send_info.send_emoji.empty();
   bool has_ttl_period = ttl_period != 0;
   bool has_max_reply_media_timestamp = max_reply_media_timestamp >= 0;
   bool are_message_media_timestamp_entities_found = true;
@@ -4184,11 +4186,12 @@ void MessagesManager::Message::store(StorerT &storer) const {
   bool has_available_reactions_generation = available_reactions_generation != 0;
   bool has_history_generation = history_generation != 0;
   bool is_reply_to_story = reply_to_story_full_id != StoryFullId();
-  bool has_input_reply_to = !message_id.is_any_server() && input_reply_to.is_valid();
+  bool has_input_reply_to = !message_id.is_any_server() && message_send_info.input_reply_to.is_valid();
   bool has_replied_message_info = !replied_message_info.is_empty();
   bool has_forward_info = forward_info != nullptr;
   bool has_saved_messages_topic_id = saved_messages_topic_id.is_valid();
-  bool has_initial_top_thread_message_id = !message_id.is_any_server() && initial_top_thread_message_id.is_valid();
+  bool has_initial_top_thread_message_id =
+      !message_id.is_any_server() && message_send_info.initial_top_thread_message_id.is_valid();
   bool has_sender_boost_count = sender_boost_count != 0;
   bool has_via_business_bot_user_id = via_business_bot_user_id.is_valid();
   bool has_effect_id = effect_id != 0;
@@ -4325,10 +4328,10 @@ void MessagesManager::Message::store(StorerT &storer) const {
     store_time(ttl_expires_at, storer);
   }
   if (has_send_error_code) {
-    store(send_error_code, storer);
-    store(send_error_message, storer);
-    if (send_error_code == 429) {
-      store_time(try_resend_at, storer);
+    store(message_send_info.send_error_code, storer);
+    store(message_send_info.send_error_message, storer);
+    if (message_send_info.send_error_code == 429) {
+      store_time(message_send_info.try_resend_at, storer);
     }
   }
   if (has_author_signature) {
@@ -4365,7 +4368,7 @@ void MessagesManager::Message::store(StorerT &storer) const {
     store(interaction_info_update_date, storer);
   }
   if (has_send_emoji) {
-    store(send_emoji, storer);
+    store(message_send_info.send_emoji, storer);
   }
   store_message_content(content.get(), storer);
   if (has_reply_markup) {
@@ -4390,7 +4393,7 @@ void MessagesManager::Message::store(StorerT &storer) const {
     store(reply_to_story_full_id, storer);
   }
   if (has_input_reply_to) {
-    store(input_reply_to, storer);
+    store(message_send_info.input_reply_to, storer);
   }
   if (has_replied_message_info) {
     store(replied_message_info, storer);
@@ -4399,7 +4402,7 @@ void MessagesManager::Message::store(StorerT &storer) const {
     store(saved_messages_topic_id, storer);
   }
   if (has_initial_top_thread_message_id) {
-    store(initial_top_thread_message_id, storer);
+    store(message_send_info.initial_top_thread_message_id, storer);
   }
   if (has_sender_boost_count) {
     store(sender_boost_count, storer);
@@ -4419,6 +4422,7 @@ void MessagesManager::Message::store(StorerT &storer) const {
 template <class ParserT>
 void MessagesManager::Message::parse(ParserT &parser) {
   using td::parse;
+  MessageSendInfo message_send_info;
   bool legacy_have_previous;
   bool legacy_have_next;
   bool has_sender;
@@ -4656,10 +4660,10 @@ void MessagesManager::Message::parse(ParserT &parser) {
     parse_time(ttl_expires_at, parser);
   }
   if (has_send_error_code) {
-    parse(send_error_code, parser);
-    parse(send_error_message, parser);
-    if (send_error_code == 429) {
-      parse_time(try_resend_at, parser);
+    parse(message_send_info.send_error_code, parser);
+    parse(message_send_info.send_error_message, parser);
+    if (message_send_info.send_error_code == 429) {
+      parse_time(message_send_info.try_resend_at, parser);
     }
   }
   if (has_author_signature) {
@@ -4700,7 +4704,7 @@ void MessagesManager::Message::parse(ParserT &parser) {
     parse(interaction_info_update_date, parser);
   }
   if (has_send_emoji) {
-    parse(send_emoji, parser);
+    parse(message_send_info.send_emoji, parser);
   }
   parse_message_content(content, parser);
   if (has_reply_markup) {
@@ -4725,12 +4729,12 @@ void MessagesManager::Message::parse(ParserT &parser) {
     parse(reply_to_story_full_id, parser);
   }
   if (has_input_reply_to) {
-    parse(input_reply_to, parser);
+    parse(message_send_info.input_reply_to, parser);
   } else if (!message_id.is_any_server()) {
     if (reply_to_story_full_id.is_valid()) {
-      input_reply_to = MessageInputReplyTo(reply_to_story_full_id);
+      message_send_info.input_reply_to = MessageInputReplyTo(reply_to_story_full_id);
     } else if (legacy_reply_to_message_id.is_valid()) {
-      input_reply_to = MessageInputReplyTo{legacy_reply_to_message_id, DialogId(), MessageQuote()};
+      message_send_info.input_reply_to = MessageInputReplyTo{legacy_reply_to_message_id, DialogId(), MessageQuote()};
     }
   }
   if (has_replied_message_info) {
@@ -4742,7 +4746,7 @@ void MessagesManager::Message::parse(ParserT &parser) {
     parse(saved_messages_topic_id, parser);
   }
   if (has_initial_top_thread_message_id) {
-    parse(initial_top_thread_message_id, parser);
+    parse(message_send_info.initial_top_thread_message_id, parser);
   }
   if (has_sender_boost_count) {
     parse(sender_boost_count, parser);
@@ -4757,6 +4761,11 @@ void MessagesManager::Message::parse(ParserT &parser) {
     parse(fact_check, parser);
   }
 
+  if (message_send_info.initial_top_thread_message_id.is_valid() || message_send_info.input_reply_to.is_valid() ||
+      !message_send_info.send_emoji.empty() || message_send_info.send_error_code != 0) {
+    send_info = make_unique<MessageSendInfo>(std::move(message_send_info));
+  }
+
   CHECK(content != nullptr);
   is_content_secret |= ttl.is_secret_message_content(content->get_type());  // repair is_content_secret for old messages
   if (hide_edit_date && content->get_type() == MessageContentType::LiveLocation) {
@@ -5455,6 +5464,10 @@ MessagesManager::MessagesManager(Td *td, ActorShared<> parent)
   pending_message_views_timeout_.set_callback(on_pending_message_views_timeout_callback);
   pending_message_views_timeout_.set_callback_data(static_cast<void *>(this));
 
+  pending_message_interaction_info_update_timeout_.set_callback(
+      on_pending_message_interaction_info_update_timeout_callback);
+  pending_message_interaction_info_update_timeout_.set_callback_data(static_cast<void *>(this));
+
   pending_message_live_location_view_timeout_.set_callback(on_pending_message_live_location_view_timeout_callback);
   pending_message_live_location_view_timeout_.set_callback_data(static_cast<void *>(this));
 
@@ -5487,13 +5500,17 @@ MessagesManager::MessagesManager(Td *td, ActorShared<> parent)
 }
 
 MessagesManager::~MessagesManager() {
+  // the list must be detached from dialogs before they are destroyed on another scheduler
+  while (!unload_dialog_list_.empty()) {
+    unload_dialog_list_.begin()->remove();
+  }
   Scheduler::instance()->destroy_on_scheduler(
       G()->get_gc_scheduler_id(), ttl_nodes_, ttl_heap_, being_sent_messages_, update_message_ids_,
       update_scheduled_message_ids_, message_id_to_dialog_id_, last_clear_history_message_id_to_dialog_id_, dialogs_,
       postponed_chat_read_inbox_updates_, found_public_dialogs_, found_on_server_dialogs_, message_embedding_codes_[0],
       message_embedding_codes_[1], message_to_replied_media_timestamp_messages_,
       story_to_replied_media_timestamp_messages_, notification_group_id_to_dialog_id_, pending_get_channel_differences_,
-      active_get_channel_differences_, get_channel_difference_to_log_event_id_, channel_get_difference_retry_timeouts_,
+      prioritized_pending_get_channel_differences_, active_get_channel_differences_, get_channel_difference_to_log_event_id_, channel_get_difference_retry_timeouts_,
       is_channel_difference_finished_, expected_channel_pts_, expected_channel_max_message_id_,
       dialog_bot_command_message_ids_, message_full_id_to_file_source_id_, last_outgoing_forwarded_message_date_,
       dialog_viewed_messages_, previous_repaired_read_inbox_max_message_id_, failed_to_load_dialogs_);
@@ -5526,6 +5543,17 @@ void MessagesManager::on_pending_message_views_timeout_callback(void *messages_m
                      DialogId(dialog_id_int));
 }
 
+void MessagesManager::on_pending_message_interaction_info_update_timeout_callback(void *messages_manager_ptr,
+                                                                                  int64 dialog_id_int) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  auto messages_manager = static_cast<MessagesManager *>(messages_manager_ptr);
+  send_closure_later(messages_manager->actor_id(messages_manager),
+                     &MessagesManager::on_pending_message_interaction_info_update_timeout, DialogId(dialog_id_int));
+}
+
 void MessagesManager::on_pending_message_live_location_view_timeout_callback(void *messages_manager_ptr,
                                                                              int64 task_id) {
   if (G()->close_flag()) {
@@ -6158,7 +6186,7 @@ void MessagesManager::on_update_message_view_count(MessageFullId message_full_id
     LOG(ERROR) << "Receive " << view_count << " views in updateChannelMessageViews for " << message_full_id;
     return;
   }
-  update_message_interaction_info(message_full_id, view_count, -1, false, nullptr, false, nullptr);
+  update_message_interaction_info(message_full_id, view_count, -1, false, nullptr, false, nullptr, true);
 }
 
 void MessagesManager::on_update_message_forward_count(MessageFullId message_full_id, int32 forward_count) {
@@ -6166,7 +6194,7 @@ void MessagesManager::on_update_message_forward_count(MessageFullId message_full
     LOG(ERROR) << "Receive " << forward_count << " forwards in updateChannelMessageForwards for " << message_full_id;
     return;
   }
-  update_message_interaction_info(message_full_id, -1, forward_count, false, nullptr, false, nullptr);
+  update_message_interaction_info(message_full_id, -1, forward_count, false, nullptr, false, nullptr, true);
 }
 
 void MessagesManager::on_update_message_reactions(MessageFullId message_full_id,
@@ -6200,13 +6228,13 @@ void MessagesManager::on_update_message_reactions(MessageFullId message_full_id,
     return;
   }
 
-  update_message_interaction_info(message_full_id, -1, -1, false, nullptr, true, std::move(new_reactions));
+  update_message_interaction_info(message_full_id, -1, -1, false, nullptr, true, std::move(new_reactions), true);
   promise.set_value(Unit());
 }
 
 void MessagesManager::update_message_reactions(MessageFullId message_full_id,
                                                unique_ptr<MessageReactions> &&reactions) {
-  update_message_interaction_info(message_full_id, -1, -1, false, nullptr, true, std::move(reactions));
+  update_message_interaction_info(message_full_id, -1, -1, false, nullptr, true, std::move(reactions), false);
 }
 
 void MessagesManager::on_get_message_reaction_list(
@@ -6241,7 +6269,7 @@ void MessagesManager::on_update_message_interaction_info(MessageFullId message_f
     return;
   }
   update_message_interaction_info(message_full_id, view_count, forward_count, has_reply_info, std::move(reply_info),
-                                  false, nullptr);
+                                  false, nullptr, false);
 }
 
 void MessagesManager::on_pending_message_views_timeout(DialogId dialog_id) {
@@ -6291,7 +6319,8 @@ void MessagesManager::on_pending_message_views_timeout(DialogId dialog_id) {
 void MessagesManager::update_message_interaction_info(MessageFullId message_full_id, int32 view_count,
                                                       int32 forward_count, bool has_reply_info,
                                                       tl_object_ptr<telegram_api::messageReplies> &&reply_info,
-                                                      bool has_reactions, unique_ptr<MessageReactions> &&reactions) {
+                                                      bool has_reactions, unique_ptr<MessageReactions> &&reactions,
+                                                      bool is_from_update) {
   if (td_->auth_manager_->is_bot()) {
     return;
   }
@@ -6324,12 +6353,53 @@ void MessagesManager::update_message_interaction_info(MessageFullId message_full
     has_reply_info = false;
   }
 
+  // interaction info of popular messages can be updated many times per second, so the changes are applied
+  // immediately, but the updates are sent and the messages are saved at most once in a while
+  bool need_delay_update =
+      is_from_update && pending_message_interaction_info_update_timeout_.has_timeout(dialog_id.get());
   if (update_message_interaction_info(d, m, view_count, forward_count, has_reply_info, std::move(new_reply_info),
-                                      has_reactions, std::move(reactions), "update_message_interaction_info")) {
-    on_message_changed(d, m, true, "update_message_interaction_info");
+                                      has_reactions, std::move(reactions), need_delay_update,
+                                      "update_message_interaction_info")) {
+    if (need_delay_update) {
+      LOG(INFO) << "Delay interaction info update of " << message_full_id;
+      pending_message_interaction_info_updates_[dialog_id].insert(message_id);
+    } else {
+      on_message_changed(d, m, true, "update_message_interaction_info");
+      if (is_from_update) {
+        pending_message_interaction_info_update_timeout_.add_timeout_in(dialog_id.get(),
+                                                                        MIN_MESSAGE_INTERACTION_INFO_UPDATE_DELAY);
+      }
+    }
   }
 }
 
+void MessagesManager::on_pending_message_interaction_info_update_timeout(DialogId dialog_id) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  auto it = pending_message_interaction_info_updates_.find(dialog_id);
+  if (it == pending_message_interaction_info_updates_.end()) {
+    return;
+  }
+  auto message_ids = std::move(it->second);
+  pending_message_interaction_info_updates_.erase(it);
+
+  Dialog *d = get_dialog(dialog_id);
+  CHECK(d != nullptr);
+  for (auto message_id : message_ids) {
+    const Message *m = get_message(d, message_id);
+    if (m == nullptr) {
+      // the message was deleted
+      continue;
+    }
+    send_update_message_interaction_info(dialog_id, m);
+    on_message_changed(d, m, true, "on_pending_message_interaction_info_update_timeout");
+  }
+  pending_message_interaction_info_update_timeout_.add_timeout_in(dialog_id.get(),
+                                                                  MIN_MESSAGE_INTERACTION_INFO_UPDATE_DELAY);
+}
+
 bool MessagesManager::is_thread_message(DialogId dialog_id, const Message *m) const {
   CHECK(m != nullptr);
   return is_thread_message(dialog_id, m->message_id, m->reply_info, m->content->get_type());
@@ -6533,7 +6603,7 @@ bool MessagesManager::update_message_fact_check(const Dialog *d, Message *m, uni
 bool MessagesManager::update_message_interaction_info(Dialog *d, Message *m, int32 view_count, int32 forward_count,
                                                       bool has_reply_info, MessageReplyInfo &&reply_info,
                                                       bool has_reactions, unique_ptr<MessageReactions> &&reactions,
-                                                      const char *source) {
+                                                      bool need_delay_update, const char *source) {
   if (td_->auth_manager_->is_bot()) {
     return false;
   }
@@ -6667,7 +6737,7 @@ bool MessagesManager::update_message_interaction_info(Dialog *d, Message *m, int
         on_message_changed(d, m, false, "update_message_interaction_info");
       }
     }
-    if (need_update) {
+    if (need_update && !need_delay_update) {
       send_update_message_interaction_info(dialog_id, m);
     }
     if (new_dialog_unread_reaction_count >= 0) {
@@ -8295,7 +8365,7 @@ void MessagesManager::do_send_media(DialogId dialog_id, Message *m, FileId file_
 
   const MessageContent *content = nullptr;
   if (m->message_id.is_any_server()) {
-    content = m->edited_content.get();
+    content = m->edited_message == nullptr ? nullptr : m->edited_message->content.get();
     if (content == nullptr) {
       LOG(ERROR) << "Message has no edited content";
       return;
@@ -8305,7 +8375,7 @@ void MessagesManager::do_send_media(DialogId dialog_id, Message *m, FileId file_
   }
 
   auto input_media = get_input_media(content, td_, std::move(input_file), std::move(input_thumbnail), file_id,
-                                     thumbnail_file_id, m->ttl, m->send_emoji, true);
+                                     thumbnail_file_id, m->ttl, get_message_send_info(m).send_emoji, true);
   LOG_CHECK(input_media != nullptr) << to_string(get_message_object(dialog_id, m, "do_send_media")) << ' '
                                     << have_input_file << ' ' << have_input_thumbnail << ' ' << file_id << ' '
                                     << thumbnail_file_id << ' ' << m->ttl;
@@ -8438,7 +8508,8 @@ void MessagesManager::on_upload_thumbnail(FileId thumbnail_file_id,
   bool is_edit = m->message_id.is_any_server();
 
   if (thumbnail_input_file == nullptr) {
-    delete_message_content_thumbnail(is_edit ? m->edited_content.get() : m->content.get(), td_);
+    CHECK(!is_edit || m->edited_message != nullptr);
+    delete_message_content_thumbnail(is_edit ? m->edited_message->content.get() : m->content.get(), td_);
   }
 
   auto dialog_id = message_full_id.get_dialog_id();
@@ -8682,10 +8753,17 @@ void MessagesManager::on_get_messages(vector<tl_object_ptr<telegram_api::Message
                                       bool is_scheduled, Promise<Unit> &&promise, const char *source) {
   TRY_STATUS_PROMISE(promise, G()->close_status());
 
+  auto *message_db = G()->use_message_database() ? G()->td_db()->get_message_db_async() : nullptr;
+  if (message_db != nullptr) {
+    message_db->start_add_message_batch();
+  }
   for (auto &message : messages) {
     LOG(INFO) << "Receive " << to_string(message);
     on_get_message(std::move(message), false, is_channel_message, is_scheduled, source);
   }
+  if (message_db != nullptr) {
+    message_db->finish_add_message_batch();
+  }
   promise.set_value(Unit());
 }
 
@@ -8841,6 +8919,11 @@ void MessagesManager::on_get_history(DialogId dialog_id, MessageId from_message_
     }
   }
 
+  // all received messages are saved to the database in one batch
+  auto *message_db = G()->use_message_database() ? G()->td_db()->get_message_db_async() : nullptr;
+  if (message_db != nullptr) {
+    message_db->start_add_message_batch();
+  }
   for (auto &message : messages) {
     auto expected_message_id = MessageId::get_message_id(message, false);
     if (!have_next && from_the_end && expected_message_id < d->last_message_id) {
@@ -8875,6 +8958,10 @@ void MessagesManager::on_get_history(DialogId dialog_id, MessageId from_message_
     }
   }
 
+  if (message_db != nullptr) {
+    message_db->finish_add_message_batch();
+  }
+
   if (from_the_end && last_added_message_id.is_valid() && last_added_message_id != last_received_message_id) {
     CHECK(last_added_message_id < last_received_message_id);
     delete_newer_server_messages_at_the_end(d, last_added_message_id);
@@ -10744,6 +10831,7 @@ void MessagesManager::unload_dialog(DialogId dialog_id, int32 delay) {
     // just in case
     LOG(INFO) << "Message unload is disabled in " << dialog_id;
     d->has_unload_timeout = false;
+    remove_dialog_from_unload_list(d);
     return;
   }
 
@@ -10783,6 +10871,103 @@ void MessagesManager::unload_dialog(DialogId dialog_id, int32 delay) {
         to_unload_message_ids.size() >= MAX_UNLOADED_MESSAGES ? 1.0 : get_next_unload_dialog_delay(d));
   } else {
     d->has_unload_timeout = false;
+    remove_dialog_from_unload_list(d);
+  }
+}
+
+int64 MessagesManager::get_loaded_message_count_max() const {
+  constexpr int64 DEFAULT_LOADED_MESSAGE_COUNT_MAX = 200000;
+  return td_->option_manager_->get_option_integer("loaded_message_count_max", DEFAULT_LOADED_MESSAGE_COUNT_MAX);
+}
+
+int64 MessagesManager::get_loaded_message_memory_max() const {
+  return td_->option_manager_->get_option_integer("loaded_message_memory_max");
+}
+
+int32 MessagesManager::get_message_memory_size(const Message *m) {
+  LogEventStorerCalcLength storer;
+  store_message_content(m->content.get(), storer);
+  return narrow_cast<int32>(sizeof(Message) + storer.get_length());
+}
+
+bool MessagesManager::is_loaded_message_limit_exceeded() const {
+  auto max_count = get_loaded_message_count_max();
+  if (max_count > 0 && loaded_message_count_ > max_count) {
+    return true;
+  }
+  auto max_memory_size = get_loaded_message_memory_max();
+  return max_memory_size > 0 && loaded_message_memory_size_ > max_memory_size;
+}
+
+void MessagesManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  size_t unload_dialog_count = 0;
+  for (auto it = unload_dialog_list_.begin(); it != unload_dialog_list_.end(); it = it->get_next()) {
+    unload_dialog_count++;
+  }
+  statistics.add("MessagesManager", "dialogs", dialogs_.calc_size(),
+                 sizeof(DialogId) + sizeof(unique_ptr<Dialog>) + sizeof(Dialog));
+  statistics.add_total("MessagesManager", "messages", static_cast<size_t>(loaded_message_count_),
+                       static_cast<size_t>(loaded_message_memory_size_));
+  statistics.add("MessagesManager", "unload_dialog_list", unload_dialog_count, 0);
+  statistics.add("MessagesManager", "message_id_to_dialog_id", message_id_to_dialog_id_.calc_size(),
+                 sizeof(MessageId) + sizeof(DialogId));
+  statistics.add("MessagesManager", "found_public_dialogs", found_public_dialogs_.size(),
+                 sizeof(string) + sizeof(vector<DialogId>));
+}
+
+void MessagesManager::add_dialog_to_unload_list(Dialog *d) {
+  CHECK(d->has_unload_timeout);
+  d->unload_list_node.dialog_id = d->dialog_id;
+  d->unload_list_node.remove();
+  unload_dialog_list_.put_back(&d->unload_list_node);
+}
+
+void MessagesManager::remove_dialog_from_unload_list(Dialog *d) {
+  d->unload_list_node.remove();
+}
+
+void MessagesManager::on_loaded_messages_changed(int32 count_diff, int64 memory_size_diff) {
+  loaded_message_count_ += count_diff;
+  loaded_message_memory_size_ += memory_size_diff;
+  CHECK(loaded_message_count_ >= 0);
+  CHECK(loaded_message_memory_size_ >= 0);
+  if (count_diff > 0 && !is_unload_least_recently_used_dialogs_scheduled_ && is_message_unload_enabled() &&
+      is_loaded_message_limit_exceeded()) {
+    // messages can't be unloaded synchronously, because pointers to them can be still used
+    is_unload_least_recently_used_dialogs_scheduled_ = true;
+    send_closure_later(actor_id(this), &MessagesManager::unload_least_recently_used_dialogs);
+  }
+}
+
+void MessagesManager::unload_least_recently_used_dialogs() {
+  is_unload_least_recently_used_dialogs_scheduled_ = false;
+  if (G()->close_flag() || !is_message_unload_enabled()) {
+    return;
+  }
+
+  // unload messages from closed dialogs, starting from the least recently used, until the number and the size of
+  // loaded messages become less than the limits; messages from opened dialogs are never unloaded
+  constexpr size_t MAX_UNLOADED_DIALOGS = 100;
+  auto old_loaded_message_count = loaded_message_count_;
+  size_t unloaded_dialog_count = 0;
+  while (is_loaded_message_limit_exceeded() && !unload_dialog_list_.empty() &&
+         unloaded_dialog_count < MAX_UNLOADED_DIALOGS) {
+    auto dialog_id = static_cast<DialogUnloadListNode *>(unload_dialog_list_.begin())->dialog_id;
+    LOG(INFO) << "Unload " << dialog_id << ", because there are " << loaded_message_count_
+              << " loaded messages of total size " << loaded_message_memory_size_;
+    unload_dialog(dialog_id, 0);
+    Dialog *d = get_dialog(dialog_id);
+    CHECK(d != nullptr);
+    if (d->has_unload_timeout) {
+      // some messages can't be unloaded now
+      add_dialog_to_unload_list(d);
+    }
+    unloaded_dialog_count++;
+  }
+  if (loaded_message_count_ < old_loaded_message_count && is_loaded_message_limit_exceeded() &&
+      !is_unload_least_recently_used_dialogs_scheduled_) {
+    is_unload_least_recently_used_dialogs_scheduled_ = true;
+    send_closure_later(actor_id(this), &MessagesManager::unload_least_recently_used_dialogs);
   }
 }
 
@@ -14852,7 +15037,7 @@ bool MessagesManager::can_unload_message(const Dialog *d, const Message *m) cons
   MessageFullId message_full_id{d->dialog_id, m->message_id};
   if (td_->auth_manager_->is_bot() && !G()->use_message_database()) {
     return !m->message_id.is_yet_unsent() && replied_by_yet_unsent_messages_.count(message_full_id) == 0 &&
-           m->edited_content == nullptr && m->message_id != d->last_pinned_message_id &&
+           m->edited_message == nullptr && m->message_id != d->last_pinned_message_id &&
            m->message_id != d->last_edited_message_id;
   }
   // don't want to unload messages from opened dialogs
@@ -14869,9 +15054,16 @@ bool MessagesManager::can_unload_message(const Dialog *d, const Message *m) cons
       return false;
     }
   }
+  // can't unload messages with not yet saved interaction info
+  {
+    auto it = pending_message_interaction_info_updates_.find(d->dialog_id);
+    if (it != pending_message_interaction_info_updates_.end() && it->second.count(m->message_id) > 0) {
+      return false;
+    }
+  }
   return d->open_count == 0 && m->message_id != d->last_message_id && m->message_id != d->last_database_message_id &&
          !m->message_id.is_yet_unsent() && active_live_location_message_full_ids_.count(message_full_id) == 0 &&
-         replied_by_yet_unsent_messages_.count(message_full_id) == 0 && m->edited_content == nullptr &&
+         replied_by_yet_unsent_messages_.count(message_full_id) == 0 && m->edited_message == nullptr &&
          m->message_id != d->reply_markup_message_id && m->message_id != d->last_pinned_message_id &&
          m->message_id != d->last_edited_message_id &&
          (m->media_album_id != d->last_media_album_id || m->media_album_id == 0);
@@ -15177,6 +15369,10 @@ unique_ptr<MessagesManager::Message> MessagesManager::do_delete_message(Dialog *
     delete_active_live_location(d->dialog_id, m);
     remove_message_file_sources(d->dialog_id, m);
 
+    if (message_id == d->last_sent_last_message_id) {
+      // the message can be added again, so the next updateChatLastMessage must contain it
+      d->last_sent_last_message_id = MessageId();
+    }
     if (message_id == d->last_message_id) {
       auto it = d->ordered_messages.get_const_iterator(message_id);
       CHECK(*it != nullptr);
@@ -15257,6 +15453,7 @@ unique_ptr<MessagesManager::Message> MessagesManager::do_delete_message(Dialog *
   auto result = std::move(d->messages[message_id]);
   CHECK(m == result.get());
   d->messages.erase(message_id);
+  on_loaded_messages_changed(-1, -result->memory_size);
 
   static_cast<ListNode *>(result.get())->remove();
 
@@ -17124,14 +17321,17 @@ bool MessagesManager::get_messages(DialogId dialog_id, const vector<MessageId> &
     return false;
   }
 
-  bool is_secret = dialog_id.get_type() == DialogType::SecretChat;
-  vector<MessageFullId> missed_message_ids;
+  // check all identifiers first to not load any message from the database if the request is invalid
   for (auto message_id : message_ids) {
     if (!message_id.is_valid() && !message_id.is_valid_scheduled()) {
       promise.set_error(Status::Error(400, "Invalid message identifier"));
       return false;
     }
+  }
 
+  bool is_secret = dialog_id.get_type() == DialogType::SecretChat;
+  vector<MessageFullId> missed_message_ids;
+  for (auto message_id : message_ids) {
     auto *m = get_message_force(d, message_id, "get_messages");
     if (m == nullptr && message_id.is_any_server() && !is_secret) {
       missed_message_ids.emplace_back(dialog_id, message_id);
@@ -19127,6 +19327,7 @@ void MessagesManager::open_dialog(Dialog *d) {
     LOG(INFO) << "Cancel unload timeout for " << dialog_id;
     pending_unload_dialog_timeout_.cancel_timeout(dialog_id.get());
     d->has_unload_timeout = false;
+    remove_dialog_from_unload_list(d);
   }
 
   if (d->notification_info != nullptr && d->notification_info->new_secret_chat_notification_id_.is_valid()) {
@@ -19157,6 +19358,7 @@ void MessagesManager::open_dialog(Dialog *d) {
       break;
     case DialogType::Channel: {
       auto channel_id = dialog_id.get_channel_id();
+      prioritize_pending_get_channel_difference(dialog_id);
       if (!td_->dialog_manager_->is_broadcast_channel(dialog_id)) {
         auto participant_count = td_->chat_manager_->get_channel_participant_count(channel_id);
         auto has_hidden_participants = td_->chat_manager_->get_channel_effective_has_hidden_participants(
@@ -19250,6 +19452,7 @@ void MessagesManager::close_dialog(Dialog *d) {
     CHECK(!d->has_unload_timeout);
     pending_unload_dialog_timeout_.set_timeout_in(dialog_id.get(), get_next_unload_dialog_delay(d));
     d->has_unload_timeout = true;
+    add_dialog_to_unload_list(d);
 
     if (d->need_unload_on_close) {
       unload_dialog(dialog_id, 0);
@@ -21166,6 +21369,7 @@ void MessagesManager::offline_search_messages(DialogId dialog_id, const string &
     fts_query.from_search_id = r_from_search_id.ok();
   }
   fts_query.limit = limit;
+  fts_query.use_prefix_search = true;
 
   G()->td_db()->get_message_db_async()->get_messages_fts(
       std::move(fts_query), PromiseCreator::lambda([offset = std::move(offset), limit, promise = std::move(promise)](
@@ -22608,16 +22812,17 @@ tl_object_ptr<td_api::MessageSendingState> MessagesManager::get_message_sending_
   }
   if (m->is_failed_to_send) {
     auto can_retry = can_resend_message(m);
-    auto error_code = m->send_error_code > 0 ? m->send_error_code : 400;
+    const auto &send_info = get_message_send_info(m);
+    auto error_code = send_info.send_error_code > 0 ? send_info.send_error_code : 400;
     auto need_another_sender =
-        can_retry && error_code == 400 && m->send_error_message == CSlice("SEND_AS_PEER_INVALID");
+        can_retry && error_code == 400 && send_info.send_error_message == CSlice("SEND_AS_PEER_INVALID");
     auto need_another_reply_quote =
-        can_retry && error_code == 400 && m->send_error_message == CSlice("QUOTE_TEXT_INVALID");
+        can_retry && error_code == 400 && send_info.send_error_message == CSlice("QUOTE_TEXT_INVALID");
     auto need_drop_reply =
-        can_retry && error_code == 400 && m->send_error_message == CSlice("REPLY_MESSAGE_ID_INVALID");
+        can_retry && error_code == 400 && send_info.send_error_message == CSlice("REPLY_MESSAGE_ID_INVALID");
     return td_api::make_object<td_api::messageSendingStateFailed>(
-        td_api::make_object<td_api::error>(error_code, m->send_error_message), can_retry, need_another_sender,
-        need_another_reply_quote, need_drop_reply, max(m->try_resend_at - Time::now(), 0.0));
+        td_api::make_object<td_api::error>(error_code, send_info.send_error_message), can_retry, need_another_sender,
+        need_another_reply_quote, need_drop_reply, max(send_info.try_resend_at - Time::now(), 0.0));
   }
   return nullptr;
 }
@@ -23009,10 +23214,10 @@ unique_ptr<MessagesManager::Message> MessagesManager::create_message_to_send(
   m->date = is_scheduled ? options.schedule_date : m->send_date;
   m->replied_message_info = RepliedMessageInfo(td_, input_reply_to);
   m->reply_to_story_full_id = input_reply_to.get_story_full_id();
-  m->input_reply_to = std::move(input_reply_to);
+  get_message_send_info_mutable(m).input_reply_to = std::move(input_reply_to);
   m->reply_to_random_id = reply_to_random_id;
   m->top_thread_message_id = top_thread_message_id;
-  m->initial_top_thread_message_id = initial_top_thread_message_id;
+  get_message_send_info_mutable(m).initial_top_thread_message_id = initial_top_thread_message_id;
   m->is_topic_message = is_topic_message;
   m->is_channel_post = is_channel_post;
   m->is_outgoing = is_scheduled || dialog_id != DialogId(my_id);
@@ -23037,7 +23242,7 @@ unique_ptr<MessagesManager::Message> MessagesManager::create_message_to_send(
         if (is_channel_post) {
           return td_->chat_manager_->get_channel_has_linked_channel(dialog_id.get_channel_id());
         }
-        return !m->input_reply_to.is_valid();
+        return !get_message_send_info(m).input_reply_to.is_valid();
       }()) {
     m->reply_info.reply_count_ = 0;
     if (is_channel_post) {
@@ -23267,10 +23472,24 @@ MessagesManager::ForwardedMessageInfo MessagesManager::get_forwarded_message_inf
   return result;
 }
 
+const MessagesManager::MessageSendInfo &MessagesManager::get_message_send_info(const Message *m) {
+  static const MessageSendInfo empty_send_info;
+  CHECK(m != nullptr);
+  return m->send_info == nullptr ? empty_send_info : *m->send_info;
+}
+
+MessagesManager::MessageSendInfo &MessagesManager::get_message_send_info_mutable(Message *m) {
+  CHECK(m != nullptr);
+  if (m->send_info == nullptr) {
+    m->send_info = make_unique<MessageSendInfo>();
+  }
+  return *m->send_info;
+}
+
 const MessageInputReplyTo *MessagesManager::get_message_input_reply_to(const Message *m) {
   CHECK(m != nullptr);
   CHECK(!m->message_id.is_any_server());
-  return &m->input_reply_to;
+  return &get_message_send_info(m).input_reply_to;
 }
 
 vector<FileId> MessagesManager::get_message_file_ids(const Message *m) const {
@@ -23310,7 +23529,7 @@ void MessagesManager::cancel_send_message_query(DialogId dialog_id, Message *m)
 
   cancel_upload_message_content_files(m->content.get());
 
-  CHECK(m->edited_content == nullptr);
+  CHECK(m->edited_message == nullptr);
 
   if (!m->send_query_ref.empty()) {
     LOG(INFO) << "Cancel send query for " << m->message_id;
@@ -23632,7 +23851,7 @@ Result<td_api::object_ptr<td_api::message>> MessagesManager::send_message(
     m->ttl = message_content.ttl;
     m->is_content_secret = m->ttl.is_secret_message_content(m->content->get_type());
   }
-  m->send_emoji = std::move(message_content.emoji);
+  get_message_send_info_mutable(m).send_emoji = std::move(message_content.emoji);
 
   if (message_send_options.only_preview) {
     return get_message_object(dialog_id, m, "send_message");
@@ -23697,7 +23916,7 @@ Result<InputMessageContent> MessagesManager::process_input_message_content(
 
     return InputMessageContent(std::move(content), get_message_disable_web_page_preview(copied_message),
                                new_invert_media, false, MessageSelfDestructType(), UserId(),
-                               copied_message->send_emoji);
+                               get_message_send_info(copied_message).send_emoji);
   }
 
   bool is_premium = td_->option_manager_->get_option_boolean("is_premium");
@@ -23939,7 +24158,8 @@ void MessagesManager::do_send_message(DialogId dialog_id, const Message *m, vect
     request.results.push_back(Status::OK());
   }
 
-  auto content = is_edit ? m->edited_content.get() : m->content.get();
+  CHECK(!is_edit || m->edited_message != nullptr);
+  auto content = is_edit ? m->edited_message->content.get() : m->content.get();
   CHECK(content != nullptr);
   auto content_type = content->get_type();
   if (content_type == MessageContentType::Text) {
@@ -23971,8 +24191,8 @@ void MessagesManager::do_send_message(DialogId dialog_id, const Message *m, vect
       on_secret_message_media_uploaded(dialog_id, m, std::move(secret_input_media), file_id, thumbnail_file_id);
     }
   } else {
-    auto input_media =
-        get_input_media(content, td_, m->ttl, m->send_emoji, td_->auth_manager_->is_bot() && bad_parts.empty());
+    auto input_media = get_input_media(content, td_, m->ttl, get_message_send_info(m).send_emoji,
+                                       td_->auth_manager_->is_bot() && bad_parts.empty());
     if (input_media == nullptr) {
       if (content_type == MessageContentType::Game || content_type == MessageContentType::Poll ||
           content_type == MessageContentType::Story) {
@@ -24011,8 +24231,9 @@ void MessagesManager::on_message_media_uploaded(DialogId dialog_id, const Messag
   CHECK(input_media != nullptr);
   auto message_id = m->message_id;
   if (message_id.is_any_server()) {
-    const FormattedText *caption = get_message_content_caption(m->edited_content.get());
-    auto input_reply_markup = get_input_reply_markup(td_->user_manager_.get(), m->edited_reply_markup);
+    CHECK(m->edited_message != nullptr);
+    const FormattedText *caption = get_message_content_caption(m->edited_message->content.get());
+    auto input_reply_markup = get_input_reply_markup(td_->user_manager_.get(), m->edited_message->reply_markup);
     bool was_uploaded = FileManager::extract_was_uploaded(input_media);
     bool was_thumbnail_uploaded = FileManager::extract_was_thumbnail_uploaded(input_media);
 
@@ -24020,7 +24241,7 @@ void MessagesManager::on_message_media_uploaded(DialogId dialog_id, const Messag
     auto schedule_date = get_message_schedule_date(m);
     auto promise = PromiseCreator::lambda(
         [actor_id = actor_id(this), dialog_id, message_id, file_id, thumbnail_file_id, schedule_date,
-         generation = m->edit_generation, was_uploaded, was_thumbnail_uploaded,
+         generation = m->edited_message->generation, was_uploaded, was_thumbnail_uploaded,
          file_reference = FileManager::extract_file_reference(input_media)](Result<int32> result) mutable {
           send_closure(actor_id, &MessagesManager::on_message_media_edited, dialog_id, message_id, file_id,
                        thumbnail_file_id, was_uploaded, was_thumbnail_uploaded, std::move(file_reference),
@@ -24029,7 +24250,8 @@ void MessagesManager::on_message_media_uploaded(DialogId dialog_id, const Messag
     td_->create_handler<EditMessageQuery>(std::move(promise))
         ->send(1 << 11, dialog_id, message_id, caption == nullptr ? "" : caption->text,
                get_input_message_entities(td_->user_manager_.get(), caption, "edit_message_media"),
-               std::move(input_media), m->edited_invert_media, std::move(input_reply_markup), schedule_date);
+               std::move(input_media), m->edited_message->invert_media, std::move(input_reply_markup),
+               schedule_date);
     return;
   }
 
@@ -24051,8 +24273,8 @@ void MessagesManager::on_message_media_uploaded(DialogId dialog_id, const Messag
                          td_->create_handler<SendMediaQuery>()->send(
                              file_id, thumbnail_file_id, get_message_flags(m), dialog_id,
                              get_send_message_as_input_peer(m), *get_message_input_reply_to(m),
-                             m->initial_top_thread_message_id, get_message_schedule_date(m), m->effect_id,
-                             get_input_reply_markup(td_->user_manager_.get(), m->reply_markup),
+                             get_message_send_info(m).initial_top_thread_message_id, get_message_schedule_date(m),
+                             m->effect_id, get_input_reply_markup(td_->user_manager_.get(), m->reply_markup),
                              get_input_message_entities(td_->user_manager_.get(), caption, "on_message_media_uploaded"),
                              caption == nullptr ? "" : caption->text, std::move(input_media), m->content->get_type(),
                              m->is_copy, random_id, &m->send_query_ref);
@@ -24210,7 +24432,7 @@ void MessagesManager::on_upload_message_media_success(DialogId dialog_id, Messag
     on_message_changed(d, m, need_update, "on_upload_message_media_success");
   }
 
-  auto input_media = get_input_media(m->content.get(), td_, m->ttl, m->send_emoji, true);
+  auto input_media = get_input_media(m->content.get(), td_, m->ttl, get_message_send_info(m).send_emoji, true);
   Status result;
   if (input_media == nullptr) {
     result = Status::Error(400, "Failed to upload file");
@@ -24367,7 +24589,7 @@ void MessagesManager::do_send_message_group(int64 media_album_id) {
     }
 
     input_reply_to = get_message_input_reply_to(m);
-    top_thread_message_id = m->initial_top_thread_message_id;
+    top_thread_message_id = get_message_send_info(m).initial_top_thread_message_id;
     flags = get_message_flags(m);
     schedule_date = get_message_schedule_date(m);
     effect_id = m->effect_id;
@@ -24386,7 +24608,7 @@ void MessagesManager::do_send_message_group(int64 media_album_id) {
     }
 
     const FormattedText *caption = get_message_content_caption(m->content.get());
-    auto input_media = get_input_media(m->content.get(), td_, m->ttl, m->send_emoji, true);
+    auto input_media = get_input_media(m->content.get(), td_, m->ttl, get_message_send_info(m).send_emoji, true);
     if (input_media == nullptr) {
       // TODO return CHECK
       auto file_id = get_message_content_any_file_id(m->content.get());
@@ -24467,15 +24689,15 @@ void MessagesManager::on_text_message_ready_to_send(DialogId dialog_id, MessageI
     if (input_media == nullptr) {
       td_->create_handler<SendMessageQuery>()->send(
           get_message_flags(m), dialog_id, get_send_message_as_input_peer(m), *get_message_input_reply_to(m),
-          m->initial_top_thread_message_id, get_message_schedule_date(m), m->effect_id,
+          get_message_send_info(m).initial_top_thread_message_id, get_message_schedule_date(m), m->effect_id,
           get_input_reply_markup(td_->user_manager_.get(), m->reply_markup),
           get_input_message_entities(td_->user_manager_.get(), message_text, "on_text_message_ready_to_send"),
           message_text->text, m->is_copy, random_id, &m->send_query_ref);
     } else {
       td_->create_handler<SendMediaQuery>()->send(
           FileId(), FileId(), get_message_flags(m), dialog_id, get_send_message_as_input_peer(m),
-          *get_message_input_reply_to(m), m->initial_top_thread_message_id, get_message_schedule_date(m), m->effect_id,
-          get_input_reply_markup(td_->user_manager_.get(), m->reply_markup),
+          *get_message_input_reply_to(m), get_message_send_info(m).initial_top_thread_message_id,
+          get_message_schedule_date(m), m->effect_id, get_input_reply_markup(td_->user_manager_.get(), m->reply_markup),
           get_input_message_entities(td_->user_manager_.get(), message_text, "on_text_message_ready_to_send"),
           message_text->text, std::move(input_media), MessageContentType::Text, m->is_copy, random_id,
           &m->send_query_ref);
@@ -24874,7 +25096,8 @@ void MessagesManager::do_send_inline_query_result_message(DialogId dialog_id, Me
   }
   m->send_query_ref = td_->create_handler<SendInlineBotResultQuery>()->send(
       flags, dialog_id, get_send_message_as_input_peer(m), *get_message_input_reply_to(m),
-      m->initial_top_thread_message_id, get_message_schedule_date(m), random_id, query_id, result_id);
+      get_message_send_info(m).initial_top_thread_message_id, get_message_schedule_date(m), random_id, query_id,
+      result_id);
 }
 
 bool MessagesManager::can_edit_message(DialogId dialog_id, const Message *m, bool is_editing,
@@ -24992,9 +25215,10 @@ bool MessagesManager::can_edit_message(DialogId dialog_id, const Message *m, boo
 }
 
 bool MessagesManager::can_resend_message(const Message *m) const {
-  if (m->send_error_code != 429 && m->send_error_message != "Message is too old to be re-sent automatically" &&
-      m->send_error_message != "SCHEDULE_TOO_MUCH" && m->send_error_message != "SEND_AS_PEER_INVALID" &&
-      m->send_error_message != "QUOTE_TEXT_INVALID" && m->send_error_message != "REPLY_MESSAGE_ID_INVALID") {
+  const auto &send_info = get_message_send_info(m);
+  if (send_info.send_error_code != 429 && send_info.send_error_message != "Message is too old to be re-sent automatically" &&
+      send_info.send_error_message != "SCHEDULE_TOO_MUCH" && send_info.send_error_message != "SEND_AS_PEER_INVALID" &&
+      send_info.send_error_message != "QUOTE_TEXT_INVALID" && send_info.send_error_message != "REPLY_MESSAGE_ID_INVALID") {
     return false;
   }
   if (m->is_bot_start_message) {
@@ -25183,17 +25407,14 @@ void MessagesManager::edit_message_live_location(MessageFullId message_full_id,
 }
 
 void MessagesManager::cancel_edit_message_media(DialogId dialog_id, Message *m, Slice error_message) {
-  if (m->edited_content == nullptr) {
+  if (m->edited_message == nullptr) {
     return;
   }
 
-  cancel_upload_message_content_files(m->edited_content.get());
+  cancel_upload_message_content_files(m->edited_message->content.get());
 
-  m->edited_content = nullptr;
-  m->edited_invert_media = false;
-  m->edited_reply_markup = nullptr;
-  m->edit_generation = 0;
-  m->edit_promise.set_error(Status::Error(400, error_message));
+  auto edited_message = std::move(m->edited_message);
+  edited_message->promise.set_error(Status::Error(400, error_message));
 }
 
 void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId message_id, FileId file_id,
@@ -25212,7 +25433,7 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
   Dialog *d = get_dialog(dialog_id);
   CHECK(d != nullptr);
   auto m = get_message(d, message_id);
-  if (m == nullptr || m->edit_generation != generation) {
+  if (m == nullptr || m->edited_message == nullptr || m->edited_message->generation != generation) {
     // message is already deleted or was edited again
     if (was_uploaded) {
       cancel_upload_file(file_id, "on_message_media_edited");
@@ -25220,7 +25441,7 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
     return;
   }
 
-  CHECK(m->edited_content != nullptr);
+  CHECK(m->edited_message->content != nullptr);
   if (result.is_ok()) {
     // message content has already been replaced from updateEdit{Channel,}Message
     // need only merge files from edited_content with their uploaded counterparts
@@ -25229,13 +25450,14 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
     auto pts = result.ok();
     LOG(INFO) << "Successfully edited " << message_id << " in " << dialog_id << " with PTS = " << pts
               << " and last edit PTS = " << m->last_edit_pts;
-    std::swap(m->content, m->edited_content);
-    bool need_send_update_message_content = m->edited_content->get_type() == MessageContentType::Photo &&
+    auto &edited_content = m->edited_message->content;
+    std::swap(m->content, edited_content);
+    bool need_send_update_message_content = edited_content->get_type() == MessageContentType::Photo &&
                                             m->content->get_type() == MessageContentType::Photo;
     bool need_merge_files = pts != 0 && pts == m->last_edit_pts;
     bool is_content_changed = false;
     bool need_update =
-        update_message_content(dialog_id, m, std::move(m->edited_content), need_merge_files, true, is_content_changed);
+        update_message_content(dialog_id, m, std::move(edited_content), need_merge_files, true, is_content_changed);
     if (need_send_update_message_content) {
       if (need_update) {
         send_update_message_content(d, m, true, "on_message_media_edited");
@@ -25271,7 +25493,7 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
       }
     }
 
-    cancel_upload_message_content_files(m->edited_content.get());
+    cancel_upload_message_content_files(m->edited_message->content.get());
 
     if (dialog_id.get_type() != DialogType::SecretChat) {
       get_message_from_server({dialog_id, m->message_id}, Auto(), "on_message_media_edited");
@@ -25284,14 +25506,11 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
   if (m->edited_schedule_date == schedule_date) {
     m->edited_schedule_date = 0;
   }
-  m->edited_content = nullptr;
-  m->edited_invert_media = false;
-  m->edited_reply_markup = nullptr;
-  m->edit_generation = 0;
+  auto edited_message = std::move(m->edited_message);
   if (result.is_ok()) {
-    m->edit_promise.set_value(Unit());
+    edited_message->promise.set_value(Unit());
   } else {
-    m->edit_promise.set_error(result.move_as_error());
+    edited_message->promise.set_error(result.move_as_error());
   }
 }
 
@@ -25358,13 +25577,14 @@ void MessagesManager::edit_message_media(MessageFullId message_full_id,
 
   cancel_edit_message_media(dialog_id, m, "Canceled by new editMessageMedia request");
 
-  m->edited_content =
+  m->edited_message = make_unique<EditedMessage>();
+  m->edited_message->content =
       dup_message_content(td_, dialog_id, content.content.get(), MessageContentDupType::Send, MessageCopyOptions());
-  CHECK(m->edited_content != nullptr);
-  m->edited_invert_media = content.invert_media;
-  m->edited_reply_markup = std::move(new_reply_markup);
-  m->edit_generation = ++current_message_edit_generation_;
-  m->edit_promise = std::move(promise);
+  CHECK(m->edited_message->content != nullptr);
+  m->edited_message->invert_media = content.invert_media;
+  m->edited_message->reply_markup = std::move(new_reply_markup);
+  m->edited_message->generation = ++current_message_edit_generation_;
+  m->edited_message->promise = std::move(promise);
 
   do_send_message(dialog_id, m);
 }
@@ -25983,8 +26203,9 @@ void MessagesManager::do_forward_messages(DialogId to_dialog_id, DialogId from_d
   vector<int64> random_ids =
       transform(messages, [this, to_dialog_id](const Message *m) { return begin_send_message(to_dialog_id, m); });
   send_closure_later(actor_id(this), &MessagesManager::send_forward_message_query, flags, to_dialog_id,
-                     messages[0]->initial_top_thread_message_id, from_dialog_id, std::move(as_input_peer), message_ids,
-                     std::move(random_ids), schedule_date, get_erase_log_event_promise(log_event_id));
+                     get_message_send_info(messages[0]).initial_top_thread_message_id, from_dialog_id,
+                     std::move(as_input_peer), message_ids, std::move(random_ids), schedule_date,
+                     get_erase_log_event_promise(log_event_id));
 }
 
 void MessagesManager::send_forward_message_query(int32 flags, DialogId to_dialog_id,
@@ -26664,7 +26885,7 @@ Result<vector<MessageId>> MessagesManager::resend_messages(DialogId dialog_id, v
     if (!can_resend_message(m)) {
       return Status::Error(400, "Message can't be re-sent");
     }
-    if (m->try_resend_at > Time::now()) {
+    if (get_message_send_info(m).try_resend_at > Time::now()) {
       return Status::Error(400, "Message can't be re-sent yet");
     }
     if (last_message_id != MessageId()) {
@@ -26726,23 +26947,24 @@ Result<vector<MessageId>> MessagesManager::resend_messages(DialogId dialog_id, v
     CHECK(message != nullptr);
     send_update_delete_messages(dialog_id, {message->message_id.get()}, true);
 
+    auto &send_info = get_message_send_info_mutable(message.get());
     auto need_another_sender =
-        message->send_error_code == 400 && message->send_error_message == CSlice("SEND_AS_PEER_INVALID");
+        send_info.send_error_code == 400 && send_info.send_error_message == CSlice("SEND_AS_PEER_INVALID");
     auto need_another_reply_quote =
-        message->send_error_code == 400 && message->send_error_message == CSlice("QUOTE_TEXT_INVALID");
+        send_info.send_error_code == 400 && send_info.send_error_message == CSlice("QUOTE_TEXT_INVALID");
     auto need_drop_reply =
-        message->send_error_code == 400 && message->send_error_message == CSlice("REPLY_MESSAGE_ID_INVALID");
+        send_info.send_error_code == 400 && send_info.send_error_message == CSlice("REPLY_MESSAGE_ID_INVALID");
     if (need_another_reply_quote && message_ids.size() == 1 && quote != nullptr) {
-      CHECK(message->input_reply_to.is_valid());
-      CHECK(message->input_reply_to.has_quote());  // checked in on_send_message_fail
-      message->input_reply_to.set_quote(MessageQuote{td_, std::move(quote)});
+      CHECK(send_info.input_reply_to.is_valid());
+      CHECK(send_info.input_reply_to.has_quote());  // checked in on_send_message_fail
+      send_info.input_reply_to.set_quote(MessageQuote{td_, std::move(quote)});
     } else if (need_drop_reply) {
-      message->input_reply_to = {};
+      send_info.input_reply_to = {};
     }
     MessageSendOptions options(message->disable_notification, message->from_background,
                                message->update_stickersets_order, message->noforwards, false,
                                get_message_schedule_date(message.get()), message->sending_id, message->effect_id);
-    Message *m = get_message_to_send(d, message->top_thread_message_id, std::move(message->input_reply_to), options,
+    Message *m = get_message_to_send(d, message->top_thread_message_id, std::move(send_info.input_reply_to), options,
                                      std::move(new_contents[i]), message->invert_media, &need_update_dialog_pos, false,
                                      nullptr, DialogId(), message->is_copy,
                                      need_another_sender ? DialogId() : get_message_sender(message.get()));
@@ -26753,7 +26975,7 @@ Result<vector<MessageId>> MessagesManager::resend_messages(DialogId dialog_id, v
     m->ttl = message->ttl;
     m->is_content_secret = message->is_content_secret;
     m->media_album_id = new_media_album_ids[message->media_album_id].first;
-    m->send_emoji = message->send_emoji;
+    get_message_send_info_mutable(m).send_emoji = std::move(send_info.send_emoji);
     m->has_explicit_sender |= message->has_explicit_sender;
 
     save_send_message_log_event(dialog_id, m);
@@ -26987,7 +27209,7 @@ Result<MessageId> MessagesManager::add_local_message(
     m->ttl = message_content.ttl;
   }
   m->is_content_secret = m->ttl.is_secret_message_content(m->content->get_type());
-  m->send_emoji = std::move(message_content.emoji);
+  get_message_send_info_mutable(m).send_emoji = std::move(message_content.emoji);
   if (dialog_id == DialogId(my_id)) {
     m->saved_messages_topic_id = SavedMessagesTopicId(dialog_id, m->forward_info.get(), DialogId());
   }
@@ -27073,6 +27295,13 @@ void MessagesManager::send_update_new_message(const Dialog *d, const Message *m)
   CHECK(d != nullptr);
   CHECK(m != nullptr);
   CHECK(d->is_update_new_chat_sent);
+  if (!td_->need_send_update(td_api::updateNewMessage::ID, d->dialog_id.get())) {
+    // the message object isn't created, but later updates about the message must be handled as if it was sent
+    if (!td_->auth_manager_->is_bot() || get_message_sending_state_object(m) == nullptr) {
+      m->is_update_sent = true;
+    }
+    return;
+  }
   send_closure(
       G()->td(), &Td::send_update,
       td_api::make_object<td_api::updateNewMessage>(get_message_object(d->dialog_id, m, "send_update_new_message")));
@@ -27980,6 +28209,10 @@ bool MessagesManager::is_message_notification_disabled(const Dialog *d, const Me
   if (!has_incoming_notification(d->dialog_id, m) || td_->auth_manager_->is_bot()) {
     return true;
   }
+  if (!td_->notification_manager_->are_notifications_enabled()) {
+    // there is no need to allocate notification identifiers and to find notification settings
+    return true;
+  }
   if (m->is_from_scheduled && d->dialog_id != td_->dialog_manager_->get_my_dialog_id() &&
       td_->option_manager_->get_option_boolean("disable_sent_scheduled_message_notifications")) {
     return true;
@@ -28358,6 +28591,9 @@ void MessagesManager::send_update_message_send_succeeded(Dialog *d, MessageId ol
       !d->had_yet_unsent_message_id_overflow && m->message_id != MessageId(ServerMessageId(1))) {
     LOG(ERROR) << "Sent " << old_message_id << " to " << d->dialog_id << " as " << m->message_id;
   }
+  if (!td_->need_send_update(td_api::updateMessageSendSucceeded::ID, d->dialog_id.get())) {
+    return;
+  }
   send_closure(G()->td(), &Td::send_update,
                td_api::make_object<td_api::updateMessageSendSucceeded>(
                    get_message_object(d->dialog_id, m, "send_update_message_send_succeeded"), old_message_id.get()));
@@ -28383,6 +28619,9 @@ void MessagesManager::send_update_message_content_impl(DialogId dialog_id, const
     LOG(INFO) << "Skip updateMessageContent for " << m->message_id << " in " << dialog_id << " from " << source;
     return;
   }
+  if (!td_->need_send_update(td_api::updateMessageContent::ID, dialog_id.get())) {
+    return;
+  }
   LOG(INFO) << "Send updateMessageContent for " << m->message_id << " in " << dialog_id << " from " << source;
   send_closure(G()->td(), &Td::send_update,
                td_api::make_object<td_api::updateMessageContent>(get_chat_id_object(dialog_id, "updateMessageContent"),
@@ -28402,7 +28641,8 @@ void MessagesManager::send_update_message_edited(DialogId dialog_id, const Messa
 
 void MessagesManager::send_update_message_interaction_info(DialogId dialog_id, const Message *m) const {
   CHECK(m != nullptr);
-  if (td_->auth_manager_->is_bot() || !m->is_update_sent) {
+  if (td_->auth_manager_->is_bot() || !m->is_update_sent ||
+      !td_->need_send_update(td_api::updateMessageInteractionInfo::ID, dialog_id.get())) {
     return;
   }
 
@@ -28476,6 +28716,7 @@ void MessagesManager::send_update_new_chat(Dialog *d, const char *source) {
   bool has_background = chat_object->background_ != nullptr;
   bool has_theme = !chat_object->theme_name_.empty();
   d->last_sent_has_scheduled_messages = chat_object->has_scheduled_messages_;
+  d->last_sent_last_message_id = chat_object->last_message_ == nullptr ? MessageId() : d->last_message_id;
   send_closure(G()->td(), &Td::send_update, td_api::make_object<td_api::updateNewChat>(std::move(chat_object)));
   d->is_update_new_chat_sent = true;
   d->is_update_new_chat_being_sent = false;
@@ -28529,6 +28770,12 @@ void MessagesManager::send_update_last_message_if_needed(const Dialog *d, const
 }
 
 void MessagesManager::send_update_chat_last_message(Dialog *d, const char *source) {
+  CHECK(d != nullptr);
+  if (d->last_message_id.is_valid() && d->last_message_id == d->last_sent_last_message_id) {
+    // the app already has the last message, so send only changed positions of the chat
+    update_dialog_pos(d, source);
+    return;
+  }
   update_dialog_pos(d, source, false);
   send_update_chat_last_message_impl(d, source);
 }
@@ -28544,6 +28791,7 @@ void MessagesManager::send_update_chat_last_message_impl(const Dialog *d, const
   LOG(INFO) << "Send updateChatLastMessage in " << d->dialog_id << " to " << d->last_message_id << " from " << source;
   const auto *m = get_message(d, d->last_message_id);
   auto message_object = get_message_object(d->dialog_id, m, "send_update_chat_last_message_impl");
+  d->last_sent_last_message_id = message_object == nullptr ? MessageId() : d->last_message_id;
   auto positions_object = get_chat_positions_object(d);
   auto update =
       td_api::make_object<td_api::updateChatLastMessage>(get_chat_id_object(d->dialog_id, "updateChatLastMessage"),
@@ -29578,12 +29826,13 @@ void MessagesManager::fail_send_message(MessageFullId message_full_id, int32 err
     message->view_count = 0;
   }
   message->is_failed_to_send = true;
-  message->send_error_code = error_code;
-  message->send_error_message = error_message;
-  message->try_resend_at = 0.0;
+  auto &send_info = get_message_send_info_mutable(message.get());
+  send_info.send_error_code = error_code;
+  send_info.send_error_message = error_message;
+  send_info.try_resend_at = 0.0;
   auto retry_after = Global::get_retry_after(error_code, error_message);
   if (retry_after > 0) {
-    message->try_resend_at = Time::now() + retry_after;
+    send_info.try_resend_at = Time::now() + retry_after;
   }
   update_failed_to_send_message_content(td_, message->content);
 
@@ -29603,10 +29852,12 @@ void MessagesManager::fail_send_message(MessageFullId message_full_id, int32 err
   if (!td_->auth_manager_->is_bot()) {
     yet_unsent_message_full_id_to_persistent_message_id_.emplace({dialog_id, old_message_id}, m->message_id);
   }
-  send_closure(G()->td(), &Td::send_update,
-               td_api::make_object<td_api::updateMessageSendFailed>(
-                   get_message_object(dialog_id, m, "fail_send_message"), old_message_id.get(),
-                   td_api::make_object<td_api::error>(error_code, error_message)));
+  if (td_->need_send_update(td_api::updateMessageSendFailed::ID, dialog_id.get())) {
+    send_closure(G()->td(), &Td::send_update,
+                 td_api::make_object<td_api::updateMessageSendFailed>(
+                     get_message_object(dialog_id, m, "fail_send_message"), old_message_id.get(),
+                     td_api::make_object<td_api::error>(error_code, error_message)));
+  }
   if (need_update_dialog_pos) {
     send_update_chat_last_message(d, "fail_send_message");
   }
@@ -29629,8 +29880,8 @@ void MessagesManager::fail_edit_message_media(MessageFullId message_full_id, Sta
     // message has already been deleted by the user or sent to inaccessible channel
     return;
   }
-  CHECK(m->edited_content != nullptr);
-  m->edit_promise.set_error(std::move(error));
+  CHECK(m->edited_message != nullptr);
+  m->edited_message->promise.set_error(std::move(error));
   cancel_edit_message_media(dialog_id, m, "Failed to edit message. MUST BE IGNORED");
 }
 
@@ -29721,10 +29972,11 @@ void MessagesManager::clear_dialog_draft_by_sent_message(Dialog *d, const Messag
   if (td_->auth_manager_->is_bot()) {
     return;
   }
+  auto initial_top_thread_message_id = get_message_send_info(m).initial_top_thread_message_id;
   if (!m->clear_draft) {
     const DraftMessage *draft_message = nullptr;
-    if (m->initial_top_thread_message_id.is_valid()) {
-      auto top_m = get_message_force(d, m->initial_top_thread_message_id, "clear_dialog_draft_by_sent_message");
+    if (initial_top_thread_message_id.is_valid()) {
+      auto top_m = get_message_force(d, initial_top_thread_message_id, "clear_dialog_draft_by_sent_message");
       if (top_m != nullptr) {
         draft_message = top_m->thread_draft_message.get();
       }
@@ -29735,8 +29987,8 @@ void MessagesManager::clear_dialog_draft_by_sent_message(Dialog *d, const Messag
       return;
     }
   }
-  if (m->initial_top_thread_message_id.is_valid()) {
-    set_dialog_draft_message(d->dialog_id, m->initial_top_thread_message_id, nullptr).ignore();
+  if (initial_top_thread_message_id.is_valid()) {
+    set_dialog_draft_message(d->dialog_id, initial_top_thread_message_id, nullptr).ignore();
   } else {
     update_dialog_draft_message(d, nullptr, false, need_update_dialog_pos);
   }
@@ -32556,6 +32808,9 @@ MessagesManager::Message *MessagesManager::add_message_to_dialog(Dialog *d, uniq
     pending_unload_dialog_timeout_.add_timeout_in(dialog_id.get(), get_next_unload_dialog_delay(d));
     d->has_unload_timeout = true;
   }
+  if (d->has_unload_timeout) {
+    add_dialog_to_unload_list(d);
+  }
 
   if (message->ttl.is_valid() && message->ttl_expires_at != 0) {
     auto now = Time::now();
@@ -32770,7 +33025,9 @@ MessagesManager::Message *MessagesManager::add_message_to_dialog(Dialog *d, uniq
   }
 
   Message *result_message = message.get();
+  result_message->memory_size = get_message_memory_size(result_message);
   d->messages.set(message_id, std::move(message));
+  on_loaded_messages_changed(1, result_message->memory_size);
 
   d->message_lru_list.put_back(result_message);
 
@@ -33842,7 +34099,7 @@ bool MessagesManager::update_message(Dialog *d, Message *old_message, unique_ptr
   // update_message_interaction_info must be called after top_thread_message_id is updated
   if (update_message_interaction_info(d, old_message, new_message->view_count, new_message->forward_count, true,
                                       std::move(new_message->reply_info), true, std::move(new_message->reactions),
-                                      "update_message")) {
+                                      false, "update_message")) {
     need_send_update = true;
   }
   if (update_message_fact_check(d, old_message, std::move(new_message->fact_check), false)) {
@@ -35991,26 +36248,50 @@ void MessagesManager::do_get_channel_difference(DialogId dialog_id, int32 pts, b
     limit = MIN_CHANNEL_DIFFERENCE;
   }
 
-  pending_get_channel_differences_.push(
-      td::make_unique<PendingGetChannelDifference>(dialog_id, pts, limit, force, std::move(input_channel), source));
+  auto query =
+      td::make_unique<PendingGetChannelDifference>(dialog_id, pts, limit, force, std::move(input_channel), source);
+  if (is_get_channel_difference_prioritized(d)) {
+    prioritized_pending_get_channel_differences_.push_back(std::move(query));
+  } else {
+    pending_get_channel_differences_.push_back(std::move(query));
+  }
   process_pending_get_channel_differences();
 }
 
+bool MessagesManager::is_get_channel_difference_prioritized(const Dialog *d) {
+  return d != nullptr && (d->open_count > 0 || d->unread_mention_count > 0);
+}
+
+void MessagesManager::prioritize_pending_get_channel_difference(DialogId dialog_id) {
+  for (auto it = pending_get_channel_differences_.begin(); it != pending_get_channel_differences_.end(); ++it) {
+    if ((*it)->dialog_id_ == dialog_id) {
+      LOG(INFO) << "Prioritize channels.getDifference for " << dialog_id;
+      prioritized_pending_get_channel_differences_.push_back(std::move(*it));
+      pending_get_channel_differences_.erase(it);
+      return;
+    }
+  }
+}
+
 void MessagesManager::process_pending_get_channel_differences() {
   static constexpr int32 MAX_CONCURRENT_GET_CHANNEL_DIFFERENCES = 10;
 
-  if (pending_get_channel_differences_.empty() ||
+  if ((pending_get_channel_differences_.empty() && prioritized_pending_get_channel_differences_.empty()) ||
       get_channel_difference_count_ >= MAX_CONCURRENT_GET_CHANNEL_DIFFERENCES) {
     return;
   }
 
   get_channel_difference_count_++;
 
-  auto query = std::move(pending_get_channel_differences_.front());
-  pending_get_channel_differences_.pop();
+  auto &queue = prioritized_pending_get_channel_differences_.empty() ? pending_get_channel_differences_
+                                                                     : prioritized_pending_get_channel_differences_;
+  auto query = std::move(queue.front());
+  queue.pop_front();
 
   LOG(INFO) << "-----BEGIN GET CHANNEL DIFFERENCE----- for " << query->dialog_id_ << " with PTS " << query->pts_
-            << " and limit " << query->limit_ << " from " << query->source_;
+            << " and limit " << query->limit_ << " from " << query->source_ << " with "
+            << prioritized_pending_get_channel_differences_.size() << " + " << pending_get_channel_differences_.size()
+            << " more pending requests";
 
   td_->create_handler<GetChannelDifferenceQuery>()->send(query->dialog_id_, std::move(query->input_channel_),
                                                          query->pts_, query->limit_, query->force_);
@@ -36918,7 +37199,7 @@ void MessagesManager::set_message_reply(const Dialog *d, Message *m, MessageInpu
   m->reply_to_story_full_id = StoryFullId();
   m->reply_to_random_id = get_message_reply_to_random_id(d, m);
   if (!m->message_id.is_any_server()) {
-    m->input_reply_to = std::move(input_reply_to);
+    get_message_send_info_mutable(m).input_reply_to = std::move(input_reply_to);
   }
   if (is_message_in_dialog) {
     register_message_reply(d->dialog_id, m);
@@ -36935,7 +37216,7 @@ void MessagesManager::update_message_reply_to_message_id(const Dialog *d, Messag
   }
   m->replied_message_info.set_message_id(reply_to_message_id);
   if (!m->message_id.is_any_server()) {
-    m->input_reply_to.set_message_id(reply_to_message_id);
+    get_message_send_info_mutable(m).input_reply_to.set_message_id(reply_to_message_id);
   }
   if (is_message_in_dialog) {
     register_message_reply(d->dialog_id, m);
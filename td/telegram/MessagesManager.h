@@ -94,10 +94,10 @@
 #include "td/utils/WaitFreeHashSet.h"
 
 #include <array>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
-#include <queue>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -113,6 +113,7 @@ class DialogFilter;
 class DraftMessage;
 class FactCheck;
 struct InputMessageContent;
+class MemoryStatistics;
 class MessageContent;
 class MessageForwardInfo;
 struct MessageReactions;
@@ -956,6 +957,8 @@ class MessagesManager final : public Actor {
 
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   void add_message_file_to_downloads(MessageFullId message_full_id, FileId file_id, int32 priority,
                                      Promise<td_api::object_ptr<td_api::file>> promise);
 
@@ -1017,6 +1020,26 @@ class MessagesManager final : public Actor {
     tl_object_ptr<telegram_api::ReplyMarkup> reply_markup;
   };
 
+  // rarely used fields of yet unsent and failed to send messages
+  struct MessageSendInfo {
+    MessageId initial_top_thread_message_id;  // for send_message
+    MessageInputReplyTo input_reply_to;       // for send_message
+    string send_emoji;                        // for send_message
+
+    int32 send_error_code = 0;
+    string send_error_message;
+    double try_resend_at = 0;
+  };
+
+  // new content of a message, which media is being edited
+  struct EditedMessage {
+    unique_ptr<MessageContent> content;
+    unique_ptr<ReplyMarkup> reply_markup;
+    bool invert_media = false;
+    uint64 generation = 0;
+    Promise<Unit> promise;
+  };
+
   // Do not forget to update MessagesManager::update_message and all make_unique<Message> when this class is changed
   struct Message final : public ListNode {
     MessageId message_id;
@@ -1040,10 +1063,7 @@ class MessagesManager final : public Actor {
     MessageId linked_top_thread_message_id;
     vector<MessageId> local_thread_message_ids;
 
-    MessageId initial_top_thread_message_id;  // for send_message
-    MessageInputReplyTo input_reply_to;       // for send_message
-    int64 reply_to_random_id = 0;             // for send_message
-    string send_emoji;                        // for send_message
+    int64 reply_to_random_id = 0;  // for send_message
 
     UserId via_bot_user_id;
     UserId via_business_bot_user_id;
@@ -1107,9 +1127,7 @@ class MessagesManager final : public Actor {
 
     int32 legacy_layer = 0;
 
-    int32 send_error_code = 0;
-    string send_error_message;
-    double try_resend_at = 0;
+    unique_ptr<MessageSendInfo> send_info;  // allocated only if some of the fields are non-empty
 
     int32 ttl_period = 0;         // counted from message send date
     MessageSelfDestructType ttl;  // counted from message content view date
@@ -1123,11 +1141,7 @@ class MessagesManager final : public Actor {
     unique_ptr<ReplyMarkup> reply_markup;
 
     int32 edited_schedule_date = 0;
-    bool edited_invert_media = false;
-    unique_ptr<MessageContent> edited_content;
-    unique_ptr<ReplyMarkup> edited_reply_markup;
-    uint64 edit_generation = 0;
-    Promise<Unit> edit_promise;
+    unique_ptr<EditedMessage> edited_message;  // allocated only while media of the message is being edited
 
     int32 last_edit_pts = 0;
 
@@ -1136,6 +1150,8 @@ class MessagesManager final : public Actor {
     mutable int32 last_access_date = 0;
     mutable bool is_update_sent = false;  // whether the message is known to the app
 
+    int32 memory_size = 0;  // approximate memory size of the message at the time it was added to the dialog
+
     mutable uint64 send_message_log_event_id = 0;
 
     mutable NetQueryRef send_query_ref;
@@ -1177,6 +1193,10 @@ class MessagesManager final : public Actor {
     FlatHashMap<NotificationId, MessageId, NotificationIdHash> notification_id_to_message_id_;
   };
 
+  struct DialogUnloadListNode final : public ListNode {
+    DialogId dialog_id;
+  };
+
   struct Dialog {
     DialogId dialog_id;
     MessageId last_new_message_id;  // identifier of the last known server message received from update, there should be
@@ -1251,6 +1271,7 @@ class MessagesManager final : public Actor {
     MessageId being_updated_last_new_message_id;
     MessageId being_updated_last_database_message_id;
     MessageId being_deleted_message_id;
+    mutable MessageId last_sent_last_message_id;  // last_message_id, which was last sent to the app
 
     bool has_contact_registered_message = false;
 
@@ -1328,6 +1349,8 @@ class MessagesManager final : public Actor {
 
     mutable ListNode message_lru_list;
 
+    DialogUnloadListNode unload_list_node;  // node in unload_dialog_list_ while the dialog has unload timeout
+
     OrderedMessages ordered_messages;
 
     unique_ptr<DialogScheduledMessages> scheduled_messages;
@@ -1605,6 +1628,8 @@ class MessagesManager final : public Actor {
   static constexpr int32 MIN_READ_HISTORY_DELAY = 3;  // seconds
   static constexpr int32 MAX_SAVE_DIALOG_DELAY = 0;   // seconds
 
+  static constexpr int32 MIN_MESSAGE_INTERACTION_INFO_UPDATE_DELAY = 1;  // seconds
+
   static constexpr int32 DEFAULT_LOADED_EXPIRED_MESSAGES = 50;
 
   static constexpr int32 LIVE_LOCATION_VIEW_PERIOD = 60;      // seconds, server-side limit
@@ -1743,6 +1768,10 @@ class MessagesManager final : public Actor {
                                                     td_api::object_ptr<td_api::InputMessageReplyTo> &&reply_to,
                                                     bool for_draft);
 
+  static const MessageSendInfo &get_message_send_info(const Message *m);
+
+  static MessageSendInfo &get_message_send_info_mutable(Message *m);
+
   static const MessageInputReplyTo *get_message_input_reply_to(const Message *m);
 
   bool can_set_game_score(DialogId dialog_id, const Message *m) const;
@@ -1943,6 +1972,22 @@ class MessagesManager final : public Actor {
 
   void unload_dialog(DialogId dialog_id, int32 delay);
 
+  int64 get_loaded_message_count_max() const;
+
+  int64 get_loaded_message_memory_max() const;
+
+  static int32 get_message_memory_size(const Message *m);
+
+  void add_dialog_to_unload_list(Dialog *d);
+
+  static void remove_dialog_from_unload_list(Dialog *d);
+
+  void on_loaded_messages_changed(int32 count_diff, int64 memory_size_diff);
+
+  bool is_loaded_message_limit_exceeded() const;
+
+  void unload_least_recently_used_dialogs();
+
   void clear_dialog_message_list(Dialog *d, bool remove_from_dialog_list, int32 last_message_date);
 
   void delete_all_dialog_messages(Dialog *d, bool remove_from_dialog_list, bool is_permanently_deleted);
@@ -1993,9 +2038,12 @@ class MessagesManager final : public Actor {
 
   void on_pending_message_views_timeout(DialogId dialog_id);
 
+  void on_pending_message_interaction_info_update_timeout(DialogId dialog_id);
+
   void update_message_interaction_info(MessageFullId message_full_id, int32 view_count, int32 forward_count,
                                        bool has_reply_info, tl_object_ptr<telegram_api::messageReplies> &&reply_info,
-                                       bool has_reactions, unique_ptr<MessageReactions> &&reactions);
+                                       bool has_reactions, unique_ptr<MessageReactions> &&reactions,
+                                       bool is_from_update);
 
   bool is_thread_message(DialogId dialog_id, const Message *m) const;
 
@@ -2024,7 +2072,8 @@ class MessagesManager final : public Actor {
 
   bool update_message_interaction_info(Dialog *d, Message *m, int32 view_count, int32 forward_count,
                                        bool has_reply_info, MessageReplyInfo &&reply_info, bool has_reactions,
-                                       unique_ptr<MessageReactions> &&reactions, const char *source);
+                                       unique_ptr<MessageReactions> &&reactions, bool need_delay_update,
+                                       const char *source);
 
   bool update_message_fact_check(const Dialog *d, Message *m, unique_ptr<FactCheck> &&fact_check, bool need_save);
 
@@ -2973,6 +3022,10 @@ class MessagesManager final : public Actor {
                                  tl_object_ptr<telegram_api::InputChannel> &&input_channel, bool is_old,
                                  const char *source);
 
+  static bool is_get_channel_difference_prioritized(const Dialog *d);
+
+  void prioritize_pending_get_channel_difference(DialogId dialog_id);
+
   void process_pending_get_channel_differences();
 
   void process_get_channel_difference_updates(DialogId dialog_id, int32 new_pts,
@@ -2990,6 +3043,9 @@ class MessagesManager final : public Actor {
 
   static void on_pending_message_views_timeout_callback(void *messages_manager_ptr, int64 dialog_id_int);
 
+  static void on_pending_message_interaction_info_update_timeout_callback(void *messages_manager_ptr,
+                                                                          int64 dialog_id_int);
+
   static void on_pending_message_live_location_view_timeout_callback(void *messages_manager_ptr, int64 task_id);
 
   static void on_pending_draft_message_timeout_callback(void *messages_manager_ptr, int64 dialog_id_int);
@@ -3239,6 +3295,11 @@ class MessagesManager final : public Actor {
   bool running_get_difference_ = false;  // true after before_get_difference and false after after_get_difference
 
   WaitFreeHashMap<DialogId, unique_ptr<Dialog>, DialogIdHash> dialogs_;
+
+  ListNode unload_dialog_list_;  // dialogs with unload timeout, from the least recently used
+  int64 loaded_message_count_ = 0;
+  int64 loaded_message_memory_size_ = 0;
+  bool is_unload_least_recently_used_dialogs_scheduled_ = false;
   int64 added_message_count_ = 0;
 
   FlatHashSet<DialogId, DialogIdHash> loaded_dialogs_;  // dialogs loaded from database, but not added to dialogs_
@@ -3306,7 +3367,9 @@ class MessagesManager final : public Actor {
         , source_(source) {
     }
   };
-  std::queue<unique_ptr<PendingGetChannelDifference>> pending_get_channel_differences_;
+  std::deque<unique_ptr<PendingGetChannelDifference>> pending_get_channel_differences_;
+  // requests for opened chats and chats with unread mentions, which are sent before all other requests
+  std::deque<unique_ptr<PendingGetChannelDifference>> prioritized_pending_get_channel_differences_;
   int32 get_channel_difference_count_ = 0;
 
   FlatHashMap<DialogId, string, DialogIdHash> active_get_channel_differences_;
@@ -3320,6 +3383,7 @@ class MessagesManager final : public Actor {
   MultiTimeout channel_get_difference_timeout_{"ChannelGetDifferenceTimeout"};
   MultiTimeout channel_get_difference_retry_timeout_{"ChannelGetDifferenceRetryTimeout"};
   MultiTimeout pending_message_views_timeout_{"PendingMessageViewsTimeout"};
+  MultiTimeout pending_message_interaction_info_update_timeout_{"PendingMessageInteractionInfoUpdateTimeout"};
   MultiTimeout pending_message_live_location_view_timeout_{"PendingMessageLiveLocationViewTimeout"};
   MultiTimeout pending_draft_message_timeout_{"PendingDraftMessageTimeout"};
   MultiTimeout pending_read_history_timeout_{"PendingReadHistoryTimeout"};
@@ -3453,6 +3517,9 @@ class MessagesManager final : public Actor {
   };
   FlatHashMap<DialogId, PendingMessageView, DialogIdHash> pending_message_views_;
 
+  // messages with changed interaction info, for which updateMessageInteractionInfo wasn't sent and which weren't saved
+  FlatHashMap<DialogId, FlatHashSet<MessageId, MessageIdHash>, DialogIdHash> pending_message_interaction_info_updates_;
+
   FlatHashMap<DialogId, std::unordered_map<int64, LogEventIdWithGeneration, Hash<int64>>, DialogIdHash>
       read_history_log_event_ids_;
 
@@ -17,6 +17,7 @@
 #include "td/telegram/files/FileManager.h"
 #include "td/telegram/Global.h"
 #include "td/telegram/logevent/LogEvent.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessagesManager.h"
 #include "td/telegram/misc.h"
 #include "td/telegram/net/ConnectionCreator.h"
@@ -168,6 +169,10 @@ bool NotificationManager::is_disabled() const {
   return G()->close_flag() || !td_->auth_manager_->is_authorized() || td_->auth_manager_->is_bot();
 }
 
+bool NotificationManager::are_notifications_enabled() const {
+  return max_notification_group_count_ != 0 && !is_disabled();
+}
+
 StringBuilder &operator<<(StringBuilder &string_builder, const NotificationManager::ActiveNotificationsUpdate &update) {
   if (update.update == nullptr) {
     return string_builder << "null";
@@ -4199,6 +4204,19 @@ void NotificationManager::after_get_chat_difference_impl(NotificationGroupId gro
   }
 }
 
+void NotificationManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  size_t notification_count = 0;
+  for (auto &group : groups_) {
+    notification_count += group.second.notifications.size() + group.second.pending_notifications.size();
+  }
+  statistics.add("NotificationManager", "groups", groups_.size(), sizeof(NotificationGroups::value_type));
+  statistics.add("NotificationManager", "notifications", notification_count, sizeof(Notification));
+  statistics.add("NotificationManager", "group_keys", group_keys_.size(),
+                 sizeof(NotificationGroupId) + sizeof(NotificationGroupKey));
+  statistics.add("NotificationManager", "temporary_notifications", temporary_notifications_.size(),
+                 sizeof(NotificationObjectFullId) + sizeof(TemporaryNotification));
+}
+
 void NotificationManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   if (is_disabled() || max_notification_group_count_ == 0 || is_destroyed_) {
     return;
@@ -44,6 +44,7 @@ extern int VERBOSITY_NAME(notifications);
 
 struct BinlogEvent;
 class JsonObject;
+class MemoryStatistics;
 class Td;
 
 class NotificationManager final : public Actor {
@@ -57,6 +58,9 @@ class NotificationManager final : public Actor {
 
   void init();
 
+  // returns false if notifications aren't shown at all, for example, if notification_group_count_max == 0
+  bool are_notifications_enabled() const;
+
   size_t get_max_notification_group_size() const;
 
   NotificationId get_max_notification_id() const;
@@ -129,6 +133,8 @@ class NotificationManager final : public Actor {
 
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   void flush_all_notifications();
 
   void destroy_all_notifications();
@@ -14,10 +14,12 @@
 #include "td/telegram/ConfigManager.h"
 #include "td/telegram/CountryInfoManager.h"
 #include "td/telegram/DialogId.h"
+#include "td/telegram/files/FileManager.h"
 #include "td/telegram/GitCommitHash.h"
 #include "td/telegram/Global.h"
 #include "td/telegram/JsonValue.h"
 #include "td/telegram/LanguagePackManager.h"
+#include "td/telegram/net/ConnectionCreator.h"
 #include "td/telegram/net/MtprotoHeader.h"
 #include "td/telegram/net/NetQueryDispatcher.h"
 #include "td/telegram/NotificationManager.h"
@@ -152,6 +154,10 @@ OptionManager::OptionManager(Td *td)
   set_default_integer_option("pinned_story_count_max", 3);
   set_default_integer_option("fact_check_length_max", 1024);
 
+  for (auto &option : options.get_all()) {
+    update_cached_option(option.first, option.second);
+  }
+
   if (options.isset("my_phone_number") || !options.isset("my_id")) {
     update_premium_options();
   }
@@ -252,7 +258,50 @@ bool OptionManager::have_option(Slice name) const {
   return options_->isset(name.str());
 }
 
+int32 OptionManager::get_cached_option_id(Slice name) {
+  static const Slice cached_option_names[CACHED_OPTION_COUNT] = {
+      "authorization_date", "is_premium", "my_id", "prefer_ipv6", "session_count", "use_quick_ack", "utc_time_offset"};
+  for (size_t i = 0; i < CACHED_OPTION_COUNT; i++) {
+    if (cached_option_names[i] == name) {
+      return static_cast<int32>(i);
+    }
+  }
+  return -1;
+}
+
+void OptionManager::update_cached_option(Slice name, Slice value) {
+  auto cached_option_id = get_cached_option_id(name);
+  if (cached_option_id < 0) {
+    return;
+  }
+  auto &cached_option = cached_options_[cached_option_id];
+  auto type = CachedOptionType::Other;
+  if (value.empty()) {
+    type = CachedOptionType::Empty;
+  } else if (value == "Btrue" || value == "Bfalse") {
+    type = CachedOptionType::Boolean;
+    cached_option.value_.store(value == "Btrue" ? 1 : 0, std::memory_order_relaxed);
+  } else if (value[0] == 'I') {
+    type = CachedOptionType::Integer;
+    cached_option.value_.store(to_integer<int64>(value.substr(1)), std::memory_order_relaxed);
+  }
+  // the value must be stored before the type, so readers that see the new type see the new value too
+  cached_option.type_.store(static_cast<int32>(type), std::memory_order_release);
+}
+
 bool OptionManager::get_option_boolean(Slice name, bool default_value) const {
+  auto cached_option_id = get_cached_option_id(name);
+  if (cached_option_id >= 0) {
+    const auto &cached_option = cached_options_[cached_option_id];
+    auto type = static_cast<CachedOptionType>(cached_option.type_.load(std::memory_order_acquire));
+    if (type == CachedOptionType::Empty) {
+      return default_value;
+    }
+    if (type == CachedOptionType::Boolean) {
+      return cached_option.value_.load(std::memory_order_relaxed) != 0;
+    }
+  }
+
   auto value = get_option(name);
   if (value.empty()) {
     return default_value;
@@ -268,6 +317,18 @@ bool OptionManager::get_option_boolean(Slice name, bool default_value) const {
 }
 
 int64 OptionManager::get_option_integer(Slice name, int64 default_value) const {
+  auto cached_option_id = get_cached_option_id(name);
+  if (cached_option_id >= 0) {
+    const auto &cached_option = cached_options_[cached_option_id];
+    auto type = static_cast<CachedOptionType>(cached_option.type_.load(std::memory_order_acquire));
+    if (type == CachedOptionType::Empty) {
+      return default_value;
+    }
+    if (type == CachedOptionType::Integer) {
+      return cached_option.value_.load(std::memory_order_relaxed);
+    }
+  }
+
   auto value = get_option(name);
   if (value.empty()) {
     return default_value;
@@ -305,6 +366,7 @@ void OptionManager::set_option(Slice name, Slice value) {
     }
     option_pmc_->set(name.str(), value.str());
   }
+  update_cached_option(name, value);
 
   if (!G()->close_flag() && is_td_inited_) {
     on_option_updated(name);
@@ -524,6 +586,9 @@ void OptionManager::on_option_updated(Slice name) {
       if (name == "dismiss_birthday_contact_today") {
         send_closure(td_->user_manager_actor_, &UserManager::reload_contact_birthdates, true);
       }
+      if (name == "download_bandwidth_limit") {
+        send_closure(td_->file_manager_actor_, &FileManager::on_bandwidth_limits_changed);
+      }
       break;
     case 'e':
       if (name == "emoji_sounds") {
@@ -604,6 +669,11 @@ void OptionManager::on_option_updated(Slice name) {
         send_closure(td_->notification_manager_actor_, &NotificationManager::on_online_cloud_timeout_changed);
       }
       break;
+    case 'p':
+      if (name == "prewarmed_media_connection_count") {
+        send_closure(G()->connection_creator(), &ConnectionCreator::update_prewarmed_media_connection_count);
+      }
+      break;
     case 'r':
       if (name == "rating_e_decay") {
         send_closure(td_->top_dialog_manager_actor_, &TopDialogManager::update_rating_e_decay);
@@ -624,6 +694,9 @@ void OptionManager::on_option_updated(Slice name) {
       if (name == "use_pfs") {
         G()->net_query_dispatcher().update_use_pfs();
       }
+      if (name == "upload_bandwidth_limit") {
+        send_closure(td_->file_manager_actor_, &FileManager::on_bandwidth_limits_changed);
+      }
       if (name == "use_storage_optimizer") {
         send_closure(td_->storage_manager_, &StorageManager::update_use_storage_optimizer);
       }
@@ -833,6 +906,12 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       if (!is_bot && set_boolean_option("disable_top_chats")) {
         return;
       }
+      if (set_integer_option("download_bandwidth_limit", 0, std::numeric_limits<int64>::max())) {
+        return;
+      }
+      if (set_integer_option("download_write_behind_size_threshold", 0, std::numeric_limits<int64>::max())) {
+        return;
+      }
       if (name == "drop_notification_ids") {
         G()->td_db()->get_binlog_pmc()->erase("notification_id_current");
         G()->td_db()->get_binlog_pmc()->erase("notification_group_id_current");
@@ -891,6 +970,12 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       if (!is_bot && set_string_option("localization_target", LanguagePackManager::check_language_pack_name)) {
         return;
       }
+      if (set_integer_option("loaded_message_count_max", 0, 1000000000)) {
+        return;
+      }
+      if (set_integer_option("loaded_message_memory_max", 0, std::numeric_limits<int64>::max())) {
+        return;
+      }
       break;
     case 'm':
       if (set_integer_option("message_unload_delay", 60, 86400)) {
@@ -925,6 +1010,9 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       }
       break;
     case 'p':
+      if (set_integer_option("prewarmed_media_connection_count", 0, 8)) {
+        return;
+      }
       if (set_boolean_option("prefer_ipv6")) {
         send_closure(td_->state_manager_, &StateManager::on_network_updated);
         return;
@@ -940,6 +1028,9 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       }
       break;
     case 's':
+      if (set_string_option("shared_file_cache_directory", [](Slice value) { return true; })) {
+        return;
+      }
       if (set_integer_option("storage_max_files_size")) {
         return;
       }
@@ -962,6 +1053,9 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       }
       break;
     case 'u':
+      if (set_integer_option("upload_bandwidth_limit", 0, std::numeric_limits<int64>::max())) {
+        return;
+      }
       if (set_boolean_option("use_pfs")) {
         return;
       }
@@ -971,6 +1065,9 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       if (set_boolean_option("use_storage_optimizer")) {
         return;
       }
+      if (set_integer_option("user_status_update_delay", 0, 60)) {
+        return;
+      }
       if (set_integer_option("utc_time_offset", -12 * 60 * 60, 14 * 60 * 60)) {
         return;
       }
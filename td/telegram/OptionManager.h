@@ -12,6 +12,7 @@
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <utility>
@@ -84,6 +85,19 @@ class OptionManager {
 
   void send_unix_time_update();
 
+  static int32 get_cached_option_id(Slice name);
+
+  void update_cached_option(Slice name, Slice value);
+
+  // the most frequently used options are also cached in a parsed form and can be read without locking
+  static constexpr size_t CACHED_OPTION_COUNT = 7;
+  enum class CachedOptionType : int32 { Empty, Boolean, Integer, Other };
+  struct CachedOption {
+    std::atomic<int32> type_{static_cast<int32>(CachedOptionType::Empty)};
+    std::atomic<int64> value_{0};
+  };
+  std::array<CachedOption, CACHED_OPTION_COUNT> cached_options_;
+
   Td *td_;
   bool is_td_inited_ = false;
   vector<std::pair<string, Promise<td_api::object_ptr<td_api::OptionValue>>>> pending_get_options_;
@@ -152,15 +152,50 @@ tl_object_ptr<telegram_api::InputCheckPasswordSRP> PasswordManager::get_input_ch
                                   state.current_srp_p, state.current_srp_B, state.current_srp_id);
 }
 
+// key derivation takes hundreds of milliseconds, so it is done on the crypto scheduler to not block other actors;
+// the promise is set on the scheduler of the actor actor_ref
+template <class T, class FunctionT>
+static void run_on_crypto_scheduler(ActorRef actor_ref, FunctionT &&function, Promise<T> &&promise) {
+  Scheduler::instance()->run_on_scheduler(
+      G()->get_crypto_scheduler_id(),
+      PromiseCreator::lambda([actor_ref = std::move(actor_ref), function = std::forward<FunctionT>(function),
+                              promise = std::move(promise)](Unit) mutable {
+        Result<T> result = function();
+        send_lambda(actor_ref, [result = std::move(result), promise = std::move(promise)]() mutable {
+          promise.set_result(std::move(result));
+        });
+      }));
+}
+
+void PasswordManager::get_input_check_password_async(
+    string password, string client_salt, string server_salt, int32 g, string p, string B, int64 id,
+    ActorRef actor_ref, Promise<tl_object_ptr<telegram_api::InputCheckPasswordSRP>> &&promise) {
+  run_on_crypto_scheduler(
+      std::move(actor_ref),
+      [password = std::move(password), client_salt = std::move(client_salt), server_salt = std::move(server_salt), g,
+       p = std::move(p), B = std::move(B), id] {
+        return get_input_check_password(password, client_salt, server_salt, g, p, B, id);
+      },
+      std::move(promise));
+}
+
+void PasswordManager::get_input_check_password_async(
+    string password, const PasswordState &state, ActorRef actor_ref,
+    Promise<tl_object_ptr<telegram_api::InputCheckPasswordSRP>> &&promise) {
+  get_input_check_password_async(std::move(password), state.current_client_salt, state.current_server_salt,
+                                 state.current_srp_g, state.current_srp_p, state.current_srp_B, state.current_srp_id,
+                                 std::move(actor_ref), std::move(promise));
+}
+
 void PasswordManager::get_input_check_password_srp(
     string password, Promise<tl_object_ptr<telegram_api::InputCheckPasswordSRP>> &&promise) {
-  do_get_state(PromiseCreator::lambda(
-      [promise = std::move(promise), password = std::move(password)](Result<PasswordState> r_state) mutable {
-        if (r_state.is_error()) {
-          return promise.set_error(r_state.move_as_error());
-        }
-        promise.set_value(PasswordManager::get_input_check_password(password, r_state.move_as_ok()));
-      }));
+  do_get_state(PromiseCreator::lambda([actor_id = actor_id(this), promise = std::move(promise),
+                                       password = std::move(password)](Result<PasswordState> r_state) mutable {
+    if (r_state.is_error()) {
+      return promise.set_error(r_state.move_as_error());
+    }
+    get_input_check_password_async(std::move(password), r_state.ok(), actor_id, std::move(promise));
+  }));
 }
 
 void PasswordManager::set_password(string current_password, string new_password, string new_hint,
@@ -320,7 +355,20 @@ void PasswordManager::drop_temp_password() {
 
 void PasswordManager::do_create_temp_password(string password, int32 timeout, PasswordState &&password_state,
                                               Promise<TempPasswordState> promise) {
-  auto hash = get_input_check_password(password, password_state);
+  get_input_check_password_async(
+      std::move(password), password_state, actor_id(this),
+      PromiseCreator::lambda([actor_id = actor_id(this), timeout, promise = std::move(promise)](
+                                 Result<tl_object_ptr<telegram_api::InputCheckPasswordSRP>> r_hash) mutable {
+        if (r_hash.is_error()) {
+          return promise.set_error(r_hash.move_as_error());
+        }
+        send_closure(actor_id, &PasswordManager::send_get_tmp_password_query, r_hash.move_as_ok(), timeout,
+                     std::move(promise));
+      }));
+}
+
+void PasswordManager::send_get_tmp_password_query(tl_object_ptr<telegram_api::InputCheckPasswordSRP> &&hash,
+                                                  int32 timeout, Promise<TempPasswordState> promise) {
   send_with_promise(G()->net_query_creator().create(telegram_api::account_getTmpPassword(std::move(hash), timeout)),
                     PromiseCreator::lambda([promise = std::move(promise)](Result<NetQueryPtr> r_query) mutable {
                       auto r_result = fetch_result<telegram_api::account_getTmpPassword>(std::move(r_query));
@@ -399,29 +447,51 @@ void PasswordManager::do_get_full_state(string password, PasswordState state, Pr
     return promise.set_value(std::move(result));
   }
 
-  auto hash = get_input_check_password(password, state);
-  send_with_promise(G()->net_query_creator().create(telegram_api::account_getPasswordSettings(std::move(hash))),
-                    PromiseCreator::lambda([promise = std::move(promise), state = std::move(state),
-                                            password](Result<NetQueryPtr> r_query) mutable {
-                      promise.set_result([&]() -> Result<PasswordFullState> {
-                        TRY_RESULT(result, fetch_result<telegram_api::account_getPasswordSettings>(std::move(r_query)));
-                        LOG(INFO) << "Receive password settings: " << to_string(result);
-                        PasswordPrivateState private_state;
-                        private_state.email = std::move(result->email_);
-
-                        if (result->secure_settings_ != nullptr) {
-                          auto r_secret =
-                              decrypt_secure_secret(password, std::move(result->secure_settings_->secure_algo_),
-                                                    result->secure_settings_->secure_secret_.as_slice(),
-                                                    result->secure_settings_->secure_secret_id_);
-                          if (r_secret.is_ok()) {
-                            private_state.secret = r_secret.move_as_ok();
-                          }
-                        }
+  get_input_check_password_async(
+      password, state, actor_id(this),
+      PromiseCreator::lambda([actor_id = actor_id(this), password, state, promise = std::move(promise)](
+                                 Result<tl_object_ptr<telegram_api::InputCheckPasswordSRP>> r_hash) mutable {
+        if (r_hash.is_error()) {
+          return promise.set_error(r_hash.move_as_error());
+        }
+        send_closure(actor_id, &PasswordManager::send_get_password_settings_query, std::move(password),
+                     std::move(state), r_hash.move_as_ok(), std::move(promise));
+      }));
+}
 
-                        return PasswordFullState{std::move(state), std::move(private_state)};
-                      }());
-                    }));
+void PasswordManager::send_get_password_settings_query(string password, PasswordState state,
+                                                       tl_object_ptr<telegram_api::InputCheckPasswordSRP> &&hash,
+                                                       Promise<PasswordFullState> promise) {
+  send_with_promise(
+      G()->net_query_creator().create(telegram_api::account_getPasswordSettings(std::move(hash))),
+      PromiseCreator::lambda([actor_id = actor_id(this), promise = std::move(promise), state = std::move(state),
+                              password = std::move(password)](Result<NetQueryPtr> r_query) mutable {
+        auto r_result = fetch_result<telegram_api::account_getPasswordSettings>(std::move(r_query));
+        if (r_result.is_error()) {
+          return promise.set_error(r_result.move_as_error());
+        }
+        auto result = r_result.move_as_ok();
+        LOG(INFO) << "Receive password settings: " << to_string(result);
+        run_on_crypto_scheduler(
+            actor_id,
+            [password = std::move(password), state = std::move(state),
+             result = std::move(result)]() mutable -> Result<PasswordFullState> {
+              PasswordPrivateState private_state;
+              private_state.email = std::move(result->email_);
+
+              if (result->secure_settings_ != nullptr) {
+                auto r_secret = decrypt_secure_secret(password, std::move(result->secure_settings_->secure_algo_),
+                                                      result->secure_settings_->secure_secret_.as_slice(),
+                                                      result->secure_settings_->secure_secret_id_);
+                if (r_secret.is_ok()) {
+                  private_state.secret = r_secret.move_as_ok();
+                }
+              }
+
+              return PasswordFullState{std::move(state), std::move(private_state)};
+            },
+            std::move(promise));
+      }));
 }
 
 void PasswordManager::get_recovery_email_address(string password,
@@ -244,6 +244,9 @@ PollManager::PollManager(Td *td, ActorShared<> parent) : td_(td), parent_(std::m
 
   unload_poll_timeout_.set_callback(on_unload_poll_timeout_callback);
   unload_poll_timeout_.set_callback_data(static_cast<void *>(this));
+
+  notify_poll_update_timeout_.set_callback(on_notify_poll_update_timeout_callback);
+  notify_poll_update_timeout_.set_callback_data(static_cast<void *>(this));
 }
 
 void PollManager::start_up() {
@@ -305,6 +308,16 @@ void PollManager::on_unload_poll_timeout_callback(void *poll_manager_ptr, int64
   send_closure_later(poll_manager->actor_id(poll_manager), &PollManager::on_unload_poll_timeout, PollId(poll_id_int));
 }
 
+void PollManager::on_notify_poll_update_timeout_callback(void *poll_manager_ptr, int64 poll_id_int) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  auto poll_manager = static_cast<PollManager *>(poll_manager_ptr);
+  send_closure_later(poll_manager->actor_id(poll_manager), &PollManager::on_notify_poll_update_timeout,
+                     PollId(poll_id_int));
+}
+
 bool PollManager::is_local_poll_id(PollId poll_id) {
   return poll_id.get() < 0 && poll_id.get() > std::numeric_limits<int32>::min();
 }
@@ -765,7 +778,8 @@ bool PollManager::can_unload_poll(PollId poll_id) {
   }
   if (is_local_poll_id(poll_id) || server_poll_messages_.count(poll_id) != 0 ||
       other_poll_messages_.count(poll_id) != 0 || reply_poll_counts_.count(poll_id) != 0 ||
-      pending_answers_.count(poll_id) != 0 || being_closed_polls_.count(poll_id) != 0) {
+      pending_answers_.count(poll_id) != 0 || being_closed_polls_.count(poll_id) != 0 ||
+      pending_poll_updates_.count(poll_id) != 0) {
     return false;
   }
 
@@ -1415,6 +1429,23 @@ void PollManager::on_close_poll_timeout(PollId poll_id) {
   }
 }
 
+void PollManager::on_notify_poll_update_timeout(PollId poll_id) {
+  if (G()->close_flag()) {
+    return;
+  }
+  if (pending_poll_updates_.erase(poll_id) == 0) {
+    return;
+  }
+
+  auto poll = get_poll(poll_id);
+  CHECK(poll != nullptr);
+  LOG(INFO) << "Send delayed update of " << poll_id;
+  save_poll(poll, poll_id);
+  notify_on_poll_update(poll_id);
+  notify_poll_update_timeout_.add_timeout_in(poll_id.get(), NOTIFY_POLL_UPDATE_DELAY);
+  schedule_poll_unload(poll_id);
+}
+
 void PollManager::on_unload_poll_timeout(PollId poll_id) {
   if (G()->close_flag()) {
     return;
@@ -1441,6 +1472,7 @@ void PollManager::on_unload_poll_timeout(PollId poll_id) {
 
   update_poll_timeout_.cancel_timeout(poll_id.get(), "on_unload_poll_timeout");
   close_poll_timeout_.cancel_timeout(poll_id.get());
+  notify_poll_update_timeout_.cancel_timeout(poll_id.get());
 
   auto is_deleted = polls_.erase(poll_id) > 0;
   CHECK(is_deleted);
@@ -1888,6 +1920,18 @@ PollId PollManager::on_get_poll(PollId poll_id, tl_object_ptr<telegram_api::poll
     LOG(INFO) << "Schedule updating of " << poll_id << " in " << timeout;
     update_poll_timeout_.set_timeout_in(poll_id.get(), timeout);
   }
+  if (is_changed && !is_bot) {
+    // results of popular polls can change many times per second, so the changes are applied immediately,
+    // but the poll is saved and the messages are updated at most once per NOTIFY_POLL_UPDATE_DELAY
+    if (notify_poll_update_timeout_.has_timeout(poll_id.get())) {
+      LOG(INFO) << "Delay update of " << poll_id;
+      pending_poll_updates_.insert(poll_id);
+      is_changed = false;
+      need_save_to_database = false;
+    } else {
+      notify_poll_update_timeout_.add_timeout_in(poll_id.get(), NOTIFY_POLL_UPDATE_DELAY);
+    }
+  }
   if (is_changed || need_save_to_database) {
     save_poll(poll, poll_id);
   }
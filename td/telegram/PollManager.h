@@ -146,6 +146,7 @@ class PollManager final : public Actor {
 
   static constexpr int32 MAX_GET_POLL_VOTERS = 50;  // server side limit
   static constexpr int32 UNLOAD_POLL_DELAY = 600;   // some reasonable value
+  static constexpr int32 NOTIFY_POLL_UPDATE_DELAY = 1;
 
   class SetPollAnswerLogEvent;
   class StopPollLogEvent;
@@ -159,6 +160,8 @@ class PollManager final : public Actor {
 
   static void on_unload_poll_timeout_callback(void *poll_manager_ptr, int64 poll_id_int);
 
+  static void on_notify_poll_update_timeout_callback(void *poll_manager_ptr, int64 poll_id_int);
+
   static void remove_unallowed_entities(FormattedText &text);
 
   static td_api::object_ptr<td_api::pollOption> get_poll_option_object(const PollOption &poll_option);
@@ -197,6 +200,8 @@ class PollManager final : public Actor {
 
   void on_unload_poll_timeout(PollId poll_id);
 
+  void on_notify_poll_update_timeout(PollId poll_id);
+
   void on_online();
 
   Poll *get_poll_force(PollId poll_id);
@@ -235,6 +240,7 @@ class PollManager final : public Actor {
   MultiTimeout update_poll_timeout_{"UpdatePollTimeout"};
   MultiTimeout close_poll_timeout_{"ClosePollTimeout"};
   MultiTimeout unload_poll_timeout_{"UnloadPollTimeout"};
+  MultiTimeout notify_poll_update_timeout_{"NotifyPollUpdateTimeout"};
 
   WaitFreeHashMap<PollId, unique_ptr<Poll>, PollIdHash> polls_;
 
@@ -263,6 +269,8 @@ class PollManager final : public Actor {
 
   FlatHashSet<PollId, PollIdHash> being_closed_polls_;
 
+  FlatHashSet<PollId, PollIdHash> pending_poll_updates_;
+
   Td *td_;
   ActorShared<> parent_;
 };
@@ -7,6 +7,7 @@
 #include "td/telegram/QueryMerger.h"
 
 #include "td/utils/logging.h"
+#include "td/utils/Time.h"
 
 namespace td {
 
@@ -24,6 +25,9 @@ void QueryMerger::add_query(int64 query_id, Promise<Unit> &&promise, const char
     // duplicate query, just wait
     return;
   }
+  if (pending_queries_.empty()) {
+    first_pending_query_at_ = Time::now();
+  }
   pending_queries_.push(query_id);
   loop();
 }
@@ -55,11 +59,23 @@ void QueryMerger::on_get_query_result(vector<int64> query_ids, Result<Unit> &&re
   loop();
 }
 
+void QueryMerger::timeout_expired() {
+  loop();
+}
+
 void QueryMerger::loop() {
   if (query_count_ == max_concurrent_query_count_) {
     return;
   }
 
+  if (merge_delay_ > 0.0 && !pending_queries_.empty() && pending_queries_.size() < max_merged_query_count_) {
+    auto send_at = first_pending_query_at_ + merge_delay_;
+    if (send_at > Time::now()) {
+      set_timeout_at(send_at);
+      return;
+    }
+  }
+
   vector<int64> query_ids;
   while (!pending_queries_.empty()) {
     auto query_id = pending_queries_.front();
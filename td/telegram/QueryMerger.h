@@ -29,6 +29,11 @@ class QueryMerger final : public Actor {
     merge_function_ = std::move(merge_function);
   }
 
+  // not full requests are sent only after the first pending query waits for the specified time
+  void set_merge_delay(double merge_delay) {
+    merge_delay_ = merge_delay;
+  }
+
   void add_query(int64 query_id, Promise<Unit> &&promise, const char *source);
 
  private:
@@ -39,6 +44,8 @@ class QueryMerger final : public Actor {
   size_t query_count_ = 0;
   size_t max_concurrent_query_count_;
   size_t max_merged_query_count_;
+  double merge_delay_ = 0.0;
+  double first_pending_query_at_ = 0.0;
 
   MergeFunction merge_function_;
   std::queue<int64> pending_queries_;
@@ -48,6 +55,8 @@ class QueryMerger final : public Actor {
 
   void on_get_query_result(vector<int64> query_ids, Result<Unit> &&result);
 
+  void timeout_expired() final;
+
   void loop() final;
 };
 
@@ -17,6 +17,9 @@
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/utf8.h"
 
+#include <mutex>
+#include <unordered_set>
+
 namespace td {
 
 static int64 get_custom_emoji_id(const string &reaction) {
@@ -32,7 +35,19 @@ static string get_custom_emoji_string(int64 custom_emoji_id) {
   return PSTRING() << '#' << base64_encode(Slice(s, 8));
 }
 
-ReactionType::ReactionType(string &&emoji) : reaction_(std::move(emoji)) {
+const string *ReactionType::get_interned_reaction(string &&reaction) {
+  if (reaction.empty()) {
+    return nullptr;
+  }
+
+  // the number of different reactions is small, so the strings are never deleted
+  static std::mutex reactions_mutex;
+  static auto *reactions = new std::unordered_set<string, Hash<string>>();
+  std::lock_guard<std::mutex> lock(reactions_mutex);
+  return &*reactions->insert(std::move(reaction)).first;
+}
+
+ReactionType::ReactionType(string &&emoji) : reaction_(get_interned_reaction(std::move(emoji))) {
 }
 
 ReactionType::ReactionType(const telegram_api::object_ptr<telegram_api::Reaction> &reaction) {
@@ -42,16 +57,19 @@ ReactionType::ReactionType(const telegram_api::object_ptr<telegram_api::Reaction
   switch (reaction->get_id()) {
     case telegram_api::reactionEmpty::ID:
       break;
-    case telegram_api::reactionEmoji::ID:
-      reaction_ = static_cast<const telegram_api::reactionEmoji *>(reaction.get())->emoticon_;
-      if (is_custom_reaction()) {
-        reaction_ = string();
+    case telegram_api::reactionEmoji::ID: {
+      const string &emoji = static_cast<const telegram_api::reactionEmoji *>(reaction.get())->emoticon_;
+      if (emoji[0] == '#') {
+        break;
       }
+      reaction_ = get_interned_reaction(string(emoji));
       break;
-    case telegram_api::reactionCustomEmoji::ID:
-      reaction_ =
-          get_custom_emoji_string(static_cast<const telegram_api::reactionCustomEmoji *>(reaction.get())->document_id_);
+    }
+    case telegram_api::reactionCustomEmoji::ID: {
+      auto custom_emoji_id = static_cast<const telegram_api::reactionCustomEmoji *>(reaction.get())->document_id_;
+      reaction_ = get_interned_reaction(get_custom_emoji_string(custom_emoji_id));
       break;
+    }
     default:
       UNREACHABLE();
       break;
@@ -68,17 +86,17 @@ ReactionType::ReactionType(const td_api::object_ptr<td_api::ReactionType> &type)
       if (!check_utf8(emoji)) {
         break;
       }
-      reaction_ = emoji;
-      if (is_custom_reaction()) {
-        reaction_ = string();
+      if (emoji[0] == '#') {
         break;
       }
+      reaction_ = get_interned_reaction(string(emoji));
       break;
     }
-    case td_api::reactionTypeCustomEmoji::ID:
-      reaction_ =
-          get_custom_emoji_string(static_cast<const td_api::reactionTypeCustomEmoji *>(type.get())->custom_emoji_id_);
+    case td_api::reactionTypeCustomEmoji::ID: {
+      auto custom_emoji_id = static_cast<const td_api::reactionTypeCustomEmoji *>(type.get())->custom_emoji_id_;
+      reaction_ = get_interned_reaction(get_custom_emoji_string(custom_emoji_id));
       break;
+    }
     default:
       UNREACHABLE();
       break;
@@ -112,9 +130,9 @@ telegram_api::object_ptr<telegram_api::Reaction> ReactionType::get_input_reactio
     return telegram_api::make_object<telegram_api::reactionEmpty>();
   }
   if (is_custom_reaction()) {
-    return telegram_api::make_object<telegram_api::reactionCustomEmoji>(get_custom_emoji_id(reaction_));
+    return telegram_api::make_object<telegram_api::reactionCustomEmoji>(get_custom_emoji_id(*reaction_));
   }
-  return telegram_api::make_object<telegram_api::reactionEmoji>(reaction_);
+  return telegram_api::make_object<telegram_api::reactionEmoji>(*reaction_);
 }
 
 td_api::object_ptr<td_api::ReactionType> ReactionType::get_reaction_type_object() const {
@@ -122,9 +140,9 @@ td_api::object_ptr<td_api::ReactionType> ReactionType::get_reaction_type_object(
     return nullptr;
   }
   if (is_custom_reaction()) {
-    return td_api::make_object<td_api::reactionTypeCustomEmoji>(get_custom_emoji_id(reaction_));
+    return td_api::make_object<td_api::reactionTypeCustomEmoji>(get_custom_emoji_id(*reaction_));
   }
-  return td_api::make_object<td_api::reactionTypeEmoji>(reaction_);
+  return td_api::make_object<td_api::reactionTypeEmoji>(*reaction_);
 }
 
 td_api::object_ptr<td_api::updateDefaultReactionType> ReactionType::get_update_default_reaction_type() const {
@@ -136,14 +154,19 @@ td_api::object_ptr<td_api::updateDefaultReactionType> ReactionType::get_update_d
 
 uint64 ReactionType::get_hash() const {
   if (is_custom_reaction()) {
-    return static_cast<uint64>(get_custom_emoji_id(reaction_));
+    return static_cast<uint64>(get_custom_emoji_id(*reaction_));
   } else {
-    return get_md5_string_hash(remove_emoji_selectors(reaction_));
+    return get_md5_string_hash(remove_emoji_selectors(get_string()));
   }
 }
 
+const string &ReactionType::get_string() const {
+  static const string empty_reaction;
+  return reaction_ == nullptr ? empty_reaction : *reaction_;
+}
+
 bool ReactionType::is_custom_reaction() const {
-  return reaction_[0] == '#';
+  return reaction_ != nullptr && (*reaction_)[0] == '#';
 }
 
 bool ReactionType::is_active_reaction(
@@ -152,7 +175,7 @@ bool ReactionType::is_active_reaction(
 }
 
 bool operator<(const ReactionType &lhs, const ReactionType &rhs) {
-  return lhs.reaction_ < rhs.reaction_;
+  return lhs.get_string() < rhs.get_string();
 }
 
 bool operator==(const ReactionType &lhs, const ReactionType &rhs) {
@@ -164,9 +187,9 @@ StringBuilder &operator<<(StringBuilder &string_builder, const ReactionType &rea
     return string_builder << "empty reaction";
   }
   if (reaction_type.is_custom_reaction()) {
-    return string_builder << "custom reaction " << get_custom_emoji_id(reaction_type.reaction_);
+    return string_builder << "custom reaction " << get_custom_emoji_id(*reaction_type.reaction_);
   }
-  return string_builder << "reaction " << reaction_type.reaction_;
+  return string_builder << "reaction " << *reaction_type.reaction_;
 }
 
 int64 get_reaction_types_hash(const vector<ReactionType> &reaction_types) {
@@ -19,7 +19,10 @@ namespace td {
 struct ReactionTypeHash;
 
 class ReactionType {
-  string reaction_;
+  // strings of reactions are interned, so equal reactions share the same string in all Td instances
+  const string *reaction_ = nullptr;
+
+  static const string *get_interned_reaction(string &&reaction);
 
   friend bool operator<(const ReactionType &lhs, const ReactionType &rhs);
 
@@ -62,12 +65,10 @@ class ReactionType {
   bool is_active_reaction(const FlatHashMap<ReactionType, size_t, ReactionTypeHash> &active_reaction_pos) const;
 
   bool is_empty() const {
-    return reaction_.empty();
+    return reaction_ == nullptr;
   }
 
-  const string &get_string() const {
-    return reaction_;
-  }
+  const string &get_string() const;
 
   template <class StorerT>
   void store(StorerT &storer) const;
@@ -78,7 +79,7 @@ class ReactionType {
 
 struct ReactionTypeHash {
   uint32 operator()(const ReactionType &reaction_type) const {
-    return Hash<string>()(reaction_type.reaction_);
+    return Hash<const string *>()(reaction_type.reaction_);
   }
 };
 
@@ -16,12 +16,14 @@ namespace td {
 template <class StorerT>
 void ReactionType::store(StorerT &storer) const {
   CHECK(!is_empty());
-  td::store(reaction_, storer);
+  td::store(*reaction_, storer);
 }
 
 template <class ParserT>
 void ReactionType::parse(ParserT &parser) {
-  td::parse(reaction_, parser);
+  string reaction;
+  td::parse(reaction, parser);
+  reaction_ = get_interned_reaction(std::move(reaction));
 }
 
 }  // namespace td
@@ -762,6 +762,7 @@ telegram_api::object_ptr<telegram_api::inputEncryptedChat> SecretChatActor::get_
 }
 void SecretChatActor::tear_down() {
   LOG(INFO) << "SecretChatActor: tear_down";
+  sync_inbound_messages();
   // TODO notify send update that we are dead
 }
 
@@ -1329,13 +1330,37 @@ Status SecretChatActor::do_inbound_message_decrypted(unique_ptr<log_event::Inbou
   auto save_log_event_finish = PromiseCreator::join(std::move(save_changes_start), std::move(qts_promise));
   if (need_sync) {
     // TODO: lazy sync is enough
-    context_->binlog()->force_sync(std::move(save_log_event_finish), "do_inbound_message_decrypted");
+    add_inbound_sync_promise(std::move(save_log_event_finish));
   } else {
     save_log_event_finish.set_value(Unit());
   }
   return Status::OK();
 }
 
+void SecretChatActor::add_inbound_sync_promise(Promise<Unit> &&promise) {
+  inbound_sync_promises_.push_back(std::move(promise));
+  if (inbound_sync_promises_.size() == 1u) {
+    // all inbound messages, which are already in the mailbox, will be synced together
+    send_closure_later(actor_id(this), &SecretChatActor::sync_inbound_messages);
+  }
+}
+
+void SecretChatActor::sync_inbound_messages() {
+  if (inbound_sync_promises_.empty()) {
+    return;
+  }
+  LOG(INFO) << "Sync " << inbound_sync_promises_.size() << " inbound secret messages";
+  auto promise = PromiseCreator::lambda([promises = std::move(inbound_sync_promises_)](Result<Unit> result) mutable {
+    if (result.is_ok()) {
+      set_promises(promises);
+    } else {
+      fail_promises(promises, result.move_as_error());
+    }
+  });
+  inbound_sync_promises_.clear();
+  context_->binlog()->force_sync(std::move(promise), "sync_inbound_messages");
+}
+
 void SecretChatActor::on_save_changes_start(ChangesProcessor<StateChange>::Id save_changes_token) {
   if (close_flag_) {
     return;
@@ -566,6 +566,9 @@ class SecretChatActor final : public NetQueryCallback {
 
   std::map<int32, unique_ptr<log_event::InboundSecretMessage>> pending_inbound_messages_;
 
+  // promises waiting for binlog sync of inbound messages received in one batch
+  vector<Promise<Unit>> inbound_sync_promises_;
+
   Result<std::tuple<uint64, BufferSlice, int32>> decrypt(BufferSlice &encrypted_message);
 
   Status do_inbound_message_encrypted(unique_ptr<log_event::InboundSecretMessage> message);
@@ -574,6 +577,9 @@ class SecretChatActor final : public NetQueryCallback {
   Status do_inbound_message_decrypted(unique_ptr<log_event::InboundSecretMessage> message);
   void do_inbound_message_decrypted_pending(unique_ptr<log_event::InboundSecretMessage> message);
 
+  void add_inbound_sync_promise(Promise<Unit> &&promise);
+  void sync_inbound_messages();
+
   void on_inbound_save_message_finish(uint64 state_id);
   void on_inbound_save_changes_finish(uint64 state_id);
   void inbound_loop(InboundMessageState *state, uint64 state_id);
@@ -300,6 +300,7 @@ class MultiSequenceDispatcherImpl final : public MultiSequenceDispatcher {
     node.net_query_ref = node.net_query.get_weak();
     node.callback = std::move(callback);
     scheduler_.create_task(chain_ids, std::move(node));
+    on_task_count_changed(1);
     loop();
   }
 
@@ -318,6 +319,27 @@ class MultiSequenceDispatcherImpl final : public MultiSequenceDispatcher {
 
   using TaskId = ChainScheduler<Node>::TaskId;
 
+  size_t task_count_ = 0;
+  size_t max_logged_task_count_ = 0;
+
+  void on_task_count_changed(int diff) {
+    if (diff < 0) {
+      CHECK(task_count_ > 0);
+      task_count_--;
+      if (task_count_ == 0 && max_logged_task_count_ != 0) {
+        LOG(INFO) << "All queries in " << get_name() << " have finished";
+        max_logged_task_count_ = 0;
+      }
+      return;
+    }
+    task_count_++;
+    // log the queue depth each time it doubles since the queue became empty last time
+    if (task_count_ >= 16 && task_count_ >= 2 * max_logged_task_count_) {
+      LOG(INFO) << "Have " << task_count_ << " queries in " << get_name();
+      max_logged_task_count_ = task_count_;
+    }
+  }
+
   bool check_timeout(Node &node) {
     auto &net_query = node.net_query;
     if (net_query.empty() || net_query->is_ready()) {
@@ -384,6 +406,7 @@ class MultiSequenceDispatcherImpl final : public MultiSequenceDispatcher {
     if (node.callback.empty()) {
       auto query = std::move(node.net_query);
       scheduler_.finish_task(task_id);
+      on_task_count_changed(-1);
       send_closure_later(G()->td(), &Td::on_result, std::move(query));
       loop();
       return;
@@ -397,6 +420,7 @@ class MultiSequenceDispatcherImpl final : public MultiSequenceDispatcher {
     auto &node = *scheduler_.get_task_extra(task_id);
     if (r_query.is_error()) {
       scheduler_.finish_task(task_id);
+      on_task_count_changed(-1);
     } else {
       do_resend(task_id, node, r_query.move_as_ok());
     }
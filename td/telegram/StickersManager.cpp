@@ -23,6 +23,7 @@
 #include "td/telegram/LanguagePackManager.h"
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/logevent/LogEventHelper.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessagesManager.h"
 #include "td/telegram/misc.h"
 #include "td/telegram/net/DcId.h"
@@ -232,8 +233,10 @@ class GetEmojiKeywordsDifferenceQuery final : public Td::ResultHandler {
   }
 
   void send(const string &language_code, int32 version) {
-    send_query(
-        G()->net_query_creator().create(telegram_api::messages_getEmojiKeywordsDifference(language_code, version)));
+    auto query =
+        G()->net_query_creator().create(telegram_api::messages_getEmojiKeywordsDifference(language_code, version));
+    query->set_priority(NetQuery::BACKGROUND_PRIORITY);
+    send_query(std::move(query));
   }
 
   void on_result(BufferSlice packet) final {
@@ -748,6 +751,8 @@ class GetStickerSetQuery final : public Td::ResultHandler {
           set->set_->id_ = StickersManager::GREAT_MINDS_SET_ID;
           set->set_->short_name_ = std::move(great_minds_name);
         }
+      } else {
+        StickersManager::add_shared_sticker_set(set->set_->id_, set->set_->hash_, packet.as_slice());
       }
     }
 
@@ -1694,6 +1699,20 @@ StickersManager::StickersManager(Td *td, ActorShared<> parent) : td_(td), parent
 
   next_click_animated_emoji_message_time_ = Time::now();
   next_update_animated_emoji_clicked_time_ = Time::now();
+
+  reload_custom_emoji_queries_.set_merge_delay(RELOAD_CUSTOM_EMOJI_MERGE_DELAY);
+  reload_custom_emoji_queries_.set_merge_function([this](vector<int64> query_ids, Promise<Unit> &&promise) {
+    TRY_STATUS_PROMISE(promise, G()->close_status());
+    auto custom_emoji_ids = transform(query_ids, [](int64 query_id) { return CustomEmojiId(query_id); });
+    auto query_promise = PromiseCreator::lambda(
+        [actor_id = actor_id(this), promise = std::move(promise)](
+            Result<vector<telegram_api::object_ptr<telegram_api::Document>>> r_documents) mutable {
+          send_closure(actor_id, &StickersManager::on_get_custom_emoji_documents, std::move(r_documents),
+                       vector<CustomEmojiId>(), Promise<td_api::object_ptr<td_api::stickers>>());
+          promise.set_value(Unit());
+        });
+    td_->create_handler<GetCustomEmojiDocumentsQuery>(std::move(query_promise))->send(std::move(custom_emoji_ids));
+  });
 }
 
 StickersManager::~StickersManager() {
@@ -3943,6 +3962,7 @@ StickerSetId StickersManager::on_get_messages_sticker_set(StickerSetId sticker_s
     s->sticker_emojis_map_.clear();
     s->keyword_stickers_map_.clear();
     s->sticker_keywords_map_.clear();
+    invalidate_installed_keyword_stickers_index(s);
     for (auto &pack : set->packs_) {
       auto cleaned_emoji = remove_emoji_modifiers(pack->emoticon_);
       if (cleaned_emoji.empty()) {
@@ -4180,8 +4200,56 @@ const std::map<string, vector<FileId>> &StickersManager::get_sticker_set_keyword
   return sticker_set->keyword_stickers_map_;
 }
 
+void StickersManager::invalidate_installed_keyword_stickers_index(const StickerSet *sticker_set) {
+  auto &index = installed_keyword_stickers_index_[static_cast<int32>(sticker_set->sticker_type_)];
+  if (index.is_valid_ && sticker_set->is_installed_ && !sticker_set->is_archived_) {
+    index = KeywordStickersIndex();
+  }
+}
+
+bool StickersManager::is_keyword_stickers_indexed(const StickerSet *sticker_set) const {
+  const auto &index = installed_keyword_stickers_index_[static_cast<int32>(sticker_set->sticker_type_)];
+  return index.is_valid_ && index.indexed_sticker_set_ids_.count(sticker_set->id_) != 0;
+}
+
+FlatHashSet<FileId, FileIdHash> StickersManager::find_installed_keyword_sticker_ids(StickerType sticker_type,
+                                                                                    const string &query) {
+  CHECK(!query.empty());
+  auto type = static_cast<int32>(sticker_type);
+  auto &index = installed_keyword_stickers_index_[type];
+  if (index.is_valid_ && index.sticker_set_ids_ != installed_sticker_set_ids_[type]) {
+    index = KeywordStickersIndex();
+  }
+  if (!index.is_valid_) {
+    // keyword search is done in the single index instead of keyword maps of each installed sticker set
+    index.is_valid_ = true;
+    index.sticker_set_ids_ = installed_sticker_set_ids_[type];
+    for (auto sticker_set_id : index.sticker_set_ids_) {
+      const StickerSet *sticker_set = get_sticker_set(sticker_set_id);
+      if (sticker_set == nullptr || !sticker_set->was_loaded_) {
+        continue;
+      }
+      index.indexed_sticker_set_ids_.insert(sticker_set_id);
+      for (auto &keyword_sticker_ids : get_sticker_set_keywords(sticker_set)) {
+        append(index.keyword_stickers_map_[keyword_sticker_ids.first], keyword_sticker_ids.second);
+      }
+    }
+    LOG(INFO) << "Built keyword index for " << index.indexed_sticker_set_ids_.size() << " installed " << sticker_type
+              << " sticker sets with " << index.keyword_stickers_map_.size() << " keywords";
+  }
+
+  FlatHashSet<FileId, FileIdHash> result;
+  const auto &keywords_map = index.keyword_stickers_map_;
+  for (auto it = keywords_map.lower_bound(query); it != keywords_map.end() && begins_with(it->first, query); ++it) {
+    result.insert(it->second.begin(), it->second.end());
+  }
+  return result;
+}
+
 void StickersManager::find_sticker_set_stickers(const StickerSet *sticker_set, const vector<string> &emojis,
-                                                const string &query, vector<std::pair<bool, FileId>> &result) const {
+                                                const string &query,
+                                                const FlatHashSet<FileId, FileIdHash> *keyword_sticker_ids,
+                                                vector<std::pair<bool, FileId>> &result) const {
   CHECK(sticker_set != nullptr);
   FlatHashSet<FileId, FileIdHash> found_sticker_ids;
   for (auto &emoji : emojis) {
@@ -4190,16 +4258,17 @@ void StickersManager::find_sticker_set_stickers(const StickerSet *sticker_set, c
       found_sticker_ids.insert(it->second.begin(), it->second.end());
     }
   }
-  if (!query.empty()) {
+  if (!query.empty() && keyword_sticker_ids == nullptr) {
     const auto &keywords_map = get_sticker_set_keywords(sticker_set);
     for (auto it = keywords_map.lower_bound(query); it != keywords_map.end() && begins_with(it->first, query); ++it) {
       found_sticker_ids.insert(it->second.begin(), it->second.end());
     }
   }
 
-  if (!found_sticker_ids.empty()) {
+  if (!found_sticker_ids.empty() || (keyword_sticker_ids != nullptr && !keyword_sticker_ids->empty())) {
     for (auto sticker_id : sticker_set->sticker_ids_) {
-      if (found_sticker_ids.count(sticker_id) != 0) {
+      if (found_sticker_ids.count(sticker_id) != 0 ||
+          (keyword_sticker_ids != nullptr && keyword_sticker_ids->count(sticker_id) != 0)) {
         const Sticker *s = get_sticker(sticker_id);
         LOG(INFO) << "Add " << sticker_id << " sticker from " << sticker_set->id_;
         result.emplace_back(is_sticker_format_animated(s->format_), sticker_id);
@@ -4208,8 +4277,9 @@ void StickersManager::find_sticker_set_stickers(const StickerSet *sticker_set, c
   }
 }
 
-bool StickersManager::can_find_sticker_by_query(FileId sticker_id, const vector<string> &emojis,
-                                                const string &query) const {
+bool StickersManager::can_find_sticker_by_query(
+    FileId sticker_id, const vector<string> &emojis, const string &query,
+    const FlatHashSet<FileId, FileIdHash> &installed_keyword_sticker_ids) const {
   const Sticker *s = get_sticker(sticker_id);
   CHECK(s != nullptr);
   if (td::contains(emojis, remove_emoji_modifiers(s->alt_))) {
@@ -4230,6 +4300,9 @@ bool StickersManager::can_find_sticker_by_query(FileId sticker_id, const vector<
   }
 
   if (!query.empty()) {
+    if (is_keyword_stickers_indexed(sticker_set)) {
+      return installed_keyword_sticker_ids.count(sticker_id) != 0;
+    }
     const auto &keywords_map = get_sticker_set_keywords(sticker_set);
     for (auto it = keywords_map.lower_bound(query); it != keywords_map.end() && begins_with(it->first, query); ++it) {
       if (td::contains(it->second, sticker_id)) {
@@ -4463,9 +4536,14 @@ vector<FileId> StickersManager::get_stickers(StickerType sticker_type, string qu
         examined_sticker_sets.push_back(sticker_set);
       }
     }
+    FlatHashSet<FileId, FileIdHash> installed_keyword_sticker_ids;
+    if (!prepared_query.empty()) {
+      installed_keyword_sticker_ids = find_installed_keyword_sticker_ids(sticker_type, prepared_query);
+    }
     vector<std::pair<bool, FileId>> partial_results[2][2];
     for (auto sticker_set : examined_sticker_sets) {
       find_sticker_set_stickers(sticker_set, emojis, prepared_query,
+                                is_keyword_stickers_indexed(sticker_set) ? &installed_keyword_sticker_ids : nullptr,
                                 partial_results[sticker_set->is_installed_][sticker_set->is_archived_]);
     }
     for (int is_installed = 1; is_installed >= 0; is_installed--) {
@@ -4497,7 +4575,7 @@ vector<FileId> StickersManager::get_stickers(StickerType sticker_type, string qu
                   << (it - result.begin());
         *it = FileId();
         is_good = true;
-      } else if (can_find_sticker_by_query(sticker_id, emojis, prepared_query)) {
+      } else if (can_find_sticker_by_query(sticker_id, emojis, prepared_query, installed_keyword_sticker_ids)) {
         LOG(INFO) << "Found prepend sticker " << sticker_id;
         is_good = true;
       }
@@ -5519,10 +5597,92 @@ void StickersManager::do_reload_sticker_set(StickerSetId sticker_set_id,
     promise = PromiseCreator::lambda([actor_id = actor_id(this), sticker_set_id](Result<Unit> result) mutable {
       send_closure(actor_id, &StickersManager::on_reload_sticker_set, sticker_set_id, std::move(result));
     });
+
+    auto shared_sticker_set = hash == 0 ? get_shared_sticker_set(get_sticker_set(sticker_set_id)) : nullptr;
+    if (shared_sticker_set != nullptr) {
+      on_get_messages_sticker_set(sticker_set_id, std::move(shared_sticker_set), true, "do_reload_sticker_set");
+      return promise.set_value(Unit());
+    }
   }
   td_->create_handler<GetStickerSetQuery>(std::move(promise))->send(sticker_set_id, std::move(input_sticker_set), hash);
 }
 
+void StickersManager::add_shared_sticker_set(int64 sticker_set_id, int32 hash, Slice packet) {
+  if (hash == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(shared_sticker_sets_mutex_);
+  auto &shared_sticker_set = shared_sticker_sets_[{G()->is_test_dc(), sticker_set_id}];
+  shared_sticker_sets_size_ -= shared_sticker_set.packet_.size();
+  shared_sticker_set.hash_ = hash;
+  shared_sticker_set.packet_ = packet.str();
+  shared_sticker_set.last_used_ = ++shared_sticker_sets_generation_;
+  shared_sticker_sets_size_ += shared_sticker_set.packet_.size();
+  if (shared_sticker_sets_size_ <= MAX_SHARED_STICKER_SETS_SIZE) {
+    return;
+  }
+
+  // delete least recently used sticker sets
+  vector<std::pair<uint64, std::pair<bool, int64>>> last_used_sticker_sets;
+  for (auto &it : shared_sticker_sets_) {
+    last_used_sticker_sets.emplace_back(it.second.last_used_, it.first);
+  }
+  std::sort(last_used_sticker_sets.begin(), last_used_sticker_sets.end());
+  for (auto &last_used_sticker_set : last_used_sticker_sets) {
+    if (shared_sticker_sets_size_ <= MAX_SHARED_STICKER_SETS_SIZE / 4 * 3) {
+      break;
+    }
+    auto it = shared_sticker_sets_.find(last_used_sticker_set.second);
+    CHECK(it != shared_sticker_sets_.end());
+    shared_sticker_sets_size_ -= it->second.packet_.size();
+    shared_sticker_sets_.erase(it);
+  }
+}
+
+telegram_api::object_ptr<telegram_api::messages_StickerSet> StickersManager::get_shared_sticker_set(
+    const StickerSet *sticker_set) {
+  if (sticker_set == nullptr || !sticker_set->is_inited_ || sticker_set->hash_ == 0) {
+    return nullptr;
+  }
+
+  string packet;
+  {
+    std::lock_guard<std::mutex> lock(shared_sticker_sets_mutex_);
+    auto it = shared_sticker_sets_.find({G()->is_test_dc(), sticker_set->id_.get()});
+    if (it == shared_sticker_sets_.end() || it->second.hash_ != sticker_set->hash_) {
+      return nullptr;
+    }
+    it->second.last_used_ = ++shared_sticker_sets_generation_;
+    packet = it->second.packet_;
+  }
+
+  auto r_set_ptr = fetch_result<telegram_api::messages_getStickerSet>(BufferSlice(packet));
+  if (r_set_ptr.is_error()) {
+    LOG(ERROR) << "Failed to parse shared " << sticker_set->id_ << ": " << r_set_ptr.error();
+    return nullptr;
+  }
+  auto set_ptr = r_set_ptr.move_as_ok();
+  CHECK(set_ptr->get_id() == telegram_api::messages_stickerSet::ID);
+
+  // the shared result was received by another user, so user-specific fields must be replaced
+  auto set = static_cast<telegram_api::messages_stickerSet *>(set_ptr.get())->set_.get();
+  if (sticker_set->is_installed_) {
+    if ((set->flags_ & telegram_api::stickerSet::INSTALLED_DATE_MASK) == 0) {
+      set->flags_ |= telegram_api::stickerSet::INSTALLED_DATE_MASK;
+      set->installed_date_ = G()->unix_time();
+    }
+  } else {
+    set->flags_ &= ~telegram_api::stickerSet::INSTALLED_DATE_MASK;
+    set->installed_date_ = 0;
+  }
+  set->archived_ = sticker_set->is_archived_;
+  set->creator_ = sticker_set->is_created_;
+
+  LOG(INFO) << "Use shared " << sticker_set->id_ << " with hash " << sticker_set->hash_;
+  return set_ptr;
+}
+
 void StickersManager::on_reload_sticker_set(StickerSetId sticker_set_id, Result<Unit> &&result) {
   G()->ignore_result_if_closing(result);
   LOG(INFO) << "Reloaded " << sticker_set_id;
@@ -6256,14 +6416,7 @@ td_api::object_ptr<td_api::sticker> StickersManager::get_custom_emoji_sticker_ob
   CHECK(s->type_ == StickerType::CustomEmoji);
   if (s->emoji_receive_date_ < G()->unix_time() - 86400 && !s->is_being_reloaded_) {
     s->is_being_reloaded_ = true;
-    LOG(INFO) << "Reload " << custom_emoji_id;
-    auto promise = PromiseCreator::lambda(
-        [actor_id =
-             actor_id(this)](Result<vector<telegram_api::object_ptr<telegram_api::Document>>> r_documents) mutable {
-          send_closure(actor_id, &StickersManager::on_get_custom_emoji_documents, std::move(r_documents),
-                       vector<CustomEmojiId>(), Promise<td_api::object_ptr<td_api::stickers>>());
-        });
-    td_->create_handler<GetCustomEmojiDocumentsQuery>(std::move(promise))->send({custom_emoji_id});
+    reload_custom_emoji_queries_.add_query(custom_emoji_id.get(), Promise<Unit>(), "get_custom_emoji_sticker_object");
   }
   return get_sticker_object(file_id);
 }
@@ -6289,15 +6442,8 @@ td_api::object_ptr<td_api::stickers> StickersManager::get_custom_emoji_stickers_
       stickers.push_back(std::move(sticker));
     }
   }
-  if (!reload_custom_emoji_ids.empty()) {
-    LOG(INFO) << "Reload " << reload_custom_emoji_ids;
-    auto promise = PromiseCreator::lambda(
-        [actor_id =
-             actor_id(this)](Result<vector<telegram_api::object_ptr<telegram_api::Document>>> r_documents) mutable {
-          send_closure(actor_id, &StickersManager::on_get_custom_emoji_documents, std::move(r_documents),
-                       vector<CustomEmojiId>(), Promise<td_api::object_ptr<td_api::stickers>>());
-        });
-    td_->create_handler<GetCustomEmojiDocumentsQuery>(std::move(promise))->send(std::move(reload_custom_emoji_ids));
+  for (auto custom_emoji_id : reload_custom_emoji_ids) {
+    reload_custom_emoji_queries_.add_query(custom_emoji_id.get(), Promise<Unit>(), "get_custom_emoji_stickers_object");
   }
   return td_api::make_object<td_api::stickers>(std::move(stickers));
 }
@@ -9624,25 +9770,72 @@ string StickersManager::get_language_emojis_database_key(const string &language_
   return PSTRING() << "emoji$" << language_code << '$' << text;
 }
 
+static bool compare_emoji_keyword(const std::pair<string, string> &keyword, const string &text) {
+  return keyword.first < text;
+}
+
+const vector<std::pair<string, string>> &StickersManager::get_language_emoji_keywords(const string &language_code) {
+  auto it = emoji_language_keywords_.find(language_code);
+  if (it != emoji_language_keywords_.end()) {
+    return it->second;
+  }
+
+  // all keywords of the language are loaded at once to avoid a database query for each typed character
+  vector<std::pair<string, string>> keywords;
+  G()->td_db()->get_sqlite_sync_pmc()->get_by_prefix(get_language_emojis_database_key(language_code, string()),
+                                                     [&keywords](Slice key, Slice value) {
+                                                       if (!value.empty()) {
+                                                         keywords.emplace_back(key.str(), value.str());
+                                                       }
+                                                       return true;
+                                                     });
+  std::sort(keywords.begin(), keywords.end());
+  LOG(INFO) << "Loaded " << keywords.size() << " emoji keywords for language " << language_code;
+  return emoji_language_keywords_[language_code] = std::move(keywords);
+}
+
+void StickersManager::set_language_emoji_keyword(const string &language_code, const string &text, string emojis) {
+  auto it = emoji_language_keywords_.find(language_code);
+  if (it == emoji_language_keywords_.end()) {
+    // the keywords will be loaded from the database on the first use
+    return;
+  }
+  auto &keywords = it->second;
+  auto keyword_it = std::lower_bound(keywords.begin(), keywords.end(), text, compare_emoji_keyword);
+  bool is_found = keyword_it != keywords.end() && keyword_it->first == text;
+  if (emojis.empty()) {
+    if (is_found) {
+      keywords.erase(keyword_it);
+    }
+  } else if (is_found) {
+    keyword_it->second = std::move(emojis);
+  } else {
+    keywords.emplace(keyword_it, text, std::move(emojis));
+  }
+}
+
 vector<std::pair<string, string>> StickersManager::search_language_emojis(const string &language_code,
                                                                           const string &text) {
   LOG(INFO) << "Search emoji for \"" << text << "\" in language " << language_code;
-  auto key = get_language_emojis_database_key(language_code, text);
+  const auto &keywords = get_language_emoji_keywords(language_code);
   vector<std::pair<string, string>> result;
-  G()->td_db()->get_sqlite_sync_pmc()->get_by_prefix(key, [&text, &result](Slice key, Slice value) {
-    for (const auto &emoji : full_split(value, '$')) {
-      result.emplace_back(emoji.str(), PSTRING() << text << key);
+  for (auto it = std::lower_bound(keywords.begin(), keywords.end(), text, compare_emoji_keyword);
+       it != keywords.end() && begins_with(it->first, text); ++it) {
+    for (const auto &emoji : full_split(Slice(it->second), '$')) {
+      result.emplace_back(emoji.str(), it->first);
     }
-    return true;
-  });
+  }
   return result;
 }
 
 vector<string> StickersManager::get_keyword_language_emojis(const string &language_code, const string &text) {
   LOG(INFO) << "Get emoji for \"" << text << "\" in language " << language_code;
-  auto key = get_language_emojis_database_key(language_code, text);
-  string emojis = G()->td_db()->get_sqlite_sync_pmc()->get(key);
-  return full_split(emojis, '$');
+  const auto &keywords = get_language_emoji_keywords(language_code);
+  auto it = std::lower_bound(keywords.begin(), keywords.end(), text, compare_emoji_keyword);
+  if (it == keywords.end() || it->first != text) {
+    return {};
+  }
+  return full_split(it->second, '$');
 }
 
 string StickersManager::get_emoji_language_codes_database_key(const vector<string> &language_codes) {
@@ -9851,8 +10044,10 @@ void StickersManager::on_get_emoji_keywords(
         }
         if (is_good && !G()->close_flag()) {
           CHECK(G()->use_sqlite_pmc());
-          G()->td_db()->get_sqlite_pmc()->set(get_language_emojis_database_key(language_code, text),
-                                              implode(keyword->emoticons_, '$'), mpas.get_promise());
+          auto emojis = implode(keyword->emoticons_, '$');
+          G()->td_db()->get_sqlite_pmc()->set(get_language_emojis_database_key(language_code, text), emojis,
+                                              mpas.get_promise());
+          set_language_emoji_keyword(language_code, text, std::move(emojis));
         }
         break;
       }
@@ -9944,6 +10139,7 @@ void StickersManager::on_get_emoji_keywords_difference(
           }
           if (is_changed) {
             key_values.emplace(get_language_emojis_database_key(language_code, text), implode(emojis, '$'));
+            set_language_emoji_keyword(language_code, text, implode(emojis, '$'));
           } else {
             LOG(INFO) << "Emoji keywords not changed for \"" << text << "\" from version " << from_version
                       << " to version " << version;
@@ -9963,6 +10159,7 @@ void StickersManager::on_get_emoji_keywords_difference(
         }
         if (is_changed) {
           key_values.emplace(get_language_emojis_database_key(language_code, text), implode(emojis, '$'));
+          set_language_emoji_keyword(language_code, text, implode(emojis, '$'));
         } else {
           LOG(INFO) << "Emoji keywords not changed for \"" << text << "\" from version " << from_version
                     << " to version " << version;
@@ -10265,6 +10462,21 @@ void StickersManager::on_get_emoji_groups(
   }
 }
 
+void StickersManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  statistics.add("StickersManager", "stickers", stickers_.calc_size(),
+                 sizeof(FileId) + sizeof(unique_ptr<Sticker>) + sizeof(Sticker));
+  statistics.add("StickersManager", "sticker_sets", sticker_sets_.calc_size(),
+                 sizeof(StickerSetId) + sizeof(unique_ptr<StickerSet>) + sizeof(StickerSet));
+  statistics.add("StickersManager", "short_name_to_sticker_set_id", short_name_to_sticker_set_id_.calc_size(),
+                 sizeof(string) + sizeof(StickerSetId));
+  statistics.add("StickersManager", "custom_emoji_to_sticker_id", custom_emoji_to_sticker_id_.calc_size(),
+                 sizeof(CustomEmojiId) + sizeof(FileId));
+  statistics.add("StickersManager", "emoji_messages", emoji_messages_.size(),
+                 sizeof(string) + sizeof(unique_ptr<EmojiMessages>) + sizeof(EmojiMessages));
+  statistics.add("StickersManager", "custom_emoji_messages", custom_emoji_messages_.size(),
+                 sizeof(CustomEmojiId) + sizeof(unique_ptr<CustomEmojiMessages>) + sizeof(CustomEmojiMessages));
+}
+
 void StickersManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   if (td_->auth_manager_->is_bot()) {
     return;
@@ -10292,4 +10504,9 @@ void StickersManager::get_current_state(vector<td_api::object_ptr<td_api::Update
   }
 }
 
+std::mutex StickersManager::shared_sticker_sets_mutex_;
+std::map<std::pair<bool, int64>, StickersManager::SharedStickerSet> StickersManager::shared_sticker_sets_;
+size_t StickersManager::shared_sticker_sets_size_ = 0;
+uint64 StickersManager::shared_sticker_sets_generation_ = 0;
+
 }  // namespace td
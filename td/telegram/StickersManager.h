@@ -16,6 +16,7 @@
 #include "td/telegram/MessageFullId.h"
 #include "td/telegram/PhotoFormat.h"
 #include "td/telegram/PhotoSize.h"
+#include "td/telegram/QueryMerger.h"
 #include "td/telegram/SecretInputMedia.h"
 #include "td/telegram/SpecialStickerSetType.h"
 #include "td/telegram/StickerFormat.h"
@@ -45,12 +46,14 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
 
 namespace td {
 
+class MemoryStatistics;
 class Td;
 
 class StickersManager final : public Actor {
@@ -60,6 +63,9 @@ class StickersManager final : public Actor {
   static vector<StickerSetId> convert_sticker_set_ids(const vector<int64> &sticker_set_ids);
   static vector<int64> convert_sticker_set_ids(const vector<StickerSetId> &sticker_set_ids);
 
+  // remembers a result of messages.getStickerSet to be reused by all clients in the process
+  static void add_shared_sticker_set(int64 sticker_set_id, int32 hash, Slice packet);
+
   StickersManager(Td *td, ActorShared<> parent);
   StickersManager(const StickersManager &) = delete;
   StickersManager &operator=(const StickersManager &) = delete;
@@ -435,6 +441,8 @@ class StickersManager final : public Actor {
 
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   template <class StorerT>
   void store_sticker_set_id(StickerSetId sticker_set_id, StorerT &storer) const;
 
@@ -449,6 +457,7 @@ class StickersManager final : public Actor {
   static constexpr size_t MAX_STICKER_SET_TITLE_LENGTH = 64;       // server side limit
   static constexpr size_t MAX_STICKER_SET_SHORT_NAME_LENGTH = 64;  // server side limit
   static constexpr size_t MAX_GET_CUSTOM_EMOJI_STICKERS = 200;     // server-side limit
+  static constexpr double RELOAD_CUSTOM_EMOJI_MERGE_DELAY = 0.01;
 
   static constexpr int32 EMOJI_KEYWORDS_UPDATE_DELAY = 3600;
   static constexpr double MIN_ANIMATED_EMOJI_CLICK_DELAY = 0.2;
@@ -694,6 +703,8 @@ class StickersManager final : public Actor {
                              tl_object_ptr<telegram_api::InputStickerSet> &&input_sticker_set, int32 hash,
                              Promise<Unit> &&promise, const char *source);
 
+  telegram_api::object_ptr<telegram_api::messages_StickerSet> get_shared_sticker_set(const StickerSet *sticker_set);
+
   void on_reload_sticker_set(StickerSetId sticker_set_id, Result<Unit> &&result);
 
   void do_get_premium_stickers(int32 limit, Promise<td_api::object_ptr<td_api::stickers>> &&promise);
@@ -923,10 +934,19 @@ class StickersManager final : public Actor {
 
   static const std::map<string, vector<FileId>> &get_sticker_set_keywords(const StickerSet *sticker_set);
 
+  void invalidate_installed_keyword_stickers_index(const StickerSet *sticker_set);
+
+  bool is_keyword_stickers_indexed(const StickerSet *sticker_set) const;
+
+  FlatHashSet<FileId, FileIdHash> find_installed_keyword_sticker_ids(StickerType sticker_type, const string &query);
+
+  // keyword_sticker_ids must be non-null for sticker sets with is_keyword_stickers_indexed
   void find_sticker_set_stickers(const StickerSet *sticker_set, const vector<string> &emojis, const string &query,
+                                 const FlatHashSet<FileId, FileIdHash> *keyword_sticker_ids,
                                  vector<std::pair<bool, FileId>> &result) const;
 
-  bool can_find_sticker_by_query(FileId sticker_id, const vector<string> &emojis, const string &query) const;
+  bool can_find_sticker_by_query(FileId sticker_id, const vector<string> &emojis, const string &query,
+                                 const FlatHashSet<FileId, FileIdHash> &installed_keyword_sticker_ids) const;
 
   static string get_emoji_language_code_version_database_key(const string &language_code);
 
@@ -960,9 +980,14 @@ class StickersManager final : public Actor {
 
   void on_get_language_codes(const string &key, Result<vector<string>> &&result);
 
-  static vector<std::pair<string, string>> search_language_emojis(const string &language_code, const string &text);
+  // returns pairs keyword -> emojis, separated by '$', sorted by keyword
+  const vector<std::pair<string, string>> &get_language_emoji_keywords(const string &language_code);
+
+  void set_language_emoji_keyword(const string &language_code, const string &text, string emojis);
+
+  vector<std::pair<string, string>> search_language_emojis(const string &language_code, const string &text);
 
-  static vector<string> get_keyword_language_emojis(const string &language_code, const string &text);
+  vector<string> get_keyword_language_emojis(const string &language_code, const string &text);
 
   void load_emoji_keywords(const string &language_code, Promise<Unit> &&promise);
 
@@ -1058,6 +1083,14 @@ class StickersManager final : public Actor {
 
   Hints installed_sticker_sets_hints_[MAX_STICKER_TYPE];  // search installed sticker sets by their title and name
 
+  struct KeywordStickersIndex {
+    bool is_valid_ = false;
+    vector<StickerSetId> sticker_set_ids_;  // installed sticker sets at the time the index was built
+    FlatHashSet<StickerSetId, StickerSetIdHash> indexed_sticker_set_ids_;
+    std::map<string, vector<FileId>> keyword_stickers_map_;  // keyword -> stickers from all indexed sticker sets
+  };
+  KeywordStickersIndex installed_keyword_stickers_index_[MAX_STICKER_TYPE];  // built lazily
+
   FlatHashMap<string, FoundStickers> found_stickers_[MAX_STICKER_TYPE];
   FlatHashMap<string, vector<std::pair<int32, Promise<td_api::object_ptr<td_api::stickers>>>>>
       search_stickers_queries_[MAX_STICKER_TYPE];
@@ -1115,11 +1148,26 @@ class StickersManager final : public Actor {
 
   std::shared_ptr<UploadStickerFileCallback> upload_sticker_file_callback_;
 
+  // sticker set content is the same for all users, so it is fetched from the server once per process;
+  // the data must be parsed by each client separately, because file identifiers are local to the client
+  struct SharedStickerSet {
+    int32 hash_ = 0;
+    string packet_;
+    uint64 last_used_ = 0;
+  };
+  static constexpr size_t MAX_SHARED_STICKER_SETS_SIZE = 1 << 26;
+
+  static std::mutex shared_sticker_sets_mutex_;
+  static std::map<std::pair<bool, int64>, SharedStickerSet> shared_sticker_sets_;  // (is_test_dc, set_id) -> set
+  static size_t shared_sticker_sets_size_;
+  static uint64 shared_sticker_sets_generation_;
+
   FlatHashMap<FileId, std::pair<UserId, Promise<Unit>>, FileIdHash> being_uploaded_files_;
 
   FlatHashMap<string, vector<string>> emoji_language_codes_;
   FlatHashMap<string, int32> emoji_language_code_versions_;
   FlatHashMap<string, double> emoji_language_code_last_difference_times_;
+  FlatHashMap<string, vector<std::pair<string, string>>> emoji_language_keywords_;  // in-memory copy of the database
   FlatHashSet<string> reloaded_emoji_keywords_;
   FlatHashMap<string, vector<Promise<Unit>>> load_emoji_keywords_queries_;
   FlatHashMap<string, vector<Promise<Unit>>> load_language_codes_queries_;
@@ -1168,6 +1216,8 @@ class StickersManager final : public Actor {
 
   WaitFreeHashMap<CustomEmojiId, FileId, CustomEmojiIdHash> custom_emoji_to_sticker_id_;
 
+  QueryMerger reload_custom_emoji_queries_{"ReloadCustomEmojiMerger", 3, MAX_GET_CUSTOM_EMOJI_STICKERS};
+
   double animated_emoji_zoom_ = 0.625;
 
   bool disable_animated_emojis_ = false;
@@ -403,6 +403,7 @@ void StickersManager::parse_sticker_set(StickerSet *sticker_set, ParserT &parser
       sticker_set->sticker_emojis_map_.clear();
       sticker_set->keyword_stickers_map_.clear();
       sticker_set->sticker_keywords_map_.clear();
+      invalidate_installed_keyword_stickers_index(sticker_set);
     }
     for (uint32 i = 0; i < stored_sticker_count; i++) {
       auto sticker_id = parse_sticker(true, parser);
@@ -6,6 +6,7 @@
 //
 #include "td/telegram/StorageManager.h"
 
+#include "td/telegram/DatabaseMaintenanceWorker.h"
 #include "td/telegram/DialogId.h"
 #include "td/telegram/files/FileGcWorker.h"
 #include "td/telegram/files/FileStatsWorker.h"
@@ -15,6 +16,7 @@
 #include "td/telegram/TdDb.h"
 
 #include "td/db/SqliteDb.h"
+#include "td/db/SqliteKeyValueSafe.h"
 
 #include "td/utils/algorithm.h"
 #include "td/utils/logging.h"
@@ -40,6 +42,15 @@ void StorageManager::start_up() {
   schedule_next_gc();
 
   load_fast_stat();
+
+  if (G()->use_file_database()) {
+    gc_index_ = create_actor_on_scheduler<FileGcIndex>(
+        "FileGcIndex", scheduler_id_, create_reference(),
+        std::make_shared<SqliteKeyValueSafe>("file_gc_index", G()->td_db()->get_sqlite_connection_safe()));
+    database_maintenance_worker_ = create_actor_on_scheduler<DatabaseMaintenanceWorker>(
+        "DatabaseMaintenanceWorker", G()->get_database_scheduler_id(), create_reference(),
+        G()->td_db()->get_sqlite_connection_safe());
+  }
 }
 
 void StorageManager::on_new_file(int64 size, int64 real_size, int32 cnt) {
@@ -60,6 +71,24 @@ void StorageManager::on_new_file(int64 size, int64 real_size, int32 cnt) {
   save_fast_stat();
 }
 
+void StorageManager::on_local_file_used(FileType file_type, string path, DialogId owner_dialog_id, int64 size,
+                                        uint64 mtime_nsec, bool is_new) {
+  if (gc_index_.empty()) {
+    return;
+  }
+  if (is_new) {
+    send_closure(gc_index_, &FileGcIndex::add_file, file_type, std::move(path), owner_dialog_id, size, mtime_nsec);
+  } else {
+    send_closure(gc_index_, &FileGcIndex::access_file, std::move(path), owner_dialog_id);
+  }
+}
+
+void StorageManager::on_local_file_deleted(string path) {
+  if (!gc_index_.empty()) {
+    send_closure(gc_index_, &FileGcIndex::remove_file, std::move(path));
+  }
+}
+
 void StorageManager::get_storage_stats(bool need_all_files, int32 dialog_limit, Promise<FileStats> promise) {
   if (is_closed_) {
     return promise.set_error(Global::request_aborted_error());
@@ -79,8 +108,22 @@ void StorageManager::get_storage_stats(bool need_all_files, int32 dialog_limit,
   stats_need_all_files_ = need_all_files;
   pending_storage_stats_.emplace_back(std::move(promise));
 
+  if (!need_all_files && !gc_index_.empty()) {
+    // there is no need to scan file directories to return only counters
+    send_closure(gc_index_, &FileGcIndex::get_stats, stats_dialog_limit_ != 0,
+                 PromiseCreator::lambda(
+                     [actor_id = actor_id(this), stats_generation = stats_generation_](Result<FileStats> file_stats) {
+                       send_closure(actor_id, &StorageManager::on_file_stats_by_index, std::move(file_stats),
+                                    stats_generation);
+                     }));
+    return;
+  }
+  get_file_stats_by_scan();
+}
+
+void StorageManager::get_file_stats_by_scan() {
   create_stats_worker();
-  send_closure(stats_worker_, &FileStatsWorker::get_stats, need_all_files, stats_dialog_limit_ != 0,
+  send_closure(stats_worker_, &FileStatsWorker::get_stats, stats_need_all_files_, stats_dialog_limit_ != 0,
                PromiseCreator::lambda(
                    [actor_id = actor_id(this), stats_generation = stats_generation_](Result<FileStats> file_stats) {
                      send_closure(actor_id, &StorageManager::on_file_stats, std::move(file_stats), stats_generation);
@@ -115,8 +158,10 @@ void StorageManager::run_gc(FileGcParameters parameters, bool return_deleted_fil
     close_gc_worker();
   }
 
+  // owners of files are also needed to rebuild counters of files GC index
   bool split_by_owner_dialog_id = !parameters.owner_dialog_ids_.empty() ||
-                                  !parameters.exclude_owner_dialog_ids_.empty() || parameters.dialog_limit_ != 0;
+                                  !parameters.exclude_owner_dialog_ids_.empty() || parameters.dialog_limit_ != 0 ||
+                                  !gc_index_.empty();
   get_storage_stats(
       true /*need_all_files*/, split_by_owner_dialog_id,
       PromiseCreator::lambda(
@@ -141,6 +186,17 @@ void StorageManager::on_file_stats(Result<FileStats> r_file_stats, uint32 genera
   send_stats(r_file_stats.move_as_ok(), stats_dialog_limit_, std::move(pending_storage_stats_));
 }
 
+void StorageManager::on_file_stats_by_index(Result<FileStats> r_file_stats, uint32 generation) {
+  if (generation != stats_generation_) {
+    return;
+  }
+  if (r_file_stats.is_error() && r_file_stats.error().code() == 404 && !is_closed_) {
+    LOG(INFO) << "Scan file directories to get storage statistics: " << r_file_stats.error();
+    return get_file_stats_by_scan();
+  }
+  on_file_stats(std::move(r_file_stats), generation);
+}
+
 void StorageManager::create_stats_worker() {
   CHECK(!is_closed_);
   if (stats_worker_.empty()) {
@@ -161,7 +217,12 @@ void StorageManager::on_all_files(FileGcParameters gc_parameters, Result<FileSta
 
   create_gc_worker();
 
-  send_closure(gc_worker_, &FileGcWorker::run_gc, std::move(gc_parameters), r_file_stats.ok_ref().get_all_files(),
+  auto all_files = r_file_stats.ok_ref().get_all_files();
+  if (!gc_index_.empty()) {
+    send_closure(gc_index_, &FileGcIndex::reset, all_files);
+  }
+
+  send_closure(gc_worker_, &FileGcWorker::run_gc, std::move(gc_parameters), std::move(all_files),
                PromiseCreator::lambda([actor_id = actor_id(this), dialog_limit](Result<FileGcResult> r_file_gc_result) {
                  send_closure(actor_id, &StorageManager::on_gc_finished, dialog_limit, std::move(r_file_gc_result));
                }));
@@ -205,7 +266,8 @@ void StorageManager::create_gc_worker() {
   CHECK(!is_closed_);
   if (gc_worker_.empty()) {
     gc_worker_ = create_actor_on_scheduler<FileGcWorker>("FileGcWorker", scheduler_id_, create_reference(),
-                                                         gc_cancellation_token_source_.get_cancellation_token());
+                                                         gc_cancellation_token_source_.get_cancellation_token(),
+                                                         gc_index_.get());
   }
 }
 
@@ -230,6 +292,35 @@ void StorageManager::on_gc_finished(int32 dialog_limit, Result<FileGcResult> r_f
   send_stats(std::move(r_file_gc_result.ok_ref().removed_file_stats_), dialog_limit, std::move(removed_file_promises));
 }
 
+void StorageManager::run_automatic_gc(Promise<FileStats> promise) {
+  if (gc_index_.empty()) {
+    return run_gc({}, false, std::move(promise));
+  }
+
+  send_closure(gc_index_, &FileGcIndex::run_gc, FileGcParameters(),
+               gc_cancellation_token_source_.get_cancellation_token(),
+               PromiseCreator::lambda(
+                   [actor_id = actor_id(this), generation = gc_generation_](Result<FileGcResult> r_file_gc_result) {
+                     send_closure(actor_id, &StorageManager::on_automatic_gc_finished, generation,
+                                  std::move(r_file_gc_result));
+                   }));
+  pending_run_gc_[0].push_back(std::move(promise));
+}
+
+void StorageManager::on_automatic_gc_finished(uint32 generation, Result<FileGcResult> r_file_gc_result) {
+  if (generation != gc_generation_) {
+    return;
+  }
+  if (r_file_gc_result.is_error() && r_file_gc_result.error().code() == 404 && !is_closed_) {
+    LOG(INFO) << "Run full files GC: " << r_file_gc_result.error();
+    CHECK(pending_run_gc_[0].size() == 1u && pending_run_gc_[1].empty());
+    auto promise = std::move(pending_run_gc_[0][0]);
+    pending_run_gc_[0].clear();
+    return run_gc({}, false, std::move(promise));
+  }
+  on_gc_finished(0, std::move(r_file_gc_result));
+}
+
 void StorageManager::save_fast_stat() {
   G()->td_db()->get_binlog_pmc()->set("fast_file_stat", log_event_store(fast_stat_).as_slice().str());
 }
@@ -300,12 +391,15 @@ void StorageManager::close_gc_worker() {
   fail_promises(promises, Global::request_aborted_error());
   gc_worker_.reset();
   gc_cancellation_token_source_.cancel();
+  gc_generation_++;
 }
 
 void StorageManager::hangup() {
   is_closed_ = true;
   close_stats_worker();
   close_gc_worker();
+  gc_index_.reset();
+  database_maintenance_worker_.reset();
   hangup_shared();
 }
 
@@ -353,13 +447,22 @@ void StorageManager::timeout_expired() {
     return;
   }
   next_gc_at_ = 0;
-  run_gc({}, false, PromiseCreator::lambda([actor_id = actor_id(this)](Result<FileStats> r_stats) {
-           if (!r_stats.is_error() || r_stats.error().code() != 500) {
-             // do not save garbage collection timestamp if request was canceled
-             send_closure(actor_id, &StorageManager::save_last_gc_timestamp);
-           }
-           send_closure(actor_id, &StorageManager::schedule_next_gc);
-         }));
+  run_automatic_gc(PromiseCreator::lambda([actor_id = actor_id(this)](Result<FileStats> r_stats) {
+    if (!r_stats.is_error() || r_stats.error().code() != 500) {
+      // do not save garbage collection timestamp if request was canceled
+      send_closure(actor_id, &StorageManager::save_last_gc_timestamp);
+    }
+    send_closure(actor_id, &StorageManager::schedule_next_gc);
+    send_closure(actor_id, &StorageManager::run_database_maintenance);
+  }));
+}
+
+void StorageManager::run_database_maintenance() {
+  if (database_maintenance_worker_.empty()) {
+    return;
+  }
+  // free pages of the deleted data and update statistics of SQLite indices after files GC
+  send_closure(database_maintenance_worker_, &DatabaseMaintenanceWorker::run_maintenance, Promise<Unit>());
 }
 
 }  // namespace td
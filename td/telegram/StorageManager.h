@@ -6,9 +6,12 @@
 //
 #pragma once
 
+#include "td/telegram/DialogId.h"
+#include "td/telegram/files/FileGcIndex.h"
 #include "td/telegram/files/FileGcWorker.h"
 #include "td/telegram/files/FileStats.h"
 #include "td/telegram/files/FileStatsWorker.h"
+#include "td/telegram/files/FileType.h"
 #include "td/telegram/td_api.h"
 
 #include "td/actor/actor.h"
@@ -29,6 +32,8 @@ struct DatabaseStats {
   tl_object_ptr<td_api::databaseStatistics> get_database_statistics_object() const;
 };
 
+class DatabaseMaintenanceWorker;
+
 class StorageManager final : public Actor {
  public:
   StorageManager(ActorShared<> parent, int32 scheduler_id);
@@ -40,6 +45,11 @@ class StorageManager final : public Actor {
 
   void on_new_file(int64 size, int64 real_size, int32 cnt);
 
+  void on_local_file_used(FileType file_type, string path, DialogId owner_dialog_id, int64 size, uint64 mtime_nsec,
+                          bool is_new);
+
+  void on_local_file_deleted(string path);
+
  private:
   static constexpr int GC_EACH = 60 * 60 * 24;  // 1 day
   static constexpr int GC_DELAY = 60;
@@ -62,6 +72,8 @@ class StorageManager final : public Actor {
   CancellationTokenSource gc_cancellation_token_source_;
 
   void on_file_stats(Result<FileStats> r_file_stats, uint32 generation);
+  void on_file_stats_by_index(Result<FileStats> r_file_stats, uint32 generation);
+  void get_file_stats_by_scan();
   void create_stats_worker();
   void update_fast_stats(const FileStats &stats);
   static void send_stats(FileStats &&stats, int32 dialog_limit, std::vector<Promise<FileStats>> &&promises);
@@ -83,7 +95,9 @@ class StorageManager final : public Actor {
 
   // Gc
   ActorOwn<FileGcWorker> gc_worker_;
+  ActorOwn<FileGcIndex> gc_index_;
   std::vector<Promise<FileStats>> pending_run_gc_[2];
+  uint32 gc_generation_{0};
 
   uint32 last_gc_timestamp_ = 0;
   double next_gc_at_ = 0;
@@ -92,6 +106,14 @@ class StorageManager final : public Actor {
   void create_gc_worker();
   void on_gc_finished(int32 dialog_limit, Result<FileGcResult> r_file_gc_result);
 
+  void run_automatic_gc(Promise<FileStats> promise);
+  void on_automatic_gc_finished(uint32 generation, Result<FileGcResult> r_file_gc_result);
+
+  // Database maintenance
+  ActorOwn<DatabaseMaintenanceWorker> database_maintenance_worker_;
+
+  void run_database_maintenance();
+
   void close_stats_worker();
   void close_gc_worker();
 
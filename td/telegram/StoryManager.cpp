@@ -18,6 +18,7 @@
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/logevent/LogEventHelper.h"
 #include "td/telegram/MediaArea.hpp"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageEntity.h"
 #include "td/telegram/MessageSender.h"
 #include "td/telegram/MessagesManager.h"
@@ -2091,14 +2092,75 @@ void StoryManager::load_active_stories_from_server(StoryListId story_list_id, St
                                                    Promise<Unit> &&promise) {
   story_list.load_list_from_server_queries_.push_back(std::move(promise));
   if (story_list.load_list_from_server_queries_.size() == 1u) {
-    auto query_promise =
-        PromiseCreator::lambda([actor_id = actor_id(this), story_list_id, is_next, state = story_list.state_](
-                                   Result<telegram_api::object_ptr<telegram_api::stories_AllStories>> r_all_stories) {
-          send_closure(actor_id, &StoryManager::on_load_active_stories_from_server, story_list_id, is_next, state,
-                       std::move(r_all_stories));
-        });
-    td_->create_handler<GetAllStoriesQuery>(std::move(query_promise))->send(story_list_id, is_next, story_list.state_);
+    if (is_next && !story_list.state_.empty() && story_list.prefetch_state_ == story_list.state_) {
+      if (story_list.prefetched_stories_ != nullptr) {
+        LOG(INFO) << "Use prefetched next page of " << story_list_id;
+        return on_load_active_stories_from_server(story_list_id, true, story_list.state_,
+                                                  std::move(story_list.prefetched_stories_));
+      }
+      if (story_list.is_prefetching_) {
+        LOG(INFO) << "Wait for prefetched next page of " << story_list_id;
+        story_list.is_waiting_prefetch_ = true;
+        return;
+      }
+    }
+    send_get_all_stories_query(story_list_id, story_list, is_next);
+  }
+}
+
+void StoryManager::send_get_all_stories_query(StoryListId story_list_id, StoryList &story_list, bool is_next) {
+  auto query_promise =
+      PromiseCreator::lambda([actor_id = actor_id(this), story_list_id, is_next, state = story_list.state_](
+                                 Result<telegram_api::object_ptr<telegram_api::stories_AllStories>> r_all_stories) {
+        send_closure(actor_id, &StoryManager::on_load_active_stories_from_server, story_list_id, is_next, state,
+                     std::move(r_all_stories));
+      });
+  td_->create_handler<GetAllStoriesQuery>(std::move(query_promise))->send(story_list_id, is_next, story_list.state_);
+}
+
+void StoryManager::prefetch_active_stories(StoryListId story_list_id, StoryList &story_list) {
+  if (!story_list.server_has_more_ || story_list.database_has_more_ || story_list.state_.empty() ||
+      story_list.is_prefetching_ || !story_list.load_list_from_server_queries_.empty()) {
+    return;
+  }
+
+  LOG(INFO) << "Prefetch next page of " << story_list_id;
+  story_list.is_prefetching_ = true;
+  story_list.prefetch_state_ = story_list.state_;
+  story_list.prefetched_stories_ = nullptr;
+  auto query_promise = PromiseCreator::lambda(
+      [actor_id = actor_id(this),
+       story_list_id](Result<telegram_api::object_ptr<telegram_api::stories_AllStories>> r_all_stories) {
+        send_closure(actor_id, &StoryManager::on_prefetch_active_stories, story_list_id, std::move(r_all_stories));
+      });
+  td_->create_handler<GetAllStoriesQuery>(std::move(query_promise))->send(story_list_id, true, story_list.state_);
+}
+
+void StoryManager::on_prefetch_active_stories(
+    StoryListId story_list_id, Result<telegram_api::object_ptr<telegram_api::stories_AllStories>> r_all_stories) {
+  G()->ignore_result_if_closing(r_all_stories);
+  auto &story_list = get_story_list(story_list_id);
+  CHECK(story_list.is_prefetching_);
+  story_list.is_prefetching_ = false;
+  bool is_waited = story_list.is_waiting_prefetch_;
+  story_list.is_waiting_prefetch_ = false;
+  if (r_all_stories.is_error() || story_list.prefetch_state_ != story_list.state_) {
+    LOG(INFO) << "Failed to prefetch next page of " << story_list_id;
+    story_list.prefetch_state_.clear();
+    if (is_waited) {
+      CHECK(!story_list.load_list_from_server_queries_.empty());
+      if (r_all_stories.is_error()) {
+        return fail_promises(story_list.load_list_from_server_queries_, r_all_stories.move_as_error());
+      }
+      send_get_all_stories_query(story_list_id, story_list, true);
+    }
+    return;
+  }
+
+  if (is_waited) {
+    return on_load_active_stories_from_server(story_list_id, true, story_list.state_, r_all_stories.move_as_ok());
   }
+  story_list.prefetched_stories_ = r_all_stories.move_as_ok();
 }
 
 void StoryManager::reload_active_stories() {
@@ -2117,6 +2179,9 @@ void StoryManager::on_load_active_stories_from_server(
   if (r_all_stories.is_error()) {
     return fail_promises(promises, r_all_stories.move_as_error());
   }
+  // the state of the list will change, so the prefetched page becomes outdated
+  story_list.prefetch_state_.clear();
+  story_list.prefetched_stories_ = nullptr;
   auto all_stories = r_all_stories.move_as_ok();
   switch (all_stories->get_id()) {
     case telegram_api::stories_allStoriesNotModified::ID: {
@@ -2221,6 +2286,11 @@ void StoryManager::on_load_active_stories_from_server(
   }
 
   set_promises(promises);
+
+  if (is_next) {
+    // the user scrolls the list, so the next page will likely be needed soon
+    prefetch_active_stories(story_list_id, story_list);
+  }
 }
 
 void StoryManager::save_story_list(StoryListId story_list_id, string state, int32 total_count, bool has_more) {
@@ -5561,6 +5631,19 @@ void StoryManager::remove_story_notifications_by_story_ids(DialogId dialog_id, c
   }
 }
 
+void StoryManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  statistics.add("StoryManager", "stories", stories_.calc_size(),
+                 sizeof(StoryFullId) + sizeof(unique_ptr<Story>) + sizeof(Story));
+  statistics.add("StoryManager", "stories_by_global_id", stories_by_global_id_.calc_size(),
+                 sizeof(int64) + sizeof(StoryFullId));
+  statistics.add("StoryManager", "active_stories", active_stories_.calc_size(),
+                 sizeof(DialogId) + sizeof(unique_ptr<ActiveStories>) + sizeof(ActiveStories));
+  statistics.add("StoryManager", "story_messages", story_messages_.calc_size(),
+                 sizeof(StoryFullId) + sizeof(WaitFreeHashSet<MessageFullId, MessageFullIdHash>));
+  statistics.add("StoryManager", "inaccessible_story_full_ids", inaccessible_story_full_ids_.calc_size(),
+                 sizeof(StoryFullId) + sizeof(double));
+}
+
 void StoryManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   active_stories_.foreach([&](const DialogId &dialog_id, const unique_ptr<ActiveStories> &active_stories) {
     if (updated_active_stories_.count(dialog_id) > 0) {
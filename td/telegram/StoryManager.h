@@ -47,6 +47,7 @@ namespace td {
 
 struct BinlogEvent;
 class Dependencies;
+class MemoryStatistics;
 class ReportReason;
 class StoryContent;
 class StoryForwardInfo;
@@ -174,6 +175,12 @@ class StoryManager final : public Actor {
     vector<Promise<Unit>> load_list_from_server_queries_;
     vector<Promise<Unit>> load_list_from_database_queries_;
 
+    // the next page of the list is requested in advance to be returned immediately when it is needed
+    string prefetch_state_;
+    telegram_api::object_ptr<telegram_api::stories_AllStories> prefetched_stories_;
+    bool is_prefetching_ = false;
+    bool is_waiting_prefetch_ = false;
+
     std::set<DialogDate> ordered_stories_;  // all known active stories from the story list
 
     DialogDate last_loaded_database_dialog_date_ = MIN_DIALOG_DATE;  // in memory
@@ -352,6 +359,8 @@ class StoryManager final : public Actor {
 
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   void on_binlog_events(vector<BinlogEvent> &&events);
 
  private:
@@ -505,10 +514,17 @@ class StoryManager final : public Actor {
   void load_active_stories_from_server(StoryListId story_list_id, StoryList &story_list, bool is_next,
                                        Promise<Unit> &&promise);
 
+  void send_get_all_stories_query(StoryListId story_list_id, StoryList &story_list, bool is_next);
+
   void on_load_active_stories_from_server(
       StoryListId story_list_id, bool is_next, string old_state,
       Result<telegram_api::object_ptr<telegram_api::stories_AllStories>> r_all_stories);
 
+  void prefetch_active_stories(StoryListId story_list_id, StoryList &story_list);
+
+  void on_prefetch_active_stories(StoryListId story_list_id,
+                                  Result<telegram_api::object_ptr<telegram_api::stories_AllStories>> r_all_stories);
+
   void save_story_list(StoryListId story_list_id, string state, int32 total_count, bool has_more);
 
   StoryList &get_story_list(StoryListId story_list_id);
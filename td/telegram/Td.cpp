@@ -86,6 +86,7 @@
 #include "td/telegram/LinkManager.h"
 #include "td/telegram/Location.h"
 #include "td/telegram/Logging.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageCopyOptions.h"
 #include "td/telegram/MessageEntity.h"
 #include "td/telegram/MessageFullId.h"
@@ -2457,6 +2458,16 @@ void Td::on_alarm_timeout(int64 alarm_id) {
     }
     return;
   }
+  if (alarm_id == MEMORY_OPTIMIZATION_ALARM_ID) {
+    if (!close_flag_) {
+      // optimize memory only while the user isn't active to avoid delays in request handling
+      if (!is_online_) {
+        run_memory_optimization();
+      }
+      schedule_memory_optimization();
+    }
+    return;
+  }
   if (close_flag_ >= 2) {
     // pending_alarms_ was already cleared
     return;
@@ -2595,6 +2606,18 @@ void Td::schedule_get_promo_data(int32 expires_in) {
   }
 }
 
+void Td::schedule_memory_optimization() {
+  alarm_timeout_.set_timeout_in(MEMORY_OPTIMIZATION_ALARM_ID,
+                                MEMORY_OPTIMIZATION_PERIOD + Random::fast(0, MEMORY_OPTIMIZATION_PERIOD / 5));
+}
+
+void Td::run_memory_optimization() {
+  LOG(INFO) << "Optimize memory usage";
+  user_manager_->optimize_memory();
+  chat_manager_->optimize_memory();
+  dialog_participant_manager_->optimize_memory();
+}
+
 bool Td::is_online() const {
   return is_online_;
 }
@@ -2685,6 +2708,7 @@ bool Td::is_synchronous_request(const td_api::Function *function) {
     case td_api::getLogTags::ID:
     case td_api::setLogTagVerbosityLevel::ID:
     case td_api::getLogTagVerbosityLevel::ID:
+    case td_api::setLogTagSampling::ID:
     case td_api::addLogMessage::ID:
     case td_api::testReturnError::ID:
       return true;
@@ -2699,6 +2723,7 @@ bool Td::is_preinitialization_request(int32 id) {
   switch (id) {
     case td_api::getCurrentState::ID:
     case td_api::setAlarm::ID:
+    case td_api::setUpdateFilter::ID:
     case td_api::testUseUpdate::ID:
     case td_api::testCallEmpty::ID:
     case td_api::testSquareInt::ID:
@@ -2734,6 +2759,7 @@ bool Td::is_preauthentication_request(int32 id) {
     case td_api::getStorageStatistics::ID:
     case td_api::getStorageStatisticsFast::ID:
     case td_api::getDatabaseStatistics::ID:
+    case td_api::getNetworkQueryStatistics::ID:
     case td_api::setNetworkType::ID:
     case td_api::getNetworkStatistics::ID:
     case td_api::addNetworkStatistics::ID:
@@ -3236,6 +3262,7 @@ void Td::clear() {
   alarm_timeout_.cancel_timeout(PING_SERVER_ALARM_ID);
   alarm_timeout_.cancel_timeout(TERMS_OF_SERVICE_ALARM_ID);
   alarm_timeout_.cancel_timeout(PROMO_DATA_ALARM_ID);
+  alarm_timeout_.cancel_timeout(MEMORY_OPTIMIZATION_ALARM_ID);
 
   auto reset_actor = [&timer](ActorOwn<Actor> actor) {
     if (!actor.empty()) {
@@ -3549,6 +3576,7 @@ void Td::init(Parameters parameters, Result<TdDb::OpenedDatabase> r_opened_datab
   VLOG(td_init) << "Finish initialization";
 
   state_ = State::Run;
+  schedule_memory_optimization();
 
   send_closure(actor_id(this), &Td::send_result, set_parameters_request_id_, td_api::make_object<td_api::ok>());
   return finish_set_parameters();
@@ -3687,6 +3715,16 @@ void Td::init_file_manager() {
       send_closure(G()->storage_manager(), &StorageManager::on_new_file, size, real_size, cnt);
     }
 
+    void on_local_file_used(const FullLocalFileLocation &location, DialogId owner_dialog_id, int64 real_size,
+                            bool is_new) final {
+      send_closure(G()->storage_manager(), &StorageManager::on_local_file_used, location.file_type_, location.path_,
+                   owner_dialog_id, real_size, location.mtime_nsec_, is_new);
+    }
+
+    void on_local_file_deleted(const string &path) final {
+      send_closure(G()->storage_manager(), &StorageManager::on_local_file_deleted, path);
+    }
+
     void on_file_updated(FileId file_id) final {
       send_closure(G()->td(), &Td::send_update,
                    make_tl_object<td_api::updateFile>(td_->file_manager_->get_file_object(file_id)));
@@ -3904,6 +3942,46 @@ void Td::init_pure_actor_managers() {
   secure_manager_ = create_actor<SecureManager>("SecureManager", create_reference());
 }
 
+template <class T>
+static auto get_update_chat_id(const T &update, int) -> decltype(static_cast<int64>(update.chat_id_)) {
+  return update.chat_id_;
+}
+
+template <class T>
+static int64 get_update_chat_id(const T &, long) {
+  return 0;
+}
+
+static int64 get_update_chat_id(const td_api::updateNewMessage &update, int) {
+  return update.message_ == nullptr ? 0 : update.message_->chat_id_;
+}
+
+bool Td::is_update_filtered(td_api::Update &update) const {
+  auto update_id = update.get_id();
+  if (update_id == td_api::updateAuthorizationState::ID || update_id == td_api::updateNewChat::ID) {
+    return false;
+  }
+  if (ignored_update_type_ids_.count(update_id) != 0) {
+    return true;
+  }
+  if (update_filter_chat_ids_.empty()) {
+    return false;
+  }
+  int64 chat_id = 0;
+  td_api::downcast_call(update, [&chat_id](const auto &update) { chat_id = get_update_chat_id(update, 0); });
+  return chat_id != 0 && update_filter_chat_ids_.count(chat_id) == 0;
+}
+
+bool Td::need_send_update(int32 update_id, int64 chat_id) const {
+  if (close_flag_ >= 5) {
+    return false;
+  }
+  if (ignored_update_type_ids_.count(update_id) != 0) {
+    return false;
+  }
+  return chat_id == 0 || update_filter_chat_ids_.empty() || update_filter_chat_ids_.count(chat_id) != 0;
+}
+
 void Td::send_update(tl_object_ptr<td_api::Update> &&object) {
   CHECK(object != nullptr);
   auto object_id = object->get_id();
@@ -3911,6 +3989,9 @@ void Td::send_update(tl_object_ptr<td_api::Update> &&object) {
     // just in case
     return;
   }
+  if ((!ignored_update_type_ids_.empty() || !update_filter_chat_ids_.empty()) && is_update_filtered(*object)) {
+    return;
+  }
 
   switch (object_id) {
     case td_api::updateAccentColors::ID:
@@ -4819,6 +4900,29 @@ void Td::on_request(uint64 id, td_api::getDatabaseStatistics &request) {
   send_closure(storage_manager_, &StorageManager::get_database_stats, std::move(query_promise));
 }
 
+void Td::on_request(uint64 id, const td_api::getMemoryStatistics &request) {
+  CREATE_REQUEST_PROMISE();
+  MemoryStatistics statistics;
+  messages_manager_->get_memory_statistics(statistics);
+  user_manager_->get_memory_statistics(statistics);
+  chat_manager_->get_memory_statistics(statistics);
+  file_manager_->get_memory_statistics(statistics);
+  stickers_manager_->get_memory_statistics(statistics);
+  story_manager_->get_memory_statistics(statistics);
+  notification_manager_->get_memory_statistics(statistics);
+  get_shared_string_pool_memory_statistics(statistics);
+  promise.set_value(statistics.get_memory_statistics_object());
+}
+
+void Td::on_request(uint64 id, const td_api::getNetworkQueryStatistics &request) {
+  if (td_options_.net_query_stats == nullptr) {
+    return send_error_raw(id, 400, "Network query statistics are unavailable");
+  }
+  CREATE_REQUEST_PROMISE();
+  promise.set_value(
+      td_api::make_object<td_api::networkQueryStatistics>(td_options_.net_query_stats->get_query_type_statistics()));
+}
+
 void Td::on_request(uint64 id, td_api::optimizeStorage &request) {
   std::vector<FileType> file_types;
   for (auto &file_type : request.file_types_) {
@@ -9309,6 +9413,26 @@ void Td::on_request(uint64 id, td_api::answerCustomQuery &request) {
   create_handler<AnswerCustomQueryQuery>(std::move(promise))->send(request.custom_query_id_, request.data_);
 }
 
+void Td::on_request(uint64 id, const td_api::setUpdateFilter &request) {
+  FlatHashSet<int64> chat_ids;
+  for (auto chat_id : request.chat_ids_) {
+    if (!DialogId(chat_id).is_valid()) {
+      return send_error_raw(id, 400, "Invalid chat identifier specified");
+    }
+    chat_ids.insert(chat_id);
+  }
+  FlatHashSet<int32> update_type_ids;
+  for (auto update_type_id : request.ignored_update_type_ids_) {
+    if (update_type_id == 0) {
+      return send_error_raw(id, 400, "Invalid update type identifier specified");
+    }
+    update_type_ids.insert(update_type_id);
+  }
+  ignored_update_type_ids_ = std::move(update_type_ids);
+  update_filter_chat_ids_ = std::move(chat_ids);
+  send_closure(actor_id(this), &Td::send_result, id, td_api::make_object<td_api::ok>());
+}
+
 void Td::on_request(uint64 id, const td_api::setAlarm &request) {
   if (request.seconds_ < 0 || request.seconds_ > 3e9) {
     return send_error_raw(id, 400, "Wrong parameter seconds specified");
@@ -9712,6 +9836,10 @@ void Td::on_request(uint64 id, const td_api::getLogTagVerbosityLevel &request) {
   UNREACHABLE();
 }
 
+void Td::on_request(uint64 id, const td_api::setLogTagSampling &request) {
+  UNREACHABLE();
+}
+
 void Td::on_request(uint64 id, const td_api::addLogMessage &request) {
   UNREACHABLE();
 }
@@ -9985,6 +10113,16 @@ td_api::object_ptr<td_api::Object> Td::do_static_request(const td_api::getLogTag
   }
 }
 
+td_api::object_ptr<td_api::Object> Td::do_static_request(const td_api::setLogTagSampling &request) {
+  auto result = Logging::set_tag_sampling(request.tag_, static_cast<int>(request.sample_rate_),
+                                          static_cast<int>(request.max_lines_per_second_));
+  if (result.is_ok()) {
+    return td_api::make_object<td_api::ok>();
+  } else {
+    return make_error(400, result.message());
+  }
+}
+
 td_api::object_ptr<td_api::Object> Td::do_static_request(const td_api::addLogMessage &request) {
   Logging::add_message(request.verbosity_level_, request.text_);
   return td_api::make_object<td_api::ok>();
@@ -26,6 +26,7 @@
 #include "td/utils/common.h"
 #include "td/utils/Container.h"
 #include "td/utils/FlatHashMap.h"
+#include "td/utils/FlatHashSet.h"
 #include "td/utils/logging.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
@@ -329,6 +330,12 @@ class Td final : public Actor {
 
   void send_update(tl_object_ptr<td_api::Update> &&object);
 
+  bool is_update_filtered(td_api::Update &update) const;
+
+  // returns false if an update of the given type in the chat would be dropped by the update filter,
+  // so its creation can be skipped
+  bool need_send_update(int32 update_id, int64 chat_id) const;
+
   static td_api::object_ptr<td_api::Object> static_request(td_api::object_ptr<td_api::Function> function);
 
  private:
@@ -337,6 +344,8 @@ class Td final : public Actor {
   static constexpr int32 PING_SERVER_TIMEOUT = 300;
   static constexpr int64 TERMS_OF_SERVICE_ALARM_ID = -2;
   static constexpr int64 PROMO_DATA_ALARM_ID = -3;
+  static constexpr int64 MEMORY_OPTIMIZATION_ALARM_ID = -4;
+  static constexpr int32 MEMORY_OPTIMIZATION_PERIOD = 600;
 
   void on_connection_state_changed(ConnectionState new_state);
 
@@ -395,6 +404,9 @@ class Td final : public Actor {
   FlatHashMap<int64, uint64> pending_alarms_;
   MultiTimeout alarm_timeout_{"AlarmTimeout"};
 
+  FlatHashSet<int32> ignored_update_type_ids_;
+  FlatHashSet<int64> update_filter_chat_ids_;  // if non-empty, then only updates in the chats are sent
+
   TermsOfService pending_terms_of_service_;
 
   struct DownloadInfo {
@@ -450,6 +462,10 @@ class Td final : public Actor {
 
   void schedule_get_promo_data(int32 expires_in);
 
+  void schedule_memory_optimization();
+
+  void run_memory_optimization();
+
   static int *get_log_verbosity_level(Slice name);
 
   template <class T>
@@ -674,6 +690,10 @@ class Td final : public Actor {
 
   void on_request(uint64 id, td_api::getDatabaseStatistics &request);
 
+  void on_request(uint64 id, const td_api::getMemoryStatistics &request);
+
+  void on_request(uint64 id, const td_api::getNetworkQueryStatistics &request);
+
   void on_request(uint64 id, td_api::optimizeStorage &request);
 
   void on_request(uint64 id, td_api::getNetworkStatistics &request);
@@ -1822,6 +1842,8 @@ class Td final : public Actor {
 
   void on_request(uint64 id, const td_api::setAlarm &request);
 
+  void on_request(uint64 id, const td_api::setUpdateFilter &request);
+
   void on_request(uint64 id, td_api::searchHashtags &request);
 
   void on_request(uint64 id, td_api::removeRecentHashtag &request);
@@ -1950,6 +1972,8 @@ class Td final : public Actor {
 
   void on_request(uint64 id, const td_api::getLogTagVerbosityLevel &request);
 
+  void on_request(uint64 id, const td_api::setLogTagSampling &request);
+
   void on_request(uint64 id, const td_api::addLogMessage &request);
 
   // test
@@ -1997,6 +2021,7 @@ class Td final : public Actor {
   static td_api::object_ptr<td_api::Object> do_static_request(const td_api::getLogTags &request);
   static td_api::object_ptr<td_api::Object> do_static_request(const td_api::setLogTagVerbosityLevel &request);
   static td_api::object_ptr<td_api::Object> do_static_request(const td_api::getLogTagVerbosityLevel &request);
+  static td_api::object_ptr<td_api::Object> do_static_request(const td_api::setLogTagSampling &request);
   static td_api::object_ptr<td_api::Object> do_static_request(const td_api::addLogMessage &request);
   static td_api::object_ptr<td_api::Object> do_static_request(td_api::testReturnError &request);
 
@@ -29,6 +29,7 @@
 #include "td/actor/actor.h"
 #include "td/actor/MultiPromise.h"
 
+#include "td/utils/algorithm.h"
 #include "td/utils/common.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
@@ -179,6 +180,17 @@ Status init_binlog(Binlog &binlog, string path, BinlogKeyValue<Binlog> &binlog_p
   return Status::OK();
 }
 
+vector<int32> get_message_db_reader_scheduler_ids() {
+  vector<int32> result;
+  auto database_scheduler_id = G()->get_database_scheduler_id();
+  for (auto scheduler_id : {G()->get_gc_scheduler_id(), G()->get_slow_net_scheduler_id()}) {
+    if (scheduler_id != database_scheduler_id && !td::contains(result, scheduler_id)) {
+      result.push_back(scheduler_id);
+    }
+  }
+  return result;
+}
+
 }  // namespace
 
 std::shared_ptr<FileDbInterface> TdDb::get_file_db_shared() {
@@ -289,7 +301,13 @@ void TdDb::do_close(bool destroy_flag, Promise<Unit> on_finished) {
   }
   MultiPromiseActorSafe mpas{"TdDbCloseMultiPromiseActor"};
   mpas.add_promise(PromiseCreator::lambda(
-      [promise = std::move(on_finished), sql_connection = std::move(sql_connection_), destroy_flag](Unit) mutable {
+      [promise = std::move(on_finished), sql_connection = std::move(sql_connection_),
+       sql_read_connection = std::move(sql_read_connection_), destroy_flag](Unit) mutable {
+        if (sql_read_connection) {
+          LOG_CHECK(sql_read_connection.unique()) << sql_read_connection.use_count();
+          sql_read_connection->close();
+          sql_read_connection.reset();
+        }
         if (sql_connection) {
           LOG_CHECK(sql_connection.unique()) << sql_connection.use_count();
           if (destroy_flag) {
@@ -378,6 +396,8 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
   auto &db = sql_connection_->get();
   TRY_STATUS(db.exec("PRAGMA journal_mode=WAL"));
   TRY_STATUS(db.exec("PRAGMA secure_delete=1"));
+  // has effect only for new databases; allows to free pages in the background with DatabaseMaintenanceWorker
+  TRY_STATUS(db.exec("PRAGMA auto_vacuum=INCREMENTAL"));
 
   // Init databases
   // Do initialization once and before everything else to avoid "database is locked" error.
@@ -481,7 +501,17 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
 
   if (use_message_database) {
     message_db_sync_safe_ = create_message_db_sync(sql_connection_);
-    message_db_async_ = create_message_db_async(message_db_sync_safe_);
+    auto reader_scheduler_ids = get_message_db_reader_scheduler_ids();
+    if (reader_scheduler_ids.empty()) {
+      message_db_async_ = create_message_db_async(message_db_sync_safe_);
+    } else {
+      // reads are done through separate read-only connections to not wait for writes on the database scheduler
+      sql_read_connection_ = std::make_shared<SqliteConnectionSafe>(sql_database_path, key,
+                                                                    sql_connection_->get().get_cipher_version(), true);
+      message_db_async_ =
+          create_message_db_async(message_db_sync_safe_, -1, create_message_db_sync(sql_read_connection_),
+                                  std::move(reader_scheduler_ids));
+    }
   }
 
   if (use_story_database) {
@@ -751,7 +781,13 @@ Result<string> TdDb::get_stats() {
   }
   sb << "Max file database depth out of " << prev.size() << '/' << count
      << " elements: " << *std::max_element(prev.begin(), prev.end()) << "\n";
-  sb << "Have " << bad_count << " forward references with maximum reference to " << max_bad_to;
+  sb << "Have " << bad_count << " forward references with maximum reference to " << max_bad_to << "\n";
+
+  TRY_RESULT(page_count, sql.get_pragma("page_count"));
+  TRY_RESULT(free_page_count, sql.get_pragma("freelist_count"));
+  TRY_RESULT(auto_vacuum, sql.get_pragma("auto_vacuum"));
+  sb << "Have " << free_page_count << " free pages out of " << page_count
+     << " database pages with auto_vacuum = " << auto_vacuum;
 
   return sb.as_cslice().str();
 }
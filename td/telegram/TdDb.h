@@ -160,6 +160,7 @@ class TdDb {
   bool was_dialog_db_created_ = false;
 
   std::shared_ptr<SqliteConnectionSafe> sql_connection_;
+  std::shared_ptr<SqliteConnectionSafe> sql_read_connection_;
 
   std::shared_ptr<FileDbInterface> file_db_;
 
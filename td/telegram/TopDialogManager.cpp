@@ -54,9 +54,11 @@ class GetTopPeersQuery final : public Td::ResultHandler {
         telegram_api::contacts_getTopPeers::BOTS_INLINE_MASK | telegram_api::contacts_getTopPeers::GROUPS_MASK |
         telegram_api::contacts_getTopPeers::CHANNELS_MASK | telegram_api::contacts_getTopPeers::PHONE_CALLS_MASK |
         telegram_api::contacts_getTopPeers::FORWARD_USERS_MASK | telegram_api::contacts_getTopPeers::FORWARD_CHATS_MASK;
-    send_query(G()->net_query_creator().create(telegram_api::contacts_getTopPeers(
+    auto query = G()->net_query_creator().create(telegram_api::contacts_getTopPeers(
         flags, false /*ignored*/, false /*ignored*/, false /*ignored*/, false /*ignored*/, false /*ignored*/,
-        false /*ignored*/, false /*ignored*/, false /*ignored*/, 0 /*offset*/, 100 /*limit*/, hash)));
+        false /*ignored*/, false /*ignored*/, false /*ignored*/, 0 /*offset*/, 100 /*limit*/, hash));
+    query->set_priority(NetQuery::BACKGROUND_PRIORITY);
+    send_query(std::move(query));
   }
 
   void on_result(BufferSlice packet) final {
@@ -384,7 +384,7 @@ void UpdatesManager::fill_pts_gap(void *td) {
       min_pts_count = min_update.pts_count;
       first_update = min_update.update.get();
     }
-    max_pts = max(max_pts, updates_manager->pending_pts_updates_.rbegin()->pts);
+    max_pts = max(max_pts, updates_manager->pending_pts_updates_.back().pts);
   }
   if (!updates_manager->postponed_pts_updates_.empty()) {
     auto &min_update = *updates_manager->postponed_pts_updates_.begin();
@@ -393,7 +393,7 @@ void UpdatesManager::fill_pts_gap(void *td) {
       min_pts_count = min_update.pts_count;
       first_update = min_update.update.get();
     }
-    max_pts = max(max_pts, updates_manager->postponed_pts_updates_.rbegin()->pts);
+    max_pts = max(max_pts, updates_manager->postponed_pts_updates_.back().pts);
   }
   updates_manager->pts_gap_++;
   fill_gap(td, PSTRING() << "PTS from " << updates_manager->get_pts() << " to " << min_pts << "(-" << min_pts_count
@@ -412,7 +412,7 @@ void UpdatesManager::fill_seq_gap(void *td) {
   auto max_seq = 0;
   if (!updates_manager->pending_seq_updates_.empty()) {
     min_seq = updates_manager->pending_seq_updates_.begin()->seq_begin;
-    max_seq = updates_manager->pending_seq_updates_.rbegin()->seq_end;
+    max_seq = updates_manager->pending_seq_updates_.back().seq_end;
   }
   fill_gap(td, PSTRING() << "seq from " << updates_manager->seq_ << " to " << min_seq << '-' << max_seq);
 }
@@ -511,18 +511,33 @@ void UpdatesManager::run_get_difference(bool is_recursive, const char *source) {
     min_postponed_update_qts_ = 0;
   }
 
-  auto promise = PromiseCreator::lambda([](Result<tl_object_ptr<telegram_api::updates_Difference>> result) {
-    if (result.is_ok()) {
-      send_closure(G()->updates_manager(), &UpdatesManager::on_get_difference, result.move_as_ok());
-    } else {
-      send_closure(G()->updates_manager(), &UpdatesManager::on_failed_get_difference, result.move_as_error());
-    }
-  });
-  td_->create_handler<GetDifferenceQuery>(std::move(promise))->send(pts, date, qts);
+  if (prefetched_get_difference_query_id_ != 0 && prefetched_get_difference_pts_ == pts &&
+      prefetched_get_difference_date_ == date && prefetched_get_difference_qts_ == qts) {
+    VLOG(get_difference) << "Wait for the prefetched getDifference";
+    get_difference_query_id_ = prefetched_get_difference_query_id_;
+  } else {
+    get_difference_query_id_ = send_get_difference_query(pts, date, qts);
+  }
+  prefetched_get_difference_query_id_ = 0;
   last_confirmed_pts_ = pts;
   last_confirmed_qts_ = qts;
 }
 
+uint64 UpdatesManager::send_get_difference_query(int32 pts, int32 date, int32 qts) {
+  auto query_id = ++last_get_difference_query_id_;
+  auto promise =
+      PromiseCreator::lambda([query_id](Result<tl_object_ptr<telegram_api::updates_Difference>> result) {
+        if (result.is_ok()) {
+          send_closure(G()->updates_manager(), &UpdatesManager::on_get_difference, query_id, result.move_as_ok());
+        } else {
+          send_closure(G()->updates_manager(), &UpdatesManager::on_failed_get_difference, query_id,
+                       result.move_as_error());
+        }
+      });
+  td_->create_handler<GetDifferenceQuery>(std::move(promise))->send(pts, date, qts);
+  return query_id;
+}
+
 void UpdatesManager::before_get_difference(bool is_initial) {
   // may be called many times before after_get_difference is called
   send_closure(G()->state_manager(), &StateManager::on_synchronized, false);
@@ -1272,10 +1287,14 @@ void UpdatesManager::on_failed_get_updates_state(Status &&error) {
   schedule_get_difference("on_failed_get_updates_state");
 }
 
-void UpdatesManager::on_failed_get_difference(Status &&error) {
+void UpdatesManager::on_failed_get_difference(uint64 query_id, Status &&error) {
   if (G()->close_flag() || !td_->auth_manager_->is_authorized()) {
     return;
   }
+  if (query_id != get_difference_query_id_) {
+    VLOG(get_difference) << "Ignore error of unneeded getDifference: " << error;
+    return;
+  }
   if (error.code() != 401) {
     LOG(ERROR) << "Receive updates.getDifference error: " << error;
   }
@@ -1872,10 +1891,15 @@ void UpdatesManager::process_get_difference_updates(
   process_updates(std::move(other_updates), true, Promise<Unit>());
 }
 
-void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Difference> &&difference_ptr) {
+void UpdatesManager::on_get_difference(uint64 query_id,
+                                       tl_object_ptr<telegram_api::updates_Difference> &&difference_ptr) {
   if (G()->close_flag() || !td_->auth_manager_->is_authorized()) {
     return;
   }
+  if (query_id != get_difference_query_id_) {
+    VLOG(get_difference) << "Ignore result of unneeded getDifference";
+    return;
+  }
 
   VLOG(get_difference) << "----- END  GET DIFFERENCE-----";
   running_get_difference_ = false;
@@ -1944,11 +1968,6 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
     case telegram_api::updates_differenceSlice::ID: {
       auto difference = move_tl_object_as<telegram_api::updates_differenceSlice>(difference_ptr);
       bool is_pts_changed = have_update_pts_changed(difference->other_updates_);
-      if (difference->intermediate_state_->pts_ >= get_pts() && get_pts() != std::numeric_limits<int32>::max() &&
-          difference->intermediate_state_->date_ >= date_ && difference->intermediate_state_->qts_ == get_qts() &&
-          !is_pts_changed) {
-        // TODO send new getDifference request and apply difference slice only after that
-      }
 
       VLOG(get_difference) << "In get difference receive " << difference->users_.size() << " users and "
                            << difference->chats_.size() << " chats";
@@ -1966,6 +1985,19 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
         }
       }
 
+      const auto &state = difference->intermediate_state_;
+      if (state->pts_ >= get_pts() && get_pts() != std::numeric_limits<int32>::max() && state->date_ >= date_ &&
+          state->qts_ == get_qts() && !is_pts_changed) {
+        // send the next getDifference request now to receive the next slice while the current one is applied;
+        // the request will be used if the state after applying of the slice is equal to the intermediate state
+        prefetched_get_difference_query_id_ = send_get_difference_query(state->pts_, state->date_, state->qts_);
+        prefetched_get_difference_pts_ = state->pts_;
+        prefetched_get_difference_date_ = state->date_;
+        prefetched_get_difference_qts_ = state->qts_;
+        VLOG(get_difference) << "Prefetch getDifference with PTS = " << state->pts_ << ", QTS = " << state->qts_
+                             << ", date = " << state->date_;
+      }
+
       process_get_difference_updates(std::move(difference->new_messages_),
                                      std::move(difference->new_encrypted_messages_),
                                      std::move(difference->other_updates_));
@@ -2013,6 +2045,7 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
     default:
       UNREACHABLE();
   }
+  prefetched_get_difference_query_id_ = 0;  // the prefetched query result must be ignored if it wasn't used
 
   get_difference_retry_count_ = 0;
 
@@ -2141,14 +2174,13 @@ void UpdatesManager::after_get_difference() {
     VLOG(get_difference) << "Begin to apply " << chunk_count << " postponed update chunks";
     size_t total_update_count = 0;
     while (!postponed_updates_.empty()) {
-      auto it = postponed_updates_.begin();
-      auto updates = std::move(it->updates);
-      auto updates_seq_begin = it->seq_begin;
-      auto updates_seq_end = it->seq_end;
-      auto receive_time = it->receive_time;
-      auto promise = std::move(it->promise);
-      // ignore it->date, because it may be too old
-      postponed_updates_.erase(it);
+      auto postponed_update = postponed_updates_.pop_front();
+      auto updates = std::move(postponed_update.updates);
+      auto updates_seq_begin = postponed_update.seq_begin;
+      auto updates_seq_end = postponed_update.seq_end;
+      auto receive_time = postponed_update.receive_time;
+      auto promise = std::move(postponed_update.promise);
+      // ignore postponed_update.date, because it may be too old
       auto update_count = updates.size();
       on_pending_updates(std::move(updates), updates_seq_begin, updates_seq_end, 0, receive_time, std::move(promise),
                          "postponed updates");
@@ -3154,16 +3186,16 @@ void UpdatesManager::process_postponed_pts_updates() {
   auto old_pts = initial_pts;
   int32 skipped_update_count = 0;
   int32 applied_update_count = 0;
-  auto update_it = postponed_pts_updates_.begin();
-  while (update_it != postponed_pts_updates_.end()) {
+  while (!postponed_pts_updates_.empty()) {
+    auto update_it = postponed_pts_updates_.begin();
     auto new_pts = update_it->pts;
     auto pts_count = update_it->pts_count;
     if (new_pts <= old_pts || (old_pts >= 1 && new_pts - (1 << 30) > old_pts)) {
       skipped_update_count++;
-      td_->messages_manager_->skip_old_pending_pts_update(std::move(update_it->update), new_pts, old_pts, pts_count,
+      auto update = postponed_pts_updates_.pop_front();
+      td_->messages_manager_->skip_old_pending_pts_update(std::move(update.update), new_pts, old_pts, pts_count,
                                                           "process_postponed_pts_updates");
-      update_it->promise.set_value(Unit());
-      update_it = postponed_pts_updates_.erase(update_it);
+      update.promise.set_value(Unit());
       continue;
     }
 
@@ -3172,40 +3204,39 @@ void UpdatesManager::process_postponed_pts_updates() {
       break;
     }
 
-    auto last_update_it = update_it;
+    size_t update_count = 0;
     for (int32 i = 1; true; i++) {
-      ++last_update_it;
       if (old_pts == new_pts - pts_count) {
         // the updates can be applied
+        update_count = i;
         break;
       }
-      if (old_pts > new_pts - pts_count || last_update_it == postponed_pts_updates_.end() ||
+      if (old_pts > new_pts - pts_count || update_it + i == postponed_pts_updates_.end() ||
           i == GAP_TIMEOUT_UPDATE_COUNT) {
         // the updates can't be applied
         VLOG(get_difference) << "Can't apply " << i << " next postponed updates with PTS " << update_it->pts << '-'
                              << new_pts << ", because their pts_count is " << pts_count << " instead of expected "
                              << new_pts - old_pts;
-        last_update_it = update_it;
         break;
       }
 
-      new_pts = last_update_it->pts;
-      pts_count += last_update_it->pts_count;
+      new_pts = update_it[i].pts;
+      pts_count += update_it[i].pts_count;
     }
 
-    if (last_update_it == update_it) {
+    if (update_count == 0) {
       // the updates will be applied or skipped later
       break;
     }
     CHECK(old_pts == new_pts - pts_count);
 
-    while (update_it != last_update_it) {
-      if (update_it->pts_count > 0) {
+    for (size_t i = 0; i < update_count; i++) {
+      auto update = postponed_pts_updates_.pop_front();
+      if (update.pts_count > 0) {
         applied_update_count++;
-        td_->messages_manager_->process_pts_update(std::move(update_it->update));
+        td_->messages_manager_->process_pts_update(std::move(update.update));
       }
-      update_it->promise.set_value(Unit());
-      update_it = postponed_pts_updates_.erase(update_it);
+      update.promise.set_value(Unit());
     }
     old_pts = new_pts;
   }
@@ -3238,13 +3269,13 @@ void UpdatesManager::process_pending_pts_updates() {
   auto initial_pts = get_pts();
   int32 applied_update_count = 0;
   while (!pending_pts_updates_.empty()) {
-    auto update_it = pending_pts_updates_.begin();
-    auto &update = *update_it;
-    if (get_pts() != update.pts - update.pts_count) {
+    const auto &first_update = pending_pts_updates_.front();
+    if (get_pts() != first_update.pts - first_update.pts_count) {
       // the updates will be applied or skipped later
       break;
     }
 
+    auto update = pending_pts_updates_.pop_front();
     applied_update_count++;
     if (update.pts_count > 0) {
       td_->messages_manager_->process_pts_update(std::move(update.update));
@@ -3260,7 +3291,6 @@ void UpdatesManager::process_pending_pts_updates() {
       LOG(INFO) << "Skip because of pts_count == 0 " << to_string(update.update);
     }
     update.promise.set_value(Unit());
-    pending_pts_updates_.erase(update_it);
   }
   if (applied_update_count > 0) {
     min_pts_gap_timeout_.cancel_timeout();
@@ -3297,14 +3327,13 @@ void UpdatesManager::process_pending_seq_updates() {
   int32 initial_seq = seq_;
   int32 applied_update_count = 0;
   while (!pending_seq_updates_.empty() && !running_get_difference_) {
-    auto update_it = pending_seq_updates_.begin();
-    auto &update = *update_it;
-    auto seq_begin = update.seq_begin;
+    auto seq_begin = pending_seq_updates_.front().seq_begin;
     if (seq_begin - 1 > seq_ && seq_begin - (1 << 30) <= seq_) {
       // the updates will be applied later
       break;
     }
 
+    auto update = pending_seq_updates_.pop_front();
     applied_update_count++;
     auto seq_end = update.seq_end;
     if (seq_begin - 1 == seq_) {
@@ -3318,7 +3347,6 @@ void UpdatesManager::process_pending_seq_updates() {
       }
       update.promise.set_value(Unit());
     }
-    pending_seq_updates_.erase(update_it);
   }
   if (pending_seq_updates_.empty() || applied_update_count > 0) {
     seq_gap_timeout_.cancel_timeout();
@@ -27,9 +27,10 @@
 #include "td/utils/Status.h"
 #include "td/utils/tl_storers.h"
 #include "td/utils/TlStorerToString.h"
+#include "td/utils/VectorQueue.h"
 
+#include <algorithm>
 #include <map>
-#include <set>
 #include <utility>
 
 namespace td {
@@ -151,13 +152,85 @@ class UpdatesManager final : public Actor {
 
   friend class OnUpdate;
 
+  // queue of updates ordered by operator<; updates with equal keys are kept in the order of addition
+  // updates are expected to be added mostly in order, so they are appended to a VectorQueue and
+  // only the unordered tail is sorted and merged on the next access instead of allocating a node per update
+  template <class T>
+  class PendingUpdateQueue {
+   public:
+    template <class... ArgsT>
+    void emplace(ArgsT &&...args) {
+      queue_.emplace(std::forward<ArgsT>(args)...);
+      auto size = queue_.size();
+      if (sorted_size_ + 1 == size && (size == 1 || !(queue_.back() < queue_.data()[size - 2]))) {
+        sorted_size_ = size;
+      }
+    }
+
+    bool empty() const {
+      return queue_.empty();
+    }
+
+    size_t size() const {
+      return queue_.size();
+    }
+
+    T &front() {
+      sort();
+      return queue_.front();
+    }
+
+    T &back() {
+      sort();
+      return queue_.back();
+    }
+
+    T pop_front() {
+      sort();
+      sorted_size_--;
+      return queue_.pop();
+    }
+
+    // iterators are invalidated by any change of the queue
+    T *begin() {
+      sort();
+      return queue_.data();
+    }
+
+    T *end() {
+      sort();
+      return queue_.data() + queue_.size();
+    }
+
+    void clear() {
+      queue_ = VectorQueue<T>();
+      sorted_size_ = 0;
+    }
+
+   private:
+    VectorQueue<T> queue_;
+    size_t sorted_size_ = 0;
+
+    void sort() {
+      if (sorted_size_ == queue_.size()) {
+        return;
+      }
+      auto first = queue_.data();
+      auto middle = first + sorted_size_;
+      auto last = first + queue_.size();
+      std::stable_sort(middle, last);
+      std::inplace_merge(first, middle, last);
+      sorted_size_ = queue_.size();
+    }
+  };
+
   class PendingPtsUpdate {
    public:
-    mutable tl_object_ptr<telegram_api::Update> update;
+    tl_object_ptr<telegram_api::Update> update;
     int32 pts;
     int32 pts_count;
     double receive_time;
-    mutable Promise<Unit> promise;
+    Promise<Unit> promise;
 
     PendingPtsUpdate(tl_object_ptr<telegram_api::Update> &&update, int32 pts, int32 pts_count, double receive_time,
                      Promise<Unit> &&promise)
@@ -182,8 +255,8 @@ class UpdatesManager final : public Actor {
     int32 seq_end;
     int32 date;
     double receive_time;
-    mutable vector<tl_object_ptr<telegram_api::Update>> updates;
-    mutable Promise<Unit> promise;
+    vector<tl_object_ptr<telegram_api::Update>> updates;
+    Promise<Unit> promise;
 
     PendingSeqUpdates(int32 seq_begin, int32 seq_end, int32 date, double receive_time,
                       vector<tl_object_ptr<telegram_api::Update>> &&updates, Promise<Unit> &&promise)
@@ -243,11 +316,11 @@ class UpdatesManager final : public Actor {
   double last_pts_jump_warning_time_ = 0;
   double last_pts_gap_time_ = 0;
 
-  std::multiset<PendingPtsUpdate> pending_pts_updates_;
-  std::multiset<PendingPtsUpdate> postponed_pts_updates_;
+  PendingUpdateQueue<PendingPtsUpdate> pending_pts_updates_;
+  PendingUpdateQueue<PendingPtsUpdate> postponed_pts_updates_;
 
-  std::multiset<PendingSeqUpdates> postponed_updates_;    // updates received during getDifference
-  std::multiset<PendingSeqUpdates> pending_seq_updates_;  // updates with too big seq
+  PendingUpdateQueue<PendingSeqUpdates> postponed_updates_;    // updates received during getDifference
+  PendingUpdateQueue<PendingSeqUpdates> pending_seq_updates_;  // updates with too big seq
 
   std::map<int32, PendingQtsUpdate> pending_qts_updates_;  // updates with too big QTS
 
@@ -275,6 +348,15 @@ class UpdatesManager final : public Actor {
   double get_difference_start_time_ = 0;  // time from which we started to get difference without success
   int32 get_difference_retry_count_ = 0;
 
+  uint64 last_get_difference_query_id_ = 0;
+  uint64 get_difference_query_id_ = 0;  // identifier of the query, which result is awaited
+
+  // the next getDifference query sent before applying of a difference slice
+  uint64 prefetched_get_difference_query_id_ = 0;
+  int32 prefetched_get_difference_pts_ = 0;
+  int32 prefetched_get_difference_date_ = 0;
+  int32 prefetched_get_difference_qts_ = 0;
+
   struct SessionInfo {
     uint64 update_count = 0;
     double first_update_time = 0.0;
@@ -333,7 +415,9 @@ class UpdatesManager final : public Actor {
 
   void on_server_pong(tl_object_ptr<telegram_api::updates_state> &&state);
 
-  void on_get_difference(tl_object_ptr<telegram_api::updates_Difference> &&difference_ptr);
+  uint64 send_get_difference_query(int32 pts, int32 date, int32 qts);
+
+  void on_get_difference(uint64 query_id, tl_object_ptr<telegram_api::updates_Difference> &&difference_ptr);
 
   void process_get_difference_updates(vector<tl_object_ptr<telegram_api::Message>> &&new_messages,
                                       vector<tl_object_ptr<telegram_api::EncryptedMessage>> &&new_encrypted_messages,
@@ -402,7 +486,7 @@ class UpdatesManager final : public Actor {
 
   void on_failed_get_updates_state(Status &&error);
 
-  void on_failed_get_difference(Status &&error);
+  void on_failed_get_difference(uint64 query_id, Status &&error);
 
   void before_get_difference(bool is_initial);
 
@@ -37,6 +37,7 @@
 #include "td/telegram/LinkManager.h"
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/logevent/LogEventHelper.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageId.h"
 #include "td/telegram/MessagesManager.h"
 #include "td/telegram/MessageTtl.h"
@@ -2074,13 +2075,56 @@ void UserManager::on_user_online_timeout(UserId user_id) {
   CHECK(u->is_update_user_sent);
 
   LOG(INFO) << "Update " << user_id << " online status to offline";
-  send_closure(G()->td(), &Td::send_update,
-               td_api::make_object<td_api::updateUserStatus>(user_id.get(),
-                                                             get_user_status_object(user_id, u, G()->unix_time())));
+  send_update_user_status(user_id, u);
 
   td_->dialog_participant_manager_->update_user_online_member_count(user_id);
 }
 
+void UserManager::send_update_user_status(UserId user_id, const User *u) {
+  auto delay = td_->option_manager_->get_option_integer("user_status_update_delay");
+  if (delay <= 0 || user_id == get_my_id()) {
+    if (!pending_user_status_updates_.empty()) {
+      pending_user_status_updates_.erase(user_id);
+    }
+    send_closure(G()->td(), &Td::send_update,
+                 td_api::make_object<td_api::updateUserStatus>(user_id.get(),
+                                                               get_user_status_object(user_id, u, G()->unix_time())));
+    return;
+  }
+
+  // only the last status of the user will be sent
+  pending_user_status_updates_.insert(user_id);
+  if (!pending_user_status_updates_timeout_.has_timeout()) {
+    pending_user_status_updates_timeout_.set_callback(send_pending_user_status_updates_static);
+    pending_user_status_updates_timeout_.set_callback_data(static_cast<void *>(this));
+    pending_user_status_updates_timeout_.set_timeout_in(static_cast<double>(delay));
+  }
+}
+
+void UserManager::send_pending_user_status_updates_static(void *user_manager) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  CHECK(user_manager != nullptr);
+  static_cast<UserManager *>(user_manager)->send_pending_user_status_updates();
+}
+
+void UserManager::send_pending_user_status_updates() {
+  FlatHashSet<UserId, UserIdHash> user_ids;
+  std::swap(user_ids, pending_user_status_updates_);
+  LOG(INFO) << "Send " << user_ids.size() << " postponed user status updates";
+  auto unix_time = G()->unix_time();
+  for (auto user_id : user_ids) {
+    const User *u = get_user(user_id);
+    CHECK(u != nullptr);
+    CHECK(u->is_update_user_sent);
+    send_closure(G()->td(), &Td::send_update,
+                 td_api::make_object<td_api::updateUserStatus>(user_id.get(),
+                                                               get_user_status_object(user_id, u, unix_time)));
+  }
+}
+
 void UserManager::on_user_emoji_status_timeout_callback(void *user_manager_ptr, int64 user_id_long) {
   if (G()->close_flag()) {
     return;
@@ -2541,6 +2585,7 @@ void UserManager::on_get_user(telegram_api::object_ptr<telegram_api::User> &&use
 }
 
 void UserManager::on_get_users(vector<telegram_api::object_ptr<telegram_api::User>> &&users, const char *source) {
+  preload_users_from_database(users);
   for (auto &user : users) {
     on_get_user(std::move(user), source);
   }
@@ -3759,6 +3804,46 @@ void UserManager::on_load_user_from_database(UserId user_id, string value, bool
   set_promises(promises);
 }
 
+void UserManager::preload_users_from_database(const vector<telegram_api::object_ptr<telegram_api::User>> &users) {
+  if (!G()->use_chat_info_database() || users.size() <= 1) {
+    return;
+  }
+
+  // find users, which will be synchronously loaded from the database by on_get_user
+  vector<UserId> user_ids;
+  for (auto &user_ptr : users) {
+    UserId user_id;
+    if (user_ptr->get_id() == telegram_api::userEmpty::ID) {
+      user_id = UserId(static_cast<const telegram_api::userEmpty *>(user_ptr.get())->id_);
+    } else {
+      CHECK(user_ptr->get_id() == telegram_api::user::ID);
+      auto user = static_cast<const telegram_api::user *>(user_ptr.get());
+      bool is_received = (user->flags_ & USER_FLAG_IS_INACCESSIBLE) == 0;
+      bool is_contact = (user->flags_ & USER_FLAG_IS_CONTACT) != 0;
+      if (is_received && (!is_contact || are_contacts_loaded_)) {
+        continue;
+      }
+      user_id = UserId(user->id_);
+    }
+    if (user_id.is_valid() && get_user(user_id) == nullptr && loaded_from_database_users_.count(user_id) == 0) {
+      user_ids.push_back(user_id);
+    }
+  }
+  if (user_ids.size() <= 1) {
+    return;
+  }
+
+  LOG(INFO) << "Preload " << user_ids.size() << " users from database";
+  auto *pmc = G()->td_db()->get_sqlite_sync_pmc();
+  // all lookups are done in one read transaction, which is much faster than a transaction per lookup
+  pmc->begin_read_transaction().ensure();
+  auto values = transform(user_ids, [pmc](UserId user_id) { return pmc->get(get_user_database_key(user_id)); });
+  pmc->commit_transaction().ensure();
+  for (size_t i = 0; i < user_ids.size(); i++) {
+    on_load_user_from_database(user_ids[i], std::move(values[i]), true);
+  }
+}
+
 bool UserManager::have_user_force(UserId user_id, const char *source) {
   return get_user_force(user_id, source) != nullptr;
 }
@@ -7622,15 +7707,17 @@ void UserManager::update_user(User *u, UserId user_id, bool from_binlog, bool fr
     u->is_changed = false;
     u->is_status_changed = false;
     u->is_update_user_sent = true;
+    if (!pending_user_status_updates_.empty()) {
+      // updateUser contains the current user status
+      pending_user_status_updates_.erase(user_id);
+    }
   }
   if (u->is_status_changed) {
     if (!from_database) {
       u->is_status_saved = false;
     }
     CHECK(u->is_update_user_sent);
-    send_closure(
-        G()->td(), &Td::send_update,
-        td_api::make_object<td_api::updateUserStatus>(user_id.get(), get_user_status_object(user_id, u, unix_time)));
+    send_update_user_status(user_id, u);
     u->is_status_changed = false;
   }
   if (u->is_online_status_changed) {
@@ -8048,6 +8135,39 @@ td_api::object_ptr<td_api::secretChat> UserManager::get_secret_chat_object_const
                                                  secret_chat->is_outbound, secret_chat->key_hash, secret_chat->layer);
 }
 
+void UserManager::optimize_memory() {
+  users_.shrink_to_fit();
+  users_full_.shrink_to_fit();
+  user_photos_.shrink_to_fit();
+  pending_user_photos_.shrink_to_fit();
+  user_profile_photo_file_source_ids_.shrink_to_fit();
+  user_full_file_source_ids_.shrink_to_fit();
+  secret_chats_.shrink_to_fit();
+  secret_chats_with_user_.shrink_to_fit();
+  loaded_from_database_users_.shrink_to_fit();
+  unavailable_user_fulls_.shrink_to_fit();
+  for (auto &it : user_messages_) {
+    it.second.shrink_to_fit();
+  }
+  user_messages_.shrink_to_fit();
+  resolved_phone_numbers_.shrink_to_fit();
+  restricted_user_ids_.shrink_to_fit();
+}
+
+void UserManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  statistics.add("UserManager", "users", users_.calc_size(), sizeof(UserId) + sizeof(unique_ptr<User>) + sizeof(User));
+  statistics.add("UserManager", "users_full", users_full_.calc_size(),
+                 sizeof(UserId) + sizeof(unique_ptr<UserFull>) + sizeof(UserFull));
+  statistics.add("UserManager", "user_photos", user_photos_.calc_size(),
+                 sizeof(UserId) + sizeof(unique_ptr<UserPhotos>) + sizeof(UserPhotos));
+  statistics.add("UserManager", "secret_chats", secret_chats_.calc_size(),
+                 sizeof(SecretChatId) + sizeof(unique_ptr<SecretChat>) + sizeof(SecretChat));
+  statistics.add("UserManager", "user_messages", user_messages_.size(),
+                 sizeof(UserId) + sizeof(FlatHashSet<MessageFullId, MessageFullIdHash>));
+  statistics.add("UserManager", "resolved_phone_numbers", resolved_phone_numbers_.size(),
+                 sizeof(string) + sizeof(UserId));
+}
+
 void UserManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   for (auto user_id : unknown_users_) {
     if (!have_min_user(user_id)) {
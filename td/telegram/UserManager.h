@@ -37,6 +37,7 @@
 #include "td/actor/actor.h"
 #include "td/actor/MultiPromise.h"
 #include "td/actor/MultiTimeout.h"
+#include "td/actor/Timeout.h"
 
 #include "td/utils/common.h"
 #include "td/utils/FlatHashMap.h"
@@ -62,6 +63,7 @@ class BusinessGreetingMessage;
 class BusinessInfo;
 class BusinessIntro;
 class BusinessWorkHours;
+class MemoryStatistics;
 class Td;
 
 class UserManager final : public Actor {
@@ -467,6 +469,10 @@ class UserManager final : public Actor {
 
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
+  void optimize_memory();
+
  private:
   struct User {
     string first_name;
@@ -725,6 +731,12 @@ class UserManager final : public Actor {
 
   void on_user_online_timeout(UserId user_id);
 
+  void send_update_user_status(UserId user_id, const User *u);
+
+  static void send_pending_user_status_updates_static(void *user_manager);
+
+  void send_pending_user_status_updates();
+
   static void on_user_emoji_status_timeout_callback(void *user_manager_ptr, int64 user_id_long);
 
   void on_user_emoji_status_timeout(UserId user_id);
@@ -755,6 +767,8 @@ class UserManager final : public Actor {
 
   void on_load_user_from_database(UserId user_id, string value, bool force);
 
+  void preload_users_from_database(const vector<telegram_api::object_ptr<telegram_api::User>> &users);
+
   User *get_user_force(UserId user_id, const char *source);
 
   User *get_user_force_impl(UserId user_id, const char *source);
@@ -1114,6 +1128,9 @@ class UserManager final : public Actor {
   vector<UserId> imported_contact_user_ids_;  // result of change_imported_contacts
   vector<int32> unimported_contact_invites_;  // result of change_imported_contacts
 
+  FlatHashSet<UserId, UserIdHash> pending_user_status_updates_;
+  Timeout pending_user_status_updates_timeout_;
+
   MultiTimeout user_online_timeout_{"UserOnlineTimeout"};
   MultiTimeout user_emoji_status_timeout_{"UserEmojiStatusTimeout"};
 };
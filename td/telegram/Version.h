@@ -83,6 +83,8 @@ enum class DbVersion : int32 {
   StorePinnedDialogsInBinlog,
   AddMessageThreadSupport,
   AddMessageThreadDatabase,
+  AddMessageDbFtsPrefixIndex,
+  AddMessageDbIndexTable,
   Next
 };
 
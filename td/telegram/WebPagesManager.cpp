@@ -779,6 +779,7 @@ void WebPagesManager::update_web_page_instant_view(WebPageId web_page_id, WebPag
       G()->td_db()->get_sqlite_pmc()->set(get_web_page_instant_view_database_key(web_page_id),
                                           log_event_store(new_instant_view).as_slice().str(), Auto());
     }
+    on_web_page_instant_view_used(web_page_id);
   }
 }
 
@@ -810,6 +811,10 @@ void WebPagesManager::on_get_web_page_instant_view_view_count(WebPageId web_page
 
   auto *instant_view = &web_pages_[web_page_id]->instant_view_;
   CHECK(!instant_view->is_empty_);
+  if (!instant_view->is_loaded_) {
+    // the instant view in the database must not be overwritten with an empty one
+    return;
+  }
   if (instant_view->view_count_ >= view_count) {
     return;
   }
@@ -1012,6 +1017,8 @@ void WebPagesManager::get_web_page_instant_view_impl(WebPageId web_page_id, bool
     return load_web_page_instant_view(web_page_id, force_full, std::move(promise));
   }
 
+  on_web_page_instant_view_used(web_page_id);
+
   if (force_full) {
     reload_web_page_instant_view(web_page_id);
   }
@@ -1180,6 +1187,55 @@ void WebPagesManager::update_web_page_instant_view_load_requests(WebPageId web_p
   }
 }
 
+void WebPagesManager::on_web_page_instant_view_used(WebPageId web_page_id) {
+  if (!G()->use_message_database() || !web_page_id.is_valid()) {
+    return;
+  }
+
+  td::remove(loaded_instant_view_web_page_ids_, web_page_id);
+  loaded_instant_view_web_page_ids_.push_back(web_page_id);
+
+  // the last used instant view is never unloaded
+  size_t pos = 0;
+  while (loaded_instant_view_web_page_ids_.size() > MAX_LOADED_INSTANT_VIEWS &&
+         pos + 1 < loaded_instant_view_web_page_ids_.size()) {
+    if (unload_web_page_instant_view(loaded_instant_view_web_page_ids_[pos])) {
+      loaded_instant_view_web_page_ids_.erase(loaded_instant_view_web_page_ids_.begin() + pos);
+    } else {
+      pos++;
+    }
+  }
+}
+
+bool WebPagesManager::unload_web_page_instant_view(WebPageId web_page_id) {
+  WebPage *web_page = web_pages_.get_pointer(web_page_id);
+  if (web_page == nullptr || web_page->instant_view_.is_empty_ || !web_page->instant_view_.is_loaded_) {
+    return true;
+  }
+  if (!web_page->instant_view_.was_loaded_from_database_) {
+    // the instant view must be saved to the database first
+    return false;
+  }
+  if (load_web_page_instant_view_queries_.count(web_page_id) > 0) {
+    return false;
+  }
+
+  LOG(INFO) << "Unload instant view of " << web_page_id;
+  auto old_file_ids = get_web_page_file_ids(web_page);
+
+  // the instant view will be loaded from the database, when it is needed next time
+  WebPageInstantView instant_view;
+  instant_view.is_empty_ = false;
+  instant_view.is_v2_ = web_page->instant_view_.is_v2_;
+  web_page->instant_view_ = std::move(instant_view);
+
+  auto new_file_ids = get_web_page_file_ids(web_page);
+  if (old_file_ids != new_file_ids) {
+    td_->file_manager_->change_files_source(get_web_page_file_source_id(web_page), old_file_ids, new_file_ids);
+  }
+  return true;
+}
+
 string WebPagesManager::get_web_page_url(WebPageId web_page_id) const {
   const WebPage *web_page = get_web_page(web_page_id);
   if (web_page != nullptr) {
@@ -109,6 +109,8 @@ class WebPagesManager final : public Actor {
   void on_story_changed(StoryFullId story_full_id);
 
  private:
+  static constexpr size_t MAX_LOADED_INSTANT_VIEWS = 10;  // number of instant views kept in memory if there is database
+
   class WebPage;
 
   class WebPageInstantView;
@@ -167,6 +169,10 @@ class WebPagesManager final : public Actor {
   void update_web_page_instant_view_load_requests(WebPageId web_page_id, bool force_update,
                                                   Result<WebPageId> r_web_page_id);
 
+  void on_web_page_instant_view_used(WebPageId web_page_id);
+
+  bool unload_web_page_instant_view(WebPageId web_page_id);
+
   static string get_web_page_url_database_key(const string &url);
 
   void load_web_page_by_url(string url, Promise<WebPageId> &&promise);
@@ -197,6 +203,8 @@ class WebPagesManager final : public Actor {
   };
   FlatHashMap<WebPageId, PendingWebPageInstantViewQueries, WebPageIdHash> load_web_page_instant_view_queries_;
 
+  vector<WebPageId> loaded_instant_view_web_page_ids_;  // in the order of usage
+
   FlatHashMap<WebPageId, FlatHashSet<MessageFullId, MessageFullIdHash>, WebPageIdHash> web_page_messages_;
 
   FlatHashMap<WebPageId,
@@ -3519,6 +3519,10 @@ class CliClient final : public Actor {
       send_request(td_api::make_object<td_api::getStorageStatisticsFast>());
     } else if (op == "database") {
       send_request(td_api::make_object<td_api::getDatabaseStatistics>());
+    } else if (op == "memory") {
+      send_request(td_api::make_object<td_api::getMemoryStatistics>());
+    } else if (op == "net_queries") {
+      send_request(td_api::make_object<td_api::getNetworkQueryStatistics>());
     } else if (op == "optimize_storage" || op == "optimize_storage_all") {
       string chat_ids;
       string exclude_chat_ids;
@@ -6914,6 +6918,12 @@ class CliClient final : public Actor {
       } else {
         execute(std::move(request));
       }
+    } else if (op == "sltsa") {
+      string tag;
+      int32 sample_rate;
+      int32 max_lines_per_second;
+      get_args(args, tag, sample_rate, max_lines_per_second);
+      execute(td_api::make_object<td_api::setLogTagSampling>(tag, sample_rate, max_lines_per_second));
     } else if (op == "alog" || op == "aloge") {
       int32 level;
       string text;
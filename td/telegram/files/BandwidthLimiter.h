@@ -0,0 +1,71 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+#include <limits>
+
+namespace td {
+
+// Token bucket limiting the total rate of resources given to file loaders by all ResourceManagers of a direction.
+// Resources are given in whole parts, so the bucket can go into debt, which is repaid before new resources are given.
+class BandwidthLimiter {
+ public:
+  static constexpr double MAX_BURST_TIME = 1.0;
+
+  // 0 means no limit
+  void set_limit(int64 bytes_per_second, double now) {
+    update(now);
+    limit_ = bytes_per_second;
+  }
+
+  int64 get_limit() const {
+    return limit_;
+  }
+
+  // returns the number of bytes, which can be given now; returns a positive value if the limit isn't set
+  int64 get_available(double now) {
+    if (limit_ <= 0) {
+      return std::numeric_limits<int64>::max();
+    }
+    update(now);
+    return static_cast<int64>(tokens_);
+  }
+
+  void spend(int64 size) {
+    if (limit_ > 0) {
+      tokens_ -= static_cast<double>(size);
+    }
+  }
+
+  // returns the time when new resources can be given
+  double get_wakeup_at() const {
+    if (limit_ <= 0 || tokens_ >= 1.0) {
+      return updated_at_;
+    }
+    return updated_at_ + (1.0 - tokens_) / static_cast<double>(limit_);
+  }
+
+ private:
+  int64 limit_ = 0;
+  double tokens_ = 0.0;
+  double updated_at_ = 0.0;
+
+  void update(double now) {
+    if (limit_ > 0 && now > updated_at_) {
+      auto max_tokens = static_cast<double>(limit_) * MAX_BURST_TIME;
+      tokens_ += (now - updated_at_) * static_cast<double>(limit_);
+      if (tokens_ > max_tokens) {
+        tokens_ = max_tokens;
+      }
+    }
+    updated_at_ = now;
+  }
+};
+
+}  // namespace td
@@ -20,20 +20,27 @@
 
 #include "td/actor/actor.h"
 
+#include "td/utils/algorithm.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
+#include "td/utils/optional.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
+#include "td/utils/Time.h"
 #include "td/utils/tl_helpers.h"
 #include "td/utils/tl_parsers.h"
 
+#include <utility>
+
 namespace td {
 
 Status drop_file_db(SqliteDb &db, int32 version) {
   LOG(WARNING) << "Drop file_db " << tag("version", version) << tag("current_db_version", current_db_version());
   TRY_STATUS(SqliteKeyValue::drop(db, "files"));
+  TRY_STATUS(SqliteKeyValue::drop(db, "file_gc_index"));
   return Status::OK();
 }
 
@@ -53,6 +60,7 @@ Status init_file_db(SqliteDb &db, int32 version) {
   if (version == 0) {
     TRY_STATUS(SqliteKeyValue::init(db, "files"));
   }
+  TRY_STATUS(SqliteKeyValue::init(db, "file_gc_index"));
   return Status::OK();
 }
 
@@ -65,6 +73,7 @@ class FileDb final : public FileDbInterface {
     }
 
     void close(Promise<> promise) {
+      do_flush();
       file_kv_safe_.reset();
       LOG(INFO) << "FileDb is closed";
       promise.set_value(Unit());
@@ -72,96 +81,135 @@ class FileDb final : public FileDbInterface {
     }
 
     void load_file_data(const string &key, Promise<FileData> promise) {
+      do_flush();
       promise.set_result(load_file_data_impl(actor_id(this), file_pmc(), key, max_file_db_id_));
     }
 
+    void load_file_data_batch(vector<string> keys, Promise<vector<Result<FileData>>> promise) {
+      do_flush();
+      promise.set_value(load_file_data_batch_impl(actor_id(this), file_pmc(), keys, max_file_db_id_));
+    }
+
     void clear_file_data(FileDbId file_db_id, const string &remote_key, const string &local_key,
                          const string &generate_key) {
-      auto &pmc = file_pmc();
-      pmc.begin_write_transaction().ensure();
-
-      if (file_db_id > max_file_db_id_) {
-        pmc.set("file_id", to_string(file_db_id.get()));
-        max_file_db_id_ = file_db_id;
-      }
+      update_max_file_db_id(file_db_id);
 
-      pmc.erase(PSTRING() << "file" << file_db_id.get());
+      add_pending_erase(PSTRING() << "file" << file_db_id.get());
       // LOG(DEBUG) << "ERASE " << format::as_hex_dump<4>(Slice(PSLICE() << "file" << file_db_id.get()));
 
       if (!remote_key.empty()) {
-        pmc.erase(remote_key);
+        add_pending_erase(remote_key);
         // LOG(DEBUG) << "ERASE remote " << format::as_hex_dump<4>(Slice(remote_key));
       }
       if (!local_key.empty()) {
-        pmc.erase(local_key);
+        add_pending_erase(local_key);
         // LOG(DEBUG) << "ERASE local " << format::as_hex_dump<4>(Slice(local_key));
       }
       if (!generate_key.empty()) {
-        pmc.erase(generate_key);
+        add_pending_erase(generate_key);
       }
-
-      pmc.commit_transaction().ensure();
+      on_write_added();
     }
 
-    void store_file_data(FileDbId file_db_id, const string &file_data, const string &remote_key,
-                         const string &local_key, const string &generate_key) {
-      auto &pmc = file_pmc();
-      pmc.begin_write_transaction().ensure();
-
-      if (file_db_id > max_file_db_id_) {
-        pmc.set("file_id", to_string(file_db_id.get()));
-        max_file_db_id_ = file_db_id;
-      }
+    void store_file_data(FileDbId file_db_id, string file_data, const string &remote_key, const string &local_key,
+                         const string &generate_key) {
+      update_max_file_db_id(file_db_id);
 
-      pmc.set(PSTRING() << "file" << file_db_id.get(), file_data);
+      add_pending_set(PSTRING() << "file" << file_db_id.get(), std::move(file_data));
 
       if (!remote_key.empty()) {
-        pmc.set(remote_key, to_string(file_db_id.get()));
+        add_pending_set(remote_key, to_string(file_db_id.get()));
       }
       if (!local_key.empty()) {
-        pmc.set(local_key, to_string(file_db_id.get()));
+        add_pending_set(local_key, to_string(file_db_id.get()));
       }
       if (!generate_key.empty()) {
-        pmc.set(generate_key, to_string(file_db_id.get()));
+        add_pending_set(generate_key, to_string(file_db_id.get()));
       }
-
-      pmc.commit_transaction().ensure();
+      on_write_added();
     }
 
     void store_file_data_ref(FileDbId file_db_id, FileDbId new_file_db_id) {
-      auto &pmc = file_pmc();
-      pmc.begin_write_transaction().ensure();
-
-      if (file_db_id > max_file_db_id_) {
-        pmc.set("file_id", to_string(file_db_id.get()));
-        max_file_db_id_ = file_db_id;
-      }
-
+      update_max_file_db_id(file_db_id);
       do_store_file_data_ref(file_db_id, new_file_db_id);
-
-      pmc.commit_transaction().ensure();
+      on_write_added();
     }
 
     void optimize_refs(std::vector<FileDbId> file_db_ids, FileDbId main_file_db_id) {
       LOG(INFO) << "Optimize " << file_db_ids.size() << " file_db_ids in file database to " << main_file_db_id.get();
-      auto &pmc = file_pmc();
-      pmc.begin_write_transaction().ensure();
       for (size_t i = 0; i + 1 < file_db_ids.size(); i++) {
         do_store_file_data_ref(file_db_ids[i], main_file_db_id);
       }
-      pmc.commit_transaction().ensure();
+      on_write_added();
     }
 
    private:
+    static constexpr size_t MAX_PENDING_WRITE_COUNT = 1000;
+    static constexpr double MAX_PENDING_WRITES_DELAY = 0.01;
+
     FileDbId max_file_db_id_;
     std::shared_ptr<SqliteKeyValueSafe> file_kv_safe_;
 
+    // the last value for each changed key; an empty optional means that the key must be erased
+    // all changes are applied in one transaction, which is equivalent to their sequential application
+    FlatHashMap<string, optional<string>> pending_writes_;
+    double wakeup_at_ = 0;
+
     SqliteKeyValue &file_pmc() {
       return file_kv_safe_->get();
     }
 
+    void update_max_file_db_id(FileDbId file_db_id) {
+      if (file_db_id > max_file_db_id_) {
+        add_pending_set("file_id", to_string(file_db_id.get()));
+        max_file_db_id_ = file_db_id;
+      }
+    }
+
+    void add_pending_set(string key, string value) {
+      pending_writes_[std::move(key)] = std::move(value);
+    }
+
+    void add_pending_erase(string key) {
+      pending_writes_[std::move(key)] = optional<string>();
+    }
+
+    void on_write_added() {
+      if (pending_writes_.size() >= MAX_PENDING_WRITE_COUNT) {
+        return do_flush();
+      }
+      if (wakeup_at_ == 0) {
+        wakeup_at_ = Time::now_cached() + MAX_PENDING_WRITES_DELAY;
+        set_timeout_at(wakeup_at_);
+      }
+    }
+
+    void do_flush() {
+      wakeup_at_ = 0;
+      cancel_timeout();
+      if (pending_writes_.empty()) {
+        return;
+      }
+
+      auto &pmc = file_pmc();
+      pmc.begin_write_transaction().ensure();
+      for (auto &it : pending_writes_) {
+        if (it.second) {
+          pmc.set(it.first, it.second.value());
+        } else {
+          pmc.erase(it.first);
+        }
+      }
+      pmc.commit_transaction().ensure();
+      pending_writes_.clear();
+    }
+
+    void timeout_expired() final {
+      do_flush();
+    }
+
     void do_store_file_data_ref(FileDbId file_db_id, FileDbId new_file_db_id) {
-      file_pmc().set(PSTRING() << "file" << file_db_id.get(), PSTRING() << "@@" << new_file_db_id.get());
+      add_pending_set(PSTRING() << "file" << file_db_id.get(), PSTRING() << "@@" << new_file_db_id.get());
     }
   };
 
@@ -190,6 +238,14 @@ class FileDb final : public FileDbInterface {
     return load_file_data_impl(file_db_actor_.get(), file_kv_safe_->get(), key, max_file_db_id_);
   }
 
+  void get_file_data_batch_impl(vector<string> keys, Promise<vector<Result<FileData>>> promise) final {
+    send_closure(file_db_actor_, &FileDbActor::load_file_data_batch, std::move(keys), std::move(promise));
+  }
+
+  vector<Result<FileData>> get_file_data_batch_sync_impl(vector<string> keys) final {
+    return load_file_data_batch_impl(file_db_actor_.get(), file_kv_safe_->get(), keys, max_file_db_id_);
+  }
+
   void clear_file_data(FileDbId file_db_id, const FileData &file_data) final {
     string remote_key;
     if (file_data.remote_.type() == RemoteFileLocation::Type::Full) {
@@ -284,6 +340,17 @@ class FileDb final : public FileDbInterface {
     return std::move(data);
   }
 
+  static vector<Result<FileData>> load_file_data_batch_impl(ActorId<FileDbActor> file_db_actor_id, SqliteKeyValue &pmc,
+                                                            const vector<string> &keys, FileDbId max_file_db_id) {
+    // all lookups are done in one read transaction, which is much faster than a transaction per lookup
+    pmc.begin_read_transaction().ensure();
+    auto result = transform(keys, [&](const string &key) {
+      return load_file_data_impl(file_db_actor_id, pmc, key, max_file_db_id);
+    });
+    pmc.commit_transaction().ensure();
+    return result;
+  }
+
   static Result<FileDbId> get_file_db_id(SqliteKeyValue &pmc, const string &key) TD_WARN_UNUSED_RESULT {
     auto file_db_id_str = pmc.get(key);
     // LOG(DEBUG) << "Found ID " << file_db_id_str << " by key " << format::as_hex_dump<4>(Slice(key));
@@ -75,6 +75,15 @@ class FileDbInterface {
     return res;
   }
 
+  // returns results for the keys, created by as_key, in the same order; all keys are looked up at once
+  vector<Result<FileData>> get_file_data_batch_sync(vector<string> keys) {
+    return get_file_data_batch_sync_impl(std::move(keys));
+  }
+
+  void get_file_data_batch(vector<string> keys, Promise<vector<Result<FileData>>> promise) {
+    get_file_data_batch_impl(std::move(keys), std::move(promise));
+  }
+
   virtual void clear_file_data(FileDbId file_db_id, const FileData &file_data) = 0;
   virtual void set_file_data(FileDbId file_db_id, const FileData &file_data, bool new_remote, bool new_local,
                              bool new_generate) = 0;
@@ -86,6 +95,8 @@ class FileDbInterface {
  private:
   virtual void get_file_data_impl(string key, Promise<FileData> promise) = 0;
   virtual Result<FileData> get_file_data_sync_impl(string key) = 0;
+  virtual void get_file_data_batch_impl(vector<string> keys, Promise<vector<Result<FileData>>> promise) = 0;
+  virtual vector<Result<FileData>> get_file_data_batch_sync_impl(vector<string> keys) = 0;
 };
 
 }  // namespace td
@@ -35,7 +35,8 @@ namespace td {
 
 FileDownloader::FileDownloader(const FullRemoteFileLocation &remote, const LocalFileLocation &local, int64 size,
                                string name, const FileEncryptionKey &encryption_key, bool is_small,
-                               bool need_search_file, int64 offset, int64 limit, unique_ptr<Callback> callback)
+                               bool need_search_file, int64 offset, int64 limit, ActorId<FileIoWorker> file_io_worker,
+                               unique_ptr<Callback> callback)
     : remote_(remote)
     , local_(local)
     , size_(size)
@@ -45,7 +46,8 @@ FileDownloader::FileDownloader(const FullRemoteFileLocation &remote, const Local
     , is_small_(is_small)
     , need_search_file_(need_search_file)
     , offset_(offset)
-    , limit_(limit) {
+    , limit_(limit)
+    , file_io_worker_(file_io_worker) {
   if (encryption_key.is_secret()) {
     set_ordered_flag(true);
   }
@@ -82,20 +84,20 @@ Result<FileLoader::FileInfo> FileDownloader::init() {
           encryption_key_.mutable_iv() = as<UInt256>(partial.iv_.data());
           next_part_ = narrow_cast<int32>(bitmask.get_ready_parts(0));
         }
-        fd_ = result_fd.move_as_ok();
+        fd_ = std::make_shared<FileFd>(result_fd.move_as_ok());
         part_size = static_cast<int32>(partial.part_size_);
       } else {
         LOG(ERROR) << "Have invalid " << partial;
       }
     }
   }
-  if (need_search_file_ && fd_.empty() && size_ > 0 && encryption_key_.empty() && !remote_.is_web()) {
+  if (need_search_file_ && fd_ == nullptr && size_ > 0 && encryption_key_.empty() && !remote_.is_web()) {
     auto r_path = search_file(remote_.file_type_, name_, size_);
     if (r_path.is_ok()) {
       auto r_fd = FileFd::open(r_path.ok(), FileFd::Read);
       if (r_fd.is_ok()) {
         path_ = r_path.move_as_ok();
-        fd_ = r_fd.move_as_ok();
+        fd_ = std::make_shared<FileFd>(r_fd.move_as_ok());
         need_check_ = true;
         only_check_ = true;
         part_size = 128 * (1 << 10);
@@ -105,6 +107,24 @@ Result<FileLoader::FileInfo> FileDownloader::init() {
     }
   }
 
+  if (local_.type() == LocalFileLocation::Type::Empty && fd_ == nullptr && size_ > 0 && encryption_key_.empty()) {
+    shared_file_cache_path_ = get_shared_file_cache_path(remote_);
+    if (!shared_file_cache_path_.empty()) {
+      auto r_path = link_from_shared_file_cache(remote_.file_type_, shared_file_cache_path_, size_);
+      if (r_path.is_ok()) {
+        path_ = r_path.move_as_ok();
+        is_from_shared_file_cache_ = true;
+        part_size = 512 * (1 << 10);
+        bitmask = Bitmask{Bitmask::Ones{}, (size_ + part_size - 1) / part_size};
+        LOG(INFO) << "Use file " << shared_file_cache_path_ << " from the shared file cache";
+      }
+    }
+  }
+
+  // writes of big files must not evict more useful data, for example, databases, from the page cache
+  auto write_behind_size_threshold = G()->get_option_integer("download_write_behind_size_threshold");
+  drop_page_cache_ = write_behind_size_threshold > 0 && size_ >= write_behind_size_threshold && !only_check_;
+
   FileInfo res;
   res.size = size_;
   res.is_size_final = true;
@@ -125,7 +145,7 @@ Result<FileLoader::FileInfo> FileDownloader::init() {
 
 Status FileDownloader::on_ok(int64 size) {
   std::string path;
-  fd_.close();
+  fd_ = nullptr;
   if (encryption_key_.is_secure()) {
     TRY_RESULT(file_path, open_temp_file(remote_.file_type_));
     string tmp_path;
@@ -140,13 +160,16 @@ Status FileDownloader::on_ok(int64 size) {
     path = path_;
   } else {
     TRY_RESULT_ASSIGN(path, create_from_temp(remote_.file_type_, path_, name_));
+    if (!shared_file_cache_path_.empty() && !is_from_shared_file_cache_) {
+      add_to_shared_file_cache(path, shared_file_cache_path_);
+    }
   }
   callback_->on_ok(FullLocalFileLocation(remote_.file_type_, std::move(path), 0), size, !only_check_);
   return Status::OK();
 }
 
 void FileDownloader::on_error(Status status) {
-  fd_.close();
+  fd_ = nullptr;
   callback_->on_error(std::move(status));
 }
 
@@ -298,7 +321,28 @@ Status FileDownloader::check_net_query(NetQueryPtr &net_query) {
   return Status::OK();
 }
 
-Result<size_t> FileDownloader::process_part(Part part, NetQueryPtr net_query) {
+void FileDownloader::process_part(Part part, NetQueryPtr net_query, Promise<size_t> promise) {
+  TRY_RESULT_PROMISE(promise, bytes, get_part_bytes(part, std::move(net_query)));
+  if (bytes.empty()) {
+    return promise.set_value(0);
+  }
+
+  TRY_STATUS_PROMISE(promise, acquire_fd());
+  auto size = bytes.size();
+  LOG(INFO) << "Receive " << size << " bytes at offset " << part.offset << " for \"" << path_ << '"';
+  send_closure(file_io_worker_, &FileIoWorker::pwrite, fd_, std::move(bytes), part.offset, drop_page_cache_,
+               PromiseCreator::lambda([size, promise = std::move(promise)](Result<size_t> r_written) mutable {
+                 TRY_RESULT_PROMISE(promise, written, std::move(r_written));
+                 LOG(INFO) << "Written " << written << " bytes";
+                 // may write less than part.size, when size of downloadable file is unknown
+                 if (written != size) {
+                   return promise.set_error(Status::Error("Failed to save file part to the file"));
+                 }
+                 promise.set_value(std::move(written));
+               }));
+}
+
+Result<BufferSlice> FileDownloader::get_part_bytes(Part part, NetQueryPtr net_query) {
   TRY_STATUS(check_net_query(net_query));
 
   BufferSlice bytes;
@@ -339,7 +383,7 @@ Result<size_t> FileDownloader::process_part(Part part, NetQueryPtr net_query) {
     return Status::Error("Part size is more than requested");
   }
   if (bytes.empty()) {
-    return 0;
+    return std::move(bytes);
   }
 
   // Encryption
@@ -364,18 +408,12 @@ Result<size_t> FileDownloader::process_part(Part part, NetQueryPtr net_query) {
     }
     aes_ige_decrypt(as_slice(encryption_key_.key()), as_mutable_slice(encryption_key_.mutable_iv()), bytes.as_slice(),
                     bytes.as_mutable_slice());
+    // the part may be written after the next parts are decrypted, so IV for the current prefix must be kept
+    part_ivs_[next_part_] = encryption_key_.mutable_iv();
   }
 
-  auto slice = bytes.as_slice().substr(0, part.size);
-  TRY_STATUS(acquire_fd());
-  LOG(INFO) << "Receive " << slice.size() << " bytes at offset " << part.offset << " for \"" << path_ << '"';
-  TRY_RESULT(written, fd_.pwrite(slice, part.offset));
-  LOG(INFO) << "Written " << written << " bytes";
-  // may write less than part.size, when size of downloadable file is unknown
-  if (written != slice.size()) {
-    return Status::Error("Failed to save file part to the file");
-  }
-  return written;
+  bytes.truncate(part.size);
+  return std::move(bytes);
 }
 
 void FileDownloader::on_progress(Progress progress) {
@@ -395,8 +433,13 @@ void FileDownloader::on_progress(Progress progress) {
     if (progress.ready_part_count == next_part_) {
       iv = encryption_key_.mutable_iv();
     } else {
-      LOG(FATAL) << tag("ready_part_count", progress.ready_part_count) << tag("next_part", next_part_);
+      auto it = part_ivs_.find(progress.ready_part_count);
+      if (it == part_ivs_.end()) {
+        LOG(FATAL) << tag("ready_part_count", progress.ready_part_count) << tag("next_part", next_part_);
+      }
+      iv = it->second;
     }
+    part_ivs_.erase(part_ivs_.begin(), part_ivs_.lower_bound(progress.ready_part_count));
     callback_->on_partial_download(PartialLocalFileLocation{remote_.file_type_, progress.part_size, path_,
                                                             as_slice(iv).str(), std::move(progress.ready_bitmask)},
                                    progress.ready_size, progress.size);
@@ -447,7 +490,7 @@ Result<FileLoader::CheckInfo> FileDownloader::check_loop(int64 checked_prefix_si
       auto size = narrow_cast<size_t>(end_offset - begin_offset);
       auto slice = BufferSlice(size);
       TRY_STATUS(acquire_fd());
-      TRY_RESULT(read_size, fd_.pread(slice.as_mutable_slice(), begin_offset));
+      TRY_RESULT(read_size, fd_->pread(slice.as_mutable_slice(), begin_offset));
       if (size != read_size) {
         return Status::Error("Failed to read file to check hash");
       }
@@ -498,18 +541,21 @@ void FileDownloader::keep_fd_flag(bool keep_fd) {
 }
 
 void FileDownloader::try_release_fd() {
-  if (!keep_fd_ && !fd_.empty()) {
-    fd_.close();
+  if (!keep_fd_ && fd_ != nullptr) {
+    // the file is closed after all pending writes are finished
+    fd_ = nullptr;
   }
 }
 
 Status FileDownloader::acquire_fd() {
-  if (fd_.empty()) {
+  if (fd_ == nullptr) {
+    FileFd fd;
     if (path_.empty()) {
-      TRY_RESULT_ASSIGN(std::tie(fd_, path_), open_temp_file(remote_.file_type_));
+      TRY_RESULT_ASSIGN(std::tie(fd, path_), open_temp_file(remote_.file_type_));
     } else {
-      TRY_RESULT_ASSIGN(fd_, FileFd::open(path_, (only_check_ ? 0 : FileFd::Write) | FileFd::Read));
+      TRY_RESULT_ASSIGN(fd, FileFd::open(path_, (only_check_ ? 0 : FileFd::Write) | FileFd::Read));
     }
+    fd_ = std::make_shared<FileFd>(std::move(fd));
   }
   return Status::OK();
 }
@@ -7,17 +7,24 @@
 #pragma once
 
 #include "td/telegram/files/FileEncryptionKey.h"
+#include "td/telegram/files/FileIoWorker.h"
 #include "td/telegram/files/FileLoader.h"
 #include "td/telegram/files/FileLocation.h"
 #include "td/telegram/net/DcId.h"
 #include "td/telegram/net/NetQuery.h"
 #include "td/telegram/telegram_api.h"
 
+#include "td/actor/actor.h"
+
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/port/FileFd.h"
+#include "td/utils/Promise.h"
 #include "td/utils/Status.h"
+#include "td/utils/UInt.h"
 
 #include <map>
+#include <memory>
 #include <set>
 #include <utility>
 
@@ -34,7 +41,7 @@ class FileDownloader final : public FileLoader {
 
   FileDownloader(const FullRemoteFileLocation &remote, const LocalFileLocation &local, int64 size, string name,
                  const FileEncryptionKey &encryption_key, bool is_small, bool need_search_file, int64 offset,
-                 int64 limit, unique_ptr<Callback> callback);
+                 int64 limit, ActorId<FileIoWorker> file_io_worker, unique_ptr<Callback> callback);
 
   // Should just implement all parent pure virtual methods.
   // Must not call any of them...
@@ -50,7 +57,7 @@ class FileDownloader final : public FileLoader {
   bool only_check_{false};
 
   string path_;
-  FileFd fd_;
+  std::shared_ptr<FileFd> fd_;
 
   int32 next_part_ = 0;
   bool next_part_stop_ = false;
@@ -58,6 +65,11 @@ class FileDownloader final : public FileLoader {
   bool need_search_file_{false};
   int64 offset_;
   int64 limit_;
+  ActorId<FileIoWorker> file_io_worker_;
+  std::map<int32, UInt256> part_ivs_;
+  bool drop_page_cache_ = false;
+  string shared_file_cache_path_;
+  bool is_from_shared_file_cache_ = false;
 
   bool use_cdn_ = false;
   DcId cdn_dc_id_;
@@ -86,7 +98,8 @@ class FileDownloader final : public FileLoader {
   Result<bool> should_restart_part(Part part, const NetQueryPtr &net_query) final TD_WARN_UNUSED_RESULT;
   Result<std::pair<NetQueryPtr, bool>> start_part(Part part, int32 part_count,
                                                   int64 streaming_offset) final TD_WARN_UNUSED_RESULT;
-  Result<size_t> process_part(Part part, NetQueryPtr net_query) final TD_WARN_UNUSED_RESULT;
+  void process_part(Part part, NetQueryPtr net_query, Promise<size_t> promise) final;
+  Result<BufferSlice> get_part_bytes(Part part, NetQueryPtr net_query) TD_WARN_UNUSED_RESULT;
   void on_progress(Progress progress) final;
   FileLoader::Callback *get_callback() final;
   Status process_check_query(NetQueryPtr net_query) final;
@@ -0,0 +1,353 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/files/FileGcIndex.h"
+
+#include "td/telegram/files/FileLoaderUtils.h"
+#include "td/telegram/files/FileLocation.h"
+#include "td/telegram/files/FileManager.h"
+#include "td/telegram/Global.h"
+
+#include "td/db/SqliteKeyValue.h"
+#include "td/db/SqliteKeyValueSafe.h"
+
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/Clocks.h"
+#include "td/utils/port/path.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
+
+#include <utility>
+
+namespace td {
+
+FileGcIndex::FileGcIndex(ActorShared<> parent, std::shared_ptr<SqliteKeyValueSafe> kv_safe)
+    : parent_(std::move(parent)), kv_safe_(std::move(kv_safe)) {
+}
+
+void FileGcIndex::start_up() {
+  rebuilt_at_ = to_integer<uint32>(kv().get("c"));
+  kv().get_by_prefix("t", [&](Slice key, Slice value) {
+    auto dialog_id_file_type = split(key);
+    auto file_type_id = to_integer<int32>(dialog_id_file_type.second);
+    if (0 <= file_type_id && file_type_id < MAX_FILE_TYPE) {
+      auto cnt_size = split(value);
+      auto &stat = stat_by_owner_dialog_id_[DialogId(to_integer<int64>(dialog_id_file_type.first))][file_type_id];
+      stat.cnt = to_integer<int32>(cnt_size.first);
+      stat.size = to_integer<int64>(cnt_size.second);
+    }
+    return true;
+  });
+}
+
+bool FileGcIndex::is_complete(double now) const {
+  return rebuilt_at_ != 0 && now <= rebuilt_at_ + MAX_INDEX_AGE && rebuilt_at_ <= now + ACCESS_TIME_PRECISION;
+}
+
+FileGcIndex::StatByType FileGcIndex::get_stat_by_type() const {
+  StatByType stat_by_type;
+  for (auto &it : stat_by_owner_dialog_id_) {
+    for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+      stat_by_type[i].size += it.second[i].size;
+      stat_by_type[i].cnt += it.second[i].cnt;
+    }
+  }
+  return stat_by_type;
+}
+
+SqliteKeyValue &FileGcIndex::kv() {
+  return kv_safe_->get();
+}
+
+string FileGcIndex::get_path_key(Slice path) {
+  return PSTRING() << 'p' << path;
+}
+
+string FileGcIndex::get_access_time_key(uint32 atime, Slice path) {
+  return PSTRING() << 'a' << lpad0(to_string(atime), ACCESS_TIME_LENGTH) << path;
+}
+
+string FileGcIndex::get_stat_key(DialogId owner_dialog_id, FileType file_type) {
+  return PSTRING() << 't' << owner_dialog_id.get() << ' ' << static_cast<int32>(file_type);
+}
+
+string FileGcIndex::serialize_entry(const Entry &entry) {
+  return PSTRING() << static_cast<int32>(entry.file_type) << ' ' << entry.size << ' ' << entry.atime << ' '
+                   << entry.mtime_nsec << ' ' << entry.owner_dialog_id.get();
+}
+
+Result<FileGcIndex::Entry> FileGcIndex::parse_entry(Slice value) {
+  auto fields = full_split(value);
+  if (fields.size() != 5) {
+    return Status::Error("Wrong number of fields");
+  }
+  TRY_RESULT(file_type_id, to_integer_safe<int32>(fields[0]));
+  if (file_type_id < 0 || file_type_id >= MAX_FILE_TYPE) {
+    return Status::Error("Wrong file type");
+  }
+  Entry entry;
+  entry.file_type = static_cast<FileType>(file_type_id);
+  TRY_RESULT_ASSIGN(entry.size, to_integer_safe<int64>(fields[1]));
+  TRY_RESULT_ASSIGN(entry.atime, to_integer_safe<uint32>(fields[2]));
+  TRY_RESULT_ASSIGN(entry.mtime_nsec, to_integer_safe<uint64>(fields[3]));
+  TRY_RESULT(owner_dialog_id, to_integer_safe<int64>(fields[4]));
+  entry.owner_dialog_id = DialogId(owner_dialog_id);
+  return entry;
+}
+
+void FileGcIndex::update_stat(const Entry &entry, int32 sign) {
+  auto &stat = stat_by_owner_dialog_id_[entry.owner_dialog_id][static_cast<int32>(entry.file_type)];
+  stat.cnt += sign;
+  stat.size += sign * entry.size;
+  if (stat.cnt < 0 || stat.size < 0) {
+    LOG(ERROR) << "Receive wrong files GC index statistics for " << entry.file_type << " in "
+               << entry.owner_dialog_id;
+    stat = FileTypeStat();
+  }
+  auto key = get_stat_key(entry.owner_dialog_id, entry.file_type);
+  if (stat.cnt == 0) {
+    kv().erase(key);
+  } else {
+    kv().set(key, PSLICE() << stat.cnt << ' ' << stat.size);
+  }
+}
+
+void FileGcIndex::do_remove_file(Slice path, const Entry &entry) {
+  kv().erase(get_path_key(path));
+  kv().erase(get_access_time_key(entry.atime, path));
+  update_stat(entry, -1);
+}
+
+void FileGcIndex::do_add_file(Slice path, const Entry &entry) {
+  auto value = serialize_entry(entry);
+  kv().set(get_path_key(path), value);
+  kv().set(get_access_time_key(entry.atime, path), value);
+  update_stat(entry, 1);
+}
+
+void FileGcIndex::add_file(FileType file_type, string path, DialogId owner_dialog_id, int64 size,
+                           uint64 mtime_nsec) {
+  VLOG(file_gc) << "Add to files GC index file \"" << path << "\" of type " << file_type << " and size " << size
+                << " from " << owner_dialog_id;
+  Entry entry;
+  entry.file_type = file_type;
+  entry.owner_dialog_id = owner_dialog_id;
+  entry.size = size;
+  entry.atime = static_cast<uint32>(Clocks::system());
+  entry.mtime_nsec = mtime_nsec;
+
+  kv().begin_write_transaction().ensure();
+  auto r_old_entry = parse_entry(kv().get(get_path_key(path)));
+  if (r_old_entry.is_ok()) {
+    do_remove_file(path, r_old_entry.ok());
+  }
+  do_add_file(path, entry);
+  kv().commit_transaction().ensure();
+}
+
+void FileGcIndex::access_file(string path, DialogId owner_dialog_id) {
+  auto r_entry = parse_entry(kv().get(get_path_key(path)));
+  if (r_entry.is_error()) {
+    return;
+  }
+  auto old_entry = r_entry.move_as_ok();
+  auto now = static_cast<uint32>(Clocks::system());
+  if (now < old_entry.atime + ACCESS_TIME_PRECISION &&
+      (!owner_dialog_id.is_valid() || owner_dialog_id == old_entry.owner_dialog_id)) {
+    // the access time is precise enough
+    return;
+  }
+
+  auto entry = old_entry;
+  entry.atime = now;
+  if (owner_dialog_id.is_valid()) {
+    entry.owner_dialog_id = owner_dialog_id;
+  }
+  kv().begin_write_transaction().ensure();
+  do_remove_file(path, old_entry);
+  do_add_file(path, entry);
+  kv().commit_transaction().ensure();
+}
+
+void FileGcIndex::remove_file(string path) {
+  auto r_entry = parse_entry(kv().get(get_path_key(path)));
+  if (r_entry.is_error()) {
+    return;
+  }
+  VLOG(file_gc) << "Remove from files GC index file \"" << path << '"';
+  kv().begin_write_transaction().ensure();
+  do_remove_file(path, r_entry.ok());
+  kv().commit_transaction().ensure();
+}
+
+void FileGcIndex::reset(vector<FullFileInfo> files) {
+  auto begin_time = Time::now();
+  kv().begin_write_transaction().ensure();
+  kv().erase_by_prefix("p");
+  kv().erase_by_prefix("a");
+  kv().erase_by_prefix("t");
+  stat_by_owner_dialog_id_.clear();
+  for (auto &info : files) {
+    Entry entry;
+    entry.file_type = info.file_type;
+    entry.owner_dialog_id = info.owner_dialog_id;
+    entry.size = info.size;
+    entry.atime = static_cast<uint32>(max(info.atime_nsec, info.mtime_nsec) / 1000000000);
+    entry.mtime_nsec = info.mtime_nsec;
+    auto value = serialize_entry(entry);
+    kv().set(get_path_key(info.path), value);
+    kv().set(get_access_time_key(entry.atime, info.path), value);
+
+    auto &stat = stat_by_owner_dialog_id_[entry.owner_dialog_id][static_cast<int32>(entry.file_type)];
+    stat.cnt++;
+    stat.size += entry.size;
+  }
+  for (auto &it : stat_by_owner_dialog_id_) {
+    for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+      const auto &stat = it.second[i];
+      if (stat.cnt != 0) {
+        kv().set(get_stat_key(it.first, static_cast<FileType>(i)), PSLICE() << stat.cnt << ' ' << stat.size);
+      }
+    }
+  }
+  rebuilt_at_ = static_cast<uint32>(Clocks::system());
+  kv().set("c", to_string(rebuilt_at_));
+  kv().commit_transaction().ensure();
+  VLOG(file_gc) << "Rebuild files GC index with " << files.size() << " files in " << Time::now() - begin_time;
+}
+
+void FileGcIndex::run_gc(FileGcParameters parameters, CancellationToken token, Promise<FileGcResult> promise) {
+  if (token) {
+    return promise.set_error(Global::request_aborted_error());
+  }
+  auto now = Clocks::system();
+  if (!is_complete(now)) {
+    return promise.set_error(Status::Error(404, "Files GC index must be rebuilt"));
+  }
+
+  auto begin_time = Time::now();
+  VLOG(file_gc) << "Start files GC by index with " << parameters;
+
+  auto immune_types = get_gc_immune_file_types(parameters);
+
+  // unlike the full files GC, files, which are immune by their modification time, are counted in the limits
+  auto stat_by_type = get_stat_by_type();
+  int64 total_size = 0;
+  uint64 total_cnt = 0;
+  for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+    if (!immune_types[i]) {
+      total_size += stat_by_type[i].size;
+      total_cnt += stat_by_type[i].cnt;
+    }
+  }
+  uint64 remove_count = 0;
+  if (total_cnt > parameters.max_file_count_) {
+    remove_count = total_cnt - parameters.max_file_count_;
+  }
+  int64 remove_size = total_size - parameters.max_files_size_;
+
+  int32 time_immunity_ignored_cnt = 0;
+  int32 remove_by_atime_cnt = 0;
+  int32 remove_by_count_cnt = 0;
+  int32 remove_by_size_cnt = 0;
+  vector<std::pair<string, Entry>> removed_files;
+
+  // rows are returned in the order of the primary key, i.e. from the least recently used files
+  kv().get_by_prefix("a", [&](Slice key, Slice value) {
+    if (token) {
+      return false;
+    }
+    auto r_entry = parse_entry(value);
+    if (r_entry.is_error() || key.size() <= ACCESS_TIME_LENGTH) {
+      LOG(ERROR) << "Receive invalid files GC index entry " << value;
+      return true;
+    }
+    auto entry = r_entry.move_as_ok();
+    if (immune_types[static_cast<int32>(entry.file_type)]) {
+      return true;
+    }
+    if (static_cast<double>(entry.mtime_nsec) * 1e-9 > now - parameters.immunity_delay_) {
+      // new files are immune to GC
+      time_immunity_ignored_cnt++;
+      return true;
+    }
+
+    if (entry.atime < now - parameters.max_time_from_last_access_) {
+      remove_by_atime_cnt++;
+    } else if (remove_count > 0) {
+      remove_by_count_cnt++;
+    } else if (remove_size > 0) {
+      remove_by_size_cnt++;
+    } else {
+      // all other files are more recently used
+      return false;
+    }
+    if (remove_count > 0) {
+      remove_count--;
+    }
+    remove_size -= entry.size;
+    removed_files.emplace_back(key.substr(ACCESS_TIME_LENGTH).str(), entry);
+    return true;
+  });
+  if (token) {
+    return promise.set_error(Global::request_aborted_error());
+  }
+
+  FileStats removed_stats(false, false);
+  int64 total_removed_size = 0;
+  kv().begin_write_transaction().ensure();
+  for (auto &removed_file : removed_files) {
+    const auto &path = removed_file.first;
+    const auto &entry = removed_file.second;
+    auto status = unlink(path);
+    LOG_IF(WARNING, status.is_error()) << "Failed to unlink file \"" << path << "\" during files GC: " << status;
+    send_closure(G()->file_manager(), &FileManager::on_file_unlink,
+                 FullLocalFileLocation(entry.file_type, path, entry.mtime_nsec));
+    do_remove_file(path, entry);
+
+    total_removed_size += entry.size;
+    removed_stats.add(FullFileInfo{entry.file_type, path, entry.owner_dialog_id, entry.size,
+                                   static_cast<uint64>(entry.atime) * 1000000000, entry.mtime_nsec});
+  }
+  kv().commit_transaction().ensure();
+
+  FileStats kept_stats(false, false);
+  stat_by_type = get_stat_by_type();
+  for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+    kept_stats.add_stat(DialogId(), static_cast<FileType>(i), stat_by_type[i]);
+  }
+
+  clean_shared_file_cache(parameters.immunity_delay_);
+
+  auto end_time = Time::now();
+  VLOG(file_gc) << "Finish files GC by index: " << tag("time", end_time - begin_time)
+                << tag("removed", removed_files.size()) << tag("total_size", format::as_size(total_size))
+                << tag("total_removed_size", format::as_size(total_removed_size))
+                << tag("by_atime", remove_by_atime_cnt) << tag("by_count", remove_by_count_cnt)
+                << tag("by_size", remove_by_size_cnt) << tag("time_immunity", time_immunity_ignored_cnt);
+
+  promise.set_value({std::move(kept_stats), std::move(removed_stats)});
+}
+
+void FileGcIndex::get_stats(bool split_by_owner_dialog_id, Promise<FileStats> promise) {
+  if (!is_complete(Clocks::system())) {
+    return promise.set_error(Status::Error(404, "Files GC index must be rebuilt"));
+  }
+
+  FileStats file_stats(false, split_by_owner_dialog_id);
+  for (auto &it : stat_by_owner_dialog_id_) {
+    for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+      if (it.second[i].cnt != 0) {
+        file_stats.add_stat(it.first, static_cast<FileType>(i), it.second[i]);
+      }
+    }
+  }
+  promise.set_value(std::move(file_stats));
+}
+
+}  // namespace td
@@ -0,0 +1,102 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/telegram/DialogId.h"
+#include "td/telegram/files/FileGcParameters.h"
+#include "td/telegram/files/FileGcWorker.h"
+#include "td/telegram/files/FileStats.h"
+#include "td/telegram/files/FileType.h"
+
+#include "td/actor/actor.h"
+
+#include "td/utils/CancellationToken.h"
+#include "td/utils/common.h"
+#include "td/utils/Promise.h"
+#include "td/utils/Slice.h"
+#include "td/utils/Status.h"
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+namespace td {
+
+class SqliteKeyValue;
+class SqliteKeyValueSafe;
+
+// persistent index of local files by their last access time with per-owner and per-type counters, which is updated
+// incrementally on file downloads, accesses and deletions and allows to run automatic files GC and to return
+// storage statistics without scanning of file directories
+class FileGcIndex final : public Actor {
+ public:
+  FileGcIndex(ActorShared<> parent, std::shared_ptr<SqliteKeyValueSafe> kv_safe);
+
+  void add_file(FileType file_type, string path, DialogId owner_dialog_id, int64 size, uint64 mtime_nsec);
+
+  void access_file(string path, DialogId owner_dialog_id);
+
+  void remove_file(string path);
+
+  // replaces all indexed files with the result of a full scan of file directories
+  void reset(vector<FullFileInfo> files);
+
+  // fails with error 404 if the index is incomplete or outdated and a full scan is required instead
+  void run_gc(FileGcParameters parameters, CancellationToken token, Promise<FileGcResult> promise);
+
+  // fails with error 404 if the index is incomplete or outdated and a full scan is required instead
+  void get_stats(bool split_by_owner_dialog_id, Promise<FileStats> promise);
+
+  struct Entry {
+    FileType file_type = FileType::Temp;
+    DialogId owner_dialog_id;
+    int64 size = 0;
+    uint32 atime = 0;
+    uint64 mtime_nsec = 0;
+  };
+
+  static string serialize_entry(const Entry &entry);
+
+  static Result<Entry> parse_entry(Slice value);
+
+ private:
+  static constexpr uint32 ACCESS_TIME_PRECISION = 60 * 60;  // 1 hour
+  static constexpr uint32 MAX_INDEX_AGE = 60 * 60 * 24 * 7;  // 1 week
+  static constexpr size_t ACCESS_TIME_LENGTH = 10;
+
+  ActorShared<> parent_;
+  std::shared_ptr<SqliteKeyValueSafe> kv_safe_;
+
+  using StatByType = std::array<FileTypeStat, MAX_FILE_TYPE>;
+
+  std::unordered_map<DialogId, StatByType, DialogIdHash> stat_by_owner_dialog_id_;
+  uint32 rebuilt_at_ = 0;
+
+  void start_up() final;
+
+  bool is_complete(double now) const;
+
+  StatByType get_stat_by_type() const;
+
+  SqliteKeyValue &kv();
+
+  static string get_path_key(Slice path);
+
+  static string get_access_time_key(uint32 atime, Slice path);
+
+  static string get_stat_key(DialogId owner_dialog_id, FileType file_type);
+
+  // must be called inside a transaction
+  void do_remove_file(Slice path, const Entry &entry);
+
+  // must be called inside a transaction
+  void do_add_file(Slice path, const Entry &entry);
+
+  void update_stat(const Entry &entry, int32 sign);
+};
+
+}  // namespace td
@@ -6,6 +6,8 @@
 //
 #include "td/telegram/files/FileGcWorker.h"
 
+#include "td/telegram/files/FileGcIndex.h"
+#include "td/telegram/files/FileLoaderUtils.h"
 #include "td/telegram/files/FileLocation.h"
 #include "td/telegram/files/FileManager.h"
 #include "td/telegram/files/FileType.h"
@@ -26,15 +28,7 @@ namespace td {
 
 int VERBOSITY_NAME(file_gc) = VERBOSITY_NAME(INFO);
 
-void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFileInfo> files,
-                          Promise<FileGcResult> promise) {
-  auto begin_time = Time::now();
-  VLOG(file_gc) << "Start files GC with " << parameters;
-  // quite stupid implementations
-  // needs a lot of memory
-  // may write something more clever, but i will need at least 2 passes over the files
-  // TODO update atime for all files in android (?)
-
+std::array<bool, MAX_FILE_TYPE> get_gc_immune_file_types(const FileGcParameters &parameters) {
   std::array<bool, MAX_FILE_TYPE> immune_types{{false}};
 
   if (G()->use_file_database()) {
@@ -63,6 +57,19 @@ void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFi
   if (G()->use_file_database()) {
     immune_types[narrow_cast<size_t>(FileType::EncryptedThumbnail)] = true;
   }
+  return immune_types;
+}
+
+void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFileInfo> files,
+                          Promise<FileGcResult> promise) {
+  auto begin_time = Time::now();
+  VLOG(file_gc) << "Start files GC with " << parameters;
+  // quite stupid implementations
+  // needs a lot of memory
+  // may write something more clever, but i will need at least 2 passes over the files
+  // TODO update atime for all files in android (?)
+
+  auto immune_types = get_gc_immune_file_types(parameters);
 
   auto file_cnt = files.size();
   int32 type_immunity_ignored_cnt = 0;
@@ -84,12 +91,15 @@ void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFi
   FileStats new_stats(false, parameters.dialog_limit_ != 0);
   FileStats removed_stats(false, parameters.dialog_limit_ != 0);
 
-  auto do_remove_file = [&removed_stats](const FullFileInfo &info) {
+  auto do_remove_file = [this, &removed_stats](const FullFileInfo &info) {
     removed_stats.add_copy(info);
     auto status = unlink(info.path);
     LOG_IF(WARNING, status.is_error()) << "Failed to unlink file \"" << info.path << "\" during files GC: " << status;
     send_closure(G()->file_manager(), &FileManager::on_file_unlink,
                  FullLocalFileLocation(info.file_type, info.path, info.mtime_nsec));
+    if (!gc_index_.empty()) {
+      send_closure(gc_index_, &FileGcIndex::remove_file, info.path);
+    }
   };
 
   double now = Clocks::system();
@@ -173,6 +183,8 @@ void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFi
     pos++;
   }
 
+  clean_shared_file_cache(parameters.immunity_delay_);
+
   auto end_time = Time::now();
 
   VLOG(file_gc) << "Finish files GC: " << tag("time", end_time - begin_time) << tag("total", file_cnt)
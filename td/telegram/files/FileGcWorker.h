@@ -8,6 +8,7 @@
 
 #include "td/telegram/files/FileGcParameters.h"
 #include "td/telegram/files/FileStats.h"
+#include "td/telegram/files/FileType.h"
 
 #include "td/actor/actor.h"
 
@@ -15,10 +16,17 @@
 #include "td/utils/logging.h"
 #include "td/utils/Promise.h"
 
+#include <array>
+
 namespace td {
 
 extern int VERBOSITY_NAME(file_gc);
 
+class FileGcIndex;
+
+// returns file types, files of which must not be deleted by files GC with the given parameters
+std::array<bool, MAX_FILE_TYPE> get_gc_immune_file_types(const FileGcParameters &parameters);
+
 struct FileGcResult {
   FileStats kept_file_stats_;
   FileStats removed_file_stats_;
@@ -26,13 +34,15 @@ struct FileGcResult {
 
 class FileGcWorker final : public Actor {
  public:
-  FileGcWorker(ActorShared<> parent, CancellationToken token) : parent_(std::move(parent)), token_(std::move(token)) {
+  FileGcWorker(ActorShared<> parent, CancellationToken token, ActorId<FileGcIndex> gc_index)
+      : parent_(std::move(parent)), token_(std::move(token)), gc_index_(std::move(gc_index)) {
   }
   void run_gc(const FileGcParameters &parameters, std::vector<FullFileInfo> files, Promise<FileGcResult> promise);
 
  private:
   ActorShared<> parent_;
   CancellationToken token_;
+  ActorId<FileGcIndex> gc_index_;
 };
 
 }  // namespace td
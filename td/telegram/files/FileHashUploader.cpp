@@ -10,8 +10,11 @@
 #include "td/telegram/Global.h"
 #include "td/telegram/net/DcId.h"
 #include "td/telegram/net/NetQueryDispatcher.h"
+#include "td/telegram/TdDb.h"
 #include "td/telegram/telegram_api.h"
 
+#include "td/db/SqliteKeyValueAsync.h"
+
 #include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/crypto.h"
@@ -21,6 +24,8 @@
 #include "td/utils/PathView.h"
 #include "td/utils/port/FileFd.h"
 #include "td/utils/port/PollFlags.h"
+#include "td/utils/port/Stat.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 
 namespace td {
@@ -32,14 +37,23 @@ void FileHashUploader::start_up() {
     stop_flag_ = true;
     return;
   }
+
+  if (G()->use_sqlite_pmc()) {
+    state_ = State::LoadSha;
+    G()->td_db()->get_sqlite_pmc()->get(get_hash_database_key(),
+                                        PromiseCreator::lambda([actor_id = actor_id(this)](string value) {
+                                          send_closure(actor_id, &FileHashUploader::on_load_hash, std::move(value));
+                                        }));
+  }
 }
 
 Status FileHashUploader::init() {
   TRY_RESULT(fd, FileFd::open(local_.path_, FileFd::Read));
-  TRY_RESULT(file_size, fd.get_size());
-  if (file_size != size_) {
+  TRY_RESULT(stat, fd.stat());
+  if (stat.size_ != size_) {
     return Status::Error("Size mismatch");
   }
+  mtime_nsec_ = stat.mtime_nsec_;
   fd_ = BufferedFd<FileFd>(std::move(fd));
   sha256_state_.init();
 
@@ -48,6 +62,40 @@ Status FileHashUploader::init() {
   return Status::OK();
 }
 
+string FileHashUploader::get_hash_database_key() const {
+  return PSTRING() << "fsha256" << local_.path_;
+}
+
+string FileHashUploader::get_hash_database_value() const {
+  return PSTRING() << size_ << ' ' << mtime_nsec_ << ' ' << hex_encode(hash_);
+}
+
+void FileHashUploader::on_load_hash(string value) {
+  if (stop_flag_) {
+    return;
+  }
+  CHECK(state_ == State::LoadSha);
+  state_ = State::CalcSha;
+
+  // the hash is reused only if neither size nor modification time of the file has changed since its calculation
+  auto parts = full_split(value, ' ');
+  if (parts.size() == 3 && to_integer<int64>(parts[0]) == size_ && to_integer<uint64>(parts[1]) == mtime_nsec_) {
+    auto r_hash = hex_decode(parts[2]);
+    if (r_hash.is_ok() && r_hash.ok().size() == 32) {
+      LOG(INFO) << "Use SHA-256 of " << local_.path_ << " from database";
+      hash_ = r_hash.move_as_ok();
+      state_ = State::NetRequest;
+    }
+  }
+  loop();
+}
+
+void FileHashUploader::save_hash() {
+  if (G()->use_sqlite_pmc()) {
+    G()->td_db()->get_sqlite_pmc()->set(get_hash_database_key(), get_hash_database_value(), Auto());
+  }
+}
+
 void FileHashUploader::loop() {
   if (stop_flag_) {
     return;
@@ -67,8 +115,7 @@ Status FileHashUploader::loop_impl() {
   }
   if (state_ == State::NetRequest) {
     // messages.getDocumentByHash#338e2464 sha256:bytes size:long mime_type:string = Document;
-    auto hash = BufferSlice(32);
-    sha256_state_.extract(hash.as_mutable_slice(), true);
+    auto hash = BufferSlice(hash_);
     auto mime_type = MimeType::from_extension(PathView(local_.path_).extension(), "image/gif");
     auto query = telegram_api::messages_getDocumentByHash(std::move(hash), size_, std::move(mime_type));
     LOG(INFO) << "Send getDocumentByHash request: " << to_string(query);
@@ -107,6 +154,9 @@ Status FileHashUploader::loop_sha() {
   size_left_ -= narrow_cast<int64>(read_size);
   CHECK(size_left_ >= 0);
   if (size_left_ == 0) {
+    hash_ = string(32, '\0');
+    sha256_state_.extract(hash_, true);
+    save_hash();
     state_ = State::NetRequest;
     return Status::OK();
   }
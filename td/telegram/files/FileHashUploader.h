@@ -13,6 +13,7 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/BufferedFd.h"
+#include "td/utils/common.h"
 #include "td/utils/crypto.h"
 #include "td/utils/port/FileFd.h"
 #include "td/utils/Status.h"
@@ -63,13 +64,23 @@ class FileHashUploader final : public FileLoaderActor {
 
   ActorShared<ResourceManager> resource_manager_;
 
-  enum class State : int32 { CalcSha, NetRequest, WaitNetResult } state_ = State::CalcSha;
+  enum class State : int32 { LoadSha, CalcSha, NetRequest, WaitNetResult } state_ = State::CalcSha;
   bool stop_flag_ = false;
   Sha256State sha256_state_;
+  uint64 mtime_nsec_ = 0;
+  string hash_;
 
   void start_up() final;
   Status init();
 
+  string get_hash_database_key() const;
+
+  string get_hash_database_value() const;
+
+  void on_load_hash(string value);
+
+  void save_hash();
+
   void loop() final;
 
   Status loop_impl();
@@ -0,0 +1,38 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/files/FileIoWorker.h"
+
+#include "td/utils/logging.h"
+#include "td/utils/Status.h"
+
+namespace td {
+
+void FileIoWorker::pread(std::shared_ptr<FileFd> fd, BufferSlice buffer, size_t size, int64 offset,
+                         Promise<BufferSlice> promise) {
+  CHECK(fd != nullptr);
+  CHECK(size <= buffer.size());
+  TRY_RESULT_PROMISE(promise, read_size, fd->pread(buffer.as_mutable_slice().truncate(size), offset));
+  if (read_size != size) {
+    return promise.set_error(Status::Error("Failed to read file part"));
+  }
+  promise.set_value(std::move(buffer));
+}
+
+void FileIoWorker::pwrite(std::shared_ptr<FileFd> fd, BufferSlice data, int64 offset, bool drop_page_cache,
+                          Promise<size_t> promise) {
+  CHECK(fd != nullptr);
+  TRY_RESULT_PROMISE(promise, written, fd->pwrite(data.as_slice(), offset));
+  if (drop_page_cache) {
+    auto status = fd->drop_page_cache(offset, static_cast<int64>(written));
+    if (status.is_error()) {
+      LOG(WARNING) << "Failed to drop written data from the page cache: " << status;
+    }
+  }
+  promise.set_value(std::move(written));
+}
+
+}  // namespace td
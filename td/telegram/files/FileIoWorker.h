@@ -0,0 +1,32 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/actor/actor.h"
+
+#include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/port/FileFd.h"
+#include "td/utils/Promise.h"
+
+#include <memory>
+
+namespace td {
+
+// Performs blocking reads and writes of file parts for file loaders, so that disk latency of one transfer doesn't
+// delay network queries of other transfers. Requests are completed in the order they were sent.
+class FileIoWorker final : public Actor {
+ public:
+  // reads exactly size bytes to the beginning of the buffer
+  void pread(std::shared_ptr<FileFd> fd, BufferSlice buffer, size_t size, int64 offset, Promise<BufferSlice> promise);
+
+  // returns the number of written bytes; if drop_page_cache, then the data is also removed from the page cache
+  void pwrite(std::shared_ptr<FileFd> fd, BufferSlice data, int64 offset, bool drop_page_cache,
+              Promise<size_t> promise);
+};
+
+}  // namespace td
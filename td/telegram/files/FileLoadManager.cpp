@@ -8,12 +8,14 @@
 
 #include "td/telegram/Global.h"
 #include "td/telegram/net/DcId.h"
+#include "td/telegram/net/NetQueryStats.h"
 
 #include "td/utils/common.h"
 #include "td/utils/filesystem.h"
 #include "td/utils/format.h"
 #include "td/utils/port/path.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
 
 namespace td {
 
@@ -22,13 +24,34 @@ FileLoadManager::FileLoadManager(ActorShared<Callback> callback, ActorShared<> p
 }
 
 void FileLoadManager::start_up() {
-  constexpr int64 MAX_UPLOAD_RESOURCE_LIMIT = 4 << 20;
   upload_resource_manager_ = create_actor<ResourceManager>(
-      "UploadResourceManager", MAX_UPLOAD_RESOURCE_LIMIT,
-      !G()->keep_media_order() ? ResourceManager::Mode::Greedy : ResourceManager::Mode::Baseline);
+      "UploadResourceManager", max_upload_resource_limit_,
+      !G()->keep_media_order() ? ResourceManager::Mode::Greedy : ResourceManager::Mode::Baseline,
+      upload_bandwidth_limiter_);
+  file_io_worker_ = create_actor_on_scheduler<FileIoWorker>("FileIoWorker", G()->get_file_io_scheduler_id());
   if (G()->get_option_boolean("is_premium")) {
     max_download_resource_limit_ *= 8;
   }
+  auto net_query_stats = G()->get_net_query_stats();
+  if (net_query_stats != nullptr) {
+    net_query_stats->on_upload_estimate_changed(0.0, 0.0, 0, max_upload_resource_limit_);
+  }
+  update_bandwidth_limits();
+}
+
+void FileLoadManager::update_bandwidth_limits() {
+  // all resource managers are run on the same scheduler, so they can share the limiters
+  auto now = Time::now();
+  download_bandwidth_limiter_->set_limit(G()->get_option_integer("download_bandwidth_limit"), now);
+  upload_bandwidth_limiter_->set_limit(G()->get_option_integer("upload_bandwidth_limit"), now);
+  for (auto *resource_managers : {&download_resource_manager_map_, &download_small_resource_manager_map_}) {
+    for (auto &it : *resource_managers) {
+      send_closure(it.second, &ResourceManager::on_bandwidth_limit_changed);
+    }
+  }
+  if (!upload_resource_manager_.empty()) {
+    send_closure(upload_resource_manager_, &ResourceManager::on_bandwidth_limit_changed);
+  }
 }
 
 ActorOwn<ResourceManager> &FileLoadManager::get_download_resource_manager(bool is_small, DcId dc_id) {
@@ -36,7 +59,7 @@ ActorOwn<ResourceManager> &FileLoadManager::get_download_resource_manager(bool i
   if (actor.empty()) {
     actor = create_actor<ResourceManager>(
         PSLICE() << "DownloadResourceManager " << tag("is_small", is_small) << tag("dc_id", dc_id),
-        max_download_resource_limit_, ResourceManager::Mode::Baseline);
+        max_download_resource_limit_, ResourceManager::Mode::Baseline, download_bandwidth_limiter_);
   }
   return actor;
 }
@@ -56,7 +79,7 @@ void FileLoadManager::download(QueryId query_id, const FullRemoteFileLocation &r
   bool is_small = size < 20 * 1024;
   node->loader_ =
       create_actor<FileDownloader>("Downloader", remote_location, local, size, std::move(name), encryption_key,
-                                   is_small, search_file, offset, limit, std::move(callback));
+                                   is_small, search_file, offset, limit, file_io_worker_.get(), std::move(callback));
   DcId dc_id = remote_location.is_web() ? G()->get_webfile_dc_id() : remote_location.get_dc_id();
   auto &resource_manager = get_download_resource_manager(is_small, dc_id);
   send_closure(resource_manager, &ResourceManager::register_worker,
@@ -77,7 +100,8 @@ void FileLoadManager::upload(QueryId query_id, const LocalFileLocation &local_lo
   node->query_id_ = query_id;
   auto callback = make_unique<FileUploaderCallback>(actor_shared(this, node_id));
   node->loader_ = create_actor<FileUploader>("Uploader", local_location, remote_location, expected_size, encryption_key,
-                                             std::move(bad_parts), std::move(callback));
+                                             std::move(bad_parts), upload_speed_estimator_.get_min_part_size(),
+                                             file_io_worker_.get(), std::move(callback));
   send_closure(upload_resource_manager_, &ResourceManager::register_worker,
                ActorShared<FileLoaderActor>(node->loader_.get(), static_cast<uint64>(-1)), priority);
   bool is_inserted = query_id_to_node_id_.emplace(query_id, node_id).second;
@@ -201,6 +225,7 @@ void FileLoadManager::update_downloaded_part(QueryId query_id, int64 offset, int
 
 void FileLoadManager::hangup() {
   nodes_container_.for_each([](auto query_id, auto &node) { node.loader_.reset(); });
+  update_upload_estimate(0.0, 0);
   stop_flag_ = true;
   loop();
 }
@@ -250,6 +275,39 @@ void FileLoadManager::on_partial_upload(PartialRemoteFileLocation partial_remote
   }
 }
 
+void FileLoadManager::on_part_uploaded(int32 part_size, int64 size, double rtt) {
+  upload_speed_estimator_.on_part_uploaded(size, rtt, Time::now());
+  auto net_query_stats = G()->get_net_query_stats();
+  if (net_query_stats != nullptr) {
+    net_query_stats->on_file_part_uploaded(part_size);
+  }
+  if (stop_flag_) {
+    return;
+  }
+
+  auto max_upload_resource_limit = upload_speed_estimator_.get_in_flight_limit();
+  if (max_upload_resource_limit != max_upload_resource_limit_) {
+    VLOG(file_loader) << "Change maximum size of uploaded parts in flight from " << max_upload_resource_limit_ << " to "
+                      << max_upload_resource_limit << " with speed " << upload_speed_estimator_.get_speed()
+                      << " and RTT " << upload_speed_estimator_.get_min_rtt();
+    send_closure(upload_resource_manager_, &ResourceManager::update_max_resource_limit, max_upload_resource_limit);
+  }
+  update_upload_estimate(upload_speed_estimator_.get_speed(), max_upload_resource_limit);
+}
+
+void FileLoadManager::update_upload_estimate(double speed, int64 max_upload_resource_limit) {
+  if (speed == upload_speed_ && max_upload_resource_limit == max_upload_resource_limit_) {
+    return;
+  }
+  auto net_query_stats = G()->get_net_query_stats();
+  if (net_query_stats != nullptr) {
+    net_query_stats->on_upload_estimate_changed(upload_speed_, speed, max_upload_resource_limit_,
+                                                max_upload_resource_limit);
+  }
+  upload_speed_ = speed;
+  max_upload_resource_limit_ = max_upload_resource_limit;
+}
+
 void FileLoadManager::on_ok_download(FullLocalFileLocation local, int64 size, bool is_new) {
   auto node_id = get_link_token();
   auto node = nodes_container_.get(node_id);
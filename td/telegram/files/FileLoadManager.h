@@ -6,15 +6,18 @@
 //
 #pragma once
 
+#include "td/telegram/files/BandwidthLimiter.h"
 #include "td/telegram/files/FileDownloader.h"
 #include "td/telegram/files/FileEncryptionKey.h"
 #include "td/telegram/files/FileFromBytes.h"
 #include "td/telegram/files/FileHashUploader.h"
+#include "td/telegram/files/FileIoWorker.h"
 #include "td/telegram/files/FileLoaderUtils.h"
 #include "td/telegram/files/FileLocation.h"
 #include "td/telegram/files/FileType.h"
 #include "td/telegram/files/FileUploader.h"
 #include "td/telegram/files/ResourceManager.h"
+#include "td/telegram/files/UploadSpeedEstimator.h"
 #include "td/telegram/net/DcId.h"
 
 #include "td/actor/actor.h"
@@ -26,6 +29,7 @@
 #include "td/utils/Status.h"
 
 #include <map>
+#include <memory>
 
 namespace td {
 
@@ -58,6 +62,7 @@ class FileLoadManager final : public Actor {
   void cancel(QueryId query_id);
   void update_local_file_location(QueryId query_id, const LocalFileLocation &local);
   void update_downloaded_part(QueryId query_id, int64 offset, int64 limit);
+  void update_bandwidth_limits();
 
   void get_content(string file_path, Promise<BufferSlice> promise);
 
@@ -81,12 +86,18 @@ class FileLoadManager final : public Actor {
   std::map<DcId, ActorOwn<ResourceManager>> download_resource_manager_map_;
   std::map<DcId, ActorOwn<ResourceManager>> download_small_resource_manager_map_;
   ActorOwn<ResourceManager> upload_resource_manager_;
+  std::shared_ptr<BandwidthLimiter> download_bandwidth_limiter_ = std::make_shared<BandwidthLimiter>();
+  std::shared_ptr<BandwidthLimiter> upload_bandwidth_limiter_ = std::make_shared<BandwidthLimiter>();
+  ActorOwn<FileIoWorker> file_io_worker_;
 
   Container<Node> nodes_container_;
   ActorShared<Callback> callback_;
   ActorShared<> parent_;
   std::map<QueryId, NodeId> query_id_to_node_id_;
   int64 max_download_resource_limit_ = 1 << 21;
+  UploadSpeedEstimator upload_speed_estimator_;
+  double upload_speed_ = 0.0;
+  int64 max_upload_resource_limit_ = UploadSpeedEstimator::MIN_IN_FLIGHT_SIZE;
   bool stop_flag_ = false;
 
   void start_up() final;
@@ -100,6 +111,8 @@ class FileLoadManager final : public Actor {
   void on_start_download();
   void on_partial_download(PartialLocalFileLocation partial_local, int64 ready_size, int64 size);
   void on_partial_upload(PartialRemoteFileLocation partial_remote, int64 ready_size);
+  void on_part_uploaded(int32 part_size, int64 size, double rtt);
+  void update_upload_estimate(double speed, int64 max_upload_resource_limit);
   void on_hash(string hash);
   void on_ok_download(FullLocalFileLocation local, int64 size, bool is_new);
   void on_ok_upload(FileType file_type, PartialRemoteFileLocation remote, int64 size);
@@ -143,6 +156,9 @@ class FileLoadManager final : public Actor {
     void on_partial_upload(PartialRemoteFileLocation partial_remote, int64 ready_size) final {
       send_closure(actor_id_, &FileLoadManager::on_partial_upload, std::move(partial_remote), ready_size);
     }
+    void on_part_uploaded(int32 part_size, int64 size, double rtt) final {
+      send_closure(actor_id_, &FileLoadManager::on_part_uploaded, part_size, size, rtt);
+    }
     void on_ok(FileType file_type, PartialRemoteFileLocation partial_remote, int64 size) final {
       send_closure(std::move(actor_id_), &FileLoadManager::on_ok_upload, file_type, std::move(partial_remote), size);
     }
@@ -17,6 +17,7 @@
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/ScopeGuard.h"
+#include "td/utils/Time.h"
 
 #include <tuple>
 
@@ -74,7 +75,9 @@ void FileLoader::update_local_file_location(const LocalFileLocation &local) {
 
 void FileLoader::update_downloaded_part(int64 offset, int64 limit, int64 max_resource_limit) {
   if (parts_manager_.get_streaming_offset() != offset) {
-    auto begin_part_id = parts_manager_.set_streaming_offset(offset, limit);
+    auto begin_part_id = parts_manager_.set_streaming_offset(offset, limit, Time::now());
+    // keep parts, which are already loaded in advance in the read-ahead window
+    limit = parts_manager_.get_streaming_limit();
     auto new_end_part_id = limit <= 0 ? parts_manager_.get_part_count()
                                       : narrow_cast<int32>((offset + limit - 1) / parts_manager_.get_part_size()) + 1;
     auto max_parts = narrow_cast<int32>(max_resource_limit / parts_manager_.get_part_size());
@@ -132,7 +135,7 @@ void FileLoader::start_up() {
   if (file_info.only_check) {
     parts_manager_.set_checked_prefix_size(0);
   }
-  parts_manager_.set_streaming_offset(file_info.offset, file_info.limit);
+  parts_manager_.set_streaming_offset(file_info.offset, file_info.limit, Time::now());
   if (ordered_flag_) {
     ordered_parts_ = OrderedEventsProcessor<std::pair<Part, NetQueryPtr>>(parts_manager_.get_ready_prefix_count());
   }
@@ -210,27 +213,48 @@ Status FileLoader::do_loop() {
     NetQueryPtr query;
     bool is_blocking;
     std::tie(query, is_blocking) = std::move(query_flag);
-    uint64 unique_id = UniqueId::next();
-    if (is_blocking) {
-      CHECK(blocking_id_ == 0);
-      blocking_id_ = unique_id;
-    }
-    part_map_[unique_id] = std::make_pair(part, query->cancel_slot_.get_signal_new());
-    // part_map_[unique_id] = std::make_pair(part, query.get_weak());
-
-    auto callback = actor_shared(this, unique_id);
-    if (delay_dispatcher_.empty()) {
-      G()->net_query_dispatcher().dispatch_with_callback(std::move(query), std::move(callback));
-    } else {
-      query->debug("sent to DelayDispatcher");
-      send_closure(delay_dispatcher_, &DelayDispatcher::send_with_callback_and_delay, std::move(query),
-                   std::move(callback), next_delay_);
-      next_delay_ = max(next_delay_ * 0.8, 0.003);
+    if (query.empty()) {
+      // the part is being read from the disk
+      CHECK(!is_blocking);
+      continue;
     }
+    send_part_query(part, std::move(query), is_blocking);
   }
   return Status::OK();
 }
 
+void FileLoader::on_part_started(Part part, Result<NetQueryPtr> r_net_query) {
+  if (stop_flag_) {
+    return;
+  }
+  if (r_net_query.is_error()) {
+    on_error(r_net_query.move_as_error());
+    stop_flag_ = true;
+    return;
+  }
+  send_part_query(part, r_net_query.move_as_ok(), false);
+}
+
+void FileLoader::send_part_query(Part part, NetQueryPtr query, bool is_blocking) {
+  uint64 unique_id = UniqueId::next();
+  if (is_blocking) {
+    CHECK(blocking_id_ == 0);
+    blocking_id_ = unique_id;
+  }
+  part_map_[unique_id] = std::make_pair(part, query->cancel_slot_.get_signal_new());
+  // part_map_[unique_id] = std::make_pair(part, query.get_weak());
+
+  auto callback = actor_shared(this, unique_id);
+  if (delay_dispatcher_.empty()) {
+    G()->net_query_dispatcher().dispatch_with_callback(std::move(query), std::move(callback));
+  } else {
+    query->debug("sent to DelayDispatcher");
+    send_closure(delay_dispatcher_, &DelayDispatcher::send_with_callback_and_delay, std::move(query),
+                 std::move(callback), next_delay_);
+    next_delay_ = max(next_delay_ * 0.8, 0.003);
+  }
+}
+
 void FileLoader::tear_down() {
   for (auto &it : part_map_) {
     it.second.second.reset();  // cancel_query(it.second.second);
@@ -317,23 +341,35 @@ void FileLoader::on_part_query(Part part, NetQueryPtr query) {
     // important for secret files
     return;
   }
-  auto status = try_on_part_query(part, std::move(query));
+  process_part(part, std::move(query),
+               PromiseCreator::lambda([actor_id = actor_id(this), part](Result<size_t> r_size) {
+                 send_closure(actor_id, &FileLoader::on_part_processed, part, std::move(r_size));
+               }));
+}
+
+void FileLoader::on_common_query(NetQueryPtr query) {
+  auto status = process_check_query(std::move(query));
   if (status.is_error()) {
     on_error(std::move(status));
     stop_flag_ = true;
   }
 }
 
-void FileLoader::on_common_query(NetQueryPtr query) {
-  auto status = process_check_query(std::move(query));
+void FileLoader::on_part_processed(Part part, Result<size_t> r_size) {
+  if (stop_flag_) {
+    return;
+  }
+  auto status = r_size.is_error() ? r_size.move_as_error() : try_on_part_processed(part, r_size.ok());
   if (status.is_error()) {
     on_error(std::move(status));
     stop_flag_ = true;
+    return;
   }
+  update_estimated_limit();
+  loop();
 }
 
-Status FileLoader::try_on_part_query(Part part, NetQueryPtr query) {
-  TRY_RESULT(size, process_part(part, std::move(query)));
+Status FileLoader::try_on_part_processed(Part part, size_t size) {
   VLOG(file_loader) << "Ok part " << tag("id", part.id) << tag("size", part.size);
   resource_state_.stop_use(static_cast<int64>(part.size));
   auto old_ready_prefix_count = parts_manager_.get_unchecked_ready_prefix_count();
@@ -18,6 +18,7 @@
 
 #include "td/utils/common.h"
 #include "td/utils/OrderedEventsProcessor.h"
+#include "td/utils/Promise.h"
 #include "td/utils/Status.h"
 
 #include <map>
@@ -68,11 +69,13 @@ class FileLoader : public FileLoaderActor {
   virtual Status before_start_parts() {
     return Status::OK();
   }
+  // returns an empty query if the query will be passed to on_part_started later
   virtual Result<std::pair<NetQueryPtr, bool>> start_part(Part part, int part_count,
                                                           int64 streaming_offset) TD_WARN_UNUSED_RESULT = 0;
   virtual void after_start_parts() {
   }
-  virtual Result<size_t> process_part(Part part, NetQueryPtr net_query) TD_WARN_UNUSED_RESULT = 0;
+  // the promise must be set with the number of bytes saved, possibly after the part is written asynchronously
+  virtual void process_part(Part part, NetQueryPtr net_query, Promise<size_t> promise) = 0;
   struct Progress {
     int32 part_count{0};
     int32 part_size{0};
@@ -108,6 +111,8 @@ class FileLoader : public FileLoaderActor {
   virtual void keep_fd_flag(bool keep_fd) {
   }
 
+  void on_part_started(Part part, Result<NetQueryPtr> r_net_query);
+
  private:
   static constexpr uint8 COMMON_QUERY_KEY = 2;
   bool stop_flag_ = false;
@@ -135,10 +140,13 @@ class FileLoader : public FileLoaderActor {
   void update_estimated_limit();
   void on_progress_impl();
 
+  void send_part_query(Part part, NetQueryPtr query, bool is_blocking);
+
   void on_result(NetQueryPtr query) final;
   void on_part_query(Part part, NetQueryPtr query);
   void on_common_query(NetQueryPtr query);
-  Status try_on_part_query(Part part, NetQueryPtr query);
+  void on_part_processed(Part part, Result<size_t> r_size);
+  Status try_on_part_processed(Part part, size_t size);
 };
 
 }  // namespace td
@@ -6,10 +6,13 @@
 //
 #include "td/telegram/files/FileLoaderUtils.h"
 
+#include "td/telegram/files/FileLocation.hpp"
 #include "td/telegram/Global.h"
 #include "td/telegram/TdDb.h"
 
+#include "td/utils/base64.h"
 #include "td/utils/common.h"
+#include "td/utils/crypto.h"
 #include "td/utils/filesystem.h"
 #include "td/utils/format.h"
 #include "td/utils/misc.h"
@@ -20,6 +23,7 @@
 #include "td/utils/Random.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/StringBuilder.h"
+#include "td/utils/tl_helpers.h"
 #include "td/utils/utf8.h"
 
 #include <tuple>
@@ -271,6 +275,75 @@ bool are_modification_times_equal(int64 old_mtime, int64 new_mtime) {
   return false;
 }
 
+static string get_shared_file_cache_dir() {
+  auto dir = G()->get_option_string("shared_file_cache_directory");
+  if (!dir.empty() && dir.back() != TD_DIR_SLASH) {
+    dir += TD_DIR_SLASH;
+  }
+  return dir;
+}
+
+string get_shared_file_cache_path(const FullRemoteFileLocation &location) {
+  if (location.is_web()) {
+    return string();
+  }
+  auto dir = get_shared_file_cache_dir();
+  if (dir.empty()) {
+    return string();
+  }
+  // the same as unique file identifier, which doesn't depend on the account
+  auto key = base64url_encode(zero_encode(serialize(location.as_unique())));
+  auto bucket = static_cast<uint8>(crc32(key));
+  return PSTRING() << dir << format::as_hex_dump(bucket) << TD_DIR_SLASH << key;
+}
+
+Result<string> link_from_shared_file_cache(FileType file_type, CSlice cache_path, int64 expected_size) {
+  TRY_RESULT(cache_stat, stat(cache_path));
+  if (!cache_stat.is_reg_ || cache_stat.size_ != expected_size) {
+    return Status::Error("Cached file has wrong size");
+  }
+  TRY_RESULT(fd_path, open_temp_file(file_type));
+  fd_path.first.close();
+  auto path = std::move(fd_path.second);
+  TRY_STATUS(unlink(path));
+  TRY_STATUS(link(cache_path, path));
+  return std::move(path);
+}
+
+void add_to_shared_file_cache(CSlice path, CSlice cache_path) {
+  mkpath(cache_path, 0750).ignore();
+  auto status = link(path, cache_path);
+  if (status.is_error()) {
+    LOG(INFO) << "Failed to add file to the shared file cache: " << status;
+  }
+}
+
+void clean_shared_file_cache(double immunity_delay) {
+  auto dir = get_shared_file_cache_dir();
+  if (dir.empty()) {
+    return;
+  }
+  auto now = Clocks::system();
+  auto status = WalkPath::run(dir, [&](CSlice path, WalkPath::Type type) {
+    if (type != WalkPath::Type::RegularFile) {
+      return;
+    }
+    auto r_stat = stat(path);
+    if (r_stat.is_error()) {
+      return;
+    }
+    // the last hard link belongs to the cache itself
+    const auto &file_stat = r_stat.ok();
+    if (file_stat.link_count_ <= 1 && static_cast<double>(file_stat.mtime_nsec_) * 1e-9 + immunity_delay < now) {
+      VLOG(file_loader) << "Remove unused file \"" << path << "\" from the shared file cache";
+      unlink(path).ignore();
+    }
+  });
+  if (status.is_error()) {
+    LOG(INFO) << "Failed to clean the shared file cache: " << status;
+  }
+}
+
 Result<FullLocalLocationInfo> check_full_local_location(FullLocalLocationInfo local_info, bool skip_file_size_checks) {
   constexpr int64 MAX_FILE_SIZE = static_cast<int64>(4000) << 20 /* 4000 MB */;
   constexpr int64 MAX_THUMBNAIL_SIZE = 200 * (1 << 10) - 1 /* 200 KB - 1 B */;
@@ -40,6 +40,18 @@ string get_files_dir(FileType file_type);
 
 bool are_modification_times_equal(int64 old_mtime, int64 new_mtime);
 
+// returns path of the file in the shared file cache or an empty string if the cache isn't used
+string get_shared_file_cache_path(const FullRemoteFileLocation &location);
+
+// returns path to a new temporary file, which is a hard link to the file in the shared file cache
+Result<string> link_from_shared_file_cache(FileType file_type, CSlice cache_path,
+                                           int64 expected_size) TD_WARN_UNUSED_RESULT;
+
+void add_to_shared_file_cache(CSlice path, CSlice cache_path);
+
+// removes files from the shared file cache, which aren't linked from any other place
+void clean_shared_file_cache(double immunity_delay);
+
 struct FullLocalLocationInfo {
   FullLocalFileLocation location_;
   int64 size_ = 0;
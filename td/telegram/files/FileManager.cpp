@@ -16,6 +16,7 @@
 #include "td/telegram/files/FileLocation.hpp"
 #include "td/telegram/Global.h"
 #include "td/telegram/logevent/LogEvent.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/misc.h"
 #include "td/telegram/SecureStorage.h"
 #include "td/telegram/TdDb.h"
@@ -895,7 +896,8 @@ void FileManager::init_actor() {
 FileManager::~FileManager() {
   Scheduler::instance()->destroy_on_scheduler(
       G()->get_gc_scheduler_id(), remote_location_info_, file_hash_to_file_id_, remote_location_to_file_id_,
-      local_location_to_file_id_, generate_location_to_file_id_, file_id_info_, empty_file_ids_, file_nodes_);
+      local_location_to_file_id_, generate_location_to_file_id_, file_id_info_, empty_file_ids_, file_nodes_,
+      compact_file_nodes_);
 }
 
 string FileManager::fix_file_extension(Slice file_name, Slice file_type, Slice file_extension) {
@@ -1372,6 +1374,7 @@ Result<FileId> FileManager::register_file(FileData &&data, FileLocationSource fi
   node->pmc_id_ = FileDbId(data.pmc_id_);
   get_file_id_info(file_id)->node_id_ = file_node_id;
   node->file_ids_.push_back(file_id);
+  add_compaction_candidate(file_node_id);
 
   FileView file_view(get_file_node(file_id));
 
@@ -2004,6 +2007,20 @@ FlatHashSet<FileId, FileIdHash> FileManager::get_main_file_ids(const vector<File
   return result;
 }
 
+void FileManager::on_local_file_used(FileNodePtr node, bool is_new) {
+  CHECK(node);
+  if (node->local_.type() != LocalFileLocation::Type::Full) {
+    return;
+  }
+  const auto &location = node->local_.full();
+  if (!begins_with(location.path_, get_files_dir(location.file_type_))) {
+    // files outside of the cache are never deleted by files GC
+    return;
+  }
+  int64 real_size = is_new ? FileView(node).get_allocated_local_size() : 0;
+  context_->on_local_file_used(location, node->owner_dialog_id_, real_size, is_new);
+}
+
 void FileManager::try_flush_node_full(FileNodePtr node, bool new_remote, bool new_local, bool new_generate,
                                       FileDbId other_pmc_id) {
   if (node->need_pmc_flush()) {
@@ -2127,6 +2144,119 @@ void FileManager::flush_to_pmc(FileNodePtr node, bool new_remote, bool new_local
                           (create_flag || new_generate));
 }
 
+class FileManager::CompactFileNode {
+ public:
+  unique_ptr<FileNode> node_;
+
+  CompactFileNode() = default;
+
+  explicit CompactFileNode(const FileNode *node) : stored_node_(node) {
+  }
+
+  template <class StorerT>
+  void store(StorerT &storer) const {
+    using td::store;
+    const FileNode &node = *stored_node_;
+    CHECK(is_remote_only_file_node(node));
+    BEGIN_STORE_FLAGS();
+    STORE_FLAG(node.remote_.is_full_alive);
+    STORE_FLAG(node.get_by_hash_);
+    STORE_FLAG(node.can_search_locally_);
+    STORE_FLAG(node.need_reload_photo_);
+    STORE_FLAG(node.upload_prefer_small_);
+    STORE_FLAG(node.need_load_from_pmc_);
+    END_STORE_FLAGS();
+    store(node.remote_.full.value(), storer);
+    store(static_cast<int32>(node.remote_.full_source), storer);
+    store(node.remote_.ready_size, storer);
+    store(node.size_, storer);
+    store(node.expected_size_, storer);
+    store(node.remote_name_, storer);
+    store(node.owner_dialog_id_, storer);
+    store(node.pmc_id_.get(), storer);
+    store(narrow_cast<int32>(node.file_ids_.size()), storer);
+    for (auto file_id : node.file_ids_) {
+      store(file_id.get(), storer);
+      store(file_id.get_remote(), storer);
+    }
+    store(node.main_file_id_.get(), storer);
+    store(node.main_file_id_.get_remote(), storer);
+    store(static_cast<int32>(node.main_file_id_priority_), storer);
+  }
+
+  template <class ParserT>
+  void parse(ParserT &parser) {
+    using td::parse;
+    bool is_full_alive;
+    bool get_by_hash;
+    bool can_search_locally;
+    bool need_reload_photo;
+    bool upload_prefer_small;
+    bool need_load_from_pmc;
+    BEGIN_PARSE_FLAGS();
+    PARSE_FLAG(is_full_alive);
+    PARSE_FLAG(get_by_hash);
+    PARSE_FLAG(can_search_locally);
+    PARSE_FLAG(need_reload_photo);
+    PARSE_FLAG(upload_prefer_small);
+    PARSE_FLAG(need_load_from_pmc);
+    END_PARSE_FLAGS();
+    FullRemoteFileLocation remote;
+    int32 full_source;
+    int64 ready_size;
+    int64 size;
+    int64 expected_size;
+    string remote_name;
+    DialogId owner_dialog_id;
+    uint64 pmc_id;
+    int32 file_id_count;
+    parse(remote, parser);
+    parse(full_source, parser);
+    parse(ready_size, parser);
+    parse(size, parser);
+    parse(expected_size, parser);
+    parse(remote_name, parser);
+    parse(owner_dialog_id, parser);
+    parse(pmc_id, parser);
+    parse(file_id_count, parser);
+    vector<FileId> file_ids;
+    for (int32 i = 0; i < file_id_count && parser.get_error() == nullptr; i++) {
+      int32 file_id;
+      int32 remote_id;
+      parse(file_id, parser);
+      parse(remote_id, parser);
+      file_ids.emplace_back(file_id, remote_id);
+    }
+    int32 main_file_id;
+    int32 main_remote_id;
+    int32 main_file_id_priority;
+    parse(main_file_id, parser);
+    parse(main_remote_id, parser);
+    parse(main_file_id_priority, parser);
+    if (parser.get_error() != nullptr) {
+      return;
+    }
+
+    node_ = td::make_unique<FileNode>(
+        LocalFileLocation(),
+        NewRemoteFileLocation(RemoteFileLocation(std::move(remote)), static_cast<FileLocationSource>(full_source)),
+        nullptr, size, expected_size, std::move(remote_name), string(), owner_dialog_id, FileEncryptionKey(),
+        FileId(main_file_id, main_remote_id), static_cast<int8>(main_file_id_priority));
+    node_->remote_.is_full_alive = is_full_alive;
+    node_->remote_.ready_size = ready_size;
+    node_->pmc_id_ = FileDbId(pmc_id);
+    node_->file_ids_ = std::move(file_ids);
+    node_->get_by_hash_ = get_by_hash;
+    node_->can_search_locally_ = can_search_locally;
+    node_->need_reload_photo_ = need_reload_photo;
+    node_->upload_prefer_small_ = upload_prefer_small;
+    node_->need_load_from_pmc_ = need_load_from_pmc;
+  }
+
+ private:
+  const FileNode *stored_node_ = nullptr;
+};
+
 FileNode *FileManager::get_file_node_raw(FileId file_id, FileNodeId *file_node_id) {
   if (file_id.get() <= 0 || file_id.get() >= static_cast<int32>(file_id_info_.size())) {
     return nullptr;
@@ -2138,7 +2268,69 @@ FileNode *FileManager::get_file_node_raw(FileId file_id, FileNodeId *file_node_i
   if (file_node_id != nullptr) {
     *file_node_id = node_id;
   }
-  return file_nodes_[node_id].get();
+  auto &node = file_nodes_[node_id];
+  if (node == nullptr && compact_file_nodes_.count(node_id) != 0) {
+    CompactFileNode compact_node;
+    log_event_parse(compact_node, compact_file_nodes_[node_id].as_slice()).ensure();
+    compact_file_nodes_.erase(node_id);
+    node = std::move(compact_node.node_);
+    add_compaction_candidate(node_id);
+  }
+  return node.get();
+}
+
+bool FileManager::is_remote_only_file_node(const FileNode &node) {
+  return node.local_.type() == LocalFileLocation::Type::Empty && node.remote_.full && node.remote_.partial == nullptr &&
+         node.generate_ == nullptr && node.url_.empty() && node.encryption_key_.empty();
+}
+
+bool FileManager::is_idle_file_node(const FileNode &node) {
+  return node.upload_id_ == 0 && node.download_id_ == 0 && node.generate_id_ == 0 && node.download_offset_ == 0 &&
+         node.private_download_limit_ == 0 && node.last_successful_force_reupload_time_ < 0 &&
+         !node.upload_pause_.is_valid() && node.upload_priority_ == 0 && node.download_priority_ == 0 &&
+         node.generate_priority_ == 0 && node.generate_download_priority_ == 0 &&
+         node.generate_upload_priority_ == 0 && !node.is_download_offset_dirty_ && !node.is_download_limit_dirty_ &&
+         !node.is_download_started_ && !node.generate_was_update_ && !node.pmc_changed_flag_ &&
+         !node.info_changed_flag_ && !node.upload_was_update_file_reference_ &&
+         !node.download_was_update_file_reference_ && !node.ignore_download_limit_;
+}
+
+void FileManager::add_compaction_candidate(FileNodeId file_node_id) {
+  compaction_candidate_file_node_ids_.push_back(file_node_id);
+  if (!empty() && !is_closed_ && !has_timeout()) {
+    set_timeout_in(FILE_NODE_COMPACTION_DELAY);
+  }
+}
+
+void FileManager::compact_file_nodes() {
+  auto file_node_ids = std::move(compaction_candidate_file_node_ids_);
+  compaction_candidate_file_node_ids_.clear();
+  size_t compacted_file_node_count = 0;
+  for (auto file_node_id : file_node_ids) {
+    auto &node = file_nodes_[file_node_id];
+    if (node == nullptr || !is_remote_only_file_node(*node)) {
+      continue;
+    }
+    if (!is_idle_file_node(*node)) {
+      // the node will be compacted after it becomes unused
+      compaction_candidate_file_node_ids_.push_back(file_node_id);
+      continue;
+    }
+    compact_file_nodes_.set(file_node_id, log_event_store(CompactFileNode(node.get())));
+    node = nullptr;
+    compacted_file_node_count++;
+  }
+  LOG(DEBUG) << "Compact " << compacted_file_node_count << " out of " << file_node_ids.size() << " file nodes";
+}
+
+void FileManager::timeout_expired() {
+  if (is_closed_) {
+    return;
+  }
+  compact_file_nodes();
+  if (!compaction_candidate_file_node_ids_.empty()) {
+    set_timeout_in(FILE_NODE_COMPACTION_DELAY);
+  }
 }
 
 FileNodePtr FileManager::get_sync_file_node(FileId file_id) {
@@ -2181,21 +2373,38 @@ void FileManager::load_from_pmc(FileNodePtr node, bool new_remote, bool new_loca
 
   LOG(DEBUG) << "Load from pmc file " << file_id << '/' << file_view.get_main_file_id()
              << ", new_remote = " << new_remote << ", new_local = " << new_local << ", new_generate = " << new_generate;
-  auto load = [&](auto location, const char *source) {
-    TRY_RESULT(file_data, file_db_->get_file_data_sync(location));
-    TRY_RESULT(new_file_id,
-               register_file(std::move(file_data), FileLocationSource::FromDatabase, FileId(), source, false));
-    TRY_STATUS(merge(file_id, new_file_id));  // merge manually to keep merge parameters order
-    return Status::OK();
-  };
+  vector<string> keys;
+  vector<const char *> sources;
   if (new_remote) {
-    load(remote, "load remote from database").ignore();
+    keys.push_back(FileDbInterface::as_key(remote));
+    sources.push_back("load remote from database");
   }
   if (new_local) {
-    load(local, "load local from database").ignore();
+    keys.push_back(FileDbInterface::as_key(local));
+    sources.push_back("load local from database");
   }
   if (new_generate) {
-    load(generate, "load generate from database").ignore();
+    keys.push_back(FileDbInterface::as_key(generate));
+    sources.push_back("load generate from database");
+  }
+  if (keys.empty()) {
+    return;
+  }
+
+  // all locations are looked up at once and merged in the same order as before
+  auto results = file_db_->get_file_data_batch_sync(std::move(keys));
+  CHECK(results.size() == sources.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    if (results[i].is_error()) {
+      LOG(DEBUG) << "Failed to " << sources[i] << ": " << results[i].error();
+      continue;
+    }
+    auto r_new_file_id =
+        register_file(results[i].move_as_ok(), FileLocationSource::FromDatabase, FileId(), sources[i], false);
+    if (r_new_file_id.is_error()) {
+      continue;
+    }
+    merge(file_id, r_new_file_id.ok()).ignore();  // merge manually to keep merge parameters order
   }
 }
 
@@ -2250,6 +2459,10 @@ bool FileManager::set_content(FileId file_id, BufferSlice bytes) {
   return true;
 }
 
+void FileManager::on_bandwidth_limits_changed() {
+  send_closure(file_load_manager_, &FileLoadManager::update_bandwidth_limits);
+}
+
 void FileManager::get_content(FileId file_id, Promise<BufferSlice> promise) {
   auto node = get_sync_file_node(file_id);
   if (!node) {
@@ -2261,6 +2474,7 @@ void FileManager::get_content(FileId file_id, Promise<BufferSlice> promise) {
   if (!file_view.has_local_location()) {
     return promise.set_error(Status::Error("No local location"));
   }
+  on_local_file_used(node, false);
 
   send_closure(file_load_manager_, &FileLoadManager::get_content, node->local_.full().path_, std::move(promise));
 }
@@ -2305,6 +2519,7 @@ void FileManager::read_file_part(FileId file_id, int64 offset, int64 count, int
     if (!begins_with(*path, get_files_dir(file_view.get_type()))) {
       return promise.set_error(Status::Error(400, "File is not inside the cache"));
     }
+    on_local_file_used(node, false);
   } else {
     CHECK(node->local_.type() == LocalFileLocation::Type::Partial);
     path = &node->local_.partial().path_;
@@ -2372,6 +2587,7 @@ void FileManager::delete_file(FileId file_id, Promise<Unit> promise, const char
   }
 
   LOG(INFO) << "Unlink file " << file_id << " at " << path;
+  context_->on_local_file_deleted(path);
   node->drop_local_location();
   try_flush_node(node, "delete_file");
   send_closure(file_load_manager_, &FileLoadManager::unlink_file, path, std::move(promise));
@@ -2424,6 +2640,7 @@ void FileManager::download_impl(FileId file_id, std::shared_ptr<DownloadCallback
   }
   if (node->local_.type() == LocalFileLocation::Type::Full) {
     LOG(INFO) << "File " << file_id << " is already downloaded";
+    on_local_file_used(node, false);
     if (callback) {
       callback->on_download_ok(file_id);
     }
@@ -3304,6 +3521,30 @@ td_api::object_ptr<td_api::file> FileManager::get_file_object(FileId file_id, bo
                                               file_node->is_uploading(), is_uploading_completed, remote_size));
 }
 
+void FileManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  size_t file_node_count = 0;
+  for (size_t i = 0; i < file_nodes_.size(); i++) {
+    if (file_nodes_[i] != nullptr) {
+      file_node_count++;
+    }
+  }
+  statistics.add("FileManager", "file_nodes", file_node_count, sizeof(unique_ptr<FileNode>) + sizeof(FileNode));
+  size_t compact_file_nodes_size = 0;
+  compact_file_nodes_.foreach([&compact_file_nodes_size](const FileNodeId &file_node_id, const BufferSlice &data) {
+    compact_file_nodes_size += sizeof(FileNodeId) + sizeof(BufferSlice) + data.size();
+  });
+  statistics.add_total("FileManager", "compact_file_nodes", compact_file_nodes_.calc_size(), compact_file_nodes_size);
+  statistics.add("FileManager", "file_id_info", file_id_info_.size(), sizeof(FileIdInfo));
+  statistics.add("FileManager", "file_hash_to_file_id", file_hash_to_file_id_.calc_size(),
+                 sizeof(string) + sizeof(FileId));
+  statistics.add("FileManager", "remote_location_to_file_id", remote_location_to_file_id_.size(),
+                 sizeof(FullRemoteFileLocation) + sizeof(FileId));
+  statistics.add("FileManager", "local_location_to_file_id", local_location_to_file_id_.size(),
+                 sizeof(FullLocalFileLocation) + sizeof(FileId));
+  statistics.add("FileManager", "generate_location_to_file_id", generate_location_to_file_id_.size(),
+                 sizeof(FullGenerateFileLocation) + sizeof(FileId));
+}
+
 vector<int32> FileManager::get_file_ids_object(const vector<FileId> &file_ids, bool with_main_file_id) {
   return transform(file_ids, [this, with_main_file_id](FileId file_id) {
     auto file_view = get_sync_file_view(file_id);
@@ -3802,6 +4043,7 @@ void FileManager::on_download_ok(QueryId query_id, FullLocalFileLocation local,
     if (is_new && context_->need_notify_on_new_files()) {
       context_->on_new_file(size, get_file_view(r_new_file_id.ok()).get_allocated_local_size(), 1);
     }
+    on_local_file_used(get_file_node(r_new_file_id.ok()), true);
   }
   if (status.is_error()) {
     LOG(ERROR) << status.message();
@@ -3968,6 +4210,7 @@ void FileManager::on_generate_ok(QueryId query_id, FullLocalFileLocation local)
       context_->on_new_file(file_view.size(), file_view.get_allocated_local_size(), 1);
     }
   }
+  on_local_file_used(file_node, true);
 
   run_upload(file_node, {});
 
@@ -4226,5 +4469,6 @@ void FileManager::tear_down() {
 constexpr int64 FileManager::KEEP_DOWNLOAD_LIMIT;
 constexpr int64 FileManager::KEEP_DOWNLOAD_OFFSET;
 constexpr int64 FileManager::IGNORE_DOWNLOAD_LIMIT;
+constexpr double FileManager::FILE_NODE_COMPACTION_DELAY;
 
 }  // namespace td
@@ -48,6 +48,7 @@ extern int VERBOSITY_NAME(update_file);
 
 class FileData;
 class FileDbInterface;
+class MemoryStatistics;
 
 enum class FileLocationSource : int8 { None, FromUser, FromBinlog, FromDatabase, FromServer };
 
@@ -416,6 +417,11 @@ class FileManager final : public FileLoadManager::Callback {
 
     virtual void on_new_file(int64 size, int64 real_size, int32 cnt) = 0;
 
+    virtual void on_local_file_used(const FullLocalFileLocation &location, DialogId owner_dialog_id, int64 real_size,
+                                    bool is_new) = 0;
+
+    virtual void on_local_file_deleted(const string &path) = 0;
+
     virtual void on_file_updated(FileId size) = 0;
 
     virtual bool add_file_source(FileId file_id, FileSourceId file_source_id) = 0;
@@ -508,6 +514,8 @@ class FileManager final : public FileLoadManager::Callback {
 
   void delete_file(FileId file_id, Promise<Unit> promise, const char *source);
 
+  void on_bandwidth_limits_changed();
+
   void external_file_generate_write_part(int64 generation_id, int64 offset, string data, Promise<> promise);
   void external_file_generate_progress(int64 generation_id, int64 expected_size, int64 local_prefix_size,
                                        Promise<> promise);
@@ -519,6 +527,8 @@ class FileManager final : public FileLoadManager::Callback {
   td_api::object_ptr<td_api::file> get_file_object(FileId file_id, bool with_main_file_id = true);
   vector<int32> get_file_ids_object(const vector<FileId> &file_ids, bool with_main_file_id = true);
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   Result<FileId> get_input_thumbnail_file_id(const tl_object_ptr<td_api::InputFile> &thumbnail_input_file,
                                              DialogId owner_dialog_id, bool is_encrypted) TD_WARN_UNUSED_RESULT;
   Result<FileId> get_input_file_id(FileType type, const tl_object_ptr<td_api::InputFile> &file,
@@ -634,6 +644,13 @@ class FileManager final : public FileLoadManager::Callback {
   WaitFreeVector<FileIdInfo> file_id_info_;
   WaitFreeVector<int32> empty_file_ids_;
   WaitFreeVector<unique_ptr<FileNode>> file_nodes_;
+
+  // remote-only file nodes, which aren't used now, are kept serialized instead of file_nodes_
+  static constexpr double FILE_NODE_COMPACTION_DELAY = 60.0;
+  class CompactFileNode;
+  WaitFreeHashMap<FileNodeId, BufferSlice> compact_file_nodes_;
+  vector<FileNodeId> compaction_candidate_file_node_ids_;
+
   ActorOwn<FileLoadManager> file_load_manager_;
   ActorOwn<FileGenerateManager> file_generate_manager_;
 
@@ -675,6 +692,7 @@ class FileManager final : public FileLoadManager::Callback {
   static bool try_fix_partial_local_location(FileNodePtr node);
   void try_flush_node_full(FileNodePtr node, bool new_remote, bool new_local, bool new_generate, FileDbId other_pmc_id);
   void try_flush_node(FileNodePtr node, const char *source);
+  void on_local_file_used(FileNodePtr node, bool is_new);
   void try_flush_node_info(FileNodePtr node, const char *source);
   void try_flush_node_pmc(FileNodePtr node, const char *source);
   void clear_from_pmc(FileNodePtr node);
@@ -697,6 +715,11 @@ class FileManager final : public FileLoadManager::Callback {
   }
   FileNode *get_file_node_raw(FileId file_id, FileNodeId *file_node_id = nullptr);
 
+  void add_compaction_candidate(FileNodeId file_node_id);
+  static bool is_remote_only_file_node(const FileNode &node);
+  static bool is_idle_file_node(const FileNode &node);
+  void compact_file_nodes();
+
   FileNodePtr get_sync_file_node(FileId file_id);
 
   void on_force_reupload_success(FileId file_id);
@@ -730,6 +753,7 @@ class FileManager final : public FileLoadManager::Callback {
   FlatHashSet<FileId, FileIdHash> get_main_file_ids(const vector<FileId> &file_ids);
 
   void hangup() final;
+  void timeout_expired() final;
   void tear_down() final;
 
   friend class FileNodePtr;
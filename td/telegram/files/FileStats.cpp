@@ -53,6 +53,14 @@ void FileStats::add(FullFileInfo &&info) {
   }
 }
 
+void FileStats::add_stat(DialogId owner_dialog_id, FileType file_type, const FileTypeStat &stat) {
+  auto pos = static_cast<size_t>(file_type);
+  CHECK(pos < stat_by_type_.size());
+  auto &by_type = split_by_owner_dialog_id_ ? stat_by_owner_dialog_id_[owner_dialog_id] : stat_by_type_;
+  by_type[pos].size += stat.size;
+  by_type[pos].cnt += stat.cnt;
+}
+
 FileTypeStat FileStats::get_nontemp_stat(const FileStats::StatByType &by_type) {
   FileTypeStat stat;
   for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
@@ -96,6 +96,8 @@ class FileStats {
 
   void add(FullFileInfo &&info);
 
+  void add_stat(DialogId owner_dialog_id, FileType file_type, const FileTypeStat &stat);
+
   void apply_dialog_limit(int32 limit);
 
   void apply_dialog_ids(const vector<DialogId> &dialog_ids);
@@ -7,6 +7,7 @@
 #include "td/telegram/files/FileUploader.h"
 
 #include "td/telegram/files/FileLoaderUtils.h"
+#include "td/telegram/files/PartsManager.h"
 #include "td/telegram/Global.h"
 #include "td/telegram/net/DcId.h"
 #include "td/telegram/net/NetQueryDispatcher.h"
@@ -22,17 +23,20 @@
 #include "td/utils/port/path.h"
 #include "td/utils/Random.h"
 #include "td/utils/ScopeGuard.h"
+#include "td/utils/Time.h"
 
 namespace td {
 
 FileUploader::FileUploader(const LocalFileLocation &local, const RemoteFileLocation &remote, int64 expected_size,
                            const FileEncryptionKey &encryption_key, std::vector<int> bad_parts,
-                           unique_ptr<Callback> callback)
+                           size_t min_part_size, ActorId<FileIoWorker> file_io_worker, unique_ptr<Callback> callback)
     : local_(local)
     , remote_(remote)
     , expected_size_(expected_size)
     , encryption_key_(encryption_key)
     , bad_parts_(std::move(bad_parts))
+    , min_part_size_(min_part_size)
+    , file_io_worker_(file_io_worker)
     , callback_(std::move(callback)) {
   if (encryption_key_.is_secret()) {
     iv_ = encryption_key_.mutable_iv();
@@ -86,6 +90,10 @@ Result<FileLoader::FileInfo> FileUploader::init() {
     file_id_ = Random::secure_int64();
     big_flag_ = is_file_big(file_type_, expected_size_);
   }
+  if (part_size == 0 && local_is_ready_ && min_part_size_ > 0) {
+    // part size can't be changed during upload, so it is chosen once based on the previously measured upload speed
+    part_size = narrow_cast<int>(PartsManager::calc_part_size(local_size_, min_part_size_));
+  }
 
   LOG(DEBUG) << "Init file uploader for " << remote_ << " with offset = " << offset << " and part size = " << part_size;
   FileInfo res;
@@ -150,7 +158,7 @@ Result<FileLoader::PrefixInfo> FileUploader::on_update_local_location(const Loca
     is_temp = true;
   }
 
-  if (!path.empty() && (path != fd_path_ || fd_.empty())) {
+  if (!path.empty() && (path != fd_path_ || fd_ == nullptr)) {
     auto res_fd = FileFd::open(path, FileFd::Read);
 
     // Race: partial location could be already deleted. Just ignore such locations
@@ -165,20 +173,19 @@ Result<FileLoader::PrefixInfo> FileUploader::on_update_local_location(const Loca
       return res_fd.move_as_error();
     }
 
-    fd_.close();
-    fd_ = res_fd.move_as_ok();
+    fd_ = std::make_shared<FileFd>(res_fd.move_as_ok());
     fd_path_ = path;
     is_temp_ = is_temp;
   }
   if (local_is_ready) {
-    CHECK(!fd_.empty());
-    TRY_RESULT_ASSIGN(local_size, fd_.get_size());
+    CHECK(fd_ != nullptr);
+    TRY_RESULT_ASSIGN(local_size, fd_->get_size());
     LOG(INFO) << "Set file local_size to " << local_size;
     if (local_size == 0) {
       return Status::Error("Can't upload empty file");
     }
-  } else if (!fd_.empty()) {
-    TRY_RESULT(real_local_size, fd_.get_size());
+  } else if (fd_ != nullptr) {
+    TRY_RESULT(real_local_size, fd_->get_size());
     if (real_local_size < local_size) {
       LOG(ERROR) << tag("real_local_size", real_local_size) << " < " << tag("local_size", local_size);
       PrefixInfo info;
@@ -201,7 +208,7 @@ Result<FileLoader::PrefixInfo> FileUploader::on_update_local_location(const Loca
 }
 
 Status FileUploader::on_ok(int64 size) {
-  fd_.close();
+  fd_ = nullptr;
   if (is_temp_) {
     LOG(INFO) << "UNLINK " << fd_path_;
     unlink(fd_path_).ignore();
@@ -210,7 +217,7 @@ Status FileUploader::on_ok(int64 size) {
 }
 
 void FileUploader::on_error(Status status) {
-  fd_.close();
+  fd_ = nullptr;
   if (is_temp_) {
     LOG(INFO) << "UNLINK " << fd_path_;
     unlink(fd_path_).ignore();
@@ -226,10 +233,10 @@ Status FileUploader::generate_iv_map() {
   if (iv_map_.empty()) {
     iv_map_.push_back(encryption_key.mutable_iv());
   }
-  CHECK(!fd_.empty());
+  CHECK(fd_ != nullptr);
   for (; generate_offset_ + static_cast<int64>(part_size) < local_size_;
        generate_offset_ += static_cast<int64>(part_size)) {
-    TRY_RESULT(read_size, fd_.pread(bytes.as_mutable_slice(), generate_offset_));
+    TRY_RESULT(read_size, fd_->pread(bytes.as_mutable_slice(), generate_offset_));
     if (read_size != part_size) {
       return Status::Error("Failed to read file part (for iv_map)");
     }
@@ -258,18 +265,40 @@ Result<std::pair<NetQueryPtr, bool>> FileUploader::start_part(Part part, int32 p
   if (encryption_key_.is_secret()) {
     padded_size = (padded_size + 15) & ~15;
   }
-  BufferSlice bytes(padded_size);
-  TRY_RESULT(size, fd_.pread(bytes.as_mutable_slice().truncate(part.size), part.offset));
+  bool is_next_part = false;
   if (encryption_key_.is_secret()) {
-    Random::secure_bytes(bytes.as_mutable_slice().substr(part.size));
+    // reads are finished in the order they were started, so the parts are encrypted in the same order
     if (next_offset_ == part.offset) {
+      is_next_part = true;
+      next_offset_ += static_cast<int64>(padded_size);
+    } else if (part.id >= static_cast<int32>(iv_map_.size())) {
+      TRY_STATUS(generate_iv_map());
+    }
+  }
+
+  send_closure(file_io_worker_, &FileIoWorker::pread, fd_, BufferSlice(padded_size), part.size, part.offset,
+               PromiseCreator::lambda(
+                   [actor_id = actor_id(this), part, part_count, is_next_part](Result<BufferSlice> r_bytes) {
+                     send_closure(actor_id, &FileUploader::on_part_read, part, part_count, is_next_part,
+                                  std::move(r_bytes));
+                   }));
+  return std::make_pair(NetQueryPtr(), false);
+}
+
+void FileUploader::on_part_read(Part part, int32 part_count, bool is_next_part, Result<BufferSlice> r_bytes) {
+  part_sent_at_[part.id] = Time::now();
+  on_part_started(part, create_part_query(part, part_count, is_next_part, std::move(r_bytes)));
+}
+
+Result<NetQueryPtr> FileUploader::create_part_query(Part part, int32 part_count, bool is_next_part,
+                                                    Result<BufferSlice> r_bytes) {
+  TRY_RESULT(bytes, std::move(r_bytes));
+  if (encryption_key_.is_secret()) {
+    Random::secure_bytes(bytes.as_mutable_slice().substr(part.size));
+    if (is_next_part) {
       aes_ige_encrypt(as_slice(encryption_key_.key()), as_mutable_slice(iv_), bytes.as_slice(),
                       bytes.as_mutable_slice());
-      next_offset_ += static_cast<int64>(bytes.size());
     } else {
-      if (part.id >= static_cast<int32>(iv_map_.size())) {
-        TRY_STATUS(generate_iv_map());
-      }
       CHECK(part.id < static_cast<int32>(iv_map_.size()) && part.id >= 0);
       auto iv = iv_map_[part.id];
       aes_ige_encrypt(as_slice(encryption_key_.key()), as_mutable_slice(iv), bytes.as_slice(),
@@ -277,10 +306,6 @@ Result<std::pair<NetQueryPtr, bool>> FileUploader::start_part(Part part, int32 p
     }
   }
 
-  if (size != part.size) {
-    return Status::Error("Failed to read file part");
-  }
-
   NetQueryPtr net_query;
   if (big_flag_) {
     auto query =
@@ -291,10 +316,23 @@ Result<std::pair<NetQueryPtr, bool>> FileUploader::start_part(Part part, int32 p
     net_query = G()->net_query_creator().create(query, {}, DcId::main(), NetQuery::Type::Upload);
   }
   net_query->file_type_ = narrow_cast<int32>(file_type_);
-  return std::make_pair(std::move(net_query), false);
+  return std::move(net_query);
+}
+
+void FileUploader::process_part(Part part, NetQueryPtr net_query, Promise<size_t> promise) {
+  auto r_size = get_part_result(part, std::move(net_query));
+  auto it = part_sent_at_.find(part.id);
+  if (it != part_sent_at_.end()) {
+    if (r_size.is_ok()) {
+      callback_->on_part_uploaded(narrow_cast<int32>(get_part_size()), narrow_cast<int64>(part.size),
+                                  Time::now() - it->second);
+    }
+    part_sent_at_.erase(it);
+  }
+  promise.set_result(std::move(r_size));
 }
 
-Result<size_t> FileUploader::process_part(Part part, NetQueryPtr net_query) {
+Result<size_t> FileUploader::get_part_result(Part part, NetQueryPtr net_query) {
   Result<bool> result = [&] {
     if (big_flag_) {
       return fetch_result<telegram_api::upload_saveBigFilePart>(std::move(net_query));
@@ -334,14 +372,16 @@ void FileUploader::keep_fd_flag(bool keep_fd) {
 }
 
 void FileUploader::try_release_fd() {
-  if (!keep_fd_ && !fd_.empty()) {
-    fd_.close();
+  if (!keep_fd_ && fd_ != nullptr) {
+    // the file is closed after all pending reads are finished
+    fd_ = nullptr;
   }
 }
 
 Status FileUploader::acquire_fd() {
-  if (fd_.empty()) {
-    TRY_RESULT_ASSIGN(fd_, FileFd::open(fd_path_, FileFd::Read));
+  if (fd_ == nullptr) {
+    TRY_RESULT(fd, FileFd::open(fd_path_, FileFd::Read));
+    fd_ = std::make_shared<FileFd>(std::move(fd));
   }
   return Status::OK();
 }
@@ -7,15 +7,22 @@
 #pragma once
 
 #include "td/telegram/files/FileEncryptionKey.h"
+#include "td/telegram/files/FileIoWorker.h"
 #include "td/telegram/files/FileLoader.h"
 #include "td/telegram/files/FileLocation.h"
 #include "td/telegram/files/FileType.h"
 
+#include "td/actor/actor.h"
+
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/port/FileFd.h"
+#include "td/utils/Promise.h"
 #include "td/utils/Status.h"
 #include "td/utils/UInt.h"
 
+#include <map>
+#include <memory>
 #include <utility>
 
 namespace td {
@@ -26,12 +33,15 @@ class FileUploader final : public FileLoader {
    public:
     virtual void on_hash(string hash) = 0;
     virtual void on_partial_upload(PartialRemoteFileLocation partial_remote, int64 ready_size) = 0;
+    virtual void on_part_uploaded(int32 part_size, int64 size, double rtt) = 0;
     virtual void on_ok(FileType file_type, PartialRemoteFileLocation partial_remote, int64 size) = 0;
     virtual void on_error(Status status) = 0;
   };
 
+  // min_part_size is used only for new uploads of files with known size
   FileUploader(const LocalFileLocation &local, const RemoteFileLocation &remote, int64 expected_size,
-               const FileEncryptionKey &encryption_key, std::vector<int> bad_parts, unique_ptr<Callback> callback);
+               const FileEncryptionKey &encryption_key, std::vector<int> bad_parts, size_t min_part_size,
+               ActorId<FileIoWorker> file_io_worker, unique_ptr<Callback> callback);
 
   // Should just implement all parent pure virtual methods.
   // Must not call any of them...
@@ -42,6 +52,8 @@ class FileUploader final : public FileLoader {
   int64 expected_size_;
   FileEncryptionKey encryption_key_;
   std::vector<int> bad_parts_;
+  size_t min_part_size_;
+  ActorId<FileIoWorker> file_io_worker_;
   unique_ptr<Callback> callback_;
   int64 local_size_ = 0;
   bool local_is_ready_ = false;
@@ -53,11 +65,12 @@ class FileUploader final : public FileLoader {
   int64 generate_offset_ = 0;
   int64 next_offset_ = 0;
 
-  FileFd fd_;
+  std::shared_ptr<FileFd> fd_;
   string fd_path_;
   bool is_temp_ = false;
   int64 file_id_ = 0;
   bool big_flag_ = false;
+  std::map<int32, double> part_sent_at_;
 
   Result<FileInfo> init() final TD_WARN_UNUSED_RESULT;
   Status on_ok(int64 size) final TD_WARN_UNUSED_RESULT;
@@ -66,7 +79,11 @@ class FileUploader final : public FileLoader {
   void after_start_parts() final;
   Result<std::pair<NetQueryPtr, bool>> start_part(Part part, int32 part_count,
                                                   int64 streaming_offset) final TD_WARN_UNUSED_RESULT;
-  Result<size_t> process_part(Part part, NetQueryPtr net_query) final TD_WARN_UNUSED_RESULT;
+  void on_part_read(Part part, int32 part_count, bool is_next_part, Result<BufferSlice> r_bytes);
+  Result<NetQueryPtr> create_part_query(Part part, int32 part_count, bool is_next_part,
+                                        Result<BufferSlice> r_bytes) TD_WARN_UNUSED_RESULT;
+  void process_part(Part part, NetQueryPtr net_query, Promise<size_t> promise) final;
+  Result<size_t> get_part_result(Part part, NetQueryPtr net_query) TD_WARN_UNUSED_RESULT;
   void on_progress(Progress progress) final;
   FileLoader::Callback *get_callback() final;
   Result<PrefixInfo> on_update_local_location(const LocalFileLocation &location,
@@ -31,7 +31,8 @@ Status PartsManager::init_known_prefix(int64 known_prefix, size_t part_size, con
   return init_no_size(part_size, ready_parts);
 }
 
-int32 PartsManager::set_streaming_offset(int64 offset, int64 limit) {
+int32 PartsManager::set_streaming_offset(int64 offset, int64 limit, double now) {
+  update_streaming_speed(offset, now);
   auto finish = [&] {
     set_streaming_limit(limit);
     update_first_not_ready_part();
@@ -69,8 +70,47 @@ int32 PartsManager::get_pending_count() const {
   return pending_count_;
 }
 
+void PartsManager::update_streaming_speed(int64 offset, double now) {
+  // consumption is sequential, if the new offset is inside the previous window; otherwise, it is a seek
+  bool is_sequential = now > 0.0 && streaming_offset_time_ > 0.0 && requested_streaming_limit_ > 0 &&
+                       streaming_offset_ <= offset && offset <= streaming_offset_ + streaming_limit_;
+  if (!is_sequential) {
+    streaming_speed_ = 0.0;
+    streaming_offset_time_ = now;
+    return;
+  }
+  auto passed_time = now - streaming_offset_time_;
+  if (offset == streaming_offset_ || passed_time < 0.1) {
+    return;
+  }
+  auto speed = static_cast<double>(offset - streaming_offset_) / passed_time;
+  streaming_speed_ = streaming_speed_ == 0.0 ? speed : 0.7 * streaming_speed_ + 0.3 * speed;
+  streaming_offset_time_ = now;
+}
+
+void PartsManager::update_read_ahead_size() {
+  read_ahead_size_ = 0;
+  if (requested_streaming_limit_ == 0 || streaming_speed_ <= 0.0) {
+    return;
+  }
+  auto read_ahead_size = streaming_speed_ * READ_AHEAD_TIME;
+  if (read_ahead_size >= static_cast<double>(MAX_READ_AHEAD_SIZE)) {
+    read_ahead_size_ = MAX_READ_AHEAD_SIZE;
+  } else {
+    auto part_size = static_cast<int64>(part_size_);
+    read_ahead_size_ = (static_cast<int64>(read_ahead_size) + part_size - 1) / part_size * part_size;
+  }
+  if (!unknown_size_flag_) {
+    // the window must not wrap to the beginning of the file
+    auto left_size = get_size() - streaming_offset_ - requested_streaming_limit_;
+    read_ahead_size_ = clamp(read_ahead_size_, static_cast<int64>(0), max(left_size, static_cast<int64>(0)));
+  }
+}
+
 void PartsManager::set_streaming_limit(int64 limit) {
-  streaming_limit_ = limit;
+  requested_streaming_limit_ = limit;
+  update_read_ahead_size();
+  streaming_limit_ = limit == 0 ? 0 : limit + read_ahead_size_;
   streaming_ready_size_ = 0;
   if (streaming_limit_ == 0) {
     return;
@@ -133,10 +173,7 @@ Status PartsManager::init(int64 size, int64 expected_size, bool is_size_final, s
       return Status::Error("FILE_UPLOAD_RESTART");
     }
   } else {
-    part_size_ = 64 << 10;
-    while (part_size_ < MAX_PART_SIZE && calc_part_count(expected_size_, part_size_) > MAX_PART_COUNT) {
-      part_size_ *= 2;
-    }
+    part_size_ = calc_part_size(expected_size_, 0);
   }
   LOG_CHECK(1 <= size_) << *this;
   LOG_CHECK(!use_part_count_limit || calc_part_count(expected_size_, part_size_) <= MAX_PART_COUNT_PREMIUM)
@@ -222,6 +259,14 @@ int64 PartsManager::get_streaming_offset() const {
   return streaming_offset_;
 }
 
+int64 PartsManager::get_streaming_limit() const {
+  return streaming_limit_;
+}
+
+int64 PartsManager::get_streaming_read_ahead_size() const {
+  return read_ahead_size_;
+}
+
 string PartsManager::get_bitmask() {
   int32 prefix_count = -1;
   if (need_check_) {
@@ -231,6 +276,10 @@ string PartsManager::get_bitmask() {
 }
 
 bool PartsManager::is_part_in_streaming_limit(int part_id) const {
+  return is_part_in_streaming_limit(part_id, streaming_limit_);
+}
+
+bool PartsManager::is_part_in_streaming_limit(int part_id, int64 streaming_limit) const {
   CHECK(part_id < part_count_);
   auto offset_begin = static_cast<int64>(part_id) * static_cast<int64>(get_part_size());
   auto offset_end = offset_begin + static_cast<int64>(get_part(part_id).size);
@@ -239,7 +288,7 @@ bool PartsManager::is_part_in_streaming_limit(int part_id) const {
     return false;
   }
 
-  if (streaming_limit_ == 0) {
+  if (streaming_limit == 0) {
     return true;
   }
 
@@ -248,7 +297,7 @@ bool PartsManager::is_part_in_streaming_limit(int part_id) const {
   };
 
   auto streaming_begin = streaming_offset_;
-  auto streaming_end = streaming_offset_ + streaming_limit_;
+  auto streaming_end = streaming_offset_ + streaming_limit;
   if (is_intersect_with(streaming_begin, streaming_end)) {
     return true;
   }
@@ -302,7 +351,7 @@ Result<Part> PartsManager::start_part() {
     }
   }
 
-  if (!is_part_in_streaming_limit(part_id)) {
+  if (!is_part_in_streaming_limit(part_id) || is_read_ahead_part_limit_reached(part_id)) {
     return get_empty_part();
   }
   CHECK(part_status_[part_id] == PartStatus::Empty);
@@ -310,6 +359,21 @@ Result<Part> PartsManager::start_part() {
   return get_part(part_id);
 }
 
+bool PartsManager::is_read_ahead_part_limit_reached(int part_id) const {
+  if (read_ahead_size_ == 0 || is_part_in_streaming_limit(part_id, requested_streaming_limit_)) {
+    return false;
+  }
+  // parts are started in order, so all pending read-ahead parts are just before the part
+  auto offset_part_id = narrow_cast<int>(streaming_offset_ / part_size_);
+  int pending_count = 0;
+  for (int i = part_id - 1; i >= offset_part_id && !is_part_in_streaming_limit(i, requested_streaming_limit_); i--) {
+    if (part_status_[i] == PartStatus::Pending) {
+      pending_count++;
+    }
+  }
+  return pending_count >= MAX_READ_AHEAD_PENDING_PART_COUNT;
+}
+
 Status PartsManager::set_known_prefix(int64 size, bool is_ready) {
   if (!known_prefix_flag_ || size < known_prefix_size_ ||
       (!is_ready && size / static_cast<int64>(part_size_) < static_cast<int64>(part_status_.size()))) {
@@ -470,6 +534,15 @@ int64 PartsManager::get_expected_size() const {
   return get_size();
 }
 
+size_t PartsManager::calc_part_size(int64 expected_size, size_t min_part_size) {
+  size_t part_size = 64 << 10;
+  while (part_size < MAX_PART_SIZE &&
+         (part_size < min_part_size || calc_part_count(expected_size, part_size) > MAX_PART_COUNT)) {
+    part_size *= 2;
+  }
+  return part_size;
+}
+
 size_t PartsManager::get_part_size() const {
   return part_size_;
 }
@@ -578,6 +651,7 @@ StringBuilder &operator<<(StringBuilder &string_builder, const PartsManager &par
                         << ", first_not_ready_part = " << parts_manager.first_not_ready_part_
                         << ", streaming_offset = " << parts_manager.streaming_offset_
                         << ", streaming_limit = " << parts_manager.streaming_limit_
+                        << ", read_ahead_size = " << parts_manager.read_ahead_size_
                         << ", first_streaming_empty_part = " << parts_manager.first_streaming_empty_part_
                         << ", first_streaming_not_ready_part = " << parts_manager.first_streaming_not_ready_part_
                         << ", use_part_count_limit = " << parts_manager.use_part_count_limit_
@@ -36,7 +36,8 @@ class PartsManager {
   Status set_known_prefix(int64 size, bool is_ready);
   void set_need_check();
   void set_checked_prefix_size(int64 size);
-  int32 set_streaming_offset(int64 offset, int64 limit);
+  // now is used to estimate playback speed for streaming read-ahead; pass 0 if the offset isn't set by playback
+  int32 set_streaming_offset(int64 offset, int64 limit, double now = 0.0);
   void set_streaming_limit(int64 limit);
 
   int64 get_checked_prefix_size() const;
@@ -51,15 +52,25 @@ class PartsManager {
   int32 get_unchecked_ready_prefix_count();
   int32 get_ready_prefix_count();
   int64 get_streaming_offset() const;
+  int64 get_streaming_limit() const;
+  int64 get_streaming_read_ahead_size() const;
   string get_bitmask();
   int32 get_pending_count() const;
 
+  // returns the part size for a file of the given size, which isn't less than min_part_size if possible
+  static size_t calc_part_size(int64 expected_size, size_t min_part_size);
+
  private:
   static constexpr int MAX_PART_COUNT = 4000;
   static constexpr int MAX_PART_COUNT_PREMIUM = 8000;
   static constexpr size_t MAX_PART_SIZE = 512 << 10;
   static constexpr int64 MAX_FILE_SIZE = static_cast<int64>(MAX_PART_SIZE) * MAX_PART_COUNT_PREMIUM;
 
+  // streaming read-ahead window covers READ_AHEAD_TIME seconds of playback, but no more than MAX_READ_AHEAD_SIZE bytes
+  static constexpr double READ_AHEAD_TIME = 10.0;
+  static constexpr int64 MAX_READ_AHEAD_SIZE = 16 << 20;
+  static constexpr int MAX_READ_AHEAD_PENDING_PART_COUNT = 4;
+
   enum class PartStatus : int32 { Empty, Pending, Ready };
 
   bool is_upload_{false};
@@ -83,7 +94,11 @@ class PartsManager {
   int first_empty_part_{0};
   int first_not_ready_part_{0};
   int64 streaming_offset_{0};
-  int64 streaming_limit_{0};
+  int64 streaming_limit_{0};  // requested limit extended by read-ahead window
+  int64 requested_streaming_limit_{0};
+  int64 read_ahead_size_{0};
+  double streaming_offset_time_{0.0};
+  double streaming_speed_{0.0};
   int first_streaming_empty_part_{0};
   int first_streaming_not_ready_part_{0};
   vector<PartStatus> part_status_;
@@ -104,6 +119,11 @@ class PartsManager {
 
   bool is_streaming_limit_reached();
   bool is_part_in_streaming_limit(int part_id) const;
+  bool is_part_in_streaming_limit(int part_id, int64 streaming_limit) const;
+  bool is_read_ahead_part_limit_reached(int part_id) const;
+
+  void update_streaming_speed(int64 offset, double now);
+  void update_read_ahead_size();
 
   friend StringBuilder &operator<<(StringBuilder &string_builder, const PartsManager &parts_manager);
 };
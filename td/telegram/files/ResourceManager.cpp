@@ -13,6 +13,7 @@
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/ScopeGuard.h"
+#include "td/utils/Time.h"
 
 #include <algorithm>
 
@@ -31,6 +32,23 @@ void ResourceManager::register_worker(ActorShared<FileLoaderActor> callback, int
   send_closure(node->callback_, &FileLoaderActor::set_resource_manager, actor_shared(this, node_id));
 }
 
+void ResourceManager::update_max_resource_limit(int64 max_resource_limit) {
+  if (stop_flag_) {
+    return;
+  }
+  // if the limit is decreased, resources in use aren't taken back, but new resources aren't given until they are freed
+  max_resource_limit_ = max_resource_limit;
+  loop();
+}
+
+void ResourceManager::on_bandwidth_limit_changed() {
+  if (stop_flag_) {
+    return;
+  }
+  cancel_timeout();
+  loop();
+}
+
 void ResourceManager::update_priority(int8 priority) {
   if (stop_flag_) {
     return;
@@ -98,7 +116,7 @@ void ResourceManager::add_to_heap(Node *node) {
   }
 }
 
-bool ResourceManager::satisfy_node(NodeId file_node_id) {
+bool ResourceManager::satisfy_node(NodeId file_node_id, int64 max_active_limit) {
   auto file_node_ptr = nodes_container_.get(file_node_id);
   CHECK(file_node_ptr);
   auto file_node = (*file_node_ptr).get();
@@ -106,18 +124,31 @@ bool ResourceManager::satisfy_node(NodeId file_node_id) {
   auto part_size = narrow_cast<int64>(file_node->resource_state_.unit_size());
   auto need = file_node->resource_state_.estimated_extra();
   VLOG(file_loader) << tag("need", need) << tag("part_size", part_size);
-  need = (need + part_size - 1) / part_size * part_size;
-  VLOG(file_loader) << tag("need", need);
-  if (need == 0) {
+  need = min(need, max_active_limit - file_node->resource_state_.active_limit());
+  if (need <= 0) {
     return true;
   }
+  need = (need + part_size - 1) / part_size * part_size;
+  VLOG(file_loader) << tag("need", need);
   auto give = resource_state_.unused();
   give = min(need, give);
+  if (bandwidth_limiter_ != nullptr) {
+    auto available = bandwidth_limiter_->get_available(Time::now());
+    if (available <= 0) {
+      is_bandwidth_limit_reached_ = true;
+      return false;
+    }
+    // the limiter can go into debt by less than one part
+    give = min(give, (available + part_size - 1) / part_size * part_size);
+  }
   give -= give % part_size;
   VLOG(file_loader) << tag("give", give);
   if (give == 0) {
     return false;
   }
+  if (bandwidth_limiter_ != nullptr) {
+    bandwidth_limiter_->spend(give);
+  }
   resource_state_.start_use(give);
   file_node->resource_state_.update_limit(give);
   send_closure(file_node->callback_, &FileLoaderActor::update_resources, file_node->resource_state_);
@@ -134,6 +165,7 @@ void ResourceManager::loop() {
   auto active_limit = resource_state_.active_limit();
   resource_state_.update_limit(max_resource_limit_ - active_limit);
   LOG(INFO) << tag("unused", resource_state_.unused());
+  is_bandwidth_limit_reached_ = false;
 
   if (mode_ == Mode::Greedy) {
     std::vector<Node *> to_add;
@@ -150,14 +182,47 @@ void ResourceManager::loop() {
       add_to_heap(node);
     }
   } else if (mode_ == Mode::Baseline) {
-    // plain
+    int64 total_weight = 0;
+    for (auto &it : to_xload_) {
+      if (is_node_active(it.second)) {
+        total_weight += get_priority_weight(it.first);
+      }
+    }
+    for (auto &it : to_xload_) {
+      if (is_bandwidth_limit_reached_ || resource_state_.unused() <= 0) {
+        break;
+      }
+      if (is_node_active(it.second)) {
+        auto share = static_cast<int64>(static_cast<double>(max_resource_limit_) *
+                                        static_cast<double>(get_priority_weight(it.first)) /
+                                        static_cast<double>(total_weight));
+        satisfy_node(it.second, share);
+      }
+    }
     for (auto &it : to_xload_) {
-      auto file_node_id = it.second;
-      if (!satisfy_node(file_node_id)) {
+      if (is_bandwidth_limit_reached_ || !satisfy_node(it.second)) {
         break;
       }
     }
   }
+  if (is_bandwidth_limit_reached_) {
+    set_timeout_at(bandwidth_limiter_->get_wakeup_at());
+  }
+}
+
+void ResourceManager::timeout_expired() {
+  loop();
+}
+
+int64 ResourceManager::get_priority_weight(int8 priority) {
+  return max(static_cast<int64>(priority), static_cast<int64>(1));
+}
+
+bool ResourceManager::is_node_active(NodeId node_id) const {
+  auto node_ptr = nodes_container_.get(node_id);
+  CHECK(node_ptr);
+  const auto &resource_state = (*node_ptr)->resource_state_;
+  return resource_state.estimated_extra() > 0 || resource_state.active_limit() > 0;
 }
 
 void ResourceManager::add_node(NodeId node_id, int8 priority) {
@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/telegram/files/BandwidthLimiter.h"
 #include "td/telegram/files/FileLoaderActor.h"
 #include "td/telegram/files/ResourceState.h"
 
@@ -15,14 +16,20 @@
 #include "td/utils/Container.h"
 #include "td/utils/Heap.h"
 
+#include <limits>
+#include <memory>
 #include <utility>
 
 namespace td {
 
+// In Baseline mode resources are shared between workers in proportion to their priorities, but each worker gets
+// at least one part, so workers with low priority aren't starved. Resources, which aren't needed by other workers,
+// are given in the order of priority.
 class ResourceManager final : public Actor {
  public:
   enum class Mode : int32 { Baseline, Greedy };
-  ResourceManager(int64 max_resource_limit, Mode mode) : max_resource_limit_(max_resource_limit), mode_(mode) {
+  ResourceManager(int64 max_resource_limit, Mode mode, std::shared_ptr<BandwidthLimiter> bandwidth_limiter = nullptr)
+      : max_resource_limit_(max_resource_limit), mode_(mode), bandwidth_limiter_(std::move(bandwidth_limiter)) {
   }
   // use through ActorShared
   void update_priority(int8 priority);
@@ -30,9 +37,15 @@ class ResourceManager final : public Actor {
 
   void register_worker(ActorShared<FileLoaderActor> callback, int8 priority);
 
+  void update_max_resource_limit(int64 max_resource_limit);
+
+  void on_bandwidth_limit_changed();
+
  private:
   int64 max_resource_limit_ = 0;
   Mode mode_;
+  std::shared_ptr<BandwidthLimiter> bandwidth_limiter_;
+  bool is_bandwidth_limit_reached_ = false;
 
   using NodeId = uint64;
   struct Node final : public HeapNode {
@@ -61,8 +74,14 @@ class ResourceManager final : public Actor {
 
   void loop() final;
 
+  void timeout_expired() final;
+
+  static int64 get_priority_weight(int8 priority);
+
+  bool is_node_active(NodeId node_id) const;
+
   void add_to_heap(Node *node);
-  bool satisfy_node(NodeId file_node_id);
+  bool satisfy_node(NodeId file_node_id, int64 max_active_limit = std::numeric_limits<int64>::max());
   void add_node(NodeId node_id, int8 priority);
   bool remove_node(NodeId node_id);
 };
@@ -0,0 +1,85 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+namespace td {
+
+// Estimates upload speed and minimum round-trip time of uploaded parts to choose part size of new uploads and
+// the total size of parts in flight. The in-flight size is kept at twice the estimated bandwidth-delay product,
+// so it grows while the uploads are limited by the number of parts in flight and stops when the link is saturated.
+class UploadSpeedEstimator {
+ public:
+  static constexpr int64 MIN_IN_FLIGHT_SIZE = 4 << 20;
+  static constexpr int64 MAX_IN_FLIGHT_SIZE = 32 << 20;
+  static constexpr double SPEED_PERIOD = 1.0;
+  static constexpr double IDLE_PERIOD = 5.0;
+  static constexpr double MIN_RTT_PERIOD = 30.0;
+  static constexpr double PART_UPLOAD_TIME = 0.05;  // preferred time of uploading of a part at the estimated speed
+
+  void on_part_uploaded(int64 size, double rtt, double now) {
+    if (rtt < 0.0) {
+      rtt = 0.0;
+    }
+    if (min_rtt_ == 0.0 || rtt < min_rtt_ || now >= min_rtt_expires_at_) {
+      min_rtt_ = rtt;
+      min_rtt_expires_at_ = now + MIN_RTT_PERIOD;
+    }
+
+    if (period_start_at_ == 0.0 || now >= last_part_at_ + IDLE_PERIOD) {
+      // the part was being uploaded during its round-trip time
+      period_start_at_ = now - rtt;
+      period_size_ = 0;
+    }
+    last_part_at_ = now;
+    period_size_ += size;
+    auto elapsed = now - period_start_at_;
+    if (elapsed >= SPEED_PERIOD) {
+      auto speed = static_cast<double>(period_size_) / elapsed;
+      speed_ = speed_ == 0.0 ? speed : speed_ * 0.7 + speed * 0.3;
+      period_start_at_ = now;
+      period_size_ = 0;
+    }
+  }
+
+  // returns estimated upload speed in bytes per second or 0 if it is unknown yet
+  double get_speed() const {
+    return speed_;
+  }
+
+  double get_min_rtt() const {
+    return min_rtt_;
+  }
+
+  int64 get_in_flight_limit() const {
+    auto limit = static_cast<int64>(2.0 * speed_ * min_rtt_);
+    if (limit < MIN_IN_FLIGHT_SIZE) {
+      return MIN_IN_FLIGHT_SIZE;
+    }
+    if (limit > MAX_IN_FLIGHT_SIZE) {
+      return MAX_IN_FLIGHT_SIZE;
+    }
+    return limit;
+  }
+
+  // returns minimum part size for new uploads or 0 if the default part size must be used
+  size_t get_min_part_size() const {
+    return static_cast<size_t>(speed_ * PART_UPLOAD_TIME);
+  }
+
+ private:
+  double speed_ = 0.0;
+  double min_rtt_ = 0.0;
+  double min_rtt_expires_at_ = 0.0;
+
+  double period_start_at_ = 0.0;
+  double last_part_at_ = 0.0;
+  int64 period_size_ = 0;
+};
+
+}  // namespace td
@@ -6,11 +6,14 @@
 //
 #include "td/telegram/misc.h"
 
+#include "td/telegram/MemoryStatistics.h"
+
 #include "td/utils/algorithm.h"
 #include "td/utils/common.h"
 #include "td/utils/crypto.h"
 #include "td/utils/Hints.h"
 #include "td/utils/misc.h"
+#include "td/utils/SharedStringPool.h"
 #include "td/utils/Slice.h"
 #include "td/utils/utf8.h"
 
@@ -403,4 +406,22 @@ vector<int32> search_strings_by_prefix(const vector<string> &strings, const stri
   return transform(result.second, [](int64 key) { return narrow_cast<int32>(key); });
 }
 
+static SharedStringPool &get_shared_string_pool() {
+  static SharedStringPool pool;
+  return pool;
+}
+
+SharedSlice get_shared_string(Slice str) {
+  return get_shared_string_pool().intern(str);
+}
+
+void get_shared_string_pool_memory_statistics(MemoryStatistics &statistics) {
+  auto stats = get_shared_string_pool().get_stats();
+  statistics.add_total("SharedStringPool", "strings", stats.string_count,
+                       stats.string_count * (sizeof(Slice) + sizeof(SharedSlice)) + stats.total_size);
+  // memory, which would have been used by duplicate strings without the pool
+  statistics.add_total("SharedStringPool", "deduplicated_strings", static_cast<size_t>(stats.hit_count),
+                       static_cast<size_t>(stats.saved_size));
+}
+
 }  // namespace td
@@ -7,11 +7,14 @@
 #pragma once
 
 #include "td/utils/common.h"
+#include "td/utils/SharedSlice.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 
 namespace td {
 
+class MemoryStatistics;
+
 // cleans user name/dialog title
 string clean_name(string str, size_t max_length) TD_WARN_UNUSED_RESULT;
 
@@ -58,4 +61,10 @@ Status validate_bot_language_code(const string &language_code);
 vector<int32> search_strings_by_prefix(const vector<string> &strings, const string &query, int32 limit,
                                        bool return_all_for_empty_query, int32 &total_count);
 
+// returns a copy of the string from the process-wide pool of deduplicated strings
+SharedSlice get_shared_string(Slice str);
+
+// adds statistics of the pool of deduplicated strings
+void get_shared_string_pool_memory_statistics(MemoryStatistics &statistics);
+
 }  // namespace td
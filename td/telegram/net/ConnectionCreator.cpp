@@ -608,6 +608,7 @@ void ConnectionCreator::request_raw_connection(DcId dc_id, bool allow_media_only
   }
   client.auth_data = std::move(auth_data);
   client.auth_data_generation++;
+  client.last_request_at = Time::now();
   VLOG(connections) << "Request connection for " << tag("client", format::as_hex(client.hash)) << " to " << dc_id << " "
                     << tag("allow_media_only", allow_media_only);
   client.queries.push_back(std::move(promise));
@@ -844,20 +845,27 @@ void ConnectionCreator::client_loop(ClientInfo &client) {
 
   // Main loop. Create new connections till needed
   bool check_mode = client.checking_connections != 0 && !proxy.use_proxy();
+  auto prewarmed_connection_count = get_prewarmed_connection_count(client);
   while (true) {
     // Check if we need new connections
+    auto need_connection_count = client.queries.size();
+    if (client.ready_connections.size() < prewarmed_connection_count) {
+      need_connection_count += prewarmed_connection_count - client.ready_connections.size();
+    }
     if (client.queries.empty()) {
       if (!client.ready_connections.empty()) {
         client_set_timeout_at(client, Time::now() + ClientInfo::READY_CONNECTIONS_TIMEOUT);
       }
-      return;
+      if (need_connection_count == 0) {
+        return;
+      }
     }
     if (check_mode) {
       if (client.checking_connections >= 3) {
         return;
       }
     } else {
-      if (client.pending_connections >= client.queries.size()) {
+      if (client.pending_connections >= need_connection_count) {
         return;
       }
     }
@@ -916,10 +924,11 @@ void ConnectionCreator::client_loop(ClientInfo &client) {
 
     auto promise = PromiseCreator::lambda(
         [actor_id = actor_id(this), check_mode, transport_type = extra.transport_type, hash = client.hash,
-         debug_str = extra.debug_str,
-         network_generation = network_generation_](Result<ConnectionData> r_connection_data) mutable {
+         debug_str = extra.debug_str, network_generation = network_generation_,
+         option_stat = extra.stat](Result<ConnectionData> r_connection_data) mutable {
           send_closure(actor_id, &ConnectionCreator::client_create_raw_connection, std::move(r_connection_data),
-                       check_mode, std::move(transport_type), hash, std::move(debug_str), network_generation);
+                       check_mode, std::move(transport_type), hash, std::move(debug_str), network_generation,
+                       option_stat);
         });
 
     auto stats_callback =
@@ -937,7 +946,8 @@ void ConnectionCreator::client_loop(ClientInfo &client) {
 
 void ConnectionCreator::client_create_raw_connection(Result<ConnectionData> r_connection_data, bool check_mode,
                                                      mtproto::TransportType transport_type, uint32 hash,
-                                                     string debug_str, uint32 network_generation) {
+                                                     string debug_str, uint32 network_generation,
+                                                     DcOptionsSet::Stat *option_stat) {
   unique_ptr<mtproto::AuthData> auth_data;
   uint64 auth_data_generation{0};
   uint64 session_id{0};
@@ -953,7 +963,8 @@ void ConnectionCreator::client_create_raw_connection(Result<ConnectionData> r_co
     }
   }
   auto promise = PromiseCreator::lambda([actor_id = actor_id(this), hash, check_mode, auth_data_generation, session_id,
-                                         debug_str](Result<unique_ptr<mtproto::RawConnection>> result) mutable {
+                                         debug_str,
+                                         option_stat](Result<unique_ptr<mtproto::RawConnection>> result) mutable {
     if (result.is_ok()) {
       VLOG(connections) << "Ready connection (" << (check_mode ? "" : "un") << "checked) " << result.ok().get() << ' '
                         << tag("rtt", format::as_time(result.ok()->extra().rtt)) << ' ' << debug_str;
@@ -962,7 +973,7 @@ void ConnectionCreator::client_create_raw_connection(Result<ConnectionData> r_co
                         << debug_str;
     }
     send_closure(actor_id, &ConnectionCreator::client_add_connection, hash, std::move(result), check_mode,
-                 auth_data_generation, session_id);
+                 auth_data_generation, session_id, option_stat);
   });
 
   if (r_connection_data.is_error()) {
@@ -997,8 +1008,32 @@ void ConnectionCreator::client_set_timeout_at(ClientInfo &client, double wakeup_
                     << wakeup_at - Time::now_cached();
 }
 
+size_t ConnectionCreator::get_prewarmed_connection_count(const ClientInfo &client) const {
+  // keep some ready connections only for recently used media clients to speed up subsequent file downloads
+  if (!client.is_media || !(online_flag_ || is_logging_out_) ||
+      client.last_request_at + ClientInfo::PREWARM_CONNECTIONS_PERIOD < Time::now()) {
+    return 0;
+  }
+  return prewarmed_media_connection_count_;
+}
+
+void ConnectionCreator::update_prewarmed_media_connection_count() {
+  auto prewarmed_media_connection_count =
+      static_cast<size_t>(max(G()->get_option_integer("prewarmed_media_connection_count"), static_cast<int64>(0)));
+  if (prewarmed_media_connection_count == prewarmed_media_connection_count_) {
+    return;
+  }
+
+  VLOG(connections) << "Update prewarmed media connection count to " << prewarmed_media_connection_count;
+  prewarmed_media_connection_count_ = prewarmed_media_connection_count;
+  for (auto &client : clients_) {
+    client_loop(client.second);
+  }
+}
+
 void ConnectionCreator::client_add_connection(uint32 hash, Result<unique_ptr<mtproto::RawConnection>> r_raw_connection,
-                                              bool check_flag, uint64 auth_data_generation, uint64 session_id) {
+                                              bool check_flag, uint64 auth_data_generation, uint64 session_id,
+                                              DcOptionsSet::Stat *option_stat) {
   auto &client = clients_[hash];
   client.add_session_id(session_id);
   CHECK(client.pending_connections > 0);
@@ -1011,6 +1046,9 @@ void ConnectionCreator::client_add_connection(uint32 hash, Result<unique_ptr<mtp
     VLOG(connections) << "Add ready connection " << r_raw_connection.ok().get() << " for "
                       << tag("client", format::as_hex(hash));
     client.backoff.clear();
+    if (check_flag && option_stat != nullptr) {
+      option_stat->on_rtt(r_raw_connection.ok()->extra().rtt);
+    }
     client.ready_connections.emplace_back(r_raw_connection.move_as_ok(), Time::now_cached());
   } else {
     if (r_raw_connection.error().code() == -404 && client.auth_data &&
@@ -1108,6 +1146,9 @@ void ConnectionCreator::start_up() {
 
   ref_cnt_guard_ = create_reference(-1);
 
+  prewarmed_media_connection_count_ =
+      static_cast<size_t>(max(G()->get_option_integer("prewarmed_media_connection_count"), static_cast<int64>(0)));
+
   is_inited_ = true;
   loop();
 }
@@ -79,6 +79,8 @@ class ConnectionCreator final : public NetQueryCallback {
   void get_proxy_link(int32 proxy_id, Promise<string> promise);
   void ping_proxy(int32 proxy_id, Promise<double> promise);
 
+  void update_prewarmed_media_connection_count();
+
   struct ConnectionData {
     IPAddress ip_address;
     BufferedFd<SocketFd> buffered_socket_fd;
@@ -104,6 +106,7 @@ class ConnectionCreator final : public NetQueryCallback {
   bool online_flag_ = false;
   bool is_logging_out_ = false;
   bool is_inited_ = false;
+  size_t prewarmed_media_connection_count_ = 0;
 
   static constexpr int32 MAX_PROXY_LAST_USED_SAVE_DELAY = 60;
   std::map<int32, Proxy> proxies_;
@@ -157,6 +160,9 @@ class ConnectionCreator final : public NetQueryCallback {
     std::vector<Promise<unique_ptr<mtproto::RawConnection>>> queries;
 
     static constexpr double READY_CONNECTIONS_TIMEOUT = 10;
+    static constexpr double PREWARM_CONNECTIONS_PERIOD = 60;
+
+    double last_request_at{0};
 
     bool inited{false};
     uint32 hash{0};
@@ -222,10 +228,11 @@ class ConnectionCreator final : public NetQueryCallback {
   void client_loop(ClientInfo &client);
   void client_create_raw_connection(Result<ConnectionData> r_connection_data, bool check_mode,
                                     mtproto::TransportType transport_type, uint32 hash, string debug_str,
-                                    uint32 network_generation);
+                                    uint32 network_generation, DcOptionsSet::Stat *option_stat);
   void client_add_connection(uint32 hash, Result<unique_ptr<mtproto::RawConnection>> r_raw_connection, bool check_flag,
-                             uint64 auth_data_generation, uint64 session_id);
+                             uint64 auth_data_generation, uint64 session_id, DcOptionsSet::Stat *option_stat);
   void client_set_timeout_at(ClientInfo &client, double wakeup_at);
+  size_t get_prewarmed_connection_count(const ClientInfo &client) const;
 
   void on_proxy_resolved(Result<IPAddress> ip_address, bool dummy);
 
@@ -28,6 +28,7 @@ class DcOptionsSet {
     double ok_at{-1000};
     double error_at{-1001};
     double check_at{-1002};
+    double rtt{0};  // exponentially weighted average round-trip time of checked connections; 0 if unknown
     enum class State : int32 { Ok, Error, Checking };
 
     void on_ok() {
@@ -39,6 +40,12 @@ class DcOptionsSet {
     void on_check() {
       check_at = Time::now_cached();
     }
+    void on_rtt(double new_rtt) {
+      if (new_rtt <= 0) {
+        return;
+      }
+      rtt = rtt == 0 ? new_rtt : rtt * 0.7 + new_rtt * 0.3;
+    }
     bool is_ok() const {
       return state() == State::Ok;
     }
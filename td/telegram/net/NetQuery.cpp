@@ -8,6 +8,7 @@
 
 #include "td/telegram/ChainId.h"
 #include "td/telegram/Global.h"
+#include "td/telegram/net/NetQueryDispatcher.h"
 #include "td/telegram/telegram_api.h"
 
 #include "td/utils/algorithm.h"
@@ -29,7 +30,7 @@ void NetQuery::debug(string state, bool may_be_lost) {
     auto guard = lock();
     auto &data = get_data_unsafe();
     data.state_ = std::move(state);
-    data.state_timestamp_ = Time::now();
+    data.state_timestamp_ = Time::now_cached();
     data.state_change_count_++;
   }
 }
@@ -52,10 +53,37 @@ NetQuery::NetQuery(uint64 id, BufferSlice &&query, DcId dc_id, Type type, AuthFl
 
   auto &data = get_data_unsafe();
   data.my_id_ = G()->get_option_integer("my_id");
-  data.start_timestamp_ = data.state_timestamp_ = Time::now();
+  data.start_timestamp_ = data.state_timestamp_ = Time::now_cached();
   LOG(INFO) << *this;
   if (stats) {
     nq_counter_ = stats->register_query(this);
+    stats_ = stats;
+  }
+}
+
+int32 NetQuery::get_stats_dc_id() const {
+  auto dc_id = dc_id_;
+  if (dc_id.is_main()) {
+    dc_id = G()->net_query_dispatcher().get_main_dc_id();
+  }
+  return dc_id.is_exact() ? dc_id.get_raw_id() : 0;
+}
+
+void NetQuery::on_acknowledged(int32 dc_id, double latency) {
+  if (stats_ != nullptr) {
+    stats_->on_query_acknowledged(tl_constructor_, dc_id, latency);
+  }
+}
+
+void NetQuery::on_result_received(int32 dc_id, double latency) {
+  if (stats_ != nullptr) {
+    stats_->on_query_result(tl_constructor_, dc_id, latency);
+  }
+}
+
+void NetQuery::on_flood_wait(double timeout) {
+  if (stats_ != nullptr) {
+    stats_->on_query_flood_wait(tl_constructor_, get_stats_dc_id(), timeout);
   }
 }
 
@@ -75,6 +103,9 @@ void NetQuery::resend(DcId new_dc_id) {
     auto guard = lock();
     get_data_unsafe().resend_count_++;
   }
+  if (stats_ != nullptr) {
+    stats_->on_query_resent(tl_constructor_, get_stats_dc_id());
+  }
   dc_id_ = new_dc_id;
   status_ = Status::OK();
   state_ = State::Query;
@@ -135,7 +166,8 @@ void NetQuery::set_error(Status status, string source) {
     }
   }
   if (status.message() == "MSG_WAIT_FAILED" && status.code() != 400) {
-    status = Status::Error(400, "MSG_WAIT_FAILED");
+    static const Status msg_wait_failed_error = Status::StaticError(400, "MSG_WAIT_FAILED");
+    status = msg_wait_failed_error.clone();
   }
   set_error_impl(std::move(status), std::move(source));
 }
@@ -203,6 +203,12 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
 
   void debug(string state, bool may_be_lost = false);
 
+  void on_acknowledged(int32 dc_id, double latency);
+
+  void on_result_received(int32 dc_id, double latency);
+
+  void on_flood_wait(double timeout);
+
   void set_callback(ActorShared<NetQueryCallback> callback) {
     callback_ = std::move(callback);
   }
@@ -220,6 +226,12 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
     finish_migrate(cancel_slot_);
   }
 
+  // queries with positive priority are sent strictly before other queries; queries with priority up to
+  // INTERACTIVE_PRIORITY share the connection with weights, so bulk queries can't delay interactive ones for long
+  static constexpr int8 INTERACTIVE_PRIORITY = 0;
+  static constexpr int8 BACKGROUND_PRIORITY = -1;
+  static constexpr int8 BULK_PRIORITY = -2;
+
   int8 priority() const {
     return priority_;
   }
@@ -252,6 +264,7 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
   DcId dc_id_;
 
   NetQueryCounter nq_counter_;
+  NetQueryStats *stats_ = nullptr;
   Status status_;
   uint64 id_ = 0;
   BufferSlice query_;
@@ -291,6 +304,8 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
 
   void set_error_impl(Status status, string source = string());
 
+  int32 get_stats_dc_id() const;
+
   static int32 tl_magic(const BufferSlice &buffer_slice);
 
  public:
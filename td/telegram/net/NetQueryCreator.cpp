@@ -19,6 +19,7 @@
 #include "td/utils/logging.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Storer.h"
+#include "td/utils/tl_storers.h"
 
 namespace td {
 
@@ -43,23 +44,17 @@ NetQueryPtr NetQueryCreator::create(uint64 id, const telegram_api::object_ptr<te
                                     const telegram_api::Function &function, vector<ChainId> &&chain_ids, DcId dc_id,
                                     NetQuery::Type type, NetQuery::AuthFlag auth_flag) {
   LOG(INFO) << "Create query " << to_string(function);
-  string prefix_str;
-  if (prefix != nullptr) {
-    auto storer = DefaultStorer<telegram_api::Function>(*prefix);
-    prefix_str.resize(storer.size());
-    auto real_size = storer.store(MutableSlice(prefix_str).ubegin());
-    CHECK(real_size == prefix_str.size());
-  }
-
+  // the prefix and the function are stored directly to the query buffer
+  size_t prefix_size = prefix == nullptr ? 0 : tl_calc_length(*prefix);
   auto storer = DefaultStorer<telegram_api::Function>(function);
-  BufferSlice slice(prefix_str.size() + storer.size());
-  auto real_size = storer.store(slice.as_mutable_slice().ubegin() + prefix_str.size());
-  LOG_CHECK(prefix_str.size() + real_size == slice.size())
-      << prefix_str.size() << ' ' << real_size << ' ' << slice.size() << ' '
-      << format::as_hex_dump<4>(slice.as_slice());
+  BufferSlice slice(prefix_size + storer.size());
   if (prefix != nullptr) {
-    slice.as_mutable_slice().copy_from(prefix_str);
+    auto real_prefix_size = tl_store_unsafe(*prefix, slice.as_mutable_slice().ubegin());
+    CHECK(real_prefix_size == prefix_size);
   }
+  auto real_size = storer.store(slice.as_mutable_slice().ubegin() + prefix_size);
+  LOG_CHECK(prefix_size + real_size == slice.size())
+      << prefix_size << ' ' << real_size << ' ' << slice.size() << ' ' << format::as_hex_dump<4>(slice.as_slice());
 
   size_t min_gzipped_size = 128;
   int32 tl_constructor = function.get_id();
@@ -38,6 +38,9 @@ void NetQueryDelayer::delay(NetQueryPtr query) {
                         Slice("TAKEOUT_INIT_DELAY_"), Slice("FLOOD_PREMIUM_WAIT_")}) {
       if (begins_with(error_message, prefix)) {
         timeout = clamp(to_integer<int>(error_message.substr(prefix.size())), 1, 14 * 24 * 60 * 60);
+        if (prefix == "FLOOD_WAIT_" || prefix == "SLOWMODE_WAIT_") {
+          G()->net_query_dispatcher().on_flood_wait(*query, timeout);
+        }
         if (prefix == "FLOOD_PREMIUM_WAIT_") {
           switch (query->type()) {
             case NetQuery::Type::Common:
@@ -72,6 +75,7 @@ void NetQueryDelayer::delay(NetQueryPtr query) {
   }
   query->total_timeout_ += timeout;
   query->last_timeout_ = timeout;
+  query->on_flood_wait(timeout);
   LOG(INFO) << "Set total_timeout to " << query->total_timeout_ << " for " << query->id();
 
   auto error = query->error().clone();
@@ -79,7 +83,8 @@ void NetQueryDelayer::delay(NetQueryPtr query) {
 
   // Fix for infinity flood control
   if (!query->need_resend_on_503_ && code == -503) {
-    query->set_error(Status::Error(502, "Bad Gateway"));
+    static const Status bad_gateway_error = Status::StaticError(502, "Bad Gateway");
+    query->set_error(bad_gateway_error.clone());
     query->debug("DcManager: send to DcManager");
     G()->net_query_dispatcher().dispatch(std::move(query));
     return;
@@ -99,9 +104,21 @@ void NetQueryDelayer::delay(NetQueryPtr query) {
   LOG(WARNING) << "Delay: " << query << " " << tag("timeout", timeout) << tag("total_timeout", query->total_timeout_)
                << " because of " << error << " from " << query->source_;
   query->debug(PSTRING() << "delay for " << format::as_time(timeout));
+  add_query_slot(std::move(query), timeout, false);
+}
+
+void NetQueryDelayer::delay_before_sending(NetQueryPtr query, double timeout) {
+  CHECK(!query->is_ready());
+  LOG(INFO) << "Delay " << query << " for " << timeout << " seconds to avoid flood wait";
+  query->debug(PSTRING() << "delay before sending for " << format::as_time(timeout));
+  add_query_slot(std::move(query), timeout, true);
+}
+
+void NetQueryDelayer::add_query_slot(NetQueryPtr query, double timeout, bool is_flood_control_delay) {
   auto id = container_.create(QuerySlot());
   auto *query_slot = container_.get(id);
   query_slot->query_ = std::move(query);
+  query_slot->is_flood_control_delay_ = is_flood_control_delay;
   query_slot->timeout_.set_event(EventCreator::yield(actor_shared(this, id)));
   query_slot->timeout_.set_timeout_in(timeout);
 }
@@ -120,7 +137,7 @@ void NetQueryDelayer::on_slot_event(uint64 id) {
     return;
   }
   auto query = std::move(slot->query_);
-  if (!query->invoke_after().empty()) {
+  if (!slot->is_flood_control_delay_ && !query->invoke_after().empty()) {
     // Fail query after timeout expired if it is a part of an invokeAfter chain.
     // It is not necessary but helps to avoid server problems, when previous query was lost.
     query->set_error_resend_invoke_after();
@@ -21,15 +21,20 @@ class NetQueryDelayer final : public Actor {
   }
   void delay(NetQueryPtr query);
 
+  void delay_before_sending(NetQueryPtr query, double timeout);
+
  private:
   struct QuerySlot {
     NetQueryPtr query_;
     Slot timeout_;
+    bool is_flood_control_delay_ = false;
   };
   Container<QuerySlot> container_;
   ActorShared<> parent_;
   void wakeup() final;
 
+  void add_query_slot(NetQueryPtr query, double timeout, bool is_flood_control_delay);
+
   void on_slot_event(uint64 id);
 
   void tear_down() final;
@@ -29,6 +29,7 @@
 #include "td/utils/port/sleep.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
 
 namespace td {
 
@@ -136,9 +137,26 @@ void NetQueryDispatcher::dispatch(NetQueryPtr net_query) {
   }
 
   if (net_query->is_ready()) {
+    on_deduplicated_query_result(net_query);
     return complete_net_query(std::move(net_query));
   }
 
+  if (can_deduplicate_query(*net_query) && deduplicate_query(net_query)) {
+    return;
+  }
+
+  if (net_query->type() == NetQuery::Type::Common) {
+    auto delay = get_flood_control_delay(*net_query);
+    if (delay > 0) {
+      net_query->debug("sent to NetQueryDelayer to avoid flood wait");
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (check_stop_flag(net_query)) {
+        return;
+      }
+      return send_closure_later(delayer_, &NetQueryDelayer::delay_before_sending, std::move(net_query), delay);
+    }
+  }
+
   if (net_query->dispatch_ttl_ > 0) {
     net_query->dispatch_ttl_--;
   }
@@ -171,6 +189,75 @@ void NetQueryDispatcher::dispatch(NetQueryPtr net_query) {
   }
 }
 
+bool NetQueryDispatcher::can_deduplicate_query(const NetQuery &net_query) {
+  if (net_query.type() != NetQuery::Type::Common || !net_query.get_chain_ids().empty()) {
+    return false;
+  }
+  switch (net_query.tl_constructor()) {
+    case telegram_api::users_getUsers::ID:
+    case telegram_api::channels_getChannels::ID:
+    case telegram_api::messages_getMessages::ID:
+    case telegram_api::channels_getMessages::ID:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// returns true if the query will receive the result of an identical query, which is already being sent
+bool NetQueryDispatcher::deduplicate_query(NetQueryPtr &net_query) {
+  string key = PSTRING() << net_query->dc_id().get_value() << ' ' << static_cast<int32>(net_query->auth_flag()) << ' '
+                         << static_cast<int32>(net_query->gzip_flag()) << ' ' << net_query->query().as_slice();
+
+  std::lock_guard<std::mutex> guard(deduplication_mutex_);
+  if (deduplication_keys_.count(net_query->id()) != 0) {
+    // the query is resent
+    return false;
+  }
+  auto &queries = deduplicated_queries_[key];
+  if (queries.query_id_ != 0) {
+    net_query->debug("wait for result of an identical query");
+    queries.waiting_queries_.push_back(std::move(net_query));
+    return true;
+  }
+  queries.query_id_ = net_query->id();
+  deduplication_keys_.emplace(net_query->id(), std::move(key));
+  return false;
+}
+
+void NetQueryDispatcher::on_deduplicated_query_result(const NetQueryPtr &net_query) {
+  if (!can_deduplicate_query(*net_query)) {
+    return;
+  }
+
+  vector<NetQueryPtr> waiting_queries;
+  {
+    std::lock_guard<std::mutex> guard(deduplication_mutex_);
+    auto key_it = deduplication_keys_.find(net_query->id());
+    if (key_it == deduplication_keys_.end()) {
+      return;
+    }
+    auto it = deduplicated_queries_.find(key_it->second);
+    CHECK(it != deduplicated_queries_.end());
+    waiting_queries = std::move(it->second.waiting_queries_);
+    deduplicated_queries_.erase(it);
+    deduplication_keys_.erase(key_it);
+  }
+
+  for (auto &query : waiting_queries) {
+    if (net_query->is_ok()) {
+      query->set_ok(net_query->ok().copy());
+    } else if (net_query->error().code() == NetQuery::Canceled) {
+      // the original query was canceled, so the waiting queries must be sent by themselves
+      dispatch(std::move(query));
+      continue;
+    } else {
+      query->set_error(net_query->error().clone());
+    }
+    complete_net_query(std::move(query));
+  }
+}
+
 Status NetQueryDispatcher::wait_dc_init(DcId dc_id, bool force) {
   // TODO: optimize
   if (!dc_id.is_exact()) {
@@ -257,6 +344,17 @@ void NetQueryDispatcher::dispatch_with_callback(NetQueryPtr net_query, ActorShar
 void NetQueryDispatcher::stop() {
   std::lock_guard<std::mutex> guard(mutex_);
   stop_flag_ = true;
+  {
+    std::lock_guard<std::mutex> deduplication_guard(deduplication_mutex_);
+    for (auto &it : deduplicated_queries_) {
+      for (auto &query : it.second.waiting_queries_) {
+        query->set_error(Global::request_aborted_error());
+        complete_net_query(std::move(query));
+      }
+    }
+    deduplicated_queries_.clear();
+    deduplication_keys_.clear();
+  }
   delayer_.reset();
   verifier_.reset();
   for (auto &dc : dcs_) {
@@ -350,6 +448,7 @@ NetQueryDispatcher::NetQueryDispatcher(const std::function<ActorShared<>()> &cre
   if (!s_main_dc_id.empty()) {
     main_dc_id_ = to_integer<int32>(s_main_dc_id);
   }
+  load_flood_controls();
   delayer_ = create_actor<NetQueryDelayer>("NetQueryDelayer", create_reference());
 #if TD_ANDROID || TD_DARWIN_IOS || TD_DARWIN_VISION_OS || TD_DARWIN_WATCH_OS || TD_TEST_VERIFICATION
   verifier_ = create_actor<NetQueryVerifier>("NetQueryVerifier", create_reference());
@@ -364,6 +463,89 @@ NetQueryDispatcher::NetQueryDispatcher(const std::function<ActorShared<>()> &cre
 
 NetQueryDispatcher::~NetQueryDispatcher() = default;
 
+std::pair<int32, uint64> NetQueryDispatcher::get_flood_control_key(const NetQuery &net_query) {
+  // chains are mostly created per chat, so the first chain approximates the peer of the query
+  const auto &chain_ids = net_query.get_chain_ids();
+  return {net_query.tl_constructor(), chain_ids.empty() ? 0 : chain_ids[0]};
+}
+
+double NetQueryDispatcher::get_flood_control_delay(const NetQuery &net_query) {
+  std::lock_guard<std::mutex> guard(flood_control_mutex_);
+  if (flood_controls_.empty()) {
+    return 0.0;
+  }
+  auto it = flood_controls_.find(get_flood_control_key(net_query));
+  if (it == flood_controls_.end()) {
+    return 0.0;
+  }
+  auto now = Time::now();
+  if (it->second.is_unlimited(now)) {
+    flood_controls_.erase(it);
+    return 0.0;
+  }
+  auto wakeup_at = it->second.get_wakeup_at(now);
+  if (wakeup_at > now) {
+    return wakeup_at - now;
+  }
+  it->second.add_event(now);
+  return 0.0;
+}
+
+void NetQueryDispatcher::on_flood_wait(const NetQuery &net_query, int32 timeout) {
+  std::lock_guard<std::mutex> guard(flood_control_mutex_);
+  auto &flood_control = flood_controls_[get_flood_control_key(net_query)];
+  flood_control.on_flood_wait(Time::now(), timeout);
+  LOG(INFO) << "Limit " << net_query << " to one query per " << flood_control.get_interval() << " seconds";
+  save_flood_controls();
+}
+
+void NetQueryDispatcher::load_flood_controls() {
+  auto value = G()->td_db()->get_binlog_pmc()->get("flood_controls");
+  if (value.empty()) {
+    return;
+  }
+  // times are stored as server times to survive restarts
+  auto now = Time::now();
+  auto time_difference = G()->get_server_time_difference();
+  for (auto &line : full_split(Slice(value), '\n')) {
+    auto parts = full_split(line, ' ');
+    if (parts.size() != 5) {
+      LOG(ERROR) << "Receive invalid flood control \"" << line << '"';
+      continue;
+    }
+    auto key = std::make_pair(to_integer<int32>(parts[0]), to_integer<uint64>(parts[1]));
+    FloodControlAdaptive flood_control(to_double(parts[2]), to_double(parts[3]) - time_difference,
+                                       to_double(parts[4]) - time_difference);
+    if (!flood_control.is_unlimited(now)) {
+      flood_controls_.emplace(key, flood_control);
+    }
+  }
+}
+
+void NetQueryDispatcher::save_flood_controls() {
+  auto now = Time::now();
+  auto time_difference = G()->get_server_time_difference();
+  string value;
+  for (auto it = flood_controls_.begin(); it != flood_controls_.end();) {
+    if (it->second.is_unlimited(now)) {
+      it = flood_controls_.erase(it);
+      continue;
+    }
+    if (!value.empty()) {
+      value += '\n';
+    }
+    value += PSTRING() << it->first.first << ' ' << it->first.second << ' ' << it->second.get_interval() << ' '
+                       << it->second.get_blocked_until() + time_difference << ' '
+                       << it->second.get_changed_at() + time_difference;
+    ++it;
+  }
+  if (value.empty()) {
+    G()->td_db()->get_binlog_pmc()->erase("flood_controls");
+  } else {
+    G()->td_db()->get_binlog_pmc()->set("flood_controls", std::move(value));
+  }
+}
+
 void NetQueryDispatcher::try_fix_migrate(NetQueryPtr &net_query) {
   auto error_message = net_query->error().message();
   static constexpr CSlice prefixes[] = {"PHONE_MIGRATE_", "NETWORK_MIGRATE_", "USER_MIGRATE_"};
@@ -12,6 +12,8 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
+#include "td/utils/FloodControlAdaptive.h"
 #include "td/utils/Promise.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/Status.h"
@@ -19,8 +21,10 @@
 #include <array>
 #include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 namespace td {
 
@@ -59,6 +63,8 @@ class NetQueryDispatcher {
 
   void set_verification_token(int64 verification_id, string &&token, Promise<Unit> &&promise);
 
+  void on_flood_wait(const NetQuery &net_query, int32 timeout);
+
  private:
   std::atomic<bool> stop_flag_{false};
   bool need_destroy_auth_key_{false};
@@ -86,6 +92,19 @@ class NetQueryDispatcher {
   std::mutex mutex_;
   std::shared_ptr<Guard> td_guard_;
 
+  // identical simultaneous queries are sent only once, and all of them receive the result of the first query
+  struct DeduplicatedQueries {
+    uint64 query_id_ = 0;
+    vector<NetQueryPtr> waiting_queries_;
+  };
+  std::mutex deduplication_mutex_;
+  FlatHashMap<string, DeduplicatedQueries> deduplicated_queries_;
+  FlatHashMap<uint64, string> deduplication_keys_;
+
+  // limits learned from received flood wait errors by method and the first chain of the query
+  std::mutex flood_control_mutex_;
+  std::map<std::pair<int32, uint64>, FloodControlAdaptive> flood_controls_;
+
   Status wait_dc_init(DcId dc_id, bool force);
   bool is_dc_inited(int32 raw_dc_id);
 
@@ -97,6 +116,15 @@ class NetQueryDispatcher {
   bool check_stop_flag(NetQueryPtr &net_query) const;
 
   void try_fix_migrate(NetQueryPtr &net_query);
+
+  static bool can_deduplicate_query(const NetQuery &net_query);
+  bool deduplicate_query(NetQueryPtr &net_query);
+  void on_deduplicated_query_result(const NetQueryPtr &net_query);
+
+  static std::pair<int32, uint64> get_flood_control_key(const NetQuery &net_query);
+  double get_flood_control_delay(const NetQuery &net_query);
+  void load_flood_controls();
+  void save_flood_controls();
 };
 
 }  // namespace td
@@ -14,8 +14,24 @@
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Time.h"
 
+#include <algorithm>
+
 namespace td {
 
+const std::array<double, NetQueryStats::LatencyHistogram::BUCKET_COUNT - 1>
+    NetQueryStats::LatencyHistogram::BUCKET_BOUNDS{{0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0}};
+
+void NetQueryStats::LatencyHistogram::add(double value) {
+  if (value < 0) {
+    value = 0;
+  }
+  auto bucket =
+      static_cast<size_t>(std::lower_bound(BUCKET_BOUNDS.begin(), BUCKET_BOUNDS.end(), value) - BUCKET_BOUNDS.begin());
+  bucket_counts_[bucket]++;
+  count_++;
+  sum_ += value;
+}
+
 uint64 NetQueryStats::get_count() const {
   return count_.load(std::memory_order_relaxed);
 }
@@ -53,4 +69,109 @@ void NetQueryStats::dump_pending_network_queries() {
     }
   }
 }
+
+NetQueryStats::QueryTypeStats &NetQueryStats::get_query_type_stats(int32 tl_constructor, int32 dc_id) {
+  return query_type_stats_[std::make_pair(tl_constructor, dc_id)];
+}
+
+void NetQueryStats::on_query_acknowledged(int32 tl_constructor, int32 dc_id, double latency) {
+  std::lock_guard<std::mutex> guard(query_type_stats_mutex_);
+  get_query_type_stats(tl_constructor, dc_id).ack_latency_.add(latency);
+}
+
+void NetQueryStats::on_query_result(int32 tl_constructor, int32 dc_id, double latency) {
+  std::lock_guard<std::mutex> guard(query_type_stats_mutex_);
+  get_query_type_stats(tl_constructor, dc_id).result_latency_.add(latency);
+}
+
+void NetQueryStats::on_query_resent(int32 tl_constructor, int32 dc_id) {
+  std::lock_guard<std::mutex> guard(query_type_stats_mutex_);
+  get_query_type_stats(tl_constructor, dc_id).resend_count_++;
+}
+
+void NetQueryStats::on_query_flood_wait(int32 tl_constructor, int32 dc_id, double timeout) {
+  std::lock_guard<std::mutex> guard(query_type_stats_mutex_);
+  auto &stats = get_query_type_stats(tl_constructor, dc_id);
+  stats.flood_wait_count_++;
+  stats.flood_wait_time_ += timeout;
+}
+
+void NetQueryStats::on_file_part_uploaded(int32 part_size) {
+  std::lock_guard<std::mutex> guard(query_type_stats_mutex_);
+  uploaded_part_counts_[part_size]++;
+}
+
+void NetQueryStats::on_upload_estimate_changed(double old_speed, double new_speed, int64 old_in_flight_limit,
+                                               int64 new_in_flight_limit) {
+  std::lock_guard<std::mutex> guard(query_type_stats_mutex_);
+  upload_speed_ += new_speed - old_speed;
+  upload_in_flight_limit_ += new_in_flight_limit - old_in_flight_limit;
+}
+
+string NetQueryStats::get_query_type_statistics() const {
+  std::lock_guard<std::mutex> guard(query_type_stats_mutex_);
+  auto get_labels = [](const std::pair<int32, int32> &key) {
+    return PSTRING() << "method=\"" << format::as_hex(key.first) << "\",dc=\"" << key.second << '"';
+  };
+
+  string result;
+  auto add_histogram = [&](Slice name, Slice help, LatencyHistogram QueryTypeStats::*histogram) {
+    result += PSTRING() << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " histogram\n";
+    for (auto &it : query_type_stats_) {
+      const auto &value = it.second.*histogram;
+      if (value.count_ == 0) {
+        continue;
+      }
+      auto labels = get_labels(it.first);
+      uint64 cumulative_count = 0;
+      for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; i++) {
+        cumulative_count += value.bucket_counts_[i];
+        result += PSTRING() << name << "_bucket{" << labels << ",le=\"";
+        if (i + 1 < LatencyHistogram::BUCKET_COUNT) {
+          result += PSTRING() << LatencyHistogram::BUCKET_BOUNDS[i];
+        } else {
+          result += "+Inf";
+        }
+        result += PSTRING() << "\"} " << cumulative_count << '\n';
+      }
+      result += PSTRING() << name << "_sum{" << labels << "} " << value.sum_ << '\n';
+      result += PSTRING() << name << "_count{" << labels << "} " << value.count_ << '\n';
+    }
+  };
+  auto add_counter = [&](Slice name, Slice help, auto get_value) {
+    result += PSTRING() << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " counter\n";
+    for (auto &it : query_type_stats_) {
+      if (it.second.resend_count_ != 0 || it.second.flood_wait_count_ != 0) {
+        result += PSTRING() << name << '{' << get_labels(it.first) << "} " << get_value(it.second) << '\n';
+      }
+    }
+  };
+
+  add_histogram("td_net_query_ack_latency_seconds",
+                "Time between sending of a query and receiving of its acknowledgement", &QueryTypeStats::ack_latency_);
+  add_histogram("td_net_query_result_latency_seconds", "Time between sending of a query and receiving of its result",
+                &QueryTypeStats::result_latency_);
+  add_counter("td_net_query_resend_total", "Number of query resends",
+              [](const QueryTypeStats &stats) { return stats.resend_count_; });
+  add_counter("td_net_query_wait_total", "Number of waits before query resending because of flood limits or errors",
+              [](const QueryTypeStats &stats) { return stats.flood_wait_count_; });
+  add_counter("td_net_query_wait_seconds_total",
+              "Total time spent waiting before query resending because of flood limits or errors",
+              [](const QueryTypeStats &stats) { return stats.flood_wait_time_; });
+
+  result += "# HELP td_file_upload_parts_total Number of uploaded file parts\n"
+            "# TYPE td_file_upload_parts_total counter\n";
+  for (auto &it : uploaded_part_counts_) {
+    result += PSTRING() << "td_file_upload_parts_total{part_size=\"" << it.first << "\"} " << it.second << '\n';
+  }
+  auto add_gauge = [&](Slice name, Slice help, auto value) {
+    result += PSTRING() << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " gauge\n"
+                        << name << ' ' << value << '\n';
+  };
+  add_gauge("td_file_upload_speed_bytes", "Estimated upload speed in bytes per second", upload_speed_);
+  add_gauge("td_file_upload_in_flight_limit_bytes", "Maximum total size of uploaded file parts in flight",
+            upload_in_flight_limit_);
+  return result;
+}
+
 }  // namespace td
@@ -11,7 +11,11 @@
 #include "td/utils/common.h"
 #include "td/utils/TsList.h"
 
+#include <array>
 #include <atomic>
+#include <map>
+#include <mutex>
+#include <utility>
 
 namespace td {
 
@@ -40,10 +44,56 @@ class NetQueryStats {
 
   void dump_pending_network_queries();
 
+  // the following methods can be called from any thread
+  void on_query_acknowledged(int32 tl_constructor, int32 dc_id, double latency);
+
+  void on_query_result(int32 tl_constructor, int32 dc_id, double latency);
+
+  void on_query_resent(int32 tl_constructor, int32 dc_id);
+
+  void on_query_flood_wait(int32 tl_constructor, int32 dc_id, double timeout);
+
+  void on_file_part_uploaded(int32 part_size);
+
+  // estimates of all clients are summed up
+  void on_upload_estimate_changed(double old_speed, double new_speed, int64 old_in_flight_limit,
+                                  int64 new_in_flight_limit);
+
+  // returns the statistics in Prometheus text exposition format
+  string get_query_type_statistics() const;
+
  private:
+  struct LatencyHistogram {
+    static constexpr size_t BUCKET_COUNT = 10;
+    static const std::array<double, BUCKET_COUNT - 1> BUCKET_BOUNDS;
+
+    std::array<uint64, BUCKET_COUNT> bucket_counts_{};  // the last bucket is for larger values
+    uint64 count_ = 0;
+    double sum_ = 0.0;
+
+    void add(double value);
+  };
+
+  struct QueryTypeStats {
+    LatencyHistogram ack_latency_;
+    LatencyHistogram result_latency_;
+    uint64 resend_count_ = 0;
+    uint64 flood_wait_count_ = 0;
+    double flood_wait_time_ = 0.0;
+  };
+
   NetQueryCounter::Counter count_{0};
   std::atomic<bool> use_list_{true};
   TsList<NetQueryDebug> list_;
+
+  mutable std::mutex query_type_stats_mutex_;
+  std::map<std::pair<int32, int32>, QueryTypeStats> query_type_stats_;  // (tl_constructor, dc_id) -> stats
+
+  std::map<int32, uint64> uploaded_part_counts_;  // part_size -> count
+  double upload_speed_ = 0.0;
+  int64 upload_in_flight_limit_ = 0;
+
+  QueryTypeStats &get_query_type_stats(int32 tl_constructor, int32 dc_id);
 };
 
 }  // namespace td
@@ -45,6 +45,7 @@
 #include "td/utils/VectorQueue.h"
 
 #include <atomic>
+#include <iterator>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -201,7 +202,7 @@ class GenAuthKeyActor final : public Actor {
     VLOG(dc) << "Receive raw connection " << raw_connection.get();
     network_generation_ = raw_connection->extra().extra;
     child_ = create_actor_on_scheduler<mtproto::HandshakeActor>(
-        PSLICE() << name_ + "::HandshakeActor", G()->get_slow_net_scheduler_id(), std::move(handshake_),
+        PSLICE() << name_ + "::HandshakeActor", G()->get_crypto_scheduler_id(), std::move(handshake_),
         std::move(raw_connection), std::move(context_), 10, std::move(connection_promise_),
         std::move(handshake_promise_));
   }
@@ -214,21 +215,42 @@ TD_THREAD_LOCAL Semaphore *GenAuthKeyActor::semaphore_{};
 
 void Session::PriorityQueue::push(NetQueryPtr query) {
   auto priority = query->priority();
-  queries_[priority].push(std::move(query));
+  auto it = queues_.find(priority);
+  if (it == queues_.end()) {
+    it = queues_.emplace(priority, Queue()).first;
+    it->second.pass_ = pass_;
+  }
+  it->second.queries_.push(std::move(query));
+}
+
+double Session::PriorityQueue::get_stride(int8 priority) {
+  // interactive queries get 4 times more slots than background queries and 16 times more than bulk queries
+  CHECK(priority <= NetQuery::INTERACTIVE_PRIORITY);
+  return static_cast<double>(1 << (2 * min(NetQuery::INTERACTIVE_PRIORITY - priority, 4)));
 }
 
 NetQueryPtr Session::PriorityQueue::pop() {
   CHECK(!empty());
-  auto it = queries_.begin();
-  auto res = it->second.pop();
-  if (it->second.empty()) {
-    queries_.erase(it);
+  auto it = queues_.begin();
+  if (it->first <= NetQuery::INTERACTIVE_PRIORITY) {
+    // stride scheduling: choose the queue with the minimum pass
+    for (auto queue_it = std::next(it); queue_it != queues_.end(); ++queue_it) {
+      if (queue_it->second.pass_ < it->second.pass_) {
+        it = queue_it;
+      }
+    }
+    pass_ = it->second.pass_;
+    it->second.pass_ += get_stride(it->first);
+  }
+  auto res = it->second.queries_.pop();
+  if (it->second.queries_.empty()) {
+    queues_.erase(it);
   }
   return res;
 }
 
 bool Session::PriorityQueue::empty() const {
-  return queries_.empty();
+  return queues_.empty();
 }
 
 Session::Session(unique_ptr<Callback> callback, std::shared_ptr<AuthDataShared> shared_auth_data, int32 raw_dc_id,
@@ -343,14 +365,14 @@ void Session::on_network(bool network_flag, uint32 network_generation) {
 void Session::on_online(bool online_flag) {
   LOG(DEBUG) << "Set online flag to " << online_flag;
   online_flag_ = online_flag;
-  connection_online_update(Time::now(), true);
+  connection_online_update(Time::now_cached(), true);
   loop();
 }
 
 void Session::on_logging_out(bool logging_out_flag) {
   LOG(DEBUG) << "Set logging out flag to " << logging_out_flag;
   logging_out_flag_ = logging_out_flag;
-  connection_online_update(Time::now(), true);
+  connection_online_update(Time::now_cached(), true);
   loop();
 }
 
@@ -371,7 +393,7 @@ void Session::connection_online_update(double now, bool force) {
 }
 
 void Session::send(NetQueryPtr &&query) {
-  last_activity_timestamp_ = Time::now();
+  last_activity_timestamp_ = Time::now_cached();
 
   // query->debug(PSTRING() << get_name() << ": received from SessionProxy");
   query->set_session_id(auth_data_.get_session_id());
@@ -435,7 +457,7 @@ void Session::on_bind_result(NetQueryPtr query) {
   if (status.is_ok()) {
     LOG(INFO) << "Bound temp auth key " << auth_data_.get_tmp_auth_key().id();
     auth_data_.on_bind();
-    last_bind_success_timestamp_ = Time::now();
+    last_bind_success_timestamp_ = Time::now_cached();
     on_tmp_auth_key_updated();
   } else if (status.message() == "DispatchTtlError") {
     LOG(INFO) << "Resend bind auth key " << auth_data_.get_tmp_auth_key().id() << " request after DispatchTtlError";
@@ -488,7 +510,7 @@ void Session::on_result(NetQueryPtr query) {
 }
 
 void Session::return_query(NetQueryPtr &&query) {
-  last_activity_timestamp_ = Time::now();
+  last_activity_timestamp_ = Time::now_cached();
 
   query->set_session_id(0);
   callback_->on_result(std::move(query));
@@ -700,13 +722,13 @@ void Session::on_closed(Status status) {
 void Session::on_new_session_created(uint64 unique_id, mtproto::MessageId first_message_id) {
   LOG(INFO) << "New session " << unique_id << " created with first " << first_message_id;
   if (!use_pfs_ && !auth_data_.use_pfs()) {
-    last_success_timestamp_ = Time::now();
+    last_success_timestamp_ = Time::now_cached();
   }
   if (is_main_) {
     LOG(DEBUG) << "Sending updatesTooLong to force getDifference";
     BufferSlice packet(4);
     as<int32>(packet.as_mutable_slice().begin()) = telegram_api::updatesTooLong::ID;
-    last_activity_timestamp_ = Time::now();
+    last_activity_timestamp_ = Time::now_cached();
     callback_->on_update(std::move(packet), auth_data_.get_auth_key().id());
   }
   auto first_query_it = sent_queries_.find(first_message_id);
@@ -784,6 +806,9 @@ void Session::on_message_ack_impl_inner(mtproto::MessageId message_id, int32 typ
     return;
   }
   VLOG(net_query) << "Ack " << it->second.net_query_;
+  if (!it->second.is_acknowledged_) {
+    it->second.net_query_->on_acknowledged(raw_dc_id_, Time::now() - it->second.sent_at_);
+  }
   it->second.is_acknowledged_ = true;
   {
     auto lock = it->second.net_query_->lock();
@@ -859,15 +884,15 @@ Status Session::on_update(BufferSlice packet) {
   }
 
   if (!use_pfs_ && !auth_data_.use_pfs()) {
-    last_success_timestamp_ = Time::now();
+    last_success_timestamp_ = Time::now_cached();
   }
-  last_activity_timestamp_ = Time::now();
+  last_activity_timestamp_ = Time::now_cached();
   callback_->on_update(std::move(packet), auth_data_.get_auth_key().id());
   return Status::OK();
 }
 
 Status Session::on_message_result_ok(mtproto::MessageId message_id, BufferSlice packet, size_t original_size) {
-  last_success_timestamp_ = Time::now();
+  last_success_timestamp_ = Time::now_cached();
 
   TlParser parser(packet.as_slice());
   int32 response_tl_id = parser.fetch_int();
@@ -910,6 +935,7 @@ Status Session::on_message_result_ok(mtproto::MessageId message_id, BufferSlice
   cleanup_container(message_id, query_ptr);
   mark_as_known(message_id, query_ptr);
   query_ptr->net_query_->on_net_read(original_size);
+  query_ptr->net_query_->on_result_received(raw_dc_id_, Time::now() - query_ptr->sent_at_);
   query_ptr->net_query_->set_ok(std::move(packet));
   query_ptr->net_query_->set_message_id(0);
   return_query(std::move(query_ptr->net_query_));
@@ -991,6 +1017,7 @@ void Session::on_message_result_error(mtproto::MessageId message_id, int error_c
 
   cleanup_container(message_id, query_ptr);
   mark_as_known(message_id, query_ptr);
+  query_ptr->net_query_->on_result_received(raw_dc_id_, Time::now() - query_ptr->sent_at_);
   query_ptr->net_query_->set_error(Status::Error(error_code, message), current_info_->connection_->get_name().str());
   query_ptr->net_query_->set_message_id(0);
   return_query(std::move(query_ptr->net_query_));
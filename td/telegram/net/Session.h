@@ -144,7 +144,14 @@ class Session final
     bool empty() const;
 
    private:
-    std::map<int8, VectorQueue<NetQueryPtr>, std::greater<>> queries_;
+    struct Queue {
+      VectorQueue<NetQueryPtr> queries_;
+      double pass_ = 0.0;
+    };
+    std::map<int8, Queue, std::greater<>> queues_;
+    double pass_ = 0.0;
+
+    static double get_stride(int8 priority);
   };
   PriorityQueue pending_queries_;
   std::map<mtproto::MessageId, Query> sent_queries_;
@@ -15,6 +15,7 @@
 #include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
 
 namespace td {
 
@@ -43,25 +44,44 @@ void SessionMultiProxy::send(NetQueryPtr query) {
     if (session_rand) {
       pos = session_rand % sessions_.size();
     } else {
-      size_t equal_count = 1;
-      int min_query_count = sessions_[pos].query_count;
-      for (size_t i = 1; i < sessions_.size(); i++) {
-        if (sessions_[i].query_count < min_query_count) {
-          pos = i;
-          min_query_count = sessions_[pos].query_count;
-          equal_count = 1;
-        } else if (sessions_[i].query_count == min_query_count) {
-          equal_count++;
-          if (Random::fast_uint32() % equal_count == 0) {
-            pos = i;
-          }
-        }
-      }
+      pos = choose_session();
     }
   }
   // query->debug(PSTRING() << get_name() << ": send to proxy #" << pos);
-  sessions_[pos].query_count++;
-  send_closure(sessions_[pos].proxy, &SessionProxy::send, std::move(query));
+  auto &session = sessions_[pos];
+  if (session.query_count++ == 0) {
+    session.query_interval_start_at = Time::now();
+  }
+  send_closure(session.proxy, &SessionProxy::send, std::move(query));
+}
+
+size_t SessionMultiProxy::choose_session() const {
+  // media sessions transfer file parts, so choose the session that is expected to finish the query the first,
+  // taking into account the speed of each connection; other sessions are chosen just by the number of queries
+  auto get_expected_time = [&](const SessionInfo &session) {
+    if (!is_media_) {
+      return static_cast<double>(session.query_count);
+    }
+    return (session.query_count + 1) * max(session.average_query_interval, MIN_QUERY_INTERVAL);
+  };
+
+  size_t pos = 0;
+  size_t equal_count = 1;
+  double min_expected_time = get_expected_time(sessions_[pos]);
+  for (size_t i = 1; i < sessions_.size(); i++) {
+    auto expected_time = get_expected_time(sessions_[i]);
+    if (expected_time < min_expected_time) {
+      pos = i;
+      min_expected_time = expected_time;
+      equal_count = 1;
+    } else if (expected_time == min_expected_time) {
+      equal_count++;
+      if (Random::fast_uint32() % equal_count == 0) {
+        pos = i;
+      }
+    }
+  }
+  return pos;
 }
 
 void SessionMultiProxy::update_main_flag(bool is_main) {
@@ -171,9 +191,18 @@ void SessionMultiProxy::on_query_finished(uint32 generation, int session_id) {
     return;
   }
   CHECK(static_cast<size_t>(session_id) < sessions_.size());
-  auto &query_count = sessions_[session_id].query_count;
-  CHECK(query_count > 0);
-  query_count--;
+  auto &session = sessions_[session_id];
+  CHECK(session.query_count > 0);
+  session.query_count--;
+
+  auto now = Time::now();
+  auto query_interval = now - session.query_interval_start_at;
+  session.query_interval_start_at = now;
+  if (session.average_query_interval == 0.0) {
+    session.average_query_interval = query_interval;
+  } else {
+    session.average_query_interval = session.average_query_interval * 0.8 + query_interval * 0.2;
+  }
 }
 
 }  // namespace td
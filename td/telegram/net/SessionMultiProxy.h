@@ -36,6 +36,8 @@ class SessionMultiProxy final : public Actor {
   void destroy_auth_key();
 
  private:
+  static constexpr double MIN_QUERY_INTERVAL = 0.001;
+
   int32 session_count_ = 0;
   std::shared_ptr<AuthDataShared> auth_data_;
   const bool is_primary_;
@@ -48,6 +50,8 @@ class SessionMultiProxy final : public Actor {
   struct SessionInfo {
     ActorOwn<SessionProxy> proxy;
     int query_count{0};
+    double query_interval_start_at{0.0};
+    double average_query_interval{0.0};  // smoothed time between finished queries while the session is busy
   };
   uint32 sessions_generation_{0};
   std::vector<SessionInfo> sessions_;
@@ -57,6 +61,8 @@ class SessionMultiProxy final : public Actor {
 
   bool get_pfs_flag() const;
 
+  size_t choose_session() const;
+
   void on_query_finished(uint32 generation, int session_id);
 };
 
@@ -22,6 +22,8 @@
 #include "td/utils/format.h"
 #include "td/utils/HashTableUtils.h"
 #include "td/utils/logging.h"
+#include "td/utils/port/Clocks.h"
+#include "td/utils/port/FileFd.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
@@ -29,8 +31,54 @@
 #include "td/utils/tl_helpers.h"
 #include "td/utils/tl_parsers.h"
 
+#include <cstring>
+#include <mutex>
+
 namespace td {
 
+// if the option "x_record_updates_path" is set, then all received update packets are appended to the file
+// for offline replaying by benchmark/bench_updates; each packet is stored as its receive time as a double,
+// its size as an int32 and its data
+static std::mutex recorded_updates_mutex;
+static string recorded_updates_path;
+static FileFd recorded_updates_fd;
+
+static void record_updates(const string &path, Slice packet) {
+  std::lock_guard<std::mutex> lock(recorded_updates_mutex);
+  if (path != recorded_updates_path) {
+    recorded_updates_path = path;
+    if (!recorded_updates_fd.empty()) {
+      recorded_updates_fd.close();
+    }
+    auto r_fd = FileFd::open(path, FileFd::Create | FileFd::Write | FileFd::Append);
+    if (r_fd.is_error()) {
+      LOG(ERROR) << "Failed to open file to record updates: " << r_fd.error();
+      return;
+    }
+    recorded_updates_fd = r_fd.move_as_ok();
+  }
+  if (recorded_updates_fd.empty()) {
+    return;
+  }
+
+  char header[sizeof(double) + sizeof(int32)];
+  auto receive_time = Clocks::system();
+  auto size = static_cast<int32>(packet.size());
+  std::memcpy(header, &receive_time, sizeof(double));
+  std::memcpy(header + sizeof(double), &size, sizeof(int32));
+  for (auto data : {Slice(header, sizeof(header)), packet}) {
+    while (!data.empty()) {
+      auto r_size = recorded_updates_fd.write(data);
+      if (r_size.is_error()) {
+        LOG(ERROR) << "Failed to record updates: " << r_size.error();
+        recorded_updates_fd.close();
+        return;
+      }
+      data.remove_prefix(r_size.ok());
+    }
+  }
+}
+
 namespace mtproto {
 class RawConnection;
 }  // namespace mtproto
@@ -66,6 +114,12 @@ class SessionCallback final : public Session::Callback {
   }
 
   void on_update(BufferSlice &&update, uint64 auth_key_id) final {
+    // TL objects aren't prefixed with their length, so boundaries of the updates in the packet can't be found
+    // without full parsing, and the decision whether an update is needed can be made only by the Td actor
+    auto record_path = G()->get_option_string("x_record_updates_path");
+    if (!record_path.empty()) {
+      record_updates(record_path, update.as_slice());
+    }
     TlBufferParser parser(&update);
     auto updates = telegram_api::Updates::fetch(parser);
     parser.fetch_end();
@@ -0,0 +1,37 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/td_binary_client.h"
+
+#include "td/telegram/ClientBinary.h"
+
+#include "td/utils/Slice.h"
+
+static td::Slice get_request_slice(const void *request, size_t request_size) {
+  if (request == nullptr) {
+    return td::Slice();
+  }
+  return td::Slice(static_cast<const char *>(request), request_size);
+}
+
+static const void *return_response(td::Slice response, size_t *response_size) {
+  if (response_size != nullptr) {
+    *response_size = response.size();
+  }
+  return response.empty() ? nullptr : response.data();
+}
+
+void td_binary_send(int client_id, unsigned long long request_id, const void *request, size_t request_size) {
+  td::binary_send(client_id, request_id, get_request_slice(request, request_size));
+}
+
+const void *td_binary_receive(double timeout, size_t *response_size) {
+  return return_response(td::binary_receive(timeout), response_size);
+}
+
+const void *td_binary_execute(const void *request, size_t request_size, size_t *response_size) {
+  return return_response(td::binary_execute(get_request_slice(request, request_size)), response_size);
+}
@@ -0,0 +1,66 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+/**
+ * \file
+ * C interface for interaction with TDLib via TL-serialized objects.
+ * Can be used instead of the JSON interface by applications, which are able to serialize and deserialize TDLib API
+ * objects in the TL binary format, to avoid the overhead of conversion of the objects to and from JSON.
+ *
+ * Requests are serialized as boxed TDLib API functions. Each response consists of a 32-bit identifier of the client
+ * for which the response or update was received, a 64-bit identifier of the request to which the response corresponds
+ * or 0 for incoming updates, and a boxed TDLib API object. All numbers are stored in little-endian byte order.
+ *
+ * TDLib client instances are shared with the JSON interface, so client identifiers returned by td_create_client_id
+ * can be used with td_binary_send. The functions td_receive and td_binary_receive must not be called simultaneously,
+ * because they receive updates and responses from the same queue.
+ */
+
+#include "td/telegram/tdjson_export.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Sends request to the TDLib client. May be called from any thread.
+ * \param[in] client_id TDLib client identifier.
+ * \param[in] request_id Request identifier. Must be non-zero.
+ * \param[in] request TL-serialized request to TDLib.
+ * \param[in] request_size Size of the request in bytes.
+ */
+TDJSON_EXPORT void td_binary_send(int client_id, unsigned long long request_id, const void *request,
+                                  size_t request_size);
+
+/**
+ * Receives incoming updates and request responses. Must not be called simultaneously from two different threads.
+ * The returned pointer can be used until the next call to td_binary_receive or td_binary_execute in the same thread,
+ * after which it will be deallocated by TDLib.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \param[out] response_size Size of the returned response in bytes.
+ * \return TL-serialized incoming update or request response. May be NULL if the timeout expires.
+ */
+TDJSON_EXPORT const void *td_binary_receive(double timeout, size_t *response_size);
+
+/**
+ * Synchronously executes a TDLib request.
+ * A request can be executed synchronously, only if it is documented with "Can be called synchronously".
+ * The returned pointer can be used until the next call to td_binary_receive or td_binary_execute in the same thread,
+ * after which it will be deallocated by TDLib.
+ * \param[in] request TL-serialized request to TDLib.
+ * \param[in] request_size Size of the request in bytes.
+ * \param[out] response_size Size of the returned response in bytes.
+ * \return TL-serialized request response with zero client and request identifiers.
+ */
+TDJSON_EXPORT const void *td_binary_execute(const void *request, size_t request_size, size_t *response_size);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
@@ -27,6 +27,10 @@ const char *td_json_client_receive(void *client, double timeout) {
   return static_cast<td::ClientJson *>(client)->receive(timeout);
 }
 
+const char *td_json_client_receive_batch(void *client, double timeout, int max_count) {
+  return static_cast<td::ClientJson *>(client)->receive_batch(timeout, max_count <= 0 ? 1 : max_count);
+}
+
 const char *td_json_client_execute(void *client, const char *request) {
   return td::ClientJson::execute(td::Slice(request == nullptr ? "" : request));
 }
@@ -43,6 +47,22 @@ const char *td_receive(double timeout) {
   return td::json_receive(timeout);
 }
 
+const char *td_receive_batch(double timeout, int max_count) {
+  return td::json_receive_batch(timeout, max_count);
+}
+
+const char *td_receive_owned(double timeout) {
+  return td::json_receive_owned(timeout);
+}
+
+int td_get_receive_fd() {
+  return td::json_get_receive_fd();
+}
+
+void td_release_owned(const char *result) {
+  td::json_release_owned(result);
+}
+
 const char *td_execute(const char *request) {
   return td::json_execute(td::Slice(request == nullptr ? "" : request));
 }
@@ -76,6 +76,43 @@ TDJSON_EXPORT void td_send(int client_id, const char *request);
  */
 TDJSON_EXPORT const char *td_receive(double timeout);
 
+/**
+ * Receives all immediately available incoming updates and request responses, waiting for the first of them at most
+ * timeout seconds. Must not be called simultaneously from two different threads or simultaneously with td_receive.
+ * The returned pointer can be used until the next call to td_receive, td_receive_batch or td_execute, after which it
+ * will be deallocated by TDLib.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \param[in] max_count The maximum number of received objects. Non-positive values are treated as 1.
+ * \return JSON-serialized null-terminated array of incoming updates and request responses in the order they were
+ *         received, each in the same format as returned by td_receive. May be NULL if the timeout expires.
+ */
+TDJSON_EXPORT const char *td_receive_batch(double timeout, int max_count);
+
+/**
+ * Receives incoming updates and request responses the same way as td_receive, but returns a string owned by the caller.
+ * The returned string isn't changed by subsequent TDLib calls and must be released using td_release_owned.
+ * Must not be called simultaneously from two different threads or simultaneously with td_receive.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \return JSON-serialized null-terminated incoming update or request response. May be NULL if the timeout expires.
+ */
+TDJSON_EXPORT const char *td_receive_owned(double timeout);
+
+/**
+ * Returns a file descriptor, which can be used to wait for incoming updates and request responses in an external event
+ * loop instead of blocking in td_receive. The descriptor becomes readable when new data is available after td_receive
+ * has returned NULL. After the descriptor becomes readable, all available responses must be received by calling
+ * td_receive with zero timeout until it returns NULL. The descriptor must not be read, written or closed by the
+ * application.
+ * \return The file descriptor, or -1 if waiting for the descriptor isn't supported on the current platform.
+ */
+TDJSON_EXPORT int td_get_receive_fd();
+
+/**
+ * Releases a string returned by td_receive_owned. May be called from any thread.
+ * \param[in] result The string to release. May be NULL.
+ */
+TDJSON_EXPORT void td_release_owned(const char *result);
+
 /**
  * Synchronously executes a TDLib request.
  * A request can be executed synchronously, only if it is documented with "Can be called synchronously".
@@ -165,6 +202,20 @@ TDJSON_EXPORT void td_json_client_send(void *client, const char *request);
  */
 TDJSON_EXPORT const char *td_json_client_receive(void *client, double timeout);
 
+/**
+ * Receives all immediately available incoming updates and request responses from the TDLib client, waiting for
+ * the first of them at most timeout seconds. May be called from any thread, but must not be called simultaneously
+ * from two different threads.
+ * Returned pointer will be deallocated by TDLib during next call to td_json_client_receive,
+ * td_json_client_receive_batch or td_json_client_execute in the same thread, so it can't be used after that.
+ * \param[in] client The client.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \param[in] max_count The maximum number of received objects. Non-positive values are treated as 1.
+ * \return JSON-serialized null-terminated array of incoming updates and request responses in the order they were
+ *         received. May be NULL if the timeout expires.
+ */
+TDJSON_EXPORT const char *td_json_client_receive_batch(void *client, double timeout, int max_count);
+
 /**
  * Synchronously executes TDLib request. May be called from any thread.
  * Only a few requests can be executed synchronously.
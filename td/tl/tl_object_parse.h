@@ -127,6 +127,33 @@ class TlFetchVector {
   }
 };
 
+// vectors of bare numbers are fetched with a single bounds check and copy
+template <class T>
+class TlFetchNumberVector {
+ public:
+  template <class ParserT>
+  static std::vector<T> parse(ParserT &parser) {
+    const std::uint32_t multiplicity = parser.fetch_int();
+    std::vector<T> v;
+    if (parser.get_left_len() / sizeof(T) < multiplicity) {
+      parser.set_error("Wrong vector length");
+    } else {
+      v.resize(multiplicity);
+      parser.fetch_binary_array(v.data(), v.size());
+    }
+    return v;
+  }
+};
+
+template <>
+class TlFetchVector<TlFetchInt> final : public TlFetchNumberVector<std::int32_t> {};
+
+template <>
+class TlFetchVector<TlFetchLong> final : public TlFetchNumberVector<std::int64_t> {};
+
+template <>
+class TlFetchVector<TlFetchDouble> final : public TlFetchNumberVector<double> {};
+
 template <class T>
 class TlFetchObject {
  public:
@@ -27,7 +27,7 @@ ConcurrentScheduler::ConcurrentScheduler(int32 additional_thread_count, uint64 t
     queue->init();
     outbound[i] = queue;
   }
-  thread_affinity_mask_ = thread_affinity_mask;
+  thread_affinity_masks_.resize(additional_thread_count, thread_affinity_mask);
 #endif
 
   // +1 for extra scheduler for IOCP and send_closure from unrelated threads
@@ -62,6 +62,41 @@ ConcurrentScheduler::ConcurrentScheduler(int32 additional_thread_count, uint64 t
   state_ = State::Start;
 }
 
+void ConcurrentScheduler::enable_work_stealing() {
+  CHECK(state_ == State::Start);
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  auto sched_count = schedulers_.size() - static_cast<size_t>(extra_scheduler_);
+  auto state = std::make_shared<Scheduler::WorkStealingState>(static_cast<int32>(schedulers_.size()));
+  for (size_t i = 0; i < sched_count; i++) {
+    // the main scheduler is run by the user and the extra scheduler has no thread, so they can't take actors
+    schedulers_[i]->set_work_stealing_state(state, i != 0);
+  }
+#endif
+}
+
+void ConcurrentScheduler::enable_actor_stats(double log_period) {
+  CHECK(state_ == State::Start);
+  for (auto &sched : schedulers_) {
+    sched->enable_actor_stats(log_period);
+  }
+}
+
+void ConcurrentScheduler::enable_timer_wheel() {
+  CHECK(state_ == State::Start);
+  for (auto &sched : schedulers_) {
+    sched->enable_timer_wheel();
+  }
+}
+
+void ConcurrentScheduler::set_thread_affinity_mask(int32 sched_id, uint64 thread_affinity_mask) {
+  CHECK(state_ == State::Start);
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  // the main scheduler is run in a thread of the user
+  CHECK(0 < sched_id && static_cast<size_t>(sched_id) < thread_affinity_masks_.size());
+  thread_affinity_masks_[sched_id] = thread_affinity_mask;
+#endif
+}
+
 void ConcurrentScheduler::test_one_thread_run() {
   do {
     for (auto &sched : schedulers_) {
@@ -84,7 +119,8 @@ void ConcurrentScheduler::start() {
 #if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
   for (size_t i = 1; i + extra_scheduler_ < schedulers_.size(); i++) {
     auto &sched = schedulers_[i];
-    threads_.push_back(td::thread([&, thread_affinity_mask = thread_affinity_mask_] {
+    // the thread is pinned before the scheduler allocates anything, so that its memory is local to the CPUs
+    threads_.push_back(td::thread([&, thread_affinity_mask = thread_affinity_masks_[i]] {
 #if TD_PORT_WINDOWS
       detail::Iocp::Guard iocp_guard(iocp_.get());
 #endif
@@ -44,6 +44,19 @@ class ConcurrentScheduler final : private Scheduler::Callback {
     return schedulers_.back()->get_const_guard();
   }
 
+  // allows idle scheduler threads to take ready actors, marked as stealable, from busy schedulers;
+  // must be called before start()
+  void enable_work_stealing();
+
+  // enables collection of per-actor statistics in all schedulers; must be called before start()
+  void enable_actor_stats(double log_period);
+
+  // makes all schedulers store actor timeouts in a timer wheel; must be called before start()
+  void enable_timer_wheel();
+
+  // overrides the affinity mask of the thread of the scheduler sched_id; must be called before start()
+  void set_thread_affinity_mask(int32 sched_id, uint64 thread_affinity_mask);
+
   void test_one_thread_run();
 
   bool is_finished() const {
@@ -100,7 +113,7 @@ class ConcurrentScheduler final : private Scheduler::Callback {
   std::atomic<bool> is_finished_{false};
 #if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
   vector<td::thread> threads_;
-  uint64 thread_affinity_mask_ = 0;
+  vector<uint64> thread_affinity_masks_;
 #endif
 #if TD_PORT_WINDOWS
   unique_ptr<detail::Iocp> iocp_;
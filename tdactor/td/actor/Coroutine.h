@@ -0,0 +1,314 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/config.h"
+
+#if TD_HAVE_COROUTINES
+
+#include "td/actor/actor.h"
+
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/Promise.h"
+#include "td/utils/Status.h"
+
+#include <atomic>
+#include <coroutine>
+#include <utility>
+
+namespace td {
+
+// Usage:
+//   Task<int32> SomeActor::get_count() {
+//     auto r_chats = co_await await_promise<vector<int64>>([&](Promise<vector<int64>> promise) {
+//       send_closure(chat_manager_, &ChatManager::get_chats, std::move(promise));
+//     });
+//     if (r_chats.is_error()) {
+//       co_return r_chats.move_as_error();
+//     }
+//     co_return narrow_cast<int32>(r_chats.ok().size());
+//   }
+//   ...
+//   get_count().start(std::move(promise));
+//
+// A task is run by the actor, which started it, and is resumed only on the scheduler of the actor.
+// If the actor is destroyed while the task is suspended, then the task is destroyed without being resumed.
+template <class T = Unit>
+class Task;
+
+namespace detail {
+
+class TaskPromiseBase {
+ public:
+  std::suspend_always initial_suspend() noexcept {
+    return {};
+  }
+
+  void unhandled_exception() {
+    UNREACHABLE();
+  }
+
+  // destroys the whole chain of tasks, to which the task belongs
+  void destroy_detached_root() {
+    auto *root = this;
+    while (root->parent_ != nullptr) {
+      root = root->parent_;
+    }
+    if (root->is_detached_) {
+      root->handle_.destroy();
+    }
+  }
+
+ protected:
+  std::coroutine_handle<> handle_;
+  std::coroutine_handle<> continuation_;
+  TaskPromiseBase *parent_ = nullptr;
+  bool is_detached_ = false;
+
+  template <class T>
+  friend class ::td::Task;
+};
+
+template <class T>
+class TaskPromise final : public TaskPromiseBase {
+ public:
+  class FinalAwaiter {
+   public:
+    bool await_ready() const noexcept {
+      return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<TaskPromise> handle) noexcept {
+      auto &task_promise = handle.promise();
+      if (task_promise.continuation_) {
+        return task_promise.continuation_;
+      }
+      if (task_promise.is_detached_) {
+        auto promise = std::move(task_promise.promise_);
+        auto result = std::move(task_promise.result_);
+        handle.destroy();
+        promise.set_result(std::move(result));
+      }
+      return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {
+    }
+  };
+
+  Task<T> get_return_object() noexcept;
+
+  FinalAwaiter final_suspend() noexcept {
+    return {};
+  }
+
+  void return_value(Result<T> &&result) {
+    result_ = std::move(result);
+  }
+
+ private:
+  Result<T> result_;
+  Promise<T> promise_;
+
+  friend class ::td::Task<T>;
+};
+
+template <class T, class F>
+class PromiseAwaiter {
+  enum State : int32 { Suspending, Suspended, Ready };
+
+  class ResumePromise final : public PromiseInterface<T> {
+   public:
+    explicit ResumePromise(PromiseAwaiter *awaiter) : awaiter_(awaiter) {
+    }
+    ResumePromise(const ResumePromise &) = delete;
+    ResumePromise &operator=(const ResumePromise &) = delete;
+    ResumePromise(ResumePromise &&) = delete;
+    ResumePromise &operator=(ResumePromise &&) = delete;
+    ~ResumePromise() final {
+      if (awaiter_ != nullptr) {
+        set_result(Status::Error("Lost promise"));
+      }
+    }
+
+    void set_value(T &&value) final {
+      set_result(std::move(value));
+    }
+    void set_error(Status &&error) final {
+      set_result(std::move(error));
+    }
+    void set_result(Result<T> &&result) final {
+      CHECK(awaiter_ != nullptr);
+      auto awaiter = awaiter_;
+      awaiter_ = nullptr;
+      awaiter->on_result(std::move(result));
+    }
+
+   private:
+    PromiseAwaiter *awaiter_;
+  };
+
+  class Resumer {
+   public:
+    Resumer(std::coroutine_handle<> handle, TaskPromiseBase *task_promise)
+        : handle_(handle), task_promise_(task_promise) {
+    }
+    Resumer(const Resumer &) = delete;
+    Resumer &operator=(const Resumer &) = delete;
+    Resumer(Resumer &&other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)), task_promise_(other.task_promise_) {
+    }
+    Resumer &operator=(Resumer &&) = delete;
+    ~Resumer() {
+      if (handle_) {
+        // the actor has been destroyed
+        task_promise_->destroy_detached_root();
+      }
+    }
+
+    void operator()() {
+      std::exchange(handle_, nullptr).resume();
+    }
+
+   private:
+    std::coroutine_handle<> handle_;
+    TaskPromiseBase *task_promise_;
+  };
+
+  void on_result(Result<T> &&result) {
+    result_ = std::move(result);
+    if (state_.exchange(State::Ready, std::memory_order_acq_rel) == State::Suspended) {
+      send_lambda(actor_id_, Resumer(handle_, task_promise_));
+    }
+  }
+
+ public:
+  explicit PromiseAwaiter(F &&func) : func_(std::move(func)) {
+  }
+
+  bool await_ready() const noexcept {
+    return false;
+  }
+
+  template <class U>
+  bool await_suspend(std::coroutine_handle<TaskPromise<U>> handle) {
+    handle_ = handle;
+    task_promise_ = &handle.promise();
+    actor_id_ = Scheduler::instance()->get_current_actor_id();
+    CHECK(!actor_id_.empty());
+
+    func_(Promise<T>(td::make_unique<ResumePromise>(this)));
+
+    // if the promise has already been set, then resume the task immediately
+    auto state = State::Suspending;
+    return state_.compare_exchange_strong(state, State::Suspended, std::memory_order_acq_rel);
+  }
+
+  Result<T> await_resume() {
+    return std::move(result_);
+  }
+
+ private:
+  F func_;
+  Result<T> result_;
+  std::atomic<State> state_{State::Suspending};
+  std::coroutine_handle<> handle_;
+  TaskPromiseBase *task_promise_ = nullptr;
+  ActorId<> actor_id_;
+};
+
+}  // namespace detail
+
+template <class T>
+class Task {
+ public:
+  using promise_type = detail::TaskPromise<T>;
+
+  Task() = default;
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+  Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {
+  }
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      reset();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+  ~Task() {
+    reset();
+  }
+
+  bool empty() const {
+    return !handle_;
+  }
+
+  // starts the task from an actor; the promise will be set with the result of the task
+  void start(Promise<T> promise = Promise<T>()) && {
+    CHECK(handle_);
+    auto handle = std::exchange(handle_, nullptr);
+    auto &task_promise = handle.promise();
+    task_promise.is_detached_ = true;
+    task_promise.promise_ = std::move(promise);
+    handle.resume();
+  }
+
+  bool await_ready() const noexcept {
+    return false;
+  }
+
+  template <class U>
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<detail::TaskPromise<U>> continuation) noexcept {
+    auto &task_promise = handle_.promise();
+    task_promise.continuation_ = continuation;
+    task_promise.parent_ = &continuation.promise();
+    return handle_;
+  }
+
+  Result<T> await_resume() {
+    return std::move(handle_.promise().result_);
+  }
+
+ private:
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {
+  }
+
+  void reset() {
+    if (handle_) {
+      handle_.destroy();
+      handle_ = nullptr;
+    }
+  }
+
+  friend class detail::TaskPromise<T>;
+};
+
+namespace detail {
+
+template <class T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+  auto handle = std::coroutine_handle<TaskPromise>::from_promise(*this);
+  handle_ = handle;
+  return Task<T>(handle);
+}
+
+}  // namespace detail
+
+// returns an awaitable, which calls the function with a Promise<T> and returns the Result<T>, with which it was set;
+// the awaiting task is resumed without an additional event if the promise is set synchronously
+template <class T, class F>
+detail::PromiseAwaiter<T, std::decay_t<F>> await_promise(F &&func) {
+  return detail::PromiseAwaiter<T, std::decay_t<F>>(std::decay_t<F>(std::forward<F>(func)));
+}
+
+}  // namespace td
+
+#endif
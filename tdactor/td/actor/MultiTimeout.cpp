@@ -14,10 +14,31 @@ bool MultiTimeout::has_timeout(int64 key) const {
   return items_.count(Item(key)) > 0;
 }
 
+void MultiTimeout::enable_timer_wheel() {
+  CHECK(items_.empty());
+  use_timer_wheel_ = true;
+}
+
+void MultiTimeout::set_timer_wheel_timeout_at(HeapNode *heap_node, double timeout) {
+  if (heap_node->in_heap()) {
+    timer_wheel_.fix(timeout, heap_node);
+  } else {
+    timer_wheel_.insert(timeout, heap_node);
+  }
+  // the actor timeout is only moved earlier; spurious wakeups after cancellation are handled in timeout_expired
+  if (!Actor::has_timeout() || timeout < Actor::get_timeout() + Time::now()) {
+    Actor::set_timeout_at(timeout);
+  }
+}
+
 void MultiTimeout::set_timeout_at(int64 key, double timeout) {
   LOG(DEBUG) << "Set " << get_name() << " for " << key << " in " << timeout - Time::now();
   auto item = items_.emplace(key);
   auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item.first));
+  if (use_timer_wheel_) {
+    CHECK(heap_node->in_heap() != item.second);
+    return set_timer_wheel_timeout_at(heap_node, timeout);
+  }
   if (heap_node->in_heap()) {
     CHECK(!item.second);
     bool need_update_timeout = heap_node->is_top();
@@ -40,6 +61,9 @@ void MultiTimeout::add_timeout_at(int64 key, double timeout) {
   auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item.first));
   if (heap_node->in_heap()) {
     CHECK(!item.second);
+  } else if (use_timer_wheel_) {
+    CHECK(item.second);
+    set_timer_wheel_timeout_at(heap_node, timeout);
   } else {
     CHECK(item.second);
     timeout_queue_.insert(timeout, heap_node);
@@ -55,6 +79,11 @@ void MultiTimeout::cancel_timeout(int64 key, const char *source) {
   if (item != items_.end()) {
     auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item));
     CHECK(heap_node->in_heap());
+    if (use_timer_wheel_) {
+      timer_wheel_.erase(heap_node);
+      items_.erase(item);
+      return;
+    }
     bool need_update_timeout = heap_node->is_top();
     timeout_queue_.erase(heap_node);
     items_.erase(item);
@@ -66,6 +95,14 @@ void MultiTimeout::cancel_timeout(int64 key, const char *source) {
 }
 
 void MultiTimeout::update_timeout(const char *source) {
+  if (use_timer_wheel_) {
+    if (!timer_wheel_.empty()) {
+      Actor::set_timeout_at(timer_wheel_.get_wakeup_time());
+    } else if (Actor::has_timeout()) {
+      Actor::cancel_timeout();
+    }
+    return;
+  }
   if (items_.empty()) {
     LOG(DEBUG) << "Cancel timeout of " << get_name();
     LOG_CHECK(timeout_queue_.empty()) << get_name() << ' ' << source;
@@ -88,6 +125,18 @@ void MultiTimeout::update_timeout(const char *source) {
 
 vector<int64> MultiTimeout::get_expired_keys(double now) {
   vector<int64> expired_keys;
+  if (use_timer_wheel_) {
+    while (true) {
+      auto heap_node = timer_wheel_.pop_expired(now);
+      if (heap_node == nullptr) {
+        break;
+      }
+      int64 key = static_cast<Item *>(heap_node)->key;
+      items_.erase(Item(key));
+      expired_keys.push_back(key);
+    }
+    return expired_keys;
+  }
   while (!timeout_queue_.empty() && timeout_queue_.top_key() < now) {
     int64 key = static_cast<Item *>(timeout_queue_.pop())->key;
     items_.erase(Item(key));
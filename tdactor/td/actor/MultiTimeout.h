@@ -12,6 +12,7 @@
 #include "td/utils/Heap.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Time.h"
+#include "td/utils/TimerWheel.h"
 
 #include <set>
 
@@ -44,6 +45,10 @@ class MultiTimeout final : public Actor {
     data_ = data;
   }
 
+  // stores timeouts in a timer wheel, which is faster for frequently updated timeouts;
+  // must be called before any timeout is set
+  void enable_timer_wheel();
+
   bool has_timeout(int64 key) const;
 
   void set_timeout_in(int64 key, double timeout) {
@@ -69,10 +74,14 @@ class MultiTimeout final : public Actor {
   Data data_;
 
   KHeap<double> timeout_queue_;
+  TimerWheel timer_wheel_;
+  bool use_timer_wheel_ = false;
   std::set<Item> items_;
 
   void update_timeout(const char *source);
 
+  void set_timer_wheel_timeout_at(HeapNode *heap_node, double timeout);
+
   void timeout_expired() final;
 
   vector<int64> get_expired_keys(double now);
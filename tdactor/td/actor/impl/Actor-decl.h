@@ -75,6 +75,10 @@ class Actor : public ObserverBase {
   void migrate(int32 sched_id);
   void do_migrate(int32 sched_id);
 
+  // allows an idle scheduler to take the actor in the work-stealing mode;
+  // the actor must not own pollable file descriptors and must not rely on its current scheduler
+  void set_stealable(bool is_stealable);
+
   uint64 get_link_token();
   std::weak_ptr<ActorContext> get_context_weak_ptr() const;
   std::shared_ptr<ActorContext> set_context(std::shared_ptr<ActorContext> context);
@@ -47,6 +47,14 @@ class ActorContext {
   std::weak_ptr<ActorContext> this_ptr_;
 };
 
+// statistics of all actors with the same name, collected by a scheduler if enabled
+struct ActorStats {
+  uint64 event_count = 0;
+  double total_time = 0.0;  // includes time of events, run immediately from the handlers
+  double max_event_time = 0.0;
+  size_t max_mailbox_size = 0;
+};
+
 class ActorInfo final
     : private ListNode
     , private HeapNode {
@@ -108,11 +116,20 @@ class ActorInfo final
   bool need_context() const;
   bool need_start_up() const;
 
+  bool is_stealable() const;
+  void set_stealable(bool is_stealable);
+
+  Slice get_stats_name() const;
+  void set_stats_name(Slice name);
+  ActorStats *get_stats() const;
+  void set_stats(ActorStats *stats);
+
  private:
   Deleter deleter_ = Deleter::None;
   bool need_context_ = true;
   bool need_start_up_ = true;
   bool is_running_ = false;
+  bool is_stealable_ = false;
 
   std::atomic<int32> sched_id_{0};
   Actor *actor_ = nullptr;
@@ -121,6 +138,9 @@ class ActorInfo final
   string name_;
 #endif
   std::shared_ptr<ActorContext> context_;
+
+  string stats_name_;
+  ActorStats *stats_ = nullptr;  // owned by the scheduler, which runs the actor
 };
 
 StringBuilder &operator<<(StringBuilder &sb, const ActorInfo &info);
@@ -50,6 +50,9 @@ inline void ActorInfo::init(int32 sched_id, Slice name, ObjectPool<ActorInfo>::O
   need_context_ = need_context;
   need_start_up_ = need_start_up;
   is_running_ = false;
+  is_stealable_ = false;
+  stats_name_.clear();
+  stats_ = nullptr;
 }
 
 inline bool ActorInfo::need_context() const {
@@ -60,6 +63,30 @@ inline bool ActorInfo::need_start_up() const {
   return need_start_up_;
 }
 
+inline bool ActorInfo::is_stealable() const {
+  return is_stealable_;
+}
+
+inline void ActorInfo::set_stealable(bool is_stealable) {
+  is_stealable_ = is_stealable;
+}
+
+inline Slice ActorInfo::get_stats_name() const {
+  return stats_name_;
+}
+
+inline void ActorInfo::set_stats_name(Slice name) {
+  stats_name_ = name.str();
+}
+
+inline ActorStats *ActorInfo::get_stats() const {
+  return stats_;
+}
+
+inline void ActorInfo::set_stats(ActorStats *stats) {
+  stats_ = stats;
+}
+
 inline void ActorInfo::on_actor_moved(Actor *actor_new_ptr) {
   actor_ = actor_new_ptr;
 }
@@ -10,6 +10,7 @@
 #include "td/utils/common.h"
 #include "td/utils/StringBuilder.h"
 
+#include <cstddef>
 #include <type_traits>
 #include <utility>
 
@@ -47,6 +48,10 @@ class CustomEvent {
   CustomEvent &operator=(CustomEvent &&) = delete;
   virtual ~CustomEvent() = default;
 
+  // small events are allocated from thread-local caches of freed events
+  static void *operator new(std::size_t size);
+  static void operator delete(void *ptr, std::size_t size);
+
   virtual void run(Actor *actor) = 0;
   virtual void start_migrate(int32 sched_id) {
   }
@@ -26,8 +26,10 @@
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Time.h"
+#include "td/utils/TimerWheel.h"
 #include "td/utils/type_traits.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -69,6 +71,20 @@ class Scheduler {
     virtual void on_finish() = 0;
     virtual void register_at_finish(std::function<void()>) = 0;
   };
+
+  // idle state of schedulers, shared between all schedulers in the work-stealing mode
+  class WorkStealingState {
+   public:
+    explicit WorkStealingState(int32 sched_count);
+
+    void set_idle(int32 sched_id, bool is_idle);
+
+    // returns identifier of an idle scheduler, which is marked busy, or -1 if there are no idle schedulers
+    int32 acquire_idle_scheduler(int32 sched_id);
+
+   private:
+    std::vector<std::atomic<bool>> is_idle_;
+  };
   Scheduler() = default;
   Scheduler(const Scheduler &) = delete;
   Scheduler &operator=(const Scheduler &) = delete;
@@ -81,6 +97,26 @@ class Scheduler {
   int32 sched_id() const;
   int32 sched_count() const;
 
+  // statistics of batched delivery of events to other schedulers; must be used only from the scheduler's thread
+  struct OutboundBatchStats {
+    uint64 batch_count = 0;
+    uint64 event_count = 0;
+    uint64 max_batch_size = 0;
+  };
+  OutboundBatchStats get_outbound_batch_stats() const;
+
+  // enables collection of per-actor statistics for actors created after the call;
+  // if log_period is positive, the statistics are logged once in log_period seconds
+  void enable_actor_stats(double log_period);
+  // returns statistics of actors run by the scheduler; must be used only from the scheduler's thread
+  vector<std::pair<string, ActorStats>> get_actor_stats() const;
+
+  // stores actor timeouts in a timer wheel instead of a heap; must be called before any actor timeout is set
+  void enable_timer_wheel();
+
+  // must be called before the scheduler is started
+  void set_work_stealing_state(std::shared_ptr<WorkStealingState> state, bool can_steal);
+
   template <class ActorT, class... Args>
   TD_WARN_UNUSED_RESULT ActorOwn<ActorT> create_actor(Slice name, Args &&...args);
   template <class ActorT, class... Args>
@@ -133,6 +169,8 @@ class Scheduler {
   void stop_actor(Actor *actor);
   void do_stop_actor(Actor *actor);
   uint64 get_link_token(Actor *actor);
+  // returns an empty identifier if no actor is running now
+  ActorId<> get_current_actor_id() const;
   void migrate_actor(Actor *actor, int32 dest_sched_id);
   void do_migrate_actor(Actor *actor, int32 dest_sched_id);
   void start_migrate_actor(Actor *actor, int32 dest_sched_id);
@@ -203,6 +241,7 @@ class Scheduler {
   void clear_mailbox(ActorInfo *actor_info);
 
   void flush_mailbox(ActorInfo *actor_info);
+  bool try_give_away_actor(ActorInfo *actor_info);
 
   void get_actor_sched_id_to_send_immediately(const ActorInfo *actor_info, int32 &actor_sched_id,
                                               bool &on_current_sched, bool &can_send_immediately);
@@ -212,6 +251,12 @@ class Scheduler {
 
   void send_later_impl(const ActorId<> &actor_id, Event &&event);
 
+  void flush_outbound_batches();
+
+  ActorStats *get_actor_stats(ActorInfo *actor_info);
+  static void update_actor_stats(ActorStats *stats, double start_time);
+  void log_actor_stats();
+
   Timestamp run_timeout();
   void run_mailbox();
   Timestamp run_events(Timestamp timeout);
@@ -231,6 +276,8 @@ class Scheduler {
   ListNode pending_actors_list_;
   ListNode ready_actors_list_;
   KHeap<double> timeout_queue_;
+  TimerWheel timer_wheel_;
+  bool use_timer_wheel_ = false;
 
   FlatHashMap<ActorInfo *, std::vector<Event>> pending_events_;
 
@@ -246,6 +293,19 @@ class Scheduler {
   std::shared_ptr<MpscPollableQueue<EventFull>> inbound_queue_;
   std::vector<std::shared_ptr<MpscPollableQueue<EventFull>>> outbound_queues_;
 
+  // events to other schedulers are buffered during run_events and sent with one wakeup per destination
+  bool is_batching_ = false;
+  std::vector<std::vector<EventFull>> outbound_batches_;
+  OutboundBatchStats outbound_batch_stats_;
+
+  bool is_actor_stats_enabled_ = false;
+  double actor_stats_log_period_ = 0.0;
+  double next_actor_stats_log_time_ = 0.0;
+  FlatHashMap<string, unique_ptr<ActorStats>> actor_stats_;
+
+  std::shared_ptr<WorkStealingState> work_stealing_state_;
+  bool can_steal_ = false;
+
   std::shared_ptr<ActorContext> save_context_;
 
   struct EventContext {
@@ -27,6 +27,7 @@
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Time.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -58,6 +59,30 @@ void Scheduler::set_scheduler(Scheduler *scheduler) {
   scheduler_ = scheduler;
 }
 
+Scheduler::WorkStealingState::WorkStealingState(int32 sched_count) : is_idle_(static_cast<size_t>(sched_count)) {
+  for (auto &is_idle : is_idle_) {
+    is_idle.store(false, std::memory_order_relaxed);
+  }
+}
+
+void Scheduler::WorkStealingState::set_idle(int32 sched_id, bool is_idle) {
+  is_idle_[static_cast<size_t>(sched_id)].store(is_idle, std::memory_order_release);
+}
+
+int32 Scheduler::WorkStealingState::acquire_idle_scheduler(int32 sched_id) {
+  auto sched_count = static_cast<int32>(is_idle_.size());
+  for (int32 i = 1; i < sched_count; i++) {
+    auto dest_sched_id = (sched_id + i) % sched_count;
+    auto &is_idle = is_idle_[static_cast<size_t>(dest_sched_id)];
+    bool expected = true;
+    if (is_idle.load(std::memory_order_relaxed) &&
+        is_idle.compare_exchange_strong(expected, false, std::memory_order_acq_rel)) {
+      return dest_sched_id;
+    }
+  }
+  return -1;
+}
+
 void Scheduler::ServiceActor::set_queue(std::shared_ptr<MpscPollableQueue<EventFull>> queues) {
   inbound_ = std::move(queues);
 }
@@ -119,6 +144,85 @@ void Scheduler::ServiceActor::tear_down() {
 #endif
 }
 
+/*** CustomEvent ***/
+namespace {
+class CustomEventAllocator {
+  static constexpr size_t MIN_SIZE_LOG = 5;
+  static constexpr size_t SIZE_CLASS_COUNT = 4;  // 32, 64, 128 and 256 bytes
+  static constexpr size_t MAX_CACHED_COUNT = 1024;
+
+  struct FreeNode {
+    FreeNode *next;
+  };
+  FreeNode *free_lists_[SIZE_CLASS_COUNT] = {};
+  size_t free_counts_[SIZE_CLASS_COUNT] = {};
+
+  static size_t get_size_class(size_t size) {
+    size_t size_class = 0;
+    while (size_class < SIZE_CLASS_COUNT && size > (static_cast<size_t>(1) << (size_class + MIN_SIZE_LOG))) {
+      size_class++;
+    }
+    return size_class;
+  }
+
+ public:
+  CustomEventAllocator() = default;
+  CustomEventAllocator(const CustomEventAllocator &) = delete;
+  CustomEventAllocator &operator=(const CustomEventAllocator &) = delete;
+  CustomEventAllocator(CustomEventAllocator &&) = delete;
+  CustomEventAllocator &operator=(CustomEventAllocator &&) = delete;
+  ~CustomEventAllocator() {
+    for (auto &free_list : free_lists_) {
+      while (free_list != nullptr) {
+        auto next = free_list->next;
+        ::operator delete(free_list);
+        free_list = next;
+      }
+    }
+  }
+
+  void *allocate(size_t size) {
+    auto size_class = get_size_class(size);
+    if (size_class == SIZE_CLASS_COUNT) {
+      return ::operator new(size);
+    }
+    auto &free_list = free_lists_[size_class];
+    if (free_list == nullptr) {
+      return ::operator new(static_cast<size_t>(1) << (size_class + MIN_SIZE_LOG));
+    }
+    auto result = free_list;
+    free_list = result->next;
+    free_counts_[size_class]--;
+    return result;
+  }
+
+  static void free(CustomEventAllocator *allocator, void *ptr, size_t size) {
+    auto size_class = get_size_class(size);
+    if (allocator == nullptr || size_class == SIZE_CLASS_COUNT ||
+        allocator->free_counts_[size_class] >= MAX_CACHED_COUNT) {
+      ::operator delete(ptr);
+      return;
+    }
+    auto node = static_cast<FreeNode *>(ptr);
+    node->next = allocator->free_lists_[size_class];
+    allocator->free_lists_[size_class] = node;
+    allocator->free_counts_[size_class]++;
+  }
+};
+
+TD_THREAD_LOCAL CustomEventAllocator *custom_event_allocator;  // static zero-initialized
+}  // namespace
+
+void *CustomEvent::operator new(std::size_t size) {
+  init_thread_local<CustomEventAllocator>(custom_event_allocator);
+  return custom_event_allocator->allocate(size);
+}
+
+void CustomEvent::operator delete(void *ptr, std::size_t size) {
+  // events can be freed on any thread; the cache isn't created there to avoid its creation during thread exit
+  CustomEventAllocator::free(custom_event_allocator, ptr, size);
+}
+
 /*** SchedlerGuard ***/
 SchedulerGuard::SchedulerGuard(Scheduler *scheduler, bool lock) : scheduler_(scheduler) {
   if (lock) {
@@ -227,12 +331,89 @@ void Scheduler::init(int32 id, std::vector<std::shared_ptr<MpscPollableQueue<Eve
     inbound_queue_ = std::move(outbound[id]);
   }
   outbound_queues_ = std::move(outbound);
+  outbound_batches_.clear();
+  outbound_batches_.resize(outbound_queues_.size());
+  outbound_batch_stats_ = OutboundBatchStats();
   sched_id_ = id;
   sched_n_ = static_cast<int32>(outbound_queues_.size());
   service_actor_.set_queue(inbound_queue_);
   register_actor(PSLICE() << "ServiceActor" << id, &service_actor_).release();
 }
 
+void Scheduler::enable_actor_stats(double log_period) {
+  is_actor_stats_enabled_ = true;
+  actor_stats_log_period_ = log_period;
+  next_actor_stats_log_time_ = Time::now() + log_period;
+}
+
+vector<std::pair<string, ActorStats>> Scheduler::get_actor_stats() const {
+  vector<std::pair<string, ActorStats>> result;
+  result.reserve(actor_stats_.size());
+  for (auto &it : actor_stats_) {
+    result.emplace_back(it.first, *it.second);
+  }
+  return result;
+}
+
+ActorStats *Scheduler::get_actor_stats(ActorInfo *actor_info) {
+  auto stats = actor_info->get_stats();
+  if (stats == nullptr) {
+    auto name = actor_info->get_stats_name();
+    if (name.empty()) {
+      return nullptr;
+    }
+    auto &stats_ptr = actor_stats_[name.str()];
+    if (stats_ptr == nullptr) {
+      stats_ptr = make_unique<ActorStats>();
+    }
+    stats = stats_ptr.get();
+    actor_info->set_stats(stats);
+  }
+  return stats;
+}
+
+void Scheduler::update_actor_stats(ActorStats *stats, double start_time) {
+  if (stats == nullptr) {
+    return;
+  }
+  auto event_time = Time::now() - start_time;
+  stats->event_count++;
+  stats->total_time += event_time;
+  if (event_time > stats->max_event_time) {
+    stats->max_event_time = event_time;
+  }
+}
+
+void Scheduler::log_actor_stats() {
+  constexpr size_t MAX_LOGGED_ACTORS = 20;
+  auto stats = get_actor_stats();
+  std::sort(stats.begin(), stats.end(),
+            [](const auto &lhs, const auto &rhs) { return lhs.second.total_time > rhs.second.total_time; });
+  if (stats.size() > MAX_LOGGED_ACTORS) {
+    stats.resize(MAX_LOGGED_ACTORS);
+  }
+  auto log_stats = PSTRING() << "Actors of scheduler " << sched_id_ << " with the biggest total run time:";
+  for (auto &it : stats) {
+    log_stats += PSTRING() << "\n" << it.first << ": " << tag("events", it.second.event_count)
+                           << tag("total_time", format::as_time(it.second.total_time))
+                           << tag("max_event_time", format::as_time(it.second.max_event_time))
+                           << tag("max_mailbox_size", it.second.max_mailbox_size);
+  }
+  LOG(WARNING) << log_stats;
+}
+
+void Scheduler::enable_timer_wheel() {
+  CHECK(timeout_queue_.empty());
+  use_timer_wheel_ = true;
+}
+
+void Scheduler::set_work_stealing_state(std::shared_ptr<WorkStealingState> state, bool can_steal) {
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  work_stealing_state_ = std::move(state);
+  can_steal_ = can_steal && work_stealing_state_ != nullptr;
+#endif
+}
+
 void Scheduler::clear() {
   if (service_actor_.empty()) {
     return;
@@ -363,11 +544,36 @@ void Scheduler::send_to_other_scheduler(int32 sched_id, const ActorId<> &actor_i
       VLOG(actor) << "Send to scheduler " << sched_id << ": " << event;
     }
     start_migrate(event, sched_id);
+    if (is_batching_) {
+      outbound_batches_[sched_id].push_back(EventCreator::event_unsafe(actor_id, std::move(event)));
+      return;
+    }
     outbound_queues_[sched_id]->writer_put(EventCreator::event_unsafe(actor_id, std::move(event)));
     outbound_queues_[sched_id]->writer_flush();
   }
 }
 
+void Scheduler::flush_outbound_batches() {
+  for (size_t i = 0; i < outbound_batches_.size(); i++) {
+    auto &batch = outbound_batches_[i];
+    if (batch.empty()) {
+      continue;
+    }
+    auto batch_size = static_cast<uint64>(batch.size());
+    outbound_batch_stats_.batch_count++;
+    outbound_batch_stats_.event_count += batch_size;
+    if (batch_size > outbound_batch_stats_.max_batch_size) {
+      outbound_batch_stats_.max_batch_size = batch_size;
+    }
+    outbound_queues_[i]->writer_put_batch(batch);
+    outbound_queues_[i]->writer_flush();
+  }
+}
+
+Scheduler::OutboundBatchStats Scheduler::get_outbound_batch_stats() const {
+  return outbound_batch_stats_;
+}
+
 void Scheduler::run_on_scheduler(int32 sched_id, Promise<Unit> action) {
   if (sched_id >= 0 && sched_id_ != sched_id) {
     class Worker final : public Actor {
@@ -479,13 +685,17 @@ void Scheduler::start_migrate_actor(ActorInfo *actor_info, int32 dest_sched_id)
     start_migrate(event, dest_sched_id);
   }
   actor_info->start_migrate(dest_sched_id);
+  actor_info->set_stats(nullptr);
   actor_info->get_list_node()->remove();
   cancel_actor_timeout(actor_info);
 }
 
 double Scheduler::get_actor_timeout(const ActorInfo *actor_info) const {
   const HeapNode *heap_node = actor_info->get_heap_node();
-  return heap_node->in_heap() ? timeout_queue_.get_key(heap_node) - Time::now() : 0.0;
+  if (!heap_node->in_heap()) {
+    return 0.0;
+  }
+  return (use_timer_wheel_ ? timer_wheel_.get_key(heap_node) : timeout_queue_.get_key(heap_node)) - Time::now();
 }
 
 void Scheduler::set_actor_timeout_in(ActorInfo *actor_info, double timeout) {
@@ -502,6 +712,14 @@ void Scheduler::set_actor_timeout_in(ActorInfo *actor_info, double timeout) {
 void Scheduler::set_actor_timeout_at(ActorInfo *actor_info, double timeout_at) {
   HeapNode *heap_node = actor_info->get_heap_node();
   VLOG(actor) << "Set actor " << *actor_info << " timeout in " << timeout_at - Time::now_cached();
+  if (use_timer_wheel_) {
+    if (heap_node->in_heap()) {
+      timer_wheel_.fix(timeout_at, heap_node);
+    } else {
+      timer_wheel_.insert(timeout_at, heap_node);
+    }
+    return;
+  }
   if (heap_node->in_heap()) {
     timeout_queue_.fix(timeout_at, heap_node);
   } else {
@@ -525,14 +743,42 @@ void Scheduler::flush_mailbox(ActorInfo *actor_info) {
   auto &mailbox = actor_info->mailbox_;
   size_t mailbox_size = mailbox.size();
   CHECK(mailbox_size != 0);
+  auto stats = is_actor_stats_enabled_ ? get_actor_stats(actor_info) : nullptr;
   EventGuard guard(this, actor_info);
   size_t i = 0;
-  for (; i < mailbox_size && guard.can_run(); i++) {
-    do_event(actor_info, std::move(mailbox[i]));
+  if (stats != nullptr) {
+    if (mailbox_size > stats->max_mailbox_size) {
+      stats->max_mailbox_size = mailbox_size;
+    }
+    for (; i < mailbox_size && guard.can_run(); i++) {
+      auto start_time = Time::update_now_cached();
+      do_event(actor_info, std::move(mailbox[i]));
+      update_actor_stats(stats, start_time);
+    }
+  } else {
+    for (; i < mailbox_size && guard.can_run(); i++) {
+      Time::update_now_cached();
+      do_event(actor_info, std::move(mailbox[i]));
+    }
   }
+  Time::reset_now_cached();
   mailbox.erase(mailbox.begin(), mailbox.begin() + i);
 }
 
+bool Scheduler::try_give_away_actor(ActorInfo *actor_info) {
+  // actors with a timeout are never moved, because migration cancels the timeout
+  if (!actor_info->is_stealable() || actor_info->get_heap_node()->in_heap()) {
+    return false;
+  }
+  auto dest_sched_id = work_stealing_state_->acquire_idle_scheduler(sched_id_);
+  if (dest_sched_id < 0) {
+    return false;
+  }
+  VLOG(actor) << "Give away actor " << *actor_info << " to idle scheduler " << dest_sched_id;
+  do_migrate_actor(actor_info, dest_sched_id);
+  return true;
+}
+
 void Scheduler::run_mailbox() {
   VLOG(actor) << "Run mailbox : begin";
   ListNode actors_list = std::move(ready_actors_list_);
@@ -540,6 +786,10 @@ void Scheduler::run_mailbox() {
     ListNode *node = actors_list.get();
     CHECK(node);
     auto actor_info = ActorInfo::from_list_node(node);
+    // an actor is given away only if there is other work to do, so the scheduler stays busy
+    if (work_stealing_state_ != nullptr && !actors_list.empty() && try_give_away_actor(actor_info)) {
+      continue;
+    }
     flush_mailbox(actor_info);
   }
   VLOG(actor) << "Run mailbox : finish " << actor_count_;
@@ -564,6 +814,17 @@ void Scheduler::run_mailbox() {
 
 Timestamp Scheduler::run_timeout() {
   double now = Time::now();
+  if (use_timer_wheel_) {
+    while (true) {
+      HeapNode *node = timer_wheel_.pop_expired(now);
+      if (node == nullptr) {
+        break;
+      }
+      ActorInfo *actor_info = ActorInfo::from_heap_node(node);
+      send_immediately(actor_info->actor_id(), Event::timeout());
+    }
+    return get_timeout();
+  }
   //TODO: use Timestamp().is_in_past()
   while (!timeout_queue_.empty() && timeout_queue_.top_key() < now) {
     HeapNode *node = timeout_queue_.pop();
@@ -577,10 +838,17 @@ Timestamp Scheduler::run_events(Timestamp timeout) {
   Timestamp res;
   VLOG(actor) << "Run events " << sched_id_ << " " << tag("pending", pending_events_.size())
               << tag("actors", actor_count_);
+  is_batching_ = !outbound_batches_.empty();
   do {
     run_mailbox();
     res = run_timeout();
+    flush_outbound_batches();
   } while (!ready_actors_list_.empty() && !timeout.is_in_past());
+  is_batching_ = false;
+  if (actor_stats_log_period_ > 0 && Time::now() >= next_actor_stats_log_time_) {
+    next_actor_stats_log_time_ = Time::now() + actor_stats_log_period_;
+    log_actor_stats();
+  }
   return res;
 }
 
@@ -594,7 +862,14 @@ void Scheduler::run_no_guard(Timestamp timeout) {
   if (yield_flag_) {
     return;
   }
+  bool is_idle = can_steal_ && ready_actors_list_.empty();
+  if (is_idle) {
+    work_stealing_state_->set_idle(sched_id_, true);
+  }
   run_poll(timeout);
+  if (is_idle) {
+    work_stealing_state_->set_idle(sched_id_, false);
+  }
   run_events(timeout);
 }
 
@@ -602,6 +877,12 @@ Timestamp Scheduler::get_timeout() {
   if (!ready_actors_list_.empty()) {
     return Timestamp::in(0);
   }
+  if (use_timer_wheel_) {
+    if (timer_wheel_.empty()) {
+      return Timestamp::in(10000);
+    }
+    return Timestamp::at(timer_wheel_.get_wakeup_time());
+  }
   if (timeout_queue_.empty()) {
     return Timestamp::in(10000);
   }
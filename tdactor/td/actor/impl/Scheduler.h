@@ -104,6 +104,9 @@ ActorOwn<ActorT> Scheduler::register_actor_impl(Slice name, ActorT *actor_ptr, A
   auto actor_info = info.get();
   actor_info->init(sched_id_, name, std::move(info), static_cast<Actor *>(actor_ptr), deleter,
                    ActorTraits<ActorT>::need_context, ActorTraits<ActorT>::need_start_up);
+  if (unlikely(is_actor_stats_enabled_)) {
+    actor_info->set_stats_name(name);
+  }
   VLOG(actor) << "Create actor " << *actor_info << " (actor_count = " << actor_count_ << ')';
 
   ActorId<ActorT> actor_id = weak_info->actor_id(actor_ptr);
@@ -193,7 +196,14 @@ void Scheduler::send_immediately_impl(const ActorId<> &actor_id, const RunFuncT
 
   if (likely(can_send_immediately)) {  // run immediately
     EventGuard guard(this, actor_info);
-    run_func(actor_info);
+    if (unlikely(is_actor_stats_enabled_)) {
+      auto stats = get_actor_stats(actor_info);
+      auto start_time = Time::now();
+      run_func(actor_info);
+      update_actor_stats(stats, start_time);
+    } else {
+      run_func(actor_info);
+    }
   } else {
     if (on_current_sched) {
       add_to_mailbox(actor_info, event_func());
@@ -294,6 +304,13 @@ inline uint64 Scheduler::get_link_token(ActorInfo *actor_info) {
   return event_context_ptr_->link_token;
 }
 
+inline ActorId<> Scheduler::get_current_actor_id() const {
+  if (event_context_ptr_ == nullptr) {
+    return ActorId<>();
+  }
+  return event_context_ptr_->actor_info->actor_id();
+}
+
 inline void Scheduler::finish_migrate_actor(Actor *actor) {
   register_migrated_actor(actor->get_info());
 }
@@ -314,7 +331,11 @@ inline void Scheduler::cancel_actor_timeout(Actor *actor) {
 inline void Scheduler::cancel_actor_timeout(ActorInfo *actor_info) {
   HeapNode *heap_node = actor_info->get_heap_node();
   if (heap_node->in_heap()) {
-    timeout_queue_.erase(heap_node);
+    if (use_timer_wheel_) {
+      timer_wheel_.erase(heap_node);
+    } else {
+      timeout_queue_.erase(heap_node);
+    }
   }
 }
 
@@ -47,6 +47,57 @@ TEST(MultiTimeout, bug) {
   sched.finish();
 }
 
+TEST(MultiTimeout, TimerWheel) {
+  td::ConcurrentScheduler sched(0, 0);
+  sched.enable_timer_wheel();
+
+  sched.start();
+  td::unique_ptr<td::MultiTimeout> multi_timeout;
+  struct Data {
+    td::vector<td::int64> expired_keys;
+  };
+  Data data;
+
+  {
+    auto guard = sched.get_main_guard();
+    multi_timeout = td::make_unique<td::MultiTimeout>("MultiTimeout");
+    multi_timeout->enable_timer_wheel();
+    multi_timeout->set_callback([](void *void_data, td::int64 key) {
+      auto &data = *static_cast<Data *>(void_data);
+      data.expired_keys.push_back(key);
+      if (key == 100) {
+        td::Scheduler::instance()->finish();
+      }
+    });
+    multi_timeout->set_callback_data(&data);
+    for (td::int64 key = 1; key <= 100; key++) {
+      multi_timeout->set_timeout_in(key, 1.0);
+    }
+    for (td::int64 key = 1; key < 100; key++) {
+      if (key % 3 == 0) {
+        multi_timeout->cancel_timeout(key);
+      } else {
+        multi_timeout->set_timeout_in(key, static_cast<double>(key) * 0.001);
+      }
+    }
+    multi_timeout->add_timeout_in(100, 0.001);
+  }
+
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+
+  td::vector<td::int64> expected_keys;
+  for (td::int64 key = 1; key < 100; key++) {
+    if (key % 3 != 0) {
+      expected_keys.push_back(key);
+    }
+  }
+  expected_keys.push_back(100);
+  ASSERT_EQ(expected_keys, data.expired_keys);
+}
+
 class TimeoutManager final : public td::Actor {
   static td::int32 count;
 
@@ -6,6 +6,7 @@
 //
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
+#include "td/actor/Coroutine.h"
 #include "td/actor/MultiPromise.h"
 #include "td/actor/PromiseFuture.h"
 #include "td/actor/SleepActor.h"
@@ -65,6 +66,36 @@ TEST(Actors, SendLater) {
   ASSERT_STREQ("AAA", sb.as_cslice().c_str());
 }
 
+TEST(Actors, ActorStats) {
+  td::Scheduler scheduler;
+  scheduler.init(0, create_queues(), nullptr);
+  scheduler.enable_actor_stats(0.0);
+
+  auto guard = scheduler.get_guard();
+  class Worker final : public td::Actor {
+   public:
+    void f() {
+    }
+
+   private:
+    void start_up() final {
+    }
+  };
+  auto id = td::create_actor<Worker>("StatsWorker");
+  for (int i = 0; i < 3; i++) {
+    td::send_closure_later(id, &Worker::f);
+  }
+  scheduler.run_no_guard(td::Timestamp::now());
+  td::send_closure(id, &Worker::f);
+
+  auto stats = scheduler.get_actor_stats();
+  ASSERT_EQ(1u, stats.size());
+  ASSERT_EQ("StatsWorker", stats[0].first);
+  ASSERT_EQ(5u, stats[0].second.event_count);
+  ASSERT_EQ(4u, stats[0].second.max_mailbox_size);
+  ASSERT_TRUE(stats[0].second.max_event_time <= stats[0].second.total_time);
+}
+
 class X {
  public:
   X() {
@@ -638,6 +669,42 @@ TEST(Actors, send_from_other_threads) {
   }
   scheduler.finish();
 }
+
+#if TD_HAVE_THREAD_AFFINITY && TD_LINUX
+TEST(Actors, thread_affinity_mask) {
+  auto available_mask = td::thread::get_affinity_mask(td::this_thread::get_id());
+  if (available_mask == 0) {
+    return;
+  }
+  auto mask = available_mask & ~(available_mask - 1);
+
+  td::ConcurrentScheduler scheduler(2, 0);
+  scheduler.set_thread_affinity_mask(2, mask);
+
+  class AffinityChecker final : public td::Actor {
+   public:
+    explicit AffinityChecker(td::uint64 &mask) : mask_(mask) {
+    }
+
+   private:
+    td::uint64 &mask_;
+
+    void start_up() final {
+      mask_ = td::thread::get_affinity_mask(td::this_thread::get_id());
+      td::Scheduler::instance()->finish();
+      stop();
+    }
+  };
+
+  td::uint64 thread_mask = 0;
+  scheduler.create_actor_unsafe<AffinityChecker>(2, "AffinityChecker", thread_mask).release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+  ASSERT_EQ(mask, thread_mask);
+}
+#endif
 #endif
 
 class DelayedCall final : public td::Actor {
@@ -680,3 +747,83 @@ TEST(Actors, MultiPromiseSendClosureLater) {
   }
   scheduler.finish();
 }
+
+#if TD_HAVE_COROUTINES
+class CoroutineTestActor final : public td::Actor {
+ public:
+  void get_square(int x, td::Promise<int> promise) {
+    promise.set_value(x * x);
+  }
+
+  void get_square_later(int x, td::Promise<int> promise) {
+    send_closure_later(actor_id(this), &CoroutineTestActor::get_square, x, std::move(promise));
+  }
+};
+
+class CoroutineTestMainActor final : public td::Actor {
+ public:
+  explicit CoroutineTestMainActor(int &result) : result_(result) {
+  }
+
+ private:
+  int &result_;
+  td::ActorOwn<CoroutineTestActor> test_actor_;
+
+  td::Task<int> get_square(int x, bool is_later) {
+    auto r_square = co_await td::await_promise<int>([&](td::Promise<int> promise) {
+      if (is_later) {
+        send_closure(test_actor_, &CoroutineTestActor::get_square_later, x, std::move(promise));
+      } else {
+        send_closure(test_actor_, &CoroutineTestActor::get_square, x, std::move(promise));
+      }
+    });
+    CHECK(r_square.is_ok());
+    co_return r_square.move_as_ok();
+  }
+
+  td::Task<int> get_sum() {
+    int sum = 0;
+    for (int i = 1; i <= 10; i++) {
+      auto r_square = co_await get_square(i, i % 2 == 0);
+      if (r_square.is_error()) {
+        co_return r_square.move_as_error();
+      }
+      sum += r_square.ok();
+    }
+
+    auto r_lost = co_await td::await_promise<int>([](td::Promise<int> promise) {});
+    CHECK(r_lost.is_error());
+
+    auto r_error = co_await td::await_promise<int>([](td::Promise<int> promise) {
+      send_lambda(td::Scheduler::instance()->get_current_actor_id(),
+                  [promise = std::move(promise)]() mutable { promise.set_error(td::Status::Error("Test")); });
+    });
+    CHECK(r_error.is_error());
+    co_return sum;
+  }
+
+  void start_up() final {
+    test_actor_ = td::create_actor<CoroutineTestActor>("CoroutineTestActor");
+    get_sum().start(td::PromiseCreator::lambda([actor_id = actor_id(this)](int sum) {
+      send_closure(actor_id, &CoroutineTestMainActor::on_sum, sum);
+    }));
+  }
+
+  void on_sum(int sum) {
+    result_ = sum;
+    td::Scheduler::instance()->finish();
+    stop();
+  }
+};
+
+TEST(Actors, Coroutine) {
+  td::ConcurrentScheduler scheduler(0, 0);
+  int result = 0;
+  scheduler.create_actor_unsafe<CoroutineTestMainActor>(0, "CoroutineTestMainActor", result).release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+  ASSERT_EQ(385, result);
+}
+#endif
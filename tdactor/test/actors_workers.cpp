@@ -27,6 +27,7 @@ class PowerWorker final : public td::Actor {
   };
   void set_callback(td::unique_ptr<Callback> callback) {
     callback_ = std::move(callback);
+    set_stealable(true);
   }
   void task(td::uint32 x, td::uint32 p) {
     td::uint32 res = 1;
@@ -106,12 +107,15 @@ class Manager final : public td::Actor {
   int query_size_;
 };
 
-static void test_workers(int threads_n, int workers_n, int queries_n, int query_size) {
+static void test_workers(int threads_n, int workers_n, int queries_n, int query_size, bool work_stealing = false) {
   td::ConcurrentScheduler sched(threads_n, 0);
+  if (work_stealing) {
+    sched.enable_work_stealing();
+  }
 
   td::vector<td::ActorId<PowerWorker>> workers;
   for (int i = 0; i < workers_n; i++) {
-    int thread_id = threads_n ? i % (threads_n - 1) + 2 : 0;
+    int thread_id = threads_n ? (work_stealing ? 2 : i % (threads_n - 1) + 2) : 0;
     workers.push_back(sched.create_actor_unsafe<PowerWorker>(thread_id, PSLICE() << "worker" << i).release());
   }
   sched.create_actor_unsafe<Manager>(threads_n ? 1 : 0, "Manager", queries_n, query_size, std::move(workers)).release();
@@ -149,6 +153,14 @@ TEST(Actors, workers_small_query_nine_threads) {
   test_workers(9, 10, 10000, 1);
 }
 
+TEST(Actors, workers_big_query_work_stealing) {
+  test_workers(4, 10, 1000, 300000, true);
+}
+
+TEST(Actors, workers_small_query_work_stealing) {
+  test_workers(4, 10, 100000, 1, true);
+}
+
 class SenderActor;
 
 class ReceiverActor final : public td::Actor {
@@ -186,3 +198,55 @@ TEST(Actors, send_closure_while_finish) {
   }
   sched.finish();
 }
+
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+class BatchReceiverActor final : public td::Actor {
+ public:
+  void receive() {
+    if (++received_ == 1000) {
+      td::Scheduler::instance()->finish();
+    }
+  }
+
+ private:
+  int received_ = 0;
+};
+
+class BatchSenderActor final : public td::Actor {
+ public:
+  explicit BatchSenderActor(td::ActorId<BatchReceiverActor> actor_id) : actor_id_(std::move(actor_id)) {
+  }
+
+ private:
+  td::ActorId<BatchReceiverActor> actor_id_;
+  td::Scheduler::OutboundBatchStats start_stats_;
+
+  void start_up() final {
+    start_stats_ = td::Scheduler::instance()->get_outbound_batch_stats();
+    for (int i = 0; i < 1000; i++) {
+      send_closure(actor_id_, &BatchReceiverActor::receive);
+    }
+    send_closure_later(actor_id(this), &BatchSenderActor::check_stats);
+  }
+
+  void check_stats() {
+    auto stats = td::Scheduler::instance()->get_outbound_batch_stats();
+    ASSERT_EQ(stats.batch_count, start_stats_.batch_count + 1);
+    ASSERT_EQ(stats.event_count, start_stats_.event_count + 1000);
+    ASSERT_TRUE(stats.max_batch_size >= 1000);
+  }
+};
+
+TEST(Actors, batched_send_to_other_scheduler) {
+  td::ConcurrentScheduler sched(2, 0);
+
+  auto receiver = sched.create_actor_unsafe<BatchReceiverActor>(2, "BatchReceiverActor").release();
+  sched.create_actor_unsafe<BatchSenderActor>(1, "BatchSenderActor", receiver).release();
+
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+}
+#endif
@@ -26,6 +26,7 @@
 #include "td/utils/tl_parsers.h"
 #include "td/utils/tl_storers.h"
 
+#include <array>
 #include <functional>
 #include <memory>
 #include <unordered_map>
@@ -89,7 +90,8 @@ class BinlogKeyValue final : public KeyValueSyncInterface {
             LOG(ERROR) << "Have event with empty key";
             return;
           }
-          map_.emplace(event.key.str(), std::make_pair(event.value.str(), binlog_event.id_));
+          auto key = event.key.str();
+          get_shard(key).map.emplace(std::move(key), std::make_pair(event.value.str(), binlog_event.id_));
         },
         std::move(db_key), DbKey::empty(), scheduler_id));
     return Status::OK();
@@ -104,7 +106,9 @@ class BinlogKeyValue final : public KeyValueSyncInterface {
 
   template <class OtherBinlogT>
   void external_init_handle(BinlogKeyValue<OtherBinlogT> &&other) {
-    map_ = std::move(other.map_);
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+      shards_[i].map = std::move(other.shards_[i].map);
+    }
   }
 
   void external_init_handle(const BinlogEvent &binlog_event) {
@@ -114,7 +118,8 @@ class BinlogKeyValue final : public KeyValueSyncInterface {
       LOG(ERROR) << "Have external event with empty key";
       return;
     }
-    map_.emplace(event.key.str(), std::make_pair(event.value.str(), binlog_event.id_));
+    auto key = event.key.str();
+    get_shard(key).map.emplace(std::move(key), std::make_pair(event.value.str(), binlog_event.id_));
   }
 
   void external_init_finish(std::shared_ptr<BinlogT> binlog) {
@@ -129,10 +134,11 @@ class BinlogKeyValue final : public KeyValueSyncInterface {
   }
 
   SeqNo set(string key, string value) final {
-    auto lock = rw_mutex_.lock_write().move_as_ok();
+    auto &shard = get_shard(key);
+    auto lock = shard.rw_mutex.lock_write().move_as_ok();
     uint64 old_event_id = 0;
     CHECK(!key.empty());
-    auto it_ok = map_.emplace(key, std::make_pair(value, 0));
+    auto it_ok = shard.map.emplace(key, std::make_pair(value, 0));
     if (!it_ok.second) {
       if (it_ok.first->second.first == value) {
         return 0;
@@ -162,14 +168,15 @@ class BinlogKeyValue final : public KeyValueSyncInterface {
   }
 
   SeqNo erase(const string &key) final {
-    auto lock = rw_mutex_.lock_write().move_as_ok();
-    auto it = map_.find(key);
-    if (it == map_.end()) {
+    auto &shard = get_shard(key);
+    auto lock = shard.rw_mutex.lock_write().move_as_ok();
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) {
       return 0;
     }
     VLOG(binlog) << "Remove value of key " << key << ", which is " << hex_encode(it->second.first);
     uint64 event_id = it->second.second;
-    map_.erase(it);
+    shard.map.erase(it);
     auto seq_no = binlog_->next_event_id();
     lock.reset();
     add_event(seq_no, BinlogEvent::create_raw(event_id, BinlogEvent::ServiceTypes::Empty, BinlogEvent::Flags::Rewrite,
@@ -178,13 +185,14 @@ class BinlogKeyValue final : public KeyValueSyncInterface {
   }
 
   SeqNo erase_batch(vector<string> keys) final {
-    auto lock = rw_mutex_.lock_write().move_as_ok();
+    auto locks = lock_all_shards();
     vector<uint64> log_event_ids;
     for (auto &key : keys) {
-      auto it = map_.find(key);
-      if (it != map_.end()) {
+      auto &map = get_shard(key).map;
+      auto it = map.find(key);
+      if (it != map.end()) {
         log_event_ids.push_back(it->second.second);
-        map_.erase(it);
+        map.erase(it);
       }
     }
     if (log_event_ids.empty()) {
@@ -199,14 +207,16 @@ class BinlogKeyValue final : public KeyValueSyncInterface {
   }
 
   bool isset(const string &key) final {
-    auto lock = rw_mutex_.lock_read().move_as_ok();
-    return map_.count(key) > 0;
+    auto &shard = get_shard(key);
+    auto lock = shard.rw_mutex.lock_read().move_as_ok();
+    return shard.map.count(key) > 0;
   }
 
   string get(const string &key) final {
-    auto lock = rw_mutex_.lock_read().move_as_ok();
-    auto it = map_.find(key);
-    if (it == map_.end()) {
+    auto &shard = get_shard(key);
+    auto lock = shard.rw_mutex.lock_read().move_as_ok();
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) {
       return string();
     }
     VLOG(binlog) << "Get value of key " << key << ", which is " << hex_encode(it->second.first);
@@ -222,45 +232,57 @@ class BinlogKeyValue final : public KeyValueSyncInterface {
   }
 
   void for_each(std::function<void(Slice, Slice)> func) final {
-    auto lock = rw_mutex_.lock_write().move_as_ok();
-    for (const auto &kv : map_) {
-      func(kv.first, kv.second.first);
+    auto locks = lock_all_shards();
+    for (const auto &shard : shards_) {
+      for (const auto &kv : shard.map) {
+        func(kv.first, kv.second.first);
+      }
     }
   }
 
   std::unordered_map<string, string, Hash<string>> prefix_get(Slice prefix) final {
-    auto lock = rw_mutex_.lock_write().move_as_ok();
+    auto locks = lock_all_shards();
     std::unordered_map<string, string, Hash<string>> res;
-    for (const auto &kv : map_) {
-      if (begins_with(kv.first, prefix)) {
-        res.emplace(kv.first.substr(prefix.size()), kv.second.first);
+    for (const auto &shard : shards_) {
+      for (const auto &kv : shard.map) {
+        if (begins_with(kv.first, prefix)) {
+          res.emplace(kv.first.substr(prefix.size()), kv.second.first);
+        }
       }
     }
     return res;
   }
 
   FlatHashMap<string, string> get_all() final {
-    auto lock = rw_mutex_.lock_write().move_as_ok();
+    auto locks = lock_all_shards();
+    size_t size = 0;
+    for (const auto &shard : shards_) {
+      size += shard.map.size();
+    }
     FlatHashMap<string, string> res;
-    res.reserve(map_.size());
-    for (const auto &kv : map_) {
-      res.emplace(kv.first, kv.second.first);
+    res.reserve(size);
+    for (const auto &shard : shards_) {
+      for (const auto &kv : shard.map) {
+        res.emplace(kv.first, kv.second.first);
+      }
     }
     return res;
   }
 
   void erase_by_prefix(Slice prefix) final {
-    auto lock = rw_mutex_.lock_write().move_as_ok();
+    auto locks = lock_all_shards();
     vector<uint64> event_ids;
-    table_remove_if(map_, [&](const auto &it) {
-      if (begins_with(it.first, prefix)) {
-        event_ids.push_back(it.second.second);
-        return true;
-      }
-      return false;
-    });
+    for (auto &shard : shards_) {
+      table_remove_if(shard.map, [&](const auto &it) {
+        if (begins_with(it.first, prefix)) {
+          event_ids.push_back(it.second.second);
+          return true;
+        }
+        return false;
+      });
+    }
     auto seq_no = binlog_->next_event_id(narrow_cast<int32>(event_ids.size()));
-    lock.reset();
+    locks.clear();
     for (auto event_id : event_ids) {
       add_event(seq_no, BinlogEvent::create_raw(event_id, BinlogEvent::ServiceTypes::Empty, BinlogEvent::Flags::Rewrite,
                                                 EmptyStorer()));
@@ -276,10 +298,32 @@ class BinlogKeyValue final : public KeyValueSyncInterface {
   }
 
  private:
-  FlatHashMap<string, std::pair<string, uint64>> map_;
+  // keys are distributed between shards with separate locks, so readers of different keys don't contend
+  static constexpr int SHARD_BITS = 4;
+  static constexpr size_t SHARD_COUNT = static_cast<size_t>(1) << SHARD_BITS;
+
+  struct Shard {
+    FlatHashMap<string, std::pair<string, uint64>> map;
+    RwMutex rw_mutex;
+  };
+  std::array<Shard, SHARD_COUNT> shards_;
   std::shared_ptr<BinlogT> binlog_;
-  RwMutex rw_mutex_;
   int32 magic_ = MAGIC;
+
+  Shard &get_shard(const string &key) {
+    // the highest bits of the hash are used, because the lowest bits are used by FlatHashMap itself
+    return shards_[Hash<string>()(key) >> (32 - SHARD_BITS)];
+  }
+
+  // all shards are locked in the same order, so this can't deadlock with locking of a single shard
+  vector<RwMutex::WriteLock> lock_all_shards() {
+    vector<RwMutex::WriteLock> locks;
+    locks.reserve(SHARD_COUNT);
+    for (auto &shard : shards_) {
+      locks.push_back(shard.rw_mutex.lock_write().move_as_ok());
+    }
+    return locks;
+  }
 };
 
 template <>
@@ -18,10 +18,12 @@
 
 namespace td {
 
+// Opens a separate connection to the database for each scheduler, on which it is used.
+// Read-only connections can be used to read from a WAL database simultaneously with a writer on another scheduler.
 class SqliteConnectionSafe {
  public:
   SqliteConnectionSafe() = default;
-  SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version = {});
+  SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version = {}, bool is_read_only = false);
 
   SqliteDb &get();
   void set(SqliteDb &&db);
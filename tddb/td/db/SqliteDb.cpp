@@ -7,7 +7,9 @@
 #include "td/db/SqliteDb.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/format.h"
+#include "td/utils/List.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/path.h"
 #include "td/utils/port/Stat.h"
@@ -69,6 +71,56 @@ string db_key_to_sqlcipher_key(const DbKey &db_key) {
 }
 }  // namespace
 
+class SqliteDb::StatementCache {
+  struct Node final : public ListNode {
+    string sql_;
+    SqliteStatement statement_;
+
+    Node(string sql, SqliteStatement statement) : sql_(std::move(sql)), statement_(std::move(statement)) {
+    }
+  };
+
+ public:
+  StatementCache() = default;
+  StatementCache(const StatementCache &) = delete;
+  StatementCache &operator=(const StatementCache &) = delete;
+  StatementCache(StatementCache &&) = delete;
+  StatementCache &operator=(StatementCache &&) = delete;
+  ~StatementCache() = default;
+
+  SqliteStatement *get(Slice sql) {
+    auto it = nodes_.find(sql);
+    if (it == nodes_.end()) {
+      return nullptr;
+    }
+    auto *node = it->second.get();
+    node->remove();
+    lru_list_.put(node);
+    return &node->statement_;
+  }
+
+  SqliteStatement *add(string sql, SqliteStatement statement) {
+    if (nodes_.size() >= MAX_CACHED_STATEMENTS) {
+      auto *oldest_node = static_cast<Node *>(lru_list_.get());
+      CHECK(oldest_node != nullptr);
+      auto it = nodes_.find(oldest_node->sql_);
+      CHECK(it != nodes_.end());
+      auto evicted_node = std::move(it->second);
+      nodes_.erase(it);
+    }
+    auto node = td::make_unique<Node>(std::move(sql), std::move(statement));
+    auto *result = &node->statement_;
+    lru_list_.put(node.get());
+    auto key = Slice(node->sql_);
+    nodes_.emplace(key, std::move(node));
+    return result;
+  }
+
+ private:
+  ListNode lru_list_;
+  FlatHashMap<Slice, unique_ptr<Node>, SliceHash> nodes_;
+};
+
 SqliteDb::~SqliteDb() = default;
 
 Status SqliteDb::init(CSlice path, bool allow_creation) {
@@ -95,6 +147,7 @@ Status SqliteDb::init(CSlice path, bool allow_creation) {
   }
   tdsqlite3_busy_timeout(db, 1000 * 5 /* 5 seconds */);
   raw_ = std::make_shared<detail::RawSqliteDb>(db, path.str());
+  statement_cache_ = std::make_shared<StatementCache>();
   return Status::OK();
 }
 
@@ -140,11 +193,12 @@ Status SqliteDb::exec(CSlice cmd) {
 }
 
 Result<bool> SqliteDb::has_table(Slice table) {
-  TRY_RESULT(stmt, get_statement(PSLICE() << "SELECT count(*) FROM sqlite_master WHERE type='table' AND name='" << table
-                                          << "'"));
-  TRY_STATUS(stmt.step());
-  CHECK(stmt.has_row());
-  auto cnt = stmt.view_int32(0);
+  TRY_RESULT(stmt, get_cached_statement("SELECT count(*) FROM sqlite_master WHERE type='table' AND name=?1"));
+  auto guard = stmt->guard();
+  TRY_STATUS(stmt->bind_string(1, table));
+  TRY_STATUS(stmt->step());
+  CHECK(stmt->has_row());
+  auto cnt = stmt->view_int32(0);
   return cnt == 1;
 }
 
@@ -169,12 +223,13 @@ Result<string> SqliteDb::get_pragma_string(Slice name) {
 }
 
 Result<int32> SqliteDb::user_version() {
-  TRY_RESULT(get_version_stmt, get_statement("PRAGMA user_version"));
-  TRY_STATUS(get_version_stmt.step());
-  if (!get_version_stmt.has_row()) {
+  TRY_RESULT(get_version_stmt, get_cached_statement("PRAGMA user_version"));
+  auto guard = get_version_stmt->guard();
+  TRY_STATUS(get_version_stmt->step());
+  if (!get_version_stmt->has_row()) {
     return Status::Error(PSLICE() << "PRAGMA user_version failed for database \"" << raw_->path() << '"');
   }
-  return get_version_stmt.view_int32(0);
+  return get_version_stmt->view_int32(0);
 }
 
 Status SqliteDb::set_user_version(int32 version) {
@@ -320,4 +375,16 @@ Result<SqliteStatement> SqliteDb::get_statement(CSlice statement) {
   return SqliteStatement(stmt, raw_);
 }
 
+Result<SqliteStatement *> SqliteDb::get_cached_statement(CSlice statement) {
+  CHECK(statement_cache_ != nullptr);
+  auto *result = statement_cache_->get(statement);
+  if (result == nullptr) {
+    TRY_RESULT(new_statement, get_statement(statement));
+    result = statement_cache_->add(statement.str(), std::move(new_statement));
+  } else {
+    result->reset();
+  }
+  return result;
+}
+
 }  // namespace td
@@ -33,7 +33,7 @@ class SqliteDb {
 
   // dangerous
   SqliteDb clone() const {
-    return SqliteDb(raw_, enable_logging_);
+    return SqliteDb(raw_, statement_cache_, enable_logging_);
   }
 
   bool empty() const {
@@ -70,6 +70,12 @@ class SqliteDb {
 
   Result<SqliteStatement> get_statement(CSlice statement) TD_WARN_UNUSED_RESULT;
 
+  // returns a reset prepared statement from the LRU cache of the connection, which is shared with all its clones;
+  // the statement must be reset after use and can be evicted by a call for MAX_CACHED_STATEMENTS other statements
+  Result<SqliteStatement *> get_cached_statement(CSlice statement) TD_WARN_UNUSED_RESULT;
+
+  static constexpr size_t MAX_CACHED_STATEMENTS = 64;
+
   template <class F>
   static void with_db_path(Slice main_path, F &&f) {
     detail::RawSqliteDb::with_db_path(main_path, f);
@@ -78,10 +84,14 @@ class SqliteDb {
   optional<int32> get_cipher_version() const;
 
  private:
-  SqliteDb(std::shared_ptr<detail::RawSqliteDb> raw, bool enable_logging)
-      : raw_(std::move(raw)), enable_logging_(enable_logging) {
+  class StatementCache;
+
+  SqliteDb(std::shared_ptr<detail::RawSqliteDb> raw, std::shared_ptr<StatementCache> statement_cache,
+           bool enable_logging)
+      : raw_(std::move(raw)), statement_cache_(std::move(statement_cache)), enable_logging_(enable_logging) {
   }
   std::shared_ptr<detail::RawSqliteDb> raw_;
+  std::shared_ptr<StatementCache> statement_cache_;
   bool enable_logging_ = false;
 
   Status init(CSlice path, bool allow_creation) TD_WARN_UNUSED_RESULT;
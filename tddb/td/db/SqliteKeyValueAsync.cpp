@@ -11,11 +11,29 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/common.h"
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/optional.h"
 #include "td/utils/Time.h"
 
 namespace td {
 
+StringBuilder &operator<<(StringBuilder &string_builder, const SqliteKeyValueAsyncStats &stats) {
+  auto commits_per_second =
+      stats.elapsed_time > 0 ? static_cast<double>(stats.commit_count) / stats.elapsed_time : 0.0;
+  auto average_batch_size =
+      stats.commit_count > 0 ? static_cast<double>(stats.committed_query_count) / static_cast<double>(stats.commit_count)
+                             : 0.0;
+  return string_builder << "SqliteKeyValueAsyncStats[" << tag("commit_count", stats.commit_count)
+                        << tag("committed_query_count", stats.committed_query_count)
+                        << tag("max_batch_size", stats.max_batch_size)
+                        << tag("average_batch_size", average_batch_size)
+                        << tag("commits_per_second", commits_per_second)
+                        << tag("total_commit_time", format::as_time(stats.total_commit_time))
+                        << tag("elapsed_time", format::as_time(stats.elapsed_time)) << ']';
+}
+
 class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
  public:
   explicit SqliteKeyValueAsync(std::shared_ptr<SqliteKeyValueSafe> kv_safe, int32 scheduler_id = -1) {
@@ -36,6 +54,9 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
   void get(string key, Promise<string> promise) final {
     send_closure_later(impl_, &Impl::get, std::move(key), std::move(promise));
   }
+  void get_stats(Promise<SqliteKeyValueAsyncStats> promise) final {
+    send_closure_later(impl_, &Impl::get_stats, std::move(promise));
+  }
   void close(Promise<Unit> promise) final {
     send_closure_later(impl_, &Impl::close, std::move(promise));
   }
@@ -96,8 +117,13 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
       promise.set_value(kv_->get(key));
     }
 
+    void get_stats(Promise<SqliteKeyValueAsyncStats> promise) {
+      promise.set_value(get_current_stats());
+    }
+
     void close(Promise<Unit> promise) {
       do_flush(true /*force*/);
+      LOG(INFO) << "Close key-value storage with " << get_current_stats();
       kv_safe_.reset();
       kv_ = nullptr;
       stop();
@@ -109,12 +135,28 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
     SqliteKeyValue *kv_ = nullptr;
 
     static constexpr double MAX_PENDING_QUERIES_DELAY = 0.01;
-    static constexpr size_t MAX_PENDING_QUERIES_COUNT = 100;
+    static constexpr double MIN_PENDING_QUERIES_DELAY = 0.001;
+    static constexpr double IDLE_TIME = 1.0;
+    static constexpr size_t MIN_PENDING_QUERIES_COUNT = 100;
+    static constexpr size_t MAX_PENDING_QUERIES_COUNT = 3200;
     FlatHashMap<string, optional<string>> buffer_;
     vector<Promise<Unit>> buffer_promises_;
     size_t cnt_ = 0;
+    size_t max_pending_queries_count_ = MIN_PENDING_QUERIES_COUNT;
+    double last_commit_time_ = 0;
+    double start_time_ = 0;
+    SqliteKeyValueAsyncStats stats_;
 
     double wakeup_at_ = 0;
+
+    // commit as soon as possible if someone waits for the commit or there were no recent commits
+    double get_pending_queries_delay(double now) const {
+      if (!buffer_promises_.empty() || now > last_commit_time_ + IDLE_TIME) {
+        return MIN_PENDING_QUERIES_DELAY;
+      }
+      return MAX_PENDING_QUERIES_DELAY;
+    }
+
     void do_flush(bool force) {
       if (buffer_.empty()) {
         return;
@@ -122,18 +164,28 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
 
       if (!force) {
         auto now = Time::now_cached();
-        if (wakeup_at_ == 0) {
-          wakeup_at_ = now + MAX_PENDING_QUERIES_DELAY;
+        auto wakeup_at = now + get_pending_queries_delay(now);
+        if (wakeup_at_ == 0 || wakeup_at < wakeup_at_) {
+          wakeup_at_ = wakeup_at;
         }
-        if (now < wakeup_at_ && cnt_ < MAX_PENDING_QUERIES_COUNT) {
-          set_timeout_at(wakeup_at_);
-          return;
+        if (now < wakeup_at_) {
+          if (cnt_ < max_pending_queries_count_) {
+            set_timeout_at(wakeup_at_);
+            return;
+          }
+          // the queries come faster than they are committed, so bigger transactions are needed
+          max_pending_queries_count_ = min(max_pending_queries_count_ * 2, MAX_PENDING_QUERIES_COUNT);
+        } else if (cnt_ * 4 < max_pending_queries_count_) {
+          max_pending_queries_count_ = max(max_pending_queries_count_ / 2, MIN_PENDING_QUERIES_COUNT);
         }
       }
 
+      auto batch_size = static_cast<int64>(cnt_);
       wakeup_at_ = 0;
       cnt_ = 0;
+      cancel_timeout();
 
+      auto commit_start_time = Time::now();
       kv_->begin_write_transaction().ensure();
       for (auto &it : buffer_) {
         if (it.second) {
@@ -144,15 +196,29 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
       }
       kv_->commit_transaction().ensure();
       buffer_.clear();
+      last_commit_time_ = Time::now();
+
+      stats_.commit_count++;
+      stats_.committed_query_count += batch_size;
+      stats_.max_batch_size = max(stats_.max_batch_size, batch_size);
+      stats_.total_commit_time += last_commit_time_ - commit_start_time;
+
       set_promises(buffer_promises_);
     }
 
+    SqliteKeyValueAsyncStats get_current_stats() const {
+      auto result = stats_;
+      result.elapsed_time = Time::now() - start_time_;
+      return result;
+    }
+
     void timeout_expired() final {
       do_flush(false /*force*/);
     }
 
     void start_up() final {
       kv_ = &kv_safe_->get();
+      start_time_ = Time::now();
     }
   };
   ActorOwn<Impl> impl_;
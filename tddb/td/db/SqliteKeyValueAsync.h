@@ -11,11 +11,22 @@
 #include "td/utils/common.h"
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/Promise.h"
+#include "td/utils/StringBuilder.h"
 
 #include <memory>
 
 namespace td {
 
+struct SqliteKeyValueAsyncStats {
+  int64 commit_count = 0;
+  int64 committed_query_count = 0;
+  int64 max_batch_size = 0;
+  double total_commit_time = 0.0;
+  double elapsed_time = 0.0;  // time since the storage was opened
+};
+
+StringBuilder &operator<<(StringBuilder &string_builder, const SqliteKeyValueAsyncStats &stats);
+
 class SqliteKeyValueAsyncInterface {
  public:
   virtual ~SqliteKeyValueAsyncInterface() = default;
@@ -30,6 +41,8 @@ class SqliteKeyValueAsyncInterface {
 
   virtual void get(string key, Promise<string> promise) = 0;
 
+  virtual void get_stats(Promise<SqliteKeyValueAsyncStats> promise) = 0;
+
   virtual void close(Promise<Unit> promise) = 0;
 };
 
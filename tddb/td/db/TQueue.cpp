@@ -20,7 +20,9 @@
 #include "td/utils/tl_helpers.h"
 #include "td/utils/tl_parsers.h"
 #include "td/utils/tl_storers.h"
+#include "td/utils/VectorQueue.h"
 
+#include <algorithm>
 #include <set>
 
 namespace td {
@@ -102,7 +104,7 @@ class TQueueImpl final : public TQueue {
       return false;
     }
     auto &q = queues_[queue_id];
-    if (q.events.size() >= MAX_QUEUE_EVENTS || q.total_event_length > MAX_TOTAL_EVENT_LENGTH - raw_event.data.size() ||
+    if (q.event_count >= MAX_QUEUE_EVENTS || q.total_event_length > MAX_TOTAL_EVENT_LENGTH - raw_event.data.size() ||
         raw_event.expires_at <= 0) {
       return false;
     }
@@ -112,17 +114,20 @@ class TQueueImpl final : public TQueue {
     }
 
     if (!q.events.empty()) {
-      auto it = q.events.end();
-      --it;
-      if (it->second.data.empty()) {
-        if (callback_ != nullptr && it->second.log_event_id != 0) {
-          callback_->pop(it->second.log_event_id);
+      auto &event = q.events.back();
+      if (event.data.empty()) {
+        if (callback_ != nullptr && event.log_event_id != 0) {
+          callback_->pop(event.log_event_id);
         }
-        q.events.erase(it);
+        remove_event(q, event);
+        normalize(q);
       }
     }
-    if (q.events.empty() && !raw_event.data.empty()) {
-      schedule_queue_gc(queue_id, q, raw_event.expires_at);
+    if (!raw_event.data.empty()) {
+      add_expiration(q, raw_event.expires_at, event_id);
+      if (q.gc_at == 0 || raw_event.expires_at < q.gc_at) {
+        schedule_queue_gc(queue_id, q, raw_event.expires_at);
+      }
     }
 
     if (raw_event.log_event_id == 0 && callback_ != nullptr) {
@@ -130,7 +135,8 @@ class TQueueImpl final : public TQueue {
     }
     q.tail_id = event_id.next().move_as_ok();
     q.total_event_length += raw_event.data.size();
-    q.events.emplace(event_id, std::move(raw_event));
+    q.event_count++;
+    q.events.push(std::move(raw_event));
     return true;
   }
 
@@ -146,7 +152,7 @@ class TQueueImpl final : public TQueue {
     }
 
     auto &q = queues_[queue_id];
-    if (q.events.size() >= MAX_QUEUE_EVENTS) {
+    if (q.event_count >= MAX_QUEUE_EVENTS) {
       return Status::Error("Queue is full");
     }
     if (q.total_event_length > MAX_TOTAL_EVENT_LENGTH - data.size()) {
@@ -171,9 +177,13 @@ class TQueueImpl final : public TQueue {
       if (event_id.next().is_ok()) {
         break;
       }
-      for (auto it = q.events.begin(); it != q.events.end();) {
-        pop(q, queue_id, it, {});
+      for (auto &event : q.events.as_mutable_span()) {
+        if (!is_removed(event)) {
+          pop(q, queue_id, event, {});
+        }
       }
+      normalize(q);
+      q.expirations.clear();
       q.tail_id = EventId();
       CHECK(hint_new_id.next().is_ok());
     }
@@ -211,11 +221,16 @@ class TQueueImpl final : public TQueue {
       return;
     }
     auto &q = q_it->second;
-    auto it = q.events.find(event_id);
-    if (it == q.events.end()) {
+    auto pos = get_event_position(q, event_id);
+    if (pos == q.events.size()) {
+      return;
+    }
+    auto &event = q.events.as_mutable_span()[pos];
+    if (event.event_id != event_id || is_removed(event)) {
       return;
     }
-    pop(q, queue_id, it, q.tail_id);
+    pop(q, queue_id, event, q.tail_id);
+    normalize(q);
   }
 
   std::map<EventId, RawEvent> clear(QueueId queue_id, size_t keep_count) final {
@@ -232,15 +247,18 @@ class TQueueImpl final : public TQueue {
     auto start_time = Time::now();
     auto total_event_length = q.total_event_length;
 
-    auto end_it = q.events.end();
+    auto events = q.events.as_mutable_span();
+    auto end_pos = events.size();
     for (size_t i = 0; i < keep_count; i++) {
-      --end_it;
+      do {
+        --end_pos;
+      } while (is_removed(events[end_pos]));
     }
     if (keep_count == 0) {
-      --end_it;
-      auto &event = end_it->second;
+      --end_pos;
+      auto &event = events[end_pos];
       if (callback_ == nullptr || event.log_event_id == 0) {
-        ++end_it;
+        ++end_pos;
       } else if (!event.data.empty()) {
         clear_event_data(q, event);
         callback_->push(queue_id, event);
@@ -251,8 +269,8 @@ class TQueueImpl final : public TQueue {
     if (callback_ != nullptr) {
       vector<uint64> deleted_log_event_ids;
       deleted_log_event_ids.reserve(size - keep_count);
-      for (auto it = q.events.begin(); it != end_it; ++it) {
-        auto &event = it->second;
+      for (size_t pos = 0; pos < end_pos; pos++) {
+        auto &event = events[pos];
         if (event.log_event_id != 0) {
           deleted_log_event_ids.push_back(event.log_event_id);
         }
@@ -263,23 +281,17 @@ class TQueueImpl final : public TQueue {
     auto callback_clear_time = Time::now() - start_time;
 
     std::map<EventId, RawEvent> deleted_events;
-    if (keep_count > size / 2) {
-      for (auto it = q.events.begin(); it != end_it;) {
-        q.total_event_length -= it->second.data.size();
-        bool is_inserted = deleted_events.emplace(it->first, std::move(it->second)).second;
-        CHECK(is_inserted);
-        it = q.events.erase(it);
-      }
-    } else {
-      q.total_event_length = 0;
-      for (auto it = end_it; it != q.events.end();) {
-        q.total_event_length += it->second.data.size();
-        bool is_inserted = deleted_events.emplace(it->first, std::move(it->second)).second;
-        CHECK(is_inserted);
-        it = q.events.erase(it);
+    for (size_t pos = 0; pos < end_pos; pos++) {
+      auto &event = events[pos];
+      if (is_removed(event)) {
+        continue;
       }
-      std::swap(deleted_events, q.events);
+      q.total_event_length -= event.data.size();
+      q.event_count--;
+      deleted_events.emplace_hint(deleted_events.end(), event.event_id, std::move(event));
     }
+    q.events.pop_n(end_pos);
+    normalize(q);
 
     auto clear_time = Time::now() - start_time;
     if (clear_time > 0.02) {
@@ -324,33 +336,30 @@ class TQueueImpl final : public TQueue {
       auto queue_id = it->second;
       auto &q = queues_[queue_id];
       CHECK(q.gc_at == it->first);
-      int32 new_gc_at = 0;
-
-      if (!q.events.empty()) {
-        size_t size_before = get_size(q);
-        for (auto event_it = q.events.begin(); event_it != q.events.end();) {
-          auto &event = event_it->second;
-          if ((++counter & 128) == 0 && Time::now() >= max_finish_time) {
-            if (new_gc_at == 0) {
-              new_gc_at = event.expires_at;
-            }
-            break;
-          }
-          if (event.expires_at < unix_time_now || event.data.empty()) {
-            pop(q, queue_id, event_it, q.tail_id);
-          } else {
-            if (new_gc_at != 0) {
-              break;
-            }
-            new_gc_at = event.expires_at;
-            ++event_it;
+
+      size_t size_before = get_size(q);
+      while (!q.expirations.empty() && q.expirations[0].expires_at < unix_time_now) {
+        if ((++counter & 128) == 0 && Time::now() >= max_finish_time) {
+          break;
+        }
+        auto event_id = q.expirations[0].event_id;
+        std::pop_heap(q.expirations.begin(), q.expirations.end(), compare_expirations);
+        q.expirations.pop_back();
+
+        auto pos = get_event_position(q, event_id);
+        if (pos < q.events.size()) {
+          auto &event = q.events.as_mutable_span()[pos];
+          if (event.event_id == event_id && !is_removed(event)) {
+            pop(q, queue_id, event, q.tail_id);
           }
         }
-        size_t size_after = get_size(q);
-        CHECK(size_after <= size_before);
-        deleted_events += size_before - size_after;
       }
-      schedule_queue_gc(queue_id, q, new_gc_at);
+      normalize(q);
+      size_t size_after = get_size(q);
+      CHECK(size_after <= size_before);
+      deleted_events += size_before - size_after;
+
+      schedule_queue_gc(queue_id, q, q.expirations.empty() ? 0 : q.expirations[0].expires_at);
       if (Time::now() >= max_finish_time) {
         return {deleted_events, false};
       }
@@ -366,6 +375,16 @@ class TQueueImpl final : public TQueue {
     return get_size(it->second);
   }
 
+  size_t get_memory_usage() const final {
+    size_t result = queues_.size() * sizeof(Queue);
+    for (auto &it : queues_) {
+      auto &q = it.second;
+      result += q.events.size() * sizeof(RawEvent) + q.total_event_length;
+      result += q.expirations.size() * sizeof(Expiration);
+    }
+    return result;
+  }
+
   void close(Promise<> promise) final {
     if (callback_ != nullptr) {
       callback_->close(std::move(promise));
@@ -374,9 +393,19 @@ class TQueueImpl final : public TQueue {
   }
 
  private:
+  struct Expiration {
+    int32 expires_at;
+    EventId event_id;
+  };
+
   struct Queue {
     EventId tail_id;
-    std::map<EventId, RawEvent> events;
+    // events sorted by event_id; removed events are left in place with zero expires_at until they are trimmed or
+    // compacted, so the first and the last stored events are never removed
+    VectorQueue<RawEvent> events;
+    // min-heap of expiration times of the events; entries of removed events are deleted lazily
+    vector<Expiration> expirations;
+    size_t event_count = 0;
     size_t total_event_length = 0;
     int32 gc_at = 0;
   };
@@ -389,7 +418,7 @@ class TQueueImpl final : public TQueue {
     if (q.events.empty()) {
       return q.tail_id;
     }
-    return q.events.begin()->first;
+    return q.events.front().event_id;
   }
 
   static size_t get_size(const Queue &q) {
@@ -397,13 +426,42 @@ class TQueueImpl final : public TQueue {
       return 0;
     }
 
-    return q.events.size() - (q.events.rbegin()->second.data.empty() ? 1 : 0);
+    return q.event_count - (q.events.back().data.empty() ? 1 : 0);
+  }
+
+  static bool is_removed(const RawEvent &event) {
+    return event.expires_at == 0;
+  }
+
+  // returns position of the first stored event with identifier not less than event_id
+  static size_t get_event_position(const Queue &q, EventId event_id) {
+    auto events = q.events.as_span();
+    if (events.empty() || !(events.front().event_id < event_id)) {
+      return 0;
+    }
+    // event identifiers are mostly sequential, so check the expected position first
+    auto expected_pos = static_cast<size_t>(event_id.value() - events.front().event_id.value());
+    if (expected_pos < events.size() && events[expected_pos].event_id == event_id) {
+      return expected_pos;
+    }
+    return static_cast<size_t>(
+        std::lower_bound(events.begin(), events.end(), event_id,
+                         [](const RawEvent &event, EventId event_id) { return event.event_id < event_id; }) -
+        events.begin());
+  }
+
+  static bool compare_expirations(const Expiration &lhs, const Expiration &rhs) {
+    return rhs.expires_at < lhs.expires_at;
   }
 
-  void pop(Queue &q, QueueId queue_id, std::map<EventId, RawEvent>::iterator &it, EventId tail_id) {
-    auto &event = it->second;
+  static void add_expiration(Queue &q, int32 expires_at, EventId event_id) {
+    q.expirations.push_back({expires_at, event_id});
+    std::push_heap(q.expirations.begin(), q.expirations.end(), compare_expirations);
+  }
+
+  void pop(Queue &q, QueueId queue_id, RawEvent &event, EventId tail_id) {
     if (callback_ == nullptr || event.log_event_id == 0) {
-      remove_event(q, it);
+      remove_event(q, event);
       return;
     }
 
@@ -412,16 +470,19 @@ class TQueueImpl final : public TQueue {
         clear_event_data(q, event);
         callback_->push(queue_id, event);
       }
-      ++it;
     } else {
       callback_->pop(event.log_event_id);
-      remove_event(q, it);
+      remove_event(q, event);
     }
   }
 
-  static void remove_event(Queue &q, std::map<EventId, RawEvent>::iterator &it) {
-    q.total_event_length -= it->second.data.size();
-    it = q.events.erase(it);
+  static void remove_event(Queue &q, RawEvent &event) {
+    CHECK(!is_removed(event));
+    clear_event_data(q, event);
+    event.log_event_id = 0;
+    event.expires_at = 0;
+    event.extra = 0;
+    q.event_count--;
   }
 
   static void clear_event_data(Queue &q, RawEvent &event) {
@@ -429,34 +490,84 @@ class TQueueImpl final : public TQueue {
     event.data = {};
   }
 
+  // drops removed events from both ends of the queue and compacts the queue and its expiration heap
+  // if there are too many removed events
+  static void normalize(Queue &q) {
+    auto events = q.events.as_span();
+    size_t front_count = 0;
+    while (front_count < events.size() && is_removed(events[front_count])) {
+      front_count++;
+    }
+    q.events.pop_n(front_count);
+    while (!q.events.empty() && is_removed(q.events.back())) {
+      q.events.pop_back();
+    }
+
+    if (q.events.size() > 2 * q.event_count + 16) {
+      auto span = q.events.as_mutable_span();
+      auto end = std::remove_if(span.begin(), span.end(), is_removed);
+      CHECK(static_cast<size_t>(end - span.begin()) == q.event_count);
+      while (q.events.size() > q.event_count) {
+        q.events.pop_back();
+      }
+    }
+
+    if (q.expirations.size() > 2 * q.event_count + 16) {
+      q.expirations.clear();
+      for (auto &event : q.events.as_span()) {
+        if (!is_removed(event) && !event.data.empty()) {
+          q.expirations.push_back({event.expires_at, event.event_id});
+        }
+      }
+      std::make_heap(q.expirations.begin(), q.expirations.end(), compare_expirations);
+    }
+  }
+
   void do_get(QueueId queue_id, Queue &q, EventId from_id, bool forget_previous, int32 unix_time_now,
               MutableSpan<Event> &result_events) {
+    auto events = q.events.as_mutable_span();
     if (forget_previous) {
-      for (auto it = q.events.begin(); it != q.events.end() && it->first < from_id;) {
-        pop(q, queue_id, it, q.tail_id);
+      for (size_t pos = 0; pos < events.size() && events[pos].event_id < from_id; pos++) {
+        if (!is_removed(events[pos])) {
+          pop(q, queue_id, events[pos], q.tail_id);
+        }
       }
     }
 
+    // remove expired events before returning any event, because normalization moves the events
     size_t ready_n = 0;
-    for (auto it = q.events.lower_bound(from_id); it != q.events.end();) {
-      auto &event = it->second;
+    for (size_t pos = get_event_position(q, from_id); pos < events.size(); pos++) {
+      auto &event = events[pos];
+      if (is_removed(event)) {
+        continue;
+      }
       if (event.expires_at < unix_time_now || event.data.empty()) {
-        pop(q, queue_id, it, q.tail_id);
+        pop(q, queue_id, event, q.tail_id);
       } else {
-        CHECK(!(event.event_id < from_id));
         if (ready_n == result_events.size()) {
           break;
         }
-
-        auto &to = result_events[ready_n];
-        to.data = event.data;
-        to.id = event.event_id;
-        to.expires_at = event.expires_at;
-        to.extra = event.extra;
         ready_n++;
-        ++it;
       }
     }
+    normalize(q);
+
+    events = q.events.as_mutable_span();
+    ready_n = 0;
+    for (size_t pos = get_event_position(q, from_id); pos < events.size() && ready_n < result_events.size(); pos++) {
+      auto &event = events[pos];
+      if (is_removed(event) || event.data.empty()) {
+        continue;
+      }
+      CHECK(!(event.event_id < from_id));
+
+      auto &to = result_events[ready_n];
+      to.data = event.data;
+      to.id = event.event_id;
+      to.expires_at = event.expires_at;
+      to.extra = event.extra;
+      ready_n++;
+    }
 
     result_events.truncate(ready_n);
   }
@@ -115,6 +115,9 @@ class TQueue {
 
   virtual size_t get_size(QueueId queue_id) const = 0;
 
+  // returns approximate size of memory used by all stored events
+  virtual size_t get_memory_usage() const = 0;
+
   // returns number of deleted events and whether garbage collection was completed
   virtual std::pair<int64, bool> run_gc(int32 unix_time_now) = 0;
   virtual void close(Promise<> promise) = 0;
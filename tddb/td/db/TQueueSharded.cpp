@@ -0,0 +1,328 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/db/TQueueSharded.h"
+
+#include "td/db/binlog/Binlog.h"
+#include "td/db/binlog/BinlogEvent.h"
+
+#include "td/utils/logging.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/Span.h"
+
+#include <atomic>
+#include <memory>
+
+namespace td {
+
+namespace {
+
+// collects results of a query, which was split between shards; different shards set results at disjoint positions
+template <class T>
+class TQueueShardedResults {
+ public:
+  TQueueShardedResults(size_t result_count, size_t shard_count, Promise<vector<Result<T>>> promise)
+      : results_(result_count), left_shard_count_(shard_count), promise_(std::move(promise)) {
+  }
+
+  void on_shard_results(const vector<size_t> &positions, Result<vector<Result<T>>> r_results) {
+    if (r_results.is_error()) {
+      for (auto pos : positions) {
+        results_[pos] = r_results.error().clone();
+      }
+    } else {
+      auto results = r_results.move_as_ok();
+      CHECK(results.size() == positions.size());
+      for (size_t i = 0; i < positions.size(); i++) {
+        results_[positions[i]] = std::move(results[i]);
+      }
+    }
+    if (left_shard_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      promise_.set_value(std::move(results_));
+    }
+  }
+
+ private:
+  vector<Result<T>> results_;
+  std::atomic<size_t> left_shard_count_;
+  Promise<vector<Result<T>>> promise_;
+};
+
+}  // namespace
+
+class TQueueSharded::Shard final : public Actor {
+ public:
+  Shard() : tqueue_(TQueue::create()) {
+  }
+
+  void open(string binlog_path, Promise<Unit> promise) {
+    auto tqueue = TQueue::create();
+    auto tqueue_binlog = make_unique<TQueueBinlog<Binlog>>();
+    auto binlog = std::make_shared<Binlog>();
+    TRY_STATUS_PROMISE(promise, binlog->init(binlog_path, [&](const BinlogEvent &event) {
+      auto status = tqueue_binlog->replay(event, *tqueue);
+      LOG_IF(ERROR, status.is_error()) << "Failed to replay TQueue event from " << binlog_path << ": " << status;
+    }));
+    tqueue_binlog->set_binlog(std::move(binlog));
+    tqueue->set_callback(std::move(tqueue_binlog));
+    tqueue_ = std::move(tqueue);
+    is_persistent_ = true;
+    promise.set_value(Unit());
+  }
+
+  void push(PushQuery query, Promise<EventId> promise) {
+    promise.set_result(do_push(std::move(query)));
+  }
+
+  void push_many(vector<PushQuery> queries, Promise<vector<Result<EventId>>> promise) {
+    vector<Result<EventId>> results;
+    results.reserve(queries.size());
+    for (auto &query : queries) {
+      results.push_back(do_push(std::move(query)));
+    }
+    promise.set_value(std::move(results));
+  }
+
+  void forget(QueueId queue_id, EventId event_id, Promise<Unit> promise) {
+    tqueue_->forget(queue_id, event_id);
+    promise.set_value(Unit());
+  }
+
+  void clear(QueueId queue_id, size_t keep_count, Promise<std::map<EventId, RawEvent>> promise) {
+    promise.set_value(tqueue_->clear(queue_id, keep_count));
+  }
+
+  void get(GetQuery query, int32 unix_time_now, Promise<GetResult> promise) {
+    promise.set_result(do_get(query, unix_time_now));
+  }
+
+  void get_many(vector<GetQuery> queries, int32 unix_time_now, Promise<vector<Result<GetResult>>> promise) {
+    vector<Result<GetResult>> results;
+    results.reserve(queries.size());
+    for (auto &query : queries) {
+      results.push_back(do_get(query, unix_time_now));
+    }
+    promise.set_value(std::move(results));
+  }
+
+  void get_size(QueueId queue_id, Promise<size_t> promise) {
+    promise.set_value(tqueue_->get_size(queue_id));
+  }
+
+  void run_gc(int32 unix_time_now, Promise<std::pair<int64, bool>> promise) {
+    promise.set_value(tqueue_->run_gc(unix_time_now));
+  }
+
+  void get_memory_usage(Promise<size_t> promise) {
+    promise.set_value(tqueue_->get_memory_usage());
+  }
+
+  void close(Promise<Unit> promise) {
+    if (!is_persistent_) {
+      return promise.set_value(Unit());
+    }
+    is_persistent_ = false;
+    tqueue_->close(std::move(promise));
+  }
+
+ private:
+  unique_ptr<TQueue> tqueue_;
+  bool is_persistent_ = false;
+  vector<TQueue::Event> events_;
+
+  Result<EventId> do_push(PushQuery &&query) {
+    return tqueue_->push(query.queue_id, std::move(query.data), query.expires_at, query.extra, query.hint_new_id);
+  }
+
+  Result<GetResult> do_get(const GetQuery &query, int32 unix_time_now) {
+    events_.resize(query.limit);
+    MutableSpan<TQueue::Event> events(events_);
+    TRY_RESULT(queue_size, tqueue_->get(query.queue_id, query.from_id, query.forget_previous, unix_time_now, events));
+
+    GetResult result;
+    result.queue_size = queue_size;
+    result.events.reserve(events.size());
+    for (auto &event : events) {
+      RawEvent raw_event;
+      raw_event.event_id = event.id;
+      raw_event.expires_at = event.expires_at;
+      raw_event.data = event.data.str();
+      raw_event.extra = event.extra;
+      result.events.push_back(std::move(raw_event));
+    }
+    return std::move(result);
+  }
+};
+
+TQueueSharded::TQueueSharded(vector<int32> scheduler_ids) {
+  CHECK(!scheduler_ids.empty());
+  for (size_t i = 0; i < scheduler_ids.size(); i++) {
+    shards_.push_back(create_actor_on_scheduler<Shard>(PSLICE() << "TQueueShard" << i, scheduler_ids[i]));
+  }
+}
+
+TQueueSharded::~TQueueSharded() = default;
+
+size_t TQueueSharded::get_shard_id(QueueId queue_id) const {
+  return static_cast<size_t>(static_cast<uint64>(queue_id) % shards_.size());
+}
+
+template <class QueryT, class T, class F>
+void TQueueSharded::run_batch(vector<QueryT> queries, Promise<vector<Result<T>>> promise, F &&send_queries) {
+  vector<vector<QueryT>> shard_queries(shards_.size());
+  vector<vector<size_t>> shard_positions(shards_.size());
+  for (size_t i = 0; i < queries.size(); i++) {
+    auto shard_id = get_shard_id(queries[i].queue_id);
+    shard_queries[shard_id].push_back(std::move(queries[i]));
+    shard_positions[shard_id].push_back(i);
+  }
+
+  size_t shard_count = 0;
+  for (auto &positions : shard_positions) {
+    if (!positions.empty()) {
+      shard_count++;
+    }
+  }
+  if (shard_count == 0) {
+    return promise.set_value(vector<Result<T>>());
+  }
+
+  auto results = std::make_shared<TQueueShardedResults<T>>(queries.size(), shard_count, std::move(promise));
+  for (size_t shard_id = 0; shard_id < shards_.size(); shard_id++) {
+    if (shard_positions[shard_id].empty()) {
+      continue;
+    }
+    send_queries(shards_[shard_id].get(), std::move(shard_queries[shard_id]),
+                 PromiseCreator::lambda([results, positions = std::move(shard_positions[shard_id])](
+                                            Result<vector<Result<T>>> r_results) mutable {
+                   results->on_shard_results(positions, std::move(r_results));
+                 }));
+  }
+}
+
+template <class T, class F>
+void TQueueSharded::run_on_all_shards(Promise<vector<T>> promise, F &&send_query) {
+  auto results = std::make_shared<TQueueShardedResults<T>>(
+      shards_.size(), shards_.size(),
+      PromiseCreator::lambda([promise = std::move(promise)](Result<vector<Result<T>>> r_results) mutable {
+        TRY_RESULT_PROMISE(promise, results, std::move(r_results));
+        vector<T> values;
+        values.reserve(results.size());
+        for (auto &result : results) {
+          if (result.is_error()) {
+            return promise.set_error(result.move_as_error());
+          }
+          values.push_back(result.move_as_ok());
+        }
+        promise.set_value(std::move(values));
+      }));
+  for (size_t shard_id = 0; shard_id < shards_.size(); shard_id++) {
+    send_query(shards_[shard_id].get(), shard_id,
+               PromiseCreator::lambda([results, shard_id](Result<T> r_result) {
+                 vector<Result<T>> shard_results;
+                 shard_results.push_back(std::move(r_result));
+                 results->on_shard_results({shard_id}, std::move(shard_results));
+               }));
+  }
+}
+
+void TQueueSharded::open(string binlog_path, Promise<Unit> promise) {
+  run_on_all_shards<Unit>(PromiseCreator::lambda([promise = std::move(promise)](Result<vector<Unit>> result) mutable {
+                            if (result.is_error()) {
+                              return promise.set_error(result.move_as_error());
+                            }
+                            promise.set_value(Unit());
+                          }),
+                          [&binlog_path](ActorId<Shard> shard, size_t shard_id, Promise<Unit> shard_promise) {
+                            send_closure(shard, &Shard::open, PSTRING() << binlog_path << '.' << shard_id,
+                                         std::move(shard_promise));
+                          });
+}
+
+void TQueueSharded::push(PushQuery query, Promise<EventId> promise) {
+  auto shard_id = get_shard_id(query.queue_id);
+  send_closure(shards_[shard_id], &Shard::push, std::move(query), std::move(promise));
+}
+
+void TQueueSharded::push_many(vector<PushQuery> queries, Promise<vector<Result<EventId>>> promise) {
+  run_batch(std::move(queries), std::move(promise),
+            [](ActorId<Shard> shard, vector<PushQuery> shard_queries,
+               Promise<vector<Result<EventId>>> shard_promise) {
+              send_closure(shard, &Shard::push_many, std::move(shard_queries), std::move(shard_promise));
+            });
+}
+
+void TQueueSharded::forget(QueueId queue_id, EventId event_id, Promise<Unit> promise) {
+  send_closure(shards_[get_shard_id(queue_id)], &Shard::forget, queue_id, event_id, std::move(promise));
+}
+
+void TQueueSharded::clear(QueueId queue_id, size_t keep_count, Promise<std::map<EventId, RawEvent>> promise) {
+  send_closure(shards_[get_shard_id(queue_id)], &Shard::clear, queue_id, keep_count, std::move(promise));
+}
+
+void TQueueSharded::get(GetQuery query, int32 unix_time_now, Promise<GetResult> promise) {
+  auto shard_id = get_shard_id(query.queue_id);
+  send_closure(shards_[shard_id], &Shard::get, std::move(query), unix_time_now, std::move(promise));
+}
+
+void TQueueSharded::get_many(vector<GetQuery> queries, int32 unix_time_now,
+                             Promise<vector<Result<GetResult>>> promise) {
+  run_batch(std::move(queries), std::move(promise),
+            [unix_time_now](ActorId<Shard> shard, vector<GetQuery> shard_queries,
+                            Promise<vector<Result<GetResult>>> shard_promise) {
+              send_closure(shard, &Shard::get_many, std::move(shard_queries), unix_time_now, std::move(shard_promise));
+            });
+}
+
+void TQueueSharded::get_size(QueueId queue_id, Promise<size_t> promise) {
+  send_closure(shards_[get_shard_id(queue_id)], &Shard::get_size, queue_id, std::move(promise));
+}
+
+void TQueueSharded::run_gc(int32 unix_time_now, Promise<std::pair<int64, bool>> promise) {
+  run_on_all_shards<std::pair<int64, bool>>(
+      PromiseCreator::lambda(
+          [promise = std::move(promise)](Result<vector<std::pair<int64, bool>>> r_shard_results) mutable {
+            TRY_RESULT_PROMISE(promise, shard_results, std::move(r_shard_results));
+            std::pair<int64, bool> result{0, true};
+            for (auto &shard_result : shard_results) {
+              result.first += shard_result.first;
+              result.second &= shard_result.second;
+            }
+            promise.set_value(std::move(result));
+          }),
+      [unix_time_now](ActorId<Shard> shard, size_t, Promise<std::pair<int64, bool>> shard_promise) {
+        send_closure(shard, &Shard::run_gc, unix_time_now, std::move(shard_promise));
+      });
+}
+
+void TQueueSharded::get_memory_usage(Promise<size_t> promise) {
+  run_on_all_shards<size_t>(
+      PromiseCreator::lambda([promise = std::move(promise)](Result<vector<size_t>> r_shard_results) mutable {
+        TRY_RESULT_PROMISE(promise, shard_results, std::move(r_shard_results));
+        size_t result = 0;
+        for (auto shard_result : shard_results) {
+          result += shard_result;
+        }
+        promise.set_value(std::move(result));
+      }),
+      [](ActorId<Shard> shard, size_t, Promise<size_t> shard_promise) {
+        send_closure(shard, &Shard::get_memory_usage, std::move(shard_promise));
+      });
+}
+
+void TQueueSharded::close(Promise<Unit> promise) {
+  run_on_all_shards<Unit>(PromiseCreator::lambda([promise = std::move(promise)](Result<vector<Unit>> result) mutable {
+                            if (result.is_error()) {
+                              return promise.set_error(result.move_as_error());
+                            }
+                            promise.set_value(Unit());
+                          }),
+                          [](ActorId<Shard> shard, size_t, Promise<Unit> shard_promise) {
+                            send_closure(shard, &Shard::close, std::move(shard_promise));
+                          });
+}
+
+}  // namespace td
@@ -0,0 +1,102 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/db/TQueue.h"
+
+#include "td/actor/actor.h"
+
+#include "td/utils/common.h"
+#include "td/utils/Promise.h"
+#include "td/utils/Status.h"
+
+#include <map>
+#include <utility>
+
+namespace td {
+
+// TQueue front-end, which partitions queues by their identifier between shards running on different schedulers;
+// each shard has its own TQueue and binlog, so queries to queues from different shards are processed in parallel;
+// promises are completed on the scheduler of the corresponding shard
+class TQueueSharded {
+ public:
+  using QueueId = TQueue::QueueId;
+  using EventId = TQueue::EventId;
+  using RawEvent = TQueue::RawEvent;
+
+  struct PushQuery {
+    QueueId queue_id = 0;
+    string data;
+    int32 expires_at = 0;
+    int64 extra = 0;
+    EventId hint_new_id;
+  };
+
+  struct GetQuery {
+    QueueId queue_id = 0;
+    EventId from_id;
+    bool forget_previous = false;
+    size_t limit = 0;
+  };
+
+  struct GetResult {
+    vector<RawEvent> events;
+    size_t queue_size = 0;
+  };
+
+  // the i-th shard runs on the scheduler scheduler_ids[i]
+  explicit TQueueSharded(vector<int32> scheduler_ids);
+  TQueueSharded(const TQueueSharded &) = delete;
+  TQueueSharded &operator=(const TQueueSharded &) = delete;
+  TQueueSharded(TQueueSharded &&) = delete;
+  TQueueSharded &operator=(TQueueSharded &&) = delete;
+  ~TQueueSharded();
+
+  size_t get_shard_count() const {
+    return shards_.size();
+  }
+
+  // replays events of the i-th shard from the binlog at path binlog_path + "." + i and persists them there;
+  // must be called before any other query, otherwise the events are kept only in memory
+  void open(string binlog_path, Promise<Unit> promise);
+
+  void push(PushQuery query, Promise<EventId> promise);
+
+  void push_many(vector<PushQuery> queries, Promise<vector<Result<EventId>>> promise);
+
+  void forget(QueueId queue_id, EventId event_id, Promise<Unit> promise);
+
+  void clear(QueueId queue_id, size_t keep_count, Promise<std::map<EventId, RawEvent>> promise);
+
+  void get(GetQuery query, int32 unix_time_now, Promise<GetResult> promise);
+
+  void get_many(vector<GetQuery> queries, int32 unix_time_now, Promise<vector<Result<GetResult>>> promise);
+
+  void get_size(QueueId queue_id, Promise<size_t> promise);
+
+  // returns total number of deleted events and whether garbage collection was completed in all shards
+  void run_gc(int32 unix_time_now, Promise<std::pair<int64, bool>> promise);
+
+  void get_memory_usage(Promise<size_t> promise);
+
+  void close(Promise<Unit> promise);
+
+ private:
+  class Shard;
+
+  vector<ActorOwn<Shard>> shards_;
+
+  size_t get_shard_id(QueueId queue_id) const;
+
+  template <class QueryT, class T, class F>
+  void run_batch(vector<QueryT> queries, Promise<vector<Result<T>>> promise, F &&send_queries);
+
+  template <class T, class F>
+  void run_on_all_shards(Promise<vector<T>> promise, F &&send_query);
+};
+
+}  // namespace td
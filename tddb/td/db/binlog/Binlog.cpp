@@ -114,10 +114,14 @@ class BinlogReader {
       if (input_->size() < 4) {
         return 4;
       }
-      auto it = input_->clone();
-
       char buf[4];
-      it.advance(4, MutableSlice(buf, 4));
+      auto ready = input_->prepare_read();
+      if (ready.size() >= 4) {
+        MutableSlice(buf, 4).copy_from(ready.substr(0, 4));
+      } else {
+        auto it = input_->clone();
+        it.advance(4, MutableSlice(buf, 4));
+      }
       size_ = static_cast<size_t>(TlParser(Slice(buf, 4)).fetch_int());
 
       if (size_ > BinlogEvent::MAX_SIZE) {
@@ -139,8 +143,9 @@ class BinlogReader {
     }
 
     event->debug_info_ = BinlogDebugInfo{__FILE__, __LINE__};
-    auto buffer_slice = input_->cut_head(size_).move_as_buffer_slice();
-    event->init(buffer_slice.as_slice().str());
+    string raw_event(size_, '\0');
+    input_->advance(size_, raw_event);
+    event->init(std::move(raw_event));
     TRY_STATUS(event->validate());
     offset_ += size_;
     event->offset_ = offset_;
@@ -285,6 +290,18 @@ Status Binlog::close(bool need_sync) {
   if (fd_.empty()) {
     return Status::OK();
   }
+  if (need_sync && state_ == State::Run) {
+    // the binlog is compacted more aggressively on close, so less events are replayed when it is opened next time
+    auto fd_size = fd_size_;
+    if (events_buffer_) {
+      fd_size += events_buffer_->size();
+    }
+    if (fd_size > 50000 && fd_size / 2 > processor_->total_raw_events_size()) {
+      LOG(INFO) << "Reindex binlog on close: " << tag("fd_size", format::as_size(fd_size))
+                << tag("total events size", format::as_size(processor_->total_raw_events_size()));
+      do_reindex();
+    }
+  }
   if (need_sync) {
     sync("close");
   } else {
@@ -544,7 +561,7 @@ Status Binlog::load_binlog(const Callback &callback, const Callback &debug_callb
         return Status::OK();
       }
     } else {
-      TRY_STATUS(fd_.flush_read(max(need_size, static_cast<size_t>(4096))));
+      TRY_STATUS(fd_.flush_read(max(need_size, static_cast<size_t>(1 << 16))));
       buffer_reader_.sync_with_writer();
       if (byte_flow_flag_) {
         byte_flow_source_.wakeup();
@@ -660,6 +677,12 @@ void Binlog::do_reindex() {
   reset_encryption();
   processor_->for_each([&](BinlogEvent &event) {
     do_event(std::move(event));  // NB: no move is actually happens
+
+    // write the new binlog by parts to avoid keeping its whole copy in memory
+    buffer_reader_.sync_with_writer();
+    if (buffer_reader_.size() > (1 << 20)) {
+      flush("do_reindex");
+    }
   });
   {
     flush("do_reindex");
@@ -6,7 +6,9 @@
 //
 #include "td/db/binlog/BinlogEvent.h"
 
+#include "td/utils/config.h"
 #include "td/utils/crypto.h"
+#include "td/utils/Gzip.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/tl_parsers.h"
@@ -14,6 +16,10 @@
 
 namespace td {
 
+static Slice get_stored_data(Slice raw_event) {
+  return Slice(raw_event.data() + BinlogEvent::HEADER_SIZE, raw_event.size() - BinlogEvent::MIN_SIZE);
+}
+
 void BinlogEvent::init(string raw_event) {
   TlParser parser(as_slice(raw_event));
   size_ = static_cast<uint32>(parser.fetch_int());
@@ -26,11 +32,27 @@ void BinlogEvent::init(string raw_event) {
   parser.template fetch_string_raw<Slice>(size_ - MIN_SIZE);  // skip data
   crc32_ = static_cast<uint32>(parser.fetch_int());
   raw_event_ = std::move(raw_event);
+
+  uncompressed_data_.clear();
+#if TD_HAVE_ZLIB
+  if ((flags_ & Flags::Compressed) != 0) {
+    // errors are returned by validate()
+    TlParser data_parser(get_stored_data(raw_event_));
+    auto compressed_data = data_parser.template fetch_string<Slice>();
+    data_parser.fetch_end();
+    if (data_parser.get_error() == nullptr) {
+      uncompressed_data_ = gzdecode(compressed_data).as_slice().str();
+    }
+  }
+#endif
 }
 
 Slice BinlogEvent::get_data() const {
   CHECK(raw_event_.size() >= MIN_SIZE);
-  return Slice(as_slice(raw_event_).data() + HEADER_SIZE, raw_event_.size() - MIN_SIZE);
+  if ((flags_ & Flags::Compressed) != 0) {
+    return uncompressed_data_;
+  }
+  return get_stored_data(raw_event_);
 }
 
 Status BinlogEvent::validate() const {
@@ -50,11 +72,32 @@ Status BinlogEvent::validate() const {
     return Status::Error(PSLICE() << "CRC mismatch " << tag("actual", format::as_hex(calculated_crc))
                                   << tag("expected", format::as_hex(crc32_)) << public_to_string());
   }
+  if ((flags_ & Flags::Compressed) != 0 && uncompressed_data_.empty()) {
+    return Status::Error(PSLICE() << "Failed to decompress " << public_to_string());
+  }
   return Status::OK();
 }
 
 BufferSlice BinlogEvent::create_raw(uint64 id, int32 type, int32 flags, const Storer &storer) {
-  auto raw_event = BufferSlice{storer.size() + MIN_SIZE};
+  flags &= ~Flags::Compressed;
+  auto data_size = storer.size();
+  BufferSlice compressed_data;
+#if TD_HAVE_ZLIB
+  // service events are parsed by the binlog itself and are never big
+  if (type >= 0 && data_size >= MIN_COMPRESSED_DATA_SIZE) {
+    BufferSlice data{data_size};
+    auto real_size = storer.store(data.as_mutable_slice().ubegin());
+    CHECK(real_size == data_size);
+    compressed_data = gzencode(data.as_slice(), 0.8);
+    if (!compressed_data.empty()) {
+      TlStorerCalcLength calc_length;
+      calc_length.store_string(compressed_data.as_slice());
+      data_size = calc_length.get_length();
+      flags |= Flags::Compressed;
+    }
+  }
+#endif
+  auto raw_event = BufferSlice{data_size + MIN_SIZE};
 
   TlStorerUnsafe tl_storer(raw_event.as_mutable_slice().ubegin());
   tl_storer.store_int(narrow_cast<int32>(raw_event.size()));
@@ -64,7 +107,11 @@ BufferSlice BinlogEvent::create_raw(uint64 id, int32 type, int32 flags, const St
   tl_storer.store_long(0);
 
   CHECK(tl_storer.get_buf() == raw_event.as_slice().ubegin() + HEADER_SIZE);
-  tl_storer.store_storer(storer);
+  if (compressed_data.empty()) {
+    tl_storer.store_storer(storer);
+  } else {
+    tl_storer.store_string(compressed_data.as_slice());
+  }
 
   CHECK(tl_storer.get_buf() == raw_event.as_slice().uend() - TAIL_SIZE);
   tl_storer.store_int(crc32(raw_event.as_slice().truncate(raw_event.size() - TAIL_SIZE)));
@@ -52,6 +52,7 @@ struct BinlogEvent {
   static constexpr size_t HEADER_SIZE = 4 + 8 + 4 + 4 + 8;
   static constexpr size_t TAIL_SIZE = 4;
   static constexpr size_t MIN_SIZE = HEADER_SIZE + TAIL_SIZE;
+  static constexpr size_t MIN_COMPRESSED_DATA_SIZE = 1 << 10;
 
   int64 offset_ = -1;
 
@@ -63,11 +64,13 @@ struct BinlogEvent {
   uint32 crc32_ = 0;
 
   string raw_event_;
+  string uncompressed_data_;  // data of a compressed event
 
   BinlogDebugInfo debug_info_;
 
   enum ServiceTypes { Header = -1, Empty = -2, AesCtrEncryption = -3, NoEncryption = -4 };
-  enum Flags { Rewrite = 1, Partial = 2 };
+  // events with the flag Compressed store their data gzipped as a TL string; the flag is chosen by create_raw
+  enum Flags { Rewrite = 1, Partial = 2, Compressed = 4 };
 
   Slice get_data() const;
 
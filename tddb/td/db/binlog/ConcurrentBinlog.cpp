@@ -6,6 +6,7 @@
 //
 #include "td/db/binlog/ConcurrentBinlog.h"
 
+#include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/OrderedEventsProcessor.h"
@@ -22,7 +23,7 @@ class BinlogActor final : public Actor {
   }
   void close(Promise<> promise) {
     binlog_->close().ensure();
-    LOG(INFO) << "Finished to close binlog";
+    LOG(INFO) << "Finished to close binlog with " << sync_stats_;
     stop();
 
     promise.set_value(Unit());  // setting promise can complete closing and destroy the current actor context
@@ -82,6 +83,14 @@ class BinlogActor final : public Actor {
     promise.set_value(Unit());
   }
 
+  void set_sync_delay(double sync_delay) {
+    sync_delay_ = sync_delay;
+  }
+
+  void get_sync_stats(Promise<BinlogSyncStats> promise) {
+    promise.set_value(BinlogSyncStats(sync_stats_));
+  }
+
  private:
   unique_ptr<Binlog> binlog_;
 
@@ -93,8 +102,12 @@ class BinlogActor final : public Actor {
   bool lazy_sync_flag_ = false;
   bool flush_flag_ = false;
   double wakeup_at_ = 0;
+  double sync_delay_ = DEFAULT_SYNC_DELAY;
+  double force_sync_request_time_ = 0;
+  BinlogSyncStats sync_stats_;
 
-  static constexpr double FLUSH_TIMEOUT = 0.001;  // 1ms
+  static constexpr double FLUSH_TIMEOUT = 0.001;        // 1ms
+  static constexpr double DEFAULT_SYNC_DELAY = 0.003;  // 3ms
 
   void wakeup_after(double after) {
     auto now = Time::now_cached();
@@ -139,7 +152,8 @@ class BinlogActor final : public Actor {
     }
     if (!force_sync_flag_) {
       force_sync_flag_ = true;
-      wakeup_after(0.003);
+      force_sync_request_time_ = Time::now();
+      wakeup_after(sync_delay_);
     }
   }
 
@@ -155,6 +169,7 @@ class BinlogActor final : public Actor {
   }
 
   void timeout_expired() final {
+    bool is_force_sync = force_sync_flag_;
     bool need_sync = lazy_sync_flag_ || force_sync_flag_;
     lazy_sync_flag_ = false;
     force_sync_flag_ = false;
@@ -162,8 +177,19 @@ class BinlogActor final : public Actor {
     flush_flag_ = false;
     wakeup_at_ = 0;
     if (need_sync) {
+      auto sync_start_time = Time::now();
       binlog_->sync("timeout_expired");
       // LOG(ERROR) << "BINLOG SYNC";
+      auto sync_time = Time::now() - sync_start_time;
+      auto batch_size = static_cast<int64>(sync_promises_.size());
+      sync_stats_.sync_count++;
+      sync_stats_.synced_promise_count += batch_size;
+      sync_stats_.max_batch_size = max(sync_stats_.max_batch_size, batch_size);
+      sync_stats_.total_sync_time += sync_time;
+      sync_stats_.max_sync_time = max(sync_stats_.max_sync_time, sync_time);
+      if (is_force_sync) {
+        sync_stats_.max_wait_time = max(sync_stats_.max_wait_time, sync_start_time - force_sync_request_time_);
+      }
       set_promises(sync_promises_);
     } else if (need_flush) {
       try_flush();
@@ -173,6 +199,15 @@ class BinlogActor final : public Actor {
 };
 }  // namespace detail
 
+StringBuilder &operator<<(StringBuilder &string_builder, const BinlogSyncStats &stats) {
+  return string_builder << "BinlogSyncStats[" << tag("sync_count", stats.sync_count)
+                        << tag("synced_promise_count", stats.synced_promise_count)
+                        << tag("max_batch_size", stats.max_batch_size)
+                        << tag("total_sync_time", format::as_time(stats.total_sync_time))
+                        << tag("max_sync_time", format::as_time(stats.max_sync_time))
+                        << tag("max_wait_time", format::as_time(stats.max_wait_time)) << ']';
+}
+
 ConcurrentBinlog::ConcurrentBinlog() = default;
 ConcurrentBinlog::~ConcurrentBinlog() = default;
 ConcurrentBinlog::ConcurrentBinlog(unique_ptr<Binlog> binlog, int scheduler_id) {
@@ -218,6 +253,14 @@ void ConcurrentBinlog::change_key(DbKey db_key, Promise<> promise) {
   send_closure(binlog_actor_, &detail::BinlogActor::change_key, std::move(db_key), std::move(promise));
 }
 
+void ConcurrentBinlog::set_sync_delay(double sync_delay) {
+  send_closure(binlog_actor_, &detail::BinlogActor::set_sync_delay, sync_delay);
+}
+
+void ConcurrentBinlog::get_sync_stats(Promise<BinlogSyncStats> promise) {
+  send_closure(binlog_actor_, &detail::BinlogActor::get_sync_stats, std::move(promise));
+}
+
 uint64 ConcurrentBinlog::erase_batch(vector<uint64> event_ids) {
   auto shift = narrow_cast<int32>(event_ids.size());
   if (shift == 0) {
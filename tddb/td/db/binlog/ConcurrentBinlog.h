@@ -17,6 +17,7 @@
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
+#include "td/utils/StringBuilder.h"
 
 #include <atomic>
 #include <functional>
@@ -27,6 +28,17 @@ namespace detail {
 class BinlogActor;
 }  // namespace detail
 
+struct BinlogSyncStats {
+  int64 sync_count = 0;
+  int64 synced_promise_count = 0;
+  int64 max_batch_size = 0;
+  double total_sync_time = 0.0;
+  double max_sync_time = 0.0;
+  double max_wait_time = 0.0;  // maximum time between a force_sync request and the start of the sync
+};
+
+StringBuilder &operator<<(StringBuilder &string_builder, const BinlogSyncStats &stats);
+
 class ConcurrentBinlog final : public BinlogInterface {
  public:
   using Callback = std::function<void(const BinlogEvent &)>;
@@ -45,6 +57,11 @@ class ConcurrentBinlog final : public BinlogInterface {
   void force_flush() final;
   void change_key(DbKey db_key, Promise<> promise) final;
 
+  // sets maximum time, for which force_sync requests can be delayed to be completed by a single sync
+  void set_sync_delay(double sync_delay);
+
+  void get_sync_stats(Promise<BinlogSyncStats> promise);
+
   uint64 next_event_id() final {
     return last_event_id_.fetch_add(1, std::memory_order_relaxed);
   }
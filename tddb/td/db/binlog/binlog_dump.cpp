@@ -8,16 +8,23 @@
 
 #include "td/db/DbKey.h"
 
+#include "td/utils/algorithm.h"
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/format.h"
+#include "td/utils/JsonBuilder.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
+#include "td/utils/OptionParser.h"
 #include "td/utils/port/Stat.h"
+#include "td/utils/port/StdStreams.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/StringBuilder.h"
+#include "td/utils/Time.h"
 #include "td/utils/tl_parsers.h"
 
+#include <algorithm>
 #include <map>
 
 struct Trie {
@@ -95,62 +102,208 @@ struct Trie {
 
 enum Magic { ConfigPmcMagic = 0x1f18, BinlogPmcMagic = 0x4327 };
 
+static td::Slice get_type_name(td::int32 type) {
+  switch (type) {
+    case td::BinlogEvent::ServiceTypes::Header:
+      return td::Slice("Header");
+    case td::BinlogEvent::ServiceTypes::Empty:
+      return td::Slice("Empty");
+    case td::BinlogEvent::ServiceTypes::AesCtrEncryption:
+      return td::Slice("AesCtrEncryption");
+    case td::BinlogEvent::ServiceTypes::NoEncryption:
+      return td::Slice("NoEncryption");
+    case ConfigPmcMagic:
+      return td::Slice("ConfigPmc");
+    case BinlogPmcMagic:
+      return td::Slice("BinlogPmc");
+    default:
+      // other types are values of LogEvent::HandlerType
+      return td::Slice();
+  }
+}
+
+static double get_ratio(std::size_t part, std::size_t total) {
+  return total == 0 ? 0.0 : static_cast<double>(part) / static_cast<double>(total);
+}
+
 int main(int argc, char *argv[]) {
-  if (argc < 2) {
-    LOG(PLAIN) << "Usage: binlog_dump <binlog_file_name>";
+  bool print_events = true;
+  bool print_json = false;
+  td::OptionParser options;
+  options.set_usage(td::Slice(argv[0]), "[options] <binlog_file_name>");
+  options.set_description("Dump events and statistics of a TDLib binlog");
+  options.add_option('s', "stats", "print only statistics without events", [&] { print_events = false; });
+  options.add_option('j', "json", "print only statistics in JSON format", [&] {
+    print_events = false;
+    print_json = true;
+  });
+  auto r_non_options = options.run(argc, argv, 1);
+  if (r_non_options.is_error()) {
+    LOG(PLAIN) << argv[0] << ": " << r_non_options.error().message();
+    LOG(PLAIN) << options;
     return 1;
   }
-  td::string binlog_file_name = argv[1];
+  td::string binlog_file_name = r_non_options.ok()[0];
   auto r_stat = td::stat(binlog_file_name);
   if (r_stat.is_error() || r_stat.ok().size_ == 0 || !r_stat.ok().is_reg_) {
     LOG(PLAIN) << "Wrong binlog file name specified";
-    LOG(PLAIN) << "Usage: binlog_dump <binlog_file_name>";
+    LOG(PLAIN) << options;
     return 1;
   }
+  auto file_size = static_cast<std::size_t>(r_stat.ok().size_);
 
   struct Info {
+    std::size_t full_count = 0;
     std::size_t full_size = 0;
-    std::size_t compressed_size = 0;
+    std::size_t live_count = 0;
+    std::size_t live_size = 0;
+    std::size_t rewrite_count = 0;
+    std::size_t compressed_count = 0;
+    std::size_t data_size = 0;
     Trie trie;
-    Trie compressed_trie;
+    Trie live_trie;
   };
-  std::map<td::uint64, Info> info;
+  // full_* describe all events in the file, live_* describe events left after replay
+  std::map<td::int32, Info> info;
+  Info total;
+  td::FlatHashMap<td::uint64, td::int32> chain_lengths;
+  std::size_t erased_count = 0;
 
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  auto start_time = td::Time::now();
   td::Binlog binlog;
   binlog
       .init(
           binlog_file_name,
           [&](auto &event) {
-            info[0].compressed_size += event.raw_event_.size();
-            info[event.type_].compressed_size += event.raw_event_.size();
+            for (auto *type_info : {&total, &info[event.type_]}) {
+              type_info->live_count++;
+              type_info->live_size += event.raw_event_.size();
+            }
             if (event.type_ == ConfigPmcMagic || event.type_ == BinlogPmcMagic) {
               auto key = td::TlParser(event.get_data()).template fetch_string<td::Slice>();
-              info[event.type_].compressed_trie.add(key);
+              info[event.type_].live_trie.add(key);
             }
           },
           td::DbKey::raw_key("cucumber"), td::DbKey::empty(), -1,
           [&](auto &event) mutable {
-            info[0].full_size += event.raw_event_.size();
-            info[event.type_].full_size += event.raw_event_.size();
+            for (auto *type_info : {&total, &info[event.type_]}) {
+              type_info->full_count++;
+              type_info->full_size += event.raw_event_.size();
+              type_info->data_size += event.get_data().size();
+              if ((event.flags_ & td::BinlogEvent::Flags::Rewrite) != 0) {
+                type_info->rewrite_count++;
+              }
+              if ((event.flags_ & td::BinlogEvent::Flags::Compressed) != 0) {
+                type_info->compressed_count++;
+              }
+            }
+            if (event.type_ >= 0 || event.type_ == td::BinlogEvent::ServiceTypes::Empty) {
+              chain_lengths[event.id_]++;
+              if (event.type_ == td::BinlogEvent::ServiceTypes::Empty) {
+                erased_count++;
+              }
+            }
             if (event.type_ == ConfigPmcMagic || event.type_ == BinlogPmcMagic) {
               auto key = td::TlParser(event.get_data()).template fetch_string<td::Slice>();
               info[event.type_].trie.add(key);
             }
-            LOG(PLAIN) << "LogEvent[" << td::tag("event_id", td::format::as_hex(event.id_))
-                       << td::tag("type", event.type_) << td::tag("flags", event.flags_)
-                       << td::tag("size", event.get_data().size())
-                       << td::tag("data", td::format::escaped(event.get_data())) << "]\n";
+            if (print_events) {
+              LOG(PLAIN) << "LogEvent[" << td::tag("event_id", td::format::as_hex(event.id_))
+                         << td::tag("type", event.type_) << td::tag("flags", event.flags_)
+                         << td::tag("size", event.get_data().size())
+                         << td::tag("data", td::format::escaped(event.get_data())) << "]\n";
+            }
           })
       .ensure();
+  auto load_time = td::Time::now() - start_time;
+
+  td::int32 max_chain_length = 0;
+  std::size_t rewritten_count = 0;
+  std::size_t chain_length_sum = 0;
+  for (auto &it : chain_lengths) {
+    max_chain_length = td::max(max_chain_length, it.second);
+    chain_length_sum += static_cast<std::size_t>(it.second);
+    if (it.second > 1) {
+      rewritten_count++;
+    }
+  }
+  auto average_chain_length = get_ratio(chain_length_sum, chain_lengths.size());
+  // reindex keeps only the events left after replay
+  auto compaction_savings = file_size - td::min(file_size, total.live_size);
+
+  auto types = td::transform(info, [](const auto &it) { return it.first; });
+  std::stable_sort(types.begin(), types.end(),
+                   [&](td::int32 lhs, td::int32 rhs) { return info[lhs].full_size > info[rhs].full_size; });
+
+  if (print_json) {
+    auto to_json = [](std::size_t value) {
+      return static_cast<td::int64>(value);
+    };
+    auto result = td::json_encode<td::string>(
+        td::json_object([&](auto &o) {
+          o("file_size", to_json(file_size));
+          o("load_time", load_time);
+          o("event_count", to_json(total.full_count));
+          o("event_size", to_json(total.full_size));
+          o("live_event_count", to_json(total.live_count));
+          o("live_event_size", to_json(total.live_size));
+          o("dead_ratio", 1.0 - get_ratio(total.live_size, total.full_size));
+          o("compaction_savings", to_json(compaction_savings));
+          o("event_id_count", to_json(chain_lengths.size()));
+          o("rewritten_event_id_count", to_json(rewritten_count));
+          o("erased_event_id_count", to_json(erased_count));
+          o("max_chain_length", max_chain_length);
+          o("average_chain_length", average_chain_length);
+          o("handlers", td::json_array(types, [&](td::int32 type) {
+              const auto &type_info = info[type];
+              return td::json_object([&, type](auto &h) {
+                h("type", type);
+                h("name", get_type_name(type));
+                h("event_count", to_json(type_info.full_count));
+                h("event_size", to_json(type_info.full_size));
+                h("live_event_count", to_json(type_info.live_count));
+                h("live_event_size", to_json(type_info.live_size));
+                h("dead_ratio", 1.0 - get_ratio(type_info.live_size, type_info.full_size));
+                h("rewrite_count", to_json(type_info.rewrite_count));
+                h("compressed_event_count", to_json(type_info.compressed_count));
+                h("data_size", to_json(type_info.data_size));
+              });
+            }));
+        }),
+        true);
+    td::Stdout().write(result).ignore();
+    return 0;
+  }
 
-  for (auto &it : info) {
-    LOG(PLAIN) << td::tag("handler", td::format::as_hex(it.first))
-               << td::tag("full_size", td::format::as_size(it.second.full_size))
-               << td::tag("compressed_size", td::format::as_size(it.second.compressed_size));
-    it.second.trie.dump();
-    if (it.second.full_size != it.second.compressed_size) {
-      it.second.compressed_trie.dump();
+  auto safe_load_time = td::max(load_time, 1e-9);
+  auto load_speed = static_cast<td::uint64>(static_cast<double>(file_size) / safe_load_time);
+  auto events_per_second = static_cast<td::uint64>(static_cast<double>(total.full_count) / safe_load_time);
+  LOG(PLAIN) << td::tag("file_size", td::format::as_size(file_size)) << td::tag("load_time", load_time)
+             << td::tag("load_speed", PSLICE() << td::format::as_size(load_speed) << "/s")
+             << td::tag("events_per_second", events_per_second);
+  LOG(PLAIN) << td::tag("events", total.full_count) << td::tag("size", td::format::as_size(total.full_size))
+             << td::tag("live_events", total.live_count)
+             << td::tag("live_size", td::format::as_size(total.live_size))
+             << td::tag("dead", PSLICE() << td::StringBuilder::FixedDouble(
+                                               100.0 - get_ratio(total.live_size, total.full_size) * 100.0, 2)
+                                         << '%')
+             << td::tag("compaction_savings", td::format::as_size(compaction_savings));
+  LOG(PLAIN) << td::tag("event_ids", chain_lengths.size()) << td::tag("rewritten", rewritten_count)
+             << td::tag("erased", erased_count) << td::tag("max_chain_length", max_chain_length)
+             << td::tag("average_chain_length", td::StringBuilder::FixedDouble(average_chain_length, 2));
+  for (auto type : types) {
+    auto &type_info = info[type];
+    LOG(PLAIN) << td::tag("handler", td::format::as_hex(type)) << td::tag("name", get_type_name(type))
+               << td::tag("events", type_info.full_count)
+               << td::tag("full_size", td::format::as_size(type_info.full_size))
+               << td::tag("live_events", type_info.live_count)
+               << td::tag("live_size", td::format::as_size(type_info.live_size))
+               << td::tag("rewrites", type_info.rewrite_count) << td::tag("compressed", type_info.compressed_count)
+               << td::tag("data_size", td::format::as_size(type_info.data_size));
+    type_info.trie.dump();
+    if (type_info.full_size != type_info.live_size) {
+      type_info.live_trie.dump();
     }
   }
 
@@ -129,6 +129,9 @@ class NativeDnsResolver final : public Actor {
 
 int VERBOSITY_NAME(dns_resolver) = VERBOSITY_NAME(DEBUG);
 
+std::mutex GetHostByNameActor::shared_cache_mutex_;
+FlatHashMap<string, GetHostByNameActor::SharedValue> GetHostByNameActor::shared_cache_;
+
 GetHostByNameActor::GetHostByNameActor(Options options) : options_(std::move(options)) {
   CHECK(!options_.resolver_types.empty());
 }
@@ -148,6 +151,15 @@ void GetHostByNameActor::run(string host, int port, bool prefer_ipv6, Promise<IP
   if (value.expires_at > begin_time) {
     return promise.set_result(value.get_ip_port(port));
   }
+  if (active_queries_[prefer_ipv6].count(ascii_host) == 0) {
+    std::lock_guard<std::mutex> lock(shared_cache_mutex_);
+    auto it = shared_cache_.find(get_shared_cache_key(ascii_host, prefer_ipv6));
+    if (it != shared_cache_.end() && it->second.expires_at > begin_time) {
+      VLOG(dns_resolver) << "Use shared result for host = " << host << ": " << it->second.ip;
+      value = Value{it->second.ip, it->second.expires_at};
+      return promise.set_result(value.get_ip_port(port));
+    }
+  }
 
   auto &query_ptr = active_queries_[prefer_ipv6][ascii_host];
   if (query_ptr == nullptr) {
@@ -163,6 +175,17 @@ void GetHostByNameActor::run(string host, int port, bool prefer_ipv6, Promise<IP
   }
 }
 
+string GetHostByNameActor::get_shared_cache_key(const string &host, bool prefer_ipv6) const {
+  // results of different resolvers must not be mixed, because some of them can be blocked
+  string key;
+  for (auto resolver_type : options_.resolver_types) {
+    key += static_cast<char>('0' + static_cast<int32>(resolver_type));
+  }
+  key += prefer_ipv6 ? " 6 " : " 4 ";
+  key += host;
+  return key;
+}
+
 void GetHostByNameActor::run_query(std::string host, bool prefer_ipv6, Query &query) {
   auto promise = PromiseCreator::lambda([actor_id = actor_id(this), host, prefer_ipv6](Result<IPAddress> res) mutable {
     send_closure(actor_id, &GetHostByNameActor::on_query_result, std::move(host), prefer_ipv6, std::move(res));
@@ -206,6 +229,12 @@ void GetHostByNameActor::on_query_result(std::string host, bool prefer_ipv6, Res
   auto value_it = cache_[prefer_ipv6].find(host);
   CHECK(value_it != cache_[prefer_ipv6].end());
   auto cache_timeout = result.is_ok() ? options_.ok_timeout : options_.error_timeout;
+  if (result.is_ok()) {
+    std::lock_guard<std::mutex> lock(shared_cache_mutex_);
+    auto &shared_value = shared_cache_[get_shared_cache_key(host, prefer_ipv6)];
+    shared_value.ip = result.ok();
+    shared_value.expires_at = end_time + cache_timeout;
+  }
   value_it->second = Value{std::move(result), end_time + cache_timeout};
   active_queries_[prefer_ipv6].erase(query_it);
 
@@ -15,6 +15,7 @@
 #include "td/utils/Promise.h"
 #include "td/utils/Status.h"
 
+#include <mutex>
 #include <utility>
 
 namespace td {
@@ -59,6 +60,16 @@ class GetHostByNameActor final : public Actor {
   };
   FlatHashMap<string, Value> cache_[2];
 
+  // successfully resolved addresses are shared between all actors with the same resolvers in the process
+  struct SharedValue {
+    IPAddress ip;
+    double expires_at = 0.0;
+  };
+  static std::mutex shared_cache_mutex_;
+  static FlatHashMap<string, SharedValue> shared_cache_;
+
+  string get_shared_cache_key(const string &host, bool prefer_ipv6) const;
+
   struct Query {
     ActorOwn<> query;
     size_t pos = 0;
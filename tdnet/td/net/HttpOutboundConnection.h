@@ -36,6 +36,12 @@ class HttpOutboundConnection final : public detail::HttpConnectionBase {
   // void write_ok();
   // void write_error(Status error);
 
+  // passes a kept alive connection to a new owner
+  void set_callback(ActorShared<Callback> callback) {
+    callback_.release();
+    callback_ = std::move(callback);
+  }
+
  private:
   void on_query(unique_ptr<HttpQuery> query) final;
   void on_error(Status error) final;
@@ -568,29 +568,48 @@ void HttpReader::process_header(MutableSlice header_name, MutableSlice header_va
   to_lower_inplace(header_name);
   LOG(DEBUG) << "Process header [" << header_name << "=>" << header_value << "]";
   query_->headers_.emplace_back(header_name, header_value);
-  if (header_name == "content-length") {
-    auto content_length = to_integer<uint64>(header_value);
-    if (content_length > MAX_CONTENT_SIZE) {
-      content_length = MAX_CONTENT_SIZE;
-    }
-    content_length_ = static_cast<int64>(content_length);
-  } else if (header_name == "connection") {
-    to_lower_inplace(header_value);
-    if (header_value == "close") {
-      query_->keep_alive_ = false;
-    } else {
-      query_->keep_alive_ = true;
-    }
-  } else if (header_name == "content-type") {
-    content_type_ = header_value;
-    content_type_lowercased_ = header_value.str();
-    to_lower_inplace(content_type_lowercased_);
-  } else if (header_name == "content-encoding") {
-    to_lower_inplace(header_value);
-    content_encoding_ = header_value;
-  } else if (header_name == "transfer-encoding") {
-    to_lower_inplace(header_value);
-    transfer_encoding_ = header_value;
+  // all interesting headers have different length, so the length is enough to find the only possible candidate
+  switch (header_name.size()) {
+    case 14:
+      if (header_name == "content-length") {
+        auto content_length = to_integer<uint64>(header_value);
+        if (content_length > MAX_CONTENT_SIZE) {
+          content_length = MAX_CONTENT_SIZE;
+        }
+        content_length_ = static_cast<int64>(content_length);
+      }
+      break;
+    case 10:
+      if (header_name == "connection") {
+        to_lower_inplace(header_value);
+        if (header_value == "close") {
+          query_->keep_alive_ = false;
+        } else {
+          query_->keep_alive_ = true;
+        }
+      }
+      break;
+    case 12:
+      if (header_name == "content-type") {
+        content_type_ = header_value;
+        content_type_lowercased_ = header_value.str();
+        to_lower_inplace(content_type_lowercased_);
+      }
+      break;
+    case 16:
+      if (header_name == "content-encoding") {
+        to_lower_inplace(header_value);
+        content_encoding_ = header_value;
+      }
+      break;
+    case 17:
+      if (header_name == "transfer-encoding") {
+        to_lower_inplace(header_value);
+        transfer_encoding_ = header_value;
+      }
+      break;
+    default:
+      break;
   }
 }
 
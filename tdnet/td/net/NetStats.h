@@ -106,31 +106,33 @@ class NetStats {
     }
 
    private:
+    // the counters are changed only by the owning scheduler, but are read from other threads
     struct LocalNetStats {
       double last_update = 0;
       uint64 unsync_size = 0;
       std::atomic<uint64> read_size{0};
       std::atomic<uint64> write_size{0};
+      char pad[TD_CONCURRENCY_PAD - sizeof(double) - sizeof(uint64) - sizeof(std::atomic<uint64>) * 2];
     };
     SchedulerLocalStorage<LocalNetStats> local_net_stats_;
     unique_ptr<Callback> callback_;
 
     void on_read(uint64 size) final {
       auto &stats = local_net_stats_.get();
-      stats.read_size.fetch_add(size, std::memory_order_relaxed);
+      stats.read_size.store(stats.read_size.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
 
       on_change(stats, size);
     }
     void on_write(uint64 size) final {
       auto &stats = local_net_stats_.get();
-      stats.write_size.fetch_add(size, std::memory_order_relaxed);
+      stats.write_size.store(stats.write_size.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
 
       on_change(stats, size);
     }
 
     void on_change(LocalNetStats &stats, uint64 size) {
       stats.unsync_size += size;
-      auto now = Time::now();
+      auto now = Time::now_cached();
       if (stats.unsync_size > 10000 || now - stats.last_update > 300) {
         stats.unsync_size = 0;
         stats.last_update = now;
@@ -23,9 +23,12 @@
 #include <openssl/x509.h>
 #include <openssl/x509_vfy.h>
 
+#include <algorithm>
 #include <cstring>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 #if TD_PORT_WINDOWS
 #include <wincrypt.h>
@@ -153,6 +156,57 @@ X509_STORE *load_system_certificate_store() {
 
 using SslCtxPtr = std::shared_ptr<SSL_CTX>;
 
+// TLS sessions are saved for each SSL context separately, because their certificates aren't checked after resumption
+struct SslSessionCache {
+  struct Session {
+    SSL_SESSION *ssl_session_ = nullptr;
+    uint64 last_used_ = 0;
+  };
+  std::mutex mutex_;
+  std::map<std::pair<const SSL_CTX *, string>, Session> sessions_;
+  size_t capacity_ = 256;
+  uint64 generation_ = 0;
+};
+
+SslSessionCache &get_ssl_session_cache() {
+  // never destroyed to not free the sessions after OpenSSL deinitialization
+  static auto *cache = new SslSessionCache();
+  return *cache;
+}
+
+void evict_ssl_sessions(SslSessionCache &cache) {
+  if (cache.sessions_.size() <= cache.capacity_) {
+    return;
+  }
+  vector<std::pair<uint64, std::pair<const SSL_CTX *, string>>> sessions;
+  sessions.reserve(cache.sessions_.size());
+  for (auto &it : cache.sessions_) {
+    sessions.emplace_back(it.second.last_used_, it.first);
+  }
+  std::sort(sessions.begin(), sessions.end());
+  for (size_t i = 0; i + cache.capacity_ < sessions.size(); i++) {
+    auto it = cache.sessions_.find(sessions[i].second);
+    CHECK(it != cache.sessions_.end());
+    SSL_SESSION_free(it->second.ssl_session_);
+    cache.sessions_.erase(it);
+  }
+}
+
+void forget_ssl_sessions(const SSL_CTX *ssl_ctx) {
+  auto &cache = get_ssl_session_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex_);
+  auto it = cache.sessions_.lower_bound(std::make_pair(ssl_ctx, string()));
+  while (it != cache.sessions_.end() && it->first.first == ssl_ctx) {
+    SSL_SESSION_free(it->second.ssl_session_);
+    it = cache.sessions_.erase(it);
+  }
+}
+
+void free_ssl_ctx(SSL_CTX *ssl_ctx) {
+  forget_ssl_sessions(ssl_ctx);
+  SSL_CTX_free(ssl_ctx);
+}
+
 Result<SslCtxPtr> do_create_ssl_ctx(CSlice cert_file, SslCtx::VerifyPeer verify_peer) {
   auto ssl_method =
 #if OPENSSL_VERSION_NUMBER >= 0x10100000L
@@ -167,7 +221,7 @@ Result<SslCtxPtr> do_create_ssl_ctx(CSlice cert_file, SslCtx::VerifyPeer verify_
   if (!ssl_ctx) {
     return create_openssl_error(-7, "Failed to create an SSL context");
   }
-  auto ssl_ctx_ptr = SslCtxPtr(ssl_ctx, SSL_CTX_free);
+  auto ssl_ctx_ptr = SslCtxPtr(ssl_ctx, free_ssl_ctx);
   long options = 0;
 #ifdef SSL_OP_NO_SSLv2
   options |= SSL_OP_NO_SSLv2;
@@ -180,6 +234,7 @@ Result<SslCtxPtr> do_create_ssl_ctx(CSlice cert_file, SslCtx::VerifyPeer verify_
   SSL_CTX_set_min_proto_version(ssl_ctx, TLS1_VERSION);
 #endif
   SSL_CTX_set_mode(ssl_ctx, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_ENABLE_PARTIAL_WRITE);
+  SSL_CTX_set_session_cache_mode(ssl_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
 
   if (cert_file.empty()) {
     auto *store = load_system_certificate_store();
@@ -269,6 +324,47 @@ class SslCtxImpl {
     return static_cast<void *>(ssl_ctx_ptr_.get());
   }
 
+  SSL_SESSION *get_ssl_session(Slice session_key) const {
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    auto &cache = get_ssl_session_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+    auto it = cache.sessions_.find(std::make_pair(static_cast<const SSL_CTX *>(ssl_ctx_ptr_.get()), session_key.str()));
+    if (it == cache.sessions_.end()) {
+      return nullptr;
+    }
+    auto *ssl_session = it->second.ssl_session_;
+    if (SSL_SESSION_get_protocol_version(ssl_session) >= TLS1_3_VERSION) {
+      // TLS 1.3 session tickets must be used only once
+      cache.sessions_.erase(it);
+    } else {
+      it->second.last_used_ = ++cache.generation_;
+      SSL_SESSION_up_ref(ssl_session);
+    }
+    return ssl_session;
+#else
+    return nullptr;
+#endif
+  }
+
+  void save_ssl_session(Slice session_key, SSL_SESSION *ssl_session) const {
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    if (SSL_SESSION_is_resumable(ssl_session)) {
+      auto &cache = get_ssl_session_cache();
+      std::lock_guard<std::mutex> lock(cache.mutex_);
+      if (cache.capacity_ > 0) {
+        auto &session =
+            cache.sessions_[std::make_pair(static_cast<const SSL_CTX *>(ssl_ctx_ptr_.get()), session_key.str())];
+        std::swap(session.ssl_session_, ssl_session);
+        session.last_used_ = ++cache.generation_;
+        evict_ssl_sessions(cache);
+      }
+    }
+#endif
+    if (ssl_session != nullptr) {
+      SSL_SESSION_free(ssl_session);
+    }
+  }
+
  private:
   SslCtxPtr ssl_ctx_ptr_;
 };
@@ -321,6 +417,22 @@ void *SslCtx::get_openssl_ctx() const {
   return impl_ == nullptr ? nullptr : impl_->get_openssl_ctx();
 }
 
+void *SslCtx::get_ssl_session(Slice session_key) const {
+  return impl_ == nullptr ? nullptr : static_cast<void *>(impl_->get_ssl_session(session_key));
+}
+
+void SslCtx::save_ssl_session(Slice session_key, void *ssl_session) const {
+  CHECK(impl_ != nullptr);
+  impl_->save_ssl_session(session_key, static_cast<SSL_SESSION *>(ssl_session));
+}
+
+void SslCtx::set_ssl_session_cache_capacity(size_t capacity) {
+  auto &cache = detail::get_ssl_session_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex_);
+  cache.capacity_ = capacity;
+  detail::evict_ssl_sessions(cache);
+}
+
 SslCtx::SslCtx(unique_ptr<detail::SslCtxImpl> impl) : impl_(std::move(impl)) {
 }
 
@@ -362,6 +474,17 @@ void *SslCtx::get_openssl_ctx() const {
   return nullptr;
 }
 
+void *SslCtx::get_ssl_session(Slice session_key) const {
+  return nullptr;
+}
+
+void SslCtx::save_ssl_session(Slice session_key, void *ssl_session) const {
+  UNREACHABLE();
+}
+
+void SslCtx::set_ssl_session_cache_capacity(size_t capacity) {
+}
+
 SslCtx::SslCtx(unique_ptr<detail::SslCtxImpl> impl) : impl_(std::move(impl)) {
 }
 
@@ -32,6 +32,15 @@ class SslCtx {
 
   void *get_openssl_ctx() const;
 
+  // returns a saved TLS session, which can be resumed, or nullptr; the returned session must be freed by the caller
+  void *get_ssl_session(Slice session_key) const;
+
+  // saves a TLS session for future resumption; takes ownership of the session
+  void save_ssl_session(Slice session_key, void *ssl_session) const;
+
+  // sets maximum number of saved TLS sessions in the process; 0 disables session resumption
+  static void set_ssl_session_cache_capacity(size_t capacity);
+
   explicit operator bool() const noexcept {
     return static_cast<bool>(impl_);
   }
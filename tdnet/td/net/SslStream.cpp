@@ -12,6 +12,7 @@
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/port/IPAddress.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 #include "td/utils/Time.h"
 
@@ -136,6 +137,21 @@ using SslHandle = std::unique_ptr<SSL, SslHandleDeleter>;
 
 class SslStreamImpl {
  public:
+  SslStreamImpl() = default;
+  SslStreamImpl(const SslStreamImpl &) = delete;
+  SslStreamImpl &operator=(const SslStreamImpl &) = delete;
+  SslStreamImpl(SslStreamImpl &&) = delete;
+  SslStreamImpl &operator=(SslStreamImpl &&) = delete;
+  ~SslStreamImpl() {
+    if (ssl_handle_ != nullptr && SSL_is_init_finished(ssl_handle_.get())) {
+      // save the session to resume it in the next connection to the same host
+      auto *ssl_session = SSL_get1_session(ssl_handle_.get());
+      if (ssl_session != nullptr) {
+        ssl_ctx_.save_ssl_session(session_key_, ssl_session);
+      }
+    }
+  }
+
   Status init(CSlice host, SslCtx ssl_ctx, bool check_ip_address_as_host) {
     if (!ssl_ctx) {
       return Status::Error("Invalid SSL context provided");
@@ -177,7 +193,16 @@ class SslStreamImpl {
 #endif
     SSL_set_connect_state(ssl_handle.get());
 
+    session_key_ = PSTRING() << host << ' ' << check_ip_address_as_host;
+    auto *ssl_session = static_cast<SSL_SESSION *>(ssl_ctx.get_ssl_session(session_key_));
+    if (ssl_session != nullptr) {
+      LOG(DEBUG) << "Try to resume TLS session with " << host;
+      SSL_set_session(ssl_handle.get(), ssl_session);
+      SSL_SESSION_free(ssl_session);
+    }
+
     ssl_handle_ = std::move(ssl_handle);
+    ssl_ctx_ = std::move(ssl_ctx);
 
     return Status::OK();
   }
@@ -197,6 +222,8 @@ class SslStreamImpl {
 
  private:
   SslHandle ssl_handle_;
+  SslCtx ssl_ctx_;
+  string session_key_;
 
   friend class SslReadByteFlow;
   friend class SslWriteByteFlow;
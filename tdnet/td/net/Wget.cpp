@@ -19,11 +19,15 @@
 #include "td/utils/port/SocketFd.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
 
 #include <limits>
 
 namespace td {
 
+std::mutex Wget::idle_connections_mutex_;
+FlatHashMap<string, vector<Wget::IdleConnection>> Wget::idle_connections_;
+
 Wget::Wget(Promise<unique_ptr<HttpQuery>> promise, string url, std::vector<std::pair<string, string>> headers,
            int32 timeout_in, int32 ttl, bool prefer_ipv6, SslCtx::VerifyPeer verify_peer, string content,
            string content_type)
@@ -72,6 +76,20 @@ Status Wget::try_init() {
   }
   TRY_RESULT(header, hc.finish(content_));
 
+  connection_key_ = PSTRING() << (url.protocol_ == HttpUrl::Protocol::Http ? "http" : "https") << "://" << url.host_
+                              << ':' << url.port_ << ' ' << prefer_ipv6_ << ' '
+                              << (verify_peer_ == SslCtx::VerifyPeer::On);
+  connection_generation_++;
+  connection_ = get_idle_connection(connection_key_);
+  is_reused_connection_ = !connection_.empty();
+  if (is_reused_connection_) {
+    LOG(DEBUG) << "Reuse connection to " << connection_key_;
+    send_closure(connection_, &HttpOutboundConnection::set_callback, actor_shared(this, connection_generation_));
+    send_closure(connection_, &HttpOutboundConnection::write_next, BufferSlice(header));
+    send_closure(connection_, &HttpOutboundConnection::write_ok);
+    return Status::OK();
+  }
+
   IPAddress addr;
   TRY_STATUS(addr.init_host_port(url.host_, url.port_, prefer_ipv6_));
 
@@ -82,13 +100,13 @@ Status Wget::try_init() {
   if (url.protocol_ == HttpUrl::Protocol::Http) {
     connection_ = create_actor<HttpOutboundConnection>("Connect", BufferedFd<SocketFd>(std::move(fd)), SslStream{},
                                                        std::numeric_limits<std::size_t>::max(), 0, 0,
-                                                       ActorOwn<HttpOutboundConnection::Callback>(actor_id(this)));
+                                                       actor_shared(this, connection_generation_));
   } else {
     TRY_RESULT(ssl_ctx, SslCtx::create(CSlice() /* certificate */, verify_peer_));
     TRY_RESULT(ssl_stream, SslStream::create(url.host_, std::move(ssl_ctx)));
     connection_ = create_actor<HttpOutboundConnection>(
         "Connect", BufferedFd<SocketFd>(std::move(fd)), std::move(ssl_stream), std::numeric_limits<std::size_t>::max(),
-        0, 0, ActorOwn<HttpOutboundConnection::Callback>(actor_id(this)));
+        0, 0, actor_shared(this, connection_generation_));
   }
 
   send_closure(connection_, &HttpOutboundConnection::write_next, BufferSlice(header));
@@ -110,12 +128,29 @@ void Wget::handle(unique_ptr<HttpQuery> result) {
 }
 
 void Wget::on_connection_error(Status error) {
+  if (retry_reused_connection()) {
+    return;
+  }
   on_error(std::move(error));
 }
 
+bool Wget::retry_reused_connection() {
+  // the server could have closed the kept alive connection before receiving the query
+  if (!is_reused_connection_ || !content_.empty()) {
+    return false;
+  }
+  LOG(INFO) << "Reused connection to " << connection_key_ << " was closed";
+  connection_.reset();
+  loop();
+  return true;
+}
+
 void Wget::on_ok(unique_ptr<HttpQuery> http_query_ptr) {
   CHECK(promise_);
   CHECK(http_query_ptr);
+  if (http_query_ptr->keep_alive_ && !connection_.empty()) {
+    add_idle_connection(connection_key_, std::move(connection_));
+  }
   if ((http_query_ptr->code_ == 301 || http_query_ptr->code_ == 302 || http_query_ptr->code_ == 307 ||
        http_query_ptr->code_ == 308) &&
       ttl_ > 0) {
@@ -149,10 +184,65 @@ void Wget::timeout_expired() {
   on_error(Status::Error("Response timeout expired"));
 }
 
+void Wget::hangup_shared() {
+  if (get_link_token() != connection_generation_ || !promise_) {
+    // an old connection was closed
+    return;
+  }
+  if (retry_reused_connection()) {
+    return;
+  }
+  on_error(Status::Error("Connection closed"));
+}
+
 void Wget::tear_down() {
   if (promise_) {
     on_error(Status::Error("Canceled"));
   }
 }
 
+ActorOwn<HttpOutboundConnection> Wget::get_idle_connection(const string &connection_key) {
+  vector<ActorOwn<HttpOutboundConnection>> expired_connections;
+  ActorOwn<HttpOutboundConnection> result;
+  {
+    std::lock_guard<std::mutex> lock(idle_connections_mutex_);
+    auto it = idle_connections_.find(connection_key);
+    if (it == idle_connections_.end()) {
+      return result;
+    }
+    auto now = Time::now();
+    auto &connections = it->second;
+    while (!connections.empty()) {
+      auto idle_connection = std::move(connections.back());
+      connections.pop_back();
+      ActorOwn<HttpOutboundConnection> connection(idle_connection.connection_);
+      if (idle_connection.expires_at_ > now) {
+        result = std::move(connection);
+        break;
+      }
+      expired_connections.push_back(std::move(connection));
+    }
+    if (connections.empty()) {
+      idle_connections_.erase(it);
+    }
+  }
+  return result;
+}
+
+void Wget::add_idle_connection(const string &connection_key, ActorOwn<HttpOutboundConnection> connection) {
+  ActorOwn<HttpOutboundConnection> old_connection;
+  {
+    std::lock_guard<std::mutex> lock(idle_connections_mutex_);
+    auto &connections = idle_connections_[connection_key];
+    if (connections.size() >= MAX_IDLE_CONNECTIONS_PER_HOST) {
+      old_connection = ActorOwn<HttpOutboundConnection>(connections[0].connection_);
+      connections.erase(connections.begin());
+    }
+    IdleConnection idle_connection;
+    idle_connection.connection_ = connection.release();
+    idle_connection.expires_at_ = Time::now() + IDLE_CONNECTION_TIMEOUT;
+    connections.push_back(std::move(idle_connection));
+  }
+}
+
 }  // namespace td
@@ -13,9 +13,11 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Status.h"
 
+#include <mutex>
 #include <utility>
 
 namespace td {
@@ -27,19 +29,40 @@ class Wget final : public HttpOutboundConnection::Callback {
                 SslCtx::VerifyPeer verify_peer = SslCtx::VerifyPeer::On, string content = {}, string content_type = {});
 
  private:
+  static constexpr size_t MAX_IDLE_CONNECTIONS_PER_HOST = 4;
+  static constexpr double IDLE_CONNECTION_TIMEOUT = 15.0;
+
+  struct IdleConnection {
+    ActorId<HttpOutboundConnection> connection_;
+    double expires_at_ = 0.0;
+  };
+
+  // kept alive connections, which can be reused by the next queries to the same server
+  static std::mutex idle_connections_mutex_;
+  static FlatHashMap<string, vector<IdleConnection>> idle_connections_;
+
+  static ActorOwn<HttpOutboundConnection> get_idle_connection(const string &connection_key);
+
+  static void add_idle_connection(const string &connection_key, ActorOwn<HttpOutboundConnection> connection);
+
   Status try_init();
   void loop() final;
   void handle(unique_ptr<HttpQuery> result) final;
   void on_connection_error(Status error) final;
   void on_ok(unique_ptr<HttpQuery> http_query_ptr);
   void on_error(Status error);
+  bool retry_reused_connection();
 
   void tear_down() final;
   void start_up() final;
   void timeout_expired() final;
+  void hangup_shared() final;
 
   Promise<unique_ptr<HttpQuery>> promise_;
   ActorOwn<HttpOutboundConnection> connection_;
+  string connection_key_;
+  uint64 connection_generation_ = 0;
+  bool is_reused_connection_ = false;
   string input_url_;
   std::vector<std::pair<string, string>> headers_;
   int32 timeout_in_;
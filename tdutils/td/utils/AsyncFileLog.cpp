@@ -80,6 +80,16 @@ Status AsyncFileLog::init(string path, int64 rotate_threshold, bool redirect_std
           }
         };
 
+        // all log lines received at once are written to the file together
+        constexpr size_t MAX_BUFFER_SIZE = 1 << 16;
+        string buffer;
+        auto flush_buffer = [&] {
+          if (!buffer.empty()) {
+            append(buffer);
+            buffer.clear();
+          }
+        };
+
         while (true) {
           int ready_count = queue->reader_wait_nonblock();
           if (ready_count == 0) {
@@ -91,18 +101,28 @@ Status AsyncFileLog::init(string path, int64 rotate_threshold, bool redirect_std
             Query query = queue->reader_get_unsafe();
             switch (query.type_) {
               case Query::Type::Log:
-                append(query.data_);
+                if (buffer.empty() && query.data_.size() >= MAX_BUFFER_SIZE) {
+                  append(query.data_);
+                  break;
+                }
+                buffer += query.data_;
+                if (buffer.size() >= MAX_BUFFER_SIZE) {
+                  flush_buffer();
+                }
                 break;
               case Query::Type::AfterRotation:
+                flush_buffer();
                 after_rotation();
                 break;
               case Query::Type::Close:
+                flush_buffer();
                 need_close = true;
                 break;
               default:
                 process_fatal_error("Invalid query type in AsyncFileLog");
             }
           }
+          flush_buffer();
           queue->reader_flush();
 
           if (need_close) {
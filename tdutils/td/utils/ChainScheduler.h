@@ -35,6 +35,15 @@ class ChainScheduler final : public ChainSchedulerBase {
   using TaskId = uint64;
   using ChainId = uint64;
 
+  static constexpr uint32 DEFAULT_MAX_ACTIVE_TASKS_PER_CHAIN = 10;
+
+  ChainScheduler() = default;
+
+  // at most max_active_tasks_per_chain tasks from each chain can be active simultaneously
+  explicit ChainScheduler(uint32 max_active_tasks_per_chain)
+      : max_active_tasks_per_chain_(td::max(max_active_tasks_per_chain, static_cast<uint32>(1))) {
+  }
+
   TaskId create_task(Span<ChainId> chains, ExtraT extra = {});
 
   ExtraT *get_task_extra(TaskId task_id);
@@ -140,6 +149,7 @@ class ChainScheduler final : public ChainSchedulerBase {
     vector<TaskChainInfo> chains;
     ExtraT extra;
   };
+  uint32 max_active_tasks_per_chain_ = DEFAULT_MAX_ACTIVE_TASKS_PER_CHAIN;
   FlatHashMap<ChainId, unique_ptr<ChainInfo>> chains_;
   FlatHashMap<ChainId, TaskId> limited_tasks_;
   Container<Task> tasks_;
@@ -168,7 +178,7 @@ class ChainScheduler final : public ChainSchedulerBase {
         }
       }
 
-      if (task_chain_info.chain_info->active_tasks >= 10) {
+      if (task_chain_info.chain_info->active_tasks >= max_active_tasks_per_chain_) {
         limited_tasks_[task_chain_info.chain_id] = task_id;
         return;
       }
@@ -261,6 +271,9 @@ class ChainScheduler final : public ChainSchedulerBase {
   friend StringBuilder &operator<<(StringBuilder &sb, ChainScheduler<ExtraTT> &scheduler);
 };
 
+template <class ExtraT>
+constexpr uint32 ChainScheduler<ExtraT>::DEFAULT_MAX_ACTIVE_TASKS_PER_CHAIN;
+
 template <class ExtraT>
 typename ChainScheduler<ExtraT>::TaskId ChainScheduler<ExtraT>::create_task(Span<ChainId> chains, ExtraT extra) {
   auto task_id = tasks_.create();
@@ -0,0 +1,258 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/EpochBasedMemoryReclamation.h"
+#include "td/utils/HashTableUtils.h"
+#include "td/utils/logging.h"
+#include "td/utils/port/thread_local.h"
+
+#include <atomic>
+#include <functional>
+#include <utility>
+
+namespace td {
+
+// Hash map, which can be changed only by one thread at a time, but can be simultaneously read from any thread without
+// locks. Nodes are immutable and are destroyed using EpochBasedMemoryReclamation after all readers have left them.
+// Thread identifiers returned by get_thread_id() must be less than max_thread_count.
+template <class KeyT, class ValueT, class HashT = Hash<KeyT>, class EqT = std::equal_to<KeyT>>
+class ConcurrentReadHashMap {
+  struct Garbage {
+    Garbage() = default;
+    Garbage(const Garbage &) = delete;
+    Garbage &operator=(const Garbage &) = delete;
+    Garbage(Garbage &&) = delete;
+    Garbage &operator=(Garbage &&) = delete;
+    virtual ~Garbage() = default;
+  };
+
+  struct Node final : public Garbage {
+    KeyT key_;
+    ValueT value_;
+
+    Node(KeyT key, ValueT value) : key_(std::move(key)), value_(std::move(value)) {
+    }
+  };
+
+  // the table doesn't own nodes, because they are shared with previous and next tables
+  struct Table final : public Garbage {
+    uint32 bucket_count_mask_;
+    vector<std::atomic<Node *>> buckets_;
+
+    explicit Table(uint32 bucket_count) : bucket_count_mask_(bucket_count - 1), buckets_(bucket_count) {
+      CHECK((bucket_count & bucket_count_mask_) == 0);
+    }
+
+    uint32 bucket_count() const {
+      return bucket_count_mask_ + 1;
+    }
+  };
+
+ public:
+  explicit ConcurrentReadHashMap(size_t max_thread_count = 128) : ebmr_(max_thread_count) {
+    lockers_.reserve(max_thread_count);
+    for (size_t i = 0; i < max_thread_count; i++) {
+      lockers_.push_back(ebmr_.get_locker(i));
+    }
+    table_.store(new Table(MIN_BUCKET_COUNT), std::memory_order_relaxed);
+  }
+  ConcurrentReadHashMap(const ConcurrentReadHashMap &) = delete;
+  ConcurrentReadHashMap &operator=(const ConcurrentReadHashMap &) = delete;
+  ConcurrentReadHashMap(ConcurrentReadHashMap &&) = delete;
+  ConcurrentReadHashMap &operator=(ConcurrentReadHashMap &&) = delete;
+  ~ConcurrentReadHashMap() {
+    // there must be no simultaneous readers
+    unique_ptr<Table> table(table_.load(std::memory_order_relaxed));
+    for (uint32 i = 0; i < table->bucket_count(); i++) {
+      auto node = table->buckets_[i].load(std::memory_order_relaxed);
+      if (node != nullptr && node != &deleted_node_) {
+        delete node;
+      }
+    }
+  }
+
+  // the following methods can be called only by the writer
+
+  void set(KeyT key, ValueT value) {
+    auto &locker = get_locker();
+    locker.lock();
+    auto table = table_.load(std::memory_order_relaxed);
+    auto new_node = new Node(std::move(key), std::move(value));
+    auto *bucket = find_bucket(table, new_node->key_);
+    if (bucket != nullptr) {
+      auto old_node = bucket->load(std::memory_order_relaxed);
+      bucket->store(new_node, std::memory_order_release);
+      locker.retire(old_node);
+    } else {
+      if ((used_node_count_ + deleted_node_count_ + 1) * 4 > table->bucket_count() * 3) {
+        table = resize(locker, table, (used_node_count_ + 1) * 2);
+      }
+      if (insert_node(table, new_node)) {
+        deleted_node_count_--;
+      }
+      used_node_count_++;
+    }
+    finish_write(locker);
+  }
+
+  size_t erase(const KeyT &key) {
+    auto &locker = get_locker();
+    locker.lock();
+    auto table = table_.load(std::memory_order_relaxed);
+    auto *bucket = find_bucket(table, key);
+    if (bucket == nullptr) {
+      locker.unlock();
+      return 0;
+    }
+
+    auto old_node = bucket->load(std::memory_order_relaxed);
+    bucket->store(&deleted_node_, std::memory_order_release);
+    locker.retire(old_node);
+    used_node_count_--;
+    deleted_node_count_++;
+    if (used_node_count_ * 8 < table->bucket_count() && table->bucket_count() > MIN_BUCKET_COUNT) {
+      resize(locker, table, used_node_count_ * 2);
+    }
+    finish_write(locker);
+    return 1;
+  }
+
+  size_t size() const {
+    return used_node_count_;
+  }
+
+  bool empty() const {
+    return used_node_count_ == 0;
+  }
+
+  void foreach(const std::function<void(const KeyT &key, const ValueT &value)> &callback) const {
+    auto table = table_.load(std::memory_order_relaxed);
+    for (uint32 i = 0; i < table->bucket_count(); i++) {
+      auto node = table->buckets_[i].load(std::memory_order_relaxed);
+      if (node != nullptr && node != &deleted_node_) {
+        callback(node->key_, node->value_);
+      }
+    }
+  }
+
+  // the following methods can be called from any thread simultaneously with the writer
+
+  // calls func(const ValueT &) if the key is found; the value must not be used after func returns,
+  // and func must not change the map
+  template <class F>
+  bool with_value(const KeyT &key, F &&func) const {
+    auto &locker = get_locker();
+    locker.lock();
+    auto node = find_node(table_.load(std::memory_order_acquire), key);
+    if (node != nullptr) {
+      func(node->value_);
+    }
+    locker.unlock();
+    return node != nullptr;
+  }
+
+  ValueT get(const KeyT &key) const {
+    ValueT result{};
+    with_value(key, [&result](const ValueT &value) { result = value; });
+    return result;
+  }
+
+  size_t count(const KeyT &key) const {
+    return with_value(key, [](const ValueT &) {});
+  }
+
+ private:
+  static constexpr uint32 MIN_BUCKET_COUNT = 8;
+
+  using Locker = typename EpochBasedMemoryReclamation<Garbage>::Locker;
+
+  mutable EpochBasedMemoryReclamation<Garbage> ebmr_;
+  mutable vector<Locker> lockers_;
+  std::atomic<Table *> table_{nullptr};
+  Node deleted_node_{KeyT(), ValueT()};
+  size_t used_node_count_ = 0;
+  size_t deleted_node_count_ = 0;
+  uint32 write_count_ = 0;
+
+  Locker &get_locker() const {
+    auto thread_id = static_cast<size_t>(get_thread_id());
+    CHECK(thread_id < lockers_.size());
+    return lockers_[thread_id];
+  }
+
+  void finish_write(Locker &locker) {
+    // try to destroy retired nodes from time to time
+    if (++write_count_ % 64 == 0) {
+      locker.retire();
+    }
+    locker.unlock();
+  }
+
+  const Node *find_node(const Table *table, const KeyT &key) const {
+    auto bucket = static_cast<uint32>(HashT()(key)) & table->bucket_count_mask_;
+    while (true) {
+      auto node = table->buckets_[bucket].load(std::memory_order_acquire);
+      if (node == nullptr) {
+        return nullptr;
+      }
+      if (node != &deleted_node_ && EqT()(node->key_, key)) {
+        return node;
+      }
+      bucket = (bucket + 1) & table->bucket_count_mask_;
+    }
+  }
+
+  // returns the bucket with the node with the given key or nullptr if there is no such node; for the writer only
+  std::atomic<Node *> *find_bucket(Table *table, const KeyT &key) {
+    auto bucket = static_cast<uint32>(HashT()(key)) & table->bucket_count_mask_;
+    while (true) {
+      auto node = table->buckets_[bucket].load(std::memory_order_relaxed);
+      if (node == nullptr) {
+        return nullptr;
+      }
+      if (node != &deleted_node_ && EqT()(node->key_, key)) {
+        return &table->buckets_[bucket];
+      }
+      bucket = (bucket + 1) & table->bucket_count_mask_;
+    }
+  }
+
+  // returns true if a deleted node was replaced
+  bool insert_node(Table *table, Node *node) {
+    auto bucket = static_cast<uint32>(HashT()(node->key_)) & table->bucket_count_mask_;
+    while (true) {
+      auto old_node = table->buckets_[bucket].load(std::memory_order_relaxed);
+      if (old_node == nullptr || old_node == &deleted_node_) {
+        table->buckets_[bucket].store(node, std::memory_order_release);
+        return old_node != nullptr;
+      }
+      bucket = (bucket + 1) & table->bucket_count_mask_;
+    }
+  }
+
+  Table *resize(Locker &locker, Table *old_table, size_t min_bucket_count) {
+    uint32 bucket_count = MIN_BUCKET_COUNT;
+    while (bucket_count < min_bucket_count) {
+      bucket_count *= 2;
+    }
+    auto table = new Table(bucket_count);
+    for (uint32 i = 0; i < old_table->bucket_count(); i++) {
+      auto node = old_table->buckets_[i].load(std::memory_order_relaxed);
+      if (node != nullptr && node != &deleted_node_) {
+        insert_node(table, node);
+      }
+    }
+    deleted_node_count_ = 0;
+    table_.store(table, std::memory_order_release);
+    locker.retire(old_table);
+    return table;
+  }
+};
+
+}  // namespace td
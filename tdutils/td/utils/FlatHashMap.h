@@ -6,8 +6,13 @@
 //
 #pragma once
 
-//#include "td/utils/FlatHashMapChunks.h"
+#include "td/utils/config.h"
+
+#if TD_FLAT_HASH_MAP_CHUNKS
+#include "td/utils/FlatHashMapChunks.h"
+#else
 #include "td/utils/FlatHashTable.h"
+#endif
 #include "td/utils/HashTableUtils.h"
 #include "td/utils/MapNode.h"
 
@@ -16,9 +21,13 @@
 
 namespace td {
 
+#if TD_FLAT_HASH_MAP_CHUNKS
+template <class KeyT, class ValueT, class HashT = Hash<KeyT>, class EqT = std::equal_to<KeyT>>
+using FlatHashMap = FlatHashMapChunks<KeyT, ValueT, HashT, EqT>;
+#else
 template <class KeyT, class ValueT, class HashT = Hash<KeyT>, class EqT = std::equal_to<KeyT>>
 using FlatHashMap = FlatHashTable<MapNode<KeyT, ValueT, EqT>, HashT, EqT>;
-//using FlatHashMap = FlatHashMapChunks<KeyT, ValueT, HashT, EqT>;
+#endif
 //using FlatHashMap = std::unordered_map<KeyT, ValueT, HashT, EqT>;
 
 }  // namespace td
@@ -155,9 +155,15 @@ class FlatHashTableChunks {
     reference operator*() {
       return it_->get_public();
     }
+    const value_type &operator*() const {
+      return it_->get_public();
+    }
     pointer operator->() {
       return &it_->get_public();
     }
+    const value_type *operator->() const {
+      return &it_->get_public();
+    }
     bool operator==(const Iterator &other) const {
       DCHECK(map_ == other.map_);
       return it_ == other.it_;
@@ -192,10 +198,10 @@ class FlatHashTableChunks {
       --it_;
       return *this;
     }
-    reference operator*() {
+    reference operator*() const {
       return *it_;
     }
-    pointer operator->() {
+    pointer operator->() const {
       return &*it_;
     }
     bool operator==(const ConstIterator &other) const {
@@ -238,6 +244,13 @@ class FlatHashTableChunks {
     }
   }
 
+  template <class T>
+  FlatHashTableChunks(std::initializer_list<T> keys) {
+    for (auto &key : keys) {
+      emplace(KeyT(key));
+    }
+  }
+
   FlatHashTableChunks(FlatHashTableChunks &&other) noexcept {
     swap(other);
   }
@@ -274,7 +287,7 @@ class FlatHashTableChunks {
           return Iterator{it, this};
         }
       }
-      if (chunk.skipped_cnt == 0) {
+      if (chunk.skipped_cnt == 0 || chunk_it.is_last()) {
         break;
       }
       chunk_it.next();
@@ -324,6 +337,18 @@ class FlatHashTableChunks {
     }
   }
 
+  // reduces the number of buckets to the minimum, which is enough for the current number of elements
+  void shrink_to_fit() {
+    if (empty()) {
+      clear();
+      return;
+    }
+    size_t want_size = normalize((used_nodes_ + 1) * 5 / 3 + 1);
+    if (want_size < nodes_.size()) {
+      resize(want_size);
+    }
+  }
+
   template <class... ArgsT>
   std::pair<Iterator, bool> emplace(KeyT key, ArgsT &&...args) {
     CHECK(!is_hash_table_key_empty<EqT>(key));
@@ -474,6 +499,10 @@ class FlatHashTableChunks {
     size_t pos() const {
       return chunk_i;
     }
+    // all chunks are visited after chunk_mask + 1 probes
+    bool is_last() const {
+      return shift == chunk_mask;
+    }
     void next() {
       DCHECK((chunk_mask & (chunk_mask + 1)) == 0);
       shift++;
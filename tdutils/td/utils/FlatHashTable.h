@@ -306,6 +306,19 @@ class FlatHashTable {
     }
   }
 
+  // reduces the number of buckets to the minimum, which is enough for the current number of elements
+  void shrink_to_fit() {
+    if (empty()) {
+      clear();
+      return;
+    }
+    uint32 want_size = detail::normalize_flat_hash_table_size((used_node_count_ + 1) * 5 / 3 + 1);
+    if (want_size < bucket_count()) {
+      resize(want_size);
+      invalidate_iterators();
+    }
+  }
+
   template <class... ArgsT>
   std::pair<NodePointer, bool> emplace(KeyT key, ArgsT &&...args) {
     CHECK(!is_hash_table_key_empty<EqT>(key));
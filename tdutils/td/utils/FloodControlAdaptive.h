@@ -0,0 +1,123 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+namespace td {
+
+// Token bucket flood control, which learns its rate from flood wait errors received from a remote side.
+// Each flood wait halves the allowed rate, and each DECAY_PERIOD without flood waits doubles it back,
+// until the limit disappears completely.
+class FloodControlAdaptive {
+ public:
+  static constexpr double MIN_INTERVAL = 0.05;
+  static constexpr double MAX_INTERVAL = 60.0;
+  static constexpr double DECAY_PERIOD = 300.0;
+  static constexpr double MAX_CAPACITY = 3.0;
+
+  FloodControlAdaptive() = default;
+
+  FloodControlAdaptive(double interval, double blocked_until, double changed_at)
+      : interval_(interval)
+      , blocked_until_(blocked_until)
+      , changed_at_(changed_at)
+      , volume_(1.0)
+      , volume_at_(blocked_until) {
+    if (interval_ < MIN_INTERVAL) {
+      interval_ = 0.0;
+    } else {
+      limit_interval();
+    }
+  }
+
+  // returns the time when the next event can be added
+  double get_wakeup_at(double now) {
+    update(now);
+    auto wakeup_at = blocked_until_;
+    if (interval_ > 0.0 && volume_ < 1.0) {
+      wakeup_at = td::max(wakeup_at, volume_at_ + (1.0 - volume_) * interval_);
+    }
+    return wakeup_at;
+  }
+
+  void add_event(double now) {
+    update(now);
+    if (interval_ > 0.0) {
+      volume_ -= 1.0;
+    }
+  }
+
+  void on_flood_wait(double now, double timeout) {
+    update(now);
+    if (interval_ == 0.0) {
+      interval_ = timeout / 10.0;
+    } else {
+      interval_ = td::max(interval_ * 2.0, timeout / 10.0);
+    }
+    if (interval_ < MIN_INTERVAL) {
+      interval_ = MIN_INTERVAL;
+    }
+    limit_interval();
+    blocked_until_ = td::max(blocked_until_, now + timeout);
+    changed_at_ = now;
+    volume_ = 1.0;
+    volume_at_ = blocked_until_;
+  }
+
+  // returns true if there is no learned limit anymore
+  bool is_unlimited(double now) {
+    update(now);
+    return interval_ == 0.0 && blocked_until_ <= now;
+  }
+
+  double get_interval() const {
+    return interval_;
+  }
+
+  double get_blocked_until() const {
+    return blocked_until_;
+  }
+
+  double get_changed_at() const {
+    return changed_at_;
+  }
+
+ private:
+  double interval_ = 0.0;  // minimum average interval between events; 0 if there is no limit
+  double blocked_until_ = 0.0;
+  double changed_at_ = 0.0;
+
+  double volume_ = 0.0;
+  double volume_at_ = 0.0;
+
+  void limit_interval() {
+    if (interval_ > MAX_INTERVAL) {
+      interval_ = MAX_INTERVAL;
+    }
+  }
+
+  void update(double now) {
+    while (interval_ > 0.0 && now >= changed_at_ + DECAY_PERIOD) {
+      interval_ *= 0.5;
+      changed_at_ += DECAY_PERIOD;
+      if (interval_ < MIN_INTERVAL) {
+        interval_ = 0.0;
+      }
+    }
+    if (interval_ == 0.0 || now <= volume_at_) {
+      return;
+    }
+    volume_ += (now - volume_at_) / interval_;
+    if (volume_ > MAX_CAPACITY) {
+      volume_ = MAX_CAPACITY;
+    }
+    volume_at_ = now;
+  }
+};
+
+}  // namespace td
@@ -32,11 +32,20 @@ class Gzip::Impl {
   ~Impl() = default;
 };
 
-Status Gzip::init_encode() {
+Status Gzip::init_encode(size_t input_size) {
   CHECK(mode_ == Mode::Empty);
   init_common();
   mode_ = Mode::Encode;
-  int ret = deflateInit2(&impl_->stream_, 6, Z_DEFLATED, 15, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+  // a window bigger than the input doesn't improve compression, but is expensive to allocate and initialize
+  int window_bits = MAX_WBITS;
+  if (input_size != 0) {
+    window_bits = 9;
+    while (window_bits < MAX_WBITS && (static_cast<size_t>(1) << window_bits) < input_size) {
+      window_bits++;
+    }
+  }
+  int mem_level = MAX_MEM_LEVEL - (MAX_WBITS - window_bits);
+  int ret = deflateInit2(&impl_->stream_, 6, Z_DEFLATED, window_bits, mem_level, Z_DEFAULT_STRATEGY);
   if (ret != Z_OK) {
     return Status::Error(PSLICE() << "zlib deflate init failed: " << ret);
   }
@@ -154,7 +163,44 @@ Gzip::~Gzip() {
   clear();
 }
 
+// returns the uncompressed size stored in the gzip trailer, or 0 if it is unknown
+static size_t get_gzip_uncompressed_size(Slice s) {
+  if (s.size() < 18 || s.ubegin()[0] != 0x1f || s.ubegin()[1] != 0x8b) {
+    return 0;
+  }
+  uint32 size;
+  std::memcpy(&size, s.end() - 4, sizeof(size));
+  if (size / 1032 > s.size()) {
+    // the size is bigger than the maximum possible for deflate, and can't be used
+    return 0;
+  }
+  return size;
+}
+
+// decodes the data into a buffer of the exact size, if the size is known
+static bool gzdecode_exact(Slice s, size_t size, BufferSlice &result) {
+  Gzip gzip;
+  gzip.init_decode().ensure();
+  gzip.set_input(s);
+  gzip.close_input();
+  result = BufferSlice(size);
+  gzip.set_output(result.as_mutable_slice());
+  auto r_state = gzip.run();
+  if (r_state.is_error() || r_state.ok() != Gzip::State::Done || gzip.left_output() != 0) {
+    return false;
+  }
+  return true;
+}
+
 BufferSlice gzdecode(Slice s) {
+  auto uncompressed_size = get_gzip_uncompressed_size(s);
+  if (uncompressed_size != 0) {
+    BufferSlice result;
+    if (gzdecode_exact(s, uncompressed_size, result)) {
+      return result;
+    }
+  }
+
   Gzip gzip;
   gzip.init_decode().ensure();
   ChainBufferWriter message;
@@ -186,7 +232,7 @@ BufferSlice gzdecode(Slice s) {
 
 BufferSlice gzencode(Slice s, double max_compression_ratio) {
   Gzip gzip;
-  gzip.init_encode().ensure();
+  gzip.init_encode(s.size()).ensure();
   gzip.set_input(s);
   gzip.close_input();
   auto max_size = static_cast<size_t>(static_cast<double>(s.size()) * max_compression_ratio);
@@ -35,7 +35,8 @@ class Gzip {
     return Status::OK();
   }
 
-  Status init_encode() TD_WARN_UNUSED_RESULT;
+  // if the total input size is known, then less memory can be used for compression of small inputs
+  Status init_encode(size_t input_size = 0) TD_WARN_UNUSED_RESULT;
 
   Status init_decode() TD_WARN_UNUSED_RESULT;
 
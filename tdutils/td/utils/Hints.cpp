@@ -14,6 +14,7 @@
 #include "td/utils/utf8.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace td {
 
@@ -40,23 +41,145 @@ vector<string> Hints::get_words(Slice name) {
   return fix_words(utf8_get_search_words(name));
 }
 
-void Hints::add_word(const string &word, KeyT key, std::map<string, vector<KeyT>> &word_to_keys) {
-  vector<KeyT> &keys = word_to_keys[word];
+template <class MapT>
+static size_t get_hash_map_memory_usage(const MapT &map) {
+  // each node of the map contains a pointer to the next node in addition to the value
+  return map.bucket_count() * sizeof(void *) + map.size() * (sizeof(typename MapT::value_type) + sizeof(void *));
+}
+
+static size_t get_string_memory_usage(const string &str) {
+  static const size_t MAX_INPLACE_STRING_CAPACITY = string().capacity();
+  return str.capacity() > MAX_INPLACE_STRING_CAPACITY ? str.capacity() + 1 : 0;
+}
+
+Hints::WordToKeys::Entry *Hints::WordToKeys::find_entry(const string &word, KeyT key) {
+  auto it = std::lower_bound(entries_.begin(), entries_.end(), std::make_pair(Slice(word), key),
+                             [this](const Entry &entry, const std::pair<Slice, KeyT> &value) {
+                               return std::make_pair(get_word(entry), entry.key) < value;
+                             });
+  if (it == entries_.end() || it->key != key || get_word(*it) != word) {
+    return nullptr;
+  }
+  return &*it;
+}
+
+void Hints::WordToKeys::add(const string &word, KeyT key) {
+  auto entry = find_entry(word, key);
+  if (entry != nullptr) {
+    CHECK((entry->word_size & DELETED_FLAG) != 0);
+    entry->word_size &= ~DELETED_FLAG;
+    deleted_entry_count_--;
+    return;
+  }
+
+  vector<KeyT> &keys = new_word_to_keys_[word];
   CHECK(!td::contains(keys, key));
   keys.push_back(key);
+  new_entry_count_++;
+  try_merge();
 }
 
-void Hints::delete_word(const string &word, KeyT key, std::map<string, vector<KeyT>> &word_to_keys) {
-  vector<KeyT> &keys = word_to_keys[word];
-  auto key_it = std::find(keys.begin(), keys.end(), key);
-  CHECK(key_it != keys.end());
-  if (keys.size() == 1) {
-    word_to_keys.erase(word);
-  } else {
-    CHECK(keys.size() > 1);
-    *key_it = keys.back();
-    keys.pop_back();
+void Hints::WordToKeys::remove(const string &word, KeyT key) {
+  auto it = new_word_to_keys_.find(word);
+  if (it != new_word_to_keys_.end()) {
+    vector<KeyT> &keys = it->second;
+    auto key_it = std::find(keys.begin(), keys.end(), key);
+    if (key_it != keys.end()) {
+      if (keys.size() == 1) {
+        new_word_to_keys_.erase(it);
+      } else {
+        *key_it = keys.back();
+        keys.pop_back();
+      }
+      new_entry_count_--;
+      return;
+    }
   }
+
+  auto entry = find_entry(word, key);
+  CHECK(entry != nullptr);
+  CHECK((entry->word_size & DELETED_FLAG) == 0);
+  entry->word_size |= DELETED_FLAG;
+  deleted_entry_count_++;
+  try_merge();
+}
+
+void Hints::WordToKeys::try_merge() {
+  auto alive_entry_count = entries_.size() - deleted_entry_count_;
+  if (new_entry_count_ + deleted_entry_count_ <= 16 + alive_entry_count / 4) {
+    return;
+  }
+
+  vector<std::pair<Slice, KeyT>> old_entries;
+  old_entries.reserve(alive_entry_count);
+  for (auto &entry : entries_) {
+    if ((entry.word_size & DELETED_FLAG) == 0) {
+      old_entries.emplace_back(get_word(entry), entry.key);
+    }
+  }
+  vector<std::pair<Slice, KeyT>> new_entries;
+  new_entries.reserve(new_entry_count_);
+  for (auto &it : new_word_to_keys_) {
+    std::sort(it.second.begin(), it.second.end());
+    for (auto key : it.second) {
+      new_entries.emplace_back(it.first, key);
+    }
+  }
+  vector<std::pair<Slice, KeyT>> all_entries(old_entries.size() + new_entries.size());
+  std::merge(old_entries.begin(), old_entries.end(), new_entries.begin(), new_entries.end(), all_entries.begin());
+
+  size_t words_size = 0;
+  for (size_t i = 0; i < all_entries.size(); i++) {
+    if (i == 0 || all_entries[i].first != all_entries[i - 1].first) {
+      words_size += all_entries[i].first.size();
+    }
+  }
+  CHECK(words_size < DELETED_FLAG);
+
+  string words;
+  words.reserve(words_size);
+  vector<Entry> entries;
+  entries.reserve(all_entries.size());
+  for (size_t i = 0; i < all_entries.size(); i++) {
+    auto word = all_entries[i].first;
+    if (i == 0 || word != all_entries[i - 1].first) {
+      words.append(word.begin(), word.size());
+    }
+    auto word_size = static_cast<uint32>(word.size());
+    entries.push_back(Entry{static_cast<uint32>(words.size()) - word_size, word_size, all_entries[i].second});
+  }
+
+  words_ = std::move(words);
+  entries_ = std::move(entries);
+  deleted_entry_count_ = 0;
+  new_word_to_keys_.clear();
+  new_entry_count_ = 0;
+}
+
+void Hints::WordToKeys::append_keys(vector<KeyT> &results, const string &prefix) const {
+  LOG(DEBUG) << "Search for word " << prefix;
+  auto it = std::lower_bound(entries_.begin(), entries_.end(), Slice(prefix),
+                             [this](const Entry &entry, Slice word) { return get_word(entry) < word; });
+  for (; it != entries_.end() && begins_with(get_word(*it), prefix); ++it) {
+    if ((it->word_size & DELETED_FLAG) == 0) {
+      results.push_back(it->key);
+    }
+  }
+
+  auto map_it = new_word_to_keys_.lower_bound(prefix);
+  while (map_it != new_word_to_keys_.end() && begins_with(map_it->first, prefix)) {
+    append(results, map_it->second);
+    ++map_it;
+  }
+}
+
+size_t Hints::WordToKeys::get_memory_usage() const {
+  size_t result = words_.capacity() + entries_.capacity() * sizeof(Entry);
+  for (auto &it : new_word_to_keys_) {
+    // each node of the map contains 3 pointers and a color in addition to the value
+    result += sizeof(it) + 4 * sizeof(void *) + get_string_memory_usage(it.first) + it.second.capacity() * sizeof(KeyT);
+  }
+  return result;
 }
 
 void Hints::add(KeyT key, Slice name) {
@@ -68,7 +191,7 @@ void Hints::add(KeyT key, Slice name) {
     }
     vector<string> old_transliterations;
     for (auto &old_word : get_words(it->second)) {
-      delete_word(old_word, key, word_to_keys_);
+      word_to_keys_.remove(old_word, key);
 
       for (auto &w : get_word_transliterations(old_word, false)) {
         if (w != old_word) {
@@ -77,7 +200,7 @@ void Hints::add(KeyT key, Slice name) {
       }
     }
     for (auto &word : fix_words(old_transliterations)) {
-      delete_word(word, key, translit_word_to_keys_);
+      translit_word_to_keys_.remove(word, key);
     }
   }
   if (name.empty()) {
@@ -90,7 +213,7 @@ void Hints::add(KeyT key, Slice name) {
 
   vector<string> transliterations;
   for (auto &word : get_words(name)) {
-    add_word(word, key, word_to_keys_);
+    word_to_keys_.add(word, key);
 
     for (auto &w : get_word_transliterations(word, false)) {
       if (w != word) {
@@ -99,7 +222,7 @@ void Hints::add(KeyT key, Slice name) {
     }
   }
   for (auto &word : fix_words(transliterations)) {
-    add_word(word, key, translit_word_to_keys_);
+    translit_word_to_keys_.add(word, key);
   }
 
   key_to_name_[key] = name.str();
@@ -110,21 +233,11 @@ void Hints::set_rating(KeyT key, RatingT rating) {
   key_to_rating_[key] = rating;
 }
 
-void Hints::add_search_results(vector<KeyT> &results, const string &word,
-                               const std::map<string, vector<KeyT>> &word_to_keys) {
-  LOG(DEBUG) << "Search for word " << word;
-  auto it = word_to_keys.lower_bound(word);
-  while (it != word_to_keys.end() && begins_with(it->first, word)) {
-    append(results, it->second);
-    ++it;
-  }
-}
-
 vector<Hints::KeyT> Hints::search_word(const string &word) const {
   vector<KeyT> results;
-  add_search_results(results, word, translit_word_to_keys_);
+  translit_word_to_keys_.append_keys(results, word);
   for (const auto &w : get_word_transliterations(word, true)) {
-    add_search_results(results, w, word_to_keys_);
+    word_to_keys_.append_keys(results, w);
   }
 
   td::unique(results);
@@ -172,12 +285,22 @@ std::pair<size_t, vector<Hints::KeyT>> Hints::search(Slice query, int32 limit, b
     results.resize(new_results_size);
   }
 
+  // ratings are fetched once instead of on each comparison
   auto total_size = results.size();
+  vector<std::pair<RatingT, KeyT>> rated_results;
+  rated_results.reserve(total_size);
+  for (auto key : results) {
+    rated_results.emplace_back(get_rating(key), key);
+  }
   if (total_size < static_cast<size_t>(limit)) {
-    std::sort(results.begin(), results.end(), CompareByRating(key_to_rating_));
+    std::sort(rated_results.begin(), rated_results.end());
   } else {
-    std::partial_sort(results.begin(), results.begin() + limit, results.end(), CompareByRating(key_to_rating_));
-    results.resize(limit);
+    std::partial_sort(rated_results.begin(), rated_results.begin() + limit, rated_results.end());
+    rated_results.resize(limit);
+  }
+  results.resize(rated_results.size());
+  for (size_t i = 0; i < rated_results.size(); i++) {
+    results[i] = rated_results[i].second;
   }
 
   return {total_size, std::move(results)};
@@ -203,4 +326,13 @@ size_t Hints::size() const {
   return key_to_name_.size();
 }
 
+size_t Hints::get_memory_usage() const {
+  size_t result = sizeof(Hints) + word_to_keys_.get_memory_usage() + translit_word_to_keys_.get_memory_usage() +
+                  get_hash_map_memory_usage(key_to_name_) + get_hash_map_memory_usage(key_to_rating_);
+  for (auto &it : key_to_name_) {
+    result += get_string_memory_usage(it.second);
+  }
+  return result;
+}
+
 }  // namespace td
@@ -42,46 +42,65 @@ class Hints {
 
   size_t size() const;
 
+  // returns approximate size of the memory used by the object
+  size_t get_memory_usage() const;
+
   static vector<string> fix_words(vector<string> words);
 
  private:
-  std::map<string, vector<KeyT>> word_to_keys_;
-  std::map<string, vector<KeyT>> translit_word_to_keys_;
-  std::unordered_map<KeyT, string, Hash<KeyT>> key_to_name_;
-  std::unordered_map<KeyT, RatingT, Hash<KeyT>> key_to_rating_;
+  // sorted array of words with their keys, and a small map for recently changed words,
+  // which is merged into the array when it becomes big enough
+  class WordToKeys {
+   public:
+    void add(const string &word, KeyT key);
 
-  static void add_word(const string &word, KeyT key, std::map<string, vector<KeyT>> &word_to_keys);
-  static void delete_word(const string &word, KeyT key, std::map<string, vector<KeyT>> &word_to_keys);
+    void remove(const string &word, KeyT key);
 
-  static vector<string> get_words(Slice name);
+    void append_keys(vector<KeyT> &results, const string &prefix) const;
 
-  static void add_search_results(vector<KeyT> &results, const string &word,
-                                 const std::map<string, vector<KeyT>> &word_to_keys);
+    size_t get_memory_usage() const;
 
-  vector<KeyT> search_word(const string &word) const;
+   private:
+    static constexpr uint32 DELETED_FLAG = static_cast<uint32>(1) << 31;
 
-  class CompareByRating {
-    const std::unordered_map<KeyT, RatingT, Hash<KeyT>> &key_to_rating_;
+    struct Entry {
+      uint32 word_offset;
+      uint32 word_size;  // or DELETED_FLAG
+      KeyT key;
+    };
 
-    RatingT get_rating(const KeyT &key) const {
-      auto it = key_to_rating_.find(key);
-      if (it == key_to_rating_.end()) {
-        return RatingT();
-      }
-      return it->second;
-    }
+    string words_;
+    vector<Entry> entries_;  // sorted by word and key
+    size_t deleted_entry_count_ = 0;
 
-   public:
-    explicit CompareByRating(const std::unordered_map<KeyT, RatingT, Hash<KeyT>> &key_to_rating)
-        : key_to_rating_(key_to_rating) {
-    }
+    std::map<string, vector<KeyT>> new_word_to_keys_;
+    size_t new_entry_count_ = 0;
 
-    bool operator()(const KeyT &lhs, const KeyT &rhs) const {
-      auto lhs_rating = get_rating(lhs);
-      auto rhs_rating = get_rating(rhs);
-      return lhs_rating < rhs_rating || (lhs_rating == rhs_rating && lhs < rhs);
+    Slice get_word(const Entry &entry) const {
+      return Slice(words_.data() + entry.word_offset, entry.word_size & ~DELETED_FLAG);
     }
+
+    Entry *find_entry(const string &word, KeyT key);
+
+    void try_merge();
   };
+
+  WordToKeys word_to_keys_;
+  WordToKeys translit_word_to_keys_;
+  std::unordered_map<KeyT, string, Hash<KeyT>> key_to_name_;
+  std::unordered_map<KeyT, RatingT, Hash<KeyT>> key_to_rating_;
+
+  static vector<string> get_words(Slice name);
+
+  vector<KeyT> search_word(const string &word) const;
+
+  RatingT get_rating(KeyT key) const {
+    auto it = key_to_rating_.find(key);
+    if (it == key_to_rating_.end()) {
+      return RatingT();
+    }
+    return it->second;
+  }
 };
 
 }  // namespace td
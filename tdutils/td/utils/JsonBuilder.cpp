@@ -6,13 +6,67 @@
 //
 #include "td/utils/JsonBuilder.h"
 
+#include "td/utils/bits.h"
 #include "td/utils/misc.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/utf8.h"
 
+#if defined(__SSE2__) || (TD_MSVC && (defined(_M_X64) || (defined(_M_IX86) && _M_IX86_FP >= 2)))
+#define TD_SSE2 1
+#endif
+
+#if TD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace td {
 
+// returns position of the first character in [begin, end), which must be escaped in a JSON string
+template <bool allow_non_ascii>
+static const char *find_json_escaped_char(const char *begin, const char *end) {
+#if TD_SSE2
+  while (end - begin >= 16) {
+    auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    // if non-ASCII characters must be escaped, then signed comparison finds both control and non-ASCII characters
+    auto is_escaped = allow_non_ascii ? _mm_cmpeq_epi8(_mm_min_epu8(bytes, _mm_set1_epi8(31)), bytes)
+                                      : _mm_cmplt_epi8(bytes, _mm_set1_epi8(32));
+    is_escaped = _mm_or_si128(is_escaped, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')));
+    is_escaped = _mm_or_si128(is_escaped, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\')));
+    auto mask = static_cast<uint32>(_mm_movemask_epi8(is_escaped));
+    if (mask != 0) {
+      return begin + count_trailing_zeroes_non_zero32(mask);
+    }
+    begin += 16;
+  }
+#elif defined(__aarch64__)
+  while (end - begin >= 16) {
+    auto bytes = vld1q_u8(reinterpret_cast<const unsigned char *>(begin));
+    auto is_escaped = vcltq_u8(bytes, vdupq_n_u8(32));
+    if (!allow_non_ascii) {
+      is_escaped = vorrq_u8(is_escaped, vcgeq_u8(bytes, vdupq_n_u8(128)));
+    }
+    is_escaped = vorrq_u8(is_escaped, vceqq_u8(bytes, vdupq_n_u8('"')));
+    is_escaped = vorrq_u8(is_escaped, vceqq_u8(bytes, vdupq_n_u8('\\')));
+    if (vmaxvq_u8(is_escaped) != 0) {
+      // the character is found by the loop below
+      break;
+    }
+    begin += 16;
+  }
+#endif
+  while (begin != end) {
+    auto ch = static_cast<unsigned char>(*begin);
+    if (ch < 32 || ch == '"' || ch == '\\' || (!allow_non_ascii && ch >= 128)) {
+      break;
+    }
+    begin++;
+  }
+  return begin;
+}
+
 StringBuilder &operator<<(StringBuilder &sb, const JsonRawString &val) {
   sb << '"';
   SCOPE_EXIT {
@@ -22,6 +76,16 @@ StringBuilder &operator<<(StringBuilder &sb, const JsonRawString &val) {
   auto len = val.value_.size();
 
   for (size_t pos = 0; pos < len; pos++) {
+    // characters, which don't need to be escaped, are appended at once
+    auto plain_end = static_cast<size_t>(find_json_escaped_char<true>(s + pos, s + len) - s);
+    if (plain_end != pos) {
+      sb << Slice(s + pos, s + plain_end);
+      pos = plain_end;
+      if (pos == len) {
+        break;
+      }
+    }
+
     auto ch = static_cast<unsigned char>(s[pos]);
     switch (ch) {
       case '"':
@@ -66,6 +130,16 @@ StringBuilder &operator<<(StringBuilder &sb, const JsonString &val) {
   auto len = val.str_.size();
 
   for (size_t pos = 0; pos < len; pos++) {
+    // characters, which don't need to be escaped, are appended at once
+    auto plain_end = static_cast<size_t>(find_json_escaped_char<false>(s + pos, s + len) - s);
+    if (plain_end != pos) {
+      sb << Slice(s + pos, s + plain_end);
+      pos = plain_end;
+      if (pos == len) {
+        break;
+      }
+    }
+
     auto ch = static_cast<unsigned char>(s[pos]);
     switch (ch) {
       case '"':
@@ -549,41 +623,53 @@ size_t JsonObject::field_count() const {
   return field_values_.size();
 }
 
-JsonValue JsonObject::extract_field(Slice name) {
-  for (auto &field_value : field_values_) {
+JsonValue *JsonObject::find_field(Slice name) {
+  auto size = field_values_.size();
+  auto start_pos = next_field_pos_ < size ? next_field_pos_ : 0;
+  for (size_t i = 0; i < size; i++) {
+    auto pos = start_pos + i;
+    if (pos >= size) {
+      pos -= size;
+    }
+    auto &field_value = field_values_[pos];
     if (field_value.first == name) {
-      return std::move(field_value.second);
+      next_field_pos_ = pos + 1;
+      return &field_value.second;
     }
   }
-  return JsonValue();
+  return nullptr;
 }
 
-Result<JsonValue> JsonObject::extract_optional_field(Slice name, JsonValueType type) {
-  for (auto &field_value : field_values_) {
-    if (field_value.first == name) {
-      if (type != JsonValue::Type::Null && field_value.second.type() != type) {
-        return Status::Error(400, PSLICE()
-                                      << "Field \"" << name << "\" must be of type " << JsonValue::get_type_name(type));
-      }
+JsonValue JsonObject::extract_field(Slice name) {
+  auto value = find_field(name);
+  if (value == nullptr) {
+    return JsonValue();
+  }
+  return std::move(*value);
+}
 
-      return std::move(field_value.second);
-    }
+Result<JsonValue> JsonObject::extract_optional_field(Slice name, JsonValueType type) {
+  auto value = find_field(name);
+  if (value == nullptr) {
+    return JsonValue();
+  }
+  if (type != JsonValue::Type::Null && value->type() != type) {
+    return Status::Error(400,
+                         PSLICE() << "Field \"" << name << "\" must be of type " << JsonValue::get_type_name(type));
   }
-  return JsonValue();
+  return std::move(*value);
 }
 
 Result<JsonValue> JsonObject::extract_required_field(Slice name, JsonValueType type) {
-  for (auto &field_value : field_values_) {
-    if (field_value.first == name) {
-      if (type != JsonValue::Type::Null && field_value.second.type() != type) {
-        return Status::Error(400, PSLICE()
-                                      << "Field \"" << name << "\" must be of type " << JsonValue::get_type_name(type));
-      }
-
-      return std::move(field_value.second);
-    }
+  auto value = find_field(name);
+  if (value == nullptr) {
+    return Status::Error(400, PSLICE() << "Can't find field \"" << name << "\"");
+  }
+  if (type != JsonValue::Type::Null && value->type() != type) {
+    return Status::Error(400,
+                         PSLICE() << "Field \"" << name << "\" must be of type " << JsonValue::get_type_name(type));
   }
-  return Status::Error(400, PSLICE() << "Can't find field \"" << name << "\"");
+  return std::move(*value);
 }
 
 const JsonValue *JsonObject::get_field(Slice name) const {
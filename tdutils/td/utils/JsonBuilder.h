@@ -459,6 +459,10 @@ using JsonArray = vector<JsonValue>;
 class JsonObject {
   const JsonValue *get_field(Slice name) const;
 
+  JsonValue *find_field(Slice name);
+
+  size_t next_field_pos_ = 0;  // fields are usually extracted in the order they were stored
+
  public:
   vector<std::pair<Slice, JsonValue>> field_values_;
 
@@ -23,18 +23,22 @@ class MpmcEagerWaiter {
    private:
     friend class MpmcEagerWaiter;
     int yields;
+    int rounds_till_sleepy;
     uint32 worker_id;
   };
   static void init_slot(Slot &slot, uint32 worker_id) {
     slot.yields = 0;
+    slot.rounds_till_sleepy = RoundsTillSleepy;
     slot.worker_id = worker_id;
   }
 
+  // the number of spinning rounds is adapted to the recent waiting times of the worker:
+  // it is decreased if the worker falls asleep and is increased if work is found at the end of spinning
   void wait(Slot &slot) {
-    if (slot.yields < RoundsTillSleepy) {
+    if (slot.yields < slot.rounds_till_sleepy) {
       yield();
       slot.yields++;
-    } else if (slot.yields == RoundsTillSleepy) {
+    } else if (slot.yields == slot.rounds_till_sleepy) {
       auto state = state_.load(std::memory_order_relaxed);
       if (!State::has_worker(state)) {
         auto new_state = State::with_worker(state, slot.worker_id);
@@ -50,7 +54,7 @@ class MpmcEagerWaiter {
       }
       yield();
       slot.yields = 0;
-    } else if (slot.yields < RoundsTillAsleep) {
+    } else if (slot.yields < 2 * slot.rounds_till_sleepy) {
       auto state = state_.load(std::memory_order_acquire);
       if (State::still_sleepy(state, slot.worker_id)) {
         yield();
@@ -65,15 +69,19 @@ class MpmcEagerWaiter {
         if (state_.compare_exchange_strong(state, State::asleep(), std::memory_order_acq_rel)) {
           condition_variable_.wait(lock);
         }
+        slot.rounds_till_sleepy = std::max(slot.rounds_till_sleepy / 2, static_cast<int>(MinRoundsTillSleepy));
       }
       slot.yields = 0;
     }
   }
 
   void stop_wait(Slot &slot) {
-    if (slot.yields > RoundsTillSleepy) {
+    if (slot.yields > slot.rounds_till_sleepy) {
       notify_cold();
     }
+    if (slot.yields * 2 > slot.rounds_till_sleepy) {
+      slot.rounds_till_sleepy = std::min(slot.rounds_till_sleepy * 2, static_cast<int>(MaxRoundsTillSleepy));
+    }
     slot.yields = 0;
   }
 
@@ -109,8 +117,8 @@ class MpmcEagerWaiter {
       return (state >> 1) == (worker + 1);
     }
   };
-  enum { RoundsTillSleepy = 32, RoundsTillAsleep = 64 };
-  // enum { RoundsTillSleepy = 1, RoundsTillAsleep = 2 };
+  enum { RoundsTillSleepy = 32, MinRoundsTillSleepy = 4, MaxRoundsTillSleepy = 256 };
+  // enum { RoundsTillSleepy = 1, MinRoundsTillSleepy = 1, MaxRoundsTillSleepy = 1 };
   std::atomic<uint32> state_{State::awake()};
   std::mutex mutex_;
   std::condition_variable condition_variable_;
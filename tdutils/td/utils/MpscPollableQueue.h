@@ -63,6 +63,26 @@ class MpscPollableQueue {
       event_fd_.release();
     }
   }
+  // moves all values to the queue under one lock with at most one wakeup of the reader
+  void writer_put_batch(std::vector<ValueType> &values) {
+    if (values.empty()) {
+      return;
+    }
+    auto guard = lock_.lock();
+    if (writer_vector_.empty()) {
+      std::swap(writer_vector_, values);
+    } else {
+      for (auto &value : values) {
+        writer_vector_.push_back(std::move(value));
+      }
+    }
+    values.clear();
+    if (wait_event_fd_) {
+      wait_event_fd_ = false;
+      guard.reset();
+      event_fd_.release();
+    }
+  }
   EventFd &reader_get_event_fd() {
     return event_fd_;
   }
@@ -128,6 +148,10 @@ class MpscPollableQueue {
     UNREACHABLE();
   }
 
+  void writer_put_batch(std::vector<ValueType> &values) {
+    UNREACHABLE();
+  }
+
   void writer_flush() {
     UNREACHABLE();
   }
@@ -31,7 +31,7 @@ void Random::secure_bytes(MutableSlice dest) {
 }
 
 void Random::secure_bytes(unsigned char *ptr, size_t size) {
-  constexpr size_t BUF_SIZE = 512;
+  constexpr size_t BUF_SIZE = 4096;
   static TD_THREAD_LOCAL unsigned char *buf;  // static zero-initialized
   static TD_THREAD_LOCAL size_t buf_pos;
   static TD_THREAD_LOCAL int64 generation;
@@ -178,6 +178,10 @@ class SharedSlice {
     return SharedSlice(impl_.clone());
   }
 
+  bool is_unique() const {
+    return impl_.is_unique();
+  }
+
   Slice as_slice() const {
     return impl_.as_slice();
   }
@@ -0,0 +1,76 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/SharedStringPool.h"
+
+#include "td/utils/algorithm.h"
+#include "td/utils/logging.h"
+
+namespace td {
+
+SharedSlice SharedStringPool::intern(Slice str) {
+  if (str.empty()) {
+    return SharedSlice();
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  intern_count_++;
+  auto it = strings_.find(str);
+  if (it != strings_.end()) {
+    hit_count_++;
+    saved_size_ += str.size();
+    return it->second.clone();
+  }
+
+  if (strings_.size() >= gc_string_count_) {
+    // amortized O(1), because the pool size doubles between full scans
+    do_gc();
+    gc_string_count_ = max(strings_.size() * 2, MIN_GC_STRING_COUNT);
+  }
+
+  SharedSlice result(str);
+  auto key = result.as_slice();
+  total_size_ += key.size();
+  strings_.emplace(key, result.clone());
+  return result;
+}
+
+size_t SharedStringPool::gc() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return do_gc();
+}
+
+size_t SharedStringPool::do_gc() {
+  auto old_size = strings_.size();
+  table_remove_if(strings_, [&](const auto &it) {
+    if (!it.second.is_unique()) {
+      return false;
+    }
+    CHECK(total_size_ >= it.first.size());
+    total_size_ -= it.first.size();
+    return true;
+  });
+  return old_size - strings_.size();
+}
+
+SharedStringPool::Stats SharedStringPool::get_stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats;
+  stats.string_count = strings_.size();
+  stats.total_size = total_size_;
+  stats.intern_count = intern_count_;
+  stats.hit_count = hit_count_;
+  stats.saved_size = saved_size_;
+  return stats;
+}
+
+StringBuilder &operator<<(StringBuilder &string_builder, const SharedStringPool::Stats &stats) {
+  return string_builder << "SharedStringPool[strings = " << stats.string_count << ", size = " << stats.total_size
+                        << ", interned = " << stats.intern_count << ", hits = " << stats.hit_count
+                        << ", saved = " << stats.saved_size << ']';
+}
+
+}  // namespace td
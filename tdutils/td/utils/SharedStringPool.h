@@ -0,0 +1,61 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
+#include "td/utils/SharedSlice.h"
+#include "td/utils/Slice.h"
+#include "td/utils/StringBuilder.h"
+
+#include <mutex>
+
+namespace td {
+
+// Thread-safe pool of immutable reference-counted strings. Equal strings interned through the pool share
+// the same memory. Strings, which are referenced only by the pool, are removed from it from time to time.
+class SharedStringPool {
+ public:
+  struct Stats {
+    size_t string_count = 0;
+    size_t total_size = 0;
+    uint64 intern_count = 0;
+    uint64 hit_count = 0;
+    uint64 saved_size = 0;  // total size of strings, which weren't allocated because of the pool
+  };
+
+  SharedStringPool() = default;
+  SharedStringPool(const SharedStringPool &) = delete;
+  SharedStringPool &operator=(const SharedStringPool &) = delete;
+  SharedStringPool(SharedStringPool &&) = delete;
+  SharedStringPool &operator=(SharedStringPool &&) = delete;
+  ~SharedStringPool() = default;
+
+  SharedSlice intern(Slice str);
+
+  // removes strings, which aren't referenced outside of the pool, and returns the number of removed strings
+  size_t gc();
+
+  Stats get_stats() const;
+
+ private:
+  static constexpr size_t MIN_GC_STRING_COUNT = 1000;
+
+  mutable std::mutex mutex_;
+  FlatHashMap<Slice, SharedSlice, SliceHash> strings_;
+  size_t total_size_ = 0;
+  size_t gc_string_count_ = MIN_GC_STRING_COUNT;
+  uint64 intern_count_ = 0;
+  uint64 hit_count_ = 0;
+  uint64 saved_size_ = 0;
+
+  size_t do_gc();
+};
+
+StringBuilder &operator<<(StringBuilder &string_builder, const SharedStringPool::Stats &stats);
+
+}  // namespace td
@@ -199,6 +199,12 @@ class Status {
     return status.clone_static(Code);
   }
 
+  // the returned error is never destroyed, so it must be stored in a static variable
+  // copies of the error created by clone() share its message and don't allocate memory
+  static Status StaticError(int err, Slice message) TD_WARN_UNUSED_RESULT {
+    return Status(true, ErrorType::General, err, message);
+  }
+
   StringBuilder &print(StringBuilder &sb) const {
     if (is_ok()) {
       return sb << "OK";
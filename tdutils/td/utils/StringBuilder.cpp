@@ -79,18 +79,29 @@ static char *print_uint(char *current_ptr, T x) {
     return current_ptr;
   }
 
-  auto begin_ptr = current_ptr;
-  do {
-    *current_ptr++ = static_cast<char>('0' + x % 10);
-    x /= 10;
-  } while (x > 0);
-
-  auto end_ptr = current_ptr - 1;
-  while (begin_ptr < end_ptr) {
-    std::swap(*begin_ptr++, *end_ptr--);
+  // digits are written from the end two at a time
+  static const char digit_pairs[] =
+      "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+      "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+  char buf[24];
+  auto end_ptr = buf + sizeof(buf);
+  auto ptr = end_ptr;
+  while (x >= 100) {
+    auto pair = static_cast<size_t>(x % 100) * 2;
+    x /= 100;
+    *--ptr = digit_pairs[pair + 1];
+    *--ptr = digit_pairs[pair];
+  }
+  if (x < 10) {
+    *--ptr = static_cast<char>('0' + x);
+  } else {
+    auto pair = static_cast<size_t>(x) * 2;
+    *--ptr = digit_pairs[pair + 1];
+    *--ptr = digit_pairs[pair];
   }
-
-  return current_ptr;
+  auto length = static_cast<size_t>(end_ptr - ptr);
+  std::memcpy(current_ptr, ptr, length);
+  return current_ptr + length;
 }
 
 template <class T>
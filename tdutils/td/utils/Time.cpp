@@ -7,6 +7,7 @@
 #include "td/utils/Time.h"
 
 #include "td/utils/port/Clocks.h"
+#include "td/utils/port/thread_local.h"
 
 #include <atomic>
 #include <cmath>
@@ -29,6 +30,25 @@ double Time::now() {
   return result;
 }
 
+static TD_THREAD_LOCAL double cached_now;
+
+double Time::now_cached() {
+  auto result = cached_now;
+  if (result > 0) {
+    return result;
+  }
+  return now();
+}
+
+double Time::update_now_cached() {
+  cached_now = now();
+  return cached_now;
+}
+
+void Time::reset_now_cached() {
+  cached_now = 0.0;
+}
+
 double Time::now_unadjusted() {
   return Clocks::monotonic();
 }
@@ -37,13 +57,13 @@ void Time::jump_in_future(double at) {
   while (true) {
     auto old_time_diff = time_diff.load();
     auto diff = at - now();
-    if (diff < 0) {
-      return;
-    }
-    if (time_diff.compare_exchange_strong(old_time_diff, old_time_diff + diff)) {
-      return;
+    if (diff < 0 || time_diff.compare_exchange_strong(old_time_diff, old_time_diff + diff)) {
+      break;
     }
   }
+  if (cached_now > 0) {
+    update_now_cached();
+  }
 }
 
 }  // namespace td
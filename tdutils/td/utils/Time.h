@@ -13,20 +13,17 @@ namespace td {
 class Time {
  public:
   static double now();
-  static double now_cached() {
-    // Temporary(?) use now in now_cached
-    // Problem:
-    //   thread A: check that now() > timestamp and notifies thread B
-    //   thread B: must see that now() > timestamp()
-    //
-    //   now() and now_cached() must be monotonic
-    //
-    //   if a=now[_cached]() happens before b=now[_cached] than
-    //     a <= b
-    //
-    // As an alternative we may say that now_cached is a thread local copy of now
-    return now();
-  }
+  // Returns a thread local copy of now(), which is updated by the actor scheduler before each event is processed,
+  // or now() if there is no cached value. Events are processed only after they are sent, so if a=now[_cached]()
+  // happens before sending of an event, then a <= b=now_cached() during processing of the event.
+  // Use now() if the exact current time is needed.
+  static double now_cached();
+
+  // Caches the current time for the current thread until reset_now_cached() is called
+  static double update_now_cached();
+
+  static void reset_now_cached();
+
   static double now_unadjusted();
 
   // Used for testing. After jump_in_future(at) is called, now() >= at.
@@ -0,0 +1,249 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/TimerWheel.h"
+
+#include "td/utils/bits.h"
+#include "td/utils/logging.h"
+
+#include <limits>
+
+namespace td {
+
+TimerWheel::TimerWheel(double granularity) : granularity_(granularity) {
+  CHECK(granularity_ > 0);
+  for (auto &slot_head : slot_heads_) {
+    slot_head = -1;
+  }
+}
+
+double TimerWheel::get_key(const HeapNode *node) const {
+  auto item_id = static_cast<size_t>(node->pos_);
+  CHECK(item_id < items_.size());
+  return items_[item_id].key_;
+}
+
+void TimerWheel::insert(double key, HeapNode *node) {
+  CHECK(!node->in_heap());
+  int32 item_id;
+  if (free_item_id_ != -1) {
+    item_id = free_item_id_;
+    free_item_id_ = items_[item_id].next_;
+  } else {
+    item_id = static_cast<int32>(items_.size());
+    items_.emplace_back();
+  }
+  auto &item = items_[item_id];
+  item.key_ = key;
+  item.node_ = node;
+  node->pos_ = item_id;
+  size_++;
+  place(item_id);
+}
+
+void TimerWheel::fix(double key, HeapNode *node) {
+  auto item_id = node->pos_;
+  CHECK(static_cast<size_t>(item_id) < items_.size());
+  unlink(item_id);
+  items_[item_id].key_ = key;
+  place(item_id);
+}
+
+void TimerWheel::erase(HeapNode *node) {
+  auto item_id = node->pos_;
+  CHECK(static_cast<size_t>(item_id) < items_.size());
+  unlink(item_id);
+  auto &item = items_[item_id];
+  item.node_ = nullptr;
+  item.next_ = free_item_id_;
+  free_item_id_ = item_id;
+  node->remove();
+  size_--;
+}
+
+double TimerWheel::get_wakeup_time() const {
+  CHECK(!empty());
+  auto slot = static_cast<int32>(current_tick_ & (SLOT_COUNT - 1));
+  if (slot_heads_[slot] != -1) {
+    return get_min_key(slot);
+  }
+  auto next_tick = get_next_tick();
+  CHECK(next_tick != -1);
+  if ((next_tick >> LEVEL_BITS) == (current_tick_ >> LEVEL_BITS)) {
+    return get_min_key(static_cast<int32>(next_tick & (SLOT_COUNT - 1)));
+  }
+  // the nodes are in an upper level, so only a lower bound is returned
+  return static_cast<double>(next_tick) * granularity_;
+}
+
+HeapNode *TimerWheel::pop_expired(double now) {
+  auto now_tick = get_tick(now);
+  if (empty()) {
+    if (now_tick > current_tick_) {
+      set_current_tick(now_tick);
+    }
+    return nullptr;
+  }
+  while (true) {
+    auto slot = static_cast<int32>(current_tick_ & (SLOT_COUNT - 1));
+    for (auto item_id = slot_heads_[slot]; item_id != -1; item_id = items_[item_id].next_) {
+      if (items_[item_id].key_ < now) {
+        auto node = items_[item_id].node_;
+        erase(node);
+        return node;
+      }
+    }
+    if (current_tick_ >= now_tick) {
+      return nullptr;
+    }
+
+    // non-expired nodes can be left in the slot only because of rounding errors
+    bool need_replace = slot_heads_[slot] != -1;
+    auto next_tick = get_next_tick();
+    if (next_tick == -1 || next_tick > now_tick) {
+      set_current_tick(now_tick);
+    } else {
+      set_current_tick(next_tick);
+      cascade();
+    }
+    if (need_replace) {
+      replace_slot(slot);
+    }
+  }
+}
+
+int64 TimerWheel::get_tick(double key) const {
+  auto tick = key / granularity_;
+  if (!(tick > 0.0)) {
+    return 0;
+  }
+  if (tick > 1e18) {
+    return static_cast<int64>(1e18);
+  }
+  auto result = static_cast<int64>(tick);
+  // ensure that start of the tick isn't after the key despite rounding errors
+  while (result > 0 && static_cast<double>(result) * granularity_ > key) {
+    result--;
+  }
+  return result;
+}
+
+double TimerWheel::get_min_key(int32 slot) const {
+  auto result = std::numeric_limits<double>::infinity();
+  for (auto item_id = slot_heads_[slot]; item_id != -1; item_id = items_[item_id].next_) {
+    result = min(result, items_[item_id].key_);
+  }
+  return result;
+}
+
+void TimerWheel::place(int32 item_id) {
+  auto &item = items_[item_id];
+  auto tick = max(get_tick(item.key_), current_tick_);
+  int32 level = 0;
+  while (level < LEVEL_COUNT &&
+         (tick >> (LEVEL_BITS * (level + 1))) != (current_tick_ >> (LEVEL_BITS * (level + 1)))) {
+    level++;
+  }
+  if (level == LEVEL_COUNT) {
+    item.slot_ = OVERFLOW_SLOT;
+  } else {
+    auto index = static_cast<int32>((tick >> (LEVEL_BITS * level)) & (SLOT_COUNT - 1));
+    item.slot_ = level * SLOT_COUNT + index;
+    slot_bitmaps_[level][index / 64] |= static_cast<uint64>(1) << (index % 64);
+  }
+
+  auto &head = slot_heads_[item.slot_];
+  item.prev_ = -1;
+  item.next_ = head;
+  if (head != -1) {
+    items_[head].prev_ = item_id;
+  }
+  head = item_id;
+}
+
+void TimerWheel::unlink(int32 item_id) {
+  auto &item = items_[item_id];
+  if (item.prev_ != -1) {
+    items_[item.prev_].next_ = item.next_;
+  } else {
+    slot_heads_[item.slot_] = item.next_;
+  }
+  if (item.next_ != -1) {
+    items_[item.next_].prev_ = item.prev_;
+  }
+  if (slot_heads_[item.slot_] == -1 && item.slot_ != OVERFLOW_SLOT) {
+    auto level = item.slot_ / SLOT_COUNT;
+    auto index = item.slot_ % SLOT_COUNT;
+    slot_bitmaps_[level][index / 64] &= ~(static_cast<uint64>(1) << (index % 64));
+  }
+}
+
+void TimerWheel::replace_slot(int32 slot) {
+  auto item_id = slot_heads_[slot];
+  slot_heads_[slot] = -1;
+  if (slot != OVERFLOW_SLOT) {
+    auto level = slot / SLOT_COUNT;
+    auto index = slot % SLOT_COUNT;
+    slot_bitmaps_[level][index / 64] &= ~(static_cast<uint64>(1) << (index % 64));
+  }
+  while (item_id != -1) {
+    auto next_item_id = items_[item_id].next_;
+    place(item_id);
+    item_id = next_item_id;
+  }
+}
+
+int32 TimerWheel::find_slot(int32 level, int32 from_index) const {
+  for (auto word = from_index / 64; word < SLOT_COUNT / 64; word++) {
+    auto bits = slot_bitmaps_[level][word];
+    if (word == from_index / 64) {
+      bits &= ~static_cast<uint64>(0) << (from_index % 64);
+    }
+    if (bits != 0) {
+      return word * 64 + count_trailing_zeroes64(bits);
+    }
+  }
+  return -1;
+}
+
+int64 TimerWheel::get_next_tick() const {
+  for (int32 level = 0; level < LEVEL_COUNT; level++) {
+    auto shift = LEVEL_BITS * level;
+    auto index = static_cast<int32>((current_tick_ >> shift) & (SLOT_COUNT - 1));
+    auto next_index = find_slot(level, index + 1);
+    if (next_index != -1) {
+      auto window_start = (current_tick_ >> (shift + LEVEL_BITS)) << (shift + LEVEL_BITS);
+      return window_start + (static_cast<int64>(next_index) << shift);
+    }
+  }
+  if (slot_heads_[OVERFLOW_SLOT] == -1) {
+    return -1;
+  }
+  auto result = std::numeric_limits<int64>::max();
+  for (auto item_id = slot_heads_[OVERFLOW_SLOT]; item_id != -1; item_id = items_[item_id].next_) {
+    result = min(result, get_tick(items_[item_id].key_));
+  }
+  return max(result, current_tick_ + 1);
+}
+
+void TimerWheel::set_current_tick(int64 tick) {
+  auto old_tick = current_tick_;
+  current_tick_ = tick;
+  if ((old_tick >> (LEVEL_BITS * LEVEL_COUNT)) != (tick >> (LEVEL_BITS * LEVEL_COUNT))) {
+    replace_slot(OVERFLOW_SLOT);
+  }
+}
+
+void TimerWheel::cascade() {
+  for (int32 level = LEVEL_COUNT - 1; level > 0; level--) {
+    auto shift = LEVEL_BITS * level;
+    if ((current_tick_ & ((static_cast<int64>(1) << shift) - 1)) == 0) {
+      replace_slot(level * SLOT_COUNT + static_cast<int32>((current_tick_ >> shift) & (SLOT_COUNT - 1)));
+    }
+  }
+}
+
+}  // namespace td
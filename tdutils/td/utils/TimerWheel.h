@@ -0,0 +1,82 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Heap.h"
+
+namespace td {
+
+// Hierarchical timer wheel with O(1) insertion, update and removal of timeouts.
+// Uses the same nodes as KHeap, but allows to find only expired nodes instead of the node with the minimum key.
+class TimerWheel {
+ public:
+  explicit TimerWheel(double granularity = 0.001);
+
+  bool empty() const {
+    return size_ == 0;
+  }
+  size_t size() const {
+    return size_;
+  }
+
+  double get_key(const HeapNode *node) const;
+
+  void insert(double key, HeapNode *node);
+
+  void fix(double key, HeapNode *node);
+
+  void erase(HeapNode *node);
+
+  // returns a time not later than the minimum key; must not be called for an empty wheel
+  double get_wakeup_time() const;
+
+  // returns a node with key less than now, or nullptr if there are no such nodes
+  HeapNode *pop_expired(double now);
+
+ private:
+  static constexpr int32 LEVEL_BITS = 8;
+  static constexpr int32 LEVEL_COUNT = 4;
+  static constexpr int32 SLOT_COUNT = 1 << LEVEL_BITS;
+  static constexpr int32 OVERFLOW_SLOT = LEVEL_COUNT * SLOT_COUNT;
+
+  struct Item {
+    double key_;
+    HeapNode *node_;
+    int32 slot_;
+    int32 prev_;
+    int32 next_;
+  };
+
+  double granularity_;
+  int64 current_tick_ = 0;
+  size_t size_ = 0;
+  vector<Item> items_;
+  int32 free_item_id_ = -1;
+  int32 slot_heads_[OVERFLOW_SLOT + 1];
+  uint64 slot_bitmaps_[LEVEL_COUNT][SLOT_COUNT / 64] = {};
+
+  int64 get_tick(double key) const;
+
+  double get_min_key(int32 slot) const;
+
+  void place(int32 item_id);
+
+  void unlink(int32 item_id);
+
+  void replace_slot(int32 slot);
+
+  int32 find_slot(int32 level, int32 from_index) const;
+
+  int64 get_next_tick() const;
+
+  void set_current_tick(int64 tick);
+
+  void cascade();
+};
+
+}  // namespace td
@@ -161,6 +161,29 @@ class WaitFreeHashMap {
     }
   }
 
+  // frees unused memory; merges the storage back into a single table if there are few elements left
+  void shrink_to_fit() {
+    if (wait_free_storage_ == nullptr) {
+      default_map_.shrink_to_fit();
+      return;
+    }
+
+    auto size = calc_size();
+    if (size <= max_storage_size_ / 2) {
+      default_map_.reserve(size);
+      for (auto &storage : wait_free_storage_->maps_) {
+        storage.foreach([&](const KeyT &key, ValueT &value) { default_map_.emplace(key, std::move(value)); });
+      }
+      wait_free_storage_ = nullptr;
+      default_map_.shrink_to_fit();
+      return;
+    }
+
+    for (auto &storage : wait_free_storage_->maps_) {
+      storage.shrink_to_fit();
+    }
+  }
+
   size_t calc_size() const {
     if (wait_free_storage_ == nullptr) {
       return default_map_.size();
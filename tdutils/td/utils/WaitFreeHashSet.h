@@ -113,6 +113,29 @@ class WaitFreeHashSet {
     return *default_set_.begin();
   }
 
+  // frees unused memory; merges the storage back into a single table if there are few elements left
+  void shrink_to_fit() {
+    if (wait_free_storage_ == nullptr) {
+      default_set_.shrink_to_fit();
+      return;
+    }
+
+    auto size = calc_size();
+    if (size <= max_storage_size_ / 2) {
+      default_set_.reserve(size);
+      for (auto &storage : wait_free_storage_->sets_) {
+        storage.foreach([&](const KeyT &key) { default_set_.insert(key); });
+      }
+      wait_free_storage_ = nullptr;
+      default_set_.shrink_to_fit();
+      return;
+    }
+
+    for (auto &storage : wait_free_storage_->sets_) {
+      storage.shrink_to_fit();
+    }
+  }
+
   size_t calc_size() const {
     if (wait_free_storage_ == nullptr) {
       return default_set_.size();
@@ -39,28 +39,35 @@ static const unsigned char *get_character_table() {
 template <bool is_url>
 string base64_encode_impl(Slice input) {
   auto characters = get_characters<is_url>();
-  string base64;
-  base64.reserve((input.size() + 2) / 3 * 4);
-  for (size_t i = 0; i < input.size();) {
-    size_t left = min(input.size() - i, static_cast<size_t>(3));
-    int c = input.ubegin()[i++] << 16;
-    base64 += characters[c >> 18];
-    if (left != 1) {
-      c |= input.ubegin()[i++] << 8;
-    }
-    base64 += characters[(c >> 12) & 63];
-    if (left == 3) {
-      c |= input.ubegin()[i++];
+  auto size = input.size();
+  auto left = size % 3;
+  auto full_size = size - left;
+  string base64(full_size / 3 * 4 + (left == 0 ? 0 : (is_url ? left + 1 : 4)), '\0');
+  auto *ptr = input.ubegin();
+  auto *out = &base64[0];
+  // the result is written directly by groups of 4 characters, because appending characters one by one is much slower
+  for (size_t i = 0; i < full_size; i += 3) {
+    auto c = (static_cast<uint32>(ptr[i]) << 16) | (static_cast<uint32>(ptr[i + 1]) << 8) | ptr[i + 2];
+    out[0] = characters[c >> 18];
+    out[1] = characters[(c >> 12) & 63];
+    out[2] = characters[(c >> 6) & 63];
+    out[3] = characters[c & 63];
+    out += 4;
+  }
+  if (left != 0) {
+    auto c = static_cast<uint32>(ptr[full_size]) << 16;
+    if (left == 2) {
+      c |= static_cast<uint32>(ptr[full_size + 1]) << 8;
     }
-    if (left != 1) {
-      base64 += characters[(c >> 6) & 63];
+    *out++ = characters[c >> 18];
+    *out++ = characters[(c >> 12) & 63];
+    if (left == 2) {
+      *out++ = characters[(c >> 6) & 63];
     } else if (!is_url) {
-      base64 += '=';
+      *out++ = '=';
     }
-    if (left == 3) {
-      base64 += characters[c & 63];
-    } else if (!is_url) {
-      base64 += '=';
+    if (!is_url) {
+      *out++ = '=';
     }
   }
   return base64;
@@ -94,7 +101,23 @@ Result<Slice> base64_drop_padding(Slice base64) {
 }
 
 static Status do_base64_decode_impl(Slice base64, const unsigned char *table, char *ptr) {
-  for (size_t i = 0; i < base64.size();) {
+  auto full_size = base64.size() & ~static_cast<size_t>(3);
+  auto *input = base64.ubegin();
+  for (size_t i = 0; i < full_size; i += 4) {
+    uint32 a = table[input[i]];
+    uint32 b = table[input[i + 1]];
+    uint32 c = table[input[i + 2]];
+    uint32 d = table[input[i + 3]];
+    if (((a | b | c | d) & 64) != 0) {
+      return Status::Error("Wrong character in the string");
+    }
+    auto value = (a << 18) | (b << 12) | (c << 6) | d;
+    ptr[0] = static_cast<char>(static_cast<unsigned char>(value >> 16));  // implementation-defined
+    ptr[1] = static_cast<char>(static_cast<unsigned char>(value >> 8));   // implementation-defined
+    ptr[2] = static_cast<char>(static_cast<unsigned char>(value));        // implementation-defined
+    ptr += 3;
+  }
+  for (size_t i = full_size; i < base64.size();) {
     size_t left = min(base64.size() - i, static_cast<size_t>(4));
     int c = 0;
     for (size_t t = 0; t < left; t++) {
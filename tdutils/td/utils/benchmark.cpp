@@ -0,0 +1,130 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/benchmark.h"
+
+#include "td/utils/common.h"
+#include "td/utils/format.h"
+#include "td/utils/JsonBuilder.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/config.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/Slice.h"
+#include "td/utils/Status.h"
+#include "td/utils/StringBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <tuple>
+
+namespace td {
+
+static int get_benchmark_option(const char *name, int default_value) {
+  const char *value = std::getenv(name);
+  if (value == nullptr || value[0] == '\0') {
+    return default_value;
+  }
+  return to_integer<int>(Slice(value));
+}
+
+static BenchmarkOptions init_benchmark_options() {
+  BenchmarkOptions options;
+  const char *format = std::getenv("TD_BENCH_FORMAT");
+  options.json_output = format != nullptr && Slice(format) == "json";
+  options.repetition_count = max(get_benchmark_option("TD_BENCH_REPETITIONS", options.repetition_count), 1);
+  options.warmup_count = max(get_benchmark_option("TD_BENCH_WARMUP", options.warmup_count), 0);
+  options.cpu = get_benchmark_option("TD_BENCH_CPU", options.cpu);
+  if (options.cpu >= 0) {
+#if !TD_THREAD_UNSUPPORTED
+    auto status = options.cpu < 64
+                      ? thread::set_affinity_mask(this_thread::get_id(), static_cast<uint64>(1) << options.cpu)
+                      : Status::Error("Too big CPU number specified");
+    LOG_IF(ERROR, status.is_error()) << "Failed to pin benchmark thread to CPU " << options.cpu << ": " << status;
+#endif
+  }
+  return options;
+}
+
+BenchmarkOptions &get_benchmark_options() {
+  static BenchmarkOptions options = init_benchmark_options();
+  return options;
+}
+
+void print_benchmark_result(const string &description, vector<double> ops_per_second) {
+  CHECK(!ops_per_second.empty());
+  std::sort(ops_per_second.begin(), ops_per_second.end());
+  auto repetition_count = ops_per_second.size();
+
+  double sum = 0.0;
+  double square_sum = 0.0;
+  for (auto value : ops_per_second) {
+    sum += value;
+    square_sum += value * value;
+  }
+  double average = sum / static_cast<double>(repetition_count);
+  double d = std::sqrt(max(square_sum / static_cast<double>(repetition_count) - average * average, 0.0));
+  double min_value = ops_per_second[0];
+  double max_value = ops_per_second.back();
+
+  if (get_benchmark_options().json_output) {
+    auto get_percentile = [&](size_t percent) {
+      auto rank = (percent * repetition_count + 99) / 100;
+      return ops_per_second[rank == 0 ? 0 : rank - 1];
+    };
+    LOG(PLAIN) << json_encode<string>(json_object([&](auto &o) {
+      o("benchmark", description);
+      o("unit", "ops/sec");
+      o("repetitions", narrow_cast<int32>(repetition_count));
+      o("mean", average);
+      o("stdev", d);
+      o("min", min_value);
+      o("max", max_value);
+      o("p50", get_percentile(50));
+      o("p90", get_percentile(90));
+      o("p99", get_percentile(99));
+    }));
+    return;
+  }
+
+  string pad;
+  if (description.size() < 40) {
+    pad = string(40 - description.size(), ' ');
+  }
+
+  LOG(ERROR) << "Bench [" << pad << description << "]: " << StringBuilder::FixedDouble(average, 3) << '['
+             << StringBuilder::FixedDouble(min_value, 3) << '-' << StringBuilder::FixedDouble(max_value, 3)
+             << "] ops/sec,\t" << format::as_time(1 / average) << " [d = " << StringBuilder::FixedDouble(d, 6) << ']';
+}
+
+void bench(Benchmark &b, double max_time) {
+  const auto &options = get_benchmark_options();
+
+  int n = 1;
+  double pass_time = 0;
+  double total_pass_time = 0;
+  while (pass_time < max_time && total_pass_time < max_time * 3 && n < (1 << 30)) {
+    n *= 2;
+    std::tie(pass_time, total_pass_time) = bench_n(b, n);
+  }
+
+  // without explicit warmup the last calibration pass is used as the first repetition
+  vector<double> ops_per_second;
+  if (options.warmup_count == 0) {
+    ops_per_second.push_back(n / pass_time);
+  }
+  for (int i = 0; i < options.warmup_count; i++) {
+    bench_n(b, n);
+  }
+  while (ops_per_second.size() < static_cast<size_t>(options.repetition_count)) {
+    ops_per_second.push_back(n / bench_n(b, n).first);
+  }
+
+  print_benchmark_result(b.get_description(), std::move(ops_per_second));
+}
+
+}  // namespace td
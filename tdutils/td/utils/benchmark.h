@@ -6,14 +6,11 @@
 //
 #pragma once
 
-#include "td/utils/format.h"
-#include "td/utils/logging.h"
 #include "td/utils/port/Clocks.h"
-#include "td/utils/StringBuilder.h"
 
-#include <cmath>
-#include <tuple>
+#include <string>
 #include <utility>
+#include <vector>
 
 #define BENCH(name, desc)                            \
   class name##Bench final : public ::td::Benchmark { \
@@ -84,46 +81,21 @@ inline std::pair<double, double> bench_n(Benchmark &&b, int n) {
   return bench_n(b, n);
 }
 
-inline void bench(Benchmark &b, double max_time = 1.0) {
-  int n = 1;
-  double pass_time = 0;
-  double total_pass_time = 0;
-  while (pass_time < max_time && total_pass_time < max_time * 3 && n < (1 << 30)) {
-    n *= 2;
-    std::tie(pass_time, total_pass_time) = bench_n(b, n);
-  }
-  pass_time = n / pass_time;
-
-  int pass_cnt = 2;
-  double sum = pass_time;
-  double square_sum = pass_time * pass_time;
-  double min_pass_time = pass_time;
-  double max_pass_time = pass_time;
-
-  for (int i = 1; i < pass_cnt; i++) {
-    pass_time = n / bench_n(b, n).first;
-    sum += pass_time;
-    square_sum += pass_time * pass_time;
-    if (pass_time < min_pass_time) {
-      min_pass_time = pass_time;
-    }
-    if (pass_time > max_pass_time) {
-      max_pass_time = pass_time;
-    }
-  }
-  double average = sum / pass_cnt;
-  double d = sqrt(square_sum / pass_cnt - average * average);
+// benchmark options are initialized from the environment variables TD_BENCH_FORMAT ("text" or "json"),
+// TD_BENCH_REPETITIONS, TD_BENCH_WARMUP and TD_BENCH_CPU; the calling thread is pinned to the specified CPU
+struct BenchmarkOptions {
+  bool json_output = false;
+  int repetition_count = 2;
+  int warmup_count = 0;
+  int cpu = -1;
+};
 
-  auto description = b.get_description();
-  std::string pad;
-  if (description.size() < 40) {
-    pad = std::string(40 - description.size(), ' ');
-  }
+BenchmarkOptions &get_benchmark_options();
 
-  LOG(ERROR) << "Bench [" << pad << description << "]: " << StringBuilder::FixedDouble(average, 3) << '['
-             << StringBuilder::FixedDouble(min_pass_time, 3) << '-' << StringBuilder::FixedDouble(max_pass_time, 3)
-             << "] ops/sec,\t" << format::as_time(1 / average) << " [d = " << StringBuilder::FixedDouble(d, 6) << ']';
-}
+// prints statistics of operations per second measured in each repetition of the benchmark
+void print_benchmark_result(const std::string &description, std::vector<double> ops_per_second);
+
+void bench(Benchmark &b, double max_time = 1.0);
 
 inline void bench(Benchmark &&b, double max_time = 1.0) {
   bench(b, max_time);
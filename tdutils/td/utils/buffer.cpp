@@ -10,6 +10,7 @@
 #include "td/utils/port/thread_local.h"
 
 #include <cstddef>
+#include <mutex>
 #include <new>
 
 // fixes https://bugs.llvm.org/show_bug.cgi?id=33723 for clang >= 3.6 + c++11 + libc++
@@ -21,6 +22,152 @@
 
 namespace td {
 
+namespace {
+
+constexpr size_t BUFFER_MIN_SIZE_LOG = 9;
+constexpr size_t BUFFER_SIZE_CLASS_COUNT = 6;  // from 512 to 16384 bytes of data
+constexpr size_t BUFFER_MAX_CACHED_SIZE = 1 << 18;
+constexpr size_t BUFFER_MAX_DEPOT_BATCH_COUNT = 32;
+
+struct FreeBufferNode {
+  FreeBufferNode *next;
+  FreeBufferNode *next_batch;  // used only for the first node of a batch in the depot
+  size_t batch_size;
+};
+
+size_t get_buffer_size_class(size_t size) {
+  size_t size_class = 0;
+  while (size_class < BUFFER_SIZE_CLASS_COUNT && size > (static_cast<size_t>(1) << (size_class + BUFFER_MIN_SIZE_LOG))) {
+    size_class++;
+  }
+  return size_class;
+}
+
+size_t get_buffer_max_cached_count(size_t size_class) {
+  return BUFFER_MAX_CACHED_SIZE >> (size_class + BUFFER_MIN_SIZE_LOG);
+}
+
+// shared storage of batches of freed buffers, which are moved between threads
+// buffers are often allocated by network threads and freed by the thread of Td
+class BufferRawDepot {
+  struct SizeClass {
+    std::mutex mutex;
+    FreeBufferNode *batches = nullptr;
+    size_t batch_count = 0;
+  };
+  SizeClass size_classes_[BUFFER_SIZE_CLASS_COUNT];
+
+ public:
+  // returns the batch, if it wasn't taken
+  FreeBufferNode *put_batch(size_t size_class, FreeBufferNode *batch, size_t batch_size) {
+    auto &info = size_classes_[size_class];
+    std::lock_guard<std::mutex> guard(info.mutex);
+    if (info.batch_count >= BUFFER_MAX_DEPOT_BATCH_COUNT) {
+      return batch;
+    }
+    batch->next_batch = info.batches;
+    batch->batch_size = batch_size;
+    info.batches = batch;
+    info.batch_count++;
+    return nullptr;
+  }
+
+  FreeBufferNode *get_batch(size_t size_class, size_t &batch_size) {
+    auto &info = size_classes_[size_class];
+    std::lock_guard<std::mutex> guard(info.mutex);
+    auto batch = info.batches;
+    if (batch == nullptr) {
+      return nullptr;
+    }
+    info.batches = batch->next_batch;
+    info.batch_count--;
+    batch_size = batch->batch_size;
+    return batch;
+  }
+
+  static BufferRawDepot *get() {
+    // never destroyed, because buffers can be freed during destruction of static objects
+    static auto *depot = new BufferRawDepot();
+    return depot;
+  }
+};
+
+void free_buffer_nodes(FreeBufferNode *node) {
+  while (node != nullptr) {
+    auto next = node->next;
+    delete[] reinterpret_cast<char *>(node);
+    node = next;
+  }
+}
+
+// per-thread cache of freed buffers of small sizes
+class BufferRawCache {
+  FreeBufferNode *free_lists_[BUFFER_SIZE_CLASS_COUNT] = {};
+  size_t free_counts_[BUFFER_SIZE_CLASS_COUNT] = {};
+
+  // detaches and returns the first count buffers from the free list
+  FreeBufferNode *cut_batch(size_t size_class, size_t count) {
+    auto &free_list = free_lists_[size_class];
+    auto batch = free_list;
+    auto last = batch;
+    for (size_t i = 1; i < count; i++) {
+      last = last->next;
+    }
+    free_list = last->next;
+    last->next = nullptr;
+    free_counts_[size_class] -= count;
+    return batch;
+  }
+
+ public:
+  BufferRawCache() = default;
+  BufferRawCache(const BufferRawCache &) = delete;
+  BufferRawCache &operator=(const BufferRawCache &) = delete;
+  BufferRawCache(BufferRawCache &&) = delete;
+  BufferRawCache &operator=(BufferRawCache &&) = delete;
+  ~BufferRawCache() {
+    auto depot = BufferRawDepot::get();
+    for (size_t size_class = 0; size_class < BUFFER_SIZE_CLASS_COUNT; size_class++) {
+      auto count = free_counts_[size_class];
+      if (count != 0) {
+        free_buffer_nodes(depot->put_batch(size_class, cut_batch(size_class, count), count));
+      }
+    }
+  }
+
+  void *allocate(size_t size_class) {
+    auto &free_list = free_lists_[size_class];
+    if (free_list == nullptr) {
+      size_t batch_size = 0;
+      free_list = BufferRawDepot::get()->get_batch(size_class, batch_size);
+      if (free_list == nullptr) {
+        return nullptr;
+      }
+      free_counts_[size_class] = batch_size;
+    }
+    auto result = free_list;
+    free_list = result->next;
+    free_counts_[size_class]--;
+    return result;
+  }
+
+  void free(size_t size_class, void *ptr) {
+    auto node = static_cast<FreeBufferNode *>(ptr);
+    node->next = free_lists_[size_class];
+    free_lists_[size_class] = node;
+    auto max_count = get_buffer_max_cached_count(size_class);
+    if (++free_counts_[size_class] > max_count) {
+      // give a half of the buffers to the threads, which allocate them
+      auto batch_size = max_count / 2;
+      free_buffer_nodes(BufferRawDepot::get()->put_batch(size_class, cut_batch(size_class, batch_size), batch_size));
+    }
+  }
+};
+
+TD_THREAD_LOCAL BufferRawCache *buffer_raw_cache;  // static zero-initialized
+
+}  // namespace
+
 TD_THREAD_LOCAL BufferAllocator::BufferRawTls *BufferAllocator::buffer_raw_tls;  // static zero-initialized
 
 std::atomic<size_t> BufferAllocator::buffer_mem;
@@ -91,8 +238,14 @@ void BufferAllocator::dec_ref_cnt(BufferRaw *ptr) {
   if (left == 1) {
     auto buf_size = max(sizeof(BufferRaw), TD_OFFSETOF(BufferRaw, data_) + ptr->data_size_);
     buffer_mem -= buf_size;
+    auto size_class = get_buffer_size_class(ptr->data_size_);
     ptr->~BufferRaw();
-    delete[] ptr;
+    // buffers can be freed on any thread; the cache isn't created there to avoid its creation during thread exit
+    if (size_class < BUFFER_SIZE_CLASS_COUNT && buffer_raw_cache != nullptr) {
+      buffer_raw_cache->free(size_class, ptr);
+    } else {
+      delete[] reinterpret_cast<char *>(ptr);
+    }
   }
 }
 
@@ -110,8 +263,20 @@ BufferRaw *BufferAllocator::create_buffer_raw(size_t size) {
     buf_size = sizeof(BufferRaw);
   }
   buffer_mem += buf_size;
-  auto *buffer_raw = reinterpret_cast<BufferRaw *>(new char[buf_size]);
-  return new (buffer_raw) BufferRaw(size);
+
+  void *ptr = nullptr;
+  auto size_class = get_buffer_size_class(size);
+  if (size_class < BUFFER_SIZE_CLASS_COUNT) {
+    // all buffers of a size class have the same capacity, so they can be reused for any size from the class
+    init_thread_local<BufferRawCache>(buffer_raw_cache);
+    ptr = buffer_raw_cache->allocate(size_class);
+    if (ptr == nullptr) {
+      ptr = new char[TD_OFFSETOF(BufferRaw, data_) + (static_cast<size_t>(1) << (size_class + BUFFER_MIN_SIZE_LOG))];
+    }
+  } else {
+    ptr = new char[buf_size];
+  }
+  return new (ptr) BufferRaw(size);
 }
 
 void BufferBuilder::append(BufferSlice slice) {
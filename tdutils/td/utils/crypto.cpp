@@ -18,6 +18,7 @@
 #include "td/utils/Random.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/SharedSlice.h"
+#include "td/utils/Span.h"
 #include "td/utils/StackAllocator.h"
 #include "td/utils/StringBuilder.h"
 
@@ -48,6 +49,24 @@
 #include "crc32c/crc32c.h"
 #endif
 
+#if (TD_GCC || TD_CLANG) && defined(__x86_64__) || TD_MSVC && defined(_M_X64)
+#define TD_X86_64_SIMD 1
+#if TD_MSVC
+#include <intrin.h>
+#define TD_X86_64_TARGET(features)
+#else
+#include <cpuid.h>
+#define TD_X86_64_TARGET(features) __attribute__((target(features)))
+#endif
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#else
+#define TD_X86_64_SIMD 0
+#endif
+
+#define TD_AES_NI (TD_HAVE_OPENSSL && TD_X86_64_SIMD)
+#define TD_CRC32_PCLMUL (TD_HAVE_ZLIB && TD_X86_64_SIMD)
+
 #include <algorithm>
 #include <cerrno>
 #include <cstring>
@@ -56,6 +75,31 @@
 
 namespace td {
 
+#if TD_AES_NI || TD_CRC32_PCLMUL
+enum class CpuFeature : int32 { Pclmulqdq = 1, Aes = 25 };
+
+// checks the feature flag, returned in ECX by CPUID with EAX == 1
+static bool has_cpu_feature(CpuFeature feature) {
+  static const uint32 flags = [] {
+#if TD_MSVC
+    int cpu_info[4];
+    __cpuid(cpu_info, 1);
+    return static_cast<uint32>(cpu_info[2]);
+#else
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+      return 0u;
+    }
+    return static_cast<uint32>(ecx);
+#endif
+  }();
+  return ((flags >> static_cast<int32>(feature)) & 1) != 0;
+}
+#endif
+
 static uint64 pq_gcd(uint64 a, uint64 b) {
   if (a == 0) {
     return b;
@@ -462,14 +506,93 @@ void AesState::decrypt(const uint8 *src, uint8 *dst, int size) {
   impl_->evp.decrypt(src, dst, size);
 }
 
+#if TD_AES_NI
+TD_X86_64_TARGET("aes,sse2") static __m128i aes_ni_expand_key(__m128i key, __m128i assist) {
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+// AES-256 decryption with round keys kept in registers; IGE decryption can't be done by OpenSSL in batches,
+// because each block depends on the previous plaintext, so a call to EVP_DecryptUpdate per block is avoided
+class AesNiIgeDecryptor {
+ public:
+  TD_X86_64_TARGET("aes,sse2") void init(Slice key) {
+    CHECK(key.size() == 32);
+    __m128i keys[15];
+    keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key.ubegin()));
+    keys[1] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key.ubegin() + 16));
+#define TD_AES_NI_EXPAND_KEY(i, rcon, shuffle) \
+  keys[i] = aes_ni_expand_key(keys[i - 2], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(keys[i - 1], rcon), shuffle))
+    TD_AES_NI_EXPAND_KEY(2, 0x01, 0xff);
+    TD_AES_NI_EXPAND_KEY(3, 0x00, 0xaa);
+    TD_AES_NI_EXPAND_KEY(4, 0x02, 0xff);
+    TD_AES_NI_EXPAND_KEY(5, 0x00, 0xaa);
+    TD_AES_NI_EXPAND_KEY(6, 0x04, 0xff);
+    TD_AES_NI_EXPAND_KEY(7, 0x00, 0xaa);
+    TD_AES_NI_EXPAND_KEY(8, 0x08, 0xff);
+    TD_AES_NI_EXPAND_KEY(9, 0x00, 0xaa);
+    TD_AES_NI_EXPAND_KEY(10, 0x10, 0xff);
+    TD_AES_NI_EXPAND_KEY(11, 0x00, 0xaa);
+    TD_AES_NI_EXPAND_KEY(12, 0x20, 0xff);
+    TD_AES_NI_EXPAND_KEY(13, 0x00, 0xaa);
+    TD_AES_NI_EXPAND_KEY(14, 0x40, 0xff);
+#undef TD_AES_NI_EXPAND_KEY
+
+    round_keys_[0] = keys[14];
+    for (int i = 1; i < 14; i++) {
+      round_keys_[i] = _mm_aesimc_si128(keys[14 - i]);
+    }
+    round_keys_[14] = keys[0];
+  }
+
+  TD_X86_64_TARGET("aes,sse2") void decrypt(const uint8 *in, uint8 *out, size_t len, AesBlock &encrypted_iv,
+                                AesBlock &plaintext_iv) const {
+    __m128i round_keys[15];
+    for (int i = 0; i < 15; i++) {
+      round_keys[i] = round_keys_[i];
+    }
+    auto encrypted_iv_block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(encrypted_iv.raw()));
+    auto plaintext_iv_block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(plaintext_iv.raw()));
+    while (len != 0) {
+      auto encrypted = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+      auto block = _mm_xor_si128(_mm_xor_si128(encrypted, plaintext_iv_block), round_keys[0]);
+      for (int i = 1; i < 14; i++) {
+        block = _mm_aesdec_si128(block, round_keys[i]);
+      }
+      block = _mm_aesdeclast_si128(block, round_keys[14]);
+      plaintext_iv_block = _mm_xor_si128(block, encrypted_iv_block);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out), plaintext_iv_block);
+      encrypted_iv_block = encrypted;
+
+      --len;
+      in += AES_BLOCK_SIZE;
+      out += AES_BLOCK_SIZE;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(encrypted_iv.raw()), encrypted_iv_block);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(plaintext_iv.raw()), plaintext_iv_block);
+  }
+
+ private:
+  __m128i round_keys_[15];
+};
+#endif
+
 class AesIgeStateImpl {
  public:
   void init(Slice key, Slice iv, bool encrypt) {
     CHECK(key.size() == 32);
     CHECK(iv.size() == 32);
+#if TD_AES_NI
+    use_aes_ni_ = !encrypt && has_cpu_feature(CpuFeature::Aes);
+    if (use_aes_ni_) {
+      aes_ni_.init(key);
+    }
+#endif
     if (encrypt) {
       evp_.init_encrypt_cbc(key);
-    } else {
+    } else if (!use_aes_ni_) {
       evp_.init_decrypt_ecb(key);
     }
 
@@ -530,6 +653,13 @@ class AesIgeStateImpl {
     auto in = from.ubegin();
     auto out = to.ubegin();
 
+#if TD_AES_NI
+    if (use_aes_ni_) {
+      aes_ni_.decrypt(in, out, len, encrypted_iv_, plaintext_iv_);
+      return;
+    }
+#endif
+
     AesBlock encrypted;
 
     while (len) {
@@ -550,6 +680,10 @@ class AesIgeStateImpl {
 
  private:
   Evp evp_;
+#if TD_AES_NI
+  AesNiIgeDecryptor aes_ni_;
+#endif
+  bool use_aes_ni_ = false;
   AesBlock encrypted_iv_;
   AesBlock plaintext_iv_;
 };
@@ -721,7 +855,7 @@ void AesCtrState::decrypt(Slice from, MutableSlice to) {
 }
 
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
-static void make_digest(Slice data, MutableSlice output, const EVP_MD *evp_md) {
+static void make_digest(Span<Slice> parts, MutableSlice output, const EVP_MD *evp_md) {
   static TD_THREAD_LOCAL EVP_MD_CTX *ctx;
   if (unlikely(ctx == nullptr)) {
     ctx = EVP_MD_CTX_new();
@@ -733,8 +867,10 @@ static void make_digest(Slice data, MutableSlice output, const EVP_MD *evp_md) {
   }
   int res = EVP_DigestInit_ex(ctx, evp_md, nullptr);
   LOG_IF(FATAL, res != 1);
-  res = EVP_DigestUpdate(ctx, data.ubegin(), data.size());
-  LOG_IF(FATAL, res != 1);
+  for (auto &data : parts) {
+    res = EVP_DigestUpdate(ctx, data.ubegin(), data.size());
+    LOG_IF(FATAL, res != 1);
+  }
   res = EVP_DigestFinal_ex(ctx, output.ubegin(), nullptr);
   LOG_IF(FATAL, res != 1);
   EVP_MD_CTX_reset(ctx);
@@ -777,6 +913,28 @@ void sha256(Slice data, MutableSlice output) {
 #endif
 }
 
+void sha256(Slice prefix, Slice data, MutableSlice output) {
+  CHECK(output.size() >= 32);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
+  static TD_THREAD_LOCAL const EVP_MD *evp_md;
+  if (unlikely(evp_md == nullptr)) {
+    init_thread_local_evp_md(evp_md, "sha256");
+  }
+  Slice parts[] = {prefix, data};
+  make_digest(parts, output, evp_md);
+#else
+  SHA256_CTX ctx;
+  int err = SHA256_Init(&ctx);
+  LOG_IF(FATAL, err != 1);
+  err = SHA256_Update(&ctx, prefix.ubegin(), prefix.size());
+  LOG_IF(FATAL, err != 1);
+  err = SHA256_Update(&ctx, data.ubegin(), data.size());
+  LOG_IF(FATAL, err != 1);
+  err = SHA256_Final(output.ubegin(), &ctx);
+  LOG_IF(FATAL, err != 1);
+#endif
+}
+
 void sha512(Slice data, MutableSlice output) {
   CHECK(output.size() >= 64);
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
@@ -1208,8 +1366,71 @@ void clear_openssl_errors(Slice source) {
 #endif
 
 #if TD_HAVE_ZLIB
+#if TD_CRC32_PCLMUL
+TD_X86_64_TARGET("pclmul,sse2") static __m128i crc32_fold(__m128i x, __m128i k, __m128i y) {
+  return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11)), y);
+}
+
+// folds 64-byte blocks using carry-less multiplication as described in Intel's paper "Fast CRC Computation for
+// Generic Polynomials Using PCLMULQDQ Instruction"; size must be a multiple of 16 and not less than 64;
+// the CRC is passed and returned without the final inversion
+TD_X86_64_TARGET("pclmul,sse2") static uint32 crc32_pclmul(const uint8 *data, size_t size, uint32 crc) {
+  auto load = [](const uint8 *ptr) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+  };
+
+  auto x1 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(static_cast<int>(crc)));
+  auto x2 = load(data + 16);
+  auto x3 = load(data + 32);
+  auto x4 = load(data + 48);
+  data += 64;
+  size -= 64;
+
+  auto k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+  while (size >= 64) {
+    x1 = crc32_fold(x1, k1k2, load(data));
+    x2 = crc32_fold(x2, k1k2, load(data + 16));
+    x3 = crc32_fold(x3, k1k2, load(data + 32));
+    x4 = crc32_fold(x4, k1k2, load(data + 48));
+    data += 64;
+    size -= 64;
+  }
+
+  auto k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+  x1 = crc32_fold(x1, k3k4, x2);
+  x1 = crc32_fold(x1, k3k4, x3);
+  x1 = crc32_fold(x1, k3k4, x4);
+  while (size >= 16) {
+    x1 = crc32_fold(x1, k3k4, load(data));
+    data += 16;
+    size -= 16;
+  }
+
+  // fold 128 bits to 64 bits
+  auto mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k3k4, 0x10));
+  auto k5 = _mm_set_epi64x(0, 0x0163cd6124);
+  x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5, 0x00), _mm_srli_si128(x1, 4));
+
+  // Barrett reduction to 32 bits
+  auto poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+  auto x2_reduced = _mm_and_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10), mask32);
+  x1 = _mm_xor_si128(x1, _mm_clmulepi64_si128(x2_reduced, poly, 0x00));
+  return static_cast<uint32>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+}
+#endif
+
 uint32 crc32(Slice data) {
-  return static_cast<uint32>(::crc32(0, data.ubegin(), static_cast<uint32>(data.size())));
+  uLong crc = 0;
+#if TD_CRC32_PCLMUL
+  static constexpr size_t MIN_PCLMUL_SIZE = 64;
+  if (data.size() >= MIN_PCLMUL_SIZE && has_cpu_feature(CpuFeature::Pclmulqdq)) {
+    auto size = data.size() & ~static_cast<size_t>(15);
+    crc = ~crc32_pclmul(data.ubegin(), size, ~static_cast<uint32>(0));
+    data.remove_prefix(size);
+  }
+#endif
+  return static_cast<uint32>(::crc32(crc, data.ubegin(), static_cast<uint32>(data.size())));
 }
 #endif
 
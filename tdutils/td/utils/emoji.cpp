@@ -185,30 +185,28 @@ string remove_emoji_modifiers(Slice emoji, bool remove_selectors) {
 }
 
 void remove_emoji_modifiers_in_place(string &emoji, bool remove_selectors) {
-  static const Slice modifiers[] = {u8"\uFE0F" /* variation selector-16 */,
-                                    u8"\u200D\u2640" /* zero width joiner + female sign */,
-                                    u8"\u200D\u2642" /* zero width joiner + male sign */,
-                                    u8"\U0001F3FB" /* emoji modifier fitzpatrick type-1-2 */,
-                                    u8"\U0001F3FC" /* emoji modifier fitzpatrick type-3 */,
-                                    u8"\U0001F3FD" /* emoji modifier fitzpatrick type-4 */,
-                                    u8"\U0001F3FE" /* emoji modifier fitzpatrick type-5 */,
-                                    u8"\U0001F3FF" /* emoji modifier fitzpatrick type-6 */};
-  const size_t start_index = remove_selectors ? 0 : 1;
+  // all modifiers are found in a single pass by their first byte
+  auto size = emoji.size();
   size_t j = 0;
-  for (size_t i = 0; i < emoji.size();) {
-    bool is_found = false;
-    for (size_t k = start_index; k < sizeof(modifiers) / sizeof(*modifiers); k++) {
-      auto length = modifiers[k].size();
-      if (i + length <= emoji.size() && Slice(&emoji[i], length) == modifiers[k]) {
-        // skip the modifier
-        i += length;
-        is_found = true;
-        break;
-      }
+  for (size_t i = 0; i < size;) {
+    auto c = emoji[i];
+    if (c == '\xEF' && remove_selectors && i + 3 <= size && emoji[i + 1] == '\xB8' && emoji[i + 2] == '\x8F') {
+      // variation selector-16 \uFE0F
+      i += 3;
+      continue;
+    }
+    if (c == '\xE2' && i + 6 <= size && emoji[i + 1] == '\x80' && emoji[i + 2] == '\x8D' && emoji[i + 3] == '\xE2' &&
+        emoji[i + 4] == '\x99' && (emoji[i + 5] == '\x80' || emoji[i + 5] == '\x82')) {
+      // zero width joiner + female sign \u200D\u2640 or zero width joiner + male sign \u200D\u2642
+      i += 6;
+      continue;
     }
-    if (!is_found) {
-      emoji[j++] = emoji[i++];
+    if (c == '\xF0' && get_fitzpatrick_modifier(Slice(emoji).substr(i, 4)) != 0) {
+      // emoji modifier fitzpatrick \U0001F3FB-\U0001F3FF
+      i += 4;
+      continue;
     }
+    emoji[j++] = emoji[i++];
   }
   if (j != 0) {
     emoji.resize(j);
@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <cstdlib>
+#include <cstring>
 #include <limits>
 #include <mutex>
 
@@ -43,6 +44,102 @@ void set_log_message_callback(int max_verbosity_level, OnLogMessageCallback call
   on_log_message_callback = callback;
 }
 
+namespace detail {
+std::atomic<bool> has_log_tag_sampling{false};
+}  // namespace detail
+
+namespace {
+// trivially destructible, because lines can be logged during static destruction
+struct LogTagSampling {
+  static constexpr size_t MAX_TAG_SIZE = 32;
+
+  char tag[MAX_TAG_SIZE];
+  size_t tag_size = 0;
+  uint32 sample_rate = 0;
+  uint32 skipped_line_count = 0;
+  double max_lines_per_second = 0.0;
+  double available_line_count = 0.0;
+  double last_update_time = 0.0;
+
+  Slice get_tag() const {
+    return Slice(tag, tag_size);
+  }
+};
+
+constexpr size_t MAX_SAMPLED_LOG_TAGS = 32;
+std::mutex log_tag_sampling_mutex;
+LogTagSampling log_tag_samplings[MAX_SAMPLED_LOG_TAGS];
+size_t log_tag_sampling_count = 0;
+}  // namespace
+
+bool set_log_tag_sampling(Slice tag, int32 sample_rate, int32 max_lines_per_second) {
+  if (tag.empty() || tag.size() > LogTagSampling::MAX_TAG_SIZE) {
+    return false;
+  }
+  bool is_disabled = sample_rate <= 1 && max_lines_per_second <= 0;
+
+  std::lock_guard<std::mutex> lock(log_tag_sampling_mutex);
+  size_t pos = 0;
+  while (pos < log_tag_sampling_count && log_tag_samplings[pos].get_tag() != tag) {
+    pos++;
+  }
+  if (is_disabled) {
+    if (pos < log_tag_sampling_count) {
+      log_tag_samplings[pos] = log_tag_samplings[--log_tag_sampling_count];
+    }
+  } else {
+    if (pos == log_tag_sampling_count) {
+      if (log_tag_sampling_count == MAX_SAMPLED_LOG_TAGS) {
+        return false;
+      }
+      log_tag_sampling_count++;
+    }
+    auto &sampling = log_tag_samplings[pos];
+    std::memcpy(sampling.tag, tag.data(), tag.size());
+    sampling.tag_size = tag.size();
+    sampling.sample_rate = sample_rate <= 1 ? 0 : static_cast<uint32>(sample_rate);
+    sampling.skipped_line_count = 0;
+    sampling.max_lines_per_second = max_lines_per_second <= 0 ? 0.0 : static_cast<double>(max_lines_per_second);
+    sampling.available_line_count = sampling.max_lines_per_second;
+    sampling.last_update_time = Clocks::monotonic();
+  }
+  detail::has_log_tag_sampling.store(log_tag_sampling_count != 0, std::memory_order_relaxed);
+  return true;
+}
+
+bool detail::need_sampled_log_tag_line(Slice tag) {
+  std::lock_guard<std::mutex> lock(log_tag_sampling_mutex);
+  for (size_t i = 0; i < log_tag_sampling_count; i++) {
+    auto &sampling = log_tag_samplings[i];
+    if (sampling.get_tag() != tag) {
+      continue;
+    }
+
+    if (sampling.sample_rate != 0) {
+      if (sampling.skipped_line_count != 0) {
+        sampling.skipped_line_count--;
+        return false;
+      }
+      sampling.skipped_line_count = sampling.sample_rate - 1;
+    }
+
+    if (sampling.max_lines_per_second != 0.0) {
+      // token bucket with capacity and fill rate equal to max_lines_per_second
+      auto now = Clocks::monotonic();
+      sampling.available_line_count =
+          min(sampling.max_lines_per_second,
+              sampling.available_line_count + (now - sampling.last_update_time) * sampling.max_lines_per_second);
+      sampling.last_update_time = now;
+      if (sampling.available_line_count < 1.0) {
+        return false;
+      }
+      sampling.available_line_count -= 1.0;
+    }
+    return true;
+  }
+  return true;
+}
+
 void LogInterface::append(int log_level, CSlice slice) {
   do_append(log_level, slice);
   if (log_level == VERBOSITY_NAME(FATAL)) {
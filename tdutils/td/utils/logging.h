@@ -19,6 +19,10 @@
  * int VERBOSITY_NAME(custom) = VERBOSITY_NAME(WARNING);
  * VLOG(custom) << "Hello custom world!"
  *
+ * Lines logged using VLOG can be sampled and rate-limited at run time:
+ * set_log_tag_sampling("custom", 100, 10);
+ * Arguments of dropped lines aren't evaluated.
+ *
  * LOG(FATAL) << "Power is off";
  * CHECK(condition) <===> LOG_IF(FATAL, !(condition))
  */
@@ -56,8 +60,11 @@
 #define LOG(level) LOG_IMPL(level, level, true, ::td::Slice())
 #define LOG_IF(level, condition) LOG_IMPL(level, level, condition, #condition)
 
-#define VLOG(level) LOG_IMPL(DEBUG, level, true, TD_DEFINE_STR(level))
-#define VLOG_IF(level, condition) LOG_IMPL(DEBUG, level, condition, TD_DEFINE_STR(level) " " #condition)
+#define VLOG(level) \
+  LOG_IMPL(DEBUG, level, ::td::detail::need_log_tag_line(TD_DEFINE_STR(level)), TD_DEFINE_STR(level))
+#define VLOG_IF(level, condition)                                                              \
+  LOG_IMPL(DEBUG, level, (condition) && ::td::detail::need_log_tag_line(TD_DEFINE_STR(level)), \
+           TD_DEFINE_STR(level) " " #condition)
 
 #define LOG_TAG ::td::Logger::tag_
 #define LOG_TAG2 ::td::Logger::tag2_
@@ -178,6 +185,21 @@ extern LogInterface *log_interface;
 using OnLogMessageCallback = void (*)(int verbosity_level, CSlice message);
 void set_log_message_callback(int max_verbosity_level, OnLogMessageCallback callback);
 
+// VLOG(tag) will log only every sample_rate-th line, but no more than max_lines_per_second lines per second
+// on average with bursts of up to max_lines_per_second lines; 0 disables the corresponding limit
+// returns false if there are too many sampled tags
+bool set_log_tag_sampling(Slice tag, int32 sample_rate, int32 max_lines_per_second);
+
+namespace detail {
+extern std::atomic<bool> has_log_tag_sampling;
+
+bool need_sampled_log_tag_line(Slice tag);
+
+inline bool need_log_tag_line(Slice tag) {
+  return !has_log_tag_sampling.load(std::memory_order_relaxed) || need_sampled_log_tag_line(tag);
+}
+}  // namespace detail
+
 class Logger {
   static const size_t BUFFER_SIZE = 128 * 1024;
 
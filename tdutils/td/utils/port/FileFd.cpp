@@ -555,6 +555,7 @@ uint64 filetime_to_unix_time_nsec(LONGLONG filetime) {
 struct FileSize {
   int64 size_;
   int64 real_size_;
+  int64 link_count_;
 };
 
 Result<FileSize> get_file_size(const FileFd &file_fd) {
@@ -566,6 +567,7 @@ Result<FileSize> get_file_size(const FileFd &file_fd) {
   FileSize res;
   res.size_ = standard_info.EndOfFile.QuadPart;
   res.real_size_ = standard_info.AllocationSize.QuadPart;
+  res.link_count_ = standard_info.NumberOfLinks;
 
   if (res.size_ > 0 && res.real_size_ <= 0) {  // just in case
     LOG(ERROR) << "Fix real file size from " << res.real_size_ << " to " << res.size_;
@@ -628,6 +630,7 @@ Result<Stat> FileFd::stat() const {
   TRY_RESULT(file_size, get_file_size(*this));
   res.size_ = file_size.size_;
   res.real_size_ = file_size.real_size_;
+  res.link_count_ = file_size.link_count_;
 
   return res;
 #endif
@@ -659,6 +662,30 @@ Status FileFd::sync_barrier() {
   return sync();
 }
 
+Status FileFd::drop_page_cache(int64 offset, int64 size) {
+  CHECK(!empty());
+  if (offset < 0 || size < 0) {
+    return Status::Error("Invalid file range");
+  }
+#if TD_LINUX
+  TRY_RESULT(offset_off_t, narrow_cast_safe<off_t>(offset));
+  TRY_RESULT(size_off_t, narrow_cast_safe<off_t>(size));
+  auto native_fd = get_native_fd().fd();
+  // dirty pages can't be dropped from the cache, so they must be written first
+  if (detail::skip_eintr([&] {
+        return sync_file_range(native_fd, offset_off_t, size_off_t,
+                               SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+      }) != 0) {
+    return OS_ERROR("Failed to write file range");
+  }
+  auto error_code = posix_fadvise(native_fd, offset_off_t, size_off_t, POSIX_FADV_DONTNEED);
+  if (error_code != 0) {
+    return Status::PosixError(error_code, "Failed to drop file range from the page cache");
+  }
+#endif
+  return Status::OK();
+}
+
 Status FileFd::seek(int64 position) {
   CHECK(!empty());
 #if TD_PORT_POSIX
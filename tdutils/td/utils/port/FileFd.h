@@ -64,6 +64,9 @@ class FileFd {
   Status sync() TD_WARN_UNUSED_RESULT;
   Status sync_barrier() TD_WARN_UNUSED_RESULT;
 
+  // writes the given range of the file to the disk and removes it from the page cache; may do nothing
+  Status drop_page_cache(int64 offset, int64 size) TD_WARN_UNUSED_RESULT;
+
   Status seek(int64 position) TD_WARN_UNUSED_RESULT;
 
   Status truncate_to_current_position(int64 current_position) TD_WARN_UNUSED_RESULT;
@@ -9,13 +9,99 @@
 #include "td/utils/port/config.h"
 
 #include "td/utils/port/detail/Epoll.h"
+#include "td/utils/port/detail/IoUring.h"
 #include "td/utils/port/detail/KQueue.h"
 #include "td/utils/port/detail/Poll.h"
 #include "td/utils/port/detail/Select.h"
 #include "td/utils/port/detail/WineventPoll.h"
 
+#if TD_POLL_IO_URING
+#include "td/utils/logging.h"
+#include "td/utils/port/PollBase.h"
+#include "td/utils/Status.h"
+#endif
+
 namespace td {
 
+#if TD_POLL_IO_URING
+// Uses io_uring if it was enabled through detail::IoUring::set_enabled before the scheduler has started
+// and is supported by the kernel, and epoll otherwise
+class Poll final : public PollBase {
+ public:
+  Poll() = default;
+  Poll(const Poll &) = delete;
+  Poll &operator=(const Poll &) = delete;
+  Poll(Poll &&) = delete;
+  Poll &operator=(Poll &&) = delete;
+  ~Poll() final = default;
+
+  void init() final {
+    if (detail::IoUring::is_enabled()) {
+      auto status = io_uring_.try_init();
+      if (status.is_ok()) {
+        use_io_uring_ = true;
+        return;
+      }
+      LOG(WARNING) << "Failed to use io_uring: " << status;
+    }
+    epoll_.init();
+  }
+
+  void clear() final {
+    if (use_io_uring_) {
+      io_uring_.clear();
+      use_io_uring_ = false;
+    } else {
+      epoll_.clear();
+    }
+  }
+
+  void subscribe(PollableFd fd, PollFlags flags) final {
+    if (use_io_uring_) {
+      io_uring_.subscribe(std::move(fd), flags);
+    } else {
+      epoll_.subscribe(std::move(fd), flags);
+    }
+  }
+
+  void unsubscribe(PollableFdRef fd) final {
+    if (use_io_uring_) {
+      io_uring_.unsubscribe(fd);
+    } else {
+      epoll_.unsubscribe(fd);
+    }
+  }
+
+  void unsubscribe_before_close(PollableFdRef fd) final {
+    if (use_io_uring_) {
+      io_uring_.unsubscribe_before_close(fd);
+    } else {
+      epoll_.unsubscribe_before_close(fd);
+    }
+  }
+
+  void run(int timeout_ms) final {
+    if (use_io_uring_) {
+      io_uring_.run(timeout_ms);
+    } else {
+      epoll_.run(timeout_ms);
+    }
+  }
+
+  static bool is_edge_triggered() {
+    return true;
+  }
+
+  bool is_io_uring_used() const {
+    return use_io_uring_;
+  }
+
+ private:
+  detail::Epoll epoll_;
+  detail::IoUring io_uring_;
+  bool use_io_uring_ = false;
+};
+#else
 // clang-format off
 
 #if TD_POLL_EPOLL
@@ -31,5 +117,6 @@ namespace td {
 #endif
 
 // clang-format on
+#endif
 
 }  // namespace td
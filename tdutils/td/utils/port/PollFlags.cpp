@@ -12,6 +12,10 @@ bool PollFlagsSet::write_flags(PollFlags flags) {
   if (flags.empty()) {
     return false;
   }
+  // avoid the atomic read-modify-write operation if the flags haven't been flushed since the previous write
+  if ((to_write_.load(std::memory_order_relaxed) & flags.raw()) == flags.raw()) {
+    return false;
+  }
   auto old_flags = to_write_.fetch_or(flags.raw(), std::memory_order_relaxed);
   return (flags.raw() & ~old_flags) != 0;
 }
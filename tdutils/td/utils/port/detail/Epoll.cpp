@@ -20,13 +20,18 @@ char disable_linker_warning_about_empty_file_epoll_cpp TD_UNUSED;
 
 namespace td {
 namespace detail {
+
+constexpr size_t Epoll::MIN_EVENT_COUNT;
+constexpr size_t Epoll::MAX_EVENT_COUNT;
+
 void Epoll::init() {
   CHECK(!epoll_fd_);
   epoll_fd_ = NativeFd(epoll_create(1));
   auto epoll_create_errno = errno;
   LOG_IF(FATAL, !epoll_fd_) << Status::PosixError(epoll_create_errno, "epoll_create failed");
 
-  events_.resize(1000);
+  events_.resize(MIN_EVENT_COUNT);
+  small_run_count_ = 0;
 }
 
 void Epoll::clear() {
@@ -81,11 +86,47 @@ void Epoll::unsubscribe_before_close(PollableFdRef fd) {
 }
 
 void Epoll::run(int timeout_ms) {
-  int ready_n = epoll_wait(epoll_fd_.fd(), &events_[0], static_cast<int>(events_.size()), timeout_ms);
-  auto epoll_wait_errno = errno;
-  LOG_IF(FATAL, ready_n == -1 && epoll_wait_errno != EINTR)
-      << Status::PosixError(epoll_wait_errno, "epoll_wait failed");
+  for (int round = 0; round < MAX_ROUND_COUNT; round++) {
+    int ready_n =
+        epoll_wait(epoll_fd_.fd(), &events_[0], static_cast<int>(events_.size()), round == 0 ? timeout_ms : 0);
+    auto epoll_wait_errno = errno;
+    LOG_IF(FATAL, ready_n == -1 && epoll_wait_errno != EINTR)
+        << Status::PosixError(epoll_wait_errno, "epoll_wait failed");
+    if (ready_n <= 0) {
+      break;
+    }
+
+    process_events(ready_n);
+
+    auto is_full = static_cast<size_t>(ready_n) == events_.size();
+    update_event_count(static_cast<size_t>(ready_n));
+    if (!is_full) {
+      break;
+    }
+    // there can be more ready fds; fetch them immediately, so all of them are handled before the next mailbox pass
+  }
+}
+
+void Epoll::update_event_count(size_t ready_n) {
+  if (ready_n == events_.size()) {
+    small_run_count_ = 0;
+    if (events_.size() < MAX_EVENT_COUNT) {
+      events_.resize(td::min(events_.size() * 2, MAX_EVENT_COUNT));
+    }
+    return;
+  }
+  if (ready_n * 4 >= events_.size() || events_.size() <= MIN_EVENT_COUNT) {
+    small_run_count_ = 0;
+    return;
+  }
+  if (++small_run_count_ >= SHRINK_RUN_COUNT) {
+    small_run_count_ = 0;
+    events_.resize(td::max(events_.size() / 2, MIN_EVENT_COUNT));
+    events_.shrink_to_fit();
+  }
+}
 
+void Epoll::process_events(int ready_n) {
   for (int i = 0; i < ready_n; i++) {
     PollFlags flags;
     epoll_event *event = &events_[i];
@@ -48,9 +48,19 @@ class Epoll final : public PollBase {
   }
 
  private:
+  static constexpr size_t MIN_EVENT_COUNT = 1000;
+  static constexpr size_t MAX_EVENT_COUNT = 1 << 16;
+  static constexpr int MAX_ROUND_COUNT = 8;
+  static constexpr int SHRINK_RUN_COUNT = 1000;
+
   NativeFd epoll_fd_;
   vector<struct epoll_event> events_;
+  int small_run_count_ = 0;
   ListNode list_root_;
+
+  void process_events(int ready_n);
+
+  void update_event_count(size_t ready_n);
 };
 
 }  // namespace detail
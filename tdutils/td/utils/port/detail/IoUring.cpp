@@ -0,0 +1,342 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/port/detail/IoUring.h"
+
+char disable_linker_warning_about_empty_file_io_uring_cpp TD_UNUSED;
+
+#ifdef TD_POLL_IO_URING
+
+#include "td/utils/logging.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(IORING_POLL_ADD_MULTI) && \
+    defined(IORING_ENTER_EXT_ARG) && defined(IORING_FEAT_EXT_ARG) && defined(IORING_FEAT_RSRC_TAGS)
+#define TD_IO_URING_SUPPORTED 1
+#endif
+
+namespace td {
+namespace detail {
+
+std::atomic<bool> IoUring::is_enabled_{false};
+
+void IoUring::set_enabled(bool is_enabled) {
+  is_enabled_.store(is_enabled, std::memory_order_relaxed);
+}
+
+bool IoUring::is_enabled() {
+  return is_enabled_.load(std::memory_order_relaxed);
+}
+
+IoUring::~IoUring() {
+  destroy_ring();
+}
+
+#if TD_IO_URING_SUPPORTED
+
+Status IoUring::try_init() {
+  CHECK(!ring_fd_);
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = ENTRY_COUNT * 4;
+  ring_fd_ = NativeFd(static_cast<int>(syscall(__NR_io_uring_setup, ENTRY_COUNT, &params)));
+  if (!ring_fd_) {
+    return OS_ERROR("io_uring_setup failed");
+  }
+  // multishot poll requests were added in the same kernel version as IORING_FEAT_RSRC_TAGS
+  uint32 required_features = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_EXT_ARG | IORING_FEAT_RSRC_TAGS;
+  if ((params.features & required_features) != required_features) {
+    ring_fd_.close();
+    return Status::Error("io_uring is too old");
+  }
+
+  ring_size_ = td::max(params.sq_off.array + params.sq_entries * sizeof(uint32),
+                       params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  ring_ = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_.fd(),
+               IORING_OFF_SQ_RING);
+  if (ring_ == MAP_FAILED) {
+    ring_ = nullptr;
+    auto status = OS_ERROR("mmap of io_uring rings failed");
+    destroy_ring();
+    return status;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_.fd(), IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    auto status = OS_ERROR("mmap of io_uring submission queue entries failed");
+    destroy_ring();
+    return status;
+  }
+
+  auto *ring = static_cast<char *>(ring_);
+  sq_head_ = reinterpret_cast<uint32 *>(ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32 *>(ring + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<uint32 *>(ring + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<uint32 *>(ring + params.sq_off.array);
+  cq_head_ = reinterpret_cast<uint32 *>(ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32 *>(ring + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32 *>(ring + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(ring + params.cq_off.cqes);
+  return Status::OK();
+}
+
+void IoUring::destroy_ring() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (ring_ != nullptr) {
+    munmap(ring_, ring_size_);
+    ring_ = nullptr;
+  }
+  ring_fd_.close();
+  pending_sqe_count_ = 0;
+}
+
+void IoUring::init() {
+  auto status = try_init();
+  LOG_IF(FATAL, status.is_error()) << status;
+}
+
+void IoUring::clear() {
+  if (!ring_fd_) {
+    return;
+  }
+  destroy_ring();
+  subscriptions_.clear();
+  fd_to_subscription_id_.clear();
+
+  for (auto *list_node = list_root_.next; list_node != &list_root_;) {
+    auto pollable_fd = PollableFd::from_list_node(list_node);
+    list_node = list_node->next;
+  }
+}
+
+io_uring_sqe *IoUring::get_sqe() {
+  auto tail = *sq_tail_;
+  if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == sq_mask_ + 1) {
+    // the submission queue is full; submit the entries without waiting for completions
+    enter(0, 0);
+    tail = *sq_tail_;
+    CHECK(tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) <= sq_mask_);
+  }
+  auto index = tail & sq_mask_;
+  auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  std::memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  pending_sqe_count_++;
+  return sqe;
+}
+
+void IoUring::add_poll(uint64 subscription_id, const Subscription &subscription) {
+  auto *sqe = get_sqe();
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = subscription.fd_;
+  sqe->poll32_events = subscription.events_;
+  sqe->len = IORING_POLL_ADD_MULTI;
+  sqe->user_data = subscription_id;
+}
+
+void IoUring::remove_poll(uint64 subscription_id) {
+  auto *sqe = get_sqe();
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = subscription_id;
+  sqe->user_data = 0;
+}
+
+int IoUring::enter(uint32 min_complete, int timeout_ms) {
+  io_uring_getevents_arg arg;
+  std::memset(&arg, 0, sizeof(arg));
+  struct __kernel_timespec timeout;
+  uint32 flags = 0;
+  if (min_complete > 0) {
+    flags |= IORING_ENTER_GETEVENTS;
+    if (timeout_ms >= 0) {
+      timeout.tv_sec = timeout_ms / 1000;
+      timeout.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+      arg.ts = reinterpret_cast<uint64>(&timeout);
+      flags |= IORING_ENTER_EXT_ARG;
+    }
+  }
+  int result;
+  if ((flags & IORING_ENTER_EXT_ARG) != 0) {
+    result = static_cast<int>(
+        syscall(__NR_io_uring_enter, ring_fd_.fd(), pending_sqe_count_, min_complete, flags, &arg, sizeof(arg)));
+  } else {
+    result = static_cast<int>(
+        syscall(__NR_io_uring_enter, ring_fd_.fd(), pending_sqe_count_, min_complete, flags, nullptr, 0));
+  }
+  auto io_uring_enter_errno = errno;
+  if (result >= 0) {
+    CHECK(static_cast<uint32>(result) <= pending_sqe_count_);
+    pending_sqe_count_ -= static_cast<uint32>(result);
+  } else {
+    LOG_IF(FATAL, io_uring_enter_errno != EINTR && io_uring_enter_errno != ETIME && io_uring_enter_errno != EBUSY)
+        << Status::PosixError(io_uring_enter_errno, "io_uring_enter failed");
+  }
+  return result;
+}
+
+void IoUring::subscribe(PollableFd fd, PollFlags flags) {
+  Subscription subscription;
+  subscription.events_ = POLLHUP | POLLERR | POLLRDHUP;
+  if (flags.can_read()) {
+    subscription.events_ |= POLLIN;
+  }
+  if (flags.can_write()) {
+    subscription.events_ |= POLLOUT;
+  }
+  subscription.fd_ = fd.native_fd().fd();
+  subscription.list_node_ = fd.release_as_list_node();
+  list_root_.put(subscription.list_node_);
+
+  auto subscription_id = ++last_subscription_id_;
+  auto &old_subscription_id = fd_to_subscription_id_[subscription.fd_];
+  LOG_CHECK(old_subscription_id == 0) << "Subscribe twice to fd " << subscription.fd_;
+  old_subscription_id = subscription_id;
+  add_poll(subscription_id, subscription);
+  subscriptions_.emplace(subscription_id, subscription);
+}
+
+void IoUring::unsubscribe(PollableFdRef fd_ref) {
+  auto fd = fd_ref.lock();
+  auto native_fd = fd.native_fd().fd();
+  auto it = fd_to_subscription_id_.find(native_fd);
+  LOG_CHECK(it != fd_to_subscription_id_.end()) << "Unsubscribe from unknown fd " << native_fd;
+  auto subscription_id = it->second;
+  fd_to_subscription_id_.erase(it);
+  subscriptions_.erase(subscription_id);
+
+  // the poll request holds a reference to the file, so it must be removed immediately
+  remove_poll(subscription_id);
+  enter(0, 0);
+}
+
+void IoUring::unsubscribe_before_close(PollableFdRef fd) {
+  unsubscribe(fd);
+}
+
+void IoUring::run(int timeout_ms) {
+  if (__atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) == *cq_head_) {
+    enter(timeout_ms == 0 ? 0 : 1, timeout_ms);
+  } else if (pending_sqe_count_ > 0) {
+    enter(0, 0);
+  }
+  process_completions();
+}
+
+void IoUring::process_completions() {
+  auto head = *cq_head_;
+  auto tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) {
+    const auto &cqe = cqes_[head & cq_mask_];
+    auto subscription_id = cqe.user_data;
+    if (subscription_id == 0) {
+      continue;
+    }
+    auto it = subscriptions_.find(subscription_id);
+    if (it == subscriptions_.end()) {
+      // the fd has already been unsubscribed
+      continue;
+    }
+    if ((cqe.flags & IORING_CQE_F_MORE) == 0) {
+      // the multishot poll request was terminated by the kernel and must be resubmitted
+      add_poll(subscription_id, it->second);
+    }
+    if (cqe.res < 0) {
+      if (cqe.res != -ECANCELED && cqe.res != -ENOMEM) {
+        LOG(ERROR) << Status::PosixError(-cqe.res, "io_uring poll failed") << ", fd = " << it->second.fd_;
+      }
+      continue;
+    }
+
+    auto events = static_cast<uint32>(cqe.res);
+    PollFlags flags;
+    if (events & POLLIN) {
+      events &= ~POLLIN;
+      flags = flags | PollFlags::Read();
+    }
+    if (events & POLLOUT) {
+      events &= ~POLLOUT;
+      flags = flags | PollFlags::Write();
+    }
+    if (events & POLLRDHUP) {
+      events &= ~POLLRDHUP;
+      flags = flags | PollFlags::Close();
+    }
+    if (events & POLLHUP) {
+      events &= ~POLLHUP;
+      flags = flags | PollFlags::Close();
+    }
+    if (events & POLLERR) {
+      events &= ~POLLERR;
+      flags = flags | PollFlags::Error();
+    }
+    if (events & POLLNVAL) {
+      LOG(FATAL) << "Unexpected POLLNVAL for fd " << it->second.fd_;
+    }
+    if (events) {
+      LOG(FATAL) << "Unsupported poll events: " << events;
+    }
+    auto pollable_fd = PollableFd::from_list_node(it->second.list_node_);
+    pollable_fd.add_flags(flags);
+    pollable_fd.release_as_list_node();
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+#else
+
+Status IoUring::try_init() {
+  return Status::Error("io_uring isn't supported by the system headers");
+}
+
+void IoUring::destroy_ring() {
+}
+
+void IoUring::init() {
+  LOG(FATAL) << "io_uring isn't supported";
+}
+
+void IoUring::clear() {
+}
+
+void IoUring::subscribe(PollableFd fd, PollFlags flags) {
+  UNREACHABLE();
+}
+
+void IoUring::unsubscribe(PollableFdRef fd) {
+  UNREACHABLE();
+}
+
+void IoUring::unsubscribe_before_close(PollableFdRef fd) {
+  UNREACHABLE();
+}
+
+void IoUring::run(int timeout_ms) {
+  UNREACHABLE();
+}
+
+#endif
+
+}  // namespace detail
+}  // namespace td
+
+#endif
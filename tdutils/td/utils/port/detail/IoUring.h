@@ -0,0 +1,113 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/port/config.h"
+
+#ifdef TD_POLL_IO_URING
+
+#include "td/utils/common.h"
+#include "td/utils/HashMap.h"
+#include "td/utils/List.h"
+#include "td/utils/port/detail/NativeFd.h"
+#include "td/utils/port/detail/PollableFd.h"
+#include "td/utils/port/PollBase.h"
+#include "td/utils/port/PollFlags.h"
+#include "td/utils/Status.h"
+
+#include <atomic>
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace td {
+namespace detail {
+
+// Edge-triggered poll based on multishot poll requests of io_uring. All subscriptions and the wait for events
+// are submitted to the kernel by a single io_uring_enter call per run.
+class IoUring final : public PollBase {
+ public:
+  IoUring() = default;
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+  IoUring(IoUring &&) = delete;
+  IoUring &operator=(IoUring &&) = delete;
+  ~IoUring() final;
+
+  // returns an error if io_uring isn't supported by the kernel
+  Status try_init() TD_WARN_UNUSED_RESULT;
+
+  void init() final;
+
+  void clear() final;
+
+  void subscribe(PollableFd fd, PollFlags flags) final;
+
+  void unsubscribe(PollableFdRef fd) final;
+
+  void unsubscribe_before_close(PollableFdRef fd) final;
+
+  void run(int timeout_ms) final;
+
+  static bool is_edge_triggered() {
+    return true;
+  }
+
+  // whether Poll must try to use io_uring instead of epoll in schedulers started after the call
+  static void set_enabled(bool is_enabled);
+
+  static bool is_enabled();
+
+ private:
+  static constexpr uint32 ENTRY_COUNT = 4096;
+
+  NativeFd ring_fd_;
+  void *ring_ = nullptr;
+  size_t ring_size_ = 0;
+  void *sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  uint32 *sq_head_ = nullptr;
+  uint32 *sq_tail_ = nullptr;
+  uint32 sq_mask_ = 0;
+  uint32 *sq_array_ = nullptr;
+  uint32 *cq_head_ = nullptr;
+  uint32 *cq_tail_ = nullptr;
+  uint32 cq_mask_ = 0;
+  io_uring_cqe *cqes_ = nullptr;
+
+  uint32 pending_sqe_count_ = 0;
+
+  struct Subscription {
+    ListNode *list_node_ = nullptr;
+    uint32 events_ = 0;
+    int fd_ = -1;
+  };
+  uint64 last_subscription_id_ = 0;
+  HashMap<uint64, Subscription> subscriptions_;
+  HashMap<int, uint64> fd_to_subscription_id_;
+  ListNode list_root_;
+
+  static std::atomic<bool> is_enabled_;
+
+  io_uring_sqe *get_sqe();
+
+  void add_poll(uint64 subscription_id, const Subscription &subscription);
+
+  void remove_poll(uint64 subscription_id);
+
+  int enter(uint32 min_complete, int timeout_ms);
+
+  void process_completions();
+
+  void destroy_ring();
+};
+
+}  // namespace detail
+}  // namespace td
+
+#endif
@@ -130,6 +130,22 @@ class TlParser {
     return fetch_binary_unsafe<T>();
   }
 
+  // fetches size consecutive values with one bounds check; returns false if there is not enough data
+  template <class T>
+  bool fetch_binary_array(T *result, size_t size) {
+    if (unlikely(left_len / sizeof(T) < size)) {
+      set_error("Not enough data to read");
+      return false;
+    }
+    auto len = size * sizeof(T);
+    left_len -= len;
+    if (len != 0) {
+      std::memcpy(result, data, len);
+      data += len;
+    }
+    return true;
+  }
+
   template <class T>
   T fetch_string() {
     check_len(sizeof(int32));
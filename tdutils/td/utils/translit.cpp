@@ -7,7 +7,6 @@
 #include "td/utils/translit.h"
 
 #include "td/utils/algorithm.h"
-#include "td/utils/FlatHashMap.h"
 #include "td/utils/misc.h"
 #include "td/utils/utf8.h"
 
@@ -16,11 +15,40 @@
 
 namespace td {
 
-static const FlatHashMap<uint32, string> &get_en_to_ru_simple_rules() {
-  static const FlatHashMap<uint32, string> rules{
+// replacements of single characters are stored in a table indexed by code - first_code,
+// because the rules are looked up for every character of every transliterated word
+class SimpleTranslitRules {
+ public:
+  explicit SimpleTranslitRules(vector<std::pair<uint32, string>> &&rules) {
+    CHECK(!rules.empty());
+    std::sort(rules.begin(), rules.end());
+    first_code_ = rules[0].first;
+    replacements_.resize(rules.back().first - first_code_ + 1);
+    for (auto &rule : rules) {
+      auto &replacement = replacements_[rule.first - first_code_];
+      replacement.first = true;
+      replacement.second = std::move(rule.second);
+    }
+  }
+
+  const string *find(uint32 code) const {
+    code -= first_code_;  // codes less than first_code_ become big
+    if (code >= replacements_.size() || !replacements_[code].first) {
+      return nullptr;
+    }
+    return &replacements_[code].second;
+  }
+
+ private:
+  uint32 first_code_ = 0;
+  vector<std::pair<bool, string>> replacements_;
+};
+
+static const SimpleTranslitRules &get_en_to_ru_simple_rules() {
+  static const SimpleTranslitRules rules({
       {'a', "а"}, {'b', "б"}, {'c', "к"}, {'d', "д"}, {'e', "е"}, {'f', "ф"},  {'g', "г"}, {'h', "х"}, {'i', "и"},
       {'j', "й"}, {'k', "к"}, {'l', "л"}, {'m', "м"}, {'n', "н"}, {'o', "о"},  {'p', "п"}, {'q', "к"}, {'r', "р"},
-      {'s', "с"}, {'t', "т"}, {'u', "у"}, {'v', "в"}, {'w', "в"}, {'x', "кс"}, {'y', "и"}, {'z', "з"}};
+      {'s', "с"}, {'t', "т"}, {'u', "у"}, {'v', "в"}, {'w', "в"}, {'x', "кс"}, {'y', "и"}, {'z', "з"}});
   return rules;
 }
 
@@ -32,13 +60,13 @@ static const std::vector<std::pair<string, string>> &get_en_to_ru_complex_rules(
   return rules;
 }
 
-static const FlatHashMap<uint32, string> &get_ru_to_en_simple_rules() {
-  static const FlatHashMap<uint32, string> rules{
+static const SimpleTranslitRules &get_ru_to_en_simple_rules() {
+  static const SimpleTranslitRules rules({
       {0x430, "a"},  {0x431, "b"},  {0x432, "v"},  {0x433, "g"},  {0x434, "d"},  {0x435, "e"},   {0x451, "e"},
       {0x436, "zh"}, {0x437, "z"},  {0x438, "i"},  {0x439, "y"},  {0x43a, "k"},  {0x43b, "l"},   {0x43c, "m"},
       {0x43d, "n"},  {0x43e, "o"},  {0x43f, "p"},  {0x440, "r"},  {0x441, "s"},  {0x442, "t"},   {0x443, "u"},
       {0x444, "f"},  {0x445, "kh"}, {0x446, "ts"}, {0x447, "ch"}, {0x448, "sh"}, {0x449, "sch"}, {0x44a, ""},
-      {0x44b, "y"},  {0x44c, ""},   {0x44d, "e"},  {0x44e, "yu"}, {0x44f, "ya"}};
+      {0x44b, "y"},  {0x44c, ""},   {0x44d, "e"},  {0x44e, "yu"}, {0x44f, "ya"}});
   return rules;
 }
 
@@ -49,7 +77,7 @@ static const std::vector<std::pair<string, string>> &get_ru_to_en_complex_rules(
 }
 
 static void add_word_transliterations(vector<string> &result, Slice word, bool allow_partial,
-                                      const FlatHashMap<uint32, string> &simple_rules,
+                                      const SimpleTranslitRules &simple_rules,
                                       const vector<std::pair<string, string>> &complex_rules) {
   string s;
   auto pos = word.ubegin();
@@ -57,9 +85,9 @@ static void add_word_transliterations(vector<string> &result, Slice word, bool a
   while (pos != end) {
     uint32 code;
     pos = next_utf8_unsafe(pos, &code);
-    auto it = simple_rules.find(code);
-    if (it != simple_rules.end()) {
-      s += it->second;
+    auto replacement = simple_rules.find(code);
+    if (replacement != nullptr) {
+      s += *replacement;
     } else {
       append_utf8_character(s, code);
     }
@@ -74,6 +102,10 @@ static void add_word_transliterations(vector<string> &result, Slice word, bool a
     auto suffix = Slice(pos, end);
     bool found = false;
     for (auto &rule : complex_rules) {
+      if (rule.first[0] != suffix[0]) {
+        // both checks below need the same first byte
+        continue;
+      }
       if (begins_with(suffix, rule.first)) {
         found = true;
         pos += rule.first.size();
@@ -90,9 +122,9 @@ static void add_word_transliterations(vector<string> &result, Slice word, bool a
 
     uint32 code;
     pos = next_utf8_unsafe(pos, &code);
-    auto it = simple_rules.find(code);
-    if (it != simple_rules.end()) {
-      s += it->second;
+    auto replacement = simple_rules.find(code);
+    if (replacement != nullptr) {
+      s += *replacement;
     } else {
       append_utf8_character(s, code);
     }
@@ -6,16 +6,129 @@
 //
 #include "td/utils/utf8.h"
 
+#include "td/utils/bits.h"
 #include "td/utils/misc.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/unicode.h"
 
+#include <cstring>
+
+#if defined(__SSE2__) || (TD_MSVC && (defined(_M_X64) || (defined(_M_IX86) && _M_IX86_FP >= 2)))
+#define TD_SSE2 1
+#endif
+
+#if TD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace td {
 
+namespace {
+
+// all functions below process UTF8_BLOCK_SIZE bytes starting from ptr
+constexpr size_t UTF8_BLOCK_SIZE = 16;
+
+#if TD_SSE2
+
+bool is_ascii_block(const unsigned char *ptr) {
+  auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+  return _mm_movemask_epi8(bytes) == 0;
+}
+
+// returns the number of bytes, which aren't first code units of a character
+size_t count_continuation_code_units_block(const unsigned char *ptr) {
+  auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+  // 0x80-0xBF are less than -64 as signed bytes
+  auto mask = _mm_movemask_epi8(_mm_cmplt_epi8(bytes, _mm_set1_epi8(-64)));
+  return static_cast<size_t>(count_bits32(static_cast<uint32>(mask)));
+}
+
+// returns the number of first code units of characters, which are encoded with 4 bytes
+size_t count_4_byte_first_code_units_block(const unsigned char *ptr) {
+  auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+  // 0xF0-0xF7 are from -16 to -9 as signed bytes
+  auto is_4_byte = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(-17)), _mm_cmplt_epi8(bytes, _mm_set1_epi8(-8)));
+  return static_cast<size_t>(count_bits32(static_cast<uint32>(_mm_movemask_epi8(is_4_byte))));
+}
+
+#elif defined(__aarch64__)
+
+bool is_ascii_block(const unsigned char *ptr) {
+  return vmaxvq_u8(vld1q_u8(ptr)) < 0x80;
+}
+
+size_t count_continuation_code_units_block(const unsigned char *ptr) {
+  auto bytes = vld1q_u8(ptr);
+  auto is_continuation = vceqq_u8(vandq_u8(bytes, vdupq_n_u8(0xC0)), vdupq_n_u8(0x80));
+  return vaddvq_u8(vshrq_n_u8(is_continuation, 7));
+}
+
+size_t count_4_byte_first_code_units_block(const unsigned char *ptr) {
+  auto bytes = vld1q_u8(ptr);
+  auto is_4_byte = vceqq_u8(vandq_u8(bytes, vdupq_n_u8(0xF8)), vdupq_n_u8(0xF0));
+  return vaddvq_u8(vshrq_n_u8(is_4_byte, 7));
+}
+
+#else
+
+constexpr uint64 HIGH_BITS = 0x8080808080808080ULL;
+
+// processes a half of a block, using highest bits of the bytes of the word as flags
+template <class F>
+size_t count_block(const unsigned char *ptr, F &&get_flags) {
+  uint64 words[2];
+  std::memcpy(words, ptr, sizeof(words));
+  return static_cast<size_t>(count_bits64(get_flags(words[0]) & HIGH_BITS) +
+                             count_bits64(get_flags(words[1]) & HIGH_BITS));
+}
+
+bool is_ascii_block(const unsigned char *ptr) {
+  return count_block(ptr, [](uint64 word) { return word; }) == 0;
+}
+
+size_t count_continuation_code_units_block(const unsigned char *ptr) {
+  // the highest bit is set and the next bit is unset
+  return count_block(ptr, [](uint64 word) { return word & ~(word << 1); });
+}
+
+size_t count_4_byte_first_code_units_block(const unsigned char *ptr) {
+  // the four highest bits are set and the next bit is unset
+  return count_block(ptr, [](uint64 word) { return word & (word << 1) & (word << 2) & (word << 3) & ~(word << 4); });
+}
+
+#endif
+
+}  // namespace
+
+bool is_ascii(Slice str) {
+  auto ptr = str.ubegin();
+  auto end = str.uend();
+  while (static_cast<size_t>(end - ptr) >= UTF8_BLOCK_SIZE) {
+    if (!is_ascii_block(ptr)) {
+      return false;
+    }
+    ptr += UTF8_BLOCK_SIZE;
+  }
+  while (ptr != end) {
+    if (*ptr++ >= 0x80) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool check_utf8(CSlice str) {
   const char *data = str.data();
   const char *data_end = data + str.size();
   do {
+    // skip runs of ASCII characters
+    while (static_cast<size_t>(data_end - data) >= UTF8_BLOCK_SIZE &&
+           is_ascii_block(reinterpret_cast<const unsigned char *>(data))) {
+      data += UTF8_BLOCK_SIZE;
+    }
+
     uint32 a = static_cast<unsigned char>(*data++);
     if ((a & 0x80) == 0) {
       if (data == data_end + 1) {
@@ -156,16 +269,43 @@ string utf8_encode(CSlice data) {
   return PSTRING() << "url_decode(" << url_encode(data) << ')';
 }
 
+size_t utf8_length(Slice str) {
+  size_t result = 0;
+  auto ptr = str.ubegin();
+  auto end = str.uend();
+  while (static_cast<size_t>(end - ptr) >= UTF8_BLOCK_SIZE) {
+    result += UTF8_BLOCK_SIZE - count_continuation_code_units_block(ptr);
+    ptr += UTF8_BLOCK_SIZE;
+  }
+  for (; ptr != end; ptr++) {
+    result += is_utf8_character_first_code_unit(*ptr);
+  }
+  return result;
+}
+
 size_t utf8_utf16_length(Slice str) {
   size_t result = 0;
-  for (auto c : str) {
+  auto ptr = str.ubegin();
+  auto end = str.uend();
+  while (static_cast<size_t>(end - ptr) >= UTF8_BLOCK_SIZE) {
+    result += UTF8_BLOCK_SIZE - count_continuation_code_units_block(ptr) + count_4_byte_first_code_units_block(ptr);
+    ptr += UTF8_BLOCK_SIZE;
+  }
+  for (; ptr != end; ptr++) {
+    auto c = *ptr;
     result += is_utf8_character_first_code_unit(c) + ((c & 0xf8) == 0xf0);
   }
   return result;
 }
 
 Slice utf8_utf16_truncate(Slice str, size_t length) {
-  for (size_t i = 0; i < str.size(); i++) {
+  size_t i = 0;
+  // each ASCII character is a single UTF-16 code unit
+  while (length >= UTF8_BLOCK_SIZE && str.size() - i >= UTF8_BLOCK_SIZE && is_ascii_block(str.ubegin() + i)) {
+    i += UTF8_BLOCK_SIZE;
+    length -= UTF8_BLOCK_SIZE;
+  }
+  for (; i < str.size(); i++) {
     auto c = static_cast<unsigned char>(str[i]);
     if (is_utf8_character_first_code_unit(c)) {
       if (length <= 0) {
@@ -14,19 +14,16 @@ namespace td {
 /// checks UTF-8 string for correctness
 bool check_utf8(CSlice str);
 
+/// checks whether the string consists only of ASCII characters
+bool is_ascii(Slice str);
+
 /// checks if a code unit is a first code unit of a UTF-8 character
 inline bool is_utf8_character_first_code_unit(unsigned char c) {
   return (c & 0xC0) != 0x80;
 }
 
 /// returns length of UTF-8 string in characters
-inline size_t utf8_length(Slice str) {
-  size_t result = 0;
-  for (auto c : str) {
-    result += is_utf8_character_first_code_unit(c);
-  }
-  return result;
-}
+size_t utf8_length(Slice str);
 
 /// returns length of UTF-8 string in UTF-16 code units
 size_t utf8_utf16_length(Slice str);
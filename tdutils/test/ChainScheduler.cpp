@@ -60,6 +60,37 @@ TEST(ChainScheduler, SendAfterRestart) {
   ASSERT_TRUE(!scheduler.start_next_task());
 }
 
+TEST(ChainScheduler, ActiveTaskLimit) {
+  td::ChainScheduler<int> scheduler(3);
+  std::vector<td::ChainScheduler<int>::ChainId> chains{1};
+
+  td::vector<td::ChainScheduler<int>::TaskId> task_ids;
+  for (int i = 0; i < 5; i++) {
+    task_ids.push_back(scheduler.create_task(chains, i));
+  }
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(task_ids[i], scheduler.start_next_task().unwrap().task_id);
+  }
+  ASSERT_TRUE(!scheduler.start_next_task());
+
+  scheduler.finish_task(task_ids[0]);
+  ASSERT_EQ(task_ids[3], scheduler.start_next_task().unwrap().task_id);
+  ASSERT_TRUE(!scheduler.start_next_task());
+
+  // only the failed task and tasks after it are restarted after the previous tasks are finished
+  scheduler.reset_task(task_ids[2]);
+  scheduler.reset_task(task_ids[3]);
+  ASSERT_TRUE(!scheduler.start_next_task());
+  scheduler.finish_task(task_ids[1]);
+  ASSERT_EQ(task_ids[2], scheduler.start_next_task().unwrap().task_id);
+  auto task = scheduler.start_next_task().unwrap();
+  ASSERT_EQ(task_ids[3], task.task_id);
+  ASSERT_EQ(1u, task.parents.size());
+  ASSERT_EQ(task_ids[2], task.parents[0]);
+  ASSERT_EQ(task_ids[4], scheduler.start_next_task().unwrap().task_id);
+  ASSERT_TRUE(!scheduler.start_next_task());
+}
+
 TEST(ChainScheduler, Basic) {
   td::ChainScheduler<int> scheduler;
   for (int i = 0; i < 100; i++) {
@@ -0,0 +1,114 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/common.h"
+#include "td/utils/ConcurrentReadHashMap.h"
+#include "td/utils/FlatHashMap.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/Random.h"
+#include "td/utils/tests.h"
+
+#include <atomic>
+
+TEST(ConcurrentReadHashMap, stress_test) {
+  td::Random::Xorshift128plus rnd(123);
+  td::FlatHashMap<td::uint64, td::uint64> reference;
+  td::ConcurrentReadHashMap<td::uint64, td::uint64> map;
+
+  td::vector<td::RandomSteps::Step> steps;
+  auto add_step = [&](td::uint32 weight, auto f) {
+    steps.emplace_back(td::RandomSteps::Step{std::move(f), weight});
+  };
+
+  auto gen_key = [&] {
+    return rnd() % 1000 + 1;
+  };
+
+  auto check = [&] {
+    ASSERT_EQ(reference.size(), map.size());
+    ASSERT_EQ(reference.empty(), map.empty());
+
+    if (reference.size() < 100) {
+      td::uint64 result = 0;
+      for (auto &it : reference) {
+        result += it.first * 101;
+        result += it.second;
+      }
+      map.foreach([&](const td::uint64 &key, const td::uint64 &value) {
+        result -= key * 101;
+        result -= value;
+      });
+      ASSERT_EQ(0u, result);
+    }
+  };
+
+  add_step(2000, [&] {
+    auto key = gen_key();
+    auto value = rnd();
+    reference[key] = value;
+    map.set(key, value);
+    ASSERT_EQ(reference[key], map.get(key));
+    check();
+  });
+
+  add_step(2000, [&] {
+    auto key = gen_key();
+    auto ref_it = reference.find(key);
+    auto ref_value = ref_it == reference.end() ? 0 : ref_it->second;
+    ASSERT_EQ(ref_value, map.get(key));
+    ASSERT_EQ(ref_it == reference.end() ? 0u : 1u, map.count(key));
+    check();
+  });
+
+  add_step(2000, [&] {
+    auto key = gen_key();
+    size_t reference_erased_count = reference.erase(key);
+    size_t map_erased_count = map.erase(key);
+    ASSERT_EQ(reference_erased_count, map_erased_count);
+    check();
+  });
+
+  td::RandomSteps runner(std::move(steps));
+  for (size_t i = 0; i < 1000000; i++) {
+    runner.step(rnd);
+  }
+}
+
+#if !TD_THREAD_UNSUPPORTED
+TEST(ConcurrentReadHashMap, concurrent_readers) {
+  td::ConcurrentReadHashMap<td::uint64, td::string> map;
+  std::atomic<bool> is_finished{false};
+
+  td::vector<td::thread> threads(4);
+  for (auto &thread : threads) {
+    thread = td::thread([&] {
+      td::uint64 found_count = 0;
+      while (!is_finished.load(std::memory_order_relaxed)) {
+        auto key = td::Random::fast_uint64() % 10000 + 1;
+        if (map.with_value(key, [key](const td::string &value) { CHECK(value == td::to_string(key)); })) {
+          found_count++;
+        }
+      }
+      LOG(INFO) << "Found " << found_count << " values";
+    });
+  }
+
+  for (int i = 0; i < 1000000; i++) {
+    auto key = td::Random::fast_uint64() % 10000 + 1;
+    if (td::Random::fast_bool()) {
+      map.set(key, td::to_string(key));
+    } else {
+      map.erase(key);
+    }
+  }
+  is_finished = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+#endif
@@ -44,6 +44,21 @@ TEST(FlatHashMapChunks, basic) {
   ASSERT_EQ(4, kv[3]);
 }
 
+TEST(FlatHashMapChunks, find_absent) {
+  // the table has 2 chunks and isn't resized, so both chunks are eventually overflowed
+  td::Random::Xorshift128plus rnd(123);
+  td::FlatHashSetChunks<td::uint64> set;
+  for (int i = 0; i < 1000000; i++) {
+    auto key = rnd() % 100 + 1;
+    auto it = set.find(key);
+    if (it != set.end()) {
+      set.erase(it);
+    } else if (set.size() < 24) {
+      set.insert(key);
+    }
+  }
+}
+
 TEST(FlatHashMap, probing) {
   auto test = [](int buckets, int elements) {
     CHECK(buckets >= elements);
@@ -330,6 +345,7 @@ TEST(FlatHashMap, stress_test) {
   });
 
   add_step("reserve", 10, [&] { tbl.reserve(static_cast<size_t>(rnd() % max_table_size)); });
+  add_step("shrink_to_fit", 10, [&] { tbl.shrink_to_fit(); });
 
   add_step("find", 1000, [&] {
     auto key = gen_key();
@@ -413,6 +429,7 @@ TEST(FlatHashSet, stress_test) {
   });
 
   add_step("reserve", 10, [&] { tbl.reserve(static_cast<size_t>(rnd() % max_table_size)); });
+  add_step("shrink_to_fit", 10, [&] { tbl.shrink_to_fit(); });
 
   add_step("find", 1000, [&] {
     auto key = gen_key();
@@ -0,0 +1,84 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/common.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/SharedSlice.h"
+#include "td/utils/SharedStringPool.h"
+#include "td/utils/tests.h"
+
+TEST(SharedStringPool, intern) {
+  td::SharedStringPool pool;
+  ASSERT_TRUE(pool.intern(td::Slice()).empty());
+
+  auto a = pool.intern("hello");
+  auto b = pool.intern(td::string("hello"));
+  auto c = pool.intern("world");
+  ASSERT_EQ("hello", a.as_slice());
+  ASSERT_EQ("hello", b.as_slice());
+  ASSERT_EQ("world", c.as_slice());
+  ASSERT_TRUE(a.data() == b.data());
+  ASSERT_TRUE(a.data() != c.data());
+
+  auto stats = pool.get_stats();
+  ASSERT_EQ(2u, stats.string_count);
+  ASSERT_EQ(10u, stats.total_size);
+  ASSERT_EQ(3u, stats.intern_count);
+  ASSERT_EQ(1u, stats.hit_count);
+  ASSERT_EQ(5u, stats.saved_size);
+
+  ASSERT_EQ(0u, pool.gc());
+  a.clear();
+  ASSERT_EQ(0u, pool.gc());
+  b.clear();
+  ASSERT_EQ(1u, pool.gc());
+  stats = pool.get_stats();
+  ASSERT_EQ(1u, stats.string_count);
+  ASSERT_EQ(5u, stats.total_size);
+
+  auto d = pool.intern("hello");
+  ASSERT_EQ("hello", d.as_slice());
+  ASSERT_EQ(2u, pool.get_stats().string_count);
+}
+
+TEST(SharedStringPool, auto_gc) {
+  td::SharedStringPool pool;
+  auto kept = pool.intern("kept");
+  for (int i = 0; i < 100000; i++) {
+    auto str = pool.intern(td::to_string(i));
+    ASSERT_EQ(td::to_string(i), str.as_slice());
+  }
+  auto stats = pool.get_stats();
+  ASSERT_TRUE(stats.string_count < 2000u);
+  ASSERT_EQ(100001u, stats.intern_count);
+  ASSERT_TRUE(pool.intern("kept").data() == kept.data());
+}
+
+#if !TD_THREAD_UNSUPPORTED
+TEST(SharedStringPool, threads) {
+  td::SharedStringPool pool;
+  td::vector<td::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&] {
+      td::vector<td::SharedSlice> strings;
+      for (int i = 0; i < 10000; i++) {
+        strings.push_back(pool.intern(td::to_string(i % 100)));
+        if (strings.size() > 50) {
+          strings.clear();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto stats = pool.get_stats();
+  ASSERT_EQ(40000u, stats.intern_count);
+  ASSERT_TRUE(stats.hit_count >= 40000u - 400u);
+  ASSERT_TRUE(stats.string_count <= 100u);
+}
+#endif
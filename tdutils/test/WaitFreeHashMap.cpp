@@ -79,6 +79,11 @@ TEST(WaitFreeHashMap, stress_test) {
     check();
   });
 
+  add_step(5, [&] {
+    map.shrink_to_fit();
+    check(true);
+  });
+
   td::RandomSteps runner(std::move(steps));
   for (size_t i = 0; i < 1000000; i++) {
     runner.step(rnd);
@@ -93,3 +98,22 @@ TEST(WaitFreeHashMap, stress_test) {
     }
   }
 }
+
+TEST(WaitFreeHashMap, shrink_to_fit) {
+  td::WaitFreeHashMap<td::uint64, td::uint64> map;
+  for (td::uint64 i = 1; i <= 100000; i++) {
+    map.set(i, i * 2);
+  }
+  for (td::uint64 i = 1; i <= 100000; i++) {
+    if (i % 1000 != 0) {
+      map.erase(i);
+    }
+  }
+  map.shrink_to_fit();
+  ASSERT_EQ(100u, map.calc_size());
+  for (td::uint64 i = 1; i <= 100000; i++) {
+    ASSERT_EQ(i % 1000 == 0 ? i * 2 : 0u, map.get(i));
+  }
+  map.set(1, 1);
+  ASSERT_EQ(101u, map.calc_size());
+}
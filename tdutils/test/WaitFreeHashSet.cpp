@@ -57,6 +57,11 @@ TEST(WaitFreeHashSet, stress_test) {
     check();
   });
 
+  add_step(5, [&] {
+    set.shrink_to_fit();
+    check(true);
+  });
+
   td::RandomSteps runner(std::move(steps));
   for (size_t i = 0; i < 1000000; i++) {
     runner.step(rnd);
@@ -71,3 +76,20 @@ TEST(WaitFreeHashSet, stress_test) {
     }
   }
 }
+
+TEST(WaitFreeHashSet, shrink_to_fit) {
+  td::WaitFreeHashSet<td::uint64> set;
+  for (td::uint64 i = 1; i <= 100000; i++) {
+    set.insert(i);
+  }
+  for (td::uint64 i = 1; i <= 100000; i++) {
+    if (i % 1000 != 0) {
+      set.erase(i);
+    }
+  }
+  set.shrink_to_fit();
+  ASSERT_EQ(100u, set.calc_size());
+  for (td::uint64 i = 1; i <= 100000; i++) {
+    ASSERT_EQ(i % 1000 == 0 ? 1u : 0u, set.count(i));
+  }
+}
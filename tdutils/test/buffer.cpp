@@ -7,7 +7,10 @@
 #include "td/utils/tests.h"
 
 #include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/port/thread.h"
 #include "td/utils/Random.h"
+#include "td/utils/Slice.h"
 
 TEST(Buffer, buffer_builder) {
   {
@@ -54,3 +57,34 @@ TEST(Buffer, buffer_builder) {
     ASSERT_EQ(builder.extract().as_slice(), str);
   }
 }
+
+#if !TD_THREAD_UNSUPPORTED
+TEST(Buffer, free_on_other_thread) {
+  auto initial_buffer_mem = td::BufferAllocator::get_buffer_mem();
+  for (int iteration = 0; iteration < 10; iteration++) {
+    td::vector<td::BufferSlice> buffers;
+    td::thread producer([&buffers] {
+      for (int i = 0; i < 2000; i++) {
+        auto size = static_cast<size_t>(td::Random::fast(1, 20000));
+        td::BufferSlice buffer(size);
+        buffer.as_mutable_slice().fill(static_cast<char>('a' + i % 26));
+        buffers.push_back(std::move(buffer));
+      }
+    });
+    producer.join();
+
+    for (size_t i = 0; i < buffers.size(); i++) {
+      auto slice = buffers[i].as_slice();
+      ASSERT_TRUE(!slice.empty());
+      ASSERT_EQ(static_cast<char>('a' + i % 26), slice[0]);
+      ASSERT_EQ(static_cast<char>('a' + i % 26), slice.back());
+    }
+    td::thread consumer([buffers = std::move(buffers)]() mutable {
+      td::BufferSlice buffer(1);  // creates buffer cache of the thread
+      buffers.clear();
+    });
+    consumer.join();
+  }
+  ASSERT_EQ(initial_buffer_mem, td::BufferAllocator::get_buffer_mem());
+}
+#endif
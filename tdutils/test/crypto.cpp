@@ -160,6 +160,44 @@ TEST(Crypto, AesIgeState) {
   }
 }
 
+TEST(Crypto, AesIgeDecrypt) {
+  td::Random::Xorshift128plus rnd(123);
+  for (int t = 0; t < 100; t++) {
+    td::UInt256 key;
+    rnd.bytes(as_mutable_slice(key));
+    td::UInt256 iv;
+    rnd.bytes(as_mutable_slice(iv));
+    td::string encrypted(16 * (rnd() % 100), '\0');
+    rnd.bytes(encrypted);
+
+    // straightforward IGE decryption using AES in ECB mode
+    td::AesState aes;
+    aes.init(as_slice(key), false);
+    td::string expected(encrypted.size(), '\0');
+    td::string encrypted_iv = as_slice(iv).substr(0, 16).str();
+    td::string plaintext_iv = as_slice(iv).substr(16).str();
+    for (size_t pos = 0; pos < encrypted.size(); pos += 16) {
+      td::string block = encrypted.substr(pos, 16);
+      for (size_t i = 0; i < 16; i++) {
+        block[i] = static_cast<char>(block[i] ^ plaintext_iv[i]);
+      }
+      aes.decrypt(td::Slice(block).ubegin(), td::MutableSlice(block).ubegin(), 16);
+      for (size_t i = 0; i < 16; i++) {
+        block[i] = static_cast<char>(block[i] ^ encrypted_iv[i]);
+      }
+      expected.replace(pos, 16, block);
+      encrypted_iv = encrypted.substr(pos, 16);
+      plaintext_iv = block;
+    }
+
+    td::string decrypted(encrypted.size(), '\0');
+    td::UInt256 iv_copy = iv;
+    td::aes_ige_decrypt(as_slice(key), as_mutable_slice(iv_copy), encrypted, decrypted);
+    ASSERT_EQ(expected, decrypted);
+    ASSERT_EQ(encrypted_iv + plaintext_iv, as_slice(iv_copy).str());
+  }
+}
+
 TEST(Crypto, AesCbcState) {
   td::vector<td::uint32> answers1{0u, 3617355989u, 3449188102u, 186999968u, 4244808847u, 2626031206u};
 
@@ -290,6 +328,13 @@ TEST(Crypto, sha256) {
     td::string output(32, '\0');
     td::sha256(strings[i], output);
     ASSERT_STREQ(answers[i], td::base64_encode(output));
+
+    for (auto prefix_size : {static_cast<std::size_t>(0), strings[i].size() / 3, strings[i].size()}) {
+      td::string parts_output(32, '\0');
+      td::sha256(td::Slice(strings[i]).substr(0, prefix_size), td::Slice(strings[i]).substr(prefix_size),
+                 parts_output);
+      ASSERT_STREQ(answers[i], td::base64_encode(parts_output));
+    }
   }
 }
 
@@ -338,6 +383,26 @@ TEST(Crypto, crc32) {
   for (std::size_t i = 0; i < strings.size(); i++) {
     ASSERT_EQ(answers[i], td::crc32(strings[i]));
   }
+
+  auto bitwise_crc32 = [](td::Slice data) {
+    td::uint32 crc = 0xFFFFFFFF;
+    for (auto c : data) {
+      crc ^= static_cast<unsigned char>(c);
+      for (int k = 0; k < 8; k++) {
+        crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+      }
+    }
+    return ~crc;
+  };
+  td::Random::Xorshift128plus rnd(123);
+  td::string data(2000, '\0');
+  rnd.bytes(data);
+  for (int i = 0; i < 1000; i++) {
+    auto offset = static_cast<std::size_t>(rnd() % 16);
+    auto size = static_cast<std::size_t>(rnd() % (data.size() - offset));
+    auto slice = td::Slice(data).substr(offset, size);
+    ASSERT_EQ(bitwise_crc32(slice), td::crc32(slice));
+  }
 }
 #endif
 
@@ -8,6 +8,7 @@
 #include "td/utils/buffer.h"
 #include "td/utils/ByteFlow.h"
 #include "td/utils/common.h"
+#include "td/utils/crypto.h"
 #include "td/utils/Gzip.h"
 #include "td/utils/GzipByteFlow.h"
 #include "td/utils/logging.h"
@@ -29,6 +30,31 @@ TEST(Gzip, gzencode_gzdecode) {
   encode_decode(td::string(1000000, 'a'));
 }
 
+// converts the output of gzencode from zlib to gzip format with the given uncompressed size in the trailer
+static td::string to_gzip_format(td::Slice zlib_data, td::Slice data, td::uint32 size) {
+  CHECK(zlib_data.size() >= 6);
+  td::string result("\x1f\x8b\x08\0\0\0\0\0\0\xff", 10);
+  result += zlib_data.substr(2, zlib_data.size() - 6).str();
+  auto crc = td::crc32(data);
+  result.append(reinterpret_cast<const char *>(&crc), sizeof(crc));
+  result.append(reinterpret_cast<const char *>(&size), sizeof(size));
+  return result;
+}
+
+TEST(Gzip, gzdecode_gzip_format) {
+  for (auto &s : {td::rand_string(0, 255, 1000), td::rand_string('a', 'z', 1000000), td::string(1000000, 'a')}) {
+    auto zlib_data = td::gzencode(s, 2);
+    ASSERT_TRUE(!zlib_data.empty());
+    auto size = static_cast<td::uint32>(s.size());
+    ASSERT_EQ(s, td::gzdecode(to_gzip_format(zlib_data.as_slice(), s, size)));
+    // data with a wrong size in the trailer is corrupted
+    ASSERT_TRUE(td::gzdecode(to_gzip_format(zlib_data.as_slice(), s, size - 1)).empty());
+    ASSERT_TRUE(td::gzdecode(to_gzip_format(zlib_data.as_slice(), s, size + 1)).empty());
+    ASSERT_TRUE(td::gzdecode(to_gzip_format(zlib_data.as_slice(), s, 1)).empty());
+    ASSERT_TRUE(td::gzdecode(to_gzip_format(zlib_data.as_slice(), s, 0xFFFFFFFF)).empty());
+  }
+}
+
 static void test_gzencode(const td::string &s) {
   auto begin_time = td::Time::now();
   auto r = td::gzencode(s, td::max(2, static_cast<int>(100 / s.size())));
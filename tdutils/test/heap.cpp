@@ -10,6 +10,7 @@
 #include "td/utils/Heap.h"
 #include "td/utils/Random.h"
 #include "td/utils/Span.h"
+#include "td/utils/TimerWheel.h"
 
 #include <cstdio>
 #include <set>
@@ -176,3 +177,67 @@ TEST(Heap, random_events) {
     // heap.check();
   }
 }
+
+TEST(TimerWheel, random_events) {
+  td::Random::Xorshift128plus rnd(123);
+  auto random_timeout = [&rnd] {
+    switch (rnd.fast(0, 5)) {
+      case 0:
+        return rnd.fast(0, 1000) * 1e-6;
+      case 1:
+        return rnd.fast(0, 1000) * 1e-3;
+      case 2:
+        return static_cast<double>(rnd.fast(0, 1000));
+      case 3:
+        return rnd.fast(0, 1000) * 1e5;
+      case 4:
+        return 1e10;
+      default:
+        return -1.0;
+    }
+  };
+
+  int n = 1000;
+  td::vector<td::HeapNode> nodes(n);
+  td::vector<double> keys(n);
+  std::set<std::pair<double, int>> expected;
+  td::TimerWheel timer_wheel;
+  double now = 1e9;
+  for (int i = 0; i < 300000; i++) {
+    int id = rnd.fast(0, n - 1);
+    int x = rnd.fast(0, 9);
+    if (x < 4) {
+      auto key = now + random_timeout();
+      if (nodes[id].in_heap()) {
+        expected.erase(std::make_pair(keys[id], id));
+        timer_wheel.fix(key, &nodes[id]);
+      } else {
+        timer_wheel.insert(key, &nodes[id]);
+      }
+      keys[id] = key;
+      expected.emplace(key, id);
+    } else if (x < 5) {
+      if (nodes[id].in_heap()) {
+        expected.erase(std::make_pair(keys[id], id));
+        timer_wheel.erase(&nodes[id]);
+      }
+    } else {
+      now += x == 9 ? rnd.fast(0, 1000) * 1e3 : rnd.fast(0, 1000) * 1e-5;
+      while (true) {
+        auto *node = timer_wheel.pop_expired(now);
+        if (node == nullptr) {
+          break;
+        }
+        auto node_id = static_cast<int>(node - &nodes[0]);
+        ASSERT_TRUE(keys[node_id] < now);
+        ASSERT_EQ(1u, expected.erase(std::make_pair(keys[node_id], node_id)));
+      }
+      ASSERT_TRUE(expected.empty() || expected.begin()->first >= now);
+    }
+    ASSERT_EQ(expected.size(), timer_wheel.size());
+    if (!expected.empty()) {
+      ASSERT_TRUE(timer_wheel.get_wakeup_time() <= expected.begin()->first);
+      ASSERT_EQ(expected.begin()->first, timer_wheel.get_key(&nodes[expected.begin()->second]));
+    }
+  }
+}
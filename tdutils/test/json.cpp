@@ -55,6 +55,17 @@ TEST(JSON, object) {
   decode_encode(encoded);
 }
 
+TEST(JSON, string_escape) {
+  char tmp[1000];
+  td::StringBuilder sb(td::MutableSlice{tmp, sizeof(tmp)});
+  td::JsonBuilder jb(std::move(sb));
+  jb.enter_value().enter_array() << "" << "plain text" << "a\"b\\c\n" << "\x01" "end" << "\xd0\xbf\xd1\x80\xd0\xb8";
+  ASSERT_EQ(jb.string_builder().is_error(), false);
+  auto encoded = jb.string_builder().as_cslice().str();
+  ASSERT_EQ("[\"\",\"plain text\",\"a\\\"b\\\\c\\n\",\"\\u0001end\",\"\\u043f\\u0440\\u0438\"]", encoded);
+  decode_encode(encoded);
+}
+
 TEST(JSON, nested) {
   char tmp[1000];
   td::StringBuilder sb(td::MutableSlice{tmp, sizeof(tmp)});
@@ -116,6 +127,21 @@ TEST(JSON, json_object_get_field) {
     ASSERT_EQ(td::json_encode<td::string>(object.extract_field("")), "null");
   }
 
+  {
+    td::string encoded_object_copy = encoded_object;
+    auto value = td::json_decode(encoded_object_copy).move_as_ok();
+    auto &object = value.get_object();
+    ASSERT_EQ(td::json_encode<td::string>(object.extract_field("object")), "{}");
+    ASSERT_EQ(td::json_encode<td::string>(object.extract_field("string2")), "12345e+1");
+    ASSERT_EQ(td::json_encode<td::string>(object.extract_field("null")), "null");
+    ASSERT_EQ(td::json_encode<td::string>(object.extract_field("int2")), "2");
+    ASSERT_EQ(td::json_encode<td::string>(object.extract_field("int")), "\"1\"");
+    ASSERT_EQ(td::json_encode<td::string>(object.extract_field("array")), "[]");
+    ASSERT_EQ(td::json_encode<td::string>(object.extract_field("bool")), "true");
+    ASSERT_EQ(td::json_encode<td::string>(object.extract_field("object")), "null");
+    ASSERT_EQ(td::json_encode<td::string>(object.extract_field("long2")), "2123456789012");
+  }
+
   {
     td::string encoded_object_copy = encoded_object;
     auto value = td::json_decode(encoded_object_copy).move_as_ok();
@@ -249,6 +275,39 @@ TEST(JSON, bench_json_string_decode) {
   td::bench(JsonStringDecodeBenchmark(str));
 }
 
+class JsonStringEncodeBenchmark final : public td::Benchmark {
+  td::string str_;
+
+ public:
+  explicit JsonStringEncodeBenchmark(td::string str) : str_(std::move(str)) {
+  }
+
+  td::string get_description() const final {
+    return td::string("JsonStringEncodeBenchmark") + str_.substr(0, 6);
+  }
+
+  void run(int n) final {
+    size_t result = 0;
+    for (int i = 0; i < n; i++) {
+      result += td::json_encode<td::string>(td::json_object([&](auto &o) {
+                  o("text", str_);
+                  o("id", td::JsonLong(1234567890123 + i));
+                })).size();
+    }
+    td::do_not_optimize_away(result);
+  }
+};
+
+TEST(JSON, bench_json_string_encode) {
+  td::bench(JsonStringEncodeBenchmark(td::string(1000, 'a')));
+  td::bench(JsonStringEncodeBenchmark(td::string(1000, '\\')));
+  td::string str;
+  while (str.size() < 1000) {
+    str += "The quick brown fox jumps over the \"lazy\" dog.\n";
+  }
+  td::bench(JsonStringEncodeBenchmark(str));
+}
+
 static void test_string_decode(td::string str, const td::string &result) {
   auto str_copy = str;
   td::Parser skip_parser(str_copy);
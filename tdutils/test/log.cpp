@@ -185,3 +185,46 @@ TEST(Log, Bench) {
 #endif
 }
 #endif
+
+static int VERBOSITY_NAME(sampled_tag) = VERBOSITY_NAME(ERROR);
+
+TEST(Log, TagSampling) {
+  class CountingLog final : public td::LogInterface {
+   public:
+    void do_append(int log_level, td::CSlice slice) final {
+      count_++;
+    }
+    int count_ = 0;
+  };
+  CountingLog counting_log;
+  auto old_log_interface = td::log_interface;
+  td::log_interface = &counting_log;
+
+  int evaluated_count = 0;
+  auto log_lines = [&](int n) {
+    counting_log.count_ = 0;
+    evaluated_count = 0;
+    for (int i = 0; i < n; i++) {
+      VLOG(sampled_tag) << ++evaluated_count;
+    }
+  };
+
+  log_lines(100);
+  ASSERT_EQ(100, counting_log.count_);
+
+  ASSERT_TRUE(td::set_log_tag_sampling("sampled_tag", 10, 0));
+  log_lines(100);
+  ASSERT_EQ(10, counting_log.count_);
+  ASSERT_EQ(10, evaluated_count);
+
+  ASSERT_TRUE(td::set_log_tag_sampling("sampled_tag", 0, 5));
+  log_lines(100);
+  ASSERT_EQ(5, counting_log.count_);
+  ASSERT_EQ(5, evaluated_count);
+
+  ASSERT_TRUE(td::set_log_tag_sampling("sampled_tag", 0, 0));
+  log_lines(100);
+  ASSERT_EQ(100, counting_log.count_);
+
+  td::log_interface = old_log_interface;
+}
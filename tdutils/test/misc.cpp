@@ -13,11 +13,13 @@
 #include "td/utils/CancellationToken.h"
 #include "td/utils/common.h"
 #include "td/utils/ExitGuard.h"
+#include "td/utils/FloodControlAdaptive.h"
 #include "td/utils/FloodControlFast.h"
 #include "td/utils/Hash.h"
 #include "td/utils/HashMap.h"
 #include "td/utils/HashSet.h"
 #include "td/utils/HashTableUtils.h"
+#include "td/utils/Hints.h"
 #include "td/utils/invoke.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
@@ -587,6 +589,21 @@ TEST(Misc, to_double) {
   test_to_double();
 }
 
+TEST(Misc, static_error) {
+  static const td::Status status = td::Status::StaticError(500, "Request aborted");
+  ASSERT_TRUE(status.is_static());
+  for (int i = 0; i < 3; i++) {
+    auto error = status.clone();
+    ASSERT_TRUE(error.is_static());
+    ASSERT_EQ(500, error.code());
+    ASSERT_EQ("Request aborted", error.message());
+    ASSERT_EQ(status.message().begin(), error.message().begin());
+    auto prefixed_error = error.move_as_error_prefix("Prefix: ");
+    ASSERT_TRUE(!prefixed_error.is_static());
+    ASSERT_EQ("Prefix: Request aborted", prefixed_error.message());
+  }
+}
+
 TEST(Misc, print_int) {
   ASSERT_STREQ("-9223372036854775808", PSLICE() << -9223372036854775807 - 1);
   ASSERT_STREQ("-2147483649", PSLICE() << -2147483649ll);
@@ -689,6 +706,81 @@ TEST(Misc, to_wstring) {
 }
 #endif
 
+static bool check_utf8_slow(td::Slice str) {
+  size_t i = 0;
+  while (i < str.size()) {
+    auto a = static_cast<unsigned char>(str[i]);
+    size_t length = a < 0x80 ? 1 : a < 0xC0 ? 0 : a < 0xE0 ? 2 : a < 0xF0 ? 3 : a < 0xF8 ? 4 : 0;
+    if (length == 0 || i + length > str.size()) {
+      return false;
+    }
+    td::uint32 code = length == 1 ? a : a & (0x7F >> length);
+    for (size_t j = 1; j < length; j++) {
+      auto c = static_cast<unsigned char>(str[i + j]);
+      if ((c & 0xC0) != 0x80) {
+        return false;
+      }
+      code = (code << 6) | (c & 0x3F);
+    }
+    static const td::uint32 min_codes[] = {0, 0, 0x80, 0x800, 0x10000};
+    if (code < min_codes[length] || code > 0x10FFFF || (0xD800 <= code && code <= 0xDFFF)) {
+      return false;
+    }
+    i += length;
+  }
+  return true;
+}
+
+static td::Slice utf8_utf16_truncate_slow(td::Slice str, size_t length) {
+  for (size_t i = 0; i < str.size(); i++) {
+    auto c = static_cast<unsigned char>(str[i]);
+    if (td::is_utf8_character_first_code_unit(c)) {
+      if (length <= 0) {
+        return str.substr(0, i);
+      }
+      length--;
+      if (c >= 0xf0) {
+        length--;
+      }
+    }
+  }
+  return str;
+}
+
+TEST(Misc, utf8_blocks) {
+  td::vector<td::string> parts{"a", "abcdefghijklmnopqrstuvwxyz", "\xd0\xb0", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+                               "\0", "\x80", "\xc0\x80", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xff", "\xe2\x82",
+                               "\xf0\x9f\x98"};
+  for (int i = 0; i < 100000; i++) {
+    td::string str;
+    auto part_count = td::Random::fast(0, 20);
+    for (int j = 0; j < part_count; j++) {
+      // invalid parts are rare to check long valid strings too
+      auto max_part = td::Random::fast(0, 10) == 0 ? static_cast<int>(parts.size()) - 1 : 5;
+      str += parts[td::Random::fast(0, max_part)];
+    }
+
+    ASSERT_EQ(check_utf8_slow(str), td::check_utf8(str));
+
+    bool is_ascii = true;
+    size_t length = 0;
+    size_t utf16_length = 0;
+    for (auto c : str) {
+      is_ascii &= static_cast<unsigned char>(c) < 0x80;
+      length += td::is_utf8_character_first_code_unit(static_cast<unsigned char>(c));
+      utf16_length += td::is_utf8_character_first_code_unit(static_cast<unsigned char>(c)) + ((c & 0xf8) == 0xf0);
+    }
+    ASSERT_EQ(is_ascii, td::is_ascii(str));
+    ASSERT_EQ(length, td::utf8_length(str));
+    ASSERT_EQ(utf16_length, td::utf8_utf16_length(str));
+
+    if (check_utf8_slow(str)) {
+      auto truncate_length = static_cast<size_t>(td::Random::fast(0, static_cast<int>(utf16_length) + 1));
+      ASSERT_EQ(utf8_utf16_truncate_slow(str, truncate_length), td::utf8_utf16_truncate(str, truncate_length));
+    }
+  }
+}
+
 static void test_translit(const td::string &word, const td::vector<td::string> &result, bool allow_partial = true) {
   ASSERT_EQ(result, td::get_word_transliterations(word, allow_partial));
 }
@@ -721,6 +813,88 @@ static void test_unicode(td::uint32 (*func)(td::uint32)) {
   }
 }
 
+TEST(Misc, Hints) {
+  td::Hints hints;
+  std::unordered_map<td::int64, td::vector<td::string>> key_to_words;
+  std::unordered_map<td::int64, td::int64> key_to_rating;
+  auto get_random_word = [] {
+    td::string word;
+    auto length = td::Random::fast(1, 3);
+    for (int i = 0; i < length; i++) {
+      word += static_cast<char>(td::Random::fast('1', '4'));
+    }
+    return word;
+  };
+
+  for (int i = 0; i < 20000; i++) {
+    td::int64 key = td::Random::fast(1, 1000);
+    if (td::Random::fast_bool()) {
+      td::vector<td::string> words;
+      auto word_count = td::Random::fast(0, 3);
+      for (int j = 0; j < word_count; j++) {
+        words.push_back(get_random_word());
+      }
+      hints.add(key, td::implode(words, ' '));
+      if (words.empty()) {
+        key_to_words.erase(key);
+        key_to_rating.erase(key);
+      } else {
+        key_to_words[key] = std::move(words);
+      }
+    } else if (td::Random::fast(0, 3) == 0) {
+      td::int64 rating = td::Random::fast(1, 5);
+      hints.set_rating(key, rating);
+      key_to_rating[key] = rating;
+    } else {
+      td::vector<td::string> query_words;
+      auto word_count = td::Random::fast(1, 2);
+      for (int j = 0; j < word_count; j++) {
+        query_words.push_back(get_random_word());
+      }
+      td::vector<std::pair<td::int64, td::int64>> expected;
+      for (auto &it : key_to_words) {
+        bool is_found = true;
+        for (auto &query_word : query_words) {
+          bool has_word = false;
+          for (auto &word : it.second) {
+            has_word |= td::begins_with(word, query_word);
+          }
+          is_found &= has_word;
+        }
+        if (is_found) {
+          auto rating_it = key_to_rating.find(it.first);
+          expected.emplace_back(rating_it == key_to_rating.end() ? 0 : rating_it->second, it.first);
+        }
+      }
+      std::sort(expected.begin(), expected.end());
+      auto limit = td::Random::fast(0, 10);
+      auto total_count = expected.size();
+      if (expected.size() > static_cast<size_t>(limit)) {
+        expected.resize(limit);
+      }
+      auto expected_keys = td::transform(expected, [](const auto &it) { return it.second; });
+
+      auto result = hints.search(td::implode(query_words, ' '), limit);
+      ASSERT_EQ(total_count, result.first);
+      ASSERT_EQ(expected_keys, result.second);
+    }
+    ASSERT_EQ(key_to_words.size(), hints.size());
+  }
+
+  auto memory_usage = hints.get_memory_usage();
+  ASSERT_TRUE(memory_usage > sizeof(td::Hints));
+  for (td::int64 key = 1; key <= 1000; key++) {
+    hints.add(key, td::string(20, '1') + ' ' + td::string(30, '2'));
+  }
+  auto full_memory_usage = hints.get_memory_usage();
+  ASSERT_TRUE(full_memory_usage > memory_usage + 1000 * 50);
+  for (td::int64 key = 1; key <= 1000; key++) {
+    hints.remove(key);
+  }
+  ASSERT_EQ(0u, hints.size());
+  ASSERT_TRUE(hints.get_memory_usage() + 1000 * 50 < full_memory_usage);
+}
+
 TEST(Misc, unicode) {
   test_unicode(td::prepare_search_character);
   test_unicode(td::unicode_to_lower);
@@ -1062,6 +1236,20 @@ TEST(Misc, BitsRange) {
   }
 }
 
+TEST(Misc, now_cached) {
+  auto cached_now = td::Time::update_now_cached();
+  ASSERT_TRUE(cached_now <= td::Time::now());
+  ASSERT_EQ(cached_now, td::Time::now_cached());
+  ASSERT_EQ(cached_now, td::Timestamp::now_cached().at());
+
+  td::Time::jump_in_future(cached_now + 1);
+  ASSERT_TRUE(td::Time::now_cached() >= cached_now + 1);
+
+  td::Time::reset_now_cached();
+  auto now = td::Time::now();
+  ASSERT_TRUE(now <= td::Time::now_cached());
+}
+
 #if !TD_THREAD_UNSUPPORTED
 TEST(Misc, Time) {
   td::Stage run;
@@ -1363,6 +1551,48 @@ TEST(FloodControl, Fast) {
   }
 }
 
+TEST(FloodControl, Adaptive) {
+  td::FloodControlAdaptive fc;
+  ASSERT_TRUE(fc.is_unlimited(0));
+  ASSERT_TRUE(fc.get_wakeup_at(0) <= 0);
+  fc.add_event(0);
+  ASSERT_TRUE(fc.get_wakeup_at(0) <= 0);
+
+  fc.on_flood_wait(10, 20);
+  ASSERT_TRUE(!fc.is_unlimited(10));
+  ASSERT_EQ(2.0, fc.get_interval());
+  ASSERT_EQ(30.0, fc.get_wakeup_at(10));
+
+  double now = fc.get_wakeup_at(10);
+  fc.add_event(now);
+  now = fc.get_wakeup_at(now);
+  ASSERT_TRUE(now >= 32.0 - 1e-9);
+  for (int i = 0; i < 10; i++) {
+    now = fc.get_wakeup_at(now);
+    fc.add_event(now);
+  }
+  ASSERT_TRUE(now >= 50.0 - 1e-9);
+
+  // idle time allows a small burst of events
+  now += 100;
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(fc.get_wakeup_at(now) <= now);
+    fc.add_event(now);
+  }
+  ASSERT_TRUE(fc.get_wakeup_at(now) > now);
+
+  fc.on_flood_wait(now, 1);
+  ASSERT_EQ(4.0, fc.get_interval());
+
+  td::FloodControlAdaptive restored(fc.get_interval(), fc.get_blocked_until(), fc.get_changed_at());
+  ASSERT_EQ(fc.get_wakeup_at(now), restored.get_wakeup_at(now));
+
+  // the limit disappears after enough time without flood waits
+  ASSERT_TRUE(!fc.is_unlimited(now + td::FloodControlAdaptive::DECAY_PERIOD * 5));
+  ASSERT_TRUE(fc.is_unlimited(now + td::FloodControlAdaptive::DECAY_PERIOD * 7));
+  ASSERT_EQ(0.0, fc.get_interval());
+}
+
 TEST(UniqueValuePtr, Basic) {
   auto a = td::make_unique_value<int>(5);
   td::unique_value_ptr<int> b;
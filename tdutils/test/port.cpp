@@ -12,6 +12,8 @@
 #include "td/utils/port/FileFd.h"
 #include "td/utils/port/IoSlice.h"
 #include "td/utils/port/path.h"
+#include "td/utils/port/Poll.h"
+#include "td/utils/port/PollFlags.h"
 #include "td/utils/port/signals.h"
 #include "td/utils/port/sleep.h"
 #include "td/utils/port/Stat.h"
@@ -148,6 +150,44 @@ TEST(Port, LargeFiles) {
   td::unlink(path).ensure();
 }
 
+TEST(Port, DropPageCache) {
+  td::CSlice path = "page_cache.txt";
+  td::unlink(path).ignore();
+  auto fd = td::FileFd::open(path, td::FileFd::Write | td::FileFd::Read | td::FileFd::CreateNew).move_as_ok();
+  td::string data(1 << 20, 'a');
+  ASSERT_EQ(data.size(), fd.pwrite(data, 0).move_as_ok());
+  fd.drop_page_cache(0, static_cast<td::int64>(data.size())).ensure();
+  ASSERT_TRUE(fd.drop_page_cache(-1, 1).is_error());
+  td::string content(data.size(), '\0');
+  ASSERT_EQ(content.size(), fd.pread(content, 0).move_as_ok());
+  ASSERT_EQ(data, content);
+  fd.close();
+  td::unlink(path).ensure();
+}
+
+TEST(Port, HardLinks) {
+  td::CSlice path = "hard_link_source.txt";
+  td::CSlice link_path = "hard_link.txt";
+  td::unlink(path).ignore();
+  td::unlink(link_path).ignore();
+  auto fd = td::FileFd::open(path, td::FileFd::Write | td::FileFd::CreateNew).move_as_ok();
+  ASSERT_EQ(4u, fd.write("abcd").move_as_ok());
+  fd.close();
+  ASSERT_EQ(1, td::stat(path).ok().link_count_);
+  auto status = td::link(path, link_path);
+  if (status.is_error()) {
+    LOG(ERROR) << "File system doesn't support hard links: " << status;
+    td::unlink(path).ensure();
+    return;
+  }
+  ASSERT_TRUE(td::link(path, link_path).is_error());
+  ASSERT_EQ(2, td::stat(path).ok().link_count_);
+  ASSERT_EQ(4, td::stat(link_path).ok().size_);
+  td::unlink(path).ensure();
+  ASSERT_EQ(1, td::stat(link_path).ok().link_count_);
+  td::unlink(link_path).ensure();
+}
+
 TEST(Port, Writev) {
   td::vector<td::IoSlice> vec;
   td::CSlice test_file_path = "test.txt";
@@ -295,6 +335,44 @@ TEST(Port, EventFdAndSignals) {
 #endif
 #endif
 
+#if TD_POLL_IO_URING
+TEST(Port, IoUringPoll) {
+  td::detail::IoUring::set_enabled(true);
+  SCOPE_EXIT {
+    td::detail::IoUring::set_enabled(false);
+  };
+  td::Poll poll;
+  poll.init();
+  if (!poll.is_io_uring_used()) {
+    LOG(ERROR) << "io_uring isn't supported";
+  }
+
+  td::EventFd event_fd;
+  event_fd.init();
+  auto &poll_info = event_fd.get_poll_info();
+  poll.subscribe(poll_info.extract_pollable_fd(nullptr), td::PollFlags::Read());
+  poll.run(0);
+  ASSERT_TRUE(!poll_info.sync_with_poll().can_read());
+
+  for (int i = 0; i < 3; i++) {
+    event_fd.release();
+    poll.run(1000);
+    ASSERT_TRUE(poll_info.sync_with_poll().can_read());
+    event_fd.acquire();
+    ASSERT_TRUE(!poll_info.get_flags_local().can_read());
+    poll.run(0);
+    ASSERT_TRUE(!poll_info.sync_with_poll().can_read());
+  }
+
+  poll.unsubscribe(poll_info.get_pollable_fd_ref());
+  event_fd.release();
+  poll.run(10);
+  ASSERT_TRUE(!poll_info.sync_with_poll().can_read());
+  poll.clear();
+  event_fd.close();
+}
+#endif
+
 #if TD_HAVE_THREAD_AFFINITY
 TEST(Port, ThreadAffinityMask) {
   auto thread_id = td::this_thread::get_id();
@@ -14,6 +14,7 @@
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteKeyValue.h"
+#include "td/db/SqliteKeyValueAsync.h"
 #include "td/db/SqliteKeyValueSafe.h"
 #include "td/db/TsSeqKeyValue.h"
 
@@ -26,9 +27,11 @@
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/FileFd.h"
+#include "td/utils/port/Stat.h"
 #include "td/utils/port/thread.h"
 #include "td/utils/Random.h"
 #include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/tests.h"
@@ -138,6 +141,121 @@ TEST(DB, binlog_encryption) {
   td::Binlog::destroy(binlog_name).ignore();
 }
 
+TEST(DB, binlog_compression) {
+  td::CSlice binlog_name = "test_binlog";
+  td::Binlog::destroy(binlog_name).ignore();
+
+  td::string random_data(2000, '\0');
+  td::Random::secure_bytes(random_data);
+  td::vector<td::string> data{"AAAA", td::string(10000, 'Z'), random_data, td::rand_string('a', 'z', 2000),
+                              td::string(100000, 'B')};
+  td::vector<bool> is_compressed{false, true, false, true, true};
+  for (size_t i = 0; i < data.size(); i++) {
+    // the flag Compressed passed to create_raw must be ignored
+    auto event = td::BinlogEvent(
+        td::BinlogEvent::create_raw(1, 1, td::BinlogEvent::Flags::Compressed, td::create_storer(data[i])),
+        td::BinlogDebugInfo{__FILE__, __LINE__});
+    event.validate().ensure();
+    ASSERT_EQ(data[i], event.get_data().str());
+    ASSERT_EQ(is_compressed[i], (event.flags_ & td::BinlogEvent::Flags::Compressed) != 0);
+  }
+
+  for (auto key : {td::DbKey::empty(), td::DbKey::password("cucumber")}) {
+    {
+      td::Binlog binlog;
+      binlog.init(binlog_name.str(), [](const td::BinlogEvent &x) {}, key).ensure();
+      for (auto &str : data) {
+        binlog.add(1, td::create_storer(str));
+      }
+      binlog.close().ensure();
+    }
+    ASSERT_TRUE(td::stat(binlog_name).move_as_ok().size_ < 5000);
+
+    td::vector<td::string> v;
+    td::Binlog binlog;
+    binlog.init(binlog_name.str(), [&](const td::BinlogEvent &x) { v.push_back(x.get_data().str()); }, key).ensure();
+    binlog.close().ensure();
+    ASSERT_TRUE(v == data);
+    td::Binlog::destroy(binlog_name).ignore();
+  }
+}
+
+TEST(DB, binlog_reindex_on_close) {
+  td::CSlice binlog_name = "test_binlog";
+  td::Binlog::destroy(binlog_name).ignore();
+
+  // the binlog is too small to be reindexed while events are added
+  td::vector<td::string> data;
+  for (int i = 0; i < 20; i++) {
+    td::string str(1000, '\0');
+    td::Random::secure_bytes(str);
+    data.push_back(std::move(str));
+  }
+  {
+    td::Binlog binlog;
+    binlog.init(binlog_name.str(), [](const td::BinlogEvent &x) {}).ensure();
+    td::vector<td::uint64> event_ids;
+    for (auto &str : data) {
+      event_ids.push_back(binlog.add(1, td::create_storer(str)));
+    }
+    for (int i = 0; i < 2; i++) {
+      for (size_t j = 0; j < data.size(); j++) {
+        binlog.rewrite(event_ids[j], 1, td::create_storer(data[j]));
+      }
+    }
+    binlog.close().ensure();
+  }
+  ASSERT_TRUE(td::stat(binlog_name).move_as_ok().size_ < 30000);
+
+  td::vector<td::string> v;
+  td::Binlog binlog;
+  binlog.init(binlog_name.str(), [&](const td::BinlogEvent &x) { v.push_back(x.get_data().str()); }).ensure();
+  binlog.close().ensure();
+  ASSERT_TRUE(v == data);
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
+TEST(DB, concurrent_binlog_sync) {
+  td::CSlice binlog_name = "test_binlog";
+  td::Binlog::destroy(binlog_name).ignore();
+
+  const int sync_count = 100;
+  td::BinlogSyncStats stats;
+  td::ConcurrentScheduler sched(0, 0);
+  {
+    auto guard = sched.get_main_guard();
+    auto binlog = std::make_shared<td::ConcurrentBinlog>();
+    binlog->init(binlog_name.str(), [](const td::BinlogEvent &x) {}).ensure();
+    binlog->set_sync_delay(0.01);
+    auto left_count = std::make_shared<int>(sync_count);
+    for (int i = 0; i < sync_count; i++) {
+      binlog->add(1, td::create_storer("AAAA"));
+      binlog->force_sync(td::PromiseCreator::lambda([binlog, left_count, &stats](td::Unit) {
+                           if (--*left_count == 0) {
+                             binlog->get_sync_stats(
+                                 td::PromiseCreator::lambda([binlog, &stats](td::BinlogSyncStats result) {
+                                   stats = result;
+                                   binlog->close(td::PromiseCreator::lambda(
+                                       [](td::Unit) { td::Scheduler::instance()->finish(); }));
+                                 }));
+                           }
+                         }),
+                         "concurrent_binlog_sync");
+    }
+  }
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+
+  ASSERT_EQ(1, stats.sync_count);
+  ASSERT_EQ(sync_count, stats.synced_promise_count);
+  ASSERT_EQ(sync_count, stats.max_batch_size);
+  ASSERT_TRUE(stats.max_wait_time < 1.0);
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
 TEST(DB, sqlite_lfs) {
   td::string path = "test_sqlite_db";
   td::SqliteDb::destroy(path).ignore();
@@ -147,6 +265,118 @@ TEST(DB, sqlite_lfs) {
   td::SqliteDb::destroy(path).ignore();
 }
 
+TEST(DB, sqlite_statement_cache) {
+  td::string path = "test_sqlite_db";
+  td::SqliteDb::destroy(path).ignore();
+  auto db = td::SqliteDb::open_with_key(path, true, td::DbKey::empty()).move_as_ok();
+  db.exec("CREATE TABLE t (k INT4 PRIMARY KEY, v INT4)").ensure();
+  db.exec("INSERT INTO t VALUES (1, 10), (2, 20)").ensure();
+  ASSERT_TRUE(db.has_table("t").move_as_ok());
+  ASSERT_TRUE(!db.has_table("u").move_as_ok());
+
+  auto get_value = [](td::SqliteDb &db, td::int32 key) {
+    auto stmt = db.get_cached_statement("SELECT v FROM t WHERE k = ?1").move_as_ok();
+    auto guard = stmt->guard();
+    stmt->bind_int32(1, key).ensure();
+    stmt->step().ensure();
+    return stmt->has_row() ? stmt->view_int32(0) : -1;
+  };
+  auto clone = db.clone();
+  auto *stmt = db.get_cached_statement("SELECT v FROM t WHERE k = ?1").move_as_ok();
+  ASSERT_EQ(stmt, clone.get_cached_statement("SELECT v FROM t WHERE k = ?1").move_as_ok());
+  ASSERT_EQ(10, get_value(db, 1));
+  ASSERT_EQ(20, get_value(clone, 2));
+  ASSERT_EQ(-1, get_value(db, 3));
+
+  // the statement isn't reset and must be reset by the cache
+  stmt->bind_int32(1, 1).ensure();
+  stmt->step().ensure();
+  ASSERT_EQ(20, get_value(db, 2));
+
+  for (size_t i = 0; i <= td::SqliteDb::MAX_CACHED_STATEMENTS; i++) {
+    auto other_stmt = db.get_cached_statement(PSLICE() << "SELECT v + " << i << " FROM t WHERE k = ?1").move_as_ok();
+    other_stmt->bind_int32(1, 1).ensure();
+    other_stmt->step().ensure();
+    ASSERT_EQ(static_cast<td::int32>(10 + i), other_stmt->view_int32(0));
+    other_stmt->reset();
+  }
+  ASSERT_EQ(10, get_value(db, 1));
+  ASSERT_TRUE(db.get_cached_statement("SELECT FROM").is_error());
+
+  db.close();
+  clone.close();
+  td::SqliteDb::destroy(path).ignore();
+}
+
+TEST(DB, sqlite_read_only_connection) {
+  td::string path = "test_sqlite_db";
+  td::SqliteDb::destroy(path).ignore();
+  td::ConcurrentScheduler sched(0, 0);
+  auto guard = sched.get_main_guard();
+
+  td::SqliteConnectionSafe writer(path, td::DbKey::empty());
+  writer.set(td::SqliteDb::open_with_key(path, true, td::DbKey::empty()).move_as_ok());
+  writer.get().exec("PRAGMA journal_mode=WAL").ensure();
+  writer.get().exec("CREATE TABLE t (k INT4 PRIMARY KEY, v INT4)").ensure();
+  writer.get().exec("INSERT INTO t VALUES (1, 10)").ensure();
+
+  td::SqliteConnectionSafe reader(path, td::DbKey::empty(), {}, true);
+  auto get_count = [&reader] {
+    auto stmt = reader.get().get_cached_statement("SELECT count(*) FROM t").move_as_ok();
+    auto stmt_guard = stmt->guard();
+    stmt->step().ensure();
+    return stmt->view_int32(0);
+  };
+  ASSERT_TRUE(reader.get().exec("INSERT INTO t VALUES (2, 20)").is_error());
+  writer.get().begin_write_transaction().ensure();
+  writer.get().exec("INSERT INTO t VALUES (3, 30)").ensure();
+  // the reader isn't blocked by the write transaction and sees only committed data
+  ASSERT_EQ(1, get_count());
+  writer.get().commit_transaction().ensure();
+  ASSERT_EQ(2, get_count());
+
+  reader.close();
+  writer.close_and_destroy();
+}
+
+TEST(DB, sqlite_key_value_async_batching) {
+  td::string path = "test_sqlite_db";
+  td::SqliteDb::destroy(path).ignore();
+
+  const int query_count = 10000;
+  td::SqliteKeyValueAsyncStats stats;
+  td::ConcurrentScheduler sched(0, 0);
+  {
+    auto guard = sched.get_main_guard();
+    auto connection = std::make_shared<td::SqliteConnectionSafe>(path, td::DbKey::empty());
+    connection->set(td::SqliteDb::open_with_key(path, true, td::DbKey::empty()).move_as_ok());
+    auto kv_safe = std::make_shared<td::SqliteKeyValueSafe>("kv", connection);
+    std::shared_ptr<td::SqliteKeyValueAsyncInterface> kv_async(td::create_sqlite_key_value_async(kv_safe, 0).release());
+    for (int i = 0; i < query_count; i++) {
+      kv_async->set(PSTRING() << "key" << i % 1000, PSTRING() << i, td::Promise<td::Unit>());
+    }
+    kv_async->get("key999", td::PromiseCreator::lambda([](td::string value) { ASSERT_EQ("9999", value); }));
+    kv_async->erase_by_prefix("unknown", td::Promise<td::Unit>());
+    kv_async->get_stats(
+        td::PromiseCreator::lambda([&stats](td::SqliteKeyValueAsyncStats result) { stats = result; }));
+    kv_async->close(td::PromiseCreator::lambda([kv_async, kv_safe, connection](td::Unit) {
+      kv_safe->close();
+      connection->close_and_destroy();
+      td::Scheduler::instance()->finish();
+    }));
+  }
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+
+  ASSERT_EQ(query_count, stats.committed_query_count);
+  ASSERT_TRUE(stats.commit_count > 0);
+  ASSERT_TRUE(stats.commit_count < query_count / 100);
+  ASSERT_TRUE(stats.max_batch_size > 100);
+}
+
 TEST(DB, sqlite_encryption) {
   td::string path = "test_sqlite_db";
   td::SqliteDb::destroy(path).ignore();
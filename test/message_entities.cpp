@@ -721,6 +721,59 @@ TEST(MessageEntities, url) {
   check_url("_.test.com", {"_.test.com"});
 }
 
+TEST(MessageEntities, find_entities) {
+  td::vector<td::string> parts{"@", "/", "#", "$", ":", ".", "0", "1", "4", "9", " ", "-", "a", "z", "t.me", "tg:",
+                               "gmail.com", "\xd0\xb0", "\xf0\x9f\x98\x80"};
+  for (int i = 0; i < 10000; i++) {
+    td::string str;
+    int part_n = td::Random::fast(0, 40);
+    for (int j = 0; j < part_n; j++) {
+      str += parts[td::Random::fast(0, static_cast<int>(parts.size()) - 1)];
+    }
+
+    td::vector<std::pair<td::Slice, td::MessageEntity::Type>> expected_entities;
+    auto add_entities = [&](td::MessageEntity::Type type, const td::vector<td::Slice> &entities) {
+      for (auto entity : entities) {
+        expected_entities.emplace_back(entity, type);
+      }
+    };
+    add_entities(td::MessageEntity::Type::Mention, td::find_mentions(str));
+    add_entities(td::MessageEntity::Type::BotCommand, td::find_bot_commands(str));
+    add_entities(td::MessageEntity::Type::Hashtag, td::find_hashtags(str));
+    add_entities(td::MessageEntity::Type::Cashtag, td::find_cashtags(str));
+    add_entities(td::MessageEntity::Type::BankCardNumber, td::find_bank_card_numbers(str));
+    add_entities(td::MessageEntity::Type::Url, td::find_tg_urls(str));
+    for (auto &url : td::find_urls(str)) {
+      expected_entities.emplace_back(url.first,
+                                     url.second ? td::MessageEntity::Type::EmailAddress : td::MessageEntity::Type::Url);
+    }
+    for (auto &media_timestamp : td::find_media_timestamps(str)) {
+      expected_entities.emplace_back(media_timestamp.first, td::MessageEntity::Type::MediaTimestamp);
+    }
+    std::sort(expected_entities.begin(), expected_entities.end(),
+              [](const auto &lhs, const auto &rhs) { return lhs.first.begin() < rhs.first.begin(); });
+
+    // intersecting entities are removed by find_entities
+    bool has_intersecting_entities = false;
+    for (size_t j = 1; j < expected_entities.size(); j++) {
+      if (expected_entities[j].first.begin() < expected_entities[j - 1].first.end()) {
+        has_intersecting_entities = true;
+      }
+    }
+    auto entities = td::find_entities(str, false, false);
+    if (has_intersecting_entities) {
+      ASSERT_TRUE(entities.size() < expected_entities.size());
+      continue;
+    }
+    ASSERT_EQ(expected_entities.size(), entities.size());
+    for (size_t j = 0; j < entities.size(); j++) {
+      ASSERT_TRUE(expected_entities[j].second == entities[j].type);
+      auto offset = td::utf8_utf16_length(td::Slice(str.data(), expected_entities[j].first.begin()));
+      ASSERT_EQ(offset, static_cast<size_t>(entities[j].offset));
+    }
+  }
+}
+
 static void check_fix_formatted_text(td::string str, td::vector<td::MessageEntity> entities,
                                      const td::string &expected_str,
                                      const td::vector<td::MessageEntity> &expected_entities, bool allow_empty = true,
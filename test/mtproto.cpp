@@ -12,6 +12,7 @@
 
 #include "td/mtproto/AuthData.h"
 #include "td/mtproto/DhCallback.h"
+#include "td/mtproto/DhExponentPool.h"
 #include "td/mtproto/DhHandshake.h"
 #include "td/mtproto/Handshake.h"
 #include "td/mtproto/HandshakeActor.h"
@@ -31,6 +32,7 @@
 #include "td/actor/ConcurrentScheduler.h"
 
 #include "td/utils/base64.h"
+#include "td/utils/BigNum.h"
 #include "td/utils/BufferedFd.h"
 #include "td/utils/common.h"
 #include "td/utils/crypto.h"
@@ -38,6 +40,7 @@
 #include "td/utils/logging.h"
 #include "td/utils/port/Clocks.h"
 #include "td/utils/port/IPAddress.h"
+#include "td/utils/port/sleep.h"
 #include "td/utils/port/SocketFd.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Random.h"
@@ -741,3 +744,33 @@ TEST(Mtproto, RSA) {
   rsa.encrypt(pem.substr(0, 256), to);
   ASSERT_EQ("U2nJEtB2AgpHrm3HB0yhpTQgb0wbesi9Pv/W1v/vULU=", td::base64_encode(td::sha256(to)));
 }
+
+#if !TD_THREAD_UNSUPPORTED
+TEST(Mtproto, DhExponentPool) {
+  td::BigNum prime;
+  td::BigNum::random(prime, 2048, 0, 1);
+  auto prime_str = prime.to_binary();
+  td::BigNum g;
+  g.set_value(3);
+
+  td::BigNumContext ctx;
+  td::string last_b;
+  int found_count = 0;
+  for (int i = 0; i < 1000 && found_count < 10; i++) {
+    td::BigNum b;
+    td::BigNum g_b;
+    if (!td::mtproto::DhExponentPool::get_exponent(3, prime_str, b, g_b)) {
+      td::usleep_for(10000);
+      continue;
+    }
+    found_count++;
+
+    td::BigNum expected_g_b;
+    td::BigNum::mod_exp(expected_g_b, g, b, prime, ctx);
+    ASSERT_EQ(expected_g_b.to_binary(), g_b.to_binary());
+    ASSERT_TRUE(b.to_binary() != last_b);
+    last_b = b.to_binary();
+  }
+  ASSERT_EQ(10, found_count);
+}
+#endif
@@ -8,7 +8,12 @@
 
 #include "td/telegram/Client.h"
 #include "td/telegram/ClientActor.h"
+#include "td/telegram/DialogId.h"
+#include "td/telegram/files/BandwidthLimiter.h"
+#include "td/telegram/files/FileGcIndex.h"
+#include "td/telegram/files/FileType.h"
 #include "td/telegram/files/PartsManager.h"
+#include "td/telegram/files/UploadSpeedEstimator.h"
 #include "td/telegram/td_api.h"
 
 #include "td/actor/actor.h"
@@ -42,6 +47,10 @@
 #include <set>
 #include <utility>
 
+#if TD_PORT_POSIX
+#include <poll.h>
+#endif
+
 template <class T>
 static void check_td_error(T &result) {
   LOG_CHECK(result->get_id() != td::td_api::error::ID) << to_string(result);
@@ -970,7 +979,100 @@ TEST(Client, Manager) {
   }
 }
 
+TEST(Client, ManagerReceiveBatch) {
+  td::ClientManager client;
+  int clients_n = 100;
+  for (int i = 0; i < clients_n; i++) {
+    auto id = client.create_client_id();
+    client.send(id, 3, td::make_tl_object<td::td_api::testSquareInt>(3));
+  }
+
+  std::set<td::int32> ids;
+  while (ids.size() != static_cast<size_t>(clients_n)) {
+    auto events = client.receive_batch(10, 7);
+    ASSERT_TRUE(!events.empty());
+    ASSERT_TRUE(events.size() <= 7u);
+    for (auto &event : events) {
+      ASSERT_TRUE(event.object != nullptr);
+      if (event.request_id == 3) {
+        ASSERT_EQ(td::td_api::testInt::ID, event.object->get_id());
+        ASSERT_TRUE(ids.insert(event.client_id).second);
+      }
+    }
+  }
+}
+
 #if !TD_EVENTFD_UNSUPPORTED  // Client must be used from a single thread if there is no EventFd
+TEST(Client, ManagerReceiveGroup) {
+  td::ClientManager client;
+  int groups_n = 4;
+  int clients_n = 10;
+  std::map<td::int32, td::int32> client_groups;
+  for (int i = 0; i < groups_n * clients_n; i++) {
+    auto id = client.create_client_id();
+    auto group_id = i % groups_n + 1;
+    client.set_receive_group(id, group_id);
+    client_groups[id] = group_id;
+    client.send(id, 3, td::make_tl_object<td::td_api::testSquareInt>(3));
+  }
+
+  td::vector<td::thread> threads;
+  std::atomic<int> ok_count{0};
+  for (int i = 0; i < groups_n; i++) {
+    threads.emplace_back([&, group_id = i + 1] {
+      std::set<td::int32> ids;
+      while (ids.size() != static_cast<size_t>(clients_n)) {
+        auto event = client.receive_group(group_id, 10);
+        ASSERT_TRUE(event.object != nullptr);
+        ASSERT_EQ(group_id, client_groups.at(event.client_id));
+        if (event.request_id == 3) {
+          ASSERT_EQ(td::td_api::testInt::ID, event.object->get_id());
+          ASSERT_TRUE(ids.insert(event.client_id).second);
+          ok_count++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(groups_n * clients_n, ok_count.load());
+}
+
+#if TD_PORT_POSIX
+TEST(Client, ManagerReceiveFd) {
+  td::ClientManager client;
+  auto fd = client.get_receive_fd();
+  ASSERT_TRUE(fd >= 0);
+  ASSERT_TRUE(client.receive(0).object == nullptr);
+
+  int clients_n = 10;
+  for (int i = 0; i < clients_n; i++) {
+    auto id = client.create_client_id();
+    client.send(id, 3, td::make_tl_object<td::td_api::testSquareInt>(3));
+  }
+
+  std::set<td::int32> ids;
+  while (ids.size() != static_cast<size_t>(clients_n)) {
+    pollfd poll_fd;
+    poll_fd.fd = fd;
+    poll_fd.events = POLLIN;
+    poll_fd.revents = 0;
+    ASSERT_EQ(1, poll(&poll_fd, 1, 10000));
+    while (true) {
+      auto event = client.receive(0);
+      if (event.object == nullptr) {
+        break;
+      }
+      if (event.request_id == 3) {
+        ASSERT_EQ(td::td_api::testInt::ID, event.object->get_id());
+        ASSERT_TRUE(ids.insert(event.client_id).second);
+      }
+    }
+  }
+}
+#endif
+
 TEST(Client, Close) {
   std::atomic<bool> stop_send{false};
   std::atomic<bool> can_stop_receive{false};
@@ -1190,3 +1292,115 @@ TEST(PartsManager, hands) {
     pm.init(1, 100000, true, 10, {0, 1, 2}, false, true).ensure_error();
   }
 }
+
+TEST(PartsManager, StreamingReadAhead) {
+  constexpr td::int64 MB = 1 << 20;
+  td::PartsManager pm;
+  pm.init(100 * MB, 100 * MB, true, 512 << 10, {}, false, false).ensure();
+  pm.set_streaming_offset(MB, MB, 1.0);
+  ASSERT_EQ(0, pm.get_streaming_read_ahead_size());
+  ASSERT_EQ(MB, pm.get_streaming_limit());
+
+  // playback advanced by 1 MB in a second
+  pm.set_streaming_offset(2 * MB, MB, 2.0);
+  ASSERT_EQ(10 * MB, pm.get_streaming_read_ahead_size());
+  ASSERT_EQ(11 * MB, pm.get_streaming_limit());
+
+  td::vector<td::Part> parts;
+  while (true) {
+    auto part = pm.start_part().move_as_ok();
+    if (part.size == 0) {
+      break;
+    }
+    parts.push_back(part);
+  }
+  // 2 requested parts and no more than 4 parts in advance
+  ASSERT_EQ(6u, parts.size());
+  ASSERT_EQ(4, parts[0].id);
+  ASSERT_EQ(9, parts.back().id);
+
+  pm.on_part_ok(parts[2].id, parts[2].size, parts[2].size).ensure();
+  auto part = pm.start_part().move_as_ok();
+  ASSERT_EQ(10, part.id);
+  ASSERT_EQ(0u, pm.start_part().move_as_ok().size);
+
+  // seek outside of the window resets read-ahead
+  pm.set_streaming_offset(50 * MB, MB, 3.0);
+  ASSERT_EQ(0, pm.get_streaming_read_ahead_size());
+  ASSERT_EQ(MB, pm.get_streaming_limit());
+}
+
+TEST(PartsManager, CalcPartSize) {
+  constexpr td::int64 MB = 1 << 20;
+  ASSERT_EQ(static_cast<size_t>(64 << 10), td::PartsManager::calc_part_size(10 * MB, 0));
+  ASSERT_EQ(static_cast<size_t>(256 << 10), td::PartsManager::calc_part_size(10 * MB, 200 << 10));
+  ASSERT_EQ(static_cast<size_t>(512 << 10), td::PartsManager::calc_part_size(10 * MB, 4 * MB));
+  ASSERT_EQ(static_cast<size_t>(256 << 10), td::PartsManager::calc_part_size(1000 * MB, 0));
+  ASSERT_EQ(static_cast<size_t>(512 << 10), td::PartsManager::calc_part_size(1001 * MB, 0));
+}
+
+TEST(UploadSpeedEstimator, InFlightLimit) {
+  constexpr td::int64 MB = 1 << 20;
+  td::UploadSpeedEstimator estimator;
+  ASSERT_EQ(static_cast<td::int64>(td::UploadSpeedEstimator::MIN_IN_FLIGHT_SIZE), estimator.get_in_flight_limit());
+  ASSERT_EQ(0u, estimator.get_min_part_size());
+
+  // 20 MB per second with RTT 0.5 seconds
+  double now = 100.0;
+  for (int i = 0; i < 100; i++) {
+    now += 0.1;
+    estimator.on_part_uploaded(2 * MB, 0.5, now);
+  }
+  ASSERT_TRUE(estimator.get_speed() > 19.0 * MB && estimator.get_speed() < 21.0 * MB);
+  ASSERT_EQ(0.5, estimator.get_min_rtt());
+  ASSERT_TRUE(estimator.get_in_flight_limit() > 18 * MB && estimator.get_in_flight_limit() < 22 * MB);
+  ASSERT_EQ(static_cast<size_t>(512 << 10), td::PartsManager::calc_part_size(10 * MB, estimator.get_min_part_size()));
+
+  // a pause in uploading doesn't decrease the speed
+  now += 100.0;
+  estimator.on_part_uploaded(2 * MB, 0.5, now);
+  ASSERT_TRUE(estimator.get_speed() > 19.0 * MB && estimator.get_speed() < 21.0 * MB);
+}
+
+TEST(BandwidthLimiter, Debt) {
+  td::BandwidthLimiter limiter;
+  ASSERT_TRUE(limiter.get_available(1.0) > 0);
+  limiter.spend(1 << 20);
+
+  limiter.set_limit(1000, 1.0);
+  ASSERT_EQ(0, limiter.get_available(1.0));
+  ASSERT_EQ(500, limiter.get_available(1.5));
+  ASSERT_EQ(1000, limiter.get_available(100.0));
+
+  limiter.spend(3000);
+  ASSERT_EQ(-2000, limiter.get_available(100.0));
+  ASSERT_TRUE(limiter.get_wakeup_at() > 102.0 && limiter.get_wakeup_at() < 102.01);
+  ASSERT_EQ(500, limiter.get_available(102.5));
+
+  limiter.set_limit(0, 102.5);
+  ASSERT_TRUE(limiter.get_available(102.5) > 0);
+}
+
+TEST(FileGcIndex, Entry) {
+  td::FileGcIndex::Entry entry;
+  entry.file_type = td::FileType::Video;
+  entry.size = 123456789012;
+  entry.atime = 1700000000;
+  entry.mtime_nsec = 1699999999123456789;
+  entry.owner_dialog_id = td::DialogId(static_cast<td::int64>(-1001234567890));
+
+  auto r_parsed_entry = td::FileGcIndex::parse_entry(td::FileGcIndex::serialize_entry(entry));
+  ASSERT_TRUE(r_parsed_entry.is_ok());
+  auto parsed_entry = r_parsed_entry.move_as_ok();
+  ASSERT_TRUE(parsed_entry.file_type == entry.file_type);
+  ASSERT_EQ(entry.size, parsed_entry.size);
+  ASSERT_EQ(entry.atime, parsed_entry.atime);
+  ASSERT_EQ(entry.mtime_nsec, parsed_entry.mtime_nsec);
+  ASSERT_TRUE(parsed_entry.owner_dialog_id == entry.owner_dialog_id);
+
+  ASSERT_TRUE(td::FileGcIndex::parse_entry("").is_error());
+  ASSERT_TRUE(td::FileGcIndex::parse_entry("1 2 3 4").is_error());
+  ASSERT_TRUE(td::FileGcIndex::parse_entry("-1 2 3 4 5").is_error());
+  ASSERT_TRUE(td::FileGcIndex::parse_entry("1 2 -3 4 5").is_error());
+  ASSERT_TRUE(td::FileGcIndex::parse_entry("1 2 3 4 5").is_ok());
+}
@@ -8,18 +8,25 @@
 #include "td/db/binlog/BinlogEvent.h"
 #include "td/db/binlog/BinlogHelper.h"
 #include "td/db/TQueue.h"
+#include "td/db/TQueueSharded.h"
+
+#include "td/actor/actor.h"
+#include "td/actor/ConcurrentScheduler.h"
 
 #include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/int_types.h"
 #include "td/utils/logging.h"
+#include "td/utils/Promise.h"
 #include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Span.h"
+#include "td/utils/Status.h"
 #include "td/utils/tests.h"
 #include "td/utils/Time.h"
 
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -258,3 +265,169 @@ TEST(TQueue, clear) {
   CHECK(tqueue->get_tail(1) == tail_id);
   CHECK(deleted_events.size() == 100000 - keep_count);
 }
+
+TEST(TQueue, forget) {
+  td::TQueue::Event events[10];
+  auto events_span = td::MutableSpan<td::TQueue::Event>(events, 10);
+
+  auto tqueue = td::TQueue::create();
+  auto qid = 1;
+  ASSERT_EQ(0u, tqueue->get_memory_usage());
+  td::vector<td::TQueue::EventId> ids;
+  for (int i = 0; i < 1000; i++) {
+    ids.push_back(tqueue->push(qid, PSTRING() << i, 1000, i, {}).move_as_ok());
+  }
+  auto memory_usage = tqueue->get_memory_usage();
+  ASSERT_TRUE(memory_usage > 0);
+  for (size_t i = 0; i < ids.size(); i++) {
+    if (i % 10 != 0) {
+      tqueue->forget(qid, ids[i]);
+    }
+  }
+  ASSERT_EQ(100u, tqueue->get_size(qid));
+  ASSERT_TRUE(tqueue->get_memory_usage() < memory_usage);
+  ASSERT_EQ(ids[0], tqueue->get_head(qid));
+
+  ASSERT_EQ(100u, tqueue->get(qid, ids[15], false, 0, events_span).move_as_ok());
+  ASSERT_EQ(10u, events_span.size());
+  for (size_t i = 0; i < events_span.size(); i++) {
+    ASSERT_EQ(ids[20 + 10 * i], events_span[i].id);
+    ASSERT_EQ(static_cast<td::int64>(20 + 10 * i), events_span[i].extra);
+  }
+
+  events_span = td::MutableSpan<td::TQueue::Event>(events, 10);
+  ASSERT_EQ(98u, tqueue->get(qid, ids[15], true, 0, events_span).move_as_ok());
+  ASSERT_EQ(ids[20], tqueue->get_head(qid));
+  tqueue->forget(qid, ids[999]);
+  tqueue->forget(qid, ids[990]);
+  ASSERT_EQ(97u, tqueue->get_size(qid));
+  ASSERT_EQ(ids[999].next().ok(), tqueue->get_tail(qid));
+}
+
+TEST(TQueue, gc) {
+  auto tqueue = td::TQueue::create();
+  auto qid = 1;
+  for (int i = 0; i < 100; i++) {
+    tqueue->push(qid, "data", i % 10 == 0 ? 10000 : 100 + i, 0, {}).ensure();
+  }
+  ASSERT_EQ(100u, tqueue->get_size(qid));
+  auto result = tqueue->run_gc(150);
+  ASSERT_EQ(45, result.first);
+  ASSERT_TRUE(result.second);
+  ASSERT_EQ(55u, tqueue->get_size(qid));
+  result = tqueue->run_gc(1000);
+  ASSERT_EQ(45, result.first);
+  ASSERT_EQ(10u, tqueue->get_size(qid));
+  result = tqueue->run_gc(1000);
+  ASSERT_EQ(0, result.first);
+  ASSERT_EQ(10u, tqueue->get_size(qid));
+  result = tqueue->run_gc(10001);
+  ASSERT_EQ(10, result.first);
+  ASSERT_EQ(0u, tqueue->get_size(qid));
+}
+
+static void run_sharded_tqueue(int shard_count, const td::string &binlog_path,
+                               std::function<void(std::shared_ptr<td::TQueueSharded>, td::Promise<td::Unit>)> f) {
+  td::ConcurrentScheduler sched(shard_count, 0);
+  {
+    auto guard = sched.get_main_guard();
+    td::vector<td::int32> scheduler_ids;
+    for (int i = 0; i < shard_count; i++) {
+      scheduler_ids.push_back(i + 1);
+    }
+    auto tqueue = std::make_shared<td::TQueueSharded>(std::move(scheduler_ids));
+    tqueue->open(binlog_path, td::PromiseCreator::lambda([](td::Unit) {}));
+    f(tqueue, td::PromiseCreator::lambda([tqueue](td::Unit) {
+      tqueue->close(td::PromiseCreator::lambda([](td::Unit) { td::Scheduler::instance()->finish(); }));
+    }));
+  }
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+}
+
+TEST(TQueue, sharded) {
+  const int shard_count = 3;
+  const int queue_count = 10;
+  const int event_count = 100;
+  td::string binlog_path = "test_tqueue_sharded.binlog";
+  for (int i = 0; i < shard_count; i++) {
+    td::Binlog::destroy(PSLICE() << binlog_path << '.' << i).ignore();
+  }
+
+  td::vector<td::TQueue::EventId> head_ids;
+  td::vector<size_t> queue_sizes;
+  size_t returned_event_count = 0;
+  auto push_events = [&](std::shared_ptr<td::TQueueSharded> tqueue, td::Promise<td::Unit> promise) {
+    td::vector<td::TQueueSharded::PushQuery> queries;
+    for (int i = 0; i < event_count; i++) {
+      td::TQueueSharded::PushQuery query;
+      query.queue_id = i % queue_count + 1;
+      query.data = PSTRING() << i;
+      query.expires_at = 1000;
+      query.extra = i;
+      queries.push_back(std::move(query));
+    }
+    tqueue->push_many(
+        std::move(queries),
+        td::PromiseCreator::lambda([&, tqueue, promise = std::move(promise)](
+                                       td::vector<td::Result<td::TQueue::EventId>> results) mutable {
+          ASSERT_EQ(static_cast<size_t>(event_count), results.size());
+          td::vector<td::TQueueSharded::GetQuery> get_queries;
+          for (int i = 0; i < queue_count; i++) {
+            head_ids.push_back(results[i].move_as_ok());
+            td::TQueueSharded::GetQuery query;
+            query.queue_id = i + 1;
+            query.from_id = head_ids.back();
+            query.limit = 5;
+            get_queries.push_back(query);
+          }
+          tqueue->get_many(std::move(get_queries), 0,
+                           td::PromiseCreator::lambda([&, promise = std::move(promise)](
+                                                          td::vector<td::Result<td::TQueueSharded::GetResult>>
+                                                              results) mutable {
+                             for (size_t i = 0; i < results.size(); i++) {
+                               auto result = results[i].move_as_ok();
+                               queue_sizes.push_back(result.queue_size);
+                               for (size_t j = 0; j < result.events.size(); j++) {
+                                 ASSERT_EQ(static_cast<td::int64>(i + j * queue_count), result.events[j].extra);
+                                 ASSERT_EQ(PSTRING() << result.events[j].extra, result.events[j].data);
+                                 returned_event_count++;
+                               }
+                             }
+                             promise.set_value(td::Unit());
+                           }));
+        }));
+  };
+  run_sharded_tqueue(shard_count, binlog_path, push_events);
+  ASSERT_EQ(static_cast<size_t>(queue_count * 5), returned_event_count);
+  ASSERT_EQ(td::vector<size_t>(queue_count, event_count / queue_count), queue_sizes);
+
+  queue_sizes.clear();
+  auto get_events = [&](std::shared_ptr<td::TQueueSharded> tqueue, td::Promise<td::Unit> promise) {
+    td::vector<td::TQueueSharded::GetQuery> get_queries;
+    for (int i = 0; i < queue_count; i++) {
+      td::TQueueSharded::GetQuery query;
+      query.queue_id = i + 1;
+      query.from_id = head_ids[i];
+      query.forget_previous = true;
+      get_queries.push_back(query);
+    }
+    using GetResults = td::vector<td::Result<td::TQueueSharded::GetResult>>;
+    tqueue->get_many(std::move(get_queries), 0,
+                     td::PromiseCreator::lambda([&, promise = std::move(promise)](GetResults results) mutable {
+                       for (auto &result : results) {
+                         queue_sizes.push_back(result.move_as_ok().queue_size);
+                       }
+                       promise.set_value(td::Unit());
+                     }));
+  };
+  run_sharded_tqueue(shard_count, binlog_path, get_events);
+  ASSERT_EQ(td::vector<size_t>(queue_count, event_count / queue_count), queue_sizes);
+
+  for (int i = 0; i < shard_count; i++) {
+    td::Binlog::destroy(PSLICE() << binlog_path << '.' << i).ignore();
+  }
+}